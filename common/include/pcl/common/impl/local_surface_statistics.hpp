@@ -0,0 +1,161 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#pragma once
+
+#include <pcl/common/local_surface_statistics.h>
+#include <pcl/common/eigen.h>
+#include <pcl/common/parallel.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+
+namespace pcl
+{
+
+namespace detail
+{
+
+template <typename PointT, typename IteratorT> unsigned int
+computeScatterMatrix (const pcl::PointCloud<PointT> &cloud,
+                      IteratorT first, IteratorT last,
+                      const Eigen::Vector3d &origin,
+                      Eigen::Vector3d &sum,
+                      Eigen::Matrix3d &scatter_matrix)
+{
+  // One row of the scatter matrix and one coordinate of the sum per accumulator, so that every point
+  // is accumulated with three vectorized multiply-adds
+  Eigen::Vector4d accu_x = Eigen::Vector4d::Zero ();
+  Eigen::Vector4d accu_y = Eigen::Vector4d::Zero ();
+  Eigen::Vector4d accu_z = Eigen::Vector4d::Zero ();
+  unsigned int point_count = 0;
+  for (; first != last; ++first)
+  {
+    const PointT &point = cloud[*first];
+    if (!cloud.is_dense && !isFinite (point))
+      continue;
+
+    const Eigen::Vector4d offset (point.x - origin[0], point.y - origin[1], point.z - origin[2], 1.0);
+    accu_x += offset[0] * offset;
+    accu_y += offset[1] * offset;
+    accu_z += offset[2] * offset;
+    ++point_count;
+  }
+
+  scatter_matrix.row (0) = accu_x.head<3> ();
+  scatter_matrix.row (1) = accu_y.head<3> ();
+  scatter_matrix.row (2) = accu_z.head<3> ();
+  sum << accu_x[3], accu_y[3], accu_z[3];
+  return (point_count);
+}
+
+
+template <typename PointT, typename IteratorT> unsigned int
+computeLocalSurfaceStatistics (const pcl::PointCloud<PointT> &cloud,
+                               IteratorT first, IteratorT last,
+                               LocalSurfaceStatistics &statistics,
+                               bool compute_eigen)
+{
+  // The moments are taken around the first finite point, which is close to the centroid
+  while (first != last && !isFinite (cloud[*first]))
+    ++first;
+  if (first == last)
+  {
+    statistics.num_points = 0;
+    statistics.centroid.setConstant (std::numeric_limits<double>::quiet_NaN ());
+    statistics.covariance.setConstant (std::numeric_limits<double>::quiet_NaN ());
+    statistics.eigenvalues.setConstant (std::numeric_limits<double>::quiet_NaN ());
+    statistics.eigenvectors.setConstant (std::numeric_limits<double>::quiet_NaN ());
+    return (0);
+  }
+  const Eigen::Vector3d origin = cloud[*first].getVector3fMap ().template cast<double> ();
+
+  Eigen::Vector3d sum;
+  statistics.num_points = computeScatterMatrix (cloud, first, last, origin, sum, statistics.covariance);
+  const Eigen::Vector3d mean_offset = sum / static_cast<double> (statistics.num_points);
+  statistics.centroid = origin + mean_offset;
+  statistics.covariance /= static_cast<double> (statistics.num_points);
+  statistics.covariance -= mean_offset * mean_offset.transpose ();
+
+  if (compute_eigen)
+    pcl::eigen33 (statistics.covariance, statistics.eigenvectors, statistics.eigenvalues);
+  return (statistics.num_points);
+}
+
+} // namespace detail
+
+
+template <typename PointT> unsigned int
+computeScatterMatrix (const pcl::PointCloud<PointT> &cloud,
+                      const Indices &indices,
+                      const Eigen::Vector3d &origin,
+                      Eigen::Vector3d &sum,
+                      Eigen::Matrix3d &scatter_matrix)
+{
+  return (detail::computeScatterMatrix (cloud, indices.cbegin (), indices.cend (), origin, sum, scatter_matrix));
+}
+
+
+template <typename PointT> unsigned int
+computeLocalSurfaceStatistics (const pcl::PointCloud<PointT> &cloud,
+                               const Indices &indices,
+                               LocalSurfaceStatistics &statistics,
+                               bool compute_eigen)
+{
+  return (detail::computeLocalSurfaceStatistics (cloud, indices.cbegin (), indices.cend (), statistics, compute_eigen));
+}
+
+
+template <typename PointT> void
+computeLocalSurfaceStatistics (const pcl::PointCloud<PointT> &cloud,
+                               const std::vector<std::size_t> &offsets,
+                               const Indices &neighbor_indices,
+                               LocalSurfaceStatisticsVector &statistics,
+                               bool compute_eigen,
+                               unsigned int nr_threads)
+{
+  const std::size_t nr_neighborhoods = offsets.empty () ? 0 : offsets.size () - 1;
+  statistics.resize (nr_neighborhoods);
+
+  pcl::parallel::parallel_for (std::size_t (0), nr_neighborhoods, [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+      detail::computeLocalSurfaceStatistics (cloud, neighbor_indices.cbegin () + offsets[i],
+                                             neighbor_indices.cbegin () + offsets[i + 1], statistics[i], compute_eigen);
+  }, nr_threads, std::size_t (256));
+}
+
+} // namespace pcl
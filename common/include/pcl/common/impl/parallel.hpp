@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+namespace pcl
+{
+
+namespace parallel
+{
+
+namespace detail
+{
+
+/** \brief Size of the chunks of a range of \a size indices processed by \a nr_threads threads. The automatic size
+  * aims at a few chunks per thread, which balances the load without making the chunks too small. */
+inline std::size_t
+getGrainSize (std::size_t size, unsigned int nr_threads, std::size_t grain_size)
+{
+  if (grain_size > 0)
+    return (grain_size);
+  return (std::max<std::size_t> (1, size / (8 * static_cast<std::size_t> (nr_threads))));
+}
+
+/** \brief Run body (chunk, first, last) for each chunk of [begin, end). */
+template <typename IndexT, typename ChunkBody> void
+forEachChunk (IndexT begin, IndexT end, const ChunkBody &body, unsigned int nr_threads, std::size_t grain_size)
+{
+  const std::size_t size = static_cast<std::size_t> (end - begin);
+  const std::size_t nr_chunks = (size + grain_size - 1) / grain_size;
+  const auto chunk_range = [begin, end, nr_chunks, grain_size] (std::size_t chunk, IndexT &first, IndexT &last)
+  {
+    first = static_cast<IndexT> (begin + static_cast<IndexT> (chunk * grain_size));
+    last = chunk + 1 == nr_chunks ? end : static_cast<IndexT> (first + static_cast<IndexT> (grain_size));
+  };
+
+  if (nr_threads <= 1 || nr_chunks <= 1)
+  {
+    for (std::size_t chunk = 0; chunk < nr_chunks; ++chunk)
+    {
+      IndexT first, last;
+      chunk_range (chunk, first, last);
+      body (chunk, first, last);
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> next_chunk (0);
+  run ([&] ()
+  {
+    for (std::size_t chunk = next_chunk++; chunk < nr_chunks; chunk = next_chunk++)
+    {
+      IndexT first, last;
+      chunk_range (chunk, first, last);
+      try
+      {
+        body (chunk, first, last);
+      }
+      catch (...)
+      {
+        // Skip the remaining chunks
+        next_chunk = nr_chunks;
+        throw;
+      }
+    }
+  }, static_cast<unsigned int> (std::min<std::size_t> (nr_threads, nr_chunks)));
+}
+
+} // namespace detail
+
+template <typename IndexT, typename RangeBody> void
+parallel_for (IndexT begin, IndexT end, const RangeBody &body, unsigned int nr_threads, IndexT grain_size)
+{
+  if (end <= begin)
+    return;
+
+  nr_threads = detail::getNumberOfThreads (nr_threads);
+  const std::size_t chunk_size = detail::getGrainSize (static_cast<std::size_t> (end - begin), nr_threads,
+                                                       static_cast<std::size_t> (grain_size));
+  detail::forEachChunk (begin, end, [&body] (std::size_t, IndexT first, IndexT last) { body (first, last); },
+                        nr_threads, chunk_size);
+}
+
+template <typename IndexT, typename T, typename RangeBody, typename Reduction> T
+parallel_reduce (IndexT begin, IndexT end, const T &identity, const RangeBody &body, const Reduction &reduce,
+                 unsigned int nr_threads, IndexT grain_size)
+{
+  if (end <= begin)
+    return (identity);
+
+  nr_threads = detail::getNumberOfThreads (nr_threads);
+  const std::size_t size = static_cast<std::size_t> (end - begin);
+  const std::size_t chunk_size = detail::getGrainSize (size, nr_threads, static_cast<std::size_t> (grain_size));
+
+  // Wrapped so that each chunk writes its own object, even for T = bool
+  struct Partial
+  {
+    T value;
+  };
+  std::vector<Partial> partials ((size + chunk_size - 1) / chunk_size, Partial {identity});
+  detail::forEachChunk (begin, end, [&body, &partials] (std::size_t chunk, IndexT first, IndexT last)
+  {
+    partials[chunk].value = body (first, last);
+  }, nr_threads, chunk_size);
+
+  T result = identity;
+  for (const auto &partial : partials)
+    result = reduce (result, partial.value);
+  return (result);
+}
+
+} // namespace parallel
+
+} // namespace pcl
@@ -0,0 +1,138 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h>
+
+/**
+  * \file pcl/common/local_surface_statistics.h
+  * Define methods for the centroid, covariance matrix and eigen decomposition of local neighborhoods
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  /** \brief Centroid, covariance matrix and eigen decomposition of a set of points, typically the
+    * neighborhood of a point, as used by normal, curvature, keypoint and local reference frame estimators.
+    * \ingroup common
+    */
+  struct LocalSurfaceStatistics
+  {
+    /** \brief The number of finite points the statistics were computed from. */
+    unsigned int num_points = 0;
+
+    /** \brief The centroid of the points. */
+    Eigen::Vector3d centroid;
+
+    /** \brief The covariance matrix of the points, normalized by their number. */
+    Eigen::Matrix3d covariance;
+
+    /** \brief The eigenvalues of the covariance matrix, in increasing order. */
+    Eigen::Vector3d eigenvalues;
+
+    /** \brief The eigenvectors of the covariance matrix, stored in the columns in the order of the eigenvalues. */
+    Eigen::Matrix3d eigenvectors;
+
+    PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  using LocalSurfaceStatisticsVector = std::vector<LocalSurfaceStatistics, Eigen::aligned_allocator<LocalSurfaceStatistics> >;
+
+  /** \brief Compute the sum of the offsets of a set of points from a given origin, and the sum of their outer
+    * products (the scatter matrix around the origin), in a single pass. Non-finite points are skipped if the cloud
+    * is not dense.
+    * \param[in] cloud the input point cloud
+    * \param[in] indices the indices of the points in \a cloud
+    * \param[in] origin the point the offsets are taken from
+    * \param[out] sum the sum of the offsets of the points from \a origin
+    * \param[out] scatter_matrix the sum of the outer products of the offsets
+    * \return the number of points used
+    * \ingroup common
+    */
+  template <typename PointT> unsigned int
+  computeScatterMatrix (const pcl::PointCloud<PointT> &cloud,
+                        const Indices &indices,
+                        const Eigen::Vector3d &origin,
+                        Eigen::Vector3d &sum,
+                        Eigen::Matrix3d &scatter_matrix);
+
+  /** \brief Compute the centroid, the normalized covariance matrix and optionally its eigenvalues and
+    * eigenvectors for a set of points, in a single pass.
+    *
+    * The moments are accumulated in double precision around the first point, which keeps the covariance matrix
+    * accurate far from the origin, unlike the raw moments of pcl::computeMeanAndCovarianceMatrix. The eigen
+    * decomposition uses the closed form solver pcl::eigen33.
+    * \param[in] cloud the input point cloud
+    * \param[in] indices the indices of the points in \a cloud
+    * \param[out] statistics the resultant statistics. If no point is finite, they are set to NaN.
+    * \param[in] compute_eigen whether to compute the eigenvalues and eigenvectors as well
+    * \return the number of points used
+    * \ingroup common
+    */
+  template <typename PointT> unsigned int
+  computeLocalSurfaceStatistics (const pcl::PointCloud<PointT> &cloud,
+                                 const Indices &indices,
+                                 LocalSurfaceStatistics &statistics,
+                                 bool compute_eigen = true);
+
+  /** \brief Compute the local surface statistics of a batch of neighborhoods, in parallel. The neighborhoods are
+    * given in compressed sparse row format, as stored by pcl::NeighborhoodCache: the i-th neighborhood is made of
+    * the entries [offsets[i], offsets[i + 1]) of \a neighbor_indices.
+    * \param[in] cloud the input point cloud
+    * \param[in] offsets the offsets of the neighborhoods in \a neighbor_indices, one more than their number
+    * \param[in] neighbor_indices the indices in \a cloud of the points of all neighborhoods
+    * \param[out] statistics the resultant statistics, one per neighborhood
+    * \param[in] compute_eigen whether to compute the eigenvalues and eigenvectors as well
+    * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
+    * \ingroup common
+    */
+  template <typename PointT> void
+  computeLocalSurfaceStatistics (const pcl::PointCloud<PointT> &cloud,
+                                 const std::vector<std::size_t> &offsets,
+                                 const Indices &neighbor_indices,
+                                 LocalSurfaceStatisticsVector &statistics,
+                                 bool compute_eigen = true,
+                                 unsigned int nr_threads = 0);
+}
+/*@}*/
+#include <pcl/common/impl/local_surface_statistics.hpp>
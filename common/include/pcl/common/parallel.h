@@ -0,0 +1,146 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+
+#include <functional>
+
+namespace pcl
+{
+  /** \brief A thread budget shared by all the parallel loops of the process.
+    *
+    * The loops run on a single pool of worker threads, plus the threads that call them. Each loop splits its range
+    * into chunks which the calling thread and the idle workers take in turn, so the work is balanced between threads
+    * at the granularity of a chunk. When several loops run concurrently, e.g. from several pipelines running in the
+    * same process or when a loop is nested in another one, they share the workers instead of starting threads of
+    * their own. A worker only starts helping with a loop while fewer than budget - 1 workers are busy with any loop,
+    * so the process never runs more than the budget of threads in parallel loops (plus its own calling threads),
+    * also right after the budget was lowered.
+    *
+    * \ingroup common
+    */
+  namespace parallel
+  {
+    /** \brief Set the number of threads the parallel loops may use, i.e. the number of workers of the pool plus one
+      * for the calling thread. It may be changed at any time, also from within a loop, without waiting for the loops
+      * which are running: the workers which are helping them keep doing so until they end, and no worker starts
+      * helping any loop again until the busy ones fit in the new budget. Workers are started as needed and kept idle until exit.
+      * \param[in] nr_threads the thread budget (0 sets the value back to automatic, i.e. the number of hardware
+      * threads)
+      */
+    PCL_EXPORTS void
+    setThreadBudget (unsigned int nr_threads = 0);
+
+    /** \brief Get the number of threads the parallel loops may use. */
+    PCL_EXPORTS unsigned int
+    getThreadBudget ();
+
+    /** \brief Set the thread budget for the lifetime of the object, and set the previous one back afterwards. */
+    class ScopedThreadBudget
+    {
+      public:
+        /** \brief Set the thread budget, see setThreadBudget (). */
+        explicit ScopedThreadBudget (unsigned int nr_threads) : previous_ (getThreadBudget ())
+        {
+          setThreadBudget (nr_threads);
+        }
+
+        ScopedThreadBudget (const ScopedThreadBudget&) = delete;
+        ScopedThreadBudget&
+        operator = (const ScopedThreadBudget&) = delete;
+
+        ~ScopedThreadBudget ()
+        {
+          setThreadBudget (previous_);
+        }
+
+      private:
+        unsigned int previous_;
+    };
+
+    /** \brief Run \a body over [\a begin, \a end), split into chunks of consecutive indices.
+      * \param[in] begin the first index
+      * \param[in] end one past the last index
+      * \param[in] body called as body (first, last) for each chunk [first, last), concurrently for different chunks
+      * \param[in] nr_threads the maximum number of threads for this loop, including the calling one (0 for the
+      * whole budget). It is further limited by the budget and by the number of idle workers
+      * \param[in] grain_size the number of indices per chunk (0 for automatic)
+      *
+      * The first exception thrown by \a body is thrown again once all the threads have left the loop; the chunks
+      * that were not started yet are then skipped.
+      */
+    template <typename IndexT, typename RangeBody> void
+    parallel_for (IndexT begin, IndexT end, const RangeBody &body, unsigned int nr_threads = 0,
+                  IndexT grain_size = 0);
+
+    /** \brief Reduce \a body over [\a begin, \a end), split into chunks of consecutive indices.
+      * \param[in] begin the first index
+      * \param[in] end one past the last index
+      * \param[in] identity the identity element of \a reduce, which is also returned for an empty range
+      * \param[in] body called as body (first, last) for each chunk [first, last), concurrently for different chunks,
+      * and returning the partial result of the chunk
+      * \param[in] reduce called as reduce (a, b) to combine two results
+      * \param[in] nr_threads the maximum number of threads for this loop, see parallel_for ()
+      * \param[in] grain_size the number of indices per chunk (0 for automatic)
+      * \return the partial results combined in the order of the chunks, starting from \a identity. For a given
+      * \a grain_size, the result hence does not depend on the number of threads, even for a non-associative
+      * \a reduce such as a floating point sum.
+      */
+    template <typename IndexT, typename T, typename RangeBody, typename Reduction> T
+    parallel_reduce (IndexT begin, IndexT end, const T &identity, const RangeBody &body, const Reduction &reduce,
+                     unsigned int nr_threads = 0, IndexT grain_size = 0);
+
+    namespace detail
+    {
+      /** \brief Get the number of threads a loop may use, given the limit it was called with. */
+      PCL_EXPORTS unsigned int
+      getNumberOfThreads (unsigned int nr_threads);
+
+      /** \brief Run \a task on the calling thread and on up to \a nr_threads - 1 idle workers, and return once all
+        * of them are done. \a task is expected to take chunks of work until there are none left, so the workers
+        * which only become idle after the calling thread ran out of chunks are not waited for.
+        * The first exception thrown by \a task is thrown again.
+        */
+      PCL_EXPORTS void
+      run (const std::function<void ()> &task, unsigned int nr_threads);
+    }
+  }
+}
+
+#include <pcl/common/impl/parallel.hpp>
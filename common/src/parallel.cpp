@@ -0,0 +1,302 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  /** \brief The workers shared by all the parallel loops. Tasks are run in the order they were submitted. */
+  class ThreadPool
+  {
+    public:
+      ~ThreadPool ()
+      {
+        stop ();
+      }
+
+      /** \brief Start workers until there are at least \a nr_workers of them. Workers are never stopped before the
+        * pool is destroyed, so the loops running concurrently keep theirs.
+        */
+      void
+      reserve (unsigned int nr_workers)
+      {
+        if (size_ >= nr_workers)
+          return;
+        std::lock_guard<std::mutex> lock (workers_mutex_);
+        while (workers_.size () < nr_workers)
+        {
+          workers_.emplace_back ([this] { work (); });
+          size_ = static_cast<unsigned int> (workers_.size ());
+        }
+      }
+
+      /** \brief Stop the workers once they have run all the submitted tasks. */
+      void
+      stop ()
+      {
+        {
+          std::lock_guard<std::mutex> lock (mutex_);
+          shutdown_ = true;
+        }
+        condition_.notify_all ();
+        std::lock_guard<std::mutex> lock (workers_mutex_);
+        for (auto &worker : workers_)
+          worker.join ();
+        workers_.clear ();
+        size_ = 0;
+      }
+
+      void
+      submit (std::function<void ()> task)
+      {
+        {
+          std::lock_guard<std::mutex> lock (mutex_);
+          tasks_.push_back (std::move (task));
+        }
+        condition_.notify_one ();
+      }
+
+      unsigned int
+      size () const
+      {
+        return (size_);
+      }
+
+    private:
+      void
+      work ()
+      {
+        for (;;)
+        {
+          std::function<void ()> task;
+          {
+            std::unique_lock<std::mutex> lock (mutex_);
+            condition_.wait (lock, [this] { return (shutdown_ || !tasks_.empty ()); });
+            if (tasks_.empty ())
+              return;
+            task = std::move (tasks_.front ());
+            tasks_.pop_front ();
+          }
+          task ();
+        }
+      }
+
+      std::vector<std::thread> workers_;
+      /** \brief Number of workers, readable without locking \a workers_mutex_. */
+      std::atomic<unsigned int> size_ {0};
+      std::mutex workers_mutex_;
+      std::deque<std::function<void ()> > tasks_;
+      std::mutex mutex_;
+      std::condition_variable condition_;
+      bool shutdown_ = false;
+  };
+
+  /** \brief A call to pcl::parallel::detail::run (), shared with the workers helping with it. */
+  struct Job
+  {
+    const std::function<void ()> *task = nullptr;
+    std::mutex mutex;
+    std::condition_variable done;
+    /** \brief Number of workers running the task. */
+    unsigned int running = 0;
+    /** \brief Set once the calling thread is done, after which the workers must not start the task anymore. */
+    bool closed = false;
+    std::exception_ptr error;
+
+    /** \brief Run the task, keeping the first exception it throws. */
+    void
+    execute ()
+    {
+      try
+      {
+        (*task) ();
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock (mutex);
+        if (!error)
+          error = std::current_exception ();
+      }
+    }
+  };
+
+  unsigned int
+  getHardwareThreads ()
+  {
+    return (std::max (1u, std::thread::hardware_concurrency ()));
+  }
+
+  /** \brief The thread budget. It is only read and written atomically, so changing it never waits for the loops
+    * which are running: the workers helping them finish their job, and no worker starts helping any loop until the
+    * workers which are busy fit in the new budget.
+    */
+  std::atomic<unsigned int>&
+  getBudget ()
+  {
+    static std::atomic<unsigned int> budget {getHardwareThreads ()};
+    return (budget);
+  }
+
+  ThreadPool&
+  getPool ()
+  {
+    static ThreadPool pool;
+    return (pool);
+  }
+
+  /** \brief Number of workers helping with a loop, over all the loops running concurrently. */
+  std::atomic<unsigned int>&
+  getBusyHelpers ()
+  {
+    static std::atomic<unsigned int> busy {0};
+    return (busy);
+  }
+
+  /** \brief Take a helper slot if the busy workers are fewer than the budget minus the calling thread.
+    * \return false if the budget is used up, in which case the worker must not help with the loop
+    */
+  bool
+  acquireHelper ()
+  {
+    std::atomic<unsigned int> &busy = getBusyHelpers ();
+    unsigned int nr_busy = busy;
+    do
+    {
+      if (nr_busy + 1 >= getBudget ())
+        return (false);
+    }
+    while (!busy.compare_exchange_weak (nr_busy, nr_busy + 1));
+    return (true);
+  }
+
+  void
+  releaseHelper ()
+  {
+    --getBusyHelpers ();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::parallel::setThreadBudget (unsigned int nr_threads)
+{
+  getBudget () = nr_threads == 0 ? getHardwareThreads () : nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int
+pcl::parallel::getThreadBudget ()
+{
+  return (getBudget ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int
+pcl::parallel::detail::getNumberOfThreads (unsigned int nr_threads)
+{
+  const unsigned int budget = getThreadBudget ();
+  return (nr_threads == 0 ? budget : std::min (nr_threads, budget));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::parallel::detail::run (const std::function<void ()> &task, unsigned int nr_threads)
+{
+  const unsigned int nr_wanted = getNumberOfThreads (nr_threads) - 1;
+  if (nr_wanted == 0)
+  {
+    task ();
+    return;
+  }
+  // The pool only grows, and outside of any lock the workers could be waiting for, so a budget raised while loops
+  // are running just adds workers. A budget lowered later is enforced by the helper slots instead: the workers
+  // beyond it stay idle
+  ThreadPool &pool = getPool ();
+  pool.reserve (nr_wanted);
+  const unsigned int nr_helpers = std::min (nr_wanted, pool.size ());
+  if (nr_helpers == 0 || getBusyHelpers () + 1 >= getBudget ())
+  {
+    task ();
+    return;
+  }
+
+  auto job = std::make_shared<Job> ();
+  job->task = &task;
+  // Workers that are busy with other loops only pick up the job if it is still running by then, so a nested or
+  // concurrent loop never waits for them. They also need a helper slot, so that all the loops together never use
+  // more workers than the current budget allows, whatever the budget was when each of them started
+  for (unsigned int i = 0; i < nr_helpers; ++i)
+    pool.submit ([job]
+    {
+      if (!acquireHelper ())
+        return;
+      {
+        std::lock_guard<std::mutex> lock (job->mutex);
+        if (job->closed)
+        {
+          releaseHelper ();
+          return;
+        }
+        ++job->running;
+      }
+      job->execute ();
+      releaseHelper ();
+      {
+        std::lock_guard<std::mutex> lock (job->mutex);
+        --job->running;
+      }
+      job->done.notify_all ();
+    });
+
+  job->execute ();
+
+  std::unique_lock<std::mutex> lock (job->mutex);
+  job->closed = true;
+  job->done.wait (lock, [&job] { return (job->running == 0); });
+  if (job->error)
+    std::rethrow_exception (job->error);
+}
@@ -179,6 +179,19 @@ namespace pcl
       bool
       computePoint (std::size_t index, const pcl::PointCloud<PointNT> &normals, float rf[9], std::vector<float> &desc);
 
+      /** \brief Estimate a descriptor for a given point, deriving the X axis of its RF from a given random direction.
+        * \param[in] index the index of the point to estimate a descriptor for
+        * \param[in] normals a pointer to the set of normals
+        * \param[in] random_axis the random direction that is made orthogonal to the normal to get the X axis
+        * \param[in] rf the reference frame
+        * \param[out] desc the resultant estimated descriptor
+        * \return true if the descriptor was computed successfully, false if there was an error
+        * (e.g. the nearest neighbor didn't return any neighbors)
+        */
+      bool
+      computePoint (std::size_t index, const pcl::PointCloud<PointNT> &normals, const Eigen::Vector3f &random_axis,
+                    float rf[9], std::vector<float> &desc) const;
+
       /** \brief Estimate the actual feature.
         * \param[out] output the resultant feature
         */
@@ -49,6 +49,7 @@
 #include <pcl/pcl_base.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/search/search.h>
+#include <pcl/features/neighborhood_cache.h>
 
 #include <functional>
 
@@ -123,6 +124,8 @@ namespace pcl
 
       using PointCloudOut = pcl::PointCloud<PointOutT>;
 
+      using NeighborhoodCacheConstPtr = typename NeighborhoodCache<PointInT>::ConstPtr;
+
       using SearchMethod = std::function<int (std::size_t, double, std::vector<int> &, std::vector<float> &)>;
       using SearchMethodSurface = std::function<int (const PointCloudIn &cloud, std::size_t index, double, std::vector<int> &, std::vector<float> &)>;
 
@@ -132,7 +135,7 @@ namespace pcl
         feature_name_ (), search_method_surface_ (),
         surface_(), tree_(),
         search_parameter_(0), search_radius_(0), k_(0),
-        fake_surface_(false)
+        fake_surface_(false), fake_tree_ (false), neighborhoods_ (), threads_ (1)
       {}
 
       /** \brief Empty destructor */
@@ -210,6 +213,38 @@ namespace pcl
         return (search_radius_);
       }
 
+      /** \brief Provide neighborhoods which were computed beforehand, e.g. to share them between several
+        * feature estimators. They are used in place of the neighbor searches if they were computed for the same
+        * input cloud and search surface, with a search parameter at least as large as the one of this estimator.
+        * Otherwise, and for the points they do not cover, the neighbors are searched as usual.
+        * \param[in] neighborhoods the precomputed neighborhoods
+        */
+      inline void
+      setPrecomputedNeighborhoods (const NeighborhoodCacheConstPtr &neighborhoods) { neighborhoods_ = neighborhoods; }
+
+      /** \brief Get a pointer to the precomputed neighborhoods. */
+      inline NeighborhoodCacheConstPtr
+      getPrecomputedNeighborhoods () const
+      {
+        return (neighborhoods_);
+      }
+
+      /** \brief Set the number of threads to use for the estimators which compute their points in parallel, i.e.
+        * the ones using computeFeatureParallel () and the *OMP classes. The other estimators ignore it. Defaults to
+        * 1, except for the *OMP classes which default to 0. The threads are taken from the process-wide pool of
+        * pcl::parallel, so the value is further limited by pcl::parallel::getThreadBudget ().
+        * \param[in] nr_threads the maximum number of threads to use (0 for the whole budget of pcl::parallel)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by computeFeatureParallel (). */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Base method for feature estimation for all points given in
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface ()
         * and the spatial locator in setSearchMethod ()
@@ -257,6 +292,30 @@ namespace pcl
       /** \brief If no surface is given, we use the input PointCloud as the surface. */
       bool fake_surface_;
 
+      /** \brief If no search method is given, we use the one of the precomputed neighborhoods, for the current
+        * compute () only.
+        */
+      bool fake_tree_;
+
+      /** \brief The precomputed neighborhoods, if any. */
+      NeighborhoodCacheConstPtr neighborhoods_;
+
+      /** \brief The number of threads used by computeFeatureParallel (). */
+      unsigned int threads_;
+
+      /** \brief Compute the output points in parallel over indices_, with up to threads_ threads of the
+        * pcl::parallel pool taking chunks of contiguous indices in turn.
+        * \param[in,out] output the output dataset, already resized; its is_dense flag is cleared if
+        * \a compute_point fails for any point
+        * \param[in] compute_point called as compute_point (idx, nn_indices, nn_dists, output.points[idx]) for each
+        * position idx in indices_, with search buffers which are private to the calling thread. It returns false if
+        * the feature could not be computed for the point (i.e. the output point holds NaN values). It is called
+        * concurrently, so it must not modify the estimator. The first exception it throws is thrown again once
+        * all the threads are done.
+        */
+      template <typename ComputePointFunctor> void
+      computeFeatureParallel (PointCloudOut &output, const ComputePointFunctor &compute_point) const;
+
       /** \brief Search for k-nearest neighbors using the spatial locator from
         * \a setSearchmethod, and the given surface from \a setSearchSurface.
         * \param[in] index the index of the query point
@@ -42,6 +42,7 @@
 
 #include <pcl/features/feature.h>
 #include <set>
+#include <vector>
 
 namespace pcl
 {
@@ -85,6 +86,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::getClassName;
       using Feature<PointInT, PointOutT>::indices_;
       using Feature<PointInT, PointOutT>::k_;
+      using Feature<PointInT, PointOutT>::search_radius_;
       using Feature<PointInT, PointOutT>::search_parameter_;
       using Feature<PointInT, PointOutT>::input_;
       using Feature<PointInT, PointOutT>::surface_;
@@ -95,7 +97,8 @@ namespace pcl
       /** \brief Empty constructor. */
       FPFHEstimation () : 
         nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), 
-        d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI)))
+        d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI))),
+        fast_atan2_ (false)
       {
         feature_name_ = "FPFHEstimation";
       };
@@ -177,8 +180,60 @@ namespace pcl
         nr_bins_f3 = nr_bins_f3_;
       }
 
+      /** \brief Set whether the first angular feature is computed with the polynomial approximation
+        * pcl::fastAtan2 instead of std::atan2 (default: false). The approximation error (about 1e-5 rad) is far
+        * below the width of a histogram bin, so the resulting histograms are practically the same.
+        * \param[in] fast_atan2 true to use the approximation
+        */
+      inline void
+      setUseFastAtan2 (bool fast_atan2) { fast_atan2_ = fast_atan2; }
+
+      /** \brief Get whether the first angular feature is computed with pcl::fastAtan2. */
+      inline bool
+      getUseFastAtan2 () const { return (fast_atan2_); }
+
+      /** \brief Estimate the FPFH descriptors for several search radii at once, using the input cloud, indices,
+        * search surface and normals given as for compute (). The neighborhoods and the pair features are computed
+        * only once, for the largest radius, and then shared by the SPFH signatures of all the radii. The
+        * results are the same as calling compute () once per radius. The radii are processed with the number of
+        * threads set through setNumberOfThreads ().
+        * \note The number of neighbors (setKSearch ()) and the search radius (setRadiusSearch ()) are ignored.
+        * \param[in] radii the search radii, all positive
+        * \param[out] outputs the resultant FPFH descriptors, one point cloud per radius
+        */
+      void
+      computeMultiRadius (const std::vector<double> &radii, std::vector<PointCloudOut> &outputs)
+      {
+        computeMultiRadiusFeatures (radii, outputs, this->threads_);
+      }
+
     protected:
 
+      /** \brief Compute the pair features between a point and each of its neighbors, and the histogram bins
+        * they fall in.
+        * \param[in] cloud the dataset containing the XYZ Cartesian coordinates of the points
+        * \param[in] normals the dataset containing the surface normals at each point in \a cloud
+        * \param[in] p_idx the index of the query point (source)
+        * \param[in] indices the neighborhood point indices in the dataset
+        * \param[in] nr_bins_f1 number of subdivisions for the first angular feature
+        * \param[in] nr_bins_f2 number of subdivisions for the second angular feature
+        * \param[in] nr_bins_f3 number of subdivisions for the third angular feature
+        * \param[out] bins the f1, f2 and f3 bins of each neighbor, in that order; -1 for the query point itself
+        */
+      void
+      computePairFeatureBins (const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
+                              int p_idx, const std::vector<int> &indices,
+                              int nr_bins_f1, int nr_bins_f2, int nr_bins_f3, std::vector<int> &bins) const;
+
+      /** \brief Estimate the FPFH descriptors for several search radii, see computeMultiRadius ().
+        * \param[in] radii the search radii, all positive
+        * \param[out] outputs the resultant FPFH descriptors, one point cloud per radius
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
+        */
+      void
+      computeMultiRadiusFeatures (const std::vector<double> &radii, std::vector<PointCloudOut> &outputs,
+                                  unsigned int nr_threads);
+
       /** \brief Estimate the set of all SPFH (Simple Point Feature Histograms) signatures for the input cloud
         * \param[out] spf_hist_lookup a lookup table for all the SPF feature indices
         * \param[out] hist_f1 the resultant SPFH histogram for feature f1
@@ -214,6 +269,9 @@ namespace pcl
 
       /** \brief Float constant = 1.0 / (2.0 * M_PI) */
       float d_pi_; 
+
+      /** \brief Whether to compute the first angular feature with pcl::fastAtan2. */
+      bool fast_atan2_;
   };
 }
 
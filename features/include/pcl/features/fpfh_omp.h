@@ -46,7 +46,7 @@
 namespace pcl
 {
   /** \brief FPFHEstimationOMP estimates the Fast Point Feature Histogram (FPFH) descriptor for a given point cloud
-    * dataset containing points and normals, in parallel, using the OpenMP standard.
+    * dataset containing points and normals, in parallel, with the threads of pcl::parallel.
     *
     * \note If you use this code in any academic work, please cite:
     *
@@ -83,6 +83,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::search_parameter_;
       using Feature<PointInT, PointOutT>::input_;
       using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::threads_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FPFHEstimation<PointInT, PointNT, PointOutT>::hist_f1_;
       using FPFHEstimation<PointInT, PointNT, PointOutT>::hist_f2_;
@@ -92,21 +93,15 @@ namespace pcl
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
 
       /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
         */
       FPFHEstimationOMP (unsigned int nr_threads = 0) : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11)
       {
         feature_name_ = "FPFHEstimationOMP";
 
-        setNumberOfThreads(nr_threads);
+        this->setNumberOfThreads (nr_threads);
       }
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      void
-      setNumberOfThreads (unsigned int nr_threads = 0);
-
     private:
       /** \brief Estimate the Fast Point Feature Histograms (FPFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
@@ -119,9 +114,6 @@ namespace pcl
     public:
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_bins_f1_, nr_bins_f2_, nr_bins_f3_;
-    private:
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
   };
 }
 
@@ -132,6 +132,19 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::initCompute ()
 template <typename PointInT, typename PointNT, typename PointOutT> bool
 pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
     std::size_t index, const pcl::PointCloud<PointNT> &normals, float rf[9], std::vector<float> &desc)
+{
+  Eigen::Vector3f random_axis;
+  random_axis[0] = rnd ();
+  random_axis[1] = rnd ();
+  random_axis[2] = rnd ();
+  return (computePoint (index, normals, random_axis, rf, desc));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
+    std::size_t index, const pcl::PointCloud<PointNT> &normals, const Eigen::Vector3f &random_axis,
+    float rf[9], std::vector<float> &desc) const
 {
   // The RF is formed as this x_axis | y_axis | normal
   Eigen::Map<Eigen::Vector3f> x_axis (rf);
@@ -159,9 +172,7 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
   normal = normals[minIndex].getNormalVector3fMap ();
 
   // Compute and store the RF direction
-  x_axis[0] = rnd ();
-  x_axis[1] = rnd ();
-  x_axis[2] = rnd ();
+  x_axis = random_axis;
   if (!pcl::utils::equal (normal[2], 0.0f))
     x_axis[2] = - (normal[0]*x_axis[0] + normal[1]*x_axis[1]) / normal[2];
   else if (!pcl::utils::equal (normal[1], 0.0f))
@@ -251,26 +262,36 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computeFeature (Poi
   assert (descriptor_length_ == 1980);
 
   output.is_dense = true;
-  // Iterate over all points and compute the descriptors
-	for (std::size_t point_index = 0; point_index < indices_->size (); point_index++)
+
+  // Draw the directions the X axes are derived from in order, so that the descriptors do not depend on the
+  // number of threads
+  std::vector<Eigen::Vector3f> random_axes (indices_->size ());
+  for (auto &random_axis : random_axes)
   {
-    //output[point_index].descriptor.resize (descriptor_length_);
+    random_axis[0] = rnd ();
+    random_axis[1] = rnd ();
+    random_axis[2] = rnd ();
+  }
 
+  // Iterate over all points and compute the descriptors
+  const auto compute_point = [this, &random_axes] (std::size_t point_index, std::vector<int> &, std::vector<float> &,
+                                                   PointOutT &point_out)
+  {
     // If the point is not finite, set the descriptor to NaN and continue
     if (!isFinite ((*input_)[(*indices_)[point_index]]))
     {
-      std::fill (output[point_index].descriptor, output[point_index].descriptor + descriptor_length_,
+      std::fill (point_out.descriptor, point_out.descriptor + descriptor_length_,
                  std::numeric_limits<float>::quiet_NaN ());
-      std::fill (output[point_index].rf, output[point_index].rf + 9, 0);
-      output.is_dense = false;
-      continue;
+      std::fill (point_out.rf, point_out.rf + 9, 0);
+      return (false);
     }
 
     std::vector<float> descriptor (descriptor_length_);
-    if (!computePoint (point_index, *normals_, output[point_index].rf, descriptor))
-      output.is_dense = false;
-    std::copy (descriptor.begin (), descriptor.end (), output[point_index].descriptor);
-  }
+    const bool valid = computePoint (point_index, *normals_, random_axes[point_index], point_out.rf, descriptor);
+    std::copy (descriptor.begin (), descriptor.end (), point_out.descriptor);
+    return (valid);
+  };
+  this->computeFeatureParallel (output, compute_point);
 }
 
 #define PCL_INSTANTIATE_ShapeContext3DEstimation(T,NT,OutT) template class PCL_EXPORTS pcl::ShapeContext3DEstimation<T,NT,OutT>;
@@ -41,9 +41,9 @@
 #ifndef PCL_FEATURES_IMPL_FEATURE_H_
 #define PCL_FEATURES_IMPL_FEATURE_H_
 
+#include <pcl/common/parallel.h>
 #include <pcl/search/pcl_search.h>
 
-
 namespace pcl
 {
 
@@ -115,7 +115,17 @@ Feature<PointInT, PointOutT>::initCompute ()
     surface_ = input_;
   }
 
-  // Check if a space search locator was given
+  const bool use_neighborhoods = neighborhoods_ &&
+                                 neighborhoods_->isCompatible (input_, surface_, search_radius_, k_);
+  if (neighborhoods_ && !use_neighborhoods)
+    PCL_WARN ("[pcl::%s::initCompute] The precomputed neighborhoods do not match the input, the search surface or the search parameter, searching the neighbors instead.\n", getClassName ().c_str ());
+
+  // Check if a space search locator was given, otherwise reuse the one of the precomputed neighborhoods
+  if (!tree_ && use_neighborhoods)
+  {
+    fake_tree_ = true;
+    tree_ = neighborhoods_->getSearchMethod ();
+  }
   if (!tree_)
   {
     if (surface_->isOrganized () && input_->isOrganized ())
@@ -172,6 +182,23 @@ Feature<PointInT, PointOutT>::initCompute ()
       return (false);
     }
   }
+
+  // Look the neighbors of the input points up in the precomputed neighborhoods, and search the others
+  if (use_neighborhoods)
+  {
+    const SearchMethodSurface search_method = search_method_surface_;
+    search_method_surface_ = [this, search_method] (const PointCloudIn &cloud, std::size_t index, double parameter,
+                                                    std::vector<int> &k_indices, std::vector<float> &k_distances)
+    {
+      if (&cloud == input_.get ())
+      {
+        const int nr_neighbors = neighborhoods_->getNeighbors (index, parameter, k_indices, k_distances);
+        if (nr_neighbors >= 0)
+          return (nr_neighbors);
+      }
+      return (search_method (cloud, index, parameter, k_indices, k_distances));
+    };
+  }
   return (true);
 }
 
@@ -185,6 +212,12 @@ Feature<PointInT, PointOutT>::deinitCompute ()
     surface_.reset ();
     fake_surface_ = false;
   }
+  // Do not keep the search method of the precomputed neighborhoods, which may not match the next compute ()
+  if (fake_tree_)
+  {
+    tree_.reset ();
+    fake_tree_ = false;
+  }
   return (true);
 }
 
@@ -227,6 +260,37 @@ Feature<PointInT, PointOutT>::compute (PointCloudOut &output)
 }
 
 
+template <typename PointInT, typename PointOutT> void
+Feature<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  threads_ = nr_threads;
+}
+
+
+template <typename PointInT, typename PointOutT> template <typename ComputePointFunctor> void
+Feature<PointInT, PointOutT>::computeFeatureParallel (PointCloudOut &output,
+                                                      const ComputePointFunctor &compute_point) const
+{
+  const bool is_dense = pcl::parallel::parallel_reduce (std::size_t (0), indices_->size (), true,
+    [this, &output, &compute_point] (std::size_t first, std::size_t last)
+    {
+      // Search buffers, reused for all the points of the chunk
+      // \note This resize is irrelevant for a radiusSearch ().
+      std::vector<int> nn_indices (k_);
+      std::vector<float> nn_dists (k_);
+
+      bool chunk_is_dense = true;
+      for (std::size_t idx = first; idx < last; ++idx)
+        if (!compute_point (idx, nn_indices, nn_dists, output.points[idx]))
+          chunk_is_dense = false;
+      return (chunk_is_dense);
+    },
+    [] (bool a, bool b) { return (a && b); }, threads_);
+  if (!is_dense)
+    output.is_dense = false;
+}
+
+
 template <typename PointInT, typename PointNT, typename PointOutT> bool
 FeatureFromNormals<PointInT, PointNT, PointOutT>::initCompute ()
 {
@@ -90,12 +90,8 @@ template<typename PointInT, typename PointNT, typename PointOutT, typename Signe
 template<typename PointInT, typename PointNT, typename PointOutT, typename SignedDistanceT> bool
   pcl::FLARELocalReferenceFrameEstimation<PointInT, PointNT, PointOutT, SignedDistanceT>::deinitCompute ()
 {
-  // Reset the surface
-  if (fake_surface_)
-  {
-    surface_.reset ();
-    fake_surface_ = false;
-  }
+  // Reset the surface and the search method
+  Feature<PointInT, PointOutT>::deinitCompute ();
   // Reset the sampled surface
   if (fake_sampled_surface_)
   {
@@ -42,9 +42,13 @@
 
 #include <pcl/features/fpfh.h>
 
+#include <pcl/common/parallel.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/features/pfh_tools.h>
 
+#include <algorithm>
+#include <numeric>
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> bool
@@ -60,47 +64,91 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computePairFeatures (
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computePairFeatureBins (
     const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
-    int p_idx, int row, const std::vector<int> &indices,
-    Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3)
+    int p_idx, const std::vector<int> &indices,
+    int nr_bins_f1, int nr_bins_f2, int nr_bins_f3, std::vector<int> &bins) const
 {
-  Eigen::Vector4f pfh_tuple;
-  // Get the number of bins from the histograms size
-  // @TODO: use arrays
-  int nr_bins_f1 = static_cast<int> (hist_f1.cols ());
-  int nr_bins_f2 = static_cast<int> (hist_f2.cols ());
-  int nr_bins_f3 = static_cast<int> (hist_f3.cols ());
-
-  // Factorization constant
-  float hist_incr = 100.0f / static_cast<float>(indices.size () - 1);
-
-  // Iterate over all the points in the neighborhood
+  // Gather the neighbors (minus the query point itself) in separate coordinate arrays for the batch kernel
+  const std::size_t nr_neighbors = indices.size ();
+  std::vector<float> data (10 * nr_neighbors);
+  float *x = &data[0], *y = x + nr_neighbors, *z = y + nr_neighbors;
+  float *nx = z + nr_neighbors, *ny = nx + nr_neighbors, *nz = ny + nr_neighbors;
+  float *f1 = nz + nr_neighbors, *f2 = f1 + nr_neighbors, *f3 = f2 + nr_neighbors, *f4 = f3 + nr_neighbors;
+  std::size_t nr_pairs = 0;
   for (const auto &index : indices)
   {
-    // Avoid unnecessary returns
     if (p_idx == index)
-        continue;
+      continue;
+    x[nr_pairs] = cloud.points[index].x;
+    y[nr_pairs] = cloud.points[index].y;
+    z[nr_pairs] = cloud.points[index].z;
+    nx[nr_pairs] = normals.points[index].normal_x;
+    ny[nr_pairs] = normals.points[index].normal_y;
+    nz[nr_pairs] = normals.points[index].normal_z;
+    ++nr_pairs;
+  }
 
-    // Compute the pair P to NNi
-    if (!computePairFeatures (cloud, normals, p_idx, index, pfh_tuple[0], pfh_tuple[1], pfh_tuple[2], pfh_tuple[3]))
-        continue;
+  // Pairs for which the features are undefined get zeros, and are binned as such
+  pcl::computePairFeatures (cloud.points[p_idx].getVector4fMap (), normals.points[p_idx].getNormalVector4fMap (),
+                            nr_pairs, x, y, z, nx, ny, nz, f1, f2, f3, f4, fast_atan2_);
 
-    // Normalize the f1, f2, f3 features and push them in the histogram
-    int h_index = static_cast<int> (std::floor (nr_bins_f1 * ((pfh_tuple[0] + M_PI) * d_pi_)));
+  bins.resize (3 * nr_neighbors);
+  std::size_t pair = 0;
+  for (std::size_t i = 0; i < nr_neighbors; ++i)
+  {
+    if (p_idx == indices[i])
+    {
+      bins[3 * i] = bins[3 * i + 1] = bins[3 * i + 2] = -1;
+      continue;
+    }
+
+    // Normalize the f1, f2, f3 features
+    int h_index = static_cast<int> (std::floor (nr_bins_f1 * ((f1[pair] + M_PI) * d_pi_)));
     if (h_index < 0)           h_index = 0;
     if (h_index >= nr_bins_f1) h_index = nr_bins_f1 - 1;
-    hist_f1 (row, h_index) += hist_incr;
+    bins[3 * i] = h_index;
 
-    h_index = static_cast<int> (std::floor (nr_bins_f2 * ((pfh_tuple[1] + 1.0) * 0.5)));
+    h_index = static_cast<int> (std::floor (nr_bins_f2 * ((f2[pair] + 1.0) * 0.5)));
     if (h_index < 0)           h_index = 0;
     if (h_index >= nr_bins_f2) h_index = nr_bins_f2 - 1;
-    hist_f2 (row, h_index) += hist_incr;
+    bins[3 * i + 1] = h_index;
 
-    h_index = static_cast<int> (std::floor (nr_bins_f3 * ((pfh_tuple[2] + 1.0) * 0.5)));
+    h_index = static_cast<int> (std::floor (nr_bins_f3 * ((f3[pair] + 1.0) * 0.5)));
     if (h_index < 0)           h_index = 0;
     if (h_index >= nr_bins_f3) h_index = nr_bins_f3 - 1;
-    hist_f3 (row, h_index) += hist_incr;
+    bins[3 * i + 2] = h_index;
+    ++pair;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (
+    const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
+    int p_idx, int row, const std::vector<int> &indices,
+    Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3)
+{
+  // Get the number of bins from the histograms size
+  // @TODO: use arrays
+  int nr_bins_f1 = static_cast<int> (hist_f1.cols ());
+  int nr_bins_f2 = static_cast<int> (hist_f2.cols ());
+  int nr_bins_f3 = static_cast<int> (hist_f3.cols ());
+
+  // Factorization constant
+  float hist_incr = 100.0f / static_cast<float>(indices.size () - 1);
+
+  std::vector<int> bins;
+  computePairFeatureBins (cloud, normals, p_idx, indices, nr_bins_f1, nr_bins_f2, nr_bins_f3, bins);
+
+  // Push the pairs of P to all its neighbors in the histograms
+  for (std::size_t i = 0; i < indices.size (); ++i)
+  {
+    if (bins[3 * i] < 0)
+      continue;
+    hist_f1 (row, bins[3 * i]) += hist_incr;
+    hist_f2 (row, bins[3 * i + 1]) += hist_incr;
+    hist_f3 (row, bins[3 * i + 2]) += hist_incr;
   }
 }
 
@@ -301,5 +349,179 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeMultiRadiusFeatures (
+    const std::vector<double> &radii, std::vector<PointCloudOut> &outputs, unsigned int nr_threads)
+{
+  outputs.clear ();
+  if (radii.empty () || *std::min_element (radii.cbegin (), radii.cend ()) <= 0.0)
+  {
+    PCL_ERROR ("[pcl::%s::computeMultiRadius] The search radii must be positive and at least one must be given!\n",
+               getClassName ().c_str ());
+    return;
+  }
+
+  // Search all the neighborhoods once, at the largest radius
+  const int k = k_;
+  const double search_radius = search_radius_;
+  k_ = 0;
+  search_radius_ = *std::max_element (radii.cbegin (), radii.cend ());
+  if (!this->initCompute ())
+  {
+    k_ = k;
+    search_radius_ = search_radius;
+    return;
+  }
+
+  const std::size_t nr_radii = radii.size ();
+  std::vector<float> sqr_radii (nr_radii);
+  for (std::size_t r = 0; r < nr_radii; ++r)
+    sqr_radii[r] = static_cast<float> (radii[r] * radii[r]);
+
+  // Build a list of (unique) indices for which we will need to compute SPFH signatures
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  std::vector<int> spfh_indices_vec;
+  if (surface_ != input_ ||
+      indices_->size () != surface_->points.size ())
+  {
+    std::set<int> spfh_indices_set;
+    for (const auto &p_idx : *indices_)
+    {
+      if (!isFinite ((*input_)[p_idx]) ||
+          this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+        continue;
+      spfh_indices_set.insert (nn_indices.begin (), nn_indices.end ());
+    }
+    spfh_indices_vec.assign (spfh_indices_set.cbegin (), spfh_indices_set.cend ());
+  }
+  else
+  {
+    spfh_indices_vec.resize (indices_->size ());
+    std::iota (spfh_indices_vec.begin (), spfh_indices_vec.end (), 0);
+  }
+
+  // One set of SPFH signatures per radius, sharing the pair features computed at the largest radius
+  const std::size_t data_size = spfh_indices_vec.size ();
+  std::vector<Eigen::MatrixXf> hist_f1 (nr_radii), hist_f2 (nr_radii), hist_f3 (nr_radii);
+  for (std::size_t r = 0; r < nr_radii; ++r)
+  {
+    hist_f1[r].setZero (data_size, nr_bins_f1_);
+    hist_f2[r].setZero (data_size, nr_bins_f2_);
+    hist_f3[r].setZero (data_size, nr_bins_f3_);
+  }
+  std::vector<int> spfh_hist_lookup (surface_->points.size ());
+
+  pcl::parallel::parallel_for (std::size_t (0), data_size, [&] (std::size_t first, std::size_t last)
+  {
+    std::vector<int> nn_indices, bins;
+    std::vector<float> nn_dists;
+    for (std::size_t i = first; i < last; ++i)
+    {
+      const int p_idx = spfh_indices_vec[i];
+      if (!isFinite ((*surface_)[p_idx]) ||
+          this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+        continue;
+
+      computePairFeatureBins (*surface_, *normals_, p_idx, nn_indices, nr_bins_f1_, nr_bins_f2_, nr_bins_f3_, bins);
+
+      for (std::size_t r = 0; r < nr_radii; ++r)
+      {
+        const auto nr_neighbors = std::count_if (nn_dists.cbegin (), nn_dists.cend (),
+                                                 [&] (float dist) { return (dist <= sqr_radii[r]); });
+        if (nr_neighbors < 2)
+          continue;
+        const float hist_incr = 100.0f / static_cast<float> (nr_neighbors - 1);
+        for (std::size_t j = 0; j < nn_indices.size (); ++j)
+        {
+          if (bins[3 * j] < 0 || nn_dists[j] > sqr_radii[r])
+            continue;
+          hist_f1[r] (i, bins[3 * j]) += hist_incr;
+          hist_f2[r] (i, bins[3 * j + 1]) += hist_incr;
+          hist_f3[r] (i, bins[3 * j + 2]) += hist_incr;
+        }
+      }
+
+      spfh_hist_lookup[p_idx] = static_cast<int> (i);
+    }
+  }, nr_threads);
+
+  // Set the output clouds up as compute () does
+  const int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+  outputs.resize (nr_radii);
+  for (auto &output : outputs)
+  {
+    output.header = input_->header;
+    output.points.resize (indices_->size ());
+    if (indices_->size () != input_->points.size () || input_->width * input_->height == 0)
+    {
+      output.width = static_cast<std::uint32_t> (indices_->size ());
+      output.height = 1;
+    }
+    else
+    {
+      output.width = input_->width;
+      output.height = input_->height;
+    }
+    output.is_dense = true;
+  }
+
+  // Whether each output is dense, combined over the chunks
+  const std::vector<bool> is_dense = pcl::parallel::parallel_reduce (std::size_t (0), indices_->size (),
+    std::vector<bool> (nr_radii, true),
+    [&] (std::size_t first, std::size_t last)
+    {
+      std::vector<int> nn_indices, radius_indices;
+      std::vector<float> nn_dists, radius_dists;
+      std::vector<bool> chunk_is_dense (nr_radii, true);
+      Eigen::VectorXf fpfh_histogram;
+      for (std::size_t idx = first; idx < last; ++idx)
+      {
+        if (!isFinite ((*input_)[(*indices_)[idx]]) ||
+            this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+          nn_indices.clear ();
+
+        for (std::size_t r = 0; r < nr_radii; ++r)
+        {
+          // Keep the neighbors within this radius, as row indices in the spfh_hist_* matrices
+          radius_indices.clear ();
+          radius_dists.clear ();
+          for (std::size_t j = 0; j < nn_indices.size (); ++j)
+          {
+            if (nn_dists[j] > sqr_radii[r])
+              continue;
+            radius_indices.push_back (spfh_hist_lookup[nn_indices[j]]);
+            radius_dists.push_back (nn_dists[j]);
+          }
+
+          auto &point = outputs[r].points[idx];
+          if (radius_indices.empty ())
+          {
+            std::fill_n (point.histogram, nr_bins, std::numeric_limits<float>::quiet_NaN ());
+            chunk_is_dense[r] = false;
+            continue;
+          }
+
+          weightPointSPFHSignature (hist_f1[r], hist_f2[r], hist_f3[r], radius_indices, radius_dists, fpfh_histogram);
+          std::copy_n (fpfh_histogram.data (), nr_bins, point.histogram);
+        }
+      }
+      return (chunk_is_dense);
+    },
+    [] (std::vector<bool> a, const std::vector<bool> &b)
+    {
+      for (std::size_t r = 0; r < a.size (); ++r)
+        a[r] = a[r] && b[r];
+      return (a);
+    }, nr_threads);
+  for (std::size_t r = 0; r < nr_radii; ++r)
+    outputs[r].is_dense = is_dense[r];
+
+  k_ = k;
+  search_radius_ = search_radius;
+  this->deinitCompute ();
+}
+
 #define PCL_INSTANTIATE_FPFHEstimation(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimation<T,NT,OutT>;
 
@@ -42,25 +42,12 @@
 
 #include <pcl/features/fpfh_omp.h>
 
+#include <pcl/common/parallel.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
 #include <numeric>
 
 
-//////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
-{
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
-}
-
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -103,73 +90,62 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
   hist_f2_.setZero (data_size, nr_bins_f2_);
   hist_f3_.setZero (data_size, nr_bins_f3_);
 
-  std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-  std::vector<float> nn_dists (k_); 
-
   // Compute SPFH signatures for every point that needs them
-
-#pragma omp parallel for \
-  default(none) \
-  shared(spfh_hist_lookup, spfh_indices_vec) \
-  firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
-  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (spfh_indices_vec.size ()); ++i)
-  {
-    // Get the next point index
-    int p_idx = spfh_indices_vec[i];
-
-    // Find the neighborhood around p_idx
-    if (!isFinite ((*input_)[p_idx]) ||
-        this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-      continue;
-
-    // Estimate the SPFH signature around p_idx
-    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1_, hist_f2_, hist_f3_);
-
-    // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
-    spfh_hist_lookup[p_idx] = i;
-  }
+  pcl::parallel::parallel_for (std::size_t (0), spfh_indices_vec.size (),
+    [&] (std::size_t first, std::size_t last)
+    {
+      std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
+      std::vector<float> nn_dists (k_);
+      for (std::size_t i = first; i < last; ++i)
+      {
+        // Get the next point index
+        int p_idx = spfh_indices_vec[i];
+
+        // Find the neighborhood around p_idx
+        if (!isFinite ((*input_)[p_idx]) ||
+            this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+          continue;
+
+        // Estimate the SPFH signature around p_idx
+        this->computePointSPFHSignature (*surface_, *normals_, p_idx, static_cast<int> (i), nn_indices,
+                                         hist_f1_, hist_f2_, hist_f3_);
+
+        // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
+        spfh_hist_lookup[p_idx] = static_cast<int> (i);
+      }
+    }, threads_);
 
   // Initialize the array that will store the FPFH signature
-  int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
-
-  nn_indices.clear();
-  nn_dists.clear();
+  const int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
 
   // Iterate over the entire index vector
-#pragma omp parallel for \
-  default(none) \
-  shared(nr_bins, output, spfh_hist_lookup) \
-  firstprivate(nn_dists, nn_indices) \
-  num_threads(threads_)
-  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+  const auto compute_point = [this, nr_bins, &spfh_hist_lookup] (std::size_t idx, std::vector<int> &nn_indices,
+                                                                std::vector<float> &nn_dists, PointOutT &point_out)
   {
     // Find the indices of point idx's neighbors...
     if (!isFinite ((*input_)[(*indices_)[idx]]) ||
         this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
     {
       for (int d = 0; d < nr_bins; ++d)
-        output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
-
-      output.is_dense = false;
-      continue;
+        point_out.histogram[d] = std::numeric_limits<float>::quiet_NaN ();
+      return (false);
     }
 
-
-    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
+    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices
     // instead of indices into surface_->points
     for (int &nn_index : nn_indices)
       nn_index = spfh_hist_lookup[nn_index];
 
     // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
+    Eigen::VectorXf fpfh_histogram;
     weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
 
     // ...and copy it into the output cloud
     for (int d = 0; d < nr_bins; ++d)
-      output.points[idx].histogram[d] = fpfh_histogram[d];
-  }
-
+      point_out.histogram[d] = fpfh_histogram[d];
+    return (true);
+  };
+  this->computeFeatureParallel (output, compute_point);
 }
 
 #define PCL_INSTANTIATE_FPFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimationOMP<T,NT,OutT>;
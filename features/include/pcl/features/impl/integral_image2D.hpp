@@ -41,12 +41,62 @@
 #ifndef PCL_INTEGRAL_IMAGE2D_IMPL_H_
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
-#include <cstddef>
+#include <pcl/common/parallel.h>
 
+#include <algorithm>
+#include <cstddef>
 
 namespace pcl
 {
 
+namespace detail
+{
+
+/** \brief Call \a process_tile (row_begin, row_end, col_begin, col_end) on all the tiles of a
+  * width x height image, such that the tiles above and to the left of a tile have been processed
+  * before it. This is all the integral image recurrence needs, so the tiles on an anti-diagonal
+  * are processed in parallel, and the result does not depend on the number of threads.
+  */
+template <typename TileFunction> void
+forEachIntegralImageTile (unsigned width, unsigned height, unsigned int nr_threads, const TileFunction &process_tile)
+{
+  if (pcl::parallel::detail::getNumberOfThreads (nr_threads) <= 1)
+  {
+    process_tile (0, height, 0, width);
+    return;
+  }
+
+  const unsigned tile_size = 64;
+  const int tile_rows = static_cast<int> ((height + tile_size - 1) / tile_size);
+  const int tile_cols = static_cast<int> ((width + tile_size - 1) / tile_size);
+
+  // Each anti-diagonal is one loop, so it only starts once the previous one is done
+  for (int diagonal = 0; diagonal < tile_rows + tile_cols - 1; ++diagonal)
+  {
+    const int first_row = (std::max) (0, diagonal - tile_cols + 1);
+    const int last_row = (std::min) (diagonal, tile_rows - 1);
+    pcl::parallel::parallel_for (first_row, last_row + 1, [&] (int first, int last)
+    {
+      for (int tile_row = first; tile_row < last; ++tile_row)
+      {
+        const unsigned row_begin = tile_row * tile_size;
+        const unsigned col_begin = (diagonal - tile_row) * tile_size;
+        process_tile (row_begin, (std::min) (row_begin + tile_size, height),
+                      col_begin, (std::min) (col_begin + tile_size, width));
+      }
+    }, nr_threads, 1);
+  }
+}
+
+} // namespace detail
+
+template <typename DataType, unsigned Dimension> void
+IntegralImage2D<DataType, Dimension>::setNumberOfThreads (unsigned int nr_threads)
+{
+  threads_ = nr_threads;
+}
+
+
 template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_second_order_integral_images)
 {
@@ -158,68 +208,79 @@ template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  const unsigned stride = width_ + 1;
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
 
-  if (!compute_second_order_integral_images_)
+  auto process_tile = [&] (unsigned row_begin, unsigned row_end, unsigned col_begin, unsigned col_end)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    for (unsigned rowIdx = row_begin; rowIdx < row_end; ++rowIdx)
     {
-      current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      const DataType* row_data = data + static_cast<std::size_t> (rowIdx) * row_stride;
+      ElementType* previous_row = &first_order_integral_image_[rowIdx * stride];
+      ElementType* current_row  = previous_row + stride;
+      unsigned* count_previous_row = &finite_values_integral_image_[rowIdx * stride];
+      unsigned* count_current_row  = count_previous_row + stride;
+
+      if (!compute_second_order_integral_images_)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (std::isfinite (element->sum ()))
+        if (col_begin == 0)
+        {
+          current_row [0].setZero ();
+          count_current_row [0] = 0;
+        }
+        for (unsigned colIdx = col_begin, valIdx = col_begin * element_stride; colIdx < col_end; ++colIdx, valIdx += element_stride)
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+          const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
+          if (std::isfinite (element->sum ()))
+          {
+            current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+            ++(count_current_row [colIdx + 1]);
+          }
         }
       }
-    }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
-    {
-      current_row [0].setZero ();
-      so_current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      else
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (std::isfinite (element->sum ()))
+        SecondOrderType* so_previous_row = &second_order_integral_image_[rowIdx * stride];
+        SecondOrderType* so_current_row  = so_previous_row + stride;
+        if (col_begin == 0)
+        {
+          current_row [0].setZero ();
+          so_current_row [0].setZero ();
+          count_current_row [0] = 0;
+        }
+        for (unsigned colIdx = col_begin, valIdx = col_begin * element_stride; colIdx < col_end; ++colIdx, valIdx += element_stride)
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
-          for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
-            for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
-              so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+
+          const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
+          if (std::isfinite (element->sum ()))
+          {
+            current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+            ++(count_current_row [colIdx + 1]);
+            for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
+              for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
+                so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+          }
         }
       }
     }
-  }
+  };
+
+  detail::forEachIntegralImageTile (width_, height_, threads_, process_tile);
+}
+
+
+template <typename DataType> void
+IntegralImage2D<DataType, 1>::setNumberOfThreads (unsigned int nr_threads)
+{
+  threads_ = nr_threads;
 }
 
 
@@ -327,62 +388,67 @@ template <typename DataType> void
 IntegralImage2D<DataType, 1>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  const unsigned stride = width_ + 1;
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
 
-  if (!compute_second_order_integral_images_)
+  auto process_tile = [&] (unsigned row_begin, unsigned row_end, unsigned col_begin, unsigned col_end)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    for (unsigned rowIdx = row_begin; rowIdx < row_end; ++rowIdx)
     {
-      current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      const DataType* row_data = data + static_cast<std::size_t> (rowIdx) * row_stride;
+      ElementType* previous_row = &first_order_integral_image_[rowIdx * stride];
+      ElementType* current_row  = previous_row + stride;
+      unsigned* count_previous_row = &finite_values_integral_image_[rowIdx * stride];
+      unsigned* count_current_row  = count_previous_row + stride;
+
+      if (!compute_second_order_integral_images_)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data [valIdx]))
+        if (col_begin == 0)
         {
-          current_row [colIdx + 1] += data [valIdx];
-          ++(count_current_row [colIdx + 1]);
+          current_row [0] = 0.0;
+          count_current_row [0] = 0;
+        }
+        for (unsigned colIdx = col_begin, valIdx = col_begin * element_stride; colIdx < col_end; ++colIdx, valIdx += element_stride)
+        {
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+          if (std::isfinite (row_data [valIdx]))
+          {
+            current_row [colIdx + 1] += row_data [valIdx];
+            ++(count_current_row [colIdx + 1]);
+          }
         }
       }
-    }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
-    {
-      current_row [0] = 0.0;
-      so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      else
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data[valIdx]))
+        SecondOrderType* so_previous_row = &second_order_integral_image_[rowIdx * stride];
+        SecondOrderType* so_current_row  = so_previous_row + stride;
+        if (col_begin == 0)
+        {
+          current_row [0] = 0.0;
+          so_current_row [0] = 0.0;
+          count_current_row [0] = 0;
+        }
+        for (unsigned colIdx = col_begin, valIdx = col_begin * element_stride; colIdx < col_end; ++colIdx, valIdx += element_stride)
         {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
-          ++(count_current_row [colIdx + 1]);
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+          if (std::isfinite (row_data [valIdx]))
+          {
+            current_row [colIdx + 1] += row_data [valIdx];
+            so_current_row [colIdx + 1] += row_data [valIdx] * row_data [valIdx];
+            ++(count_current_row [colIdx + 1]);
+          }
         }
       }
     }
-  }
+  };
+
+  detail::forEachIntegralImageTile (width_, height_, threads_, process_tile);
 }
 
 } // namespace pcl
@@ -40,6 +40,7 @@
 #define PCL_FEATURES_INTEGRALIMAGE_BASED_IMPL_NORMAL_ESTIMATOR_H_
 
 #include <pcl/features/integral_image_normal.h>
+#include <pcl/common/parallel.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT>
@@ -67,6 +68,12 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initData ()
     PCL_THROW_EXCEPTION (InitFailedException,
                          "[pcl::IntegralImageNormalEstimation::initData] unknown normal estimation method.");
 
+  // The integral images are built with as many threads as the normals
+  integral_image_DX_.setNumberOfThreads (threads_);
+  integral_image_DY_.setNumberOfThreads (threads_);
+  integral_image_depth_.setNumberOfThreads (threads_);
+  integral_image_XYZ_.setNumberOfThreads (threads_);
+
   // compute derivatives
   delete[] diff_x_;
   delete[] diff_y_;
@@ -150,33 +157,37 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::initAverage3DGradientMe
   // x u x
   // l x r
   // x d x
-  const PointInT* point_up = &(input_->points [1]);
-  const PointInT* point_dn = point_up + (input_->width << 1);//&(input_->points [1 + (input_->width << 1)]);
-  const PointInT* point_lf = &(input_->points [input_->width]);
-  const PointInT* point_rg = point_lf + 2; //&(input_->points [input_->width + 2]);
-  float* diff_x_ptr = diff_x_ + ((input_->width + 1) << 2);
-  float* diff_y_ptr = diff_y_ + ((input_->width + 1) << 2);
-  unsigned diff_skip = 8; // skip last element in row and the first in the next row
-
-  for (std::size_t ri = 1; ri < input_->height - 1; ++ri
-                                             , point_up += input_->width
-                                             , point_dn += input_->width
-                                             , point_lf += input_->width
-                                             , point_rg += input_->width
-                                             , diff_x_ptr += diff_skip
-                                             , diff_y_ptr += diff_skip)
+  // (the first and last element of each row are skipped)
+  const PointInT* first_point_up = &(input_->points [1]);
+  const PointInT* first_point_dn = first_point_up + (input_->width << 1);
+  const PointInT* first_point_lf = &(input_->points [input_->width]);
+  const PointInT* first_point_rg = first_point_lf + 2;
+  float* first_diff_x = diff_x_ + ((input_->width + 1) << 2);
+  float* first_diff_y = diff_y_ + ((input_->width + 1) << 2);
+
+  pcl::parallel::parallel_for (1, static_cast<int> (input_->height) - 1, [&] (int first, int last)
   {
-    for (std::size_t ci = 0; ci < input_->width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
+    for (int ri = first; ri < last; ++ri)
     {
-      diff_x_ptr[0] = point_rg[ci].x - point_lf[ci].x;
-      diff_x_ptr[1] = point_rg[ci].y - point_lf[ci].y;
-      diff_x_ptr[2] = point_rg[ci].z - point_lf[ci].z;
+      const std::size_t row_offset = (ri - 1) * static_cast<std::size_t> (input_->width);
+      const PointInT* point_up = first_point_up + row_offset;
+      const PointInT* point_dn = first_point_dn + row_offset;
+      const PointInT* point_lf = first_point_lf + row_offset;
+      const PointInT* point_rg = first_point_rg + row_offset;
+      float* diff_x_ptr = first_diff_x + (row_offset << 2);
+      float* diff_y_ptr = first_diff_y + (row_offset << 2);
+      for (std::size_t ci = 0; ci < input_->width - 2; ++ci, diff_x_ptr += 4, diff_y_ptr += 4)
+      {
+        diff_x_ptr[0] = point_rg[ci].x - point_lf[ci].x;
+        diff_x_ptr[1] = point_rg[ci].y - point_lf[ci].y;
+        diff_x_ptr[2] = point_rg[ci].z - point_lf[ci].z;
 
-      diff_y_ptr[0] = point_dn[ci].x - point_up[ci].x;
-      diff_y_ptr[1] = point_dn[ci].y - point_up[ci].y;
-      diff_y_ptr[2] = point_dn[ci].z - point_up[ci].z;
+        diff_y_ptr[0] = point_dn[ci].x - point_up[ci].x;
+        diff_y_ptr[1] = point_dn[ci].y - point_up[ci].y;
+        diff_y_ptr[2] = point_dn[ci].z - point_up[ci].z;
+      }
     }
-  }
+  }, threads_);
 
   // Compute integral images
   integral_image_DX_.setInput (diff_x_, input_->width, input_->height, 4, input_->width << 2);
@@ -207,6 +218,19 @@ template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal)
 {
+  computePointNormal (pos_x, pos_y, point_index, rect_width_, rect_height_, normal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
+    const int pos_x, const int pos_y, const unsigned point_index,
+    const int rect_width, const int rect_height, PointOutT &normal)
+{
+  const int rect_width_2 = rect_width / 2;
+  const int rect_width_4 = rect_width / 4;
+  const int rect_height_2 = rect_height / 2;
+  const int rect_height_4 = rect_height / 4;
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
   if (normal_estimation_method_ == COVARIANCE_MATRIX)
@@ -214,7 +238,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     if (!init_covariance_matrix_)
       initCovarianceMatrixMethod ();
 
-    unsigned count = integral_image_XYZ_.getFiniteElementsCount (pos_x - (rect_width_2_), pos_y - (rect_height_2_), rect_width_, rect_height_);
+    unsigned count = integral_image_XYZ_.getFiniteElementsCount (pos_x - (rect_width_2), pos_y - (rect_height_2), rect_width, rect_height);
 
     // no valid points within the rectangular region?
     if (count == 0)
@@ -226,8 +250,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
     Eigen::Vector3f center;
     typename IntegralImage2D<float, 3>::SecondOrderType so_elements;
-    center = integral_image_XYZ_.getFirstOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_).template cast<float> ();
-    so_elements = integral_image_XYZ_.getSecondOrderSum(pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    center = integral_image_XYZ_.getFirstOrderSum(pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height).template cast<float> ();
+    so_elements = integral_image_XYZ_.getSecondOrderSum(pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
 
     covariance_matrix.coeffRef (0) = static_cast<float> (so_elements [0]);
     covariance_matrix.coeffRef (1) = covariance_matrix.coeffRef (3) = static_cast<float> (so_elements [1]);
@@ -255,15 +279,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
     if (!init_average_3d_gradient_)
       initAverage3DGradientMethod ();
 
-    unsigned count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    unsigned count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    unsigned count_x = integral_image_DX_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    unsigned count_y = integral_image_DY_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
     if (count_x == 0 || count_y == 0)
     {
       normal.normal_x = normal.normal_y = normal.normal_z = normal.curvature = bad_point;
       return;
     }
-    Eigen::Vector3d gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
-    Eigen::Vector3d gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, rect_height_);
+    Eigen::Vector3d gradient_x = integral_image_DX_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
+    Eigen::Vector3d gradient_y = integral_image_DY_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, rect_height);
 
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
@@ -294,10 +318,10 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
       initAverageDepthChangeMethod ();
 
     // width and height are at least 3 x 3
-    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_);
-    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_);
-    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_);
+    unsigned count_L_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_R_z = integral_image_depth_.getFiniteElementsCount (pos_x + 1            , pos_y - rect_height_4, rect_width_2, rect_height_2);
+    unsigned count_U_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2);
+    unsigned count_D_z = integral_image_depth_.getFiniteElementsCount (pos_x - rect_width_4, pos_y + 1             , rect_width_2, rect_height_2);
 
     if (count_L_z == 0 || count_R_z == 0 || count_U_z == 0 || count_D_z == 0)
     {
@@ -305,15 +329,15 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
       return;
     }
 
-    float mean_L_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_L_z);
-    float mean_R_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x + 1            , pos_y - rect_height_4_, rect_width_2_, rect_height_2_) / count_R_z);
-    float mean_U_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y - rect_height_2_, rect_width_2_, rect_height_2_) / count_U_z);
-    float mean_D_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4_, pos_y + 1             , rect_width_2_, rect_height_2_) / count_D_z);
+    float mean_L_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_4, rect_width_2, rect_height_2) / count_L_z);
+    float mean_R_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x + 1            , pos_y - rect_height_4, rect_width_2, rect_height_2) / count_R_z);
+    float mean_U_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y - rect_height_2, rect_width_2, rect_height_2) / count_U_z);
+    float mean_D_z = static_cast<float> (integral_image_depth_.getFirstOrderSum (pos_x - rect_width_4, pos_y + 1             , rect_width_2, rect_height_2) / count_D_z);
 
-    PointInT pointL = input_->points[point_index - rect_width_4_ - 1];
-    PointInT pointR = input_->points[point_index + rect_width_4_ + 1];
-    PointInT pointU = input_->points[point_index - rect_height_4_ * input_->width - 1];
-    PointInT pointD = input_->points[point_index + rect_height_4_ * input_->width + 1];
+    PointInT pointL = input_->points[point_index - rect_width_4 - 1];
+    PointInT pointR = input_->points[point_index + rect_width_4 + 1];
+    PointInT pointU = input_->points[point_index - rect_height_4 * input_->width - 1];
+    PointInT pointD = input_->points[point_index + rect_height_4 * input_->width + 1];
 
     const float mean_x_z = mean_R_z - mean_L_z;
     const float mean_y_z = mean_D_z - mean_U_z;
@@ -353,11 +377,11 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormal (
       initSimple3DGradientMethod ();
 
     // this method does not work if lots of NaNs are in the neighborhood of the point
-    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2_, pos_y - rect_height_2_, 1, rect_height_) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, 1, rect_height_);
+    Eigen::Vector3d gradient_x = integral_image_XYZ_.getFirstOrderSum (pos_x + rect_width_2, pos_y - rect_height_2, 1, rect_height) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, 1, rect_height);
 
-    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y + rect_height_2_, rect_width_, 1) -
-                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2_, pos_y - rect_height_2_, rect_width_, 1);
+    Eigen::Vector3d gradient_y = integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y + rect_height_2, rect_width, 1) -
+                                 integral_image_XYZ_.getFirstOrderSum (pos_x - rect_width_2, pos_y - rect_height_2, rect_width, 1);
     Eigen::Vector3d normal_vector = gradient_y.cross (gradient_x);
     double normal_length = normal_vector.squaredNorm ();
     if (normal_length == 0.0f)
@@ -462,6 +486,19 @@ template <typename PointInT, typename PointOutT> void
 pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirror (
     const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal)
 {
+  computePointNormalMirror (pos_x, pos_y, point_index, rect_width_, rect_height_, normal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirror (
+    const int pos_x, const int pos_y, const unsigned point_index,
+    const int rect_width, const int rect_height, PointOutT &normal)
+{
+  const int rect_width_2 = rect_width / 2;
+  const int rect_width_4 = rect_width / 4;
+  const int rect_height_2 = rect_height / 2;
+  const int rect_height_4 = rect_height / 4;
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
   const int width = input_->width;
@@ -473,10 +510,10 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     if (!init_covariance_matrix_)
       initCovarianceMatrixMethod ();
 
-    const int start_x = pos_x - rect_width_2_;
-    const int start_y = pos_y - rect_height_2_;
-    const int end_x = start_x + rect_width_;
-    const int end_y = start_y + rect_height_;
+    const int start_x = pos_x - rect_width_2;
+    const int start_y = pos_y - rect_height_2;
+    const int end_x = start_x + rect_width;
+    const int end_y = start_y + rect_height;
 
     unsigned count = 0;
     auto cb_xyz_fecse = [this] (unsigned p1, unsigned p2, unsigned p3, unsigned p4) { return integral_image_XYZ_.getFiniteElementsCountSE (p1, p2, p3, p4); };
@@ -544,10 +581,10 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     if (!init_average_3d_gradient_)
       initAverage3DGradientMethod ();
 
-    const int start_x = pos_x - rect_width_2_;
-    const int start_y = pos_y - rect_height_2_;
-    const int end_x = start_x + rect_width_;
-    const int end_y = start_y + rect_height_;
+    const int start_x = pos_x - rect_width_2;
+    const int start_y = pos_y - rect_height_2;
+    const int end_x = start_x + rect_width;
+    const int end_y = start_y + rect_height;
 
     unsigned count_x = 0;
     unsigned count_y = 0;
@@ -601,14 +638,14 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     if (!init_depth_change_)
       initAverageDepthChangeMethod ();
 
-    int point_index_L_x = pos_x - rect_width_4_ - 1;
+    int point_index_L_x = pos_x - rect_width_4 - 1;
     int point_index_L_y = pos_y;
-    int point_index_R_x = pos_x + rect_width_4_ + 1;
+    int point_index_R_x = pos_x + rect_width_4 + 1;
     int point_index_R_y = pos_y;
     int point_index_U_x = pos_x - 1;
-    int point_index_U_y = pos_y - rect_height_4_;
+    int point_index_U_y = pos_y - rect_height_4;
     int point_index_D_x = pos_x + 1;
-    int point_index_D_y = pos_y + rect_height_4_;
+    int point_index_D_y = pos_y + rect_height_4;
 
     if (point_index_L_x < 0)
       point_index_L_x = -point_index_L_x;
@@ -624,25 +661,25 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computePointNormalMirro
     if (point_index_D_y >= height)
       point_index_D_y = height-(point_index_D_y-(height-1));
 
-    const int start_x_L = pos_x - rect_width_2_;
-    const int start_y_L = pos_y - rect_height_4_;
-    const int end_x_L = start_x_L + rect_width_2_;
-    const int end_y_L = start_y_L + rect_height_2_;
+    const int start_x_L = pos_x - rect_width_2;
+    const int start_y_L = pos_y - rect_height_4;
+    const int end_x_L = start_x_L + rect_width_2;
+    const int end_y_L = start_y_L + rect_height_2;
 
     const int start_x_R = pos_x + 1;
-    const int start_y_R = pos_y - rect_height_4_;
-    const int end_x_R = start_x_R + rect_width_2_;
-    const int end_y_R = start_y_R + rect_height_2_;
+    const int start_y_R = pos_y - rect_height_4;
+    const int end_x_R = start_x_R + rect_width_2;
+    const int end_y_R = start_y_R + rect_height_2;
 
-    const int start_x_U = pos_x - rect_width_4_;
-    const int start_y_U = pos_y - rect_height_2_;
-    const int end_x_U = start_x_U + rect_width_2_;
-    const int end_y_U = start_y_U + rect_height_2_;
+    const int start_x_U = pos_x - rect_width_4;
+    const int start_y_U = pos_y - rect_height_2;
+    const int end_x_U = start_x_U + rect_width_2;
+    const int end_y_U = start_y_U + rect_height_2;
 
-    const int start_x_D = pos_x - rect_width_4_;
+    const int start_x_D = pos_x - rect_width_4;
     const int start_y_D = pos_y + 1;
-    const int end_x_D = start_x_D + rect_width_2_;
-    const int end_y_D = start_y_D + rect_height_2_;
+    const int end_x_D = start_x_D + rect_width_2;
+    const int end_y_D = start_y_D + rect_height_2;
 
     unsigned count_L_z = 0;
     unsigned count_R_z = 0;
@@ -735,6 +772,17 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeature (PointCl
   
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
+  if (border_policy_ == BORDER_POLICY_MIRROR && normal_estimation_method_ == SIMPLE_3D_GRADIENT)
+    PCL_THROW_EXCEPTION (PCLException, "BORDER_POLICY_MIRROR not supported for normal estimation method SIMPLE_3D_GRADIENT");
+
+  // Build the integral images for the current method here rather than lazily from the first
+  // computePointNormal call, as the normals below may be computed by several threads
+  if ((normal_estimation_method_ == COVARIANCE_MATRIX && !init_covariance_matrix_) ||
+      (normal_estimation_method_ == AVERAGE_3D_GRADIENT && !init_average_3d_gradient_) ||
+      (normal_estimation_method_ == AVERAGE_DEPTH_CHANGE && !init_depth_change_) ||
+      (normal_estimation_method_ == SIMPLE_3D_GRADIENT && !init_simple_3d_gradient_))
+    initData ();
+
   // compute depth-change map
   unsigned char * depthChangeMap = new unsigned char[input_->points.size ()];
   memset (depthChangeMap, 255, input_->points.size ());
@@ -839,8 +887,6 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
                                                                              const float &bad_point,
                                                                              PointCloudOut &output)
 {
-  unsigned index = 0;
-
   if (border_policy_ == BORDER_POLICY_IGNORE)
   {
     // Set all normals that we do not touch to NaN
@@ -876,70 +922,72 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
 
     if (use_depth_dependent_smoothing_)
     {
-      index = border + input_->width * border;
-      unsigned skip = (border << 1);
-      for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
+      pcl::parallel::parallel_for (border, input_->height - border, [&] (unsigned first, unsigned last)
       {
-        for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
+        for (unsigned ri = first; ri < last; ++ri)
         {
-          index = ri * input_->width + ci;
-
-          const float depth = input_->points[index].z;
-          if (!std::isfinite (depth))
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-          if (smoothing > 2.0f)
+          for (unsigned ci = border; ci < input_->width - border; ++ci)
           {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormal (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
+            const unsigned index = ri * input_->width + ci;
+
+            const float depth = input_->points[index].z;
+            if (!std::isfinite (depth))
+            {
+              output[index].getNormalVector3fMap ().setConstant (bad_point);
+              output[index].curvature = bad_point;
+              continue;
+            }
+
+            float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+
+            if (smoothing > 2.0f)
+            {
+              const int rect_size = static_cast<int> (smoothing);
+              computePointNormal (ci, ri, index, rect_size, rect_size, output [index]);
+            }
+            else
+            {
+              output[index].getNormalVector3fMap ().setConstant (bad_point);
+              output[index].curvature = bad_point;
+            }
           }
         }
-      }
+      }, threads_, 8u);
     }
     else
     {
       float smoothing_constant = normal_smoothing_size_;
 
-      index = border + input_->width * border;
-      unsigned skip = (border << 1);
-      for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
+      pcl::parallel::parallel_for (border, input_->height - border, [&] (unsigned first, unsigned last)
       {
-        for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
+        for (unsigned ri = first; ri < last; ++ri)
         {
-          index = ri * input_->width + ci;
-
-          if (!std::isfinite (input_->points[index].z))
+          for (unsigned ci = border; ci < input_->width - border; ++ci)
           {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], smoothing_constant);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormal (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
+            const unsigned index = ri * input_->width + ci;
+
+            if (!std::isfinite (input_->points[index].z))
+            {
+              output [index].getNormalVector3fMap ().setConstant (bad_point);
+              output [index].curvature = bad_point;
+              continue;
+            }
+
+            float smoothing = (std::min)(distanceMap[index], smoothing_constant);
+
+            if (smoothing > 2.0f)
+            {
+              const int rect_size = static_cast<int> (smoothing);
+              computePointNormal (ci, ri, index, rect_size, rect_size, output [index]);
+            }
+            else
+            {
+              output [index].getNormalVector3fMap ().setConstant (bad_point);
+              output [index].curvature = bad_point;
+            }
           }
         }
-      }
+      }, threads_, 8u);
     }
   }
   else if (border_policy_ == BORDER_POLICY_MIRROR)
@@ -948,74 +996,72 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
 
     if (use_depth_dependent_smoothing_)
     {
-      //index = 0;
-      //unsigned skip = 0;
-      //for (unsigned ri = 0; ri < input_->height; ++ri, index += skip)
-      for (unsigned ri = 0; ri < input_->height; ++ri)
+      pcl::parallel::parallel_for (0u, input_->height, [&] (unsigned first, unsigned last)
       {
-        //for (unsigned ci = 0; ci < input_->width; ++ci, ++index)
-        for (unsigned ci = 0; ci < input_->width; ++ci)
+        for (unsigned ri = first; ri < last; ++ri)
         {
-          index = ri * input_->width + ci;
-
-          const float depth = input_->points[index].z;
-          if (!std::isfinite (depth))
+          for (unsigned ci = 0; ci < input_->width; ++ci)
           {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormalMirror (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output[index].getNormalVector3fMap ().setConstant (bad_point);
-            output[index].curvature = bad_point;
+            const unsigned index = ri * input_->width + ci;
+
+            const float depth = input_->points[index].z;
+            if (!std::isfinite (depth))
+            {
+              output[index].getNormalVector3fMap ().setConstant (bad_point);
+              output[index].curvature = bad_point;
+              continue;
+            }
+
+            float smoothing = (std::min)(distanceMap[index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+
+            if (smoothing > 2.0f)
+            {
+              const int rect_size = static_cast<int> (smoothing);
+              computePointNormalMirror (ci, ri, index, rect_size, rect_size, output [index]);
+            }
+            else
+            {
+              output[index].getNormalVector3fMap ().setConstant (bad_point);
+              output[index].curvature = bad_point;
+            }
           }
         }
-      }
+      }, threads_, 8u);
     }
     else
     {
       float smoothing_constant = normal_smoothing_size_;
 
-      //index = border + input_->width * border;
-      //unsigned skip = (border << 1);
-      //for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
-      for (unsigned ri = 0; ri < input_->height; ++ri)
+      pcl::parallel::parallel_for (0u, input_->height, [&] (unsigned first, unsigned last)
       {
-        //for (unsigned ci = border; ci < input_->width - border; ++ci, ++index)
-        for (unsigned ci = 0; ci < input_->width; ++ci)
+        for (unsigned ri = first; ri < last; ++ri)
         {
-          index = ri * input_->width + ci;
-
-          if (!std::isfinite (input_->points[index].z))
+          for (unsigned ci = 0; ci < input_->width; ++ci)
           {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
-            continue;
-          }
-
-          float smoothing = (std::min)(distanceMap[index], smoothing_constant);
-
-          if (smoothing > 2.0f)
-          {
-            setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-            computePointNormalMirror (ci, ri, index, output [index]);
-          }
-          else
-          {
-            output [index].getNormalVector3fMap ().setConstant (bad_point);
-            output [index].curvature = bad_point;
+            const unsigned index = ri * input_->width + ci;
+
+            if (!std::isfinite (input_->points[index].z))
+            {
+              output [index].getNormalVector3fMap ().setConstant (bad_point);
+              output [index].curvature = bad_point;
+              continue;
+            }
+
+            float smoothing = (std::min)(distanceMap[index], smoothing_constant);
+
+            if (smoothing > 2.0f)
+            {
+              const int rect_size = static_cast<int> (smoothing);
+              computePointNormalMirror (ci, ri, index, rect_size, rect_size, output [index]);
+            }
+            else
+            {
+              output [index].getNormalVector3fMap ().setConstant (bad_point);
+              output [index].curvature = bad_point;
+            }
           }
         }
-      }
+      }, threads_, 8u);
     }
   }
 }
@@ -1035,89 +1081,95 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (con
     if (use_depth_dependent_smoothing_)
     {
       // Iterating over the entire index vector
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      pcl::parallel::parallel_for (std::size_t (0), indices_->size (), [&] (std::size_t first, std::size_t last)
       {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-        if (v < border || v > bottom)
+        for (std::size_t idx = first; idx < last; ++idx)
         {
-          output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output.points[idx].curvature = bad_point;
-          continue;
-        }
+          unsigned pt_index = (*indices_)[idx];
+          unsigned u = pt_index % input_->width;
+          unsigned v = pt_index / input_->width;
+          if (v < border || v > bottom)
+          {
+            output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output.points[idx].curvature = bad_point;
+            continue;
+          }
 
-        if (u < border || u > right)
-        {
-          output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output.points[idx].curvature = bad_point;
-          continue;
-        }
+          if (u < border || u > right)
+          {
+            output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output.points[idx].curvature = bad_point;
+            continue;
+          }
 
-        const float depth = input_->points[pt_index].z;
-        if (!std::isfinite (depth))
-        {
-          output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output.points[idx].curvature = bad_point;
-          continue;
-        }
+          const float depth = input_->points[pt_index].z;
+          if (!std::isfinite (depth))
+          {
+            output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output.points[idx].curvature = bad_point;
+            continue;
+          }
 
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormal (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
+          float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+          if (smoothing > 2.0f)
+          {
+            const int rect_size = static_cast<int> (smoothing);
+            computePointNormal (u, v, pt_index, rect_size, rect_size, output [idx]);
+          }
+          else
+          {
+            output[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output[idx].curvature = bad_point;
+          }
         }
-      }
+      }, threads_, std::size_t (256));
     }
     else
     {
       float smoothing_constant = normal_smoothing_size_;
       // Iterating over the entire index vector
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      pcl::parallel::parallel_for (std::size_t (0), indices_->size (), [&] (std::size_t first, std::size_t last)
       {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-        if (v < border || v > bottom)
+        for (std::size_t idx = first; idx < last; ++idx)
         {
-          output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output.points[idx].curvature = bad_point;
-          continue;
-        }
+          unsigned pt_index = (*indices_)[idx];
+          unsigned u = pt_index % input_->width;
+          unsigned v = pt_index / input_->width;
+          if (v < border || v > bottom)
+          {
+            output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output.points[idx].curvature = bad_point;
+            continue;
+          }
 
-        if (u < border || u > right)
-        {
-          output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output.points[idx].curvature = bad_point;
-          continue;
-        }
+          if (u < border || u > right)
+          {
+            output.points[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output.points[idx].curvature = bad_point;
+            continue;
+          }
 
-        if (!std::isfinite (input_->points[pt_index].z))
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-          continue;
-        }
+          if (!std::isfinite (input_->points[pt_index].z))
+          {
+            output [idx].getNormalVector3fMap ().setConstant (bad_point);
+            output [idx].curvature = bad_point;
+            continue;
+          }
 
-        float smoothing = (std::min)(distanceMap[pt_index], smoothing_constant);
+          float smoothing = (std::min)(distanceMap[pt_index], smoothing_constant);
 
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormal (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
+          if (smoothing > 2.0f)
+          {
+            const int rect_size = static_cast<int> (smoothing);
+            computePointNormal (u, v, pt_index, rect_size, rect_size, output [idx]);
+          }
+          else
+          {
+            output [idx].getNormalVector3fMap ().setConstant (bad_point);
+            output [idx].curvature = bad_point;
+          }
         }
-      }
+      }, threads_, std::size_t (256));
     }
   }// border_policy_ == BORDER_POLICY_IGNORE
   else if (border_policy_ == BORDER_POLICY_MIRROR)
@@ -1126,63 +1178,69 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (con
 
     if (use_depth_dependent_smoothing_)
     {
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      pcl::parallel::parallel_for (std::size_t (0), indices_->size (), [&] (std::size_t first, std::size_t last)
       {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-
-        const float depth = input_->points[pt_index].z;
-        if (!std::isfinite (depth))
+        for (std::size_t idx = first; idx < last; ++idx)
         {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
-          continue;
-        }
+          unsigned pt_index = (*indices_)[idx];
+          unsigned u = pt_index % input_->width;
+          unsigned v = pt_index / input_->width;
 
-        float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+          const float depth = input_->points[pt_index].z;
+          if (!std::isfinite (depth))
+          {
+            output[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output[idx].curvature = bad_point;
+            continue;
+          }
 
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormalMirror (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output[idx].getNormalVector3fMap ().setConstant (bad_point);
-          output[idx].curvature = bad_point;
+          float smoothing = (std::min)(distanceMap[pt_index], normal_smoothing_size_ + static_cast<float>(depth)/10.0f);
+
+          if (smoothing > 2.0f)
+          {
+            const int rect_size = static_cast<int> (smoothing);
+            computePointNormalMirror (u, v, pt_index, rect_size, rect_size, output [idx]);
+          }
+          else
+          {
+            output[idx].getNormalVector3fMap ().setConstant (bad_point);
+            output[idx].curvature = bad_point;
+          }
         }
-      }
+      }, threads_, std::size_t (256));
     }
     else
     {
       float smoothing_constant = normal_smoothing_size_;
-      for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      pcl::parallel::parallel_for (std::size_t (0), indices_->size (), [&] (std::size_t first, std::size_t last)
       {
-        unsigned pt_index = (*indices_)[idx];
-        unsigned u = pt_index % input_->width;
-        unsigned v = pt_index / input_->width;
-
-        if (!std::isfinite (input_->points[pt_index].z))
+        for (std::size_t idx = first; idx < last; ++idx)
         {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
-          continue;
-        }
+          unsigned pt_index = (*indices_)[idx];
+          unsigned u = pt_index % input_->width;
+          unsigned v = pt_index / input_->width;
 
-        float smoothing = (std::min)(distanceMap[pt_index], smoothing_constant);
+          if (!std::isfinite (input_->points[pt_index].z))
+          {
+            output [idx].getNormalVector3fMap ().setConstant (bad_point);
+            output [idx].curvature = bad_point;
+            continue;
+          }
 
-        if (smoothing > 2.0f)
-        {
-          setRectSize (static_cast<int> (smoothing), static_cast<int> (smoothing));
-          computePointNormalMirror (u, v, pt_index, output [idx]);
-        }
-        else
-        {
-          output [idx].getNormalVector3fMap ().setConstant (bad_point);
-          output [idx].curvature = bad_point;
+          float smoothing = (std::min)(distanceMap[pt_index], smoothing_constant);
+
+          if (smoothing > 2.0f)
+          {
+            const int rect_size = static_cast<int> (smoothing);
+            computePointNormalMirror (u, v, pt_index, rect_size, rect_size, output [idx]);
+          }
+          else
+          {
+            output [idx].getNormalVector3fMap ().setConstant (bad_point);
+            output [idx].curvature = bad_point;
+          }
         }
-      }
+      }, threads_, std::size_t (256));
     }
   } // border_policy_ == BORDER_POLICY_MIRROR
 }
@@ -49,7 +49,7 @@
 template <typename PointInT, typename PointNT, typename PointOutT, typename IntensitySelectorT> void
 pcl::IntensityGradientEstimation <PointInT, PointNT, PointOutT, IntensitySelectorT>::computePointIntensityGradient (
   const pcl::PointCloud <PointInT> &cloud, const std::vector <int> &indices,
-  const Eigen::Vector3f &point, float mean_intensity, const Eigen::Vector3f &normal, Eigen::Vector3f &gradient)
+  const Eigen::Vector3f &point, float mean_intensity, const Eigen::Vector3f &normal, Eigen::Vector3f &gradient) const
 {
   if (indices.size () < 3)
   {
@@ -142,97 +142,48 @@ pcl::IntensityGradientEstimation <PointInT, PointNT, PointOutT, IntensitySelecto
 template <typename PointInT, typename PointNT, typename PointOutT, typename IntensitySelectorT> void
 pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelectorT>::computeFeature (PointCloudOut &output)
 {
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
   output.is_dense = true;
-
   // If the data is dense, we don't need to check for NaN
-  if (surface_->is_dense)
+  const bool check_finite = !surface_->is_dense;
+
+  // Iterating over the entire index vector
+  const auto compute_point = [this, check_finite] (std::size_t idx, std::vector<int> &nn_indices,
+                                                   std::vector<float> &nn_dists, PointOutT &p_out)
   {
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+    if ((check_finite && !isFinite ((*surface_) [(*indices_)[idx]])) ||
+        !this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists))
     {
-      PointOutT &p_out = output.points[idx];
-
-      if (!this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists))
-      {
-        p_out.gradient[0] = p_out.gradient[1] = p_out.gradient[2] = std::numeric_limits<float>::quiet_NaN ();
-        output.is_dense = false;
-        continue;
-      }
-
-      Eigen::Vector3f centroid;
-      float mean_intensity = 0;
-      // Initialize to 0
-      centroid.setZero ();
-      for (const int &nn_index : nn_indices)
-      {
-        centroid += surface_->points[nn_index].getVector3fMap ();
-        mean_intensity += intensity_ (surface_->points[nn_index]);
-      }
-      centroid /= static_cast<float> (nn_indices.size ());
-      mean_intensity /= static_cast<float> (nn_indices.size ());
-
-      Eigen::Vector3f normal = Eigen::Vector3f::Map (normals_->points[(*indices_) [idx]].normal);
-      Eigen::Vector3f gradient;
-      computePointIntensityGradient (*surface_, nn_indices, centroid, mean_intensity, normal, gradient);
-
-      p_out.gradient[0] = gradient[0];
-      p_out.gradient[1] = gradient[1];
-      p_out.gradient[2] = gradient[2];
+      p_out.gradient[0] = p_out.gradient[1] = p_out.gradient[2] = std::numeric_limits<float>::quiet_NaN ();
+      return (false);
     }
-  }
-  else
-  {
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+
+    Eigen::Vector3f centroid;
+    float mean_intensity = 0;
+    // Initialize to 0
+    centroid.setZero ();
+    unsigned cp = 0;
+    for (const int &nn_index : nn_indices)
     {
-      PointOutT &p_out = output.points[idx];
-      if (!isFinite ((*surface_) [(*indices_)[idx]]) ||
-          !this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists))
-      {
-        p_out.gradient[0] = p_out.gradient[1] = p_out.gradient[2] = std::numeric_limits<float>::quiet_NaN ();
-        output.is_dense = false;
+      // Check if the point is invalid
+      if (check_finite && !isFinite ((*surface_) [nn_index]))
         continue;
-      }
-      Eigen::Vector3f centroid;
-      float mean_intensity = 0;
-      // Initialize to 0
-      centroid.setZero ();
-      unsigned cp = 0;
-      for (const int &nn_index : nn_indices)
-      {
-        // Check if the point is invalid
-        if (!isFinite ((*surface_) [nn_index]))
-          continue;
-
-        centroid += surface_->points [nn_index].getVector3fMap ();
-        mean_intensity += intensity_ (surface_->points [nn_index]);
-        ++cp;
-      }
-      centroid /= static_cast<float> (cp);
-      mean_intensity /= static_cast<float> (cp);
-      Eigen::Vector3f normal = Eigen::Vector3f::Map (normals_->points[(*indices_) [idx]].normal);
-      Eigen::Vector3f gradient;
-      computePointIntensityGradient (*surface_, nn_indices, centroid, mean_intensity, normal, gradient);
-
-      p_out.gradient[0] = gradient[0];
-      p_out.gradient[1] = gradient[1];
-      p_out.gradient[2] = gradient[2];
+
+      centroid += surface_->points [nn_index].getVector3fMap ();
+      mean_intensity += intensity_ (surface_->points [nn_index]);
+      ++cp;
     }
-  }
+    centroid /= static_cast<float> (cp);
+    mean_intensity /= static_cast<float> (cp);
+    Eigen::Vector3f normal = Eigen::Vector3f::Map (normals_->points[(*indices_) [idx]].normal);
+    Eigen::Vector3f gradient;
+    computePointIntensityGradient (*surface_, nn_indices, centroid, mean_intensity, normal, gradient);
+
+    p_out.gradient[0] = gradient[0];
+    p_out.gradient[1] = gradient[1];
+    p_out.gradient[2] = gradient[2];
+    return (true);
+  };
+  this->computeFeatureParallel (output, compute_point);
 }
 
 #define PCL_INSTANTIATE_IntensityGradientEstimation(InT,NT,OutT) template class PCL_EXPORTS pcl::IntensityGradientEstimation<InT,NT,OutT>;
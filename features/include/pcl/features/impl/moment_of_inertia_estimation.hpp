@@ -41,6 +41,7 @@
 #define PCL_MOMENT_OF_INERTIA_ESTIMATION_HPP_
 
 #include <pcl/features/moment_of_inertia_estimation.h>
+#include <pcl/common/local_surface_statistics.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
@@ -357,21 +358,13 @@ pcl::MomentOfInertiaEstimation<PointT>::computeMeanValue ()
 template <typename PointT> void
 pcl::MomentOfInertiaEstimation<PointT>::computeCovarianceMatrix (Eigen::Matrix <float, 3, 3>& covariance_matrix) const
 {
-  covariance_matrix.setZero ();
-
   unsigned int number_of_points = static_cast <unsigned int> (indices_->size ());
-  float factor = 1.0f / static_cast <float> ((number_of_points - 1 > 0)?(number_of_points - 1):1);
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
-  {
-    Eigen::Vector3f current_point (0.0f, 0.0f, 0.0f);
-    current_point (0) = input_->points[(*indices_)[i_point]].x - mean_value_ (0);
-    current_point (1) = input_->points[(*indices_)[i_point]].y - mean_value_ (1);
-    current_point (2) = input_->points[(*indices_)[i_point]].z - mean_value_ (2);
+  double factor = 1.0 / static_cast <double> ((number_of_points - 1 > 0)?(number_of_points - 1):1);
 
-    covariance_matrix += current_point * current_point.transpose ();
-  }
-
-  covariance_matrix *= factor;
+  Eigen::Vector3d sum;
+  Eigen::Matrix3d scatter_matrix;
+  computeScatterMatrix (*input_, *indices_, mean_value_.cast<double> (), sum, scatter_matrix);
+  covariance_matrix = (scatter_matrix * factor).cast<float> ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,194 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PCL_FEATURES_IMPL_NEIGHBORHOOD_CACHE_H_
+#define PCL_FEATURES_IMPL_NEIGHBORHOOD_CACHE_H_
+
+#include <pcl/features/neighborhood_cache.h>
+#include <pcl/common/parallel.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/search/pcl_search.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::NeighborhoodCache<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  threads_ = nr_threads;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::NeighborhoodCache<PointT>::compute ()
+{
+  computed_input_.reset ();
+  computed_surface_.reset ();
+  rows_.clear ();
+  offsets_.clear ();
+  neighbor_indices_.clear ();
+  sqr_distances_.clear ();
+
+  if (!initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::compute] Init failed.\n", getClassName ());
+    return (false);
+  }
+
+  if ((search_radius_ > 0.0) == (k_ > 0))
+  {
+    PCL_ERROR ("[pcl::%s::compute] Exactly one of the radius (%f) and K (%d) has to be set!\n",
+               getClassName (), search_radius_, k_);
+    deinitCompute ();
+    return (false);
+  }
+
+  const PointCloudConstPtr surface = surface_ ? surface_ : input_;
+  if (!tree_)
+  {
+    if (surface->isOrganized () && input_->isOrganized ())
+      tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+    else
+      tree_.reset (new pcl::search::KdTree<PointT> (false));
+  }
+  if (tree_->getInputCloud () != surface)
+    tree_->setInputCloud (surface);
+
+  // Search the neighborhoods in parallel, then pack them in query order
+  const std::size_t nr_queries = indices_->size ();
+  std::vector<std::vector<int> > nn_indices (nr_queries);
+  std::vector<std::vector<float> > nn_dists (nr_queries);
+  pcl::parallel::parallel_for (std::size_t (0), nr_queries, [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+    {
+      const int index = (*indices_)[i];
+      // Non-finite query points have no neighbors
+      if (!isFinite (input_->points[index]))
+        continue;
+      const int nr_neighbors = search_radius_ > 0.0 ?
+                               tree_->radiusSearch (*input_, index, search_radius_, nn_indices[i], nn_dists[i], 0) :
+                               tree_->nearestKSearch (*input_, index, k_, nn_indices[i], nn_dists[i]);
+      nn_indices[i].resize ((std::max) (nr_neighbors, 0));
+      nn_dists[i].resize ((std::max) (nr_neighbors, 0));
+    }
+  }, threads_, std::size_t (64));
+
+  offsets_.resize (nr_queries + 1);
+  offsets_[0] = 0;
+  for (std::size_t i = 0; i < nr_queries; ++i)
+    offsets_[i + 1] = offsets_[i] + nn_indices[i].size ();
+  neighbor_indices_.resize (offsets_.back ());
+  sqr_distances_.resize (offsets_.back ());
+  pcl::parallel::parallel_for (std::size_t (0), nr_queries, [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+    {
+      std::copy (nn_indices[i].cbegin (), nn_indices[i].cend (), neighbor_indices_.begin () + offsets_[i]);
+      std::copy (nn_dists[i].cbegin (), nn_dists[i].cend (), sqr_distances_.begin () + offsets_[i]);
+      std::vector<int> ().swap (nn_indices[i]);
+      std::vector<float> ().swap (nn_dists[i]);
+    }
+  }, threads_);
+
+  rows_.assign (input_->points.size (), -1);
+  for (std::size_t i = 0; i < nr_queries; ++i)
+    rows_[(*indices_)[i]] = static_cast<int> (i);
+
+  computed_input_ = input_;
+  computed_surface_ = surface;
+  computed_radius_ = search_radius_;
+  computed_k_ = k_;
+
+  deinitCompute ();
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::NeighborhoodCache<PointT>::isCompatible (const PointCloudConstPtr &input, const PointCloudConstPtr &surface,
+                                              double radius, int k) const
+{
+  if (!computed_input_ || input != computed_input_ || surface != computed_surface_)
+    return (false);
+  if (computed_radius_ > 0.0)
+    return (k == 0 && radius > 0.0 && radius <= computed_radius_);
+  return (radius == 0.0 && k > 0 && k <= computed_k_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::NeighborhoodCache<PointT>::getNeighbors (std::size_t index, double parameter,
+                                              std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  if (index >= rows_.size () || rows_[index] < 0)
+    return (-1);
+  const std::size_t begin = offsets_[rows_[index]];
+  std::size_t end = offsets_[rows_[index] + 1];
+
+  if (computed_radius_ > 0.0)
+  {
+    if (parameter > computed_radius_)
+      return (-1);
+    // A smaller radius keeps the neighbors within it, in the same order
+    if (parameter < computed_radius_)
+    {
+      const float sqr_radius = static_cast<float> (parameter * parameter);
+      k_indices.clear ();
+      k_sqr_distances.clear ();
+      for (std::size_t j = begin; j < end; ++j)
+        if (sqr_distances_[j] <= sqr_radius)
+        {
+          k_indices.push_back (neighbor_indices_[j]);
+          k_sqr_distances.push_back (sqr_distances_[j]);
+        }
+      return (static_cast<int> (k_indices.size ()));
+    }
+  }
+  else
+  {
+    if (parameter > computed_k_)
+      return (-1);
+    // The nearest neighbors are sorted by distance, so fewer neighbors are a prefix
+    end = (std::min) (end, begin + static_cast<std::size_t> (parameter));
+  }
+
+  k_indices.assign (neighbor_indices_.cbegin () + begin, neighbor_indices_.cbegin () + end);
+  k_sqr_distances.assign (sqr_distances_.cbegin () + begin, sqr_distances_.cbegin () + end);
+  return (static_cast<int> (end - begin));
+}
+
+#endif    // PCL_FEATURES_IMPL_NEIGHBORHOOD_CACHE_H_
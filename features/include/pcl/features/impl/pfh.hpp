@@ -41,6 +41,7 @@
 #include <pcl/features/pfh.h>
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/features/pfh_tools.h>
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +70,69 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
   // Factorization constant
   float hist_incr = 100.0f / static_cast<float> (indices.size () * (indices.size () - 1) / 2);
 
+  // Normalize the f1, f2, f3 features and push them in the histogram
+  const auto add_to_histogram = [&] (float f1, float f2, float f3)
+  {
+    f_index_[0] = static_cast<int> (std::floor (nr_split * ((f1 + M_PI) * d_pi_)));
+    if (f_index_[0] < 0)         f_index_[0] = 0;
+    if (f_index_[0] >= nr_split) f_index_[0] = nr_split - 1;
+
+    f_index_[1] = static_cast<int> (std::floor (nr_split * ((f2 + 1.0) * 0.5)));
+    if (f_index_[1] < 0)         f_index_[1] = 0;
+    if (f_index_[1] >= nr_split) f_index_[1] = nr_split - 1;
+
+    f_index_[2] = static_cast<int> (std::floor (nr_split * ((f3 + 1.0) * 0.5)));
+    if (f_index_[2] < 0)         f_index_[2] = 0;
+    if (f_index_[2] >= nr_split) f_index_[2] = nr_split - 1;
+
+    // Copy into the histogram
+    h_index = 0;
+    h_p     = 1;
+    for (const int &d : f_index_)
+    {
+      h_index += h_p * d;
+      h_p     *= nr_split;
+    }
+    pfh_histogram[h_index] += hist_incr;
+  };
+
+  if (!use_cache_)
+  {
+    // Gather the finite neighbors in separate coordinate arrays, so that each one can be paired with all the
+    // previous ones in a single call of the batch kernel
+    std::vector<int> finite_indices;
+    finite_indices.reserve (indices.size ());
+    for (const auto &index : indices)
+      if (isFinite (cloud.points[index]))
+        finite_indices.push_back (index);
+
+    const std::size_t nr_points = finite_indices.size ();
+    std::vector<float> data (10 * nr_points);
+    float *x = &data[0], *y = x + nr_points, *z = y + nr_points;
+    float *nx = z + nr_points, *ny = nx + nr_points, *nz = ny + nr_points;
+    float *f1 = nz + nr_points, *f2 = f1 + nr_points, *f3 = f2 + nr_points, *f4 = f3 + nr_points;
+    for (std::size_t i = 0; i < nr_points; ++i)
+    {
+      x[i] = cloud.points[finite_indices[i]].x;
+      y[i] = cloud.points[finite_indices[i]].y;
+      z[i] = cloud.points[finite_indices[i]].z;
+      nx[i] = normals.points[finite_indices[i]].normal_x;
+      ny[i] = normals.points[finite_indices[i]].normal_y;
+      nz[i] = normals.points[finite_indices[i]].normal_z;
+    }
+
+    // Pairs for which the features are undefined get zeros, and are binned as such
+    for (std::size_t i = 1; i < nr_points; ++i)
+    {
+      pcl::computePairFeatures (cloud.points[finite_indices[i]].getVector4fMap (),
+                                normals.points[finite_indices[i]].getNormalVector4fMap (),
+                                i, x, y, z, nx, ny, nz, f1, f2, f3, f4, fast_atan2_);
+      for (std::size_t j = 0; j < i; ++j)
+        add_to_histogram (f1[j], f2[j], f3[j]);
+    }
+    return;
+  }
+
   std::pair<int, int> key;
   bool key_found = false;
 
@@ -81,68 +145,28 @@ pcl::PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature (
       if (!isFinite (cloud.points[indices[i_idx]]) || !isFinite (cloud.points[indices[j_idx]]))
         continue;
 
-      if (use_cache_)
-      {
-        // In order to create the key, always use the smaller index as the first key pair member
-        int p1, p2;
-  //      if (indices[i_idx] >= indices[j_idx])
-  //      {
-          p1 = indices[i_idx];
-          p2 = indices[j_idx];
-  //      }
-  //      else
-  //      {
-  //        p1 = indices[j_idx];
-  //        p2 = indices[i_idx];
-  //      }
-        key = std::pair<int, int> (p1, p2);
-
-        // Check to see if we already estimated this pair in the global hashmap
-        std::map<std::pair<int, int>, Eigen::Vector4f, std::less<>, Eigen::aligned_allocator<std::pair<const std::pair<int, int>, Eigen::Vector4f> > >::iterator fm_it = feature_map_.find (key);
-        if (fm_it != feature_map_.end ())
-        {
-          pfh_tuple_ = fm_it->second;
-          key_found = true;
-        }
-        else
-        {
-          // Compute the pair NNi to NNj
-          if (!computePairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
-                                    pfh_tuple_[0], pfh_tuple_[1], pfh_tuple_[2], pfh_tuple_[3]))
-            continue;
+      key = std::pair<int, int> (indices[i_idx], indices[j_idx]);
 
-          key_found = false;
-        }
+      // Check to see if we already estimated this pair in the global hashmap
+      std::map<std::pair<int, int>, Eigen::Vector4f, std::less<>, Eigen::aligned_allocator<std::pair<const std::pair<int, int>, Eigen::Vector4f> > >::iterator fm_it = feature_map_.find (key);
+      if (fm_it != feature_map_.end ())
+      {
+        pfh_tuple_ = fm_it->second;
+        key_found = true;
       }
       else
+      {
+        // Compute the pair NNi to NNj
         if (!computePairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
                                   pfh_tuple_[0], pfh_tuple_[1], pfh_tuple_[2], pfh_tuple_[3]))
           continue;
 
-      // Normalize the f1, f2, f3 features and push them in the histogram
-      f_index_[0] = static_cast<int> (std::floor (nr_split * ((pfh_tuple_[0] + M_PI) * d_pi_)));
-      if (f_index_[0] < 0)         f_index_[0] = 0;
-      if (f_index_[0] >= nr_split) f_index_[0] = nr_split - 1;
-
-      f_index_[1] = static_cast<int> (std::floor (nr_split * ((pfh_tuple_[1] + 1.0) * 0.5)));
-      if (f_index_[1] < 0)         f_index_[1] = 0;
-      if (f_index_[1] >= nr_split) f_index_[1] = nr_split - 1;
-
-      f_index_[2] = static_cast<int> (std::floor (nr_split * ((pfh_tuple_[2] + 1.0) * 0.5)));
-      if (f_index_[2] < 0)         f_index_[2] = 0;
-      if (f_index_[2] >= nr_split) f_index_[2] = nr_split - 1;
-
-      // Copy into the histogram
-      h_index = 0;
-      h_p     = 1;
-      for (const int &d : f_index_)
-      {
-        h_index += h_p * d;
-        h_p     *= nr_split;
+        key_found = false;
       }
-      pfh_histogram[h_index] += hist_incr;
 
-      if (use_cache_ && !key_found)
+      add_to_histogram (pfh_tuple_[0], pfh_tuple_[1], pfh_tuple_[2]);
+
+      if (!key_found)
       {
         // Save the value in the hashmap
         feature_map_[key] = pfh_tuple_;
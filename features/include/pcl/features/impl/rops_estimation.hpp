@@ -144,21 +144,19 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
 
   //feature size = number_of_rotations * number_of_axis_to_rotate_around * number_of_projections * number_of_central_moments
   unsigned int feature_size = number_of_rotations_ * 3 * 3 * 5;
-  const auto number_of_points = indices_->size ();
-  output.points.clear ();
-  output.points.reserve (number_of_points);
-
-  for (const auto& idx: *indices_)
+  const auto compute_point = [this, feature_size] (std::size_t i_point, std::vector<int> &, std::vector<float> &,
+                                                  PointOutT &point_out)
   {
+    const PointInT &point = input_->points[(*indices_)[i_point]];
     std::set <unsigned int> local_triangles;
     std::vector <int> local_points;
-    getLocalSurface (input_->points[idx], local_triangles, local_points);
+    getLocalSurface (point, local_triangles, local_points);
 
     Eigen::Matrix3f lrf_matrix;
-    computeLRF (input_->points[idx], local_triangles, lrf_matrix);
+    computeLRF (point, local_triangles, lrf_matrix);
 
     PointCloudIn transformed_cloud;
-    transformCloud (input_->points[idx], lrf_matrix, local_points, transformed_cloud);
+    transformCloud (point, lrf_matrix, local_points, transformed_cloud);
 
     std::array<PointInT, 3> axes;
     axes[0].x = 1.0f; axes[0].y = 0.0f; axes[0].z = 0.0f;
@@ -203,10 +201,11 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
     else
       invert_norm = 1.0f / norm;
 
-    output.points.emplace_back ();
     for (std::size_t i_dim = 0; i_dim < feature_size; i_dim++)
-      output.points.back().histogram[i_dim] = feature[i_dim] * invert_norm;
-  }
+      point_out.histogram[i_dim] = feature[i_dim] * invert_norm;
+    return (true);
+  };
+  this->computeFeatureParallel (output, compute_point);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
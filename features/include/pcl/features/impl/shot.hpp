@@ -44,6 +44,10 @@
 #include <pcl/features/shot_lrf.h>
 #include <utility>
 
+#if defined(__AVX__) && defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 // Useful constants.
 #define PST_PI 3.1415926535897932384626433832795
 #define PST_RAD_45 0.78539816339744830961566084581988
@@ -84,6 +88,109 @@ areEquals (float val1, float val2, float zeroFloatEps = zeroFloatEps8)
   return (std::fabs (val1 - val2)<zeroFloatEps);
 }
 
+namespace pcl
+{
+  namespace detail
+  {
+#if defined(__AVX__) && defined(__AVX2__)
+    /** \brief Arc tangent of eight values of y/x, using the polynomial approximation 4.4.49 from
+      * Abramowitz & Stegun on [0, 1] (maximum absolute error 2e-8 rad, before rounding).
+      */
+    inline __m256
+    shotAtan2 (const __m256 y, const __m256 x)
+    {
+      const __m256 sign_mask = _mm256_set1_ps (-0.0f);
+      const __m256 abs_y = _mm256_andnot_ps (sign_mask, y), abs_x = _mm256_andnot_ps (sign_mask, x);
+      const __m256 max_abs = _mm256_max_ps (abs_y, abs_x);
+      const __m256 nonzero = _mm256_cmp_ps (max_abs, _mm256_setzero_ps (), _CMP_NEQ_OQ);
+      const __m256 a = _mm256_and_ps (nonzero, _mm256_div_ps (_mm256_min_ps (abs_y, abs_x), max_abs));
+      const __m256 t = _mm256_mul_ps (a, a);
+      __m256 r = _mm256_set1_ps (0.0028662257f);
+      r = _mm256_add_ps (_mm256_mul_ps (r, t), _mm256_set1_ps (-0.0161657367f));
+      r = _mm256_add_ps (_mm256_mul_ps (r, t), _mm256_set1_ps (0.0429096138f));
+      r = _mm256_add_ps (_mm256_mul_ps (r, t), _mm256_set1_ps (-0.0752896400f));
+      r = _mm256_add_ps (_mm256_mul_ps (r, t), _mm256_set1_ps (0.1065626393f));
+      r = _mm256_add_ps (_mm256_mul_ps (r, t), _mm256_set1_ps (-0.1420889944f));
+      r = _mm256_add_ps (_mm256_mul_ps (r, t), _mm256_set1_ps (0.1999355085f));
+      r = _mm256_add_ps (_mm256_mul_ps (r, t), _mm256_set1_ps (-0.3333314528f));
+      r = _mm256_add_ps (_mm256_mul_ps (_mm256_mul_ps (r, t), a), a);
+      r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (static_cast<float> (PST_RAD_90)), r), _mm256_cmp_ps (abs_y, abs_x, _CMP_GT_OQ));
+      r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (static_cast<float> (PST_PI)), r), _mm256_cmp_ps (x, _mm256_setzero_ps (), _CMP_LT_OQ));
+      return (_mm256_or_ps (r, _mm256_and_ps (y, sign_mask)));
+    }
+#endif
+
+    /** \brief Express points, given relatively to the center of a SHOT support, in its local reference frame, and
+      * compute their inclination (angle to the z axis) and azimuth (angle to the x axis in the xy plane).
+      * \param[in] nr_points the number of points
+      * \param[in] frame the x, y and z axes of the reference frame
+      * \param[in,out] x the x coordinates relative to the center, replaced with the ones in the reference frame
+      * \param[in,out] y the y coordinates relative to the center, replaced with the ones in the reference frame
+      * \param[in,out] z the z coordinates relative to the center, replaced with the ones in the reference frame
+      * \param[in] distances the distances to the center
+      * \param[out] inclination the inclinations, undefined at zero distance
+      * \param[out] azimuth the azimuths
+      */
+    inline void
+    computeSHOTLocalCoordinates (std::size_t nr_points, const float frame[9],
+                                 float *x, float *y, float *z, const float *distances,
+                                 float *inclination, float *azimuth)
+    {
+      std::size_t i = 0;
+#if defined(__AVX__) && defined(__AVX2__)
+      const __m256 sign_mask = _mm256_set1_ps (-0.0f);
+      const __m256 tiny = _mm256_set1_ps (1e-30f);
+      const __m256 one = _mm256_set1_ps (1.0f);
+      __m256 axes[9];
+      for (int j = 0; j < 9; ++j)
+        axes[j] = _mm256_set1_ps (frame[j]);
+      for (; i + 8 <= nr_points; i += 8)
+      {
+        const __m256 dx = _mm256_loadu_ps (x + i), dy = _mm256_loadu_ps (y + i), dz = _mm256_loadu_ps (z + i);
+        __m256 local[3];
+        for (int j = 0; j < 3; ++j)
+        {
+          local[j] = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (dx, axes[3 * j]), _mm256_mul_ps (dy, axes[3 * j + 1])),
+                                    _mm256_mul_ps (dz, axes[3 * j + 2]));
+          // To avoid numerical problems afterwards
+          local[j] = _mm256_andnot_ps (_mm256_cmp_ps (_mm256_andnot_ps (sign_mask, local[j]), tiny, _CMP_LT_OQ), local[j]);
+        }
+        _mm256_storeu_ps (x + i, local[0]);
+        _mm256_storeu_ps (y + i, local[1]);
+        _mm256_storeu_ps (z + i, local[2]);
+
+        // acos (c) = atan2 (sqrt (1 - c^2), c)
+        __m256 cos_incl = _mm256_div_ps (local[2], _mm256_loadu_ps (distances + i));
+        cos_incl = _mm256_max_ps (_mm256_min_ps (cos_incl, one), _mm256_sub_ps (_mm256_setzero_ps (), one));
+        const __m256 sin_incl = _mm256_sqrt_ps (_mm256_mul_ps (_mm256_sub_ps (one, cos_incl), _mm256_add_ps (one, cos_incl)));
+        _mm256_storeu_ps (inclination + i, shotAtan2 (sin_incl, cos_incl));
+        _mm256_storeu_ps (azimuth + i, shotAtan2 (local[1], local[0]));
+      }
+#endif
+      for (; i < nr_points; ++i)
+      {
+        const float dx = x[i], dy = y[i], dz = z[i];
+        float local[3];
+        for (int j = 0; j < 3; ++j)
+        {
+          local[j] = dx * frame[3 * j] + dy * frame[3 * j + 1] + dz * frame[3 * j + 2];
+          // To avoid numerical problems afterwards
+          if (std::abs (local[j]) < 1e-30f)
+            local[j] = 0;
+        }
+        x[i] = local[0];
+        y[i] = local[1];
+        z[i] = local[2];
+
+        double cos_incl = local[2] / static_cast<double> (distances[i]);
+        cos_incl = (std::max) (-1.0, (std::min) (cos_incl, 1.0));
+        inclination[i] = static_cast<float> (std::acos (cos_incl));
+        azimuth[i] = static_cast<float> (std::atan2 (static_cast<double> (local[1]), static_cast<double> (local[0])));
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> float
 pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::sRGB_LUT[256] = {- 1};
@@ -181,7 +288,8 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
   if (!fake_surface_)
     lrf_estimator->setSearchSurface(surface_);
 
-  if (!FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
+  if (!initCloudReferenceFrames () ||
+      !FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
   {
     PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
     return (false);
@@ -190,6 +298,65 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCloudReferenceFrames ()
+{
+  if (!cloud_frames_)
+    return (true);
+
+  if (cloud_frames_->points.size () != input_->points.size ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] The number of reference frames (%lu) differs from the number of points in the input cloud (%lu)!\n",
+               getClassName ().c_str (), cloud_frames_->points.size (), input_->points.size ());
+    return (false);
+  }
+
+  typename FeatureWithLocalReferenceFrames<PointInT, PointRFT>::PointCloudLRFPtr frames (
+      new typename FeatureWithLocalReferenceFrames<PointInT, PointRFT>::PointCloudLRF);
+  frames->points.reserve (indices_->size ());
+  for (const auto &index : *indices_)
+    frames->points.push_back (cloud_frames_->points[index]);
+  frames->width = static_cast<std::uint32_t> (frames->points.size ());
+  frames->height = 1;
+
+  frames_ = frames;
+  frames_never_defined_ = false;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::computeLocalCoordinates (
+    const int index,
+    const std::vector<int> &indices,
+    const std::vector<float> &sqr_dists,
+    std::vector<float> &local) const
+{
+  const std::size_t nr_neighbors = indices.size ();
+  local.resize (6 * nr_neighbors);
+  float *x = local.data (), *y = x + nr_neighbors, *z = y + nr_neighbors;
+  float *inclination = z + nr_neighbors, *azimuth = inclination + nr_neighbors;
+  float *distances = azimuth + nr_neighbors;
+
+  const PointInT &central_point = (*input_)[(*indices_)[index]];
+  for (std::size_t i = 0; i < nr_neighbors; ++i)
+  {
+    const PointInT &point = surface_->points[indices[i]];
+    x[i] = point.x - central_point.x;
+    y[i] = point.y - central_point.y;
+    z[i] = point.z - central_point.z;
+    distances[i] = std::sqrt (sqr_dists[i]);
+  }
+
+  const PointRFT &current_frame = (*frames_)[index];
+  const float frame[9] = {current_frame.x_axis[0], current_frame.x_axis[1], current_frame.x_axis[2],
+                          current_frame.y_axis[0], current_frame.y_axis[1], current_frame.y_axis[2],
+                          current_frame.z_axis[0], current_frame.z_axis[1], current_frame.z_axis[2]};
+  pcl::detail::computeSHOTLocalCoordinates (nr_neighbors, frame, x, y, z, distances, inclination, azimuth);
+  local.resize (5 * nr_neighbors);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::createBinDistanceShape (
@@ -261,38 +428,28 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     const int nr_bins,
     Eigen::VectorXf &shot)
 {
-  const Eigen::Vector4f& central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
-  const PointRFT& current_frame = (*frames_)[index];
-
-  Eigen::Vector4f current_frame_x (current_frame.x_axis[0], current_frame.x_axis[1], current_frame.x_axis[2], 0);
-  Eigen::Vector4f current_frame_y (current_frame.y_axis[0], current_frame.y_axis[1], current_frame.y_axis[2], 0);
-  Eigen::Vector4f current_frame_z (current_frame.z_axis[0], current_frame.z_axis[1], current_frame.z_axis[2], 0);
+  // Express all the neighbors in the local reference frame at once, in a buffer reused across the points described
+  // by the calling thread
+  static thread_local std::vector<float> local;
+  this->computeLocalCoordinates (index, indices, sqr_dists, local);
+  const std::size_t nr_neighbors = indices.size ();
+  const float *x_local = local.data (), *y_local = x_local + nr_neighbors, *z_local = y_local + nr_neighbors;
+  const float *inclinations = z_local + nr_neighbors, *azimuths = inclinations + nr_neighbors;
 
   for (std::size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
     if (!std::isfinite(binDistance[i_idx]))
       continue;
 
-    Eigen::Vector4f delta = surface_->points[indices[i_idx]].getVector4fMap () - central_point;
-    delta[3] = 0;
-
     // Compute the Euclidean norm
    double distance = sqrt (sqr_dists[i_idx]);
 
     if (areEquals (distance, 0.0))
       continue;
 
-    double xInFeatRef = delta.dot (current_frame_x);
-    double yInFeatRef = delta.dot (current_frame_y);
-    double zInFeatRef = delta.dot (current_frame_z);
-
-    // To avoid numerical problems afterwards
-    if (std::abs (yInFeatRef) < 1E-30)
-      yInFeatRef  = 0;
-    if (std::abs (xInFeatRef) < 1E-30)
-      xInFeatRef  = 0;
-    if (std::abs (zInFeatRef) < 1E-30)
-      zInFeatRef  = 0;
+    double xInFeatRef = x_local[i_idx];
+    double yInFeatRef = y_local[i_idx];
+    double zInFeatRef = z_local[i_idx];
 
 
     unsigned char bit4 = ((yInFeatRef > 0) || ((yInFeatRef == 0.0) && (xInFeatRef < 0))) ? 1 : 0;
@@ -354,15 +511,10 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     }
 
     //Interpolation on the inclination (adjacent vertical volumes)
-    double inclinationCos = zInFeatRef / distance;
-    if (inclinationCos < - 1.0)
-      inclinationCos = - 1.0;
-    if (inclinationCos > 1.0)
-      inclinationCos = 1.0;
+    double inclination = inclinations[i_idx];
 
-    double inclination = std::acos (inclinationCos);
-
-    assert (inclination >= 0.0 && inclination <= PST_RAD_180);
+    // The angles are stored as floats, which may round pi up
+    assert (inclination >= 0.0 && inclination <= PST_RAD_180 + 1e-6);
 
     if (inclination > PST_RAD_90 || (std::abs (inclination - PST_RAD_90) < 1e-30 && zInFeatRef <= 0))
     {
@@ -392,7 +544,7 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     if (yInFeatRef != 0.0 || xInFeatRef != 0.0)
     {
       //Interpolation on the azimuth (adjacent horizontal volumes)
-      double azimuth = std::atan2 (yInFeatRef, xInFeatRef);
+      double azimuth = azimuths[i_idx];
 
       int sel = desc_index >> 2;
       double angularSectorSpan = PST_RAD_45;
@@ -400,7 +552,7 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
 
       double azimuthDistance = (azimuth - (angularSectorStart + angularSectorSpan*sel)) / angularSectorSpan;
 
-      assert ((azimuthDistance < 0.5 || areEquals (azimuthDistance, 0.5)) && (azimuthDistance > - 0.5 || areEquals (azimuthDistance, - 0.5)));
+      assert ((azimuthDistance < 0.5 || areEquals (azimuthDistance, 0.5, 1e-5)) && (azimuthDistance > - 0.5 || areEquals (azimuthDistance, - 0.5, 1e-5)));
 
       azimuthDistance = (std::max)(- 0.5, std::min (azimuthDistance, 0.5));
 
@@ -438,40 +590,30 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::interpolateDou
   const int nr_bins_color,
   Eigen::VectorXf &shot)
 {
-  const Eigen::Vector4f &central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
-  const PointRFT& current_frame = (*frames_)[index];
-
   int shapeToColorStride = nr_grid_sector_*(nr_bins_shape+1);
 
-  Eigen::Vector4f current_frame_x (current_frame.x_axis[0], current_frame.x_axis[1], current_frame.x_axis[2], 0);
-  Eigen::Vector4f current_frame_y (current_frame.y_axis[0], current_frame.y_axis[1], current_frame.y_axis[2], 0);
-  Eigen::Vector4f current_frame_z (current_frame.z_axis[0], current_frame.z_axis[1], current_frame.z_axis[2], 0);
+  // Express all the neighbors in the local reference frame at once, in a buffer reused across the points described
+  // by the calling thread
+  static thread_local std::vector<float> local;
+  this->computeLocalCoordinates (index, indices, sqr_dists, local);
+  const std::size_t nr_neighbors = indices.size ();
+  const float *x_local = local.data (), *y_local = x_local + nr_neighbors, *z_local = y_local + nr_neighbors;
+  const float *inclinations = z_local + nr_neighbors, *azimuths = inclinations + nr_neighbors;
 
   for (std::size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
     if (!std::isfinite(binDistanceShape[i_idx]))
       continue;
 
-    Eigen::Vector4f delta = surface_->points[indices[i_idx]].getVector4fMap () - central_point;
-    delta[3] = 0;
-
     // Compute the Euclidean norm
     double distance = sqrt (sqr_dists[i_idx]);
 
     if (areEquals (distance, 0.0))
       continue;
 
-    double xInFeatRef = delta.dot (current_frame_x);
-    double yInFeatRef = delta.dot (current_frame_y);
-    double zInFeatRef = delta.dot (current_frame_z);
-
-    // To avoid numerical problems afterwards
-    if (std::abs (yInFeatRef) < 1E-30)
-      yInFeatRef  = 0;
-    if (std::abs (xInFeatRef) < 1E-30)
-      xInFeatRef  = 0;
-    if (std::abs (zInFeatRef) < 1E-30)
-      zInFeatRef  = 0;
+    double xInFeatRef = x_local[i_idx];
+    double yInFeatRef = y_local[i_idx];
+    double zInFeatRef = z_local[i_idx];
 
     unsigned char bit4 = ((yInFeatRef > 0) || ((yInFeatRef == 0.0) && (xInFeatRef < 0))) ? 1 : 0;
     unsigned char bit3 = static_cast<unsigned char> (((xInFeatRef > 0) || ((xInFeatRef == 0.0) && (yInFeatRef > 0))) ? !bit4 : bit4);
@@ -553,15 +695,10 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::interpolateDou
     }
 
     //Interpolation on the inclination (adjacent vertical volumes)
-    double inclinationCos = zInFeatRef / distance;
-    if (inclinationCos < - 1.0)
-      inclinationCos = - 1.0;
-    if (inclinationCos > 1.0)
-      inclinationCos = 1.0;
-
-    double inclination = std::acos (inclinationCos);
+    double inclination = inclinations[i_idx];
 
-    assert (inclination >= 0.0 && inclination <= PST_RAD_180);
+    // The angles are stored as floats, which may round pi up
+    assert (inclination >= 0.0 && inclination <= PST_RAD_180 + 1e-6);
 
     if (inclination > PST_RAD_90 || (std::abs (inclination - PST_RAD_90) < 1e-30 && zInFeatRef <= 0))
     {
@@ -603,14 +740,14 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::interpolateDou
     if (yInFeatRef != 0.0 || xInFeatRef != 0.0)
     {
       //Interpolation on the azimuth (adjacent horizontal volumes)
-      double azimuth = std::atan2 (yInFeatRef, xInFeatRef);
+      double azimuth = azimuths[i_idx];
 
       int sel = desc_index >> 2;
       double angularSectorSpan = PST_RAD_45;
       double angularSectorStart = - PST_RAD_PI_7_8;
 
       double azimuthDistance = (azimuth - (angularSectorStart + angularSectorSpan*sel)) / angularSectorSpan;
-      assert ((azimuthDistance < 0.5 || areEquals (azimuthDistance, 0.5)) && (azimuthDistance > - 0.5 || areEquals (azimuthDistance, - 0.5)));
+      assert ((azimuthDistance < 0.5 || areEquals (azimuthDistance, 0.5, 1e-5)) && (azimuthDistance > - 0.5 || areEquals (azimuthDistance, - 0.5, 1e-5)));
       azimuthDistance = (std::max)(- 0.5, std::min (azimuthDistance, 0.5));
 
       if (azimuthDistance > 0)
@@ -688,18 +825,29 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSH
     aRef /= 120.0f;
     bRef /= 120.0f;    //normalized LAB components (0<L<1, -1<a<1, -1<b<1)
 
+    // Use the colors converted once for the whole surface, if available
+    const bool use_surface_lab = (surface_lab_cloud_ == surface_ && surface_lab_.size () == surface_->points.size ());
     for (const auto& idx: indices)
     {
-      unsigned char red = surface_->points[idx].r;
-      unsigned char green = surface_->points[idx].g;
-      unsigned char blue = surface_->points[idx].b;
-
       float L, a, b;
 
-      RGB2CIELAB (red, green, blue, L, a, b);
-      L /= 100.0f;
-      a /= 120.0f;
-      b /= 120.0f;   //normalized LAB components (0<L<1, -1<a<1, -1<b<1)
+      if (use_surface_lab)
+      {
+        L = surface_lab_[idx][0];
+        a = surface_lab_[idx][1];
+        b = surface_lab_[idx][2];
+      }
+      else
+      {
+        unsigned char red = surface_->points[idx].r;
+        unsigned char green = surface_->points[idx].g;
+        unsigned char blue = surface_->points[idx].b;
+
+        RGB2CIELAB (red, green, blue, L, a, b);
+        L /= 100.0f;
+        a /= 120.0f;
+        b /= 120.0f;   //normalized LAB components (0<L<1, -1<a<1, -1<b<1)
+      }
 
       double colorDistance = (std::fabs (LRef - L) + ((std::fabs (aRef - a) + std::fabs (bRef - b)) / 2)) /3;
 
@@ -727,6 +875,21 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSH
   this->normalizeHistogram (shot, descLength_);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeSurfaceLab ()
+{
+  surface_lab_cloud_ = surface_;
+  surface_lab_.resize (surface_->points.size ());
+  for (std::size_t i = 0; i < surface_->points.size (); ++i)
+  {
+    const PointInT &point = surface_->points[i];
+    float L, a, b;
+    RGB2CIELAB (point.r, point.g, point.b, L, a, b);
+    surface_lab_[i] = Eigen::Vector3f (L / 100.0f, a / 120.0f, b / 120.0f);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
@@ -844,6 +1007,9 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
 
   shot_.setZero (descLength_);
 
+  if (b_describe_color_)
+    computeSurfaceLab ();
+
   // Allocate enough space to hold the results
   // \note This resize is irrelevant for a radiusSearch ().
   std::vector<int> nn_indices (k_);
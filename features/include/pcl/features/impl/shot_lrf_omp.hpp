@@ -44,20 +44,6 @@
 #include <pcl/features/shot_lrf_omp.h>
 #include <pcl/features/shot_lrf.h>
 
-//////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointInT, typename PointOutT> void
-pcl::SHOTLocalReferenceFrameEstimationOMP<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
-{
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
-}
-
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT> void
 pcl::SHOTLocalReferenceFrameEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -72,26 +58,16 @@ pcl::SHOTLocalReferenceFrameEstimationOMP<PointInT, PointOutT>::computeFeature (
   }
   tree_->setSortedResults (true);
 
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  num_threads(threads_)
-  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (indices_->size ()); ++i)
+  // getLocalRF () searches for the neighbors itself, so the search buffers are not used
+  const auto compute_point = [this] (std::size_t i, std::vector<int>&, std::vector<float>&, PointOutT &output_rf)
   {
     // point result
     Eigen::Matrix3f rf;
-    PointOutT& output_rf = output[i];
 
     //output_rf.confidence = getLocalRF ((*indices_)[i], rf);
     //if (output_rf.confidence == std::numeric_limits<float>::max ())
 
-    std::vector<int> n_indices;
-    std::vector<float> n_sqr_distances;
-    this->searchForNeighbors ((*indices_)[i], search_parameter_, n_indices, n_sqr_distances);
-    if (getLocalRF ((*indices_)[i], rf) == std::numeric_limits<float>::max ())
-    {
-      output.is_dense = false;
-    }
+    const bool is_valid = getLocalRF ((*indices_)[i], rf) != std::numeric_limits<float>::max ();
 
     for (int d = 0; d < 3; ++d)
     {
@@ -99,8 +75,9 @@ pcl::SHOTLocalReferenceFrameEstimationOMP<PointInT, PointOutT>::computeFeature (
       output_rf.y_axis[d] = rf.row (1)[d];
       output_rf.z_axis[d] = rf.row (2)[d];
     }
-  }
-
+    return (is_valid);
+  };
+  this->computeFeatureParallel (output, compute_point);
 }
 
 #define PCL_INSTANTIATE_SHOTLocalReferenceFrameEstimationOMP(T,OutT) template class PCL_EXPORTS pcl::SHOTLocalReferenceFrameEstimationOMP<T,OutT>;
@@ -321,8 +321,8 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::initCompute ()
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void 
 pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
-{ 
-  for (std::size_t i_input = 0; i_input < indices_->size (); ++i_input)
+{
+  const auto compute_point = [this] (std::size_t i_input, std::vector<int> &, std::vector<float> &, PointOutT &point_out)
   {
     Eigen::ArrayXXd res = computeSiForPoint (indices_->at (i_input));
 
@@ -331,10 +331,12 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClo
     {
       for (Eigen::Index iCol = 0; iCol < res.cols () ; iCol++)
       {
-        output.points[i_input].histogram[ iRow*res.cols () + iCol ] = static_cast<float> (res (iRow, iCol));
+        point_out.histogram[ iRow*res.cols () + iCol ] = static_cast<float> (res (iRow, iCol));
       }
-    }   
-  } 
+    }
+    return (true);
+  };
+  this->computeFeatureParallel (output, compute_point);
 }
 
 #define PCL_INSTANTIATE_SpinImageEstimation(T,NT,OutT) template class PCL_EXPORTS pcl::SpinImageEstimation<T,NT,OutT>;
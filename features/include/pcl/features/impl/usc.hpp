@@ -142,7 +142,7 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initCompute ()
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT, typename PointRFT> void
-pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computePointDescriptor (std::size_t index, /*float rf[9],*/ std::vector<float> &desc)
+pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computePointDescriptor (std::size_t index, /*float rf[9],*/ std::vector<float> &desc) const
 {
   pcl::Vector3fMapConst origin = input_->points[(*indices_)[index]].getVector3fMap ();
 
@@ -228,10 +228,9 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computeFeature (PointClo
 
   output.is_dense = true;
 
-  for (std::size_t point_index = 0; point_index < indices_->size (); ++point_index)
+  const auto compute_point = [this] (std::size_t point_index, std::vector<int> &, std::vector<float> &,
+                                     PointOutT &point_out)
   {
-    //output[point_index].descriptor.resize (descriptor_length_);
-
     // If the point is not finite, set the descriptor to NaN and continue
     const PointRFT& current_frame = (*frames_)[point_index];
     if (!isFinite ((*input_)[(*indices_)[point_index]]) ||
@@ -239,24 +238,25 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::computeFeature (PointClo
         !std::isfinite (current_frame.y_axis[0]) ||
         !std::isfinite (current_frame.z_axis[0])  )
     {
-      std::fill (output.points[point_index].descriptor, output.points[point_index].descriptor + descriptor_length_,
+      std::fill (point_out.descriptor, point_out.descriptor + descriptor_length_,
                  std::numeric_limits<float>::quiet_NaN ());
-      std::fill (output.points[point_index].rf, output.points[point_index].rf + 9, 0);
-      output.is_dense = false;
-      continue;
+      std::fill (point_out.rf, point_out.rf + 9, 0);
+      return (false);
     }
 
     for (int d = 0; d < 3; ++d)
     {
-      output.points[point_index].rf[0 + d] = current_frame.x_axis[d];
-      output.points[point_index].rf[3 + d] = current_frame.y_axis[d];
-      output.points[point_index].rf[6 + d] = current_frame.z_axis[d];
+      point_out.rf[0 + d] = current_frame.x_axis[d];
+      point_out.rf[3 + d] = current_frame.y_axis[d];
+      point_out.rf[6 + d] = current_frame.z_axis[d];
     }
 
     std::vector<float> descriptor (descriptor_length_);
     computePointDescriptor (point_index, descriptor);
-    std::copy (descriptor.begin (), descriptor.end (), output.points[point_index].descriptor);
-  }
+    std::copy (descriptor.begin (), descriptor.end (), point_out.descriptor);
+    return (true);
+  };
+  this->computeFeatureParallel (output, compute_point);
 }
 
 #define PCL_INSTANTIATE_UniqueShapeContext(T,OutT,RFT) template class PCL_EXPORTS pcl::UniqueShapeContext<T,OutT,RFT>;
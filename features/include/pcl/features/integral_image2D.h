@@ -123,7 +123,8 @@ namespace pcl
         second_order_integral_image_ (),
         width_ (1), 
         height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1)
       {
       }
 
@@ -137,6 +138,13 @@ namespace pcl
       void 
       setSecondOrderComputation (bool compute_second_order_integral_images);
 
+      /** \brief Set the number of threads used to build the integral images. The result does not depend
+        * on the number of threads.
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -224,6 +232,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to build the integral images. */
+      unsigned int threads_;
    };
 
    /**
@@ -248,7 +259,8 @@ namespace pcl
         second_order_integral_image_ (),
         
         width_ (1), height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1)
       {
       }
 
@@ -256,6 +268,13 @@ namespace pcl
       virtual
       ~IntegralImage2D () { }
 
+      /** \brief Set the number of threads used to build the integral images. The result does not depend
+        * on the number of threads.
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -343,6 +362,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to build the integral images. */
+      unsigned int threads_;
    };
  }
 
@@ -70,6 +70,7 @@ namespace pcl
     using Feature<PointInT, PointOutT>::tree_;
     using Feature<PointInT, PointOutT>::k_;
     using Feature<PointInT, PointOutT>::indices_;
+    using Feature<PointInT, PointOutT>::threads_;
 
     public:
       using Ptr = shared_ptr<IntegralImageNormalEstimation<PointInT, PointOutT> >;
@@ -342,6 +343,31 @@ namespace pcl
 
     private:
 
+      /** \brief Computes the normal at the specified position, using a rectangle of the given size.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormal (const int pos_x, const int pos_y, const unsigned point_index,
+                          const int rect_width, const int rect_height, PointOutT &normal);
+
+      /** \brief Computes the normal at the specified position with mirroring for border handling, using a
+        * rectangle of the given size.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormalMirror (const int pos_x, const int pos_y, const unsigned point_index,
+                                const int rect_width, const int rect_height, PointOutT &normal);
+
       /** \brief Flip (in place) the estimated normal of a point towards a given viewpoint
         * \param point a given point
         * \param vp_x the X coordinate of the viewpoint
@@ -69,17 +69,13 @@ namespace pcl
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
 
       /** \brief Empty constructor. */
-      IntensityGradientEstimation () : intensity_ (), threads_ (0)
+      IntensityGradientEstimation () : intensity_ ()
       {
         feature_name_ = "IntensityGradientEstimation";
+        // Unlike most estimators, this one uses all the hardware threads by default
+        this->setNumberOfThreads (0);
       };
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      inline void
-      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
-
     protected:
       /** \brief Estimate the intensity gradients for a set of points given in <setInputCloud (), setIndices ()> using
         *  the surface in setSearchSurface () and the spatial locator in setSearchMethod ().
@@ -102,13 +98,11 @@ namespace pcl
                                      const Eigen::Vector3f &point, 
                                      float mean_intensity, 
                                      const Eigen::Vector3f &normal,
-                                     Eigen::Vector3f &gradient);
+                                     Eigen::Vector3f &gradient) const;
 
     protected:
       ///intensity field accessor structure
       IntensitySelectorT intensity_;
-      ///number of threads to be used, default 0 (auto)
-      unsigned int threads_;
   };
 }
 
@@ -0,0 +1,237 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_base.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/search/search.h>
+
+namespace pcl
+{
+  /** \brief NeighborhoodCache computes the neighborhoods of a set of query points once, so that they can be
+    * shared by several feature estimators which work on the same input, surface and search parameter.
+    *
+    * The neighbors are stored in compressed sparse row format: the neighbors of the i-th query point are
+    * the entries [offsets[i], offsets[i + 1]) of the neighbor indices and squared distances. A cache computed
+    * with a radius also serves searches with a smaller radius, and a cache computed with k nearest neighbors
+    * also serves searches with fewer neighbors.
+    *
+    * Usage example:
+    * \code
+    * pcl::NeighborhoodCache<pcl::PointXYZ>::Ptr neighborhoods (new pcl::NeighborhoodCache<pcl::PointXYZ>);
+    * neighborhoods->setInputCloud (cloud);
+    * neighborhoods->setRadiusSearch (0.03);
+    * neighborhoods->compute ();
+    *
+    * pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> ne;
+    * ne.setInputCloud (cloud);
+    * ne.setRadiusSearch (0.03);
+    * ne.setPrecomputedNeighborhoods (neighborhoods);
+    * ne.compute (*normals);
+    * \endcode
+    *
+    * \note The cache refers to the clouds by pointer, so it has to be recomputed if their points are modified.
+    * \ingroup features
+    */
+  template <typename PointT>
+  class NeighborhoodCache : public PCLBase<PointT>
+  {
+    public:
+      using PCLBase<PointT>::indices_;
+      using PCLBase<PointT>::input_;
+      using PCLBase<PointT>::initCompute;
+      using PCLBase<PointT>::deinitCompute;
+
+      using Ptr = shared_ptr<NeighborhoodCache<PointT> >;
+      using ConstPtr = shared_ptr<const NeighborhoodCache<PointT> >;
+
+      using KdTree = pcl::search::Search<PointT>;
+      using KdTreePtr = typename KdTree::Ptr;
+
+      using PointCloud = pcl::PointCloud<PointT>;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+      /** \brief Empty constructor. */
+      NeighborhoodCache () :
+        surface_ (), tree_ (), search_radius_ (0), k_ (0), threads_ (0),
+        computed_input_ (), computed_surface_ (), computed_radius_ (0), computed_k_ (0)
+      {
+      }
+
+      /** \brief Provide a pointer to the dataset in which the neighbors are searched. If it is not set, the
+        * neighbors are searched in the input cloud.
+        * \param[in] cloud a pointer to the search surface
+        */
+      inline void
+      setSearchSurface (const PointCloudConstPtr &cloud) { surface_ = cloud; }
+
+      /** \brief Get a pointer to the surface point cloud dataset. */
+      inline PointCloudConstPtr
+      getSearchSurface () const { return (surface_); }
+
+      /** \brief Provide a pointer to the search object.
+        * \param[in] tree a pointer to the spatial search object.
+        */
+      inline void
+      setSearchMethod (const KdTreePtr &tree) { tree_ = tree; }
+
+      /** \brief Get a pointer to the search method used. After compute (), this is the search object built on
+        * the search surface, which feature estimators without a search method of their own reuse.
+        */
+      inline KdTreePtr
+      getSearchMethod () const { return (tree_); }
+
+      /** \brief Set the number of k nearest neighbors to search for.
+        * \param[in] k the number of k-nearest neighbors
+        */
+      inline void
+      setKSearch (int k) { k_ = k; }
+
+      /** \brief Get the number of k nearest neighbors to search for. */
+      inline int
+      getKSearch () const { return (k_); }
+
+      /** \brief Set the sphere radius that is to be used for determining the nearest neighbors.
+        * \param[in] radius the sphere radius used as the maximum distance to consider a point a neighbor
+        */
+      inline void
+      setRadiusSearch (double radius) { search_radius_ = radius; }
+
+      /** \brief Get the sphere radius used for determining the neighbors. */
+      inline double
+      getRadiusSearch () const { return (search_radius_); }
+
+      /** \brief Set the number of threads to use for the neighbor searches.
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Search the neighbors of all points given in <setInputCloud (), setIndices ()> in the surface
+        * given in setSearchSurface (), using the spatial locator in setSearchMethod ().
+        * \return true if the neighborhoods were computed, false otherwise
+        */
+      bool
+      compute ();
+
+      /** \brief Check whether the neighborhoods can be used in place of a search with the given parameters.
+        * \param[in] input the cloud of the query points
+        * \param[in] surface the cloud in which the neighbors are searched
+        * \param[in] radius the search radius, or 0 for a k nearest neighbors search
+        * \param[in] k the number of nearest neighbors, or 0 for a radius search
+        */
+      bool
+      isCompatible (const PointCloudConstPtr &input, const PointCloudConstPtr &surface, double radius, int k) const;
+
+      /** \brief Get the cached neighbors of a point.
+        * \param[in] index the index of the query point in the input cloud
+        * \param[in] parameter the search parameter: the radius, or the number of neighbors for a cache computed
+        * with setKSearch ()
+        * \param[out] k_indices the indices of the neighbors in the search surface
+        * \param[out] k_sqr_distances the squared distances to the neighbors
+        * \return the number of neighbors, or -1 if the neighbors of the point were not computed or the
+        * search parameter exceeds the one of the cache
+        */
+      int
+      getNeighbors (std::size_t index, double parameter,
+                    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+      /** \brief Get the offsets of the neighborhoods of the query points, one more than the number of queries. */
+      inline const std::vector<std::size_t>&
+      getOffsets () const { return (offsets_); }
+
+      /** \brief Get the indices of the neighbors of all query points, in the order of the queries. */
+      inline const std::vector<int>&
+      getNeighborIndices () const { return (neighbor_indices_); }
+
+      /** \brief Get the squared distances to the neighbors of all query points, in the order of the queries. */
+      inline const std::vector<float>&
+      getSquaredDistances () const { return (sqr_distances_); }
+
+    protected:
+      /** \brief An input point cloud describing the surface in which the neighbors are searched. */
+      PointCloudConstPtr surface_;
+
+      /** \brief A pointer to the spatial search object. */
+      KdTreePtr tree_;
+
+      /** \brief The nearest neighbors search radius. */
+      double search_radius_;
+
+      /** \brief The number of K nearest neighbors to search for. */
+      int k_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief The input cloud the neighborhoods were computed for. */
+      PointCloudConstPtr computed_input_;
+
+      /** \brief The surface the neighborhoods were computed in. */
+      PointCloudConstPtr computed_surface_;
+
+      /** \brief The search radius the neighborhoods were computed with. */
+      double computed_radius_;
+
+      /** \brief The number of nearest neighbors the neighborhoods were computed with. */
+      int computed_k_;
+
+      /** \brief The query row of every point of the input cloud, -1 for the points which were not queried. */
+      std::vector<int> rows_;
+
+      /** \brief The offsets of the neighborhoods in neighbor_indices_ and sqr_distances_. */
+      std::vector<std::size_t> offsets_;
+
+      /** \brief The indices of the neighbors, in the order of the queries. */
+      std::vector<int> neighbor_indices_;
+
+      /** \brief The squared distances to the neighbors, in the order of the queries. */
+      std::vector<float> sqr_distances_;
+
+      /** \brief Get a string representation of the name of this class. */
+      inline const char*
+      getClassName () const { return ("NeighborhoodCache"); }
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#include <pcl/features/impl/neighborhood_cache.hpp>
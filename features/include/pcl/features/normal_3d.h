@@ -44,6 +44,7 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/features/feature.h>
 #include <pcl/common/centroid.h>
+#include <pcl/common/local_surface_statistics.h>
 
 namespace pcl
 {
@@ -94,19 +95,19 @@ namespace pcl
   computePointNormal (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices,
                       Eigen::Vector4f &plane_parameters, float &curvature)
   {
-    // Placeholder for the 3x3 covariance matrix at each surface patch
-    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
-    // 16-bytes aligned placeholder for the XYZ centroid of a surface patch
-    Eigen::Vector4f xyz_centroid;
+    LocalSurfaceStatistics statistics;
     if (indices.size () < 3 ||
-        computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix, xyz_centroid) == 0)
+        computeLocalSurfaceStatistics (cloud, indices, statistics, false) == 0)
     {
       plane_parameters.setConstant (std::numeric_limits<float>::quiet_NaN ());
       curvature = std::numeric_limits<float>::quiet_NaN ();
       return false;
     }
     // Get the plane normal and surface curvature
-    solvePlaneParameters (covariance_matrix, xyz_centroid, plane_parameters, curvature);
+    const Eigen::Vector4f xyz_centroid (static_cast<float> (statistics.centroid[0]),
+                                        static_cast<float> (statistics.centroid[1]),
+                                        static_cast<float> (statistics.centroid[2]), 1.0f);
+    solvePlaneParameters (statistics.covariance.cast<float> (), xyz_centroid, plane_parameters, curvature);
     return true;
   }
 
@@ -284,8 +285,7 @@ namespace pcl
       computePointNormal (const pcl::PointCloud<PointInT> &cloud, const std::vector<int> &indices,
                           Eigen::Vector4f &plane_parameters, float &curvature)
       {
-        if (indices.size () < 3 ||
-            computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix_, xyz_centroid_) == 0)
+        if (indices.size () < 3 || !computeCentroidAndCovariance (cloud, indices))
         {
           plane_parameters.setConstant (std::numeric_limits<float>::quiet_NaN ());
           curvature = std::numeric_limits<float>::quiet_NaN ();
@@ -313,8 +313,7 @@ namespace pcl
       computePointNormal (const pcl::PointCloud<PointInT> &cloud, const std::vector<int> &indices,
                           float &nx, float &ny, float &nz, float &curvature)
       {
-        if (indices.size () < 3 ||
-            computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix_, xyz_centroid_) == 0)
+        if (indices.size () < 3 || !computeCentroidAndCovariance (cloud, indices))
         {
           nx = ny = nz = curvature = std::numeric_limits<float>::quiet_NaN ();
           return false;
@@ -405,6 +404,23 @@ namespace pcl
         * from NormalEstimation and provide your own computeFeature (). By default, the viewpoint is set to 0,0,0. */
       float vpx_, vpy_, vpz_;
 
+      /** \brief Compute the centroid and the covariance matrix of a surface patch into xyz_centroid_ and
+        * covariance_matrix_, with pcl::computeLocalSurfaceStatistics.
+        * \param cloud the input point cloud
+        * \param indices the point cloud indices that need to be used
+        * \return false if none of the points is finite
+        */
+      inline bool
+      computeCentroidAndCovariance (const pcl::PointCloud<PointInT> &cloud, const std::vector<int> &indices)
+      {
+        LocalSurfaceStatistics statistics;
+        if (computeLocalSurfaceStatistics (cloud, indices, statistics, false) == 0)
+          return (false);
+        covariance_matrix_ = statistics.covariance.cast<float> ();
+        xyz_centroid_ << statistics.centroid.cast<float> (), 1.0f;
+        return (true);
+      }
+
       /** \brief Placeholder for the 3x3 covariance matrix at each surface patch. */
       EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix_;
 
@@ -104,7 +104,8 @@ namespace pcl
         key_list_ (),
         // Default 1GB memory size. Need to set it to something more conservative.
         max_cache_size_ ((1ul*1024ul*1024ul*1024ul) / sizeof (std::pair<std::pair<int, int>, Eigen::Vector4f>)),
-        use_cache_ (false)
+        use_cache_ (false),
+        fast_atan2_ (false)
       {
         feature_name_ = "PFHEstimation";
       };
@@ -130,7 +131,8 @@ namespace pcl
         * \note Depending on how the point cloud is ordered and how the nearest
         * neighbors are estimated, using a cache could have a positive or a
         * negative influence. Please test with and without a cache on your
-        * data, and choose whatever works best!
+        * data, and choose whatever works best! Without the cache, the pairs formed by each neighbor are evaluated
+        * in batches (see pcl::computePairFeatures), which is usually the faster option.
         *
         * See \ref setMaximumCacheSize for setting the maximum cache size
         *
@@ -149,6 +151,23 @@ namespace pcl
         return (use_cache_);
       }
 
+      /** \brief Set whether the first angular feature is computed with the polynomial approximation
+        * pcl::fastAtan2 instead of std::atan2 (default: false). Only used when the internal cache is disabled.
+        * \param[in] fast_atan2 true to use the approximation
+        */
+      inline void
+      setUseFastAtan2 (bool fast_atan2)
+      {
+        fast_atan2_ = fast_atan2;
+      }
+
+      /** \brief Get whether the first angular feature is computed with pcl::fastAtan2. */
+      inline bool
+      getUseFastAtan2 () const
+      {
+        return (fast_atan2_);
+      }
+
       /** \brief Compute the 4-tuple representation containing the three angles and one distance between two points
         * represented by Cartesian coordinates and normals.
         * \note For explanations about the features, please see the literature mentioned above (the order of the
@@ -214,6 +233,9 @@ namespace pcl
 
       /** \brief Set to true to use the internal cache for removing redundant computations. */
       bool use_cache_;
+
+      /** \brief Set to true to compute the first angular feature with pcl::fastAtan2. */
+      bool fast_atan2_;
   };
 }
 
@@ -44,6 +44,8 @@
 #include <pcl/pcl_exports.h>
 #include <Eigen/Core>
 
+#include <cstddef>
+
 namespace pcl
 {
   /** \brief Compute the 4-tuple representation containing the three angles and one distance between two points
@@ -67,6 +69,46 @@ namespace pcl
                        const Eigen::Vector4f &p2, const Eigen::Vector4f &n2, 
                        float &f1, float &f2, float &f3, float &f4);
 
+  /** \brief Compute the 4-tuple representation of the pairs formed by one point and a batch of points, see the
+    * single pair version above. The batch is passed as separate coordinate arrays, which allows for evaluating
+    * several pairs at once (eight with AVX2).
+    * \param[in] p1 the first XYZ point
+    * \param[in] n1 the first surface normal
+    * \param[in] nr_pairs the number of points in the batch
+    * \param[in] x2 the x coordinates of the second points
+    * \param[in] y2 the y coordinates of the second points
+    * \param[in] z2 the z coordinates of the second points
+    * \param[in] nx2 the x components of the second surface normals
+    * \param[in] ny2 the y components of the second surface normals
+    * \param[in] nz2 the z components of the second surface normals
+    * \param[out] f1 the first angular features, \a nr_pairs values
+    * \param[out] f2 the second angular features, \a nr_pairs values
+    * \param[out] f3 the third angular features, \a nr_pairs values
+    * \param[out] f4 the distance features, \a nr_pairs values
+    * \param[in] fast_atan2 compute \a f1 with pcl::fastAtan2 instead of std::atan2
+    * \return the number of pairs for which the features are defined. For the others (coincident points, or normal
+    * parallel to the connecting line) all four features are set to 0, which is the only case where \a f4 is 0.
+    *
+    * \note As for the single pair version, the point data is assumed to be finite.
+    * \ingroup features
+    */
+  PCL_EXPORTS std::size_t
+  computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, std::size_t nr_pairs,
+                       const float *x2, const float *y2, const float *z2,
+                       const float *nx2, const float *ny2, const float *nz2,
+                       float *f1, float *f2, float *f3, float *f4, bool fast_atan2 = false);
+
+  /** \brief Polynomial approximation of std::atan2, with a maximum absolute error of about 1e-5 rad. This is
+    * well below the bin width of the angular histograms (2 * pi / 11 for FPFH), so only values very close to a
+    * bin boundary may be binned differently than with std::atan2.
+    * \param[in] y the y coordinate
+    * \param[in] x the x coordinate
+    * \return the angle in [-pi, pi]; 0 if both \a x and \a y are 0
+    * \ingroup features
+    */
+  PCL_EXPORTS float
+  fastAtan2 (float y, float x);
+
   PCL_EXPORTS bool
   computeRGBPairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, const Eigen::Vector4i &colors1,
                           const Eigen::Vector4f &p2, const Eigen::Vector4f &n2, const Eigen::Vector4i &colors2,
@@ -75,12 +75,7 @@ namespace pcl
       using PointCloudIn = pcl::PointCloud<PointInT>;
 
       /** \brief Empty constructor. */
-      PrincipalCurvaturesEstimation () : 
-        xyz_centroid_ (Eigen::Vector3f::Zero ()), 
-        demean_ (Eigen::Vector3f::Zero ()),
-        covariance_matrix_ (Eigen::Matrix3f::Zero ()),
-        eigenvector_ (Eigen::Vector3f::Zero ()),
-        eigenvalues_ (Eigen::Vector3f::Zero ())
+      PrincipalCurvaturesEstimation ()
       {
         feature_name_ = "PrincipalCurvaturesEstimation";
       };
@@ -100,7 +95,7 @@ namespace pcl
       void
       computePointPrincipalCurvatures (const pcl::PointCloud<PointNT> &normals,
                                        int p_idx, const std::vector<int> &indices,
-                                       float &pcx, float &pcy, float &pcz, float &pc1, float &pc2);
+                                       float &pcx, float &pcy, float &pcz, float &pc1, float &pc2) const;
 
     protected:
 
@@ -111,24 +106,6 @@ namespace pcl
         */
       void
       computeFeature (PointCloudOut &output) override;
-
-    private:
-      /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
-      std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > projected_normals_;
-
-      /** \brief SSE aligned placeholder for the XYZ centroid of a surface patch. */
-      Eigen::Vector3f xyz_centroid_;
-
-      /** \brief Temporary point placeholder. */
-      Eigen::Vector3f demean_;
-
-      /** \brief Placeholder for the 3x3 covariance matrix at each surface patch. */
-      EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix_;
-
-      /** \brief SSE aligned eigenvectors placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvector_;
-      /** \brief eigenvalues placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvalues_;
   };
 }
 
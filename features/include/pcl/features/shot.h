@@ -81,8 +81,10 @@ namespace pcl
       using Feature<PointInT, PointOutT>::fake_surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_never_defined_;
 
       using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
+      using PointCloudLRFConstPtr = typename FeatureWithLocalReferenceFrames<PointInT, PointRFT>::PointCloudLRFConstPtr;
 
     protected:
       /** \brief Empty constructor.
@@ -125,13 +127,56 @@ namespace pcl
       virtual float
       getLRFRadius () const { return lrf_radius_; }
 
+      /** \brief Provide the local reference frames of all the points of the input cloud, e.g. computed once with
+        * SHOTLocalReferenceFrameEstimationOMP. Each compute () then picks the frames of the points in setIndices ()
+        * instead of estimating them, which allows for describing the keypoints of a cloud in several batches.
+        * Takes precedence over setInputReferenceFrames (); set to null to estimate the frames again.
+        * \param[in] frames the reference frames, one per point of the input cloud
+        */
+      inline void
+      setInputCloudReferenceFrames (const PointCloudLRFConstPtr &frames)
+      {
+        if (!frames && cloud_frames_)
+          frames_never_defined_ = true;
+        cloud_frames_ = frames;
+      }
+
+      /** \brief Get the local reference frames of all the points of the input cloud. */
+      inline PointCloudLRFConstPtr
+      getInputCloudReferenceFrames () const { return (cloud_frames_); }
+
     protected:
 
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute () override;
 
+      /** \brief Pick the frames of the points in indices_ from the ones given with setInputCloudReferenceFrames (),
+        * if any, as the frames to use.
+        * \return false if the frames do not match the input cloud
+        */
+      bool
+      initCloudReferenceFrames ();
+
+      /** \brief Express the neighbors of a point in its local reference frame, in a single pass over the
+        * neighborhood (vectorized with AVX2 when available).
+        * \param[in] index the index of the point in indices_
+        * \param[in] indices the neighborhood point indices in surface_
+        * \param[in] sqr_dists the neighborhood point distances
+        * \param[out] local the x, y and z coordinates of the neighbors in the reference frame, their inclination and
+        * their azimuth, each as a contiguous block of indices.size () values. Coordinates below 1e-30 in absolute
+        * value are set to 0.
+        */
+      void
+      computeLocalCoordinates (const int index,
+                               const std::vector<int> &indices,
+                               const std::vector<float> &sqr_dists,
+                               std::vector<float> &local) const;
+
       /** \brief Quadrilinear interpolation used when color and shape descriptions are NOT activated simultaneously
+        * \note Only the projection of the neighbors in the local reference frame is vectorized (see
+        * computeLocalCoordinates ()); the interpolation weights and the votes into the histogram bins are computed
+        * one neighbor at a time.
         *
         * \param[in] indices the neighborhood point indices
         * \param[in] sqr_dists the neighborhood point distances
@@ -194,6 +239,9 @@ namespace pcl
 
       /** \brief One SHOT length. */
       int descLength_;
+
+      /** \brief The reference frames of all the points of the input cloud, if given. */
+      PointCloudLRFConstPtr cloud_frames_;
   };
 
   /** \brief SHOTEstimation estimates the Signature of Histograms of OrienTations (SHOT) descriptor for
@@ -360,6 +408,7 @@ namespace pcl
       computeFeature (pcl::PointCloud<PointOutT> &output) override;
 
       /** \brief Quadrilinear interpolation; used when color and shape descriptions are both activated
+        * \note As in interpolateSingleChannel (), only the projection of the neighbors is vectorized.
         * \param[in] indices the neighborhood point indices
         * \param[in] sqr_dists the neighborhood point distances
         * \param[in] index the index of the point in indices_
@@ -388,6 +437,19 @@ namespace pcl
       /** \brief The number of bins in each color histogram. */
       int nr_color_bins_;
 
+      /** \brief The normalized CIELab colors of the search surface \a surface_lab_cloud_. */
+      std::vector<Eigen::Vector3f> surface_lab_;
+
+      /** \brief The search surface whose colors are in \a surface_lab_. */
+      typename Feature<PointInT, PointOutT>::PointCloudInConstPtr surface_lab_cloud_;
+
+      /** \brief Convert the colors of all the points of the search surface to normalized CIELab (0<L<1, -1<a<1,
+        * -1<b<1), so that they are not converted again for every neighborhood they belong to. The colors are
+        * converted again by every compute () call, so that colors edited in place are never stale.
+        */
+      void
+      computeSurfaceLab ();
+
     public:
       /** \brief Converts RGB triplets to CIELab space.
         * \param[in] R the red channel
@@ -46,7 +46,7 @@
 namespace pcl
 {
   /** \brief SHOTEstimationOMP estimates the Signature of Histograms of OrienTations (SHOT) descriptor for a given point cloud dataset
-    * containing points and normals, in parallel, using the OpenMP standard.
+    * containing points and normals, in parallel, with the threads of pcl::parallel.
     *
     * The suggested PointOutT is pcl::SHOT352.
     *
@@ -82,6 +82,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::fake_surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using Feature<PointInT, PointOutT>::threads_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::lrf_radius_;
       using SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::descLength_;
       using SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::nr_grid_sector_;
@@ -97,15 +98,9 @@ namespace pcl
       /** \brief Empty constructor. */
       SHOTEstimationOMP (unsigned int nr_threads = 0) : SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT> ()
       {
-        setNumberOfThreads(nr_threads);
+        this->setNumberOfThreads (nr_threads);
       };
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      void
-      setNumberOfThreads (unsigned int nr_threads = 0);
-
     protected:
 
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
@@ -119,13 +114,10 @@ namespace pcl
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute () override;
-
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
   };
 
   /** \brief SHOTColorEstimationOMP estimates the Signature of Histograms of OrienTations (SHOT) descriptor for a given point cloud dataset
-    * containing points, normals and colors, in parallel, using the OpenMP standard.
+    * containing points, normals and colors, in parallel, with the threads of pcl::parallel.
     *
     * The suggested PointOutT is pcl::SHOT1344.
     *
@@ -161,6 +153,7 @@ namespace pcl
       using Feature<PointInT, PointOutT>::fake_surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using Feature<PointInT, PointOutT>::threads_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::lrf_radius_;
       using SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::descLength_;
       using SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::nr_grid_sector_;
@@ -182,15 +175,9 @@ namespace pcl
                               unsigned int nr_threads = 0)
         : SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT> (describe_shape, describe_color)
       {
-        setNumberOfThreads(nr_threads);
+        this->setNumberOfThreads (nr_threads);
       }
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
-        */
-      void
-      setNumberOfThreads (unsigned int nr_threads = 0);
-
     protected:
 
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
@@ -204,9 +191,6 @@ namespace pcl
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute () override;
-
-      /** \brief The number of threads the scheduler should use. */
-      unsigned int threads_;
   };
 
 }
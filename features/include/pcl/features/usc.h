@@ -142,7 +142,7 @@ namespace pcl
         * \param[out] desc descriptor to compute
         */
       void
-      computePointDescriptor (std::size_t index, std::vector<float> &desc);
+      computePointDescriptor (std::size_t index, std::vector<float> &desc) const;
 
       /** \brief Initialize computation by allocating all the intervals and the volume lookup table. */
       bool
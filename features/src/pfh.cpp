@@ -40,6 +40,10 @@
 #include <pcl/features/impl/pfh.hpp>
 #include <pcl/features/impl/pfhrgb.hpp>
 
+#if defined(__AVX__) && defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 bool
 pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, 
@@ -102,6 +106,175 @@ pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
   return (true);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+float
+pcl::fastAtan2 (float y, float x)
+{
+  const float abs_y = std::abs (y), abs_x = std::abs (x);
+  const float max_abs = (std::max) (abs_y, abs_x);
+  if (max_abs == 0.0f)
+    return (0.0f);
+  const float a = (std::min) (abs_y, abs_x) / max_abs;
+  const float s = a * a;
+  // Polynomial approximation 4.4.47 from Abramowitz & Stegun for atan (a) on [0, 1]
+  float r = ((((0.0208351f * s - 0.0851330f) * s + 0.1801410f) * s - 0.3302995f) * s + 0.9998660f) * a;
+  if (abs_y > abs_x)
+    r = static_cast<float> (M_PI_2) - r;
+  if (x < 0.0f)
+    r = static_cast<float> (M_PI) - r;
+  return (y < 0.0f ? -r : r);
+}
+
+namespace
+{
+  /** Pair features of a single pair, for the remainder of computePairFeatures (batch). Same computation
+    * as pcl::computePairFeatures, written on separate coordinates. */
+  inline bool
+  computePairFeaturesSingle (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
+                             float x2, float y2, float z2, float nx2, float ny2, float nz2,
+                             float &f1, float &f2, float &f3, float &f4, bool fast_atan2)
+  {
+    Eigen::Vector3f d (x2 - p1[0], y2 - p1[1], z2 - p1[2]);
+    Eigen::Vector3f u = n1.head<3> (), n2 (nx2, ny2, nz2);
+    f4 = d.norm ();
+    if (f4 == 0.0f)
+    {
+      f1 = f2 = f3 = f4 = 0.0f;
+      return (false);
+    }
+
+    const float angle1 = u.dot (d) / f4;
+    const float angle2 = n2.dot (d) / f4;
+    // Same as comparing the arc cosines of the absolute values, which decrease with them
+    if (std::abs (angle1) < std::abs (angle2))
+    {
+      std::swap (u, n2);
+      d = -d;
+      f3 = -angle2;
+    }
+    else
+      f3 = angle1;
+
+    Eigen::Vector3f v = d.cross (u);
+    const float v_norm = v.norm ();
+    if (v_norm == 0.0f)
+    {
+      f1 = f2 = f3 = f4 = 0.0f;
+      return (false);
+    }
+    v /= v_norm;
+    const Eigen::Vector3f w = u.cross (v);
+
+    f2 = v.dot (n2);
+    f1 = fast_atan2 ? pcl::fastAtan2 (w.dot (n2), u.dot (n2)) : std::atan2 (w.dot (n2), u.dot (n2));
+    return (true);
+  }
+
+#if defined(__AVX__) && defined(__AVX2__)
+  /** Eight lanes of pcl::fastAtan2. */
+  inline __m256
+  fastAtan2x8 (const __m256 y, const __m256 x)
+  {
+    const __m256 sign_mask = _mm256_set1_ps (-0.0f);
+    const __m256 abs_y = _mm256_andnot_ps (sign_mask, y), abs_x = _mm256_andnot_ps (sign_mask, x);
+    const __m256 max_abs = _mm256_max_ps (abs_y, abs_x);
+    const __m256 nonzero = _mm256_cmp_ps (max_abs, _mm256_setzero_ps (), _CMP_NEQ_OQ);
+    const __m256 a = _mm256_and_ps (nonzero, _mm256_div_ps (_mm256_min_ps (abs_y, abs_x), max_abs));
+    const __m256 s = _mm256_mul_ps (a, a);
+    __m256 r = _mm256_set1_ps (0.0208351f);
+    r = _mm256_add_ps (_mm256_mul_ps (r, s), _mm256_set1_ps (-0.0851330f));
+    r = _mm256_add_ps (_mm256_mul_ps (r, s), _mm256_set1_ps (0.1801410f));
+    r = _mm256_add_ps (_mm256_mul_ps (r, s), _mm256_set1_ps (-0.3302995f));
+    r = _mm256_add_ps (_mm256_mul_ps (r, s), _mm256_set1_ps (0.9998660f));
+    r = _mm256_mul_ps (r, a);
+    r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (static_cast<float> (M_PI_2)), r), _mm256_cmp_ps (abs_y, abs_x, _CMP_GT_OQ));
+    r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (static_cast<float> (M_PI)), r), _mm256_cmp_ps (x, _mm256_setzero_ps (), _CMP_LT_OQ));
+    r = _mm256_blendv_ps (r, _mm256_xor_ps (r, sign_mask), _mm256_cmp_ps (y, _mm256_setzero_ps (), _CMP_LT_OQ));
+    return (_mm256_and_ps (nonzero, r));
+  }
+
+  /** Dot product of eight pairs of 3D vectors. */
+  inline __m256
+  dot3 (const __m256 ax, const __m256 ay, const __m256 az, const __m256 bx, const __m256 by, const __m256 bz)
+  {
+    return (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (ax, bx), _mm256_mul_ps (ay, by)), _mm256_mul_ps (az, bz)));
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, std::size_t nr_pairs,
+                          const float *x2, const float *y2, const float *z2,
+                          const float *nx2, const float *ny2, const float *nz2,
+                          float *f1, float *f2, float *f3, float *f4, bool fast_atan2)
+{
+  std::size_t nr_valid = 0;
+  std::size_t i = 0;
+#if defined(__AVX__) && defined(__AVX2__)
+  const __m256 zero = _mm256_setzero_ps ();
+  const __m256 sign_mask = _mm256_set1_ps (-0.0f);
+  const __m256 p1x = _mm256_set1_ps (p1[0]), p1y = _mm256_set1_ps (p1[1]), p1z = _mm256_set1_ps (p1[2]);
+  const __m256 n1x = _mm256_set1_ps (n1[0]), n1y = _mm256_set1_ps (n1[1]), n1z = _mm256_set1_ps (n1[2]);
+  alignas (32) float atan2_y[8], atan2_x[8];
+  for (; i + 8 <= nr_pairs; i += 8)
+  {
+    __m256 dx = _mm256_sub_ps (_mm256_loadu_ps (x2 + i), p1x);
+    __m256 dy = _mm256_sub_ps (_mm256_loadu_ps (y2 + i), p1y);
+    __m256 dz = _mm256_sub_ps (_mm256_loadu_ps (z2 + i), p1z);
+    const __m256 n2x = _mm256_loadu_ps (nx2 + i), n2y = _mm256_loadu_ps (ny2 + i), n2z = _mm256_loadu_ps (nz2 + i);
+
+    const __m256 dist = _mm256_sqrt_ps (dot3 (dx, dy, dz, dx, dy, dz));
+    const __m256 angle1 = _mm256_div_ps (dot3 (n1x, n1y, n1z, dx, dy, dz), dist);
+    const __m256 angle2 = _mm256_div_ps (dot3 (n2x, n2y, n2z, dx, dy, dz), dist);
+
+    // Make sure the same point is selected as 1 and 2 for each pair
+    const __m256 swap = _mm256_cmp_ps (_mm256_andnot_ps (sign_mask, angle1), _mm256_andnot_ps (sign_mask, angle2), _CMP_LT_OQ);
+    const __m256 ux = _mm256_blendv_ps (n1x, n2x, swap), uy = _mm256_blendv_ps (n1y, n2y, swap), uz = _mm256_blendv_ps (n1z, n2z, swap);
+    const __m256 mx = _mm256_blendv_ps (n2x, n1x, swap), my = _mm256_blendv_ps (n2y, n1y, swap), mz = _mm256_blendv_ps (n2z, n1z, swap);
+    const __m256 flip = _mm256_and_ps (swap, sign_mask);
+    dx = _mm256_xor_ps (dx, flip);
+    dy = _mm256_xor_ps (dy, flip);
+    dz = _mm256_xor_ps (dz, flip);
+    const __m256 angle = _mm256_xor_ps (_mm256_blendv_ps (angle1, angle2, swap), flip);
+
+    // Darboux frame u-v-w: v = d x u / || d x u ||, w = u x v
+    __m256 vx = _mm256_sub_ps (_mm256_mul_ps (dy, uz), _mm256_mul_ps (dz, uy));
+    __m256 vy = _mm256_sub_ps (_mm256_mul_ps (dz, ux), _mm256_mul_ps (dx, uz));
+    __m256 vz = _mm256_sub_ps (_mm256_mul_ps (dx, uy), _mm256_mul_ps (dy, ux));
+    const __m256 v_norm = _mm256_sqrt_ps (dot3 (vx, vy, vz, vx, vy, vz));
+    vx = _mm256_div_ps (vx, v_norm);
+    vy = _mm256_div_ps (vy, v_norm);
+    vz = _mm256_div_ps (vz, v_norm);
+    const __m256 wx = _mm256_sub_ps (_mm256_mul_ps (uy, vz), _mm256_mul_ps (uz, vy));
+    const __m256 wy = _mm256_sub_ps (_mm256_mul_ps (uz, vx), _mm256_mul_ps (ux, vz));
+    const __m256 wz = _mm256_sub_ps (_mm256_mul_ps (ux, vy), _mm256_mul_ps (uy, vx));
+
+    const __m256 valid = _mm256_and_ps (_mm256_cmp_ps (dist, zero, _CMP_NEQ_OQ), _mm256_cmp_ps (v_norm, zero, _CMP_NEQ_OQ));
+    const __m256 wn = dot3 (wx, wy, wz, mx, my, mz), un = dot3 (ux, uy, uz, mx, my, mz);
+    if (fast_atan2)
+      _mm256_storeu_ps (f1 + i, _mm256_and_ps (valid, fastAtan2x8 (wn, un)));
+    else
+    {
+      _mm256_store_ps (atan2_y, wn);
+      _mm256_store_ps (atan2_x, un);
+      for (int j = 0; j < 8; ++j)
+        f1[i + j] = std::atan2 (atan2_y[j], atan2_x[j]);
+      _mm256_storeu_ps (f1 + i, _mm256_and_ps (valid, _mm256_loadu_ps (f1 + i)));
+    }
+    _mm256_storeu_ps (f2 + i, _mm256_and_ps (valid, dot3 (vx, vy, vz, mx, my, mz)));
+    _mm256_storeu_ps (f3 + i, _mm256_and_ps (valid, angle));
+    _mm256_storeu_ps (f4 + i, _mm256_and_ps (valid, dist));
+    nr_valid += _mm_popcnt_u32 (static_cast<unsigned int> (_mm256_movemask_ps (valid)));
+  }
+#endif
+  for (; i < nr_pairs; ++i)
+    if (computePairFeaturesSingle (p1, n1, x2[i], y2[i], z2[i], nx2[i], ny2[i], nz2[i],
+                                   f1[i], f2[i], f3[i], f4[i], fast_atan2))
+      ++nr_valid;
+  return (nr_valid);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 bool
 pcl::computeRGBPairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, const Eigen::Vector4i &colors1,
@@ -76,8 +76,8 @@ namespace pcl
           setNumberOfThreads(nr_threads);
       }
 
-      /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+      /** \brief Set the number of threads to use.
+        * \param nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
         */
       void
       setNumberOfThreads (unsigned int nr_threads = 0);
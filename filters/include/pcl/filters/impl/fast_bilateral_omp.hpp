@@ -42,20 +42,14 @@
 
 #include <pcl/filters/fast_bilateral_omp.h>
 #include <pcl/common/io.h>
+#include <pcl/common/parallel.h>
 #include <cassert>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::FastBilateralFilterOMP<PointT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -86,13 +80,12 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
     PCL_WARN ("[pcl::FastBilateralFilterOMP] Given an empty cloud. Doing nothing.\n");
     return;
   }
-#pragma omp parallel for \
-  default(none) \
-  shared(base_min, base_max, output) \
-  num_threads(threads_)
-  for (long int i = 0; i < static_cast<long int> (output.size ()); ++i)
-    if (!std::isfinite (output.at(i).z))
-      output.at(i).z = base_max;
+  pcl::parallel::parallel_for (std::size_t (0), output.size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+      if (!std::isfinite (output.at(i).z))
+        output.at(i).z = base_max;
+  }, threads_);
 
   const float base_delta = base_max - base_min;
 
@@ -104,41 +97,33 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
   const std::size_t small_depth  = static_cast<std::size_t> (base_delta / sigma_r_)   + 1 + 2 * padding_z;
 
   Array3D data (small_width, small_height, small_depth);
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  shared(base_min, data, output) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(base_min, data, output, small_height, small_width) \
-  num_threads(threads_)	
-#endif
-  for (long int i = 0; i < static_cast<long int> (small_width * small_height); ++i)
+  pcl::parallel::parallel_for (std::size_t (0), small_width * small_height, [&] (std::size_t first, std::size_t last)
   {
-    std::size_t small_x = static_cast<std::size_t> (i % small_width);
-    std::size_t small_y = static_cast<std::size_t> (i / small_width);
-    std::size_t start_x = static_cast<std::size_t>( 
-        std::max ((static_cast<float> (small_x) - static_cast<float> (padding_xy) - 0.5f) * sigma_s_ + 1, 0.f));
-    std::size_t end_x = static_cast<std::size_t>( 
-      std::max ((static_cast<float> (small_x) - static_cast<float> (padding_xy) + 0.5f) * sigma_s_ + 1, 0.f));
-    std::size_t start_y = static_cast<std::size_t>( 
-      std::max ((static_cast<float> (small_y) - static_cast<float> (padding_xy) - 0.5f) * sigma_s_ + 1, 0.f));
-    std::size_t end_y = static_cast<std::size_t>( 
-      std::max ((static_cast<float> (small_y) - static_cast<float> (padding_xy) + 0.5f) * sigma_s_ + 1, 0.f));
-    for (std::size_t x = start_x; x < end_x && x < input_->width; ++x)
+    for (std::size_t i = first; i < last; ++i)
     {
-      for (std::size_t y = start_y; y < end_y && y < input_->height; ++y)
+      std::size_t small_x = static_cast<std::size_t> (i % small_width);
+      std::size_t small_y = static_cast<std::size_t> (i / small_width);
+      std::size_t start_x = static_cast<std::size_t>( 
+          std::max ((static_cast<float> (small_x) - static_cast<float> (padding_xy) - 0.5f) * sigma_s_ + 1, 0.f));
+      std::size_t end_x = static_cast<std::size_t>( 
+        std::max ((static_cast<float> (small_x) - static_cast<float> (padding_xy) + 0.5f) * sigma_s_ + 1, 0.f));
+      std::size_t start_y = static_cast<std::size_t>( 
+        std::max ((static_cast<float> (small_y) - static_cast<float> (padding_xy) - 0.5f) * sigma_s_ + 1, 0.f));
+      std::size_t end_y = static_cast<std::size_t>( 
+        std::max ((static_cast<float> (small_y) - static_cast<float> (padding_xy) + 0.5f) * sigma_s_ + 1, 0.f));
+      for (std::size_t x = start_x; x < end_x && x < input_->width; ++x)
       {
-        const float z = output (x,y).z - base_min;
-        const std::size_t small_z = static_cast<std::size_t> (static_cast<float> (z) / sigma_r_ + 0.5f) + padding_z;
-        Eigen::Vector2f& d = data (small_x, small_y, small_z);
-        d[0] += output (x,y).z;
-        d[1] += 1.0f;
+        for (std::size_t y = start_y; y < end_y && y < input_->height; ++y)
+        {
+          const float z = output (x,y).z - base_min;
+          const std::size_t small_z = static_cast<std::size_t> (static_cast<float> (z) / sigma_r_ + 0.5f) + padding_z;
+          Eigen::Vector2f& d = data (small_x, small_y, small_z);
+          d[0] += output (x,y).z;
+          d[1] += 1.0f;
+        }
       }
     }
-  }
+  }, threads_);
 
   std::vector<long int> offset (3);
   offset[0] = &(data (1,0,0)) - &(data (0,0,0));
@@ -153,28 +138,20 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
     {
       Array3D* current_buffer = (n_iter % 2 == 1 ? &buffer : &data);
       Array3D* current_data =(n_iter % 2 == 1 ? &data : &buffer);
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  shared(current_buffer, current_data, dim, offset) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(current_buffer, current_data, dim, offset, small_depth, small_height, small_width) \
-  num_threads(threads_)
-#endif
-      for(long int i = 0; i < static_cast<long int> ((small_width - 2)*(small_height - 2)); ++i)
+      pcl::parallel::parallel_for (std::size_t (0), (small_width - 2)*(small_height - 2), [&] (std::size_t first, std::size_t last)
       {
-        std::size_t x = static_cast<std::size_t> (i % (small_width - 2) + 1);
-        std::size_t y = static_cast<std::size_t> (i / (small_width - 2) + 1);
-        const long int off = offset[dim];
-        Eigen::Vector2f* d_ptr = &(current_data->operator() (x,y,1));
-        Eigen::Vector2f* b_ptr = &(current_buffer->operator() (x,y,1));
-
-        for(std::size_t z = 1; z < small_depth - 1; ++z, ++d_ptr, ++b_ptr)
-          *d_ptr = (*(b_ptr - off) + *(b_ptr + off) + 2.0 * (*b_ptr)) / 4.0;
-      }
+        for(std::size_t i = first; i < last; ++i)
+        {
+          std::size_t x = i % (small_width - 2) + 1;
+          std::size_t y = i / (small_width - 2) + 1;
+          const long int off = offset[dim];
+          Eigen::Vector2f* d_ptr = &(current_data->operator() (x,y,1));
+          Eigen::Vector2f* b_ptr = &(current_buffer->operator() (x,y,1));
+
+          for(std::size_t z = 1; z < small_depth - 1; ++z, ++d_ptr, ++b_ptr)
+            *d_ptr = (*(b_ptr - off) + *(b_ptr + off) + 2.0 * (*b_ptr)) / 4.0;
+        }
+      }, threads_);
     }
   }
   // Note: this works because there are an even number of iterations. 
@@ -186,37 +163,35 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
     for (std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> >::iterator d = data.begin (); d != data.end (); ++d)
       *d /= ((*d)[0] != 0) ? (*d)[1] : 1;
 
-#pragma omp parallel for \
-  default(none) \
-  shared(base_min, data, output) \
-  num_threads(threads_)
-    for (long int i = 0; i < static_cast<long int> (input_->size ()); ++i)
+    pcl::parallel::parallel_for (std::size_t (0), input_->size (), [&] (std::size_t first, std::size_t last)
     {
-      std::size_t x = static_cast<std::size_t> (i % input_->width);
-      std::size_t y = static_cast<std::size_t> (i / input_->width);
-      const float z = output (x,y).z - base_min;
-      const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
-                                                              static_cast<float> (y) / sigma_s_ + padding_xy,
-                                                              z / sigma_r_ + padding_z);
-      output(x,y).z = D[0];
-    }
+      for (std::size_t i = first; i < last; ++i)
+      {
+        std::size_t x = i % input_->width;
+        std::size_t y = i / input_->width;
+        const float z = output (x,y).z - base_min;
+        const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
+                                                                static_cast<float> (y) / sigma_s_ + padding_xy,
+                                                                z / sigma_r_ + padding_z);
+        output(x,y).z = D[0];
+      }
+    }, threads_);
   }
   else
   {
-#pragma omp parallel for \
-  default(none) \
-  shared(base_min, data, output) \
-  num_threads(threads_)
-    for (long i = 0; i < static_cast<long int> (input_->size ()); ++i)
+    pcl::parallel::parallel_for (std::size_t (0), input_->size (), [&] (std::size_t first, std::size_t last)
     {
-      std::size_t x = static_cast<std::size_t> (i % input_->width);
-      std::size_t y = static_cast<std::size_t> (i / input_->width);
-      const float z = output (x,y).z - base_min;
-      const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
-                                                              static_cast<float> (y) / sigma_s_ + padding_xy,
-                                                              z / sigma_r_ + padding_z);
-      output (x,y).z = D[0] / D[1];
-    }
+      for (std::size_t i = first; i < last; ++i)
+      {
+        std::size_t x = i % input_->width;
+        std::size_t y = i / input_->width;
+        const float z = output (x,y).z - base_min;
+        const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
+                                                                static_cast<float> (y) / sigma_s_ + padding_xy,
+                                                                z / sigma_r_ + padding_z);
+        output (x,y).z = D[0] / D[1];
+      }
+    }, threads_);
   }
 }
 
@@ -0,0 +1,582 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Point Cloud Library (PCL) - www.pointclouds.org
+ * Copyright (c) 2020-, Open Perception, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *  * Neither the name of the copyright holder(s) nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/geometry/quadric_decimation.h>
+#include <pcl/common/parallel.h>
+#include <pcl/console/print.h>
+
+#include <Eigen/LU>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> void
+pcl::geometry::QuadricDecimation<MeshT>::Quadric::addPlane (const Eigen::Vector3d& n, const double d, const double weight)
+{
+  a2 += weight * n [0] * n [0]; ab += weight * n [0] * n [1]; ac += weight * n [0] * n [2]; ad += weight * n [0] * d;
+  b2 += weight * n [1] * n [1]; bc += weight * n [1] * n [2]; bd += weight * n [1] * d;
+  c2 += weight * n [2] * n [2]; cd += weight * n [2] * d;
+  d2 += weight * d * d;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> typename pcl::geometry::QuadricDecimation<MeshT>::Quadric&
+pcl::geometry::QuadricDecimation<MeshT>::Quadric::operator+= (const Quadric& other)
+{
+  a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+  b2 += other.b2; bc += other.bc; bd += other.bd;
+  c2 += other.c2; cd += other.cd;
+  d2 += other.d2;
+  area += other.area;
+  return (*this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> double
+pcl::geometry::QuadricDecimation<MeshT>::Quadric::evaluate (const Eigen::Vector3d& p) const
+{
+  const double x = p [0], y = p [1], z = p [2];
+  return (a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+          b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+          c2 * z * z + 2.0 * cd * z + d2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> bool
+pcl::geometry::QuadricDecimation<MeshT>::Quadric::optimize (Eigen::Vector3d& p) const
+{
+  Eigen::Matrix3d a;
+  a << a2, ab, ac,
+       ab, b2, bc,
+       ac, bc, c2;
+  const double scale = a.diagonal ().maxCoeff ();
+  const double det = a.determinant ();
+  if (!(scale > 0.0) || std::abs (det) <= 1e-10 * scale * scale * scale)
+    return (false);
+  p = a.inverse () * Eigen::Vector3d (-ad, -bd, -cd);
+  return (p.allFinite ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> std::size_t
+pcl::geometry::QuadricDecimation<MeshT>::decimate (Mesh& mesh)
+{
+  // Meshes of more faces than this are decimated in parts first
+  const std::size_t nr_faces_per_part = 10000;
+
+  this->initCompute (mesh);
+  std::size_t nr_faces = std::count (face_alive_.begin (), face_alive_.end (), 1);
+
+  if (nr_faces > target_nr_faces_)
+  {
+    const std::size_t nr_parts = nr_faces / nr_faces_per_part;
+    if (nr_parts > 1)
+      nr_faces -= this->decimateParts (nr_parts, static_cast <double> (target_nr_faces_) / nr_faces);
+
+    // Collapse the remaining edges, in any part
+    std::vector <std::uint64_t> edges;
+    edges.reserve (3 * nr_faces);
+    for (std::size_t f = 0; f < faces_.size (); ++f)
+    {
+      if (!face_alive_ [f]) continue;
+      for (int i = 0; i < 3; ++i)
+      {
+        const std::uint32_t v0 = faces_ [f][i], v1 = faces_ [f][(i + 1) % 3];
+        edges.push_back ((static_cast <std::uint64_t> (std::min (v0, v1)) << 32) | std::max (v0, v1));
+      }
+    }
+    std::sort (edges.begin (), edges.end ());
+    edges.erase (std::unique (edges.begin (), edges.end ()), edges.end ());
+
+    Workspace workspace;
+    workspace.heap.resize (edges.size ());
+    pcl::parallel::parallel_for (std::size_t (0), edges.size (), [&] (std::size_t first, std::size_t last)
+    {
+      Eigen::Vector3d position;
+      for (std::size_t i = first; i < last; ++i)
+        this->computeCollapse (static_cast <int> (edges [i] >> 32), static_cast <int> (edges [i] & 0xffffffff), workspace.heap [i], position);
+    }, threads_);
+    workspace.heap.erase (std::remove_if (workspace.heap.begin (), workspace.heap.end (),
+                                          [this] (const Collapse& c) { return (c.cost > max_error_); }),
+                          workspace.heap.end ());
+    std::make_heap (workspace.heap.begin (), workspace.heap.end (), CollapseGreater ());
+    nr_faces = this->collapseEdges (nr_faces, target_nr_faces_, -1, workspace);
+  }
+
+  nr_dropped_faces_ = this->rebuild (mesh);
+  if (nr_dropped_faces_ > 0)
+    PCL_WARN ("[pcl::geometry::QuadricDecimation::decimate] %lu faces could not be added back to the mesh.\n", nr_dropped_faces_);
+  return (mesh.sizeFaces ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> void
+pcl::geometry::QuadricDecimation<MeshT>::initCompute (Mesh& mesh)
+{
+  using HalfEdgeIndex = typename Mesh::HalfEdgeIndex;
+  using VAFC = typename Mesh::VertexAroundFaceCirculator;
+  using OHEAVC = typename Mesh::OutgoingHalfEdgeAroundVertexCirculator;
+
+  const std::size_t nr_vertices = mesh.sizeVertices ();
+  const std::size_t nr_faces = mesh.sizeFaces ();
+  const typename Mesh::VertexDataCloud& vertex_data = mesh.getVertexDataCloud ();
+
+  positions_.resize (nr_vertices);
+  vertex_alive_.resize (nr_vertices);
+  for (std::size_t v = 0; v < nr_vertices; ++v)
+  {
+    positions_ [v] = vertex_data [v].getVector3fMap ().template cast <double> ();
+    vertex_alive_ [v] = !mesh.isDeleted (VertexIndex (static_cast <int> (v)));
+  }
+  versions_.assign (nr_vertices, 0);
+  parts_.assign (nr_vertices, -1);
+
+  faces_.resize (nr_faces);
+  face_alive_.resize (nr_faces);
+  vertex_faces_.assign (nr_vertices, std::vector <int> ());
+  for (std::size_t f = 0; f < nr_faces; ++f)
+  {
+    face_alive_ [f] = !mesh.isDeleted (FaceIndex (static_cast <int> (f)));
+    if (!face_alive_ [f]) continue;
+    VAFC circ = mesh.getVertexAroundFaceCirculator (FaceIndex (static_cast <int> (f)));
+    for (int i = 0; i < 3; ++i, ++circ)
+    {
+      faces_ [f][i] = circ.getTargetIndex ().get ();
+      vertex_faces_ [faces_ [f][i]].push_back (static_cast <int> (f));
+    }
+  }
+
+  normals_.resize (nr_faces);
+  for (std::size_t f = 0; f < nr_faces; ++f)
+  {
+    if (!face_alive_ [f]) continue;
+    const Eigen::Vector3d& p0 = positions_ [faces_ [f][0]];
+    normals_ [f] = (positions_ [faces_ [f][1]] - p0).cross (positions_ [faces_ [f][2]] - p0);
+  }
+
+  // The quadric of a vertex sums the planes of its faces, weighted by their areas, and the planes perpendicular to
+  // its boundary edges
+  quadrics_.assign (nr_vertices, Quadric ());
+  vertex_boundary_.assign (nr_vertices, 0);
+  const Mesh& const_mesh = mesh;
+  pcl::parallel::parallel_for (std::size_t (0), nr_vertices, [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t v = first; v < last; ++v)
+    {
+      if (!vertex_alive_ [v]) continue;
+      Quadric& quadric = quadrics_ [v];
+      for (const int f : vertex_faces_ [v])
+      {
+        const Eigen::Vector3d& p0 = positions_ [faces_ [f][0]];
+        Eigen::Vector3d n = (positions_ [faces_ [f][1]] - p0).cross (positions_ [faces_ [f][2]] - p0);
+        const double length = n.norm ();
+        if (length == 0.0) continue;
+        n /= length;
+        quadric.addPlane (n, -n.dot (p0), 0.5 * length);
+        quadric.area += 0.5 * length;
+      }
+
+      OHEAVC circ = const_mesh.getOutgoingHalfEdgeAroundVertexCirculator (VertexIndex (static_cast <int> (v)));
+      const OHEAVC circ_end = circ;
+      do
+      {
+        const HalfEdgeIndex idx_he = circ.getTargetIndex ();
+        const HalfEdgeIndex idx_opposite = const_mesh.getOppositeHalfEdgeIndex (idx_he);
+        const bool boundary = const_mesh.isBoundary (idx_he);
+        if (boundary == const_mesh.isBoundary (idx_opposite)) continue;
+        vertex_boundary_ [v] = 1;
+
+        const FaceIndex idx_face = const_mesh.getFaceIndex (boundary ? idx_opposite : idx_he);
+        const std::array <int, 3>& face = faces_ [idx_face.get ()];
+        const Eigen::Vector3d& p0 = positions_ [face [0]];
+        const Eigen::Vector3d face_normal = (positions_ [face [1]] - p0).cross (positions_ [face [2]] - p0);
+        const Eigen::Vector3d edge = positions_ [const_mesh.getTerminatingVertexIndex (idx_he).get ()] - positions_ [v];
+        Eigen::Vector3d n = edge.cross (face_normal);
+        const double length = n.norm ();
+        if (length == 0.0) continue;
+        n /= length;
+        quadric.addPlane (n, -n.dot (positions_ [v]), boundary_weight_ * edge.squaredNorm ());
+      } while (++circ != circ_end);
+    }
+  }, threads_);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> void
+pcl::geometry::QuadricDecimation<MeshT>::computeCollapse (const int v0, const int v1, Collapse& collapse, Eigen::Vector3d& position) const
+{
+  collapse.keep = std::min (v0, v1);
+  collapse.remove = std::max (v0, v1);
+  collapse.keep_version = versions_ [collapse.keep];
+  collapse.remove_version = versions_ [collapse.remove];
+
+  Quadric quadric = quadrics_ [v0];
+  quadric += quadrics_ [v1];
+  double error;
+  if (quadric.optimize (position))
+  {
+    error = quadric.evaluate (position);
+  }
+  else
+  {
+    // Take the best of the two vertices and the middle of the edge
+    const Eigen::Vector3d candidates [3] = {positions_ [v0], positions_ [v1], 0.5 * (positions_ [v0] + positions_ [v1])};
+    error = std::numeric_limits <double>::max ();
+    for (const auto& candidate : candidates)
+    {
+      const double candidate_error = quadric.evaluate (candidate);
+      if (candidate_error < error)
+      {
+        error = candidate_error;
+        position = candidate;
+      }
+    }
+  }
+  error = std::max (0.0, error);
+  collapse.cost = quadric.area > 0.0 ? error / quadric.area : error;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> bool
+pcl::geometry::QuadricDecimation<MeshT>::flips (const int face, const int vertex, const Eigen::Vector3d& position) const
+{
+  Eigen::Vector3d p [3];
+  for (int i = 0; i < 3; ++i) p [i] = positions_ [faces_ [face][i]];
+  const Eigen::Vector3d normal_before = (p [1] - p [0]).cross (p [2] - p [0]);
+  for (int i = 0; i < 3; ++i)
+  {
+    if (faces_ [face][i] == vertex) p [i] = position;
+  }
+  const Eigen::Vector3d normal_after = (p [1] - p [0]).cross (p [2] - p [0]);
+
+  // Small rotations may add up over many collapses, so the face is also compared to the original one
+  return (normal_after.dot (normal_before) <= 0.5 * normal_after.norm () * normal_before.norm () ||
+          normal_after.dot (normals_ [face]) <= 0.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> bool
+pcl::geometry::QuadricDecimation<MeshT>::isCollapsible (const int keep, const int remove, const Eigen::Vector3d& position,
+                                                         const int part, Workspace& workspace) const
+{
+  // Collect the neighbors of both vertices, check the faces which are kept for flips, and count the faces which are
+  // removed with the edge
+  int nr_shared = 0;
+  const int vertices [2] = {keep, remove};
+  std::vector <int>* neighbors [2] = {&workspace.neighbors_keep, &workspace.neighbors_remove};
+  for (int k = 0; k < 2; ++k)
+  {
+    const int vertex = vertices [k], other = vertices [1 - k];
+    neighbors [k]->clear ();
+    for (const int f : vertex_faces_ [vertex])
+    {
+      if (!face_alive_ [f]) continue;
+      const std::array <int, 3>& face = faces_ [f];
+      bool shared = false;
+      for (int i = 0; i < 3; ++i)
+      {
+        if (part >= 0 && parts_ [face [i]] != part) return (false);
+        if (face [i] == other) shared = true;
+        if (face [i] != vertex) neighbors [k]->push_back (face [i]);
+      }
+      if (shared)
+      {
+        if (k == 0) ++nr_shared;
+      }
+      else if (this->flips (f, vertex, position))
+      {
+        return (false);
+      }
+    }
+    std::sort (neighbors [k]->begin (), neighbors [k]->end ());
+    neighbors [k]->erase (std::unique (neighbors [k]->begin (), neighbors [k]->end ()), neighbors [k]->end ());
+  }
+
+  // An inner edge has two faces and a boundary edge has one. An inner edge between two boundary vertices would pinch
+  // the mesh
+  if (nr_shared == 0 || nr_shared > 2) return (false);
+  if (nr_shared == 2 && vertex_boundary_ [keep] && vertex_boundary_ [remove]) return (false);
+
+  // Link condition: the only common neighbors are the opposite vertices of the removed faces
+  std::size_t nr_common = 0;
+  auto it_keep = workspace.neighbors_keep.cbegin ();
+  auto it_remove = workspace.neighbors_remove.cbegin ();
+  while (it_keep != workspace.neighbors_keep.cend () && it_remove != workspace.neighbors_remove.cend ())
+  {
+    if (*it_keep < *it_remove) ++it_keep;
+    else if (*it_remove < *it_keep) ++it_remove;
+    else { ++nr_common; ++it_keep; ++it_remove; }
+  }
+  if (nr_common != static_cast <std::size_t> (nr_shared)) return (false);
+
+  // The merged vertex of an inner edge needs at least three neighbors, or its faces would fold onto each other
+  const std::size_t nr_merged_neighbors = workspace.neighbors_keep.size () + workspace.neighbors_remove.size () - 2 - nr_common;
+  return (nr_shared == 1 || nr_merged_neighbors >= 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> std::size_t
+pcl::geometry::QuadricDecimation<MeshT>::collapse (const int keep, const int remove, const Eigen::Vector3d& position)
+{
+  std::size_t nr_removed = 0;
+  std::vector <int>& keep_faces = vertex_faces_ [keep];
+  for (const int f : vertex_faces_ [remove])
+  {
+    if (!face_alive_ [f]) continue;
+    std::array <int, 3>& face = faces_ [f];
+    if (face [0] == keep || face [1] == keep || face [2] == keep)
+    {
+      face_alive_ [f] = 0;
+      ++nr_removed;
+    }
+    else
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        if (face [i] == remove) face [i] = keep;
+      }
+      keep_faces.push_back (f);
+    }
+  }
+  keep_faces.erase (std::remove_if (keep_faces.begin (), keep_faces.end (), [this] (const int f) { return (!face_alive_ [f]); }),
+                    keep_faces.end ());
+  std::vector <int> ().swap (vertex_faces_ [remove]);
+
+  positions_ [keep] = position;
+  quadrics_ [keep] += quadrics_ [remove];
+  vertex_boundary_ [keep] = vertex_boundary_ [keep] || vertex_boundary_ [remove];
+  vertex_alive_ [remove] = 0;
+  ++versions_ [keep];
+  return (nr_removed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> void
+pcl::geometry::QuadricDecimation<MeshT>::pushCollapses (const int vertex, const int part, Workspace& workspace) const
+{
+  std::vector <int>& neighbors = workspace.neighbors_keep;
+  neighbors.clear ();
+  for (const int f : vertex_faces_ [vertex])
+  {
+    for (const int v : faces_ [f])
+    {
+      if (v != vertex && (part < 0 || parts_ [v] == part)) neighbors.push_back (v);
+    }
+  }
+  std::sort (neighbors.begin (), neighbors.end ());
+  neighbors.erase (std::unique (neighbors.begin (), neighbors.end ()), neighbors.end ());
+
+  Collapse collapse;
+  Eigen::Vector3d position;
+  for (const int neighbor : neighbors)
+  {
+    this->computeCollapse (vertex, neighbor, collapse, position);
+    if (collapse.cost > max_error_) continue;
+    workspace.heap.push_back (collapse);
+    std::push_heap (workspace.heap.begin (), workspace.heap.end (), CollapseGreater ());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> std::size_t
+pcl::geometry::QuadricDecimation<MeshT>::collapseEdges (std::size_t nr_faces, const std::size_t target_nr_faces, const int part, Workspace& workspace)
+{
+  std::vector <Collapse>& heap = workspace.heap;
+  Collapse current;
+  Eigen::Vector3d position;
+  while (nr_faces > target_nr_faces && !heap.empty ())
+  {
+    std::pop_heap (heap.begin (), heap.end (), CollapseGreater ());
+    const Collapse collapse = heap.back ();
+    heap.pop_back ();
+
+    // Skip the collapses computed before one of the vertices changed
+    if (!vertex_alive_ [collapse.keep] || !vertex_alive_ [collapse.remove] ||
+        versions_ [collapse.keep] != collapse.keep_version || versions_ [collapse.remove] != collapse.remove_version)
+      continue;
+
+    this->computeCollapse (collapse.keep, collapse.remove, current, position);
+    if (!this->isCollapsible (collapse.keep, collapse.remove, position, part, workspace)) continue;
+
+    nr_faces -= this->collapse (collapse.keep, collapse.remove, position);
+    this->pushCollapses (collapse.keep, part, workspace);
+  }
+  return (nr_faces);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> std::size_t
+pcl::geometry::QuadricDecimation<MeshT>::decimateParts (const std::size_t nr_parts, const double ratio)
+{
+  // Split the vertices into parts of consecutive vertices along a Morton curve over the bounding box
+  std::vector <int> vertices;
+  Eigen::Vector3d min_pt = Eigen::Vector3d::Constant (std::numeric_limits <double>::max ());
+  Eigen::Vector3d max_pt = -min_pt;
+  for (std::size_t v = 0; v < positions_.size (); ++v)
+  {
+    if (!vertex_alive_ [v]) continue;
+    vertices.push_back (static_cast <int> (v));
+    min_pt = min_pt.cwiseMin (positions_ [v]);
+    max_pt = max_pt.cwiseMax (positions_ [v]);
+  }
+  const Eigen::Vector3d scale = (1023.0 / (max_pt - min_pt).array ().max (std::numeric_limits <double>::min ())).matrix ();
+  std::vector <std::pair <std::uint32_t, int> > codes (vertices.size ());
+  for (std::size_t i = 0; i < vertices.size (); ++i)
+  {
+    const Eigen::Vector3d cell = (positions_ [vertices [i]] - min_pt).cwiseProduct (scale);
+    std::uint32_t code = 0;
+    for (int bit = 9; bit >= 0; --bit)
+    {
+      for (int d = 0; d < 3; ++d)
+        code = (code << 1) | ((static_cast <std::uint32_t> (cell [d]) >> bit) & 1);
+    }
+    codes [i] = std::make_pair (code, vertices [i]);
+  }
+  std::sort (codes.begin (), codes.end ());
+  for (std::size_t i = 0; i < codes.size (); ++i)
+    parts_ [codes [i].second] = static_cast <int> (i * nr_parts / codes.size ());
+
+  // The edges and number of faces of each part, among the faces whose vertices are all in the same part
+  std::vector <std::vector <std::pair <int, int> > > part_edges (nr_parts);
+  std::vector <std::size_t> part_nr_faces (nr_parts, 0);
+  for (std::size_t f = 0; f < faces_.size (); ++f)
+  {
+    if (!face_alive_ [f]) continue;
+    const std::array <int, 3>& face = faces_ [f];
+    const int part = parts_ [face [0]];
+    if (parts_ [face [1]] != part || parts_ [face [2]] != part) continue;
+    ++part_nr_faces [part];
+    for (int i = 0; i < 3; ++i)
+      part_edges [part].emplace_back (std::min (face [i], face [(i + 1) % 3]), std::max (face [i], face [(i + 1) % 3]));
+  }
+
+  // The parts only modify their own vertices and faces, so they are decimated concurrently
+  std::vector <std::size_t> part_nr_removed (nr_parts, 0);
+  pcl::parallel::parallel_for (std::size_t (0), nr_parts, [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t part = first; part < last; ++part)
+    {
+      std::vector <std::pair <int, int> >& edges = part_edges [part];
+      std::sort (edges.begin (), edges.end ());
+      edges.erase (std::unique (edges.begin (), edges.end ()), edges.end ());
+
+      Workspace workspace;
+      workspace.heap.reserve (edges.size ());
+      Collapse collapse;
+      Eigen::Vector3d position;
+      for (const auto& edge : edges)
+      {
+        this->computeCollapse (edge.first, edge.second, collapse, position);
+        if (collapse.cost <= max_error_) workspace.heap.push_back (collapse);
+      }
+      std::make_heap (workspace.heap.begin (), workspace.heap.end (), CollapseGreater ());
+      std::vector <std::pair <int, int> > ().swap (edges);
+
+      const std::size_t target = static_cast <std::size_t> (std::ceil (ratio * part_nr_faces [part]));
+      part_nr_removed [part] = part_nr_faces [part] -
+                               this->collapseEdges (part_nr_faces [part], target, static_cast <int> (part), workspace);
+    }
+  }, threads_, std::size_t (1));
+
+  std::size_t nr_removed = 0;
+  for (const std::size_t n : part_nr_removed) nr_removed += n;
+  return (nr_removed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class MeshT> std::size_t
+pcl::geometry::QuadricDecimation<MeshT>::rebuild (Mesh& mesh) const
+{
+  const typename Mesh::VertexDataCloud vertex_data = mesh.getVertexDataCloud ();
+  const typename Mesh::FaceDataCloud face_data = mesh.getFaceDataCloud ();
+
+  std::vector <char> used (positions_.size (), 0);
+  std::size_t nr_faces = 0;
+  for (std::size_t f = 0; f < faces_.size (); ++f)
+  {
+    if (!face_alive_ [f]) continue;
+    ++nr_faces;
+    for (const int v : faces_ [f]) used [v] = 1;
+  }
+
+  mesh.clear ();
+  mesh.reserveVertices (std::count (used.begin (), used.end (), 1));
+  mesh.reserveEdges (3 * nr_faces);
+  mesh.reserveFaces (nr_faces);
+
+  std::vector <VertexIndex> new_indices (positions_.size ());
+  for (std::size_t v = 0; v < positions_.size (); ++v)
+  {
+    if (!used [v]) continue;
+    typename Mesh::VertexData data = vertex_data [v];
+    data.getVector3fMap () = positions_ [v].template cast <float> ();
+    new_indices [v] = mesh.addVertex (data);
+  }
+
+  // The faces are added in one go, which does not depend on their order as long as each vertex has a single fan of
+  // faces. The collapses never split a fan, so faces are only dropped if the original mesh was not manifold already
+  typename Mesh::VertexIndices vertices;
+  vertices.reserve (3 * nr_faces);
+  typename Mesh::FaceDataCloud new_face_data;
+  if (Mesh::HasFaceData::value) new_face_data.reserve (nr_faces);
+  for (std::size_t f = 0; f < faces_.size (); ++f)
+  {
+    if (!face_alive_ [f]) continue;
+    for (const int v : faces_ [f]) vertices.push_back (new_indices [v]);
+    if (Mesh::HasFaceData::value) new_face_data.push_back (face_data [f]);
+  }
+  return (nr_faces - mesh.addFaces (vertices, 3, new_face_data, threads_));
+}
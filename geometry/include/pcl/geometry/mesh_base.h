@@ -46,10 +46,15 @@
 #include <pcl/geometry/mesh_indices.h>
 #include <pcl/geometry/mesh_elements.h>
 #include <pcl/geometry/mesh_traits.h>
+#include <pcl/common/parallel.h>
 #include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/point_cloud.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
 #include <vector>
 #include <type_traits>
 
@@ -77,6 +82,9 @@ namespace pcl
   {
     template <class MeshT>
     class MeshIO;
+
+    struct TriangleMeshTag;
+    struct QuadMeshTag;
   } // End namespace geometry
 } // End namespace pcl
 
@@ -194,6 +202,55 @@ namespace pcl
           return (static_cast <Derived*> (this)->addFaceImpl (vertices, face_data, edge_data, half_edge_data));
         }
 
+        /** \brief Add faces of the same size to the mesh, given one after the other in an index buffer.
+          *
+          * If the mesh has no faces yet, the connectivity of all faces is built at once: on one thread, the half-edges
+          * are paired in one pass over the faces; on more threads, they are sorted by their originating vertex with a
+          * parallel counting sort, which gives the opposite of each half-edge without a search. Both give the same
+          * mesh, and the result is checked in parallel. The elements are stored compactly, without any deleted
+          * element, and in the order of the faces: the faces keep their order in the index buffer, and the edges are
+          * numbered in the order of the first face they belong to, whose half-edge is the first one of the edge.
+          * Unlike with addFace, the order of the faces does not matter, but each vertex has to end up with a single fan
+          * of faces. Otherwise, the faces are added one after the other with addFace, skipping the faces that can not
+          * be added.
+          * \param[in] vertices   Indices to the vertices of the faces.
+          * \param[in] face_size  Number of vertices of each face.
+          * \param[in] face_data  Data that is set for the faces, in their order. Default data is set if its size does not match the number of faces.
+          * \param[in] nr_threads The number of threads to use (0 sets the value to the thread budget, see pcl::parallel::setThreadBudget ()).
+          * \return The number of faces added.
+          * \warning The vertices must be valid and unique within each face, as for addFace.
+          */
+        inline std::size_t
+        addFaces (const VertexIndices&  vertices,
+                  const std::size_t     face_size,
+                  const FaceDataCloud&  face_data  = FaceDataCloud (),
+                  const unsigned int    nr_threads = 1)
+        {
+          if (face_size == 0) return (0);
+          return (this->addFacesImplBase (vertices, vertices.size () / face_size,
+                                          [face_size] (const std::size_t idx_face) { return (idx_face * face_size); },
+                                          face_data, nr_threads));
+        }
+
+        /** \brief Add faces of any size to the mesh, given one after the other in an index buffer. See the version for faces of the same size.
+          * \param[in] vertices   Indices to the vertices of the faces.
+          * \param[in] offsets    Offset of the first vertex of each face into the vertices, followed by the offset past the last face. The offsets may not decrease, nor exceed the number of vertices.
+          * \param[in] face_data  Data that is set for the faces, in their order. Default data is set if its size does not match the number of faces.
+          * \param[in] nr_threads The number of threads to use (0 sets the value to the thread budget, see pcl::parallel::setThreadBudget ()).
+          * \return The number of faces added (0 if the offsets are not valid).
+          */
+        inline std::size_t
+        addFaces (const VertexIndices&             vertices,
+                  const std::vector <std::size_t>& offsets,
+                  const FaceDataCloud&             face_data  = FaceDataCloud (),
+                  const unsigned int               nr_threads = 1)
+        {
+          if (offsets.empty () || offsets.back () > vertices.size () || !std::is_sorted (offsets.begin (), offsets.end ())) return (0);
+          return (this->addFacesImplBase (vertices, offsets.size () - 1,
+                                          [&offsets] (const std::size_t idx_face) { return (offsets [idx_face]); },
+                                          face_data, nr_threads));
+        }
+
         /** \brief Mark the given vertex and all connected half-edges and faces as deleted.
           * \note Call cleanUp () to finally delete all mesh-elements.
           */
@@ -1168,6 +1225,412 @@ namespace pcl
           return (this->connectFace (inner_he_, face_data));
         }
 
+        /** \brief General implementation of addFaces.
+          * \param[in] offset Function returning the offset of the first vertex of a face into the vertices (or the number of vertices for nr_faces).
+          */
+        template <class OffsetT> std::size_t
+        addFacesImplBase (const VertexIndices& vertices,
+                          const std::size_t    nr_faces,
+                          const OffsetT&       offset,
+                          const FaceDataCloud& face_data,
+                          const unsigned int   nr_threads)
+        {
+          const bool has_face_data = face_data.size () == nr_faces;
+          if (!this->buildFaces (vertices, nr_faces, offset, nr_threads))
+          {
+            std::size_t nr_added = 0;
+            VertexIndices face;
+            for (std::size_t f = 0; f < nr_faces; ++f)
+            {
+              face.assign (vertices.begin () + offset (f), vertices.begin () + offset (f + 1));
+              if (this->addFace (face, has_face_data ? face_data [f] : FaceData ()).isValid ()) ++nr_added;
+            }
+            return (nr_added);
+          }
+
+          this->resizeData (half_edge_data_cloud_, half_edges_.size ()    , HalfEdgeData (), HasHalfEdgeData ());
+          this->resizeData (edge_data_cloud_     , half_edges_.size () / 2, EdgeData ()    , HasEdgeData     ());
+          if (HasFaceData::value && has_face_data) face_data_cloud_ = face_data;
+          else this->resizeData (face_data_cloud_, nr_faces, FaceData (), HasFaceData ());
+          return (nr_faces);
+        }
+
+        /** \brief Build the connectivity of all faces at once, if the mesh has no faces yet and each vertex ends up with a single fan of faces.
+          * \return false if the faces could not be built, in which case the mesh is left unchanged.
+          */
+        template <class OffsetT> bool
+        buildFaces (const VertexIndices& vertices,
+                    const std::size_t    nr_faces,
+                    const OffsetT&       offset,
+                    const unsigned int   nr_threads)
+        {
+          if (!half_edges_.empty () || !faces_.empty () || nr_faces == 0) return (false);
+          if (offset (nr_faces) - offset (0) > static_cast <std::size_t> (std::numeric_limits <int>::max () / 2)) return (false);
+          const int nr_vertices = static_cast <int> (this->sizeVertices ());
+
+          std::vector <int> nr_inner;
+          bool valid = (pcl::parallel::detail::getNumberOfThreads (nr_threads) > 1 ?
+                        this->pairHalfEdgesSorted   (vertices, nr_faces, offset, nr_threads, nr_inner) :
+                        this->pairHalfEdgesStreamed (vertices, nr_faces, offset, nr_threads, nr_inner));
+
+          // Check that the half-edges around each vertex form a single fan without two edges to the same vertex
+          if (valid)
+          {
+            valid = pcl::parallel::parallel_reduce (0, nr_vertices, true, [&] (int first, int last)
+            {
+              std::vector <int> neighbors;
+              for (int v = first; v < last; ++v)
+              {
+                const HalfEdgeIndex idx_first = vertices_ [v].idx_outgoing_half_edge_;
+                if (!idx_first.isValid ()) continue;
+                neighbors.clear ();
+                int count = 0;
+                HalfEdgeIndex idx_he = idx_first;
+                do
+                {
+                  neighbors.push_back (half_edges_ [idx_he.get ()].idx_terminating_vertex_.get ());
+                  if (half_edges_ [idx_he.get ()].idx_face_.isValid ()) ++count;
+                  idx_he = half_edges_ [this->getOppositeHalfEdgeIndex (idx_he).get ()].idx_next_half_edge_;
+                } while (idx_he != idx_first && count <= nr_inner [v]);
+                if (count != nr_inner [v]) return (false);
+                std::sort (neighbors.begin (), neighbors.end ());
+                if (std::adjacent_find (neighbors.begin (), neighbors.end ()) != neighbors.end ()) return (false);
+              }
+              return (true);
+            }, all_, nr_threads);
+          }
+
+          if (!valid)
+          {
+            half_edges_.clear ();
+            faces_.clear ();
+            for (Vertex& vertex : vertices_) vertex.idx_outgoing_half_edge_ = HalfEdgeIndex ();
+          }
+          return (valid);
+        }
+
+        /** \brief Pair the half-edges of the faces in one pass over them and connect them, for buildFaces.
+          * \param[out] nr_inner The number of inner half-edges from each vertex.
+          * \return false if the faces are not valid.
+          */
+        template <class OffsetT> bool
+        pairHalfEdgesStreamed (const VertexIndices& vertices,
+                               const std::size_t    nr_faces,
+                               const OffsetT&       offset,
+                               const unsigned int   nr_threads,
+                               std::vector <int>&   nr_inner)
+        {
+          const int nr_vertices = static_cast <int> (this->sizeVertices ());
+
+          // Match the half-edges of the faces in their order. The half-edges which were added as the opposite of a
+          // half-edge of a face, and whose own face was not reached yet, are kept in a list for each of their
+          // originating vertices. These lists are linked through the (unused) next half-edges.
+          std::vector <int> unmatched (nr_vertices, -1);
+          nr_inner.assign (nr_vertices, 0);
+          half_edges_.reserve (2 * offset (nr_faces));
+          faces_.reserve (nr_faces);
+          bool valid = true;
+          for (std::size_t f = 0; f < nr_faces && valid; ++f)
+          {
+            const std::size_t begin = offset (f), end = offset (f + 1);
+            if (end < begin || !isValidFaceSize (end - begin, static_cast <MeshTag*> (nullptr))) valid = false;
+            for (std::size_t i = begin; i < end && valid; ++i)
+            {
+              if (vertices [i].get () < 0 || vertices [i].get () >= nr_vertices) valid = false;
+            }
+            if (!valid) break;
+
+            const int n = static_cast <int> (end - begin);
+            inner_he_.resize (n);
+            for (int i = 0; i < n; ++i)
+            {
+              const int a = vertices [begin + i].get (), b = vertices [i + 1 < n ? begin + i + 1 : begin].get ();
+              if (a == b) { valid = false; break; }
+
+              int idx_prev = -1, idx_he = unmatched [a];
+              while (idx_he != -1 && half_edges_ [idx_he].idx_terminating_vertex_.get () != b)
+              {
+                idx_prev = idx_he;
+                idx_he = half_edges_ [idx_he].idx_next_half_edge_.get ();
+              }
+              if (idx_he != -1)
+              {
+                const int idx_next = half_edges_ [idx_he].idx_next_half_edge_.get ();
+                if (idx_prev == -1) unmatched [a] = idx_next;
+                else                half_edges_ [idx_prev].idx_next_half_edge_ = HalfEdgeIndex (idx_next);
+              }
+              else
+              {
+                idx_he = static_cast <int> (half_edges_.size ());
+                half_edges_.push_back (HalfEdge (VertexIndex (b)));
+                half_edges_.push_back (HalfEdge (VertexIndex (a), HalfEdgeIndex (unmatched [b])));
+                unmatched [b] = idx_he + 1;
+              }
+              inner_he_ [i] = HalfEdgeIndex (idx_he);
+              vertices_ [a].idx_outgoing_half_edge_ = inner_he_ [i];
+              ++nr_inner [a];
+            }
+            if (!valid) break;
+
+            const FaceIndex idx_face (static_cast <int> (faces_.size ()));
+            for (int i = 0; i < n; ++i)
+            {
+              HalfEdge& half_edge = half_edges_ [inner_he_ [i].get ()];
+              half_edge.idx_next_half_edge_ = inner_he_ [i + 1 < n ? i + 1 : 0];
+              half_edge.idx_prev_half_edge_ = inner_he_ [i > 0 ? i - 1 : n - 1];
+              half_edge.idx_face_ = idx_face;
+            }
+            faces_.push_back (Face (inner_he_.back ()));
+          }
+
+          // The unmatched half-edges are on the boundary. The outgoing half-edge of a boundary vertex must be its
+          // boundary half-edge, which has to be unique
+          if (valid)
+          {
+            valid = pcl::parallel::parallel_reduce (0, nr_vertices, true, [&] (int first, int last)
+            {
+              for (int v = first; v < last; ++v)
+              {
+                if (unmatched [v] == -1) continue;
+                if (half_edges_ [unmatched [v]].idx_next_half_edge_.isValid ()) return (false);
+                vertices_ [v].idx_outgoing_half_edge_ = HalfEdgeIndex (unmatched [v]);
+              }
+              return (true);
+            }, all_, nr_threads);
+          }
+
+          // Connect the boundary half-edges
+          if (valid)
+          {
+            valid = pcl::parallel::parallel_reduce (0, nr_vertices, true, [&] (int first, int last)
+            {
+              for (int v = first; v < last; ++v)
+              {
+                if (unmatched [v] == -1) continue;
+                const int idx_next = unmatched [half_edges_ [unmatched [v]].idx_terminating_vertex_.get ()];
+                if (idx_next == -1) return (false);
+                half_edges_ [unmatched [v]].idx_next_half_edge_ = HalfEdgeIndex (idx_next);
+                half_edges_ [idx_next].idx_prev_half_edge_ = HalfEdgeIndex (unmatched [v]);
+              }
+              return (true);
+            }, all_, nr_threads);
+          }
+          return (valid);
+        }
+
+        /** \brief Pair the half-edges of the faces in parallel, through a counting sort by their originating vertex, and connect them, for buildFaces.
+          *
+          * The result is the same as with pairHalfEdgesStreamed: the edges are numbered in the order of their first
+          * half-edge in the faces, and the outgoing half-edge of an inner vertex is its last one in the faces.
+          * \param[out] nr_inner The number of inner half-edges from each vertex.
+          * \return false if the faces are not valid.
+          */
+        template <class OffsetT> bool
+        pairHalfEdgesSorted (const VertexIndices& vertices,
+                             const std::size_t    nr_faces,
+                             const OffsetT&       offset,
+                             const unsigned int   nr_threads,
+                             std::vector <int>&   nr_inner)
+        {
+          const int nr_vertices = static_cast <int> (this->sizeVertices ());
+
+          // The inner half-edges are numbered by the position of their originating vertex in the faces
+          const std::size_t first = offset (0);
+          const int nr_inner_he = static_cast <int> (offset (nr_faces) - first);
+          std::vector <int> face_of (nr_inner_he), target (nr_inner_he);
+          const auto origin = [&] (const int i) { return (vertices [first + i].get ()); };
+          bool valid = pcl::parallel::parallel_reduce (std::size_t (0), nr_faces, true, [&] (std::size_t first_face, std::size_t last_face)
+          {
+            for (std::size_t f = first_face; f < last_face; ++f)
+            {
+              const std::size_t begin = offset (f), end = offset (f + 1);
+              if (!isValidFaceSize (end - begin, static_cast <MeshTag*> (nullptr))) return (false);
+              for (std::size_t i = begin; i < end; ++i)
+              {
+                const int a = vertices [i].get (), b = vertices [i + 1 < end ? i + 1 : begin].get ();
+                if (a < 0 || a >= nr_vertices || a == b) return (false);
+                face_of [i - first] = static_cast <int> (f);
+                target [i - first] = b;
+              }
+            }
+            return (true);
+          }, all_, nr_threads);
+          if (!valid) return (false);
+
+          // Sort the inner half-edges by their originating vertex with a counting sort, keeping their order. Each
+          // thread sorts the half-edges of a range of vertices, so that no synchronization is needed. The targets
+          // are sorted along, so that the half-edges between two vertices are found in one contiguous range
+          const int nr_parts = static_cast <int> (pcl::parallel::detail::getNumberOfThreads (nr_threads));
+          std::vector <int> first_out (nr_vertices + 1, 0), out (nr_inner_he), out_target (nr_inner_he);
+          const auto part_begin = [&] (const int part) { return (static_cast <int> (static_cast <std::int64_t> (nr_vertices) * part / nr_parts)); };
+          pcl::parallel::parallel_for (0, nr_parts, [&] (int first_part, int last_part)
+          {
+            const int v_begin = part_begin (first_part), v_end = part_begin (last_part);
+            for (int i = 0; i < nr_inner_he; ++i)
+            {
+              const int a = origin (i);
+              if (a >= v_begin && a < v_end) ++first_out [a + 1];
+            }
+          }, nr_parts, 1);
+          std::partial_sum (first_out.begin (), first_out.end (), first_out.begin ());
+          pcl::parallel::parallel_for (0, nr_parts, [&] (int first_part, int last_part)
+          {
+            const int v_begin = part_begin (first_part), v_end = part_begin (last_part);
+            std::vector <int> position (first_out.begin () + v_begin, first_out.begin () + v_end);
+            for (int i = 0; i < nr_inner_he; ++i)
+            {
+              const int a = origin (i);
+              if (a < v_begin || a >= v_end) continue;
+              const int k = position [a - v_begin]++;
+              out [k] = i;
+              out_target [k] = target [i];
+            }
+          }, nr_parts, 1);
+
+          // Pair the half-edges: the opposite of the half-edge from a to b is the only one from b to a, if any. The
+          // first half-edge of an edge stores its opposite (-1 if there is none), the second one stores -2 * (its
+          // opposite + 1). The edges are counted by chunks of half-edges along the way
+          std::vector <int> half_edge (nr_inner_he);
+          const int chunk_size = 1 << 16, nr_chunks = (nr_inner_he + chunk_size - 1) / chunk_size;
+          std::vector <int> first_edge (nr_chunks + 1, 0);
+          valid = pcl::parallel::parallel_reduce (0, nr_chunks, true, [&] (int first_chunk, int last_chunk)
+          {
+            for (int c = first_chunk; c < last_chunk; ++c)
+            {
+              for (int i = c * chunk_size; i < std::min ((c + 1) * chunk_size, nr_inner_he); ++i)
+              {
+                const int a = origin (i), b = target [i];
+                int idx_opposite = -1;
+                for (int k = first_out [b]; k < first_out [b + 1]; ++k)
+                {
+                  if (out_target [k] != a) continue;
+                  if (idx_opposite != -1) return (false);
+                  idx_opposite = out [k];
+                }
+                if (idx_opposite == -1 || i < idx_opposite)
+                {
+                  half_edge [i] = idx_opposite;
+                  ++first_edge [c + 1];
+                }
+                else half_edge [i] = -2 * (idx_opposite + 1);
+              }
+            }
+            return (true);
+          }, all_, nr_threads, 1);
+          if (!valid) return (false);
+
+          // Number the edges in the order of their first half-edge, which gets the even index. The other one is
+          // either the opposite inner half-edge or a boundary half-edge, in which case the index of the first one is
+          // stored as its complement (odd and negative, unlike the second half-edges which are not numbered yet)
+          std::partial_sum (first_edge.begin (), first_edge.end (), first_edge.begin ());
+          pcl::parallel::parallel_for (0, nr_chunks, [&] (int first_chunk, int last_chunk)
+          {
+            for (int c = first_chunk; c < last_chunk; ++c)
+            {
+              int idx_edge = first_edge [c];
+              for (int i = c * chunk_size; i < std::min ((c + 1) * chunk_size, nr_inner_he); ++i)
+              {
+                if      (half_edge [i] == -1) half_edge [i] = ~(2 * idx_edge++);
+                else if (half_edge [i] >=  0) half_edge [i] = 2 * idx_edge++;
+              }
+            }
+          }, nr_threads, 1);
+          pcl::parallel::parallel_for (0, nr_inner_he, [&] (int first_he, int last_he)
+          {
+            for (int i = first_he; i < last_he; ++i)
+              if (half_edge [i] < 0 && half_edge [i] % 2 == 0) half_edge [i] = half_edge [-half_edge [i] / 2 - 1] + 1;
+          }, nr_threads);
+          const auto index = [&] (const int i) { return (half_edge [i] < 0 ? ~half_edge [i] : half_edge [i]); };
+
+          half_edges_.assign (2 * static_cast <std::size_t> (first_edge.back ()), HalfEdge ());
+          faces_.assign (nr_faces, Face ());
+          pcl::parallel::parallel_for (std::size_t (0), nr_faces, [&] (std::size_t first_face, std::size_t last_face)
+          {
+            for (std::size_t f = first_face; f < last_face; ++f)
+            {
+              const int begin = static_cast <int> (offset (f) - first), end = static_cast <int> (offset (f + 1) - first);
+              int idx_prev = index (end - 1), idx_he = index (begin);
+              for (int i = begin; i < end; ++i)
+              {
+                const int idx_next = index (i + 1 < end ? i + 1 : begin);
+                half_edges_ [idx_he] = HalfEdge (VertexIndex (target [i]), HalfEdgeIndex (idx_next), HalfEdgeIndex (idx_prev), FaceIndex (static_cast <int> (f)));
+                if (half_edge [i] < 0) half_edges_ [idx_he + 1] = HalfEdge (VertexIndex (origin (i)));
+                idx_prev = idx_he;
+                idx_he = idx_next;
+              }
+              faces_ [f] = Face (HalfEdgeIndex (idx_prev));
+            }
+          }, nr_threads);
+
+          // The outgoing half-edge of a boundary vertex must be its boundary half-edge, which has to be unique. The
+          // boundary half-edge to a vertex is opposite to an unpaired half-edge from it, the one from a vertex is
+          // opposite to the unpaired half-edge before
+          valid = pcl::parallel::parallel_reduce (0, nr_vertices, true, [&] (int first_vertex, int last_vertex)
+          {
+            for (int v = first_vertex; v < last_vertex; ++v)
+            {
+              if (first_out [v] == first_out [v + 1]) continue;
+              int idx_boundary_in = -1, idx_boundary_out = -1;
+              for (int k = first_out [v]; k < first_out [v + 1]; ++k)
+              {
+                const int i = out [k];
+                const std::size_t f = face_of [i];
+                const int i_prev = first + i > offset (f) ? i - 1 : static_cast <int> (offset (f + 1) - first) - 1;
+                if (half_edge [i] < 0)
+                {
+                  if (idx_boundary_in != -1) return (false);
+                  idx_boundary_in = ~half_edge [i] + 1;
+                }
+                if (half_edge [i_prev] < 0)
+                {
+                  if (idx_boundary_out != -1) return (false);
+                  idx_boundary_out = ~half_edge [i_prev] + 1;
+                }
+              }
+              if ((idx_boundary_in == -1) != (idx_boundary_out == -1)) return (false);
+              vertices_ [v].idx_outgoing_half_edge_ = HalfEdgeIndex (idx_boundary_out != -1 ? idx_boundary_out : index (out [first_out [v + 1] - 1]));
+              if (idx_boundary_in != -1)
+              {
+                half_edges_ [idx_boundary_in ].idx_next_half_edge_ = HalfEdgeIndex (idx_boundary_out);
+                half_edges_ [idx_boundary_out].idx_prev_half_edge_ = HalfEdgeIndex (idx_boundary_in);
+              }
+            }
+            return (true);
+          }, all_, nr_threads);
+
+          nr_inner.resize (nr_vertices);
+          for (int v = 0; v < nr_vertices; ++v) nr_inner [v] = first_out [v + 1] - first_out [v];
+          return (valid);
+        }
+
+        /** \brief Combine the results of the checks of buildFaces. */
+        static inline bool
+        all_ (const bool a, const bool b)
+        {
+          return (a && b);
+        }
+
+        /** \brief Check if a face of the given size may be added to a triangle mesh. */
+        static inline bool
+        isValidFaceSize (const std::size_t n, pcl::geometry::TriangleMeshTag* /*tag*/)
+        {
+          return (n == 3);
+        }
+
+        /** \brief Check if a face of the given size may be added to a quad mesh. */
+        static inline bool
+        isValidFaceSize (const std::size_t n, pcl::geometry::QuadMeshTag* /*tag*/)
+        {
+          return (n == 4);
+        }
+
+        /** \brief Check if a face of the given size may be added to a polygon mesh. */
+        template <class MeshTagT2> static inline bool
+        isValidFaceSize (const std::size_t n, MeshTagT2* /*tag*/)
+        {
+          return (n >= 3);
+        }
+
         ////////////////////////////////////////////////////////////////////////
         // addEdge
         ////////////////////////////////////////////////////////////////////////
@@ -1946,9 +2409,11 @@ namespace pcl
 
         /** \brief Resize the mesh data. */
         template <class DataCloudT> inline void
-        resizeData (DataCloudT& /*data_cloud*/, const std::size_t n, const typename DataCloudT::value_type& data, std::true_type /*has_data*/) const
+        resizeData (DataCloudT& data_cloud, const std::size_t n, const typename DataCloudT::value_type& data, std::true_type /*has_data*/) const
         {
-          data.resize (n, data);
+          data_cloud.points.resize (n, data);
+          data_cloud.width = static_cast <std::uint32_t> (n);
+          data_cloud.height = 1;
         }
 
         /** \brief Does nothing. */
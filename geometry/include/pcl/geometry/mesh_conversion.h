@@ -78,14 +78,18 @@ namespace pcl
     }
 
     /** \brief Convert a face-vertex mesh to a half-edge mesh.
+      *
+      * The faces are added with MeshBase::addFaces, which builds the connectivity of all faces at once if the
+      * half-edge mesh has no faces yet.
       * \param[in] face_vertex_mesh The input mesh.
       * \param[out] half_edge_mesh The output mesh. It must have data associated with the vertices.
+      * \param[in] nr_threads The number of threads to build the connectivity with, see MeshBase::addFaces.
       * \return The number of faces that could NOT be added to the half-edge mesh.
       * \author Martin Saelzle
       * \ingroup geometry
       */
     template <class HalfEdgeMeshT> int
-    toHalfEdgeMesh (const pcl::PolygonMesh& face_vertex_mesh, HalfEdgeMeshT& half_edge_mesh)
+    toHalfEdgeMesh (const pcl::PolygonMesh& face_vertex_mesh, HalfEdgeMeshT& half_edge_mesh, const unsigned int nr_threads = 1)
     {
       using HalfEdgeMesh = HalfEdgeMeshT;
       using VertexDataCloud = typename HalfEdgeMesh::VertexDataCloud;
@@ -107,24 +111,23 @@ namespace pcl
 
       assert (half_edge_mesh.sizeVertices () == vertices.size ());
 
-      int count_not_added = 0;
+      // Put the faces one after the other in an index buffer
       VertexIndices vi;
-      vi.reserve (3); // Minimum number (triangle)
+      std::vector <std::size_t> offsets;
+      vi.reserve (3 * face_vertex_mesh.polygons.size ()); // Minimum number (triangles)
+      offsets.reserve (face_vertex_mesh.polygons.size () + 1);
       for (const auto &polygon : face_vertex_mesh.polygons)
       {
-        vi.clear ();
+        offsets.push_back (vi.size ());
         for (const unsigned int &vertex : polygon.vertices)
         {
           vi.emplace_back (vertex);
         }
-
-        if (!half_edge_mesh.addFace (vi).isValid ())
-        {
-          ++count_not_added;
-        }
       }
+      offsets.push_back (vi.size ());
 
-      return (count_not_added);
+      const std::size_t nr_added = half_edge_mesh.addFaces (vi, offsets, typename HalfEdgeMesh::FaceDataCloud (), nr_threads);
+      return (static_cast <int> (face_vertex_mesh.polygons.size () - nr_added));
     }
   } // End namespace geometry
 } // End namespace pcl
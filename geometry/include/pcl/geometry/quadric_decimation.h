@@ -0,0 +1,315 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Point Cloud Library (PCL) - www.pointclouds.org
+ * Copyright (c) 2020-, Open Perception, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *  * Neither the name of the copyright holder(s) nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/geometry/triangle_mesh.h>
+
+#include <Eigen/Core>
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace pcl
+{
+  namespace geometry
+  {
+    /** \brief Simplification of a triangle mesh by quadric edge collapses.
+      *
+      * Edges are collapsed in the order of the error they introduce, as measured by the quadric error metric of
+      * Garland and Heckbert: the mean squared distance of the merged vertex to the planes of the original faces
+      * merged into it, weighted by their areas. The merged vertex is placed where this error is minimal. Collapses
+      * which would flip a face or make the mesh non-manifold are skipped, and the boundary of the mesh is kept in
+      * place by additional planes perpendicular to it.
+      *
+      * The decimation stops once the mesh has the target number of faces, or when no edge can be collapsed with an
+      * error below the maximum error. Large meshes are first decimated in parallel: their vertices are split into
+      * spatially coherent parts, and each part collapses the edges whose faces lie entirely within it, down to the
+      * target proportion of faces. The remaining edges, notably along the seams between the parts, are collapsed in
+      * a final sequential pass. The parts only depend on the mesh, so the result does not depend on the number of
+      * threads.
+      *
+      * The mesh is rebuilt at the end: the remaining vertices and faces keep their data (with the new positions of
+      * the vertices), the data of the half-edges and edges is lost, and the deleted and isolated vertices are
+      * removed as with MeshBase::cleanUp ().
+      *
+      * \note M. Garland and P. S. Heckbert. Surface Simplification Using Quadric Error Metrics. SIGGRAPH 1997.
+      * \tparam MeshT A pcl::geometry::TriangleMesh whose vertex data has x, y and z fields.
+      * \ingroup geometry
+      */
+    template <class MeshT>
+    class QuadricDecimation
+    {
+      public:
+
+        using Mesh = MeshT;
+        using VertexIndex = typename Mesh::VertexIndex;
+        using FaceIndex = typename Mesh::FaceIndex;
+
+        static_assert (std::is_same <typename Mesh::MeshTag, pcl::geometry::TriangleMeshTag>::value, "The mesh must be a triangle mesh!");
+        static_assert (Mesh::HasVertexData::value, "The mesh must have data associated with the vertices!");
+
+        /** \brief Constructor. */
+        QuadricDecimation ()
+          : target_nr_faces_ (0),
+            max_error_ (std::numeric_limits <double>::max ()),
+            boundary_weight_ (1000.0),
+            threads_ (1),
+            nr_dropped_faces_ (0)
+        {
+        }
+
+        /** \brief Set the number of faces at which the decimation stops (0 to only stop at the maximum error). */
+        inline void
+        setTargetNumberOfFaces (const std::size_t nr_faces)
+        {
+          target_nr_faces_ = nr_faces;
+        }
+
+        /** \brief Get the number of faces at which the decimation stops. */
+        inline std::size_t
+        getTargetNumberOfFaces () const
+        {
+          return (target_nr_faces_);
+        }
+
+        /** \brief Set the maximum error of a collapse, i.e. the maximum mean squared distance of a merged vertex to the planes of the faces merged into it. */
+        inline void
+        setMaxError (const double max_error)
+        {
+          max_error_ = max_error;
+        }
+
+        /** \brief Get the maximum error of a collapse. */
+        inline double
+        getMaxError () const
+        {
+          return (max_error_);
+        }
+
+        /** \brief Set the weight of the planes keeping the boundary in place, relative to the planes of the faces (default: 1000). */
+        inline void
+        setBoundaryWeight (const double weight)
+        {
+          boundary_weight_ = weight;
+        }
+
+        /** \brief Get the weight of the planes keeping the boundary in place. */
+        inline double
+        getBoundaryWeight () const
+        {
+          return (boundary_weight_);
+        }
+
+        /** \brief Set the number of threads to use.
+          * \param[in] nr_threads The number of threads to use (0 sets the value to the thread budget, see pcl::parallel::setThreadBudget ()).
+          */
+        inline void
+        setNumberOfThreads (const unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get the number of threads to use. */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
+        /** \brief Decimate the mesh.
+          * \param[in,out] mesh The mesh to decimate.
+          * \return The number of faces of the decimated mesh.
+          */
+        std::size_t
+        decimate (Mesh& mesh);
+
+        /** \brief Get the number of faces of the last decimated mesh which could not be added back to it. This only
+          * happens for vertices with several fans of faces, which a manifold input mesh does not have.
+          */
+        inline std::size_t
+        getNumberOfDroppedFaces () const
+        {
+          return (nr_dropped_faces_);
+        }
+
+      protected:
+
+        /** \brief Sum of the squared distances to weighted planes, as the symmetric matrix of the quadratic form. The total area of the faces is kept along for the normalization of the error. */
+        struct Quadric
+        {
+          double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0, b2 = 0.0, bc = 0.0, bd = 0.0, c2 = 0.0, cd = 0.0, d2 = 0.0;
+          double area = 0.0;
+
+          /** \brief Add the plane n.p + d = 0 with the given weight. */
+          void
+          addPlane (const Eigen::Vector3d& n, const double d, const double weight);
+
+          Quadric&
+          operator+= (const Quadric& other);
+
+          /** \brief Get the weighted sum of the squared distances of p to the planes. */
+          double
+          evaluate (const Eigen::Vector3d& p) const;
+
+          /** \brief Find the point minimizing the error. Fails if the minimum is not unique (e.g. for coplanar planes). */
+          bool
+          optimize (Eigen::Vector3d& p) const;
+        };
+
+        /** \brief A candidate collapse of an edge, removing one of its vertices. The versions of the vertices are those the collapse was computed with. */
+        struct Collapse
+        {
+          double cost;
+          int keep;
+          int remove;
+          unsigned int keep_version;
+          unsigned int remove_version;
+        };
+
+        /** \brief Orders the collapses from the cheapest one in a heap, and then by vertex, so that the order is deterministic. */
+        struct CollapseGreater
+        {
+          inline bool
+          operator () (const Collapse& lhs, const Collapse& rhs) const
+          {
+            if (lhs.cost != rhs.cost) return (lhs.cost > rhs.cost);
+            if (lhs.keep != rhs.keep) return (lhs.keep > rhs.keep);
+            return (lhs.remove > rhs.remove);
+          }
+        };
+
+        /** \brief Buffers used by the collapses of one part of the mesh. */
+        struct Workspace
+        {
+          std::vector <Collapse> heap;
+          std::vector <int> neighbors_keep;
+          std::vector <int> neighbors_remove;
+        };
+
+        /** \brief Copy the mesh into the buffers and compute the quadrics of the vertices. */
+        void
+        initCompute (Mesh& mesh);
+
+        /** \brief Compute the cost and the merged vertex of the collapse of an edge. */
+        void
+        computeCollapse (const int v0, const int v1, Collapse& collapse, Eigen::Vector3d& position) const;
+
+        /** \brief Check if an edge can be collapsed into the given position.
+          * \param[in] part The part in which the collapse happens, whose vertices the faces around the edge must be in (-1 for any part).
+          */
+        bool
+        isCollapsible (const int keep, const int remove, const Eigen::Vector3d& position, const int part, Workspace& workspace) const;
+
+        /** \brief Check if moving a vertex of a face to the given position turns the face too much, or against the original face. */
+        bool
+        flips (const int face, const int vertex, const Eigen::Vector3d& position) const;
+
+        /** \brief Collapse an edge. \return The number of faces removed. */
+        std::size_t
+        collapse (const int keep, const int remove, const Eigen::Vector3d& position);
+
+        /** \brief Push the collapses of the edges around a vertex into the heap of the workspace. */
+        void
+        pushCollapses (const int vertex, const int part, Workspace& workspace) const;
+
+        /** \brief Collapse the edges of the heap of the workspace until the target number of faces is reached.
+          * \return The number of faces left.
+          */
+        std::size_t
+        collapseEdges (std::size_t nr_faces, const std::size_t target_nr_faces, const int part, Workspace& workspace);
+
+        /** \brief Decimate the parts of the mesh in parallel, down to the given proportion of their faces. \return The number of faces removed. */
+        std::size_t
+        decimateParts (const std::size_t nr_parts, const double ratio);
+
+        /** \brief Replace the mesh by the decimated one. \return The number of faces which could not be added. */
+        std::size_t
+        rebuild (Mesh& mesh) const;
+
+        /** \brief The number of faces at which the decimation stops. */
+        std::size_t target_nr_faces_;
+
+        /** \brief The maximum error of a collapse. */
+        double max_error_;
+
+        /** \brief The weight of the planes keeping the boundary in place. */
+        double boundary_weight_;
+
+        /** \brief The number of threads to use. */
+        unsigned int threads_;
+
+        /** \brief The number of faces the last decimate () could not add back to the mesh. */
+        std::size_t nr_dropped_faces_;
+
+        /** \brief The positions of the vertices. */
+        std::vector <Eigen::Vector3d> positions_;
+
+        /** \brief The quadrics of the vertices. */
+        std::vector <Quadric> quadrics_;
+
+        /** \brief The faces around each vertex, which may include removed faces. */
+        std::vector <std::vector <int> > vertex_faces_;
+
+        /** \brief The version of each vertex, increased when an edge is collapsed into it. */
+        std::vector <unsigned int> versions_;
+
+        /** \brief Whether each vertex is still in the mesh. */
+        std::vector <char> vertex_alive_;
+
+        /** \brief Whether each vertex lies on the boundary. */
+        std::vector <char> vertex_boundary_;
+
+        /** \brief The part of each vertex during the parallel decimation. */
+        std::vector <int> parts_;
+
+        /** \brief The vertices of the faces. */
+        std::vector <std::array <int, 3> > faces_;
+
+        /** \brief The normals of the faces of the original mesh, scaled by twice their areas. */
+        std::vector <Eigen::Vector3d> normals_;
+
+        /** \brief Whether each face is still in the mesh. */
+        std::vector <char> face_alive_;
+    };
+  } // End namespace geometry
+} // End namespace pcl
+
+#include <pcl/geometry/impl/quadric_decimation.hpp>
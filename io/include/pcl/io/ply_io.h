@@ -46,8 +46,12 @@
 #include <pcl/io/ply/ply_parser.h>
 #include <pcl/PolygonMesh.h>
 
+#include <cstdint>
+#include <functional>
 #include <sstream>
+#include <string>
 #include <tuple>
+#include <vector>
 
 namespace pcl
 {
@@ -74,6 +78,11 @@ namespace pcl
     *   - [property list uchar int vertex_indices]
     *   - end header
     *
+    * The data is read directly from a memory map of the file, unless a vertex property is a list or the file has a
+    * range_grid element, in which case it is read value by value by pcl::io::ply::ply_parser. Binary vertices are
+    * copied at once when their properties are laid out as the fields of the cloud, and the records of the elements
+    * are split into chunks which are parsed in parallel (see setNumberOfThreads ()).
+    *
     * \author Nizar Sallem
     * \ingroup io
     */
@@ -96,6 +105,9 @@ namespace pcl
         , rgb_offset_before_ (0)
         , do_resize_ (false)
         , polygons_ (nullptr)
+        , format_ (pcl::io::ply::unknown)
+        , read_data_ (false)
+        , threads_ (1)
         , r_(0), g_(0), b_(0)
         , a_(0), rgba_(0)
       {}
@@ -110,6 +122,9 @@ namespace pcl
         , rgb_offset_before_ (0)
         , do_resize_ (false)
         , polygons_ (nullptr)
+        , format_ (pcl::io::ply::unknown)
+        , read_data_ (false)
+        , threads_ (1)
         , r_(0), g_(0), b_(0)
         , a_(0), rgba_(0)
       {
@@ -123,10 +138,22 @@ namespace pcl
         orientation_ = p.orientation_;
         range_grid_ = p.range_grid_;
         polygons_ = p.polygons_;
+        threads_ = p.threads_;
         return (*this);
       }
 
       ~PLYReader () { delete range_grid_; }
+
+      /** \brief Set the number of threads used to parse the data of the files read directly (default: 1).
+        * \param[in] nr_threads the number of threads (0 sets the value to the thread budget, see pcl::parallel::setThreadBudget ())
+        */
+      inline void
+      setNumberOfThreads (const unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads used to parse the data of the files read directly. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Read a point cloud data header from a PLY file.
         *
         * Load only the meta information (number of points, their types, etc),
@@ -250,6 +277,100 @@ namespace pcl
       bool
       parse (const std::string& istream_filename);
 
+      /** \brief How a property is stored in the data of the file, and how its values are read directly. */
+      struct PropertyLayout
+      {
+        enum Action
+        {
+          SKIP,         ///< the values are ignored
+          COPY,         ///< the value is copied into the point
+          PACK,         ///< the color channel is packed into the rgb(a) field of the point
+          INTENSITY,    ///< the uchar intensity is converted into a float of the point
+          INVOKE,       ///< the value is passed to the callback
+          FACE_INDICES, ///< the list is stored as the vertices of the polygon
+          UNSUPPORTED   ///< the values can only be read by the parser
+        };
+
+        PropertyLayout (std::uint8_t type, std::uint8_t size_type = 0)
+          : type (type), size_type (size_type), action (SKIP), offset (0), shift (0)
+        {}
+
+        /** \brief Type of the values, as a pcl::PCLPointField datatype. */
+        std::uint8_t type;
+        /** \brief Type of the size of a list, as a pcl::PCLPointField datatype (0 for a scalar property). */
+        std::uint8_t size_type;
+        Action action;
+        /** \brief Offset of the value in the point (COPY, PACK and INTENSITY). */
+        std::uint32_t offset;
+        /** \brief Shift of the color channel in the rgb(a) field (PACK). */
+        std::uint32_t shift;
+        /** \brief Callback taking the address of the value, in the host byte order (INVOKE). */
+        std::function<void (const void*)> callback;
+      };
+
+      /** \brief The properties of an element, in the order of the file. */
+      struct ElementLayout
+      {
+        ElementLayout (const std::string& name, std::size_t count) : name (name), count (count), contiguous (false) {}
+
+        std::string name;
+        std::size_t count;
+        std::vector<PropertyLayout> properties;
+        /** \brief Whether the binary records are laid out as the points of the cloud. */
+        bool contiguous;
+      };
+
+      /** \brief Append a scalar property to the layout of the current element, and get its callback. */
+      template <typename Scalar> std::function<void (Scalar)>
+      layoutScalarProperty (const std::string& element_name, const std::string& property_name);
+
+      /** \brief Append a list property to the layout of the current element, and get its callbacks.
+        * \param[in] handled whether the type of list is handled, otherwise no callbacks are returned
+        */
+      template <typename SizeType, typename ScalarType>
+      std::tuple<std::function<void (SizeType)>, std::function<void (ScalarType)>, std::function<void ()> >
+      layoutListProperty (const std::string& element_name, const std::string& property_name, bool handled);
+
+      /** \brief Set how the values of the last property of the layout are read directly. */
+      void
+      setPropertyAction (PropertyLayout::Action action, std::uint32_t offset = 0, std::uint32_t shift = 0);
+
+      /** \brief Read the data of the file directly, following the layout of the elements.
+        * \return true on success, false on failure
+        */
+      bool
+      readData (const std::string& file_name);
+
+      /** \brief Read the data of a binary file directly from [data, end). */
+      bool
+      readBinaryData (const std::string& file_name, const unsigned char* data, const unsigned char* end);
+
+      /** \brief Read the data of an ASCII file directly from [data, end).
+        * \param[in] line_number the number of lines of the header, for the messages
+        */
+      bool
+      readASCIIData (const std::string& file_name, const char* data, const char* end, std::size_t line_number);
+
+      /** \brief Read a binary record of an element.
+        * \param[out] point the point the record is stored into, if any
+        * \param[out] polygon the polygon the record is stored into, if any
+        * \return the end of the record
+        */
+      const unsigned char*
+      readBinaryRecord (const ElementLayout& element, const unsigned char* record, bool swap,
+                        std::uint8_t* point, pcl::Vertices* polygon, bool& is_dense) const;
+
+      /** \brief Parse an ASCII record (a line) of an element.
+        * \param[in] stream a stream imbued with the classic locale to parse the floating point numbers with, or
+        * nullptr if the decimal point of the C locale is a dot and std::strtod can parse them
+        * \param[out] point the point the record is stored into, if any
+        * \param[out] polygon the polygon the record is stored into, if any
+        * \return false if the line does not match the properties
+        */
+      bool
+      readASCIIRecord (const ElementLayout& element, const char* line, const char* line_end, std::istringstream* stream,
+                       std::uint8_t* point, pcl::Vertices* polygon, bool& is_dense) const;
+
       /** \brief Info callback function
         * \param[in] filename PLY file read
         * \param[in] line_number line triggering the callback
@@ -530,6 +651,11 @@ namespace pcl
       bool do_resize_;
       //face element artifact
       std::vector<pcl::Vertices> *polygons_;
+      //direct reading of the data
+      pcl::io::ply::format_type format_;
+      std::vector<ElementLayout> layout_;
+      bool read_data_;
+      unsigned int threads_;
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
       
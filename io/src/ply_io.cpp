@@ -38,12 +38,21 @@
 #include <fcntl.h>
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
+#include <pcl/common/parallel.h>
+#include <pcl/io/low_level_io.h>
 #include <pcl/io/ply_io.h>
 #include <pcl/io/boost.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <clocale>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <limits>
+#include <locale>
 #include <map>
 #include <sstream>
 #include <string>
@@ -58,6 +67,7 @@ namespace fs = boost::filesystem;
 std::tuple<std::function<void ()>, std::function<void ()> >
 pcl::PLYReader::elementDefinitionCallback (const std::string& element_name, std::size_t count)
 {
+  layout_.emplace_back (element_name, count);
   if (element_name == "vertex")
   {
     cloud_->data.clear ();
@@ -102,7 +112,31 @@ bool
 pcl::PLYReader::endHeaderCallback ()
 {
   cloud_->data.resize (static_cast<std::size_t>(cloud_->point_step) * cloud_->width * cloud_->height);
-  return (true);
+
+  // Read the data directly unless some properties need the parser
+  read_data_ = (format_ != pcl::io::ply::unknown);
+  for (auto &element : layout_)
+  {
+    for (const auto &property : element.properties)
+      if (property.action == PropertyLayout::UNSUPPORTED)
+        read_data_ = false;
+    if (element.name != "vertex")
+      continue;
+    if (static_cast<std::size_t> (cloud_->point_step) * element.count > cloud_->data.size ())
+      read_data_ = false;
+    // The binary records can be copied at once if they hold the fields of the points in order
+    std::uint32_t offset = 0;
+    element.contiguous = true;
+    for (const auto &property : element.properties)
+    {
+      if (property.action != PropertyLayout::COPY || property.offset != offset)
+        element.contiguous = false;
+      offset += static_cast<std::uint32_t> (pcl::getFieldSize (property.type));
+    }
+    element.contiguous = element.contiguous && (offset == cloud_->point_step);
+  }
+  // Stop the parser after the header if the data is read directly
+  return (!read_data_);
 }
 
 template<typename Scalar> void
@@ -130,6 +164,15 @@ pcl::PLYReader::amendProperty (const std::string& old_name, const std::string& n
     finder->datatype = new_datatype;
 }
 
+void
+pcl::PLYReader::setPropertyAction (PropertyLayout::Action action, std::uint32_t offset, std::uint32_t shift)
+{
+  PropertyLayout &property = layout_.back ().properties.back ();
+  property.action = action;
+  property.offset = offset;
+  property.shift = shift;
+}
+
 namespace pcl
 {
   template <>
@@ -139,6 +182,7 @@ namespace pcl
     if (element_name == "vertex")
     {
       appendScalarProperty<pcl::io::ply::float32> (property_name, 1);
+      setPropertyAction (PropertyLayout::COPY, cloud_->fields.back ().offset);
       return ([this] (pcl::io::ply::float32 value) { vertexScalarPropertyCallback<pcl::io::ply::float32> (value); });
     }
     if (element_name == "camera")
@@ -205,19 +249,37 @@ namespace pcl
       {
         if ((property_name == "red") || (property_name == "diffuse_red"))
           appendScalarProperty<pcl::io::ply::float32> ("rgb");
+        const auto rgb = std::find_if (cloud_->fields.rbegin (), cloud_->fields.rend (),
+                                       [] (const pcl::PCLPointField &field) { return (field.name == "rgb" || field.name == "rgba"); });
+        if (rgb == cloud_->fields.rend ())
+          setPropertyAction (PropertyLayout::UNSUPPORTED);
+        else if ((property_name == "red") || (property_name == "diffuse_red"))
+          setPropertyAction (PropertyLayout::PACK, rgb->offset, 16);
+        else if ((property_name == "green") || (property_name == "diffuse_green"))
+          setPropertyAction (PropertyLayout::PACK, rgb->offset, 8);
+        else
+          setPropertyAction (PropertyLayout::PACK, rgb->offset, 0);
         return [=] (pcl::io::ply::uint8 color) { vertexColorCallback (property_name, color); };
       }
       if (property_name == "alpha")
       {
         amendProperty ("rgb", "rgba", pcl::PCLPointField::UINT32);
+        const auto rgba = std::find_if (cloud_->fields.rbegin (), cloud_->fields.rend (),
+                                        [] (const pcl::PCLPointField &field) { return (field.name == "rgba"); });
+        if (rgba == cloud_->fields.rend ())
+          setPropertyAction (PropertyLayout::UNSUPPORTED);
+        else
+          setPropertyAction (PropertyLayout::PACK, rgba->offset, 24);
         return [this] (pcl::io::ply::uint8 alpha) { vertexAlphaCallback (alpha); };
       }
       if (property_name == "intensity")
       {
         appendScalarProperty<pcl::io::ply::float32> (property_name);
+        setPropertyAction (PropertyLayout::INTENSITY, cloud_->fields.back ().offset);
         return [this] (pcl::io::ply::uint8 intensity) { vertexIntensityCallback (intensity); };
       }
       appendScalarProperty<pcl::io::ply::uint8> (property_name);
+      setPropertyAction (PropertyLayout::COPY, cloud_->fields.back ().offset);
       return ([this] (pcl::io::ply::uint8 value) { vertexScalarPropertyCallback<pcl::io::ply::uint8> (value); });
     }
     return {};
@@ -229,6 +291,7 @@ namespace pcl
     if (element_name == "vertex")
     {
       appendScalarProperty<pcl::io::ply::int32> (property_name, 1);
+      setPropertyAction (PropertyLayout::COPY, cloud_->fields.back ().offset);
       return ([this] (pcl::io::ply::uint32 value) { vertexScalarPropertyCallback<pcl::io::ply::uint32> (value); });
     }
     if (element_name == "camera")
@@ -252,6 +315,7 @@ namespace pcl
     if (element_name == "vertex")
     {
       appendScalarProperty<Scalar> (property_name, 1);
+      setPropertyAction (PropertyLayout::COPY, cloud_->fields.back ().offset);
       return ([this] (Scalar value) { vertexScalarPropertyCallback<Scalar> (value); });
     }
     return {};
@@ -315,6 +379,7 @@ namespace pcl
   {
     if ((element_name == "range_grid") && (property_name == "vertex_indices" || property_name == "vertex_index"))
     {
+      setPropertyAction (PropertyLayout::UNSUPPORTED);
       return std::tuple<std::function<void (pcl::io::ply::uint8)>, std::function<void (pcl::io::ply::int32)>, std::function<void ()> > (
         [this] (pcl::io::ply::uint8 size) { rangeGridVertexIndicesBeginCallback (size); },
         [this] (pcl::io::ply::int32 vertex_index) { rangeGridVertexIndicesElementCallback (vertex_index); },
@@ -323,6 +388,7 @@ namespace pcl
     }
     if ((element_name == "face") && (property_name == "vertex_indices" || property_name == "vertex_index") && polygons_)
     {
+      setPropertyAction (PropertyLayout::FACE_INDICES);
       return std::tuple<std::function<void (pcl::io::ply::uint8)>, std::function<void (pcl::io::ply::int32)>, std::function<void ()> > (
         [this] (pcl::io::ply::uint8 size) { faceVertexIndicesBeginCallback (size); },
         [this] (pcl::io::ply::int32 vertex_index) { faceVertexIndicesElementCallback (vertex_index); },
@@ -342,6 +408,7 @@ namespace pcl
       else
         cloud_->point_step = static_cast<std::uint32_t> (std::numeric_limits<std::uint32_t>::max ());
       do_resize_ = true;
+      setPropertyAction (PropertyLayout::UNSUPPORTED);
       return std::tuple<std::function<void (pcl::io::ply::uint8)>, std::function<void (pcl::io::ply::int32)>, std::function<void ()> > (
         std::bind (&pcl::PLYReader::vertexListPropertyBeginCallback<pcl::io::ply::uint8>, this, property_name, std::placeholders::_1),
         [this] (pcl::io::ply::int32 value) { vertexListPropertyContentCallback<pcl::io::ply::int32> (value); },
@@ -368,6 +435,7 @@ namespace pcl
       else
         cloud_->point_step = static_cast<std::uint32_t> (std::numeric_limits<std::uint32_t>::max ());
       do_resize_ = true;
+      setPropertyAction (PropertyLayout::UNSUPPORTED);
       return std::tuple<std::function<void (SizeType)>, std::function<void (ContentType)>, std::function<void ()> > (
         std::bind (&pcl::PLYReader::vertexListPropertyBeginCallback<SizeType>, this, property_name, std::placeholders::_1),
         [this] (ContentType value) { vertexListPropertyContentCallback (value); },
@@ -378,6 +446,35 @@ namespace pcl
   }
 }
 
+template <typename Scalar> std::function<void (Scalar)>
+pcl::PLYReader::layoutScalarProperty (const std::string& element_name, const std::string& property_name)
+{
+  layout_.back ().properties.push_back (PropertyLayout (pcl::traits::asEnum<Scalar>::value));
+  const std::function<void (Scalar)> callback = scalarPropertyDefinitionCallback<Scalar> (element_name, property_name);
+  PropertyLayout &property = layout_.back ().properties.back ();
+  if (callback && property.action == PropertyLayout::SKIP)
+  {
+    property.action = PropertyLayout::INVOKE;
+    property.callback = [callback] (const void* value)
+    {
+      Scalar scalar;
+      memcpy (&scalar, value, sizeof (Scalar));
+      callback (scalar);
+    };
+  }
+  return (callback);
+}
+
+template <typename SizeType, typename ScalarType>
+std::tuple<std::function<void (SizeType)>, std::function<void (ScalarType)>, std::function<void ()> >
+pcl::PLYReader::layoutListProperty (const std::string& element_name, const std::string& property_name, bool handled)
+{
+  layout_.back ().properties.push_back (PropertyLayout (pcl::traits::asEnum<ScalarType>::value, pcl::traits::asEnum<SizeType>::value));
+  if (!handled)
+    return {};
+  return (listPropertyDefinitionCallback<SizeType, ScalarType> (element_name, property_name));
+}
+
 void
 pcl::PLYReader::vertexColorCallback (const std::string& color_name, pcl::io::ply::uint8 color)
 {
@@ -524,6 +621,9 @@ bool
 pcl::PLYReader::parse (const std::string& istream_filename)
 {
   pcl::io::ply::ply_parser ply_parser;
+  layout_.clear ();
+  format_ = pcl::io::ply::unknown;
+  read_data_ = false;
 
   ply_parser.info_callback ([&, this] (std::size_t line_number, const std::string& message) { infoCallback (istream_filename, line_number, message); });
   ply_parser.warning_callback ([&, this] (std::size_t line_number, const std::string& message) { warningCallback (istream_filename, line_number, message); });
@@ -531,32 +631,665 @@ pcl::PLYReader::parse (const std::string& istream_filename)
 
   ply_parser.obj_info_callback ([this] (const std::string& line) { objInfoCallback (line); });
   ply_parser.element_definition_callback ([this] (const std::string& element_name, std::size_t count) { return elementDefinitionCallback (element_name, count); });
+  ply_parser.format_callback ([this] (pcl::io::ply::format_type format, const std::string&) { format_ = format; });
   ply_parser.end_header_callback ([this] { return endHeaderCallback (); });
 
   pcl::io::ply::ply_parser::scalar_property_definition_callbacks_type scalar_property_definition_callbacks;
-  pcl::io::ply::ply_parser::at<pcl::io::ply::float64> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::float64> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::float32> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::float32> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::int8> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::int8> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::uint8> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::int32> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::int32> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::uint32> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::int16> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::int16> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::uint16> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::float64> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::float64> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::float32> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::float32> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::int8> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::int8> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::uint8> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::int32> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::int32> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::uint32> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::int16> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::int16> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutScalarProperty<pcl::io::ply::uint16> (element_name, property_name); };
   ply_parser.scalar_property_definition_callbacks (scalar_property_definition_callbacks);
 
   pcl::io::ply::ply_parser::list_property_definition_callbacks_type list_property_definition_callbacks;
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::int32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint8, pcl::io::ply::int32> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::float64> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::float64> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::float32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::float32> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::uint32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::uint32> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::int32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::int32> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::uint16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::uint16> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::int16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::int16> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::uint8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::uint8> (element_name, property_name); };
-  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::int8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return listPropertyDefinitionCallback<pcl::io::ply::uint32, pcl::io::ply::int8> (element_name, property_name); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::int32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::int32> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::float64> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::float64> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::float32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::float32> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::uint32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::uint32> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::int32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::int32> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::uint16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::uint16> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::int16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::int16> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::uint8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::uint8> (element_name, property_name, true); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint32, pcl::io::ply::int8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint32, pcl::io::ply::int8> (element_name, property_name, true); };
+  // The other lists are not handled, but are part of the layout of the data
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::int8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::int8> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::int16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::int16> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::uint8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::uint8> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::uint16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::uint16> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::uint32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::uint32> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::float32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::float32> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint8, pcl::io::ply::float64> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint8, pcl::io::ply::float64> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::int8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::int8> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::int16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::int16> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::int32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::int32> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::uint8> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::uint8> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::uint16> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::uint16> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::uint32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::uint32> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::float32> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::float32> (element_name, property_name, false); };
+  pcl::io::ply::ply_parser::at<pcl::io::ply::uint16, pcl::io::ply::float64> (list_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return layoutListProperty<pcl::io::ply::uint16, pcl::io::ply::float64> (element_name, property_name, false); };
   ply_parser.list_property_definition_callbacks (list_property_definition_callbacks);
 
-  return ply_parser.parse (istream_filename);
+  if (!ply_parser.parse (istream_filename))
+    return (false);
+  return (!read_data_ || readData (istream_filename));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \brief Number of records of an element in a chunk read by a thread. */
+  constexpr std::size_t records_per_chunk = 4096;
+
+  /** \brief Copy a value of a binary file, swapping its bytes if the file and the host byte orders differ. */
+  inline void
+  copyValue (void* dst, const unsigned char* src, std::size_t size, bool swap)
+  {
+    if (swap)
+      std::reverse_copy (src, src + size, static_cast<unsigned char*> (dst));
+    else
+      memcpy (dst, src, size);
+  }
+
+  /** \brief Read the size of a list of a binary file. */
+  inline std::size_t
+  readListSize (const unsigned char* data, std::uint8_t size_type, bool swap)
+  {
+    if (size_type == pcl::PCLPointField::UINT8)
+      return (*data);
+    if (size_type == pcl::PCLPointField::UINT16)
+    {
+      std::uint16_t size;
+      copyValue (&size, data, sizeof (size), swap);
+      return (size);
+    }
+    std::uint32_t size;
+    copyValue (&size, data, sizeof (size), swap);
+    return (size);
+  }
+
+  /** \brief Check that a value is not a NaN or an infinity. */
+  inline bool
+  isFiniteValue (const void* value, std::uint8_t type)
+  {
+    if (type == pcl::PCLPointField::FLOAT32)
+    {
+      float v;
+      memcpy (&v, value, sizeof (v));
+      return (std::isfinite (v));
+    }
+    if (type == pcl::PCLPointField::FLOAT64)
+    {
+      double v;
+      memcpy (&v, value, sizeof (v));
+      return (std::isfinite (v));
+    }
+    return (true);
+  }
+
+  /** \brief Or a color channel into a packed rgb(a) value. */
+  inline void
+  packColor (std::uint8_t* rgba, std::uint8_t channel, std::uint32_t shift)
+  {
+    std::uint32_t value;
+    memcpy (&value, rgba, sizeof (value));
+    value |= static_cast<std::uint32_t> (channel) << shift;
+    memcpy (rgba, &value, sizeof (value));
+  }
+
+  /** \brief Get the next token of a line, separated by whitespace. */
+  inline bool
+  nextToken (const char*& line, const char* line_end, const char*& token, std::size_t& length)
+  {
+    while (line != line_end && std::isspace (static_cast<unsigned char> (*line)))
+      ++line;
+    token = line;
+    while (line != line_end && !std::isspace (static_cast<unsigned char> (*line)))
+      ++line;
+    length = line - token;
+    return (length > 0);
+  }
+
+  /** \brief Parse a token as an integer, in the range of the type the parser reads it as. */
+  template <typename ParseType> inline bool
+  parseInteger (const char* str, std::size_t length, long long& value)
+  {
+    char* str_end;
+    errno = 0;
+    value = std::strtoll (str, &str_end, 10);
+    return (str_end == str + length && errno == 0 &&
+            value >= static_cast<long long> (std::numeric_limits<ParseType>::lowest ()) &&
+            value <= static_cast<long long> (std::numeric_limits<ParseType>::max ()));
+  }
+
+  /** \brief Parse a token as a floating point number with std::strtof, which only gives the number of the
+    * classic locale if the decimal point of the C locale is a dot.
+    */
+  inline bool
+  parseFloat (const char* str, std::size_t length, float& value)
+  {
+    char* str_end;
+    value = std::strtof (str, &str_end);
+    return (str_end == str + length);
+  }
+
+  /** \brief Parse a token as a floating point number with std::strtod, which only gives the number of the
+    * classic locale if the decimal point of the C locale is a dot.
+    */
+  inline bool
+  parseFloat (const char* str, std::size_t length, double& value)
+  {
+    char* str_end;
+    value = std::strtod (str, &str_end);
+    return (str_end == str + length);
+  }
+
+  /** \brief Parse a token as a floating point number with a stream imbued with the classic locale, whatever the
+    * locale of the program is. Unlike std::strtod, the stream does not parse infinities, which are handled apart.
+    */
+  template <typename Type> inline bool
+  parseFloat (const char* str, std::istringstream& stream, Type& value)
+  {
+    stream.clear ();
+    stream.str (str);
+    if (stream >> value)
+      return (stream.peek () == std::char_traits<char>::eof ());
+
+    const std::size_t sign = (*str == '-' || *str == '+') ? 1 : 0;
+    if (boost::iequals (str + sign, "inf") || boost::iequals (str + sign, "infinity"))
+    {
+      value = (*str == '-') ? -std::numeric_limits<Type>::infinity () : std::numeric_limits<Type>::infinity ();
+      return (true);
+    }
+    return (false);
+  }
+
+  /** \brief Parse an ASCII token into a value in the host byte order. As with the parser, a token which is not a
+    * number of the type gives a NaN, i.e. 0 for integers.
+    * \param[in] stream the stream imbued with the classic locale to parse the floating point numbers with, or
+    * nullptr if std::strtod can parse them
+    */
+  void
+  parseValue (const char* token, std::size_t length, std::uint8_t type, std::istringstream* stream, void* value)
+  {
+    // strto* and the stream need a null terminated string
+    char buffer[64];
+    std::string long_token;
+    const char* str = buffer;
+    if (length < sizeof (buffer))
+    {
+      memcpy (buffer, token, length);
+      buffer[length] = '\0';
+    }
+    else
+    {
+      long_token.assign (token, length);
+      str = long_token.c_str ();
+    }
+
+    long long integer;
+    switch (type)
+    {
+      case pcl::PCLPointField::FLOAT32:
+      {
+        float v;
+        if (!(stream ? parseFloat (str, *stream, v) : parseFloat (str, length, v)))
+          v = std::numeric_limits<float>::quiet_NaN ();
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+      case pcl::PCLPointField::FLOAT64:
+      {
+        double v;
+        if (!(stream ? parseFloat (str, *stream, v) : parseFloat (str, length, v)))
+          v = std::numeric_limits<double>::quiet_NaN ();
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+      case pcl::PCLPointField::INT8:
+      {
+        const auto v = static_cast<std::int8_t> (parseInteger<pcl::io::ply::int16> (str, length, integer) ? integer : 0);
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+      case pcl::PCLPointField::UINT8:
+      {
+        const auto v = static_cast<std::uint8_t> (parseInteger<pcl::io::ply::uint16> (str, length, integer) ? integer : 0);
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+      case pcl::PCLPointField::INT16:
+      {
+        const auto v = static_cast<std::int16_t> (parseInteger<pcl::io::ply::int16> (str, length, integer) ? integer : 0);
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+      case pcl::PCLPointField::UINT16:
+      {
+        const auto v = static_cast<std::uint16_t> (parseInteger<pcl::io::ply::uint16> (str, length, integer) ? integer : 0);
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+      case pcl::PCLPointField::INT32:
+      {
+        const auto v = static_cast<std::int32_t> (parseInteger<pcl::io::ply::int32> (str, length, integer) ? integer : 0);
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+      default:
+      {
+        const auto v = static_cast<std::uint32_t> (parseInteger<pcl::io::ply::uint32> (str, length, integer) ? integer : 0);
+        memcpy (value, &v, sizeof (v));
+        break;
+      }
+    }
+  }
+
+  /** \brief Parse an ASCII token as the size of a list, which has to be valid. */
+  inline bool
+  parseListSize (const char* token, std::size_t length, std::uint8_t size_type, std::size_t& size)
+  {
+    char buffer[16];
+    if (length >= sizeof (buffer))
+      return (false);
+    memcpy (buffer, token, length);
+    buffer[length] = '\0';
+    long long integer;
+    bool valid;
+    if (size_type == pcl::PCLPointField::UINT8)
+      valid = parseInteger<pcl::io::ply::uint8> (buffer, length, integer);
+    else if (size_type == pcl::PCLPointField::UINT16)
+      valid = parseInteger<pcl::io::ply::uint16> (buffer, length, integer);
+    else
+      valid = parseInteger<pcl::io::ply::uint32> (buffer, length, integer);
+    size = static_cast<std::size_t> (integer);
+    return (valid);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+const unsigned char*
+pcl::PLYReader::readBinaryRecord (const ElementLayout& element, const unsigned char* record, bool swap,
+                                  std::uint8_t* point, pcl::Vertices* polygon, bool& is_dense) const
+{
+  unsigned char value[8];
+  for (const auto &property : element.properties)
+  {
+    const std::size_t size = pcl::getFieldSize (property.type);
+    if (property.size_type == 0)
+    {
+      switch (property.action)
+      {
+        case PropertyLayout::COPY:
+          copyValue (point + property.offset, record, size, swap);
+          is_dense = is_dense && isFiniteValue (point + property.offset, property.type);
+          break;
+        case PropertyLayout::PACK:
+          packColor (point + property.offset, *record, property.shift);
+          break;
+        case PropertyLayout::INTENSITY:
+        {
+          const float intensity = *record;
+          memcpy (point + property.offset, &intensity, sizeof (intensity));
+          break;
+        }
+        case PropertyLayout::INVOKE:
+          copyValue (value, record, size, swap);
+          property.callback (value);
+          break;
+        default:
+          break;
+      }
+      record += size;
+      continue;
+    }
+
+    const std::size_t list_size = readListSize (record, property.size_type, swap);
+    record += pcl::getFieldSize (property.size_type);
+    if (property.action == PropertyLayout::FACE_INDICES)
+    {
+      polygon->vertices.resize (list_size);
+      for (std::size_t i = 0; i < list_size; ++i, record += size)
+      {
+        std::int32_t vertex_index;
+        copyValue (&vertex_index, record, sizeof (vertex_index), swap);
+        polygon->vertices[i] = vertex_index;
+      }
+    }
+    else
+      record += list_size * size;
+  }
+  return (record);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PLYReader::readASCIIRecord (const ElementLayout& element, const char* line, const char* line_end,
+                                 std::istringstream* stream, std::uint8_t* point, pcl::Vertices* polygon,
+                                 bool& is_dense) const
+{
+  unsigned char value[8];
+  const char* token;
+  std::size_t length;
+  for (const auto &property : element.properties)
+  {
+    if (!nextToken (line, line_end, token, length))
+      return (false);
+    if (property.size_type == 0)
+    {
+      if (property.action == PropertyLayout::SKIP)
+        continue;
+      parseValue (token, length, property.type, stream, value);
+      switch (property.action)
+      {
+        case PropertyLayout::COPY:
+          memcpy (point + property.offset, value, pcl::getFieldSize (property.type));
+          is_dense = is_dense && isFiniteValue (value, property.type);
+          break;
+        case PropertyLayout::PACK:
+          packColor (point + property.offset, value[0], property.shift);
+          break;
+        case PropertyLayout::INTENSITY:
+        {
+          const float intensity = value[0];
+          memcpy (point + property.offset, &intensity, sizeof (intensity));
+          break;
+        }
+        case PropertyLayout::INVOKE:
+          property.callback (value);
+          break;
+        default:
+          break;
+      }
+      continue;
+    }
+
+    std::size_t list_size;
+    if (!parseListSize (token, length, property.size_type, list_size))
+      return (false);
+    if (property.action == PropertyLayout::FACE_INDICES)
+      polygon->vertices.resize (list_size);
+    for (std::size_t i = 0; i < list_size; ++i)
+    {
+      if (!nextToken (line, line_end, token, length))
+        return (false);
+      if (property.action == PropertyLayout::FACE_INDICES)
+      {
+        std::int32_t vertex_index;
+        parseValue (token, length, pcl::PCLPointField::INT32, stream, &vertex_index);
+        polygon->vertices[i] = vertex_index;
+      }
+    }
+  }
+  // The line must not hold more values than the properties
+  return (!nextToken (line, line_end, token, length));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PLYReader::readBinaryData (const std::string& file_name, const unsigned char* data, const unsigned char* end)
+{
+  const bool swap = ((format_ == pcl::io::ply::binary_big_endian_format) !=
+                     (pcl::io::ply::host_byte_order == pcl::io::ply::big_endian_byte_order));
+  for (const auto &element : layout_)
+  {
+    // Find the beginning of the chunks of records, checking that the file holds all of them
+    std::size_t record_size = 0;
+    bool fixed_size = true;
+    for (const auto &property : element.properties)
+    {
+      if (property.size_type == 0)
+        record_size += pcl::getFieldSize (property.type);
+      else
+        fixed_size = false;
+    }
+    std::vector<const unsigned char*> chunks;
+    if (fixed_size)
+    {
+      if (record_size > 0 && static_cast<std::size_t> (end - data) / record_size < element.count)
+      {
+        errorCallback (file_name, 0, "parse error: failed to read from the binary stream");
+        return (false);
+      }
+      for (std::size_t i = 0; i < element.count; i += records_per_chunk)
+        chunks.push_back (data + i * record_size);
+      data += element.count * record_size;
+    }
+    else
+    {
+      for (std::size_t i = 0; i < element.count; ++i)
+      {
+        if (i % records_per_chunk == 0)
+          chunks.push_back (data);
+        for (const auto &property : element.properties)
+        {
+          const std::size_t size = pcl::getFieldSize (property.type);
+          std::size_t list_size = 1;
+          if (property.size_type != 0)
+          {
+            const std::size_t size_size = pcl::getFieldSize (property.size_type);
+            if (static_cast<std::size_t> (end - data) < size_size)
+              list_size = std::numeric_limits<std::size_t>::max ();
+            else
+            {
+              list_size = readListSize (data, property.size_type, swap);
+              data += size_size;
+            }
+          }
+          if (static_cast<std::size_t> (end - data) / size < list_size)
+          {
+            errorCallback (file_name, 0, "parse error: failed to read from the binary stream");
+            return (false);
+          }
+          data += list_size * size;
+        }
+      }
+    }
+    chunks.push_back (data);
+
+    // Read the chunks
+    const bool is_vertex = (element.name == "vertex");
+    const bool is_face = (element.name == "face") && polygons_;
+    const std::size_t first_polygon = is_face ? polygons_->size () : 0;
+    if (is_face)
+      polygons_->resize (first_polygon + element.count);
+    const bool has_callbacks = std::any_of (element.properties.cbegin (), element.properties.cend (),
+                                            [] (const PropertyLayout &property) { return (property.action == PropertyLayout::INVOKE); });
+    const std::size_t point_step = cloud_->point_step;
+    std::vector<char> dense (chunks.size () - 1, true);
+    pcl::parallel::parallel_for (std::size_t (0), chunks.size () - 1, [&] (std::size_t first, std::size_t last)
+    {
+      for (std::size_t c = first; c < last; ++c)
+      {
+        const std::size_t begin = c * records_per_chunk;
+        const std::size_t chunk_end = std::min (begin + records_per_chunk, element.count);
+        bool is_dense = true;
+        if (element.contiguous && !swap)
+        {
+          std::uint8_t* points = cloud_->data.data () + begin * point_step;
+          memcpy (points, chunks[c], (chunk_end - begin) * point_step);
+          for (std::size_t i = begin; i < chunk_end; ++i, points += point_step)
+            for (const auto &property : element.properties)
+              is_dense = is_dense && isFiniteValue (points + property.offset, property.type);
+        }
+        else
+        {
+          const unsigned char* record = chunks[c];
+          for (std::size_t i = begin; i < chunk_end; ++i)
+            record = readBinaryRecord (element, record, swap,
+                                       is_vertex ? cloud_->data.data () + i * point_step : nullptr,
+                                       is_face ? &(*polygons_)[first_polygon + i] : nullptr, is_dense);
+        }
+        dense[c] = is_dense;
+      }
+    }, has_callbacks ? 1 : threads_, std::size_t (1));
+
+    if (std::find (dense.cbegin (), dense.cend (), false) != dense.cend ())
+      cloud_->is_dense = false;
+    if (is_vertex)
+      vertex_count_ = element.count;
+  }
+  if (data != end)
+    warningCallback (file_name, 0, "ignoring extra data at the end of binary stream");
+  return (true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PLYReader::readASCIIData (const std::string& file_name, const char* data, const char* end, std::size_t line_number)
+{
+  // std::strtod is faster than a stream, but only parses the numbers of the classic locale if the decimal point of
+  // the C locale is a dot
+  const bool classic_decimal_point = (std::strcmp (std::localeconv ()->decimal_point, ".") == 0);
+  for (const auto &element : layout_)
+  {
+    // Find the beginning of the chunks of lines, checking that the file holds all of them
+    std::vector<const char*> chunks;
+    for (std::size_t i = 0; i < element.count; ++i)
+    {
+      if (i % records_per_chunk == 0)
+        chunks.push_back (data);
+      if (data == end)
+      {
+        errorCallback (file_name, line_number + i + 1, "parse error: found less elements than declared in the header");
+        return (false);
+      }
+      const char* line_end = static_cast<const char*> (memchr (data, '\n', end - data));
+      data = line_end ? line_end + 1 : end;
+    }
+    chunks.push_back (data);
+
+    // Parse the chunks, keeping the first invalid line of each
+    const bool is_vertex = (element.name == "vertex");
+    const bool is_face = (element.name == "face") && polygons_;
+    const std::size_t first_polygon = is_face ? polygons_->size () : 0;
+    if (is_face)
+      polygons_->resize (first_polygon + element.count);
+    const bool has_callbacks = std::any_of (element.properties.cbegin (), element.properties.cend (),
+                                            [] (const PropertyLayout &property) { return (property.action == PropertyLayout::INVOKE); });
+    const std::size_t point_step = cloud_->point_step;
+    std::vector<char> dense (chunks.size () - 1, true);
+    std::vector<std::size_t> invalid (chunks.size () - 1, element.count);
+    pcl::parallel::parallel_for (std::size_t (0), chunks.size () - 1, [&] (std::size_t first, std::size_t last)
+    {
+      for (std::size_t c = first; c < last; ++c)
+      {
+        const std::size_t begin = c * records_per_chunk;
+        const std::size_t chunk_end = std::min (begin + records_per_chunk, element.count);
+        const char* line = chunks[c];
+        bool is_dense = true;
+        std::istringstream stream;
+        stream.imbue (std::locale::classic ());
+        for (std::size_t i = begin; i < chunk_end; ++i)
+        {
+          const char* line_end = static_cast<const char*> (memchr (line, '\n', chunks[c + 1] - line));
+          if (!line_end)
+            line_end = chunks[c + 1];
+          if (!readASCIIRecord (element, line, line_end, classic_decimal_point ? nullptr : &stream,
+                                is_vertex ? cloud_->data.data () + i * point_step : nullptr,
+                                is_face ? &(*polygons_)[first_polygon + i] : nullptr, is_dense))
+          {
+            invalid[c] = i;
+            break;
+          }
+          line = line_end + 1;
+        }
+        dense[c] = is_dense;
+      }
+    }, has_callbacks ? 1 : threads_, std::size_t (1));
+
+    const std::size_t first_invalid = invalid.empty () ? element.count : *std::min_element (invalid.cbegin (), invalid.cend ());
+    if (first_invalid < element.count)
+    {
+      errorCallback (file_name, line_number + first_invalid + 1, "parse error: element does not match its declaration in the header");
+      return (false);
+    }
+    if (std::find (dense.cbegin (), dense.cend (), false) != dense.cend ())
+      cloud_->is_dense = false;
+    if (is_vertex)
+      vertex_count_ = element.count;
+    line_number += element.count;
+  }
+  while (data != end && std::isspace (static_cast<unsigned char> (*data)))
+    ++data;
+  if (data != end)
+    warningCallback (file_name, line_number, "ignoring extra data at the end of ascii stream");
+  return (true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PLYReader::readData (const std::string& file_name)
+{
+  const int fd = io::raw_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::PLYReader::read] Failure to open file %s\n", file_name.c_str ());
+    return (false);
+  }
+  const std::size_t file_size = io::raw_lseek (fd, 0, SEEK_END);
+  io::raw_lseek (fd, 0, SEEK_SET);
+
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  const char *map = static_cast<const char*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+  if (map == NULL)
+  {
+    CloseHandle (fm);
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PLYReader::read] Error mapping view of file, %s\n", file_name.c_str ());
+    return (false);
+  }
+#else
+  const char *map = static_cast<const char*> (::mmap (nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0));
+  if (map == reinterpret_cast<const char*> (-1))    // MAP_FAILED
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PLYReader::read] Error preparing mmap for PLY file %s\n", file_name.c_str ());
+    return (false);
+  }
+#endif
+
+  // Find the end of the header, splitting the lines as the parser does
+  const char* end = map + file_size;
+  const std::size_t crlf = (file_size > 3 && map[3] == '\r') ? 1 : 0;
+  const char line_delim = crlf ? '\r' : '\n';
+  const char* data = nullptr;
+  std::size_t line_number = 1;
+  for (const char* line = map + std::min<std::size_t> (file_size, 4 + crlf); !data && line < end; )
+  {
+    const char* line_end = static_cast<const char*> (memchr (line, line_delim, end - line));
+    if (!line_end)
+      line_end = end;
+    ++line_number;
+    const char* keyword = line;
+    while (keyword != line_end && std::isspace (static_cast<unsigned char> (*keyword)))
+      ++keyword;
+    if (line_end - keyword >= 10 && !strncmp (keyword, "end_header", 10) &&
+        (keyword + 10 == line_end || std::isspace (static_cast<unsigned char> (keyword[10]))))
+      data = std::min (line_end + 1 + crlf, end);
+    line = std::min (line_end + 1 + crlf, end);
+  }
+
+  bool result = false;
+  if (!data)
+    PCL_ERROR ("[pcl::PLYReader::read] Could not find the end of the header of %s\n", file_name.c_str ());
+  else if (format_ == pcl::io::ply::ascii_format)
+    result = readASCIIData (file_name, data, end, line_number);
+  else
+    result = readBinaryData (file_name, reinterpret_cast<const unsigned char*> (data), reinterpret_cast<const unsigned char*> (end));
+
+#ifdef _WIN32
+  UnmapViewOfFile (map);
+  CloseHandle (fm);
+#else
+  ::munmap (const_cast<char*> (map), file_size);
+#endif
+  io::raw_close (fd);
+  return (result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -118,7 +118,7 @@ namespace pcl
       setSearchSurface (const PointCloudInConstPtr &cloud) { surface_ = cloud; normals_->clear (); intensity_gradients_->clear ();}
 
       /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        * \param nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
         */
       inline void
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
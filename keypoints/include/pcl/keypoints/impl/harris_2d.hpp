@@ -41,6 +41,7 @@
 #ifndef PCL_HARRIS_KEYPOINT_2D_IMPL_H_
 #define PCL_HARRIS_KEYPOINT_2D_IMPL_H_
 
+#include <pcl/common/parallel.h>
 #include <pcl/common/point_tests.h>
 
 namespace pcl
@@ -256,19 +257,7 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointCloudOu
     int height (response_->height);
     const int occupency_map_size (occupency_map.size ());
 
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for                                       \
-  default(none)                                                \
-  shared(occupency_map, output)                                \
-  firstprivate(width, height)                                  \
-  num_threads(threads_)
-#else
-#pragma omp parallel for                                       \
-  default(none)                                                \
-  shared(occupency_map, occupency_map_size, output, threshold) \
-  firstprivate(width, height)                                  \
-  num_threads(threads_)	
-#endif
+    // Greedy suppression in the order of decreasing response, which is sequential by nature
     for (int i = 0; i < occupency_map_size; ++i)
     {
       int idx = indices_->at (i);
@@ -276,11 +265,8 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointCloudOu
       if (occupency_map[idx] || point_out.intensity < threshold || !isXYZFinite (point_out))
         continue;
 
-#pragma omp critical
-      {
-        output.push_back (point_out);
-        keypoints_indices_->indices.push_back (idx);
-      }
+      output.push_back (point_out);
+      keypoints_indices_->indices.push_back (idx);
 
       int u_end = std::min (width, idx % width + min_distance_);
       int v_end = std::min (height, idx / width + min_distance_);
@@ -304,43 +290,33 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointCloudOu
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseHarris (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
   const int output_size (output.size ());
 
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output)              \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#else
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output, output_size) \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#endif
-  for (int index = 0; index < output_size; ++index)
+  pcl::parallel::parallel_for (0, output_size, [&] (int first, int last)
   {
-    PointOutT& out_point = output.points [index];
-    const PointInT &in_point = (*input_).points [index];
-    out_point.intensity = 0;
-    out_point.x = in_point.x;
-    out_point.y = in_point.y;
-    out_point.z = in_point.z;
-    if (isXYZFinite (in_point))
+    PCL_ALIGN (16) float covar [3];
+    for (int index = first; index < last; ++index)
     {
-      computeSecondMomentMatrix (index, covar);
-      float trace = covar [0] + covar [2];
-      if (trace != 0.f)
+      PointOutT& out_point = output.points [index];
+      const PointInT &in_point = (*input_).points [index];
+      out_point.intensity = 0;
+      out_point.x = in_point.x;
+      out_point.y = in_point.y;
+      out_point.z = in_point.z;
+      if (isXYZFinite (in_point))
       {
-        float det = covar[0] * covar[2] - covar[1] * covar[1];
-        out_point.intensity = 0.04f + det - 0.04f * trace * trace;
+        computeSecondMomentMatrix (index, covar);
+        float trace = covar [0] + covar [2];
+        if (trace != 0.f)
+        {
+          float det = covar[0] * covar[2] - covar[1] * covar[1];
+          out_point.intensity = 0.04f + det - 0.04f * trace * trace;
+        }
       }
     }
-  }
+  }, threads_);
 
   output.height = input_->height;
   output.width = input_->width;
@@ -350,43 +326,33 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseHarris (PointCloudOut
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseNoble (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
   const int output_size (output.size ());
 
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output)              \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#else
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output, output_size) \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#endif
-  for (int index = 0; index < output_size; ++index)
+  pcl::parallel::parallel_for (0, output_size, [&] (int first, int last)
   {
-    PointOutT &out_point = output.points [index];
-    const PointInT &in_point = input_->points [index];
-    out_point.x = in_point.x;
-    out_point.y = in_point.y;
-    out_point.z = in_point.z;
-    out_point.intensity = 0;
-    if (isXYZFinite (in_point))
+    PCL_ALIGN (16) float covar [3];
+    for (int index = first; index < last; ++index)
     {
-      computeSecondMomentMatrix (index, covar);
-      float trace = covar [0] + covar [2];
-      if (trace != 0)
+      PointOutT &out_point = output.points [index];
+      const PointInT &in_point = input_->points [index];
+      out_point.x = in_point.x;
+      out_point.y = in_point.y;
+      out_point.z = in_point.z;
+      out_point.intensity = 0;
+      if (isXYZFinite (in_point))
       {
-        float det = covar[0] * covar[2] - covar[1] * covar[1];
-        out_point.intensity = det / trace;
+        computeSecondMomentMatrix (index, covar);
+        float trace = covar [0] + covar [2];
+        if (trace != 0)
+        {
+          float det = covar[0] * covar[2] - covar[1] * covar[1];
+          out_point.intensity = det / trace;
+        }
       }
     }
-  }
+  }, threads_);
 
   output.height = input_->height;
   output.width = input_->width;
@@ -396,43 +362,33 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseNoble (PointCloudOut
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseLowe (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
   const int output_size (output.size ());
 
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output)              \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#else
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output, output_size) \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#endif
-  for (int index = 0; index < output_size; ++index)
+  pcl::parallel::parallel_for (0, output_size, [&] (int first, int last)
   {
-    PointOutT &out_point = output.points [index];
-    const PointInT &in_point = input_->points [index];
-    out_point.x = in_point.x;
-    out_point.y = in_point.y;
-    out_point.z = in_point.z;
-    out_point.intensity = 0;
-    if (isXYZFinite (in_point))
+    PCL_ALIGN (16) float covar [3];
+    for (int index = first; index < last; ++index)
     {
-      computeSecondMomentMatrix (index, covar);
-      float trace = covar [0] + covar [2];
-      if (trace != 0)
+      PointOutT &out_point = output.points [index];
+      const PointInT &in_point = input_->points [index];
+      out_point.x = in_point.x;
+      out_point.y = in_point.y;
+      out_point.z = in_point.z;
+      out_point.intensity = 0;
+      if (isXYZFinite (in_point))
       {
-        float det = covar[0] * covar[2] - covar[1] * covar[1];
-        out_point.intensity = det / (trace * trace);
+        computeSecondMomentMatrix (index, covar);
+        float trace = covar [0] + covar [2];
+        if (trace != 0)
+        {
+          float det = covar[0] * covar[2] - covar[1] * covar[1];
+          out_point.intensity = det / (trace * trace);
+        }
       }
     }
-  }
+  }, threads_);
 
   output.height = input_->height;
   output.width = input_->width;
@@ -442,39 +398,29 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseLowe (PointCloudOut &
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseTomasi (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
   const int output_size (output.size ());
 
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output)              \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#else
-#pragma omp parallel for      \
-  default(none)               \
-  shared(output, output_size) \
-  firstprivate(covar)              \
-  num_threads(threads_)
-#endif
-  for (int index = 0; index < output_size; ++index)
+  pcl::parallel::parallel_for (0, output_size, [&] (int first, int last)
   {
-    PointOutT &out_point = output.points [index];
-    const PointInT &in_point = input_->points [index];
-    out_point.x = in_point.x;
-    out_point.y = in_point.y;
-    out_point.z = in_point.z;
-    out_point.intensity = 0;
-    if (isXYZFinite (in_point))
+    PCL_ALIGN (16) float covar [3];
+    for (int index = first; index < last; ++index)
     {
-      computeSecondMomentMatrix (index, covar);
-      // min egenvalue
-      out_point.intensity = ((covar[0] + covar[2] - sqrt((covar[0] - covar[2])*(covar[0] - covar[2]) + 4 * covar[1] * covar[1])) /2.0f);
+      PointOutT &out_point = output.points [index];
+      const PointInT &in_point = input_->points [index];
+      out_point.x = in_point.x;
+      out_point.y = in_point.y;
+      out_point.z = in_point.z;
+      out_point.intensity = 0;
+      if (isXYZFinite (in_point))
+      {
+        computeSecondMomentMatrix (index, covar);
+        // min egenvalue
+        out_point.intensity = ((covar[0] + covar[2] - sqrt((covar[0] - covar[2])*(covar[0] - covar[2]) + 4 * covar[1] * covar[1])) /2.0f);
+      }
     }
-  }
+  }, threads_);
 
   output.height = input_->height;
   output.width = input_->width;
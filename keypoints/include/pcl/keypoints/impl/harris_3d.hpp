@@ -46,6 +46,7 @@
 #include <pcl/features/integral_image_normal.h>
 #include <pcl/common/time.h>
 #include <pcl/common/centroid.h>
+#include <pcl/common/parallel.h>
 #ifdef __SSE__
 #include <xmmintrin.h>
 #endif
@@ -276,35 +277,39 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.points.clear ();
     output.points.reserve (response->points.size());
 
-#pragma omp parallel for \
-  default(none) \
-  shared(output, response) \
-  num_threads(threads_)
-    for (int idx = 0; idx < static_cast<int> (response->points.size ()); ++idx)
+    // Flag the local maxima in parallel, then gather them in the order of the points
+    std::vector<char> is_maximum (response->points.size (), 0);
+    pcl::parallel::parallel_for (0, static_cast<int> (response->points.size ()), [&] (int first, int last)
     {
-      if (!isFinite (response->points[idx]) ||
-          !std::isfinite (response->points[idx].intensity) ||
-          response->points[idx].intensity < threshold_)
-        continue;
-
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
-      bool is_maxima = true;
-      for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
+      for (int idx = first; idx < last; ++idx)
       {
-        if (response->points[idx].intensity < response->points[*iIt].intensity)
+        if (!isFinite (response->points[idx]) ||
+            !std::isfinite (response->points[idx].intensity) ||
+            response->points[idx].intensity < threshold_)
+          continue;
+
+        tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
+        bool is_maxima = true;
+        for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
         {
-          is_maxima = false;
-          break;
+          if (response->points[idx].intensity < response->points[*iIt].intensity)
+          {
+            is_maxima = false;
+            break;
+          }
         }
+        is_maximum[idx] = is_maxima;
       }
-      if (is_maxima)
-#pragma omp critical
-      {
-        output.points.push_back (response->points[idx]);
-        keypoints_indices_->indices.push_back (idx);
-      }
+    }, threads_);
+
+    for (int idx = 0; idx < static_cast<int> (response->points.size ()); ++idx)
+    {
+      if (!is_maximum[idx])
+        continue;
+      output.points.push_back (response->points[idx]);
+      keypoints_indices_->indices.push_back (idx);
     }
 
     if (refine_)
@@ -320,39 +325,37 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(covar) \
-  num_threads(threads_)
-  for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
+  pcl::parallel::parallel_for (0, static_cast<int> (input_->size ()), [&] (int first, int last)
   {
-    const PointInT& pointIn = input_->points [pIdx];
-    output [pIdx].intensity = 0.0; //std::numeric_limits<float>::quiet_NaN ();
-    if (isFinite (pointIn))
+    PCL_ALIGN (16) float covar [8];
+    for (int pIdx = first; pIdx < last; ++pIdx)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
-
-      float trace = covar [0] + covar [5] + covar [7];
-      if (trace != 0)
+      const PointInT& pointIn = input_->points [pIdx];
+      output [pIdx].intensity = 0.0; //std::numeric_limits<float>::quiet_NaN ();
+      if (isFinite (pointIn))
       {
-        float det = covar [0] * covar [5] * covar [7] + 2.0f * covar [1] * covar [2] * covar [6]
-                  - covar [2] * covar [2] * covar [5]
-                  - covar [1] * covar [1] * covar [7]
-                  - covar [6] * covar [6] * covar [0];
+        std::vector<int> nn_indices;
+        std::vector<float> nn_dists;
+        tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+        calculateNormalCovar (nn_indices, covar);
 
-        output [pIdx].intensity = 0.04f + det - 0.04f * trace * trace;
+        float trace = covar [0] + covar [5] + covar [7];
+        if (trace != 0)
+        {
+          float det = covar [0] * covar [5] * covar [7] + 2.0f * covar [1] * covar [2] * covar [6]
+                    - covar [2] * covar [2] * covar [5]
+                    - covar [1] * covar [1] * covar [7]
+                    - covar [6] * covar [6] * covar [0];
+
+          output [pIdx].intensity = 0.04f + det - 0.04f * trace * trace;
+        }
       }
+      output [pIdx].x = pointIn.x;
+      output [pIdx].y = pointIn.y;
+      output [pIdx].z = pointIn.z;
     }
-    output [pIdx].x = pointIn.x;
-    output [pIdx].y = pointIn.y;
-    output [pIdx].z = pointIn.z;
-  }
+  }, threads_);
   output.height = input_->height;
   output.width = input_->width;
 }
@@ -361,38 +364,36 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudO
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
-#pragma omp parallel \
-  for default(none) \
-  shared(output) \
-  firstprivate(covar) \
-  num_threads(threads_)
-  for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
+  pcl::parallel::parallel_for (0, static_cast<int> (input_->size ()), [&] (int first, int last)
   {
-    const PointInT& pointIn = input_->points [pIdx];
-    output [pIdx].intensity = 0.0;
-    if (isFinite (pointIn))
+    PCL_ALIGN (16) float covar [8];
+    for (int pIdx = first; pIdx < last; ++pIdx)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
-      float trace = covar [0] + covar [5] + covar [7];
-      if (trace != 0)
+      const PointInT& pointIn = input_->points [pIdx];
+      output [pIdx].intensity = 0.0;
+      if (isFinite (pointIn))
       {
-        float det = covar [0] * covar [5] * covar [7] + 2.0f * covar [1] * covar [2] * covar [6]
-                  - covar [2] * covar [2] * covar [5]
-                  - covar [1] * covar [1] * covar [7]
-                  - covar [6] * covar [6] * covar [0];
+        std::vector<int> nn_indices;
+        std::vector<float> nn_dists;
+        tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+        calculateNormalCovar (nn_indices, covar);
+        float trace = covar [0] + covar [5] + covar [7];
+        if (trace != 0)
+        {
+          float det = covar [0] * covar [5] * covar [7] + 2.0f * covar [1] * covar [2] * covar [6]
+                    - covar [2] * covar [2] * covar [5]
+                    - covar [1] * covar [1] * covar [7]
+                    - covar [6] * covar [6] * covar [0];
 
-        output [pIdx].intensity = det / trace;
+          output [pIdx].intensity = det / trace;
+        }
       }
+      output [pIdx].x = pointIn.x;
+      output [pIdx].y = pointIn.y;
+      output [pIdx].z = pointIn.z;
     }
-    output [pIdx].x = pointIn.x;
-    output [pIdx].y = pointIn.y;
-    output [pIdx].z = pointIn.z;
-  }
+  }, threads_);
   output.height = input_->height;
   output.width = input_->width;
 }
@@ -401,38 +402,36 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOu
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseLowe (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(covar) \
-  num_threads(threads_)
-  for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
+  pcl::parallel::parallel_for (0, static_cast<int> (input_->size ()), [&] (int first, int last)
   {
-    const PointInT& pointIn = input_->points [pIdx];
-    output [pIdx].intensity = 0.0;
-    if (isFinite (pointIn))
+    PCL_ALIGN (16) float covar [8];
+    for (int pIdx = first; pIdx < last; ++pIdx)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
-      float trace = covar [0] + covar [5] + covar [7];
-      if (trace != 0)
+      const PointInT& pointIn = input_->points [pIdx];
+      output [pIdx].intensity = 0.0;
+      if (isFinite (pointIn))
       {
-        float det = covar [0] * covar [5] * covar [7] + 2.0f * covar [1] * covar [2] * covar [6]
-                  - covar [2] * covar [2] * covar [5]
-                  - covar [1] * covar [1] * covar [7]
-                  - covar [6] * covar [6] * covar [0];
+        std::vector<int> nn_indices;
+        std::vector<float> nn_dists;
+        tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+        calculateNormalCovar (nn_indices, covar);
+        float trace = covar [0] + covar [5] + covar [7];
+        if (trace != 0)
+        {
+          float det = covar [0] * covar [5] * covar [7] + 2.0f * covar [1] * covar [2] * covar [6]
+                    - covar [2] * covar [2] * covar [5]
+                    - covar [1] * covar [1] * covar [7]
+                    - covar [6] * covar [6] * covar [0];
 
-        output [pIdx].intensity = det / (trace * trace);
+          output [pIdx].intensity = det / (trace * trace);
+        }
       }
+      output [pIdx].x = pointIn.x;
+      output [pIdx].y = pointIn.y;
+      output [pIdx].z = pointIn.z;
     }
-    output [pIdx].x = pointIn.x;
-    output [pIdx].y = pointIn.y;
-    output [pIdx].z = pointIn.z;
-  }
+  }, threads_);
   output.height = input_->height;
   output.width = input_->width;
 }
@@ -459,43 +458,41 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseCurvature (PointClo
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudOut &output) const
 {
-  PCL_ALIGN (16) float covar [8];
-  Eigen::Matrix3f covariance_matrix;
   output.resize (input_->size ());
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(covar, covariance_matrix) \
-  num_threads(threads_)
-  for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
+  pcl::parallel::parallel_for (0, static_cast<int> (input_->size ()), [&] (int first, int last)
   {
-    const PointInT& pointIn = input_->points [pIdx];
-    output [pIdx].intensity = 0.0;
-    if (isFinite (pointIn))
+    PCL_ALIGN (16) float covar [8];
+    Eigen::Matrix3f covariance_matrix;
+    for (int pIdx = first; pIdx < last; ++pIdx)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateNormalCovar (nn_indices, covar);
-      float trace = covar [0] + covar [5] + covar [7];
-      if (trace != 0)
+      const PointInT& pointIn = input_->points [pIdx];
+      output [pIdx].intensity = 0.0;
+      if (isFinite (pointIn))
       {
-        covariance_matrix.coeffRef (0) = covar [0];
-        covariance_matrix.coeffRef (1) = covariance_matrix.coeffRef (3) = covar [1];
-        covariance_matrix.coeffRef (2) = covariance_matrix.coeffRef (6) = covar [2];
-        covariance_matrix.coeffRef (4) = covar [5];
-        covariance_matrix.coeffRef (5) = covariance_matrix.coeffRef (7) = covar [6];
-        covariance_matrix.coeffRef (8) = covar [7];
-
-        EIGEN_ALIGN16 Eigen::Vector3f eigen_values;
-        pcl::eigen33(covariance_matrix, eigen_values);
-        output [pIdx].intensity = eigen_values[0];
+        std::vector<int> nn_indices;
+        std::vector<float> nn_dists;
+        tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+        calculateNormalCovar (nn_indices, covar);
+        float trace = covar [0] + covar [5] + covar [7];
+        if (trace != 0)
+        {
+          covariance_matrix.coeffRef (0) = covar [0];
+          covariance_matrix.coeffRef (1) = covariance_matrix.coeffRef (3) = covar [1];
+          covariance_matrix.coeffRef (2) = covariance_matrix.coeffRef (6) = covar [2];
+          covariance_matrix.coeffRef (4) = covar [5];
+          covariance_matrix.coeffRef (5) = covariance_matrix.coeffRef (7) = covar [6];
+          covariance_matrix.coeffRef (8) = covar [7];
+
+          EIGEN_ALIGN16 Eigen::Vector3f eigen_values;
+          pcl::eigen33(covariance_matrix, eigen_values);
+          output [pIdx].intensity = eigen_values[0];
+        }
       }
+      output [pIdx].x = pointIn.x;
+      output [pIdx].y = pointIn.y;
+      output [pIdx].z = pointIn.z;
     }
-    output [pIdx].x = pointIn.x;
-    output [pIdx].y = pointIn.y;
-    output [pIdx].z = pointIn.z;
-  }
+  }, threads_);
   output.height = input_->height;
   output.width = input_->width;
 }
@@ -504,45 +501,43 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::refineCorners (PointCloudOut &corners) const
 {
-  Eigen::Matrix3f nnT;
-  Eigen::Matrix3f NNT;
-  Eigen::Matrix3f NNTInv;
-  Eigen::Vector3f NNTp;
-  float diff;
   const unsigned max_iterations = 10;
-#pragma omp parallel for \
-  default(none) \
-  shared(corners) \
-  firstprivate(nnT, NNT, NNTInv, NNTp, diff) \
-  num_threads(threads_)
-  for (int cIdx = 0; cIdx < static_cast<int> (corners.size ()); ++cIdx)
+  pcl::parallel::parallel_for (0, static_cast<int> (corners.size ()), [&] (int first, int last)
   {
-    unsigned iterations = 0;
-    do {
-      NNT.setZero();
-      NNTp.setZero();
-      PointInT corner;
-      corner.x = corners[cIdx].x;
-      corner.y = corners[cIdx].y;
-      corner.z = corners[cIdx].z;
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->radiusSearch (corner, search_radius_, nn_indices, nn_dists);
-      for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
-      {
-        if (!std::isfinite (normals_->points[*iIt].normal_x))
-          continue;
+    Eigen::Matrix3f nnT;
+    Eigen::Matrix3f NNT;
+    Eigen::Matrix3f NNTInv;
+    Eigen::Vector3f NNTp;
+    float diff;
+    for (int cIdx = first; cIdx < last; ++cIdx)
+    {
+      unsigned iterations = 0;
+      do {
+        NNT.setZero();
+        NNTp.setZero();
+        PointInT corner;
+        corner.x = corners[cIdx].x;
+        corner.y = corners[cIdx].y;
+        corner.z = corners[cIdx].z;
+        std::vector<int> nn_indices;
+        std::vector<float> nn_dists;
+        tree_->radiusSearch (corner, search_radius_, nn_indices, nn_dists);
+        for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
+        {
+          if (!std::isfinite (normals_->points[*iIt].normal_x))
+            continue;
 
-        nnT = normals_->points[*iIt].getNormalVector3fMap () * normals_->points[*iIt].getNormalVector3fMap ().transpose();
-        NNT += nnT;
-        NNTp += nnT * surface_->points[*iIt].getVector3fMap ();
-      }
-      if (invert3x3SymMatrix (NNT, NNTInv) != 0)
-        corners[cIdx].getVector3fMap () = NNTInv * NNTp;
+          nnT = normals_->points[*iIt].getNormalVector3fMap () * normals_->points[*iIt].getNormalVector3fMap ().transpose();
+          NNT += nnT;
+          NNTp += nnT * surface_->points[*iIt].getVector3fMap ();
+        }
+        if (invert3x3SymMatrix (NNT, NNTInv) != 0)
+          corners[cIdx].getVector3fMap () = NNTInv * NNTp;
 
-      diff = (corners[cIdx].getVector3fMap () - corner.getVector3fMap()).squaredNorm ();
-    } while (diff > 1e-6 && ++iterations < max_iterations);
-  }
+        diff = (corners[cIdx].getVector3fMap () - corner.getVector3fMap()).squaredNorm ();
+      } while (diff > 1e-6 && ++iterations < max_iterations);
+    }
+  }, threads_);
 }
 
 #define PCL_INSTANTIATE_HarrisKeypoint3D(T,U,N) template class PCL_EXPORTS pcl::HarrisKeypoint3D<T,U,N>;
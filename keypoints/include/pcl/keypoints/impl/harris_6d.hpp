@@ -46,6 +46,7 @@
 //#include <pcl/features/fast_intensity_gradient.h>
 #include <pcl/features/intensity_gradient.h>
 #include <pcl/features/integral_image_normal.h>
+#include <pcl/common/parallel.h>
 
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::setThreshold (float threshold)
@@ -164,18 +165,18 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
   pcl::PointCloud<pcl::PointXYZI>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZI>);
   cloud->resize (surface_->size ());
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-  for (unsigned idx = 0; idx < surface_->size (); ++idx)
+  pcl::parallel::parallel_for (std::size_t (0), surface_->size (), [&] (std::size_t first, std::size_t last)
   {
-    cloud->points [idx].x = surface_->points [idx].x;
-    cloud->points [idx].y = surface_->points [idx].y;
-    cloud->points [idx].z = surface_->points [idx].z;
-    //grayscale = 0.2989 * R + 0.5870 * G + 0.1140 * B
+    for (std::size_t idx = first; idx < last; ++idx)
+    {
+      cloud->points [idx].x = surface_->points [idx].x;
+      cloud->points [idx].y = surface_->points [idx].y;
+      cloud->points [idx].z = surface_->points [idx].z;
+      //grayscale = 0.2989 * R + 0.5870 * G + 0.1140 * B
 
-    cloud->points [idx].intensity = 0.00390625 * (0.114 * float(surface_->points [idx].b) + 0.5870 * float(surface_->points [idx].g) + 0.2989 * float(surface_->points [idx].r));
-  }
+      cloud->points [idx].intensity = 0.00390625 * (0.114 * float(surface_->points [idx].b) + 0.5870 * float(surface_->points [idx].g) + 0.2989 * float(surface_->points [idx].r));
+    }
+  }, threads_);
   pcl::copyPointCloud (*surface_, *cloud);
 
   IntensityGradientEstimation<PointXYZI, NormalT, IntensityGradient> grad_est;
@@ -184,30 +185,30 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
   grad_est.setRadiusSearch (search_radius_);
   grad_est.compute (*intensity_gradients_);
   
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-  for (std::size_t idx = 0; idx < intensity_gradients_->size (); ++idx)
+  pcl::parallel::parallel_for (std::size_t (0), intensity_gradients_->size (), [&] (std::size_t first, std::size_t last)
   {
-    float len = intensity_gradients_->points [idx].gradient_x * intensity_gradients_->points [idx].gradient_x +
-                intensity_gradients_->points [idx].gradient_y * intensity_gradients_->points [idx].gradient_y +
-                intensity_gradients_->points [idx].gradient_z * intensity_gradients_->points [idx].gradient_z ;
-
-    // Suat: ToDo: remove this magic number or expose using set/get
-    if (len > 200.0)
+    for (std::size_t idx = first; idx < last; ++idx)
     {
-      len = 1.0 / sqrt (len);
-      intensity_gradients_->points [idx].gradient_x *= len;
-      intensity_gradients_->points [idx].gradient_y *= len;
-      intensity_gradients_->points [idx].gradient_z *= len;
-    }
-    else
-    {
-      intensity_gradients_->points [idx].gradient_x = 0;
-      intensity_gradients_->points [idx].gradient_y = 0;
-      intensity_gradients_->points [idx].gradient_z = 0;
+      float len = intensity_gradients_->points [idx].gradient_x * intensity_gradients_->points [idx].gradient_x +
+                  intensity_gradients_->points [idx].gradient_y * intensity_gradients_->points [idx].gradient_y +
+                  intensity_gradients_->points [idx].gradient_z * intensity_gradients_->points [idx].gradient_z ;
+
+      // Suat: ToDo: remove this magic number or expose using set/get
+      if (len > 200.0)
+      {
+        len = 1.0 / sqrt (len);
+        intensity_gradients_->points [idx].gradient_x *= len;
+        intensity_gradients_->points [idx].gradient_y *= len;
+        intensity_gradients_->points [idx].gradient_z *= len;
+      }
+      else
+      {
+        intensity_gradients_->points [idx].gradient_x = 0;
+        intensity_gradients_->points [idx].gradient_y = 0;
+        intensity_gradients_->points [idx].gradient_z = 0;
+      }
     }
-  }
+  }, threads_);
 
   typename pcl::PointCloud<PointOutT>::Ptr response (new pcl::PointCloud<PointOutT>);
   response->points.reserve (input_->points.size());
@@ -227,32 +228,37 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.points.clear ();
     output.points.reserve (response->points.size());
 
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-    for (std::size_t idx = 0; idx < response->points.size (); ++idx)
+    // Flag the local maxima in parallel, then gather them in the order of the points
+    std::vector<char> is_maximum (response->points.size (), 0);
+    pcl::parallel::parallel_for (std::size_t (0), response->points.size (), [&] (std::size_t first, std::size_t last)
     {
-      if (!isFinite (response->points[idx]) || response->points[idx].intensity < threshold_)
-        continue;
-
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
-      bool is_maxima = true;
-      for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
+      for (std::size_t idx = first; idx < last; ++idx)
       {
-        if (response->points[idx].intensity < response->points[*iIt].intensity)
+        if (!isFinite (response->points[idx]) || response->points[idx].intensity < threshold_)
+          continue;
+
+        tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
+        bool is_maxima = true;
+        for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
         {
-          is_maxima = false;
-          break;
+          if (response->points[idx].intensity < response->points[*iIt].intensity)
+          {
+            is_maxima = false;
+            break;
+          }
         }
+        is_maximum[idx] = is_maxima;
       }
-      if (is_maxima)
-        #pragma omp critical
-      {
-        output.points.push_back (response->points[idx]);
-        keypoints_indices_->indices.push_back (idx);
-      }
+    }, threads_);
+
+    for (std::size_t idx = 0; idx < response->points.size (); ++idx)
+    {
+      if (!is_maximum[idx])
+        continue;
+      output.points.push_back (response->points[idx]);
+      keypoints_indices_->indices.push_back (idx);
     }
 
     if (refine_)
@@ -267,89 +273,86 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudOut &output) const
 {
-  // get the 6x6 covar-mat
-  PointOutT pointOut;
-  PCL_ALIGN (16) float covar [21];
-  Eigen::SelfAdjointEigenSolver <Eigen::Matrix<float, 6, 6> > solver;
-  Eigen::Matrix<float, 6, 6> covariance;
-
-#pragma omp parallel for \
-  default(none) \
-  firstprivate(pointOut, covar, covariance, solver) \
-  num_threads(threads_)
-  for (unsigned pIdx = 0; pIdx < input_->size (); ++pIdx)
+  // The response of each point is written at its index, so that the output is organized as the input
+  output.resize (input_->size ());
+  pcl::parallel::parallel_for (std::size_t (0), input_->size (), [&] (std::size_t first, std::size_t last)
   {
-    const PointInT& pointIn = input_->points [pIdx];
-    pointOut.intensity = 0.0; //std::numeric_limits<float>::quiet_NaN ();
-    if (isFinite (pointIn))
+    // get the 6x6 covar-mat
+    PCL_ALIGN (16) float covar [21];
+    Eigen::SelfAdjointEigenSolver <Eigen::Matrix<float, 6, 6> > solver;
+    Eigen::Matrix<float, 6, 6> covariance;
+    for (std::size_t pIdx = first; pIdx < last; ++pIdx)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
-      calculateCombinedCovar (nn_indices, covar);
-
-      float trace = covar [0] + covar [6] + covar [11] + covar [15] + covar [18] + covar [20];
-      if (trace != 0)
+      const PointInT& pointIn = input_->points [pIdx];
+      PointOutT &pointOut = output.points [pIdx];
+      pointOut.intensity = 0.0; //std::numeric_limits<float>::quiet_NaN ();
+      if (isFinite (pointIn))
       {
-        covariance.coeffRef ( 0) = covar [ 0];
-        covariance.coeffRef ( 1) = covar [ 1];
-        covariance.coeffRef ( 2) = covar [ 2];
-        covariance.coeffRef ( 3) = covar [ 3];
-        covariance.coeffRef ( 4) = covar [ 4];
-        covariance.coeffRef ( 5) = covar [ 5];
-
-        covariance.coeffRef ( 7) = covar [ 6];
-        covariance.coeffRef ( 8) = covar [ 7];
-        covariance.coeffRef ( 9) = covar [ 8];
-        covariance.coeffRef (10) = covar [ 9];
-        covariance.coeffRef (11) = covar [10];
-
-        covariance.coeffRef (14) = covar [11];
-        covariance.coeffRef (15) = covar [12];
-        covariance.coeffRef (16) = covar [13];
-        covariance.coeffRef (17) = covar [14];
-
-        covariance.coeffRef (21) = covar [15];
-        covariance.coeffRef (22) = covar [16];
-        covariance.coeffRef (23) = covar [17];
-
-        covariance.coeffRef (28) = covar [18];
-        covariance.coeffRef (29) = covar [19];
-
-        covariance.coeffRef (35) = covar [20];
-
-        covariance.coeffRef ( 6) = covar [ 1];
-
-        covariance.coeffRef (12) = covar [ 2];
-        covariance.coeffRef (13) = covar [ 7];
-
-        covariance.coeffRef (18) = covar [ 3];
-        covariance.coeffRef (19) = covar [ 8];
-        covariance.coeffRef (20) = covar [12];
-
-        covariance.coeffRef (24) = covar [ 4];
-        covariance.coeffRef (25) = covar [ 9];
-        covariance.coeffRef (26) = covar [13];
-        covariance.coeffRef (27) = covar [16];
-
-        covariance.coeffRef (30) = covar [ 5];
-        covariance.coeffRef (31) = covar [10];
-        covariance.coeffRef (32) = covar [14];
-        covariance.coeffRef (33) = covar [17];
-        covariance.coeffRef (34) = covar [19];
-
-        solver.compute (covariance);
-        pointOut.intensity = solver.eigenvalues () [3];
-      }
-    }
+        std::vector<int> nn_indices;
+        std::vector<float> nn_dists;
+        tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+        calculateCombinedCovar (nn_indices, covar);
 
-    pointOut.x = pointIn.x;
-    pointOut.y = pointIn.y;
-    pointOut.z = pointIn.z;
+        float trace = covar [0] + covar [6] + covar [11] + covar [15] + covar [18] + covar [20];
+        if (trace != 0)
+        {
+          covariance.coeffRef ( 0) = covar [ 0];
+          covariance.coeffRef ( 1) = covar [ 1];
+          covariance.coeffRef ( 2) = covar [ 2];
+          covariance.coeffRef ( 3) = covar [ 3];
+          covariance.coeffRef ( 4) = covar [ 4];
+          covariance.coeffRef ( 5) = covar [ 5];
+
+          covariance.coeffRef ( 7) = covar [ 6];
+          covariance.coeffRef ( 8) = covar [ 7];
+          covariance.coeffRef ( 9) = covar [ 8];
+          covariance.coeffRef (10) = covar [ 9];
+          covariance.coeffRef (11) = covar [10];
+
+          covariance.coeffRef (14) = covar [11];
+          covariance.coeffRef (15) = covar [12];
+          covariance.coeffRef (16) = covar [13];
+          covariance.coeffRef (17) = covar [14];
+
+          covariance.coeffRef (21) = covar [15];
+          covariance.coeffRef (22) = covar [16];
+          covariance.coeffRef (23) = covar [17];
+
+          covariance.coeffRef (28) = covar [18];
+          covariance.coeffRef (29) = covar [19];
+
+          covariance.coeffRef (35) = covar [20];
+
+          covariance.coeffRef ( 6) = covar [ 1];
+
+          covariance.coeffRef (12) = covar [ 2];
+          covariance.coeffRef (13) = covar [ 7];
+
+          covariance.coeffRef (18) = covar [ 3];
+          covariance.coeffRef (19) = covar [ 8];
+          covariance.coeffRef (20) = covar [12];
+
+          covariance.coeffRef (24) = covar [ 4];
+          covariance.coeffRef (25) = covar [ 9];
+          covariance.coeffRef (26) = covar [13];
+          covariance.coeffRef (27) = covar [16];
+
+          covariance.coeffRef (30) = covar [ 5];
+          covariance.coeffRef (31) = covar [10];
+          covariance.coeffRef (32) = covar [14];
+          covariance.coeffRef (33) = covar [17];
+          covariance.coeffRef (34) = covar [19];
+
+          solver.compute (covariance);
+          pointOut.intensity = solver.eigenvalues () [3];
+        }
+      }
 
-    #pragma omp critical
-    output.points.push_back(pointOut);
-  }
+      pointOut.x = pointIn.x;
+      pointOut.y = pointIn.y;
+      pointOut.z = pointIn.z;
+    }
+  }, threads_);
   output.height = input_->height;
   output.width = input_->width;
 }
@@ -38,6 +38,9 @@
 #ifndef PCL_ISS_KEYPOINT3D_IMPL_H_
 #define PCL_ISS_KEYPOINT3D_IMPL_H_
 
+#include <pcl/common/eigen.h>
+#include <pcl/common/local_surface_statistics.h>
+#include <pcl/common/parallel.h>
 #include <pcl/features/boundary.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
@@ -106,41 +109,38 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (PointCloudI
 {
   bool* edge_points = new bool [input.size ()];
 
-  Eigen::Vector4f u = Eigen::Vector4f::Zero ();
-  Eigen::Vector4f v = Eigen::Vector4f::Zero ();
-
   pcl::BoundaryEstimation<PointInT, NormalT, pcl::Boundary> boundary_estimator;
   boundary_estimator.setInputCloud (input_);
 
-#pragma omp parallel for \
-  default(none) \
-  shared(angle_threshold, boundary_estimator, border_radius, edge_points, input) \
-  firstprivate(u, v) \
-  num_threads(threads_)
-  for (int index = 0; index < int (input.points.size ()); index++)
+  pcl::parallel::parallel_for (0, static_cast<int> (input.points.size ()), [&] (int first, int last)
   {
-    edge_points[index] = false;
-    PointInT current_point = input.points[index];
-
-    if (pcl::isFinite(current_point))
+    Eigen::Vector4f u = Eigen::Vector4f::Zero ();
+    Eigen::Vector4f v = Eigen::Vector4f::Zero ();
+    for (int index = first; index < last; index++)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_distances;
-      int n_neighbors;
+      edge_points[index] = false;
+      PointInT current_point = input.points[index];
+
+      if (pcl::isFinite(current_point))
+      {
+        std::vector<int> nn_indices;
+        std::vector<float> nn_distances;
+        int n_neighbors;
 
-      this->searchForNeighbors (static_cast<int> (index), border_radius, nn_indices, nn_distances);
+        this->searchForNeighbors (static_cast<int> (index), border_radius, nn_indices, nn_distances);
 
-      n_neighbors = static_cast<int> (nn_indices.size ());
+        n_neighbors = static_cast<int> (nn_indices.size ());
 
-      if (n_neighbors >= min_neighbors_)
-      {
-	boundary_estimator.getCoordinateSystemOnPlane (normals_->points[index], u, v);
+        if (n_neighbors >= min_neighbors_)
+        {
+          boundary_estimator.getCoordinateSystemOnPlane (normals_->points[index], u, v);
 
-	if (boundary_estimator.isBoundaryPoint (input, static_cast<int> (index), nn_indices, u, v, angle_threshold))
-	  edge_points[index] = true;
+          if (boundary_estimator.isBoundaryPoint (input, static_cast<int> (index), nn_indices, u, v, angle_threshold))
+            edge_points[index] = true;
+        }
       }
     }
-  }
+  }, threads_);
 
   return (edge_points);
 }
@@ -151,48 +151,19 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getScatterMatrix (const int& c
 {
   const PointInT& current_point = (*input_).points[current_index];
 
-  double central_point[3];
-  memset(central_point, 0, sizeof(double) * 3);
-
-  central_point[0] = current_point.x;
-  central_point[1] = current_point.y;
-  central_point[2] = current_point.z;
-
   cov_m = Eigen::Matrix3d::Zero ();
 
   std::vector<int> nn_indices;
   std::vector<float> nn_distances;
-  int n_neighbors;
 
   this->searchForNeighbors (current_index, salient_radius_, nn_indices, nn_distances);
 
-  n_neighbors = static_cast<int> (nn_indices.size ());
-
-  if (n_neighbors < min_neighbors_)
+  if (static_cast<int> (nn_indices.size ()) < min_neighbors_)
     return;
 
-  double cov[9];
-  memset(cov, 0, sizeof(double) * 9);
-
-  for (int n_idx = 0; n_idx < n_neighbors; n_idx++)
-  {
-    const PointInT& n_point = (*input_).points[nn_indices[n_idx]];
-
-    double neigh_point[3];
-    memset(neigh_point, 0, sizeof(double) * 3);
-
-    neigh_point[0] = n_point.x;
-    neigh_point[1] = n_point.y;
-    neigh_point[2] = n_point.z;
-
-    for (int i = 0; i < 3; i++)
-      for (int j = 0; j < 3; j++)
-        cov[i * 3 + j] += (neigh_point[i] - central_point[i]) * (neigh_point[j] - central_point[j]);
-  }
-
-  cov_m << cov[0], cov[1], cov[2],
-	   cov[3], cov[4], cov[5],
-	   cov[6], cov[7], cov[8];
+  // The scatter matrix is taken around the current point, not around the centroid
+  Eigen::Vector3d sum;
+  computeScatterMatrix (*input_, nn_indices, current_point.getVector3fMap ().template cast<double> (), sum, cov_m);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -299,43 +270,31 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 
   bool* borders = new bool [input_->size()];
 
-#pragma omp parallel for \
-  default(none) \
-  shared(borders) \
-  num_threads(threads_)
-  for (int index = 0; index < int (input_->size ()); index++)
+  pcl::parallel::parallel_for (0, static_cast<int> (input_->size ()), [&] (int first, int last)
   {
-    borders[index] = false;
-    PointInT current_point = input_->points[index];
-
-    if ((border_radius_ > 0.0) && (pcl::isFinite(current_point)))
+    for (int index = first; index < last; index++)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_distances;
-
-      this->searchForNeighbors (static_cast<int> (index), border_radius_, nn_indices, nn_distances);
+      borders[index] = false;
+      PointInT current_point = input_->points[index];
 
-      for (const int &nn_index : nn_indices)
+      if ((border_radius_ > 0.0) && (pcl::isFinite(current_point)))
       {
-        if (edge_points_[nn_index])
+        std::vector<int> nn_indices;
+        std::vector<float> nn_distances;
+
+        this->searchForNeighbors (static_cast<int> (index), border_radius_, nn_indices, nn_distances);
+
+        for (const int &nn_index : nn_indices)
         {
-          borders[index] = true;
-          break;
+          if (edge_points_[nn_index])
+          {
+            borders[index] = true;
+            break;
+          }
         }
       }
     }
-  }
-
-#ifdef _OPENMP
-  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[threads_];
-
-  for (std::size_t i = 0; i < threads_; i++)
-    omp_mem[i].setZero (3);
-#else
-  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[1];
-
-  omp_mem[0].setZero (3);
-#endif
+  }, threads_);
 
   double *prg_local_mem = new double[input_->size () * 3];
   double **prg_mem = new double * [input_->size ()];
@@ -343,49 +302,48 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   for (std::size_t i = 0; i < input_->size (); i++)
     prg_mem[i] = prg_local_mem + 3 * i;
 
-#pragma omp parallel for \
-  default(none) \
-  shared(borders, omp_mem, prg_mem) \
-  num_threads(threads_)
-  for (int index = 0; index < static_cast<int> (input_->size ()); index++)
+  // The ratios stay zero for the points which are skipped, so that they are never kept as keypoints
+  pcl::parallel::parallel_for (0, static_cast<int> (input_->size ()), [&] (int first, int last)
   {
-#ifdef _OPENMP
-    int tid = omp_get_thread_num ();
-#else
-    int tid = 0;
-#endif
-    PointInT current_point = input_->points[index];
-
-    if ((!borders[index]) && pcl::isFinite(current_point))
+    for (int index = first; index < last; index++)
     {
-      //if the considered point is not a border point and the point is "finite", then compute the scatter matrix
-      Eigen::Matrix3d cov_m = Eigen::Matrix3d::Zero ();
-      getScatterMatrix (static_cast<int> (index), cov_m);
+      Eigen::Vector3d point_mem = Eigen::Vector3d::Zero ();
+      PointInT current_point = input_->points[index];
 
-      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (cov_m);
+      if ((!borders[index]) && pcl::isFinite(current_point))
+      {
+        //if the considered point is not a border point and the point is "finite", then compute the scatter matrix
+        Eigen::Matrix3d cov_m = Eigen::Matrix3d::Zero ();
+        getScatterMatrix (static_cast<int> (index), cov_m);
 
-      const double& e1c = solver.eigenvalues ()[2];
-      const double& e2c = solver.eigenvalues ()[1];
-      const double& e3c = solver.eigenvalues ()[0];
+        // Closed form eigenvalues, in increasing order
+        Eigen::Vector3d eigen_values;
+        pcl::eigen33 (cov_m, eigen_values);
 
-      if (!std::isfinite (e1c) || !std::isfinite (e2c) || !std::isfinite (e3c))
-	continue;
+        const double& e1c = eigen_values[2];
+        const double& e2c = eigen_values[1];
+        const double& e3c = eigen_values[0];
 
-      if (e3c < 0)
-      {
-	PCL_WARN ("[pcl::%s::detectKeypoints] : The third eigenvalue is negative! Skipping the point with index %i.\n",
-	          name_.c_str (), index);
-	continue;
+        if (std::isfinite (e1c) && std::isfinite (e2c) && std::isfinite (e3c))
+        {
+          if (e3c < 0)
+          {
+            PCL_WARN ("[pcl::%s::detectKeypoints] : The third eigenvalue is negative! Skipping the point with index %i.\n",
+                      name_.c_str (), index);
+          }
+          else
+          {
+            point_mem[0] = e2c / e1c;
+            point_mem[1] = e3c / e2c;
+            point_mem[2] = e3c;
+          }
+        }
       }
 
-      omp_mem[tid][0] = e2c / e1c;
-      omp_mem[tid][1] = e3c / e2c;;
-      omp_mem[tid][2] = e3c;
+      for (Eigen::Index d = 0; d < point_mem.size (); d++)
+          prg_mem[index][d] = point_mem[d];
     }
-
-    for (Eigen::Index d = 0; d < omp_mem[tid].size (); d++)
-        prg_mem[index][d] = omp_mem[tid][d];
-  }
+  }, threads_);
 
   for (int index = 0; index < int (input_->size ()); index++)
   {
@@ -398,46 +356,40 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 
   bool* feat_max = new bool [input_->size()];
 
-#pragma omp parallel for \
-  default(none) \
-  shared(feat_max) \
-  num_threads(threads_)
-  for (int index = 0; index < int (input_->size ()); index++)
+  pcl::parallel::parallel_for (0, static_cast<int> (input_->size ()), [&] (int first, int last)
   {
-    feat_max [index] = false;
-    PointInT current_point = input_->points[index];
-
-    if ((third_eigen_value_[index] > 0.0) && (pcl::isFinite(current_point)))
+    for (int index = first; index < last; index++)
     {
-      std::vector<int> nn_indices;
-      std::vector<float> nn_distances;
-      int n_neighbors;
+      feat_max [index] = false;
+      PointInT current_point = input_->points[index];
+
+      if ((third_eigen_value_[index] > 0.0) && (pcl::isFinite(current_point)))
+      {
+        std::vector<int> nn_indices;
+        std::vector<float> nn_distances;
+        int n_neighbors;
 
-      this->searchForNeighbors (static_cast<int> (index), non_max_radius_, nn_indices, nn_distances);
+        this->searchForNeighbors (static_cast<int> (index), non_max_radius_, nn_indices, nn_distances);
 
-      n_neighbors = static_cast<int> (nn_indices.size ());
+        n_neighbors = static_cast<int> (nn_indices.size ());
 
-      if (n_neighbors >= min_neighbors_)
-      {
-        bool is_max = true;
+        if (n_neighbors >= min_neighbors_)
+        {
+          bool is_max = true;
 
-        for (int j = 0 ; j < n_neighbors; j++)
-          if (third_eigen_value_[index] < third_eigen_value_[nn_indices[j]])
-            is_max = false;
-        if (is_max)
-          feat_max[index] = true;
+          for (int j = 0 ; j < n_neighbors; j++)
+            if (third_eigen_value_[index] < third_eigen_value_[nn_indices[j]])
+              is_max = false;
+          if (is_max)
+            feat_max[index] = true;
+        }
       }
     }
-  }
+  }, threads_);
 
-#pragma omp parallel for \
-  default(none) \
-  shared(feat_max, output) \
-  num_threads(threads_)
   for (int index = 0; index < int (input_->size ()); index++)
   {
     if (feat_max[index])
-#pragma omp critical
     {
       PointOutT p;
       p.getVector3fMap () = input_->points[index].getVector3fMap ();
@@ -458,7 +410,6 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   delete[] prg_mem;
   delete[] prg_local_mem;
   delete[] feat_max;
-  delete[] omp_mem;
 }
 
 #define PCL_INSTANTIATE_ISSKeypoint3D(T,U,N) template class PCL_EXPORTS pcl::ISSKeypoint3D<T,U,N>;
@@ -39,6 +39,8 @@
 #ifndef PCL_TRAJKOVIC_KEYPOINT_2D_IMPL_H_
 #define PCL_TRAJKOVIC_KEYPOINT_2D_IMPL_H_
 
+#include <pcl/common/parallel.h>
+
 
 namespace pcl
 {
@@ -91,137 +93,123 @@ TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointClou
 
   if (method_ == pcl::TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::FOUR_CORNERS)
   {
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(h, w) \
-  num_threads(threads_)
-#endif
-    for(int j = half_window_size_; j < h; ++j)
+    pcl::parallel::parallel_for (half_window_size_, h, [&] (int first, int last)
     {
-      for(int i = half_window_size_; i < w; ++i)
+      for(int j = first; j < last; ++j)
       {
-        float center = intensity_ ((*input_) (i,j));
-        float up = intensity_ ((*input_) (i, j-half_window_size_));
-        float down = intensity_ ((*input_) (i, j+half_window_size_));
-        float left = intensity_ ((*input_) (i-half_window_size_, j));
-        float right = intensity_ ((*input_) (i+half_window_size_, j));
-
-        float up_center = up - center;
-        float r1 = up_center * up_center;
-        float down_center = down - center;
-        r1+= down_center * down_center;
-
-        float right_center = right - center;
-        float r2 = right_center * right_center;
-        float left_center = left - center;
-        r2+= left_center * left_center;
-
-        float d = std::min (r1, r2);
-
-        if (d < first_threshold_)
-          continue;
-
-        float b1 = (right - up) * up_center;
-        b1+= (left - down) * down_center;
-        float b2 = (right - down) * down_center;
-        b2+= (left - up) * up_center;
-        float B = std::min (b1, b2);
-        float A = r2 - r1 - 2*B;
-
-        (*response_) (i,j) = ((B < 0) && ((B + A) > 0)) ? r1 - ((B*B)/A) : d;
+        for(int i = half_window_size_; i < w; ++i)
+        {
+          float center = intensity_ ((*input_) (i,j));
+          float up = intensity_ ((*input_) (i, j-half_window_size_));
+          float down = intensity_ ((*input_) (i, j+half_window_size_));
+          float left = intensity_ ((*input_) (i-half_window_size_, j));
+          float right = intensity_ ((*input_) (i+half_window_size_, j));
+
+          float up_center = up - center;
+          float r1 = up_center * up_center;
+          float down_center = down - center;
+          r1+= down_center * down_center;
+
+          float right_center = right - center;
+          float r2 = right_center * right_center;
+          float left_center = left - center;
+          r2+= left_center * left_center;
+
+          float d = std::min (r1, r2);
+
+          if (d < first_threshold_)
+            continue;
+
+          float b1 = (right - up) * up_center;
+          b1+= (left - down) * down_center;
+          float b2 = (right - down) * down_center;
+          b2+= (left - up) * up_center;
+          float B = std::min (b1, b2);
+          float A = r2 - r1 - 2*B;
+
+          (*response_) (i,j) = ((B < 0) && ((B + A) > 0)) ? r1 - ((B*B)/A) : d;
+        }
       }
-    }
+    }, threads_);
   }
   else
   {
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(h, w) \
-  num_threads(threads_)
-#endif
-    for(int j = half_window_size_; j < h; ++j)
+    pcl::parallel::parallel_for (half_window_size_, h, [&] (int first, int last)
     {
-      for(int i = half_window_size_; i < w; ++i)
+      for(int j = first; j < last; ++j)
       {
-        float center = intensity_ ((*input_) (i,j));
-        float up = intensity_ ((*input_) (i, j-half_window_size_));
-        float down = intensity_ ((*input_) (i, j+half_window_size_));
-        float left = intensity_ ((*input_) (i-half_window_size_, j));
-        float right = intensity_ ((*input_) (i+half_window_size_, j));
-        float upleft = intensity_ ((*input_) (i-half_window_size_, j-half_window_size_));
-        float upright = intensity_ ((*input_) (i+half_window_size_, j-half_window_size_));
-        float downleft = intensity_ ((*input_) (i-half_window_size_, j+half_window_size_));
-        float downright = intensity_ ((*input_) (i+half_window_size_, j+half_window_size_));
-        std::vector<float> r (4,0);
-
-        float up_center = up - center;
-        r[0] = up_center * up_center;
-        float down_center = down - center;
-        r[0]+= down_center * down_center;
-
-        float upright_center = upright - center;
-        r[1] = upright_center * upright_center;
-        float downleft_center = downleft - center;
-        r[1]+= downleft_center * downleft_center;
-
-        float right_center = right - center;
-        r[2] = right_center * right_center;
-        float left_center = left - center;
-        r[2]+= left_center * left_center;
-
-        float downright_center = downright - center;
-        r[3] = downright_center * downright_center;
-        float upleft_center = upleft - center;
-        r[3]+= upleft_center * upleft_center;
-
-        float d = *(std::min_element (r.begin (), r.end ()));
-
-        if (d < first_threshold_)
-          continue;
-
-        std::vector<float> B (4,0);
-        std::vector<float> A (4,0);
-        std::vector<float> sumAB (4,0);
-        B[0] = (upright - up) * up_center;
-        B[0]+= (downleft - down) * down_center;
-        B[1] = (right - upright) * upright_center;
-        B[1]+= (left - downleft) * downleft_center;
-        B[2] = (downright - right) * downright_center;
-        B[2]+= (upleft - left) * upleft_center;
-        B[3] = (down - downright) * downright_center;
-        B[3]+= (up - upleft) * upleft_center;
-        A[0] = r[1] - r[0] - B[0] - B[0];
-        A[1] = r[2] - r[1] - B[1] - B[1];
-        A[2] = r[3] - r[2] - B[2] - B[2];
-        A[3] = r[0] - r[3] - B[3] - B[3];
-        sumAB[0] = A[0] + B[0];
-        sumAB[1] = A[1] + B[1];
-        sumAB[2] = A[2] + B[2];
-        sumAB[3] = A[3] + B[3];
-        if ((*std::max_element (B.begin (), B.end ()) < 0) &&
-            (*std::min_element (sumAB.begin (), sumAB.end ()) > 0))
+        for(int i = half_window_size_; i < w; ++i)
         {
-          std::vector<float> D (4,0);
-          D[0] = B[0] * B[0] / A[0];
-          D[1] = B[1] * B[1] / A[1];
-          D[2] = B[2] * B[2] / A[2];
-          D[3] = B[3] * B[3] / A[3];
-          (*response_) (i,j) = *(std::min (D.begin (), D.end ()));
+          float center = intensity_ ((*input_) (i,j));
+          float up = intensity_ ((*input_) (i, j-half_window_size_));
+          float down = intensity_ ((*input_) (i, j+half_window_size_));
+          float left = intensity_ ((*input_) (i-half_window_size_, j));
+          float right = intensity_ ((*input_) (i+half_window_size_, j));
+          float upleft = intensity_ ((*input_) (i-half_window_size_, j-half_window_size_));
+          float upright = intensity_ ((*input_) (i+half_window_size_, j-half_window_size_));
+          float downleft = intensity_ ((*input_) (i-half_window_size_, j+half_window_size_));
+          float downright = intensity_ ((*input_) (i+half_window_size_, j+half_window_size_));
+          std::vector<float> r (4,0);
+
+          float up_center = up - center;
+          r[0] = up_center * up_center;
+          float down_center = down - center;
+          r[0]+= down_center * down_center;
+
+          float upright_center = upright - center;
+          r[1] = upright_center * upright_center;
+          float downleft_center = downleft - center;
+          r[1]+= downleft_center * downleft_center;
+
+          float right_center = right - center;
+          r[2] = right_center * right_center;
+          float left_center = left - center;
+          r[2]+= left_center * left_center;
+
+          float downright_center = downright - center;
+          r[3] = downright_center * downright_center;
+          float upleft_center = upleft - center;
+          r[3]+= upleft_center * upleft_center;
+
+          float d = *(std::min_element (r.begin (), r.end ()));
+
+          if (d < first_threshold_)
+            continue;
+
+          std::vector<float> B (4,0);
+          std::vector<float> A (4,0);
+          std::vector<float> sumAB (4,0);
+          B[0] = (upright - up) * up_center;
+          B[0]+= (downleft - down) * down_center;
+          B[1] = (right - upright) * upright_center;
+          B[1]+= (left - downleft) * downleft_center;
+          B[2] = (downright - right) * downright_center;
+          B[2]+= (upleft - left) * upleft_center;
+          B[3] = (down - downright) * downright_center;
+          B[3]+= (up - upleft) * upleft_center;
+          A[0] = r[1] - r[0] - B[0] - B[0];
+          A[1] = r[2] - r[1] - B[1] - B[1];
+          A[2] = r[3] - r[2] - B[2] - B[2];
+          A[3] = r[0] - r[3] - B[3] - B[3];
+          sumAB[0] = A[0] + B[0];
+          sumAB[1] = A[1] + B[1];
+          sumAB[2] = A[2] + B[2];
+          sumAB[3] = A[3] + B[3];
+          if ((*std::max_element (B.begin (), B.end ()) < 0) &&
+              (*std::min_element (sumAB.begin (), sumAB.end ()) > 0))
+          {
+            std::vector<float> D (4,0);
+            D[0] = B[0] * B[0] / A[0];
+            D[1] = B[1] * B[1] / A[1];
+            D[2] = B[2] * B[2] / A[2];
+            D[3] = B[3] * B[3] / A[3];
+            (*response_) (i,j) = *(std::min (D.begin (), D.end ()));
+          }
+          else
+            (*response_) (i,j) = d;
         }
-        else
-          (*response_) (i,j) = d;
       }
-    }
+    }, threads_);
   }
 
   // Non maximas suppression
@@ -235,17 +223,7 @@ TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointClou
   const int width (input_->width);
   const int height (input_->height);
 
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  shared(indices, occupency_map, output) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(height, indices, occupency_map, output, width) \
-  num_threads(threads_)
-#endif
+  // Greedy suppression in the order of decreasing response, which is sequential by nature
   for (std::size_t i = 0; i < indices.size (); ++i)
   {
     int idx = indices[i];
@@ -256,11 +234,8 @@ TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointClou
     p.getVector3fMap () = input_->points[idx].getVector3fMap ();
     p.intensity = response_->points [idx];
 
-#pragma omp critical
-    {
-      output.push_back (p);
-      keypoints_indices_->indices.push_back (idx);
-    }
+    output.push_back (p);
+    keypoints_indices_->indices.push_back (idx);
 
     const int x = idx % width;
     const int y = idx / width;
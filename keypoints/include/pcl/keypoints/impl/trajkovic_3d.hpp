@@ -38,6 +38,7 @@
 #ifndef PCL_TRAJKOVIC_KEYPOINT_3D_IMPL_H_
 #define PCL_TRAJKOVIC_KEYPOINT_3D_IMPL_H_
 
+#include <pcl/common/parallel.h>
 #include <pcl/features/integral_image_normal.h>
 
 
@@ -106,138 +107,122 @@ TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOu
 
   if (method_ == FOUR_CORNERS)
   {
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  shared(input, normals, response) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(h, input, normals, response, w) \
-  num_threads(threads_)
-#endif
-    for(int j = half_window_size_; j < h; ++j)
+    pcl::parallel::parallel_for (half_window_size_, h, [&] (int first, int last)
     {
-      for(int i = half_window_size_; i < w; ++i)
+      for(int j = first; j < last; ++j)
       {
-        if (!isFinite (input (i,j))) continue;
-        const NormalT &center = normals (i,j);
-        if (!isFinite (center)) continue;
-
-        int count = 0;
-        const NormalT &up = getNormalOrNull (i, j-half_window_size_, count);
-        const NormalT &down = getNormalOrNull (i, j+half_window_size_, count);
-        const NormalT &left = getNormalOrNull (i-half_window_size_, j, count);
-        const NormalT &right = getNormalOrNull (i+half_window_size_, j, count);
-        // Get rid of isolated points
-        if (!count) continue;
-
-        float sn1 = squaredNormalsDiff (up, center);
-        float sn2 = squaredNormalsDiff (down, center);
-        float r1 = sn1 + sn2;
-        float r2 = squaredNormalsDiff (right, center) + squaredNormalsDiff (left, center);
-
-        float d = std::min (r1, r2);
-        if (d < first_threshold_) continue;
-
-        sn1 = std::sqrt (sn1);
-        sn2 = std::sqrt (sn2);
-        float b1 = normalsDiff (right, up) * sn1;
-        b1+= normalsDiff (left, down) * sn2;
-        float b2 = normalsDiff (right, down) * sn2;
-        b2+= normalsDiff (left, up) * sn1;
-        float B = std::min (b1, b2);
-        float A = r2 - r1 - 2*B;
-
-        response (i,j) = ((B < 0) && ((B + A) > 0)) ? r1 - ((B*B)/A) : d;
+        for(int i = half_window_size_; i < w; ++i)
+        {
+          if (!isFinite (input (i,j))) continue;
+          const NormalT &center = normals (i,j);
+          if (!isFinite (center)) continue;
+
+          int count = 0;
+          const NormalT &up = getNormalOrNull (i, j-half_window_size_, count);
+          const NormalT &down = getNormalOrNull (i, j+half_window_size_, count);
+          const NormalT &left = getNormalOrNull (i-half_window_size_, j, count);
+          const NormalT &right = getNormalOrNull (i+half_window_size_, j, count);
+          // Get rid of isolated points
+          if (!count) continue;
+
+          float sn1 = squaredNormalsDiff (up, center);
+          float sn2 = squaredNormalsDiff (down, center);
+          float r1 = sn1 + sn2;
+          float r2 = squaredNormalsDiff (right, center) + squaredNormalsDiff (left, center);
+
+          float d = std::min (r1, r2);
+          if (d < first_threshold_) continue;
+
+          sn1 = std::sqrt (sn1);
+          sn2 = std::sqrt (sn2);
+          float b1 = normalsDiff (right, up) * sn1;
+          b1+= normalsDiff (left, down) * sn2;
+          float b2 = normalsDiff (right, down) * sn2;
+          b2+= normalsDiff (left, up) * sn1;
+          float B = std::min (b1, b2);
+          float A = r2 - r1 - 2*B;
+
+          response (i,j) = ((B < 0) && ((B + A) > 0)) ? r1 - ((B*B)/A) : d;
+        }
       }
-    }
+    }, threads_);
   }
   else
   {
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  shared(input, normals, response) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(h, input, normals, response, w) \
-  num_threads(threads_)
-#endif
-    for(int j = half_window_size_; j < h; ++j)
+    pcl::parallel::parallel_for (half_window_size_, h, [&] (int first, int last)
     {
-      for(int i = half_window_size_; i < w; ++i)
+      for(int j = first; j < last; ++j)
       {
-        if (!isFinite (input (i,j))) continue;
-        const NormalT &center = normals (i,j);
-        if (!isFinite (center)) continue;
-
-        int count = 0;
-        const NormalT &up = getNormalOrNull (i, j-half_window_size_, count);
-        const NormalT &down = getNormalOrNull (i, j+half_window_size_, count);
-        const NormalT &left = getNormalOrNull (i-half_window_size_, j, count);
-        const NormalT &right = getNormalOrNull (i+half_window_size_, j, count);
-        const NormalT &upleft = getNormalOrNull (i-half_window_size_, j-half_window_size_, count);
-        const NormalT &upright = getNormalOrNull (i+half_window_size_, j-half_window_size_, count);
-        const NormalT &downleft = getNormalOrNull (i-half_window_size_, j+half_window_size_, count);
-        const NormalT &downright = getNormalOrNull (i+half_window_size_, j+half_window_size_, count);
-        // Get rid of isolated points
-        if (!count) continue;
-
-        std::vector<float> r (4,0);
-
-        r[0] = squaredNormalsDiff (up, center);
-        r[0]+= squaredNormalsDiff (down, center);
-
-        r[1] = squaredNormalsDiff (upright, center);
-        r[1]+= squaredNormalsDiff (downleft, center);
-
-        r[2] = squaredNormalsDiff (right, center);
-        r[2]+= squaredNormalsDiff (left, center);
-
-        r[3] = squaredNormalsDiff (downright, center);
-        r[3]+= squaredNormalsDiff (upleft, center);
-
-        float d = *(std::min_element (r.begin (), r.end ()));
-
-        if (d < first_threshold_) continue;
-
-        std::vector<float> B (4,0);
-        std::vector<float> A (4,0);
-        std::vector<float> sumAB (4,0);
-        B[0] = normalsDiff (upright, up) * normalsDiff (up, center);
-        B[0]+= normalsDiff (downleft, down) * normalsDiff (down, center);
-        B[1] = normalsDiff (right, upright) * normalsDiff (upright, center);
-        B[1]+= normalsDiff (left, downleft) * normalsDiff (downleft, center);
-        B[2] = normalsDiff (downright, right) * normalsDiff (downright, center);
-        B[2]+= normalsDiff (upleft, left) * normalsDiff (upleft, center);
-        B[3] = normalsDiff (down, downright) * normalsDiff (downright, center);
-        B[3]+= normalsDiff (up, upleft) * normalsDiff (upleft, center);
-        A[0] = r[1] - r[0] - B[0] - B[0];
-        A[1] = r[2] - r[1] - B[1] - B[1];
-        A[2] = r[3] - r[2] - B[2] - B[2];
-        A[3] = r[0] - r[3] - B[3] - B[3];
-        sumAB[0] = A[0] + B[0];
-        sumAB[1] = A[1] + B[1];
-        sumAB[2] = A[2] + B[2];
-        sumAB[3] = A[3] + B[3];
-        if ((*std::max_element (B.begin (), B.end ()) < 0) &&
-            (*std::min_element (sumAB.begin (), sumAB.end ()) > 0))
+        for(int i = half_window_size_; i < w; ++i)
         {
-          std::vector<float> D (4,0);
-          D[0] = B[0] * B[0] / A[0];
-          D[1] = B[1] * B[1] / A[1];
-          D[2] = B[2] * B[2] / A[2];
-          D[3] = B[3] * B[3] / A[3];
-          response (i,j) = *(std::min (D.begin (), D.end ()));
+          if (!isFinite (input (i,j))) continue;
+          const NormalT &center = normals (i,j);
+          if (!isFinite (center)) continue;
+
+          int count = 0;
+          const NormalT &up = getNormalOrNull (i, j-half_window_size_, count);
+          const NormalT &down = getNormalOrNull (i, j+half_window_size_, count);
+          const NormalT &left = getNormalOrNull (i-half_window_size_, j, count);
+          const NormalT &right = getNormalOrNull (i+half_window_size_, j, count);
+          const NormalT &upleft = getNormalOrNull (i-half_window_size_, j-half_window_size_, count);
+          const NormalT &upright = getNormalOrNull (i+half_window_size_, j-half_window_size_, count);
+          const NormalT &downleft = getNormalOrNull (i-half_window_size_, j+half_window_size_, count);
+          const NormalT &downright = getNormalOrNull (i+half_window_size_, j+half_window_size_, count);
+          // Get rid of isolated points
+          if (!count) continue;
+
+          std::vector<float> r (4,0);
+
+          r[0] = squaredNormalsDiff (up, center);
+          r[0]+= squaredNormalsDiff (down, center);
+
+          r[1] = squaredNormalsDiff (upright, center);
+          r[1]+= squaredNormalsDiff (downleft, center);
+
+          r[2] = squaredNormalsDiff (right, center);
+          r[2]+= squaredNormalsDiff (left, center);
+
+          r[3] = squaredNormalsDiff (downright, center);
+          r[3]+= squaredNormalsDiff (upleft, center);
+
+          float d = *(std::min_element (r.begin (), r.end ()));
+
+          if (d < first_threshold_) continue;
+
+          std::vector<float> B (4,0);
+          std::vector<float> A (4,0);
+          std::vector<float> sumAB (4,0);
+          B[0] = normalsDiff (upright, up) * normalsDiff (up, center);
+          B[0]+= normalsDiff (downleft, down) * normalsDiff (down, center);
+          B[1] = normalsDiff (right, upright) * normalsDiff (upright, center);
+          B[1]+= normalsDiff (left, downleft) * normalsDiff (downleft, center);
+          B[2] = normalsDiff (downright, right) * normalsDiff (downright, center);
+          B[2]+= normalsDiff (upleft, left) * normalsDiff (upleft, center);
+          B[3] = normalsDiff (down, downright) * normalsDiff (downright, center);
+          B[3]+= normalsDiff (up, upleft) * normalsDiff (upleft, center);
+          A[0] = r[1] - r[0] - B[0] - B[0];
+          A[1] = r[2] - r[1] - B[1] - B[1];
+          A[2] = r[3] - r[2] - B[2] - B[2];
+          A[3] = r[0] - r[3] - B[3] - B[3];
+          sumAB[0] = A[0] + B[0];
+          sumAB[1] = A[1] + B[1];
+          sumAB[2] = A[2] + B[2];
+          sumAB[3] = A[3] + B[3];
+          if ((*std::max_element (B.begin (), B.end ()) < 0) &&
+              (*std::min_element (sumAB.begin (), sumAB.end ()) > 0))
+          {
+            std::vector<float> D (4,0);
+            D[0] = B[0] * B[0] / A[0];
+            D[1] = B[1] * B[1] / A[1];
+            D[2] = B[2] * B[2] / A[2];
+            D[3] = B[3] * B[3] / A[3];
+            response (i,j) = *(std::min (D.begin (), D.end ()));
+          }
+          else
+            response (i,j) = d;
         }
-        else
-          response (i,j) = d;
       }
-    }
+    }, threads_);
   }
   // Non maximas suppression
   std::vector<int> indices = *indices_;
@@ -250,17 +235,7 @@ TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOu
   const int width (input_->width);
   const int height (input_->height);
 
-#if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
-#pragma omp parallel for \
-  default(none) \
-  shared(indices, occupency_map, output) \
-  num_threads(threads_)
-#else
-#pragma omp parallel for \
-  default(none) \
-  shared(height, indices, occupency_map, output, width) \
-  num_threads(threads_)
-#endif
+  // Greedy suppression in the order of decreasing response, which is sequential by nature
   for (int i = 0; i < static_cast<int>(indices.size ()); ++i)
   {
     int idx = indices[static_cast<std::size_t>(i)];
@@ -271,11 +246,8 @@ TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOu
     p.getVector3fMap () = input_->points[idx].getVector3fMap ();
     p.intensity = response_->points [idx];
 
-#pragma omp critical
-    {
-      output.push_back (p);
-      keypoints_indices_->indices.push_back (idx);
-    }
+    output.push_back (p);
+    keypoints_indices_->indices.push_back (idx);
 
     const int x = idx % width;
     const int y = idx / width;
@@ -194,7 +194,7 @@ namespace pcl
       }
 
       /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel)
         */
       inline void
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
@@ -38,6 +38,7 @@
 #pragma once
 
 #include <pcl/common/geometry.h>
+#include <pcl/common/parallel.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/console/print.h>
 
@@ -58,6 +59,7 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
                    LeafContainerT,
                    BranchContainerT,
                    OctreeBase<LeafContainerT, BranchContainerT>>(resolution_arg)
+, threads_(1)
 {}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -66,51 +68,65 @@ void
 pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::
     addPointsFromInputCloud()
 {
-  // double t1,t2;
-  float minX = std::numeric_limits<float>::max(),
-        minY = std::numeric_limits<float>::max(),
-        minZ = std::numeric_limits<float>::max();
-  float maxX = -std::numeric_limits<float>::max(),
-        maxY = -std::numeric_limits<float>::max(),
-        maxZ = -std::numeric_limits<float>::max();
-
-  for (std::size_t i = 0; i < input_->size(); ++i) {
-    PointT temp(input_->points[i]);
-    if (transform_func_) // Search for point with
-      transform_func_(temp);
-    if (!pcl::isFinite(
-            temp)) // Check to make sure transform didn't make point not finite
-      continue;
-    if (temp.x < minX)
-      minX = temp.x;
-    if (temp.y < minY)
-      minY = temp.y;
-    if (temp.z < minZ)
-      minZ = temp.z;
-    if (temp.x > maxX)
-      maxX = temp.x;
-    if (temp.y > maxY)
-      maxY = temp.y;
-    if (temp.z > maxZ)
-      maxZ = temp.z;
-  }
-  this->defineBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
+  // Bounding box of the (transformed) points
+  using BoundsT = std::pair<Eigen::Array3f, Eigen::Array3f>;
+  const BoundsT empty_bounds(
+      Eigen::Array3f::Constant(std::numeric_limits<float>::max()),
+      Eigen::Array3f::Constant(-std::numeric_limits<float>::max()));
+  const BoundsT bounds = pcl::parallel::parallel_reduce(
+      std::size_t(0),
+      input_->size(),
+      empty_bounds,
+      [this, &empty_bounds](std::size_t first, std::size_t last) {
+        BoundsT chunk_bounds = empty_bounds;
+        for (std::size_t i = first; i < last; ++i) {
+          PointT temp(input_->points[i]);
+          if (transform_func_) // Search for point with
+            transform_func_(temp);
+          if (!pcl::isFinite(temp)) // Check to make sure transform didn't make point
+                                    // not finite
+            continue;
+          chunk_bounds.first = chunk_bounds.first.min(temp.getArray3fMap());
+          chunk_bounds.second = chunk_bounds.second.max(temp.getArray3fMap());
+        }
+        return chunk_bounds;
+      },
+      [](const BoundsT& a, const BoundsT& b) {
+        return BoundsT(a.first.min(b.first), a.second.max(b.second));
+      },
+      threads_);
+  this->defineBoundingBox(bounds.first[0],
+                          bounds.first[1],
+                          bounds.first[2],
+                          bounds.second[0],
+                          bounds.second[1],
+                          bounds.second[2]);
 
   OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::addPointsFromInputCloud();
 
+  leaf_vector_.clear();
   leaf_vector_.reserve(this->getLeafCount());
+  std::vector<OctreeKey> leaf_keys;
+  leaf_keys.reserve(this->getLeafCount());
   for (auto leaf_itr = this->leaf_depth_begin(); leaf_itr != this->leaf_depth_end();
        ++leaf_itr) {
-    OctreeKey leaf_key = leaf_itr.getCurrentOctreeKey();
-    LeafContainerT* leaf_container = &(leaf_itr.getLeafContainer());
-
-    // Run the leaf's compute function
-    leaf_container->computeData();
+    leaf_keys.push_back(leaf_itr.getCurrentOctreeKey());
+    leaf_vector_.push_back(&(leaf_itr.getLeafContainer()));
+  }
 
-    computeNeighbors(leaf_key, leaf_container);
+  // The tree is only read from now on, and each leaf only writes its own container
+  pcl::parallel::parallel_for(
+      std::size_t(0),
+      leaf_vector_.size(),
+      [this, &leaf_keys](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+          // Run the leaf's compute function
+          leaf_vector_[i]->computeData();
 
-    leaf_vector_.push_back(leaf_container);
-  }
+          computeNeighbors(leaf_keys[i], leaf_vector_[i]);
+        }
+      },
+      threads_);
   // Make sure our leaf vector is correctly sized
   assert(leaf_vector_.size() == this->getLeafCount());
 }
@@ -188,6 +188,27 @@ public:
   testForOcclusion(const PointT& point_arg,
                    const PointXYZ& camera_pos = PointXYZ(0, 0, 0));
 
+  /** \brief Sets the number of threads used by addPointsFromInputCloud() to compute
+   * the bounding box, and the data and the neighbors of the leaves. Defaults to 1.
+   *
+   * The threads are taken from the pool of pcl::parallel. The points are still inserted
+   * in the tree by the calling thread.
+   *
+   * \param[in] nr_threads The maximum number of threads to use (0 for the whole budget
+   * of pcl::parallel) */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    threads_ = nr_threads;
+  }
+
+  /** \brief Gets the number of threads used by addPointsFromInputCloud(). */
+  unsigned int
+  getNumberOfThreads() const
+  {
+    return threads_;
+  }
+
 protected:
   /** \brief Add point at index from input pointcloud dataset to octree.
    *
@@ -239,6 +260,9 @@ private:
   LeafVectorT leaf_vector_;
 
   std::function<void(PointT& p)> transform_func_;
+
+  /// Number of threads used by addPointsFromInputCloud().
+  unsigned int threads_;
 };
 
 } // namespace octree
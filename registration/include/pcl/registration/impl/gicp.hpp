@@ -43,6 +43,7 @@
 
 #include <pcl/registration/boost.h>
 #include <pcl/registration/exceptions.h>
+#include <pcl/common/local_surface_statistics.h>
 
 
 namespace pcl
@@ -60,7 +61,7 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(t
     return;
   }
 
-  Eigen::Vector3d mean;
+  LocalSurfaceStatistics statistics;
   std::vector<int> nn_indecies; nn_indecies.reserve (k_correspondences_);
   std::vector<float> nn_dist_sq; nn_dist_sq.reserve (k_correspondences_);
 
@@ -75,50 +76,19 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(t
   {
     const PointT &query_point = *points_iterator;
     Eigen::Matrix3d &cov = *matrices_iterator;
-    // Zero out the cov and mean
-    cov.setZero ();
-    mean.setZero ();
 
     // Search for the K nearest neighbours
     kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
 
-    // Find the covariance matrix
-    for(int j = 0; j < k_correspondences_; j++) {
-      const PointT &pt = (*cloud)[nn_indecies[j]];
-
-      mean[0] += pt.x;
-      mean[1] += pt.y;
-      mean[2] += pt.z;
-
-      cov(0,0) += pt.x*pt.x;
-
-      cov(1,0) += pt.y*pt.x;
-      cov(1,1) += pt.y*pt.y;
-
-      cov(2,0) += pt.z*pt.x;
-      cov(2,1) += pt.z*pt.y;
-      cov(2,2) += pt.z*pt.z;
-    }
-
-    mean /= static_cast<double> (k_correspondences_);
-    // Get the actual covariance
-    for (int k = 0; k < 3; k++)
-      for (int l = 0; l <= k; l++)
-      {
-        cov(k,l) /= static_cast<double> (k_correspondences_);
-        cov(k,l) -= mean[k]*mean[l];
-        cov(l,k) = cov(k,l);
-      }
+    // Find the covariance matrix and its eigenvectors, in increasing order of the eigenvalues
+    computeLocalSurfaceStatistics (*cloud, nn_indecies, statistics);
 
-    // Compute the SVD (covariance matrix is symmetric so U = V')
-    Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU);
+    // Reconstitute the covariance matrix with modified eigenvalues, using the eigenvectors.
     cov.setZero ();
-    Eigen::Matrix3d U = svd.matrixU ();
-    // Reconstitute the covariance matrix with modified singular values using the column     // vectors in V.
     for(int k = 0; k < 3; k++) {
-      Eigen::Vector3d col = U.col(k);
-      double v = 1.; // biggest 2 singular values replaced by 1
-      if(k == 2)   // smallest singular value replaced by gicp_epsilon
+      Eigen::Vector3d col = statistics.eigenvectors.col(k);
+      double v = 1.; // biggest 2 eigenvalues replaced by 1
+      if(k == 0)   // smallest eigenvalue replaced by gicp_epsilon
         v = gicp_epsilon_;
       cov+= v * col * col.transpose();
     }
@@ -0,0 +1,239 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/sample_consensus/sac.h>
+#include <pcl/sample_consensus/sac_model.h>
+#include <pcl/search/search.h>
+
+#include <boost/graph/adjacency_list.hpp>
+
+namespace pcl
+{
+  /** \brief @b GraphCutRandomSampleConsensus represents an implementation of the GC-RANSAC algorithm, as
+    * described in: "Graph-Cut RANSAC", D. Barath and J. Matas, CVPR 2018.
+    *
+    * Hypotheses are scored with the truncated quadratic (MSAC) score. Whenever a new best model is found, it
+    * is improved by a local optimization which alternates between labeling the points as inliers or outliers
+    * with a graph-cut, and a least-squares fit to the labeled inliers. The labeling minimizes the energy of a
+    * Markov random field over the k nearest neighbors graph of the points, whose pairwise term favors
+    * neighboring points having the same label (spatial coherence). As the local optimization converges to a
+    * good model early, the number of iterations needed by the adaptive termination criterion drops
+    * considerably on cluttered scenes.
+    *
+    * The returned inliers are the points within the threshold of the final model that are also labeled as
+    * inliers by the graph-cut, i.e. isolated points which only accidentally lie close to the model are removed.
+    * \ingroup sample_consensus
+    */
+  template <typename PointT>
+  class GraphCutRandomSampleConsensus : public SampleConsensus<PointT>
+  {
+    using SampleConsensusModelPtr = typename SampleConsensusModel<PointT>::Ptr;
+
+    public:
+      using Ptr = shared_ptr<GraphCutRandomSampleConsensus<PointT> >;
+      using ConstPtr = shared_ptr<const GraphCutRandomSampleConsensus<PointT> >;
+
+      using SearchPtr = typename pcl::search::Search<PointT>::Ptr;
+
+      using SampleConsensus<PointT>::max_iterations_;
+      using SampleConsensus<PointT>::threshold_;
+      using SampleConsensus<PointT>::iterations_;
+      using SampleConsensus<PointT>::sac_model_;
+      using SampleConsensus<PointT>::model_;
+      using SampleConsensus<PointT>::model_coefficients_;
+      using SampleConsensus<PointT>::inliers_;
+      using SampleConsensus<PointT>::probability_;
+
+      /** \brief GC-RANSAC main constructor
+        * \param[in] model a Sample Consensus model
+        */
+      GraphCutRandomSampleConsensus (const SampleConsensusModelPtr &model)
+        : SampleConsensus<PointT> (model)
+        , spatial_coherence_weight_ (0.975)
+        , nr_neighbors_ (8)
+        , max_local_optimization_iterations_ (10)
+        , graph_built_ (false)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief GC-RANSAC main constructor
+        * \param[in] model a Sample Consensus model
+        * \param[in] threshold distance to model threshold
+        */
+      GraphCutRandomSampleConsensus (const SampleConsensusModelPtr &model, double threshold)
+        : SampleConsensus<PointT> (model, threshold)
+        , spatial_coherence_weight_ (0.975)
+        , nr_neighbors_ (8)
+        , max_local_optimization_iterations_ (10)
+        , graph_built_ (false)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief Set the weight of the spatial coherence (pairwise) term of the labeling energy.
+        * \param[in] weight the weight, 0 disables the spatial coherence (default: 0.975)
+        */
+      inline void
+      setSpatialCoherenceWeight (double weight) { spatial_coherence_weight_ = weight; }
+
+      /** \brief Get the weight of the spatial coherence term of the labeling energy. */
+      inline double
+      getSpatialCoherenceWeight () const { return (spatial_coherence_weight_); }
+
+      /** \brief Set the number of nearest neighbors each point is connected to in the neighborhood graph.
+        * \param[in] nr_neighbors the number of neighbors (default: 8)
+        */
+      inline void
+      setNumberOfNeighbors (int nr_neighbors) { nr_neighbors_ = nr_neighbors; }
+
+      /** \brief Get the number of nearest neighbors each point is connected to in the neighborhood graph. */
+      inline int
+      getNumberOfNeighbors () const { return (nr_neighbors_); }
+
+      /** \brief Set the maximum number of graph-cut / least-squares iterations of a local optimization.
+        * \param[in] iterations the maximum number of iterations (0 disables the local optimization)
+        */
+      inline void
+      setMaxLocalOptimizationIterations (unsigned int iterations) { max_local_optimization_iterations_ = iterations; }
+
+      /** \brief Get the maximum number of graph-cut / least-squares iterations of a local optimization. */
+      inline unsigned int
+      getMaxLocalOptimizationIterations () const { return (max_local_optimization_iterations_); }
+
+      /** \brief Provide a pointer to the search object used to build the neighborhood graph. If none is given,
+        * a pcl::search::KdTree is used.
+        * \param[in] search a pointer to the spatial search object
+        */
+      inline void
+      setSearchMethod (const SearchPtr &search) { search_ = search; }
+
+      /** \brief Get a pointer to the search object used to build the neighborhood graph. */
+      inline SearchPtr
+      getSearchMethod () const { return (search_); }
+
+      /** \brief Compute the actual model and find the inliers
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        */
+      bool
+      computeModel (int debug_verbosity_level = 0) override;
+
+    protected:
+      using Traits = boost::adjacency_list_traits<boost::vecS, boost::vecS, boost::directedS>;
+
+      using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
+                                          boost::property<boost::vertex_color_t, boost::default_color_type,
+                                            boost::property<boost::vertex_distance_t, long,
+                                              boost::property<boost::vertex_predecessor_t, Traits::edge_descriptor> > >,
+                                          boost::property<boost::edge_capacity_t, double,
+                                            boost::property<boost::edge_residual_capacity_t, double,
+                                              boost::property<boost::edge_reverse_t, Traits::edge_descriptor> > > >;
+
+      using EdgeDescriptor = Traits::edge_descriptor;
+
+      /** \brief Compute the truncated quadratic score of a model (higher is better).
+        * \param[in] distances the distances of all the points to the model
+        * \param[out] n_inliers the number of points within the threshold
+        */
+      double
+      computeScore (const std::vector<double> &distances, std::size_t &n_inliers) const;
+
+      /** \brief Build the graph of the k nearest neighbors of the points, including the source and sink
+        * terminals of the graph-cut.
+        * \return false if the neighborhood graph could not be built
+        */
+      bool
+      buildGraph ();
+
+      /** \brief Label the points as inliers or outliers of a model by a minimum graph-cut.
+        * \param[in] distances the distances of all the points to the model
+        * \param[out] inliers the indices of the points labeled as inliers
+        * \param[in] max_distance only return the inliers within this distance to the model
+        */
+      void
+      labelInliers (const std::vector<double> &distances, Indices &inliers,
+                    double max_distance = std::numeric_limits<double>::max ());
+
+      /** \brief Improve a model by alternating graph-cut labelings and least-squares fits.
+        * \param[in,out] model_coefficients the model to improve
+        * \param[in,out] score the score of the model
+        * \param[in,out] n_inliers the number of points within the threshold of the model
+        */
+      void
+      localOptimization (Eigen::VectorXf &model_coefficients, double &score, std::size_t &n_inliers);
+
+    private:
+      /** \brief Add a directed edge and its (zero capacity) reverse edge to the graph. */
+      EdgeDescriptor
+      addEdge (std::size_t source, std::size_t target, double capacity);
+
+      /** \brief The weight of the spatial coherence term of the labeling energy. */
+      double spatial_coherence_weight_;
+
+      /** \brief The number of nearest neighbors in the neighborhood graph. */
+      int nr_neighbors_;
+
+      /** \brief The maximum number of iterations of a local optimization. */
+      unsigned int max_local_optimization_iterations_;
+
+      /** \brief The search object used to build the neighborhood graph. */
+      SearchPtr search_;
+
+      /** \brief The graph-cut graph: one vertex per index of the model, followed by the source and the sink. */
+      Graph graph_;
+
+      /** \brief The pairs of neighboring points (positions in the indices of the model). */
+      std::vector<std::pair<std::size_t, std::size_t> > neighbor_pairs_;
+
+      /** \brief The edges from the source to every point. */
+      std::vector<EdgeDescriptor> source_edges_;
+
+      /** \brief The edges from every point to the sink. */
+      std::vector<EdgeDescriptor> sink_edges_;
+
+      /** \brief Whether graph_ was built for the current model indices. */
+      bool graph_built_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/sample_consensus/impl/gc_ransac.hpp>
+#endif
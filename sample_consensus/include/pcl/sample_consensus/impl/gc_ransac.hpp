@@ -0,0 +1,344 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SAMPLE_CONSENSUS_IMPL_GC_RANSAC_H_
+#define PCL_SAMPLE_CONSENSUS_IMPL_GC_RANSAC_H_
+
+#include <pcl/sample_consensus/gc_ransac.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+
+#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> double
+pcl::GraphCutRandomSampleConsensus<PointT>::computeScore (const std::vector<double> &distances, std::size_t &n_inliers) const
+{
+  const double sqr_threshold = threshold_ * threshold_;
+  double score = 0.0;
+  n_inliers = 0;
+  for (const double &distance : distances)
+  {
+    const double sqr_distance = distance * distance;
+    if (sqr_distance < sqr_threshold)
+    {
+      score += 1.0 - sqr_distance / sqr_threshold;
+      ++n_inliers;
+    }
+  }
+  return (score);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> typename pcl::GraphCutRandomSampleConsensus<PointT>::EdgeDescriptor
+pcl::GraphCutRandomSampleConsensus<PointT>::addEdge (std::size_t source, std::size_t target, double capacity)
+{
+  EdgeDescriptor edge, reverse_edge;
+  bool added;
+  boost::tie (edge, added) = boost::add_edge (source, target, graph_);
+  boost::tie (reverse_edge, added) = boost::add_edge (target, source, graph_);
+  boost::put (boost::edge_capacity, graph_, edge, capacity);
+  boost::put (boost::edge_capacity, graph_, reverse_edge, 0.0);
+  boost::put (boost::edge_reverse, graph_, edge, reverse_edge);
+  boost::put (boost::edge_reverse, graph_, reverse_edge, edge);
+  return (edge);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::GraphCutRandomSampleConsensus<PointT>::buildGraph ()
+{
+  const auto &cloud = sac_model_->getInputCloud ();
+  const auto &indices = sac_model_->getIndices ();
+  if (!cloud || !indices || nr_neighbors_ <= 0)
+    return (false);
+
+  if (!search_)
+    search_.reset (new pcl::search::KdTree<PointT> (false));
+  search_->setInputCloud (cloud, indices);
+
+  // Position of every point of the cloud in the indices of the model
+  const std::size_t n = indices->size ();
+  std::vector<int> position (cloud->size (), -1);
+  for (std::size_t i = 0; i < n; ++i)
+    position[(*indices)[i]] = static_cast<int> (i);
+
+  std::vector<std::vector<std::size_t> > neighbors (n);
+  Indices nn_indices;
+  std::vector<float> nn_sqr_distances;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (!isFinite ((*cloud)[(*indices)[i]]))
+      continue;
+    search_->nearestKSearch (static_cast<index_t> (i), nr_neighbors_ + 1, nn_indices, nn_sqr_distances);
+    for (const auto &nn_index : nn_indices)
+    {
+      const int j = position[nn_index];
+      if (j >= 0 && static_cast<std::size_t> (j) != i)
+        neighbors[i].push_back (j);
+    }
+  }
+
+  // The k nearest neighbors relation is not symmetric, keep every pair of neighbors once
+  neighbor_pairs_.clear ();
+  for (std::size_t i = 0; i < n; ++i)
+    for (const auto &j : neighbors[i])
+      if (i < j || std::find (neighbors[j].cbegin (), neighbors[j].cend (), i) == neighbors[j].cend ())
+        neighbor_pairs_.emplace_back (i, j);
+
+  // Points 0..n-1, followed by the source (outliers) and the sink (inliers). The terminal capacities
+  // depend on the model and are set in labelInliers.
+  graph_ = Graph (n + 2);
+  source_edges_.resize (n);
+  sink_edges_.resize (n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    source_edges_[i] = addEdge (n, i, 0.0);
+    sink_edges_[i] = addEdge (i, n + 1, 0.0);
+  }
+  for (const auto &pair : neighbor_pairs_)
+    addEdge (pair.first, pair.second, spatial_coherence_weight_);
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::GraphCutRandomSampleConsensus<PointT>::labelInliers (const std::vector<double> &distances, Indices &inliers, double max_distance)
+{
+  const Indices &indices = *sac_model_->getIndices ();
+  const std::size_t n = source_edges_.size ();
+  inliers.clear ();
+  if (distances.size () != n || indices.size () != n)
+    return;
+
+  // Energy of the labeling, with L_p = 1 for inliers (Eq. 3 and 4 of the paper): every point costs
+  // K_p if it is an outlier and 1 - K_p if it is an inlier, with the Gaussian kernel K_p of its
+  // distance. A pair of neighbors costs 1 if labeled differently, 1 - (K_p + K_q) / 2 if both are
+  // inliers and (K_p + K_q) / 2 if both are outliers. The pairwise term is split into the constant
+  // capacity of the edges between the points, and terminal capacities added below.
+  const double two_sqr_threshold = 2.0 * threshold_ * threshold_;
+  std::vector<double> kernel (n), inlier_cost (n), outlier_cost (n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    kernel[i] = std::isfinite (distances[i]) ? std::exp (-distances[i] * distances[i] / two_sqr_threshold) : 0.0;
+    inlier_cost[i] = 1.0 - kernel[i];
+    outlier_cost[i] = kernel[i];
+  }
+  for (const auto &pair : neighbor_pairs_)
+  {
+    const double k_pq = 0.5 * (kernel[pair.first] + kernel[pair.second]);
+    inlier_cost[pair.first] += spatial_coherence_weight_ * (1.0 - k_pq);
+    outlier_cost[pair.second] += spatial_coherence_weight_ * k_pq;
+  }
+
+  // A point ending up on the sink side (inlier) cuts its edge from the source, and vice versa
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    boost::put (boost::edge_capacity, graph_, source_edges_[i], inlier_cost[i]);
+    boost::put (boost::edge_capacity, graph_, sink_edges_[i], outlier_cost[i]);
+  }
+
+  boost::boykov_kolmogorov_max_flow (graph_, n, n + 1);
+
+  const auto colors = boost::get (boost::vertex_color, graph_);
+  const auto source_color = colors[n];
+  for (std::size_t i = 0; i < n; ++i)
+    if (colors[i] != source_color && distances[i] <= max_distance)
+      inliers.push_back (indices[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::GraphCutRandomSampleConsensus<PointT>::localOptimization (Eigen::VectorXf &model_coefficients, double &score, std::size_t &n_inliers)
+{
+  if (max_local_optimization_iterations_ == 0)
+    return;
+  if (!graph_built_ && !(graph_built_ = buildGraph ()))
+    return;
+
+  Indices inliers;
+  Eigen::VectorXf refined_coefficients;
+  std::vector<double> distances, refined_distances;
+  sac_model_->getDistancesToModel (model_coefficients, distances);
+  for (unsigned int i = 0; i < max_local_optimization_iterations_; ++i)
+  {
+    labelInliers (distances, inliers);
+    if (inliers.size () < sac_model_->getSampleSize ())
+      break;
+
+    sac_model_->optimizeModelCoefficients (inliers, model_coefficients, refined_coefficients);
+    sac_model_->getDistancesToModel (refined_coefficients, refined_distances);
+
+    std::size_t refined_n_inliers = 0;
+    const double refined_score = computeScore (refined_distances, refined_n_inliers);
+    if (!(refined_score > score))
+      break;
+
+    score = refined_score;
+    n_inliers = refined_n_inliers;
+    model_coefficients = refined_coefficients;
+    distances.swap (refined_distances);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::GraphCutRandomSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
+{
+  // Warn and exit if no threshold was set
+  if (threshold_ == std::numeric_limits<double>::max())
+  {
+    PCL_ERROR ("[pcl::GraphCutRandomSampleConsensus::computeModel] No threshold set!\n");
+    return (false);
+  }
+
+  iterations_ = 0;
+  this->initHypothesisPretest ();
+  // The neighborhood graph is built on the first local optimization, for the current indices
+  graph_built_ = false;
+  double best_score = -1.0;
+  double k = 1.0;
+
+  Indices selection;
+  Eigen::VectorXf model_coefficients;
+  std::vector<double> distances;
+
+  std::size_t n_inliers_count = 0;
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  // Iterate
+  while (iterations_ < k && skipped_count < max_skip)
+  {
+    // Get X samples which satisfy the model criteria
+    sac_model_->getSamples (iterations_, selection);
+
+    if (selection.empty ()) break;
+
+    // Search for inliers in the point cloud for the current model
+    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    {
+      ++skipped_count;
+      continue;
+    }
+
+    // Hypotheses rejected by the pre-test (if any) count as iterations, but are not scored.
+    // The first hypothesis is always scored, as k is only estimated from a best model.
+    if (!model_.empty () && !this->pretestHypothesis (model_coefficients, threshold_))
+    {
+      if (++iterations_ > max_iterations_)
+        break;
+      continue;
+    }
+
+    sac_model_->getDistancesToModel (model_coefficients, distances);
+    if (distances.empty ())
+    {
+      ++skipped_count;
+      continue;
+    }
+
+    std::size_t n_inliers = 0;
+    double score = computeScore (distances, n_inliers);
+
+    // Better match ?
+    if (score > best_score)
+    {
+      // Local optimization of the new best model
+      localOptimization (model_coefficients, score, n_inliers);
+
+      // Save the current model/coefficients selection as being the best so far
+      best_score          = score;
+      model_              = selection;
+      model_coefficients_ = model_coefficients;
+      n_inliers_count     = n_inliers;
+
+      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+      double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
+      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+      k = std::log (1.0 - probability_) / std::log (p_no_outliers);
+
+      this->updateHypothesisPretest (n_inliers_count);
+    }
+
+    ++iterations_;
+    if (debug_verbosity_level > 1)
+      PCL_DEBUG ("[pcl::GraphCutRandomSampleConsensus::computeModel] Trial %d out of %d. Best score is %f.\n", iterations_, static_cast<int> (std::ceil (k)), best_score);
+    if (iterations_ > max_iterations_)
+    {
+      if (debug_verbosity_level > 0)
+        PCL_DEBUG ("[pcl::GraphCutRandomSampleConsensus::computeModel] GC-RANSAC reached the maximum number of trials.\n");
+      break;
+    }
+  }
+
+  if (model_.empty ())
+  {
+    if (debug_verbosity_level > 0)
+      PCL_DEBUG ("[pcl::GraphCutRandomSampleConsensus::computeModel] Unable to find a solution!\n");
+    return (false);
+  }
+
+  // Iterate through the 3d points and calculate the distances from them to the model again
+  sac_model_->getDistancesToModel (model_coefficients_, distances);
+  const Indices &indices = *sac_model_->getIndices ();
+
+  if (distances.size () != indices.size ())
+  {
+    PCL_ERROR ("[pcl::GraphCutRandomSampleConsensus::computeModel] Estimated distances (%lu) differs than the normal of indices (%lu).\n", distances.size (), indices.size ());
+    return (false);
+  }
+
+  // Get the inliers for the best model found, removing the points which are not spatially coherent
+  if (spatial_coherence_weight_ > 0.0 && (graph_built_ || (graph_built_ = buildGraph ())))
+    labelInliers (distances, inliers_, threshold_);
+  else
+    sac_model_->selectWithinDistance (model_coefficients_, threshold_, inliers_);
+
+  if (debug_verbosity_level > 0)
+    PCL_DEBUG ("[pcl::GraphCutRandomSampleConsensus::computeModel] Model: %lu size, %lu inliers.\n", model_.size (), inliers_.size ());
+
+  return (true);
+}
+
+#define PCL_INSTANTIATE_GraphCutRandomSampleConsensus(T) template class PCL_EXPORTS pcl::GraphCutRandomSampleConsensus<T>;
+
+#endif    // PCL_SAMPLE_CONSENSUS_IMPL_GC_RANSAC_H_
@@ -0,0 +1,278 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SAMPLE_CONSENSUS_IMPL_MAGSAC_H_
+#define PCL_SAMPLE_CONSENSUS_IMPL_MAGSAC_H_
+
+#include <pcl/sample_consensus/magsac.h>
+#include <boost/math/distributions/chi_squared.hpp>
+#include <boost/math/special_functions/expint.hpp>
+#include <boost/math/special_functions/gamma.hpp>
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MagsacSampleConsensus<PointT>::initLossTable ()
+{
+  double dof = degrees_of_freedom_;
+  if (degrees_of_freedom_ == 0)
+  {
+    switch (sac_model_->getModelType ())
+    {
+      case SACMODEL_REGISTRATION:
+        dof = 3.0;
+        break;
+      default:
+        dof = 1.0;
+        break;
+    }
+  }
+
+  // The threshold is the 99% quantile of the residuals of a point with noise sigma_max, i.e.
+  // (threshold / sigma_max)^2 is the 99% quantile of the chi-squared distribution
+  const double k2 = boost::math::quantile (boost::math::chi_squared (dof), 0.99);
+  const double a_lower = (dof + 1.0) / 2.0;
+  const double a_upper = (dof - 1.0) / 2.0;
+  // Upper incomplete gamma function, which is the exponential integral E1 for a = 0
+  const auto upper_gamma = [a_upper] (double z)
+  {
+    return (a_upper > 0.0 ? boost::math::tgamma (a_upper, z) : boost::math::expint (1, z));
+  };
+  const double upper_gamma_k = upper_gamma (k2 / 2.0);
+  const double outlier_loss = 0.5 * boost::math::tgamma_lower (a_lower, k2 / 2.0);
+
+  // Loss of a point at distance r, with x = r^2 / sigma_max^2 (Eq. 8 of the paper, without the
+  // constant factors and divided by the loss of the outliers)
+  const std::size_t table_size = 1024;
+  loss_table_.resize (table_size + 1);
+  loss_table_[0] = 0.0;
+  for (std::size_t i = 1; i < table_size; ++i)
+  {
+    const double x = k2 * static_cast<double> (i) / static_cast<double> (table_size);
+    const double loss = 0.5 * boost::math::tgamma_lower (a_lower, x / 2.0) +
+                        x / 4.0 * (upper_gamma (x / 2.0) - upper_gamma_k);
+    loss_table_[i] = loss / outlier_loss;
+  }
+  loss_table_[table_size] = 1.0;
+  loss_table_scale_ = static_cast<double> (table_size) / (threshold_ * threshold_);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> double
+pcl::MagsacSampleConsensus<PointT>::computeLoss (const std::vector<double> &distances, std::size_t &n_inliers) const
+{
+  const double sqr_threshold = threshold_ * threshold_;
+  const std::size_t last = loss_table_.size () - 1;
+  double loss = 0.0;
+  n_inliers = 0;
+  for (const double &distance : distances)
+  {
+    const double sqr_distance = distance * distance;
+    // Also catches NaN distances
+    if (!(sqr_distance < sqr_threshold))
+    {
+      loss += 1.0;
+      continue;
+    }
+    const double pos = sqr_distance * loss_table_scale_;
+    const std::size_t bin = (std::min) (static_cast<std::size_t> (pos), last - 1);
+    const double t = pos - static_cast<double> (bin);
+    loss += loss_table_[bin] + t * (loss_table_[bin + 1] - loss_table_[bin]);
+    ++n_inliers;
+  }
+  return (loss);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::MagsacSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
+{
+  // Warn and exit if no threshold was set
+  if (threshold_ == std::numeric_limits<double>::max())
+  {
+    PCL_ERROR ("[pcl::MagsacSampleConsensus::computeModel] No threshold set!\n");
+    return (false);
+  }
+
+  iterations_ = 0;
+  this->initHypothesisPretest ();
+  initLossTable ();
+  double best_loss = std::numeric_limits<double>::max();
+  double k = 1.0;
+
+  Indices selection;
+  Eigen::VectorXf model_coefficients;
+  std::vector<double> distances;
+
+  std::size_t n_inliers_count = 0;
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  // Iterate
+  while (iterations_ < k && skipped_count < max_skip)
+  {
+    // Get X samples which satisfy the model criteria
+    sac_model_->getSamples (iterations_, selection);
+
+    if (selection.empty ()) break;
+
+    // Search for inliers in the point cloud for the current model
+    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    {
+      ++skipped_count;
+      continue;
+    }
+
+    // Hypotheses rejected by the pre-test (if any) count as iterations, but are not scored.
+    // The first hypothesis is always scored, as k is only estimated from a best model.
+    if (!model_.empty () && !this->pretestHypothesis (model_coefficients, threshold_))
+    {
+      if (++iterations_ > max_iterations_)
+        break;
+      continue;
+    }
+
+    // Iterate through the 3d points and calculate the distances from them to the model
+    sac_model_->getDistancesToModel (model_coefficients, distances);
+    if (distances.empty ())
+    {
+      ++skipped_count;
+      continue;
+    }
+
+    std::size_t n_inliers = 0;
+    const double loss = computeLoss (distances, n_inliers);
+
+    // Better match ?
+    if (loss < best_loss)
+    {
+      best_loss = loss;
+
+      // Save the current model/coefficients selection as being the best so far
+      model_              = selection;
+      model_coefficients_ = model_coefficients;
+      n_inliers_count     = n_inliers;
+
+      // Compute the k parameter (k=std::log(z)/std::log(1-w^n)), counting all the points below the
+      // threshold, which is an upper bound of the inlier-outlier threshold
+      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+      double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
+      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+      k = std::log (1.0 - probability_) / std::log (p_no_outliers);
+
+      this->updateHypothesisPretest (n_inliers_count);
+    }
+
+    ++iterations_;
+    if (debug_verbosity_level > 1)
+      PCL_DEBUG ("[pcl::MagsacSampleConsensus::computeModel] Trial %d out of %d. Best loss is %f.\n", iterations_, static_cast<int> (std::ceil (k)), best_loss);
+    if (iterations_ > max_iterations_)
+    {
+      if (debug_verbosity_level > 0)
+        PCL_DEBUG ("[pcl::MagsacSampleConsensus::computeModel] MAGSAC++ reached the maximum number of trials.\n");
+      break;
+    }
+  }
+
+  if (model_.empty ())
+  {
+    if (debug_verbosity_level > 0)
+      PCL_DEBUG ("[pcl::MagsacSampleConsensus::computeModel] Unable to find a solution!\n");
+    return (false);
+  }
+
+  // Iterate through the 3d points and calculate the distances from them to the model again
+  sac_model_->getDistancesToModel (model_coefficients_, distances);
+  const Indices &indices = *sac_model_->getIndices ();
+
+  if (distances.size () != indices.size ())
+  {
+    PCL_ERROR ("[pcl::MagsacSampleConsensus::computeModel] Estimated distances (%lu) differs than the normal of indices (%lu).\n", distances.size (), indices.size ());
+    return (false);
+  }
+
+  // Polish the best model with least-squares fits to the points below the threshold, as long as
+  // this decreases the marginalized loss
+  Indices inliers;
+  Eigen::VectorXf refined_coefficients;
+  std::vector<double> refined_distances;
+  for (unsigned int i = 0; i < max_refinement_iterations_; ++i)
+  {
+    inliers.clear ();
+    for (std::size_t j = 0; j < distances.size (); ++j)
+      if (distances[j] < threshold_)
+        inliers.push_back (indices[j]);
+    if (inliers.size () < sac_model_->getSampleSize ())
+      break;
+
+    sac_model_->optimizeModelCoefficients (inliers, model_coefficients_, refined_coefficients);
+    sac_model_->getDistancesToModel (refined_coefficients, refined_distances);
+    if (refined_distances.size () != indices.size ())
+      break;
+
+    std::size_t n_inliers = 0;
+    const double loss = computeLoss (refined_distances, n_inliers);
+    if (!(loss < best_loss))
+      break;
+
+    best_loss = loss;
+    model_coefficients_ = refined_coefficients;
+    distances.swap (refined_distances);
+    if (debug_verbosity_level > 1)
+      PCL_DEBUG ("[pcl::MagsacSampleConsensus::computeModel] Refinement %u decreased the loss to %f.\n", i + 1, best_loss);
+  }
+
+  inliers_.resize (distances.size ());
+  // Get the inliers for the best model found
+  n_inliers_count = 0;
+  for (std::size_t i = 0; i < distances.size (); ++i)
+    if (distances[i] <= threshold_)
+      inliers_[n_inliers_count++] = indices[i];
+
+  // Resize the inliers vector
+  inliers_.resize (n_inliers_count);
+
+  if (debug_verbosity_level > 0)
+    PCL_DEBUG ("[pcl::MagsacSampleConsensus::computeModel] Model: %lu size, %lu inliers.\n", model_.size (), n_inliers_count);
+
+  return (true);
+}
+
+#define PCL_INSTANTIATE_MagsacSampleConsensus(T) template class PCL_EXPORTS pcl::MagsacSampleConsensus<T>;
+
+#endif    // PCL_SAMPLE_CONSENSUS_IMPL_MAGSAC_H_
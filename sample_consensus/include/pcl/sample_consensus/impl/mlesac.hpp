@@ -56,6 +56,7 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   }
 
   iterations_ = 0;
+  this->initHypothesisPretest ();
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
@@ -96,6 +97,15 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
       continue;
     }
 
+    // Hypotheses rejected by the pre-test (if any) count as iterations, but are not scored.
+    // The first hypothesis is always scored, as k is only estimated from a best model.
+    if (!model_.empty () && !this->pretestHypothesis (model_coefficients, 2 * sigma_))
+    {
+      if (++iterations_ > max_iterations_)
+        break;
+      continue;
+    }
+
     // Iterate through the 3d points and calculate the distances from them to the model
     sac_model_->getDistancesToModel (model_coefficients, distances);
 
@@ -156,6 +166,8 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
       p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
       p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
       k = std::log (1 - probability_) / std::log (p_no_outliers);
+
+      this->updateHypothesisPretest (n_inliers_count);
     }
 
     ++iterations_;
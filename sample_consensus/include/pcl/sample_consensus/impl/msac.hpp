@@ -55,6 +55,7 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   }
 
   iterations_ = 0;
+  this->initHypothesisPretest ();
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
@@ -83,6 +84,15 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
       continue;
      }
 
+    // Hypotheses rejected by the pre-test (if any) count as iterations, but are not scored.
+    // The first hypothesis is always scored, as k is only estimated from a best model.
+    if (!model_.empty () && !this->pretestHypothesis (model_coefficients, threshold_))
+    {
+      if (++iterations_ > max_iterations_)
+        break;
+      continue;
+    }
+
     double d_cur_penalty = 0;
     // Iterate through the 3d points and calculate the distances from them to the model
     sac_model_->getDistancesToModel (model_coefficients, distances);
@@ -114,6 +124,8 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
       p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
       p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
       k = std::log (1.0 - probability_) / std::log (p_no_outliers);
+
+      this->updateHypothesisPretest (n_inliers_count);
     }
 
     ++iterations_;
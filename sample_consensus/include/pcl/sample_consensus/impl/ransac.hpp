@@ -42,15 +42,10 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_RANSAC_H_
 
 #include <pcl/sample_consensus/ransac.h>
-#ifdef _OPENMP
-#include <omp.h>
-#endif
+#include <pcl/common/parallel.h>
 
-#if defined _OPENMP && _OPENMP >= 201107 // We need OpenMP 3.1 for the atomic constructs
-#define OPENMP_AVAILABLE_RANSAC true
-#else
-#define OPENMP_AVAILABLE_RANSAC false
-#endif
+#include <atomic>
+#include <mutex>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -64,143 +59,109 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
   }
 
   iterations_ = 0;
+  this->initHypothesisPretest ();
   std::size_t n_best_inliers_count = 0;
   double k = std::numeric_limits<double>::max();
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients;
-
   const double log_probability  = std::log (1.0 - probability_);
   const double one_over_indices = 1.0 / static_cast<double> (sac_model_->getIndices ()->size ());
 
-  unsigned skipped_count = 0;
-
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
 
-  int threads = threads_;
-  if (threads >= 0)
+  // Every thread runs the RANSAC loop on its own hypotheses, until one of them meets a stopping criterion
+  const unsigned int threads = threads_ < 0 ? 1u : pcl::parallel::detail::getNumberOfThreads (static_cast<unsigned int> (threads_));
+  if (threads > 1)
+    PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing in parallel with up to %u threads.\n", threads);
+  else
+    PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing not parallel.\n");
+
+  std::atomic<bool> done (false);
+  std::atomic<int> iterations (0);
+  std::atomic<unsigned> skipped_count (0);
+  std::atomic<bool> has_best_model (false);
+  std::mutex update_mutex; // n_best_inliers_count, model_, model_coefficients_ and k are shared
+  pcl::parallel::parallel_for (0u, threads, [&] (unsigned int, unsigned int)
   {
-#if OPENMP_AVAILABLE_RANSAC
-    if (threads == 0)
-    {
-      threads = omp_get_num_procs();
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Automatic number of threads requested, choosing %i threads.\n", threads);
-    }
-#else
-    // Parallelization desired, but not available
-    PCL_WARN ("[pcl::RandomSampleConsensus::computeModel] Parallelization is requested, but OpenMP 3.1 is not available! Continuing without parallelization.\n");
-    threads = -1;
-#endif
-  }
-
-#if OPENMP_AVAILABLE_RANSAC
-#pragma omp parallel if(threads > 0) num_threads(threads) shared(k, skipped_count, n_best_inliers_count) firstprivate(selection, model_coefficients) // would be nice to have a default(none)-clause here, but then some compilers complain about the shared const variables
-#endif
-  {
-#if OPENMP_AVAILABLE_RANSAC
-    if (omp_in_parallel())
-#pragma omp master
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing in parallel with up to %i threads.\n", omp_get_num_threads());
-    else
-#endif
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing not parallel.\n");
+    Indices selection;
+    Eigen::VectorXf model_coefficients;
 
     // Iterate
-    while (true) // infinite loop with four possible breaks
+    while (!done)
     {
       // Get X samples which satisfy the model criteria
-#if OPENMP_AVAILABLE_RANSAC
-#pragma omp critical(samples)
-#endif
       {
-        sac_model_->getSamples (iterations_, selection); // The random number generator used when choosing the samples should not be called in parallel
+        // The random number generator used when choosing the samples should not be called in parallel
+        std::lock_guard<std::mutex> lock (*this->samples_mutex_);
+        int iterations_tmp = iterations;
+        sac_model_->getSamples (iterations_tmp, selection);
       }
 
       if (selection.empty ())
       {
         PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
+        done = true;
         break;
       }
 
       // Search for inliers in the point cloud for the current plane model M
       if (!sac_model_->computeModelCoefficients (selection, model_coefficients)) // This function has to be thread-safe
       {
-        //++iterations_;
-        unsigned skipped_count_tmp;
-#if OPENMP_AVAILABLE_RANSAC
-#pragma omp atomic capture
-#endif
-        skipped_count_tmp = ++skipped_count;
-        if (skipped_count_tmp < max_skip)
+        if (++skipped_count < max_skip)
           continue;
-        else
-          break;
+        done = true;
+        break;
       }
 
-      // Select the inliers that are within threshold_ from the model
-      //sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
-      //if (inliers.empty () && k > 1.0)
-      //  continue;
-
-      std::size_t n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_); // This functions has to be thread-safe. Most work is done here
+      // Hypotheses rejected by the pre-test (if any) count as iterations, but are not scored.
+      // The hypotheses are always scored until there is a best model, as k is only estimated from one.
+      std::size_t n_inliers_count = 0;
+      if (!has_best_model || this->pretestHypothesis (model_coefficients, threshold_)) // This function is thread-safe
+        n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_); // This functions has to be thread-safe. Most work is done here
 
       std::size_t n_best_inliers_count_tmp;
-#if OPENMP_AVAILABLE_RANSAC
-#pragma omp atomic read
-#endif
-      n_best_inliers_count_tmp = n_best_inliers_count;
-
-      if (n_inliers_count > n_best_inliers_count_tmp) // This condition is false most of the time, and the critical region is not entered, hopefully leading to more efficient concurrency
+      double k_tmp;
       {
-#if OPENMP_AVAILABLE_RANSAC
-#pragma omp critical(update) // n_best_inliers_count, model_, model_coefficients_, k are shared and read/write must be protected
-#endif
+        std::lock_guard<std::mutex> lock (update_mutex);
+        // Better match ?
+        if (n_inliers_count > n_best_inliers_count)
         {
-          // Better match ?
-          if (n_inliers_count > n_best_inliers_count)
-          {
-            n_best_inliers_count = n_inliers_count; // This write and the previous read of n_best_inliers_count must be consecutive and must not be interrupted!
-            n_best_inliers_count_tmp = n_best_inliers_count;
-
-            // Save the current model/inlier/coefficients selection as being the best so far
-            model_              = selection;
-            model_coefficients_ = model_coefficients;
-
-            // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-            const double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
-            double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
-            p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-            p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-            k = log_probability / std::log (p_no_outliers);
-          }
-        } // omp critical
+          n_best_inliers_count = n_inliers_count;
+
+          // Save the current model/inlier/coefficients selection as being the best so far
+          model_              = selection;
+          model_coefficients_ = model_coefficients;
+          has_best_model = true;
+
+          // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+          const double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
+          double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
+          p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+          p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+          k = log_probability / std::log (p_no_outliers);
+
+          this->updateHypothesisPretest (n_best_inliers_count);
+        }
+        n_best_inliers_count_tmp = n_best_inliers_count;
+        k_tmp = k;
       }
 
-      int iterations_tmp;
-      double k_tmp;
-#if OPENMP_AVAILABLE_RANSAC
-#pragma omp atomic capture
-#endif
-      iterations_tmp = ++iterations_;
-#if OPENMP_AVAILABLE_RANSAC
-#pragma omp atomic read
-#endif
-      k_tmp = k;
-#if OPENMP_AVAILABLE_RANSAC
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %u inliers (best is: %u so far) (thread %d).\n", iterations_tmp, k_tmp, n_inliers_count, n_best_inliers_count_tmp, omp_get_thread_num());
-#else
+      const int iterations_tmp = ++iterations;
       PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %u inliers (best is: %u so far).\n", iterations_tmp, k_tmp, n_inliers_count, n_best_inliers_count_tmp);
-#endif
       if (iterations_tmp > k_tmp)
+      {
+        done = true;
         break;
+      }
       if (iterations_tmp > max_iterations_)
       {
         PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        done = true;
         break;
       }
     } // while
-  } // omp parallel
+  }, threads, 1u);
+  iterations_ = iterations;
 
   PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Model: %lu size, %u inliers.\n", model_.size (), n_best_inliers_count);
 
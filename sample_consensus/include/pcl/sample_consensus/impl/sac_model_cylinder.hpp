@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/eigen.h>
 #include <pcl/sample_consensus/sac_model_cylinder.h>
+#include <pcl/sample_consensus/impl/sac_model_simd.hpp>
 #include <pcl/common/concatenate.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -186,42 +187,19 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::selectWithinDistance (
     return;
   }
 
-  inliers.clear ();
-  error_sqr_dists_.clear ();
-  inliers.reserve (indices_->size ());
-  error_sqr_dists_.reserve (indices_->size ());
-
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0.0f);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
-  float ptdotdir = line_pt.dot (line_dir);
-  float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  // Same distances as countWithinDistance, so that both agree on the inliers
+  this->selectWithinRanges ([&] (std::size_t begin, std::size_t end, Indices &range_inliers, std::vector<double> &range_distances)
   {
-    // Approximate the distance from the point to the cylinder as the difference between
-    // dist(point,cylinder_axis) and cylinder radius
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x, input_->points[(*indices_)[i]].y, input_->points[(*indices_)[i]].z, 0.0f);
-    Eigen::Vector4f n  (normals_->points[(*indices_)[i]].normal[0], normals_->points[(*indices_)[i]].normal[1], normals_->points[(*indices_)[i]].normal[2], 0.0f);
-    double d_euclid = std::abs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
-
-    // Calculate the point's projection on the cylinder axis
-    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
-    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
-    Eigen::Vector4f dir = pt - pt_proj;
-    dir.normalize ();
-
-    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
-    double d_normal = std::abs (getAngle3D (n, dir));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    double distance = std::abs (normal_distance_weight_ * d_normal + (1.0 - normal_distance_weight_) * d_euclid);
-    if (distance < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (distance);
-    }
-  }
+#if defined (__AVX512F__)
+    countWithinDistanceAVX512 (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__AVX__) && defined (__AVX2__)
+    countWithinDistanceAVX (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__SSE2__)
+    countWithinDistanceSSE (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#else
+    countWithinDistanceStandard (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#endif
+  }, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -233,6 +211,26 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
+  return (this->countWithinRanges ([&] (std::size_t begin, std::size_t end)
+  {
+#if defined (__AVX512F__)
+    return (countWithinDistanceAVX512 (model_coefficients, threshold, begin, end));
+#elif defined (__AVX__) && defined (__AVX2__)
+    return (countWithinDistanceAVX (model_coefficients, threshold, begin, end));
+#elif defined (__SSE2__)
+    return (countWithinDistanceSSE (model_coefficients, threshold, begin, end));
+#else
+    return (countWithinDistanceStandard (model_coefficients, threshold, begin, end));
+#endif
+  }));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
   std::size_t nr_p = 0;
 
   Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
@@ -240,7 +238,7 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistance (
   float ptdotdir = line_pt.dot (line_dir);
   float dirdotdir = 1.0f / line_dir.dot (line_dir);
   // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (std::size_t i = begin; i < end; ++i)
   {
     // Approximate the distance from the point to the cylinder as the difference between
     // dist(point,cylinder_axis) and cylinder radius
@@ -258,12 +256,225 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistance (
     double d_normal = std::abs (getAngle3D (n, dir));
     d_normal = (std::min) (d_normal, M_PI - d_normal);
 
-    if (std::abs (normal_distance_weight_ * d_normal + (1.0 - normal_distance_weight_) * d_euclid) < threshold)
+    const double distance = std::abs (normal_distance_weight_ * d_normal + (1.0 - normal_distance_weight_) * d_euclid);
+    if (distance < threshold)
+    {
       nr_p++;
+      if (inliers)
+      {
+        inliers->push_back ((*indices_)[i]);
+        distances->push_back (distance);
+      }
+    }
   }
   return (nr_p);
 }
 
+#define AT(POS) (input_->points[(*indices_)[i + (POS)]])
+#define NORMAL_AT(POS) (normals_->points[(*indices_)[i + (POS)]])
+
+// The SIMD implementations use an approximation of acos (see pcl::detail::sacAcosUnit), so points
+// whose weighted distance lies within about 1e-4 of the threshold may be classified differently
+// than by the standard implementation.
+
+#if defined (__SSE2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const Eigen::Vector3f line_pt (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
+  const Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+  const __m128 px_vec = _mm_set1_ps (line_pt[0]);
+  const __m128 py_vec = _mm_set1_ps (line_pt[1]);
+  const __m128 pz_vec = _mm_set1_ps (line_pt[2]);
+  const __m128 dx_vec = _mm_set1_ps (line_dir[0]);
+  const __m128 dy_vec = _mm_set1_ps (line_dir[1]);
+  const __m128 dz_vec = _mm_set1_ps (line_dir[2]);
+  const __m128 dirdotdir_vec = _mm_set1_ps (1.0f / line_dir.dot (line_dir));
+  const __m128 radius_vec = _mm_set1_ps (model_coefficients[6]);
+  const __m128 weight_vec = _mm_set1_ps (static_cast<float> (normal_distance_weight_));
+  const __m128 one_vec = _mm_set1_ps (1.0f);
+  const __m128 threshold_vec = _mm_set1_ps (static_cast<float> (threshold));
+  __m128i counts = _mm_setzero_si128 ();
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    const __m128 x = _mm_set_ps (AT(3).x, AT(2).x, AT(1).x, AT(0).x);
+    const __m128 y = _mm_set_ps (AT(3).y, AT(2).y, AT(1).y, AT(0).y);
+    const __m128 z = _mm_set_ps (AT(3).z, AT(2).z, AT(1).z, AT(0).z);
+    const __m128 nx = _mm_set_ps (NORMAL_AT(3).normal[0], NORMAL_AT(2).normal[0], NORMAL_AT(1).normal[0], NORMAL_AT(0).normal[0]);
+    const __m128 ny = _mm_set_ps (NORMAL_AT(3).normal[1], NORMAL_AT(2).normal[1], NORMAL_AT(1).normal[1], NORMAL_AT(0).normal[1]);
+    const __m128 nz = _mm_set_ps (NORMAL_AT(3).normal[2], NORMAL_AT(2).normal[2], NORMAL_AT(1).normal[2], NORMAL_AT(0).normal[2]);
+
+    // Point relative to the point on the axis, and its position k along the axis
+    const __m128 vx = _mm_sub_ps (x, px_vec);
+    const __m128 vy = _mm_sub_ps (y, py_vec);
+    const __m128 vz = _mm_sub_ps (z, pz_vec);
+    const __m128 k = _mm_mul_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (vx, dx_vec), _mm_mul_ps (vy, dy_vec)), _mm_mul_ps (vz, dz_vec)), dirdotdir_vec);
+
+    // Direction from the projection of the point on the axis to the point
+    const __m128 rx = _mm_sub_ps (vx, _mm_mul_ps (k, dx_vec));
+    const __m128 ry = _mm_sub_ps (vy, _mm_mul_ps (k, dy_vec));
+    const __m128 rz = _mm_sub_ps (vz, _mm_mul_ps (k, dz_vec));
+    const __m128 r_sqr_norm = _mm_add_ps (_mm_add_ps (_mm_mul_ps (rx, rx), _mm_mul_ps (ry, ry)), _mm_mul_ps (rz, rz));
+
+    // Approximate the distance from the point to the cylinder as the difference between
+    // dist(point,cylinder_axis) and cylinder radius
+    const __m128 d_euclid = pcl::detail::sacAbs (_mm_sub_ps (_mm_sqrt_ps (r_sqr_norm), radius_vec));
+
+    // Angular distance between the point normal and the (projection->point) direction
+    const __m128 n_dot = _mm_add_ps (_mm_add_ps (_mm_mul_ps (nx, rx), _mm_mul_ps (ny, ry)), _mm_mul_ps (nz, rz));
+    const __m128 n_sqr_norm = _mm_add_ps (_mm_add_ps (_mm_mul_ps (nx, nx), _mm_mul_ps (ny, ny)), _mm_mul_ps (nz, nz));
+    const __m128 d_normal = pcl::detail::sacUnsignedAngle (n_dot, _mm_mul_ps (n_sqr_norm, r_sqr_norm));
+
+    const __m128 distance = pcl::detail::sacAbs (_mm_add_ps (_mm_mul_ps (weight_vec, d_normal),
+                                                             _mm_mul_ps (_mm_sub_ps (one_vec, weight_vec), d_euclid)));
+    const __m128 mask = _mm_cmplt_ps (distance, threshold_vec);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const Eigen::Vector3f line_pt (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
+  const Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+  const __m256 px_vec = _mm256_set1_ps (line_pt[0]);
+  const __m256 py_vec = _mm256_set1_ps (line_pt[1]);
+  const __m256 pz_vec = _mm256_set1_ps (line_pt[2]);
+  const __m256 dx_vec = _mm256_set1_ps (line_dir[0]);
+  const __m256 dy_vec = _mm256_set1_ps (line_dir[1]);
+  const __m256 dz_vec = _mm256_set1_ps (line_dir[2]);
+  const __m256 dirdotdir_vec = _mm256_set1_ps (1.0f / line_dir.dot (line_dir));
+  const __m256 radius_vec = _mm256_set1_ps (model_coefficients[6]);
+  const __m256 weight_vec = _mm256_set1_ps (static_cast<float> (normal_distance_weight_));
+  const __m256 one_vec = _mm256_set1_ps (1.0f);
+  const __m256 threshold_vec = _mm256_set1_ps (static_cast<float> (threshold));
+  __m256i counts = _mm256_setzero_si256 ();
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    const __m256 x = _mm256_set_ps (AT(7).x, AT(6).x, AT(5).x, AT(4).x, AT(3).x, AT(2).x, AT(1).x, AT(0).x);
+    const __m256 y = _mm256_set_ps (AT(7).y, AT(6).y, AT(5).y, AT(4).y, AT(3).y, AT(2).y, AT(1).y, AT(0).y);
+    const __m256 z = _mm256_set_ps (AT(7).z, AT(6).z, AT(5).z, AT(4).z, AT(3).z, AT(2).z, AT(1).z, AT(0).z);
+    const __m256 nx = _mm256_set_ps (NORMAL_AT(7).normal[0], NORMAL_AT(6).normal[0], NORMAL_AT(5).normal[0], NORMAL_AT(4).normal[0],
+                                     NORMAL_AT(3).normal[0], NORMAL_AT(2).normal[0], NORMAL_AT(1).normal[0], NORMAL_AT(0).normal[0]);
+    const __m256 ny = _mm256_set_ps (NORMAL_AT(7).normal[1], NORMAL_AT(6).normal[1], NORMAL_AT(5).normal[1], NORMAL_AT(4).normal[1],
+                                     NORMAL_AT(3).normal[1], NORMAL_AT(2).normal[1], NORMAL_AT(1).normal[1], NORMAL_AT(0).normal[1]);
+    const __m256 nz = _mm256_set_ps (NORMAL_AT(7).normal[2], NORMAL_AT(6).normal[2], NORMAL_AT(5).normal[2], NORMAL_AT(4).normal[2],
+                                     NORMAL_AT(3).normal[2], NORMAL_AT(2).normal[2], NORMAL_AT(1).normal[2], NORMAL_AT(0).normal[2]);
+
+    // Point relative to the point on the axis, and its position k along the axis
+    const __m256 vx = _mm256_sub_ps (x, px_vec);
+    const __m256 vy = _mm256_sub_ps (y, py_vec);
+    const __m256 vz = _mm256_sub_ps (z, pz_vec);
+    const __m256 k = _mm256_mul_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (vx, dx_vec), _mm256_mul_ps (vy, dy_vec)), _mm256_mul_ps (vz, dz_vec)), dirdotdir_vec);
+
+    // Direction from the projection of the point on the axis to the point
+    const __m256 rx = _mm256_sub_ps (vx, _mm256_mul_ps (k, dx_vec));
+    const __m256 ry = _mm256_sub_ps (vy, _mm256_mul_ps (k, dy_vec));
+    const __m256 rz = _mm256_sub_ps (vz, _mm256_mul_ps (k, dz_vec));
+    const __m256 r_sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (rx, rx), _mm256_mul_ps (ry, ry)), _mm256_mul_ps (rz, rz));
+
+    // Approximate the distance from the point to the cylinder as the difference between
+    // dist(point,cylinder_axis) and cylinder radius
+    const __m256 d_euclid = pcl::detail::sacAbs (_mm256_sub_ps (_mm256_sqrt_ps (r_sqr_norm), radius_vec));
+
+    // Angular distance between the point normal and the (projection->point) direction
+    const __m256 n_dot = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (nx, rx), _mm256_mul_ps (ny, ry)), _mm256_mul_ps (nz, rz));
+    const __m256 n_sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (nx, nx), _mm256_mul_ps (ny, ny)), _mm256_mul_ps (nz, nz));
+    const __m256 d_normal = pcl::detail::sacUnsignedAngle (n_dot, _mm256_mul_ps (n_sqr_norm, r_sqr_norm));
+
+    const __m256 distance = pcl::detail::sacAbs (_mm256_add_ps (_mm256_mul_ps (weight_vec, d_normal),
+                                                                _mm256_mul_ps (_mm256_sub_ps (one_vec, weight_vec), d_euclid)));
+    const __m256 mask = _mm256_cmp_ps (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX512F__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistanceAVX512 (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const Eigen::Vector3f line_pt (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
+  const Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+  const __m512 px_vec = _mm512_set1_ps (line_pt[0]);
+  const __m512 py_vec = _mm512_set1_ps (line_pt[1]);
+  const __m512 pz_vec = _mm512_set1_ps (line_pt[2]);
+  const __m512 dx_vec = _mm512_set1_ps (line_dir[0]);
+  const __m512 dy_vec = _mm512_set1_ps (line_dir[1]);
+  const __m512 dz_vec = _mm512_set1_ps (line_dir[2]);
+  const __m512 dirdotdir_vec = _mm512_set1_ps (1.0f / line_dir.dot (line_dir));
+  const __m512 radius_vec = _mm512_set1_ps (model_coefficients[6]);
+  const __m512 weight_vec = _mm512_set1_ps (static_cast<float> (normal_distance_weight_));
+  const __m512 one_vec = _mm512_set1_ps (1.0f);
+  const __m512 threshold_vec = _mm512_set1_ps (static_cast<float> (threshold));
+  __m512i counts = _mm512_setzero_si512 ();
+
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16)
+  {
+    const __m512 x = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).x); });
+    const __m512 y = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).y); });
+    const __m512 z = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).z); });
+    const __m512 nx = pcl::detail::sacLoad ([&] (int lane) { return (NORMAL_AT(lane).normal[0]); });
+    const __m512 ny = pcl::detail::sacLoad ([&] (int lane) { return (NORMAL_AT(lane).normal[1]); });
+    const __m512 nz = pcl::detail::sacLoad ([&] (int lane) { return (NORMAL_AT(lane).normal[2]); });
+
+    // Point relative to the point on the axis, and its position k along the axis
+    const __m512 vx = _mm512_sub_ps (x, px_vec);
+    const __m512 vy = _mm512_sub_ps (y, py_vec);
+    const __m512 vz = _mm512_sub_ps (z, pz_vec);
+    const __m512 k = _mm512_mul_ps (_mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (vx, dx_vec), _mm512_mul_ps (vy, dy_vec)), _mm512_mul_ps (vz, dz_vec)), dirdotdir_vec);
+
+    // Direction from the projection of the point on the axis to the point
+    const __m512 rx = _mm512_sub_ps (vx, _mm512_mul_ps (k, dx_vec));
+    const __m512 ry = _mm512_sub_ps (vy, _mm512_mul_ps (k, dy_vec));
+    const __m512 rz = _mm512_sub_ps (vz, _mm512_mul_ps (k, dz_vec));
+    const __m512 r_sqr_norm = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (rx, rx), _mm512_mul_ps (ry, ry)), _mm512_mul_ps (rz, rz));
+
+    // Approximate the distance from the point to the cylinder as the difference between
+    // dist(point,cylinder_axis) and cylinder radius
+    const __m512 d_euclid = pcl::detail::sacAbs (_mm512_sub_ps (_mm512_sqrt_ps (r_sqr_norm), radius_vec));
+
+    // Angular distance between the point normal and the (projection->point) direction
+    const __m512 n_dot = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (nx, rx), _mm512_mul_ps (ny, ry)), _mm512_mul_ps (nz, rz));
+    const __m512 n_sqr_norm = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (nx, nx), _mm512_mul_ps (ny, ny)), _mm512_mul_ps (nz, nz));
+    const __m512 d_normal = pcl::detail::sacUnsignedAngle (n_dot, _mm512_mul_ps (n_sqr_norm, r_sqr_norm));
+
+    const __m512 distance = pcl::detail::sacAbs (_mm512_add_ps (_mm512_mul_ps (weight_vec, d_normal),
+                                                                _mm512_mul_ps (_mm512_sub_ps (one_vec, weight_vec), d_euclid)));
+    const __mmask16 mask = _mm512_cmp_ps_mask (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#undef AT
+#undef NORMAL_AT
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> void
 pcl::SampleConsensusModelCylinder<PointT, PointNT>::optimizeModelCoefficients (
@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_LINE_H_
 
 #include <pcl/sample_consensus/sac_model_line.h>
+#include <pcl/sample_consensus/impl/sac_model_simd.hpp>
 #include <pcl/common/centroid.h>
 #include <pcl/common/concatenate.h>
 
@@ -137,32 +138,19 @@ pcl::SampleConsensusModelLine<PointT>::selectWithinDistance (
   if (!isModelValid (model_coefficients))
     return;
 
-  double sqr_threshold = threshold * threshold;
-
-  inliers.clear ();
-  error_sqr_dists_.clear ();
-  inliers.reserve (indices_->size ());
-  error_sqr_dists_.reserve (indices_->size ());
-
-  // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  line_dir.normalize ();
-
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  // Same (squared) distances as countWithinDistance, so that both agree on the inliers
+  this->selectWithinRanges ([&] (std::size_t begin, std::size_t end, Indices &range_inliers, std::vector<double> &range_distances)
   {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
-    {
-      // Returns the indices of the points whose squared distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (sqr_distance);
-    }
-  }
+#if defined (__AVX512F__)
+    countWithinDistanceAVX512 (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__AVX__) && defined (__AVX2__)
+    countWithinDistanceAVX (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__SSE2__)
+    countWithinDistanceSSE (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#else
+    countWithinDistanceStandard (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#endif
+  }, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -174,6 +162,26 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
+  return (this->countWithinRanges ([&] (std::size_t begin, std::size_t end)
+  {
+#if defined (__AVX512F__)
+    return (countWithinDistanceAVX512 (model_coefficients, threshold, begin, end));
+#elif defined (__AVX__) && defined (__AVX2__)
+    return (countWithinDistanceAVX (model_coefficients, threshold, begin, end));
+#elif defined (__SSE2__)
+    return (countWithinDistanceSSE (model_coefficients, threshold, begin, end));
+#else
+    return (countWithinDistanceStandard (model_coefficients, threshold, begin, end));
+#endif
+  }));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
   double sqr_threshold = threshold * threshold;
 
   std::size_t nr_p = 0;
@@ -184,18 +192,149 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   line_dir.normalize ();
 
   // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (std::size_t i = begin; i < end; ++i)
   {
     // Calculate the distance from the point to the line
     // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
+    double distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
 
-    if (sqr_distance < sqr_threshold)
+    if (distance < sqr_threshold)
+    {
       nr_p++;
+      if (inliers)
+      {
+        inliers->push_back ((*indices_)[i]);
+        distances->push_back (distance);
+      }
+    }
   }
   return (nr_p);
 }
 
+#define AT(POS) (input_->points[(*indices_)[i + (POS)]])
+
+#if defined (__SSE2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  // Obtain the line point and the normalized line direction
+  Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+  line_dir.normalize ();
+  const __m128 px_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 py_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 pz_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 dx_vec = _mm_set1_ps (line_dir[0]);
+  const __m128 dy_vec = _mm_set1_ps (line_dir[1]);
+  const __m128 dz_vec = _mm_set1_ps (line_dir[2]);
+  // The squared distances are compared against the squared threshold
+  const __m128 threshold_vec = _mm_set1_ps (static_cast<float> (threshold * threshold));
+  __m128i counts = _mm_setzero_si128 ();
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    const __m128 vx = _mm_sub_ps (px_vec, _mm_set_ps (AT(3).x, AT(2).x, AT(1).x, AT(0).x));
+    const __m128 vy = _mm_sub_ps (py_vec, _mm_set_ps (AT(3).y, AT(2).y, AT(1).y, AT(0).y));
+    const __m128 vz = _mm_sub_ps (pz_vec, _mm_set_ps (AT(3).z, AT(2).z, AT(1).z, AT(0).z));
+    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1||, with ||P2-P1|| = 1
+    const __m128 cx = _mm_sub_ps (_mm_mul_ps (vy, dz_vec), _mm_mul_ps (vz, dy_vec));
+    const __m128 cy = _mm_sub_ps (_mm_mul_ps (vz, dx_vec), _mm_mul_ps (vx, dz_vec));
+    const __m128 cz = _mm_sub_ps (_mm_mul_ps (vx, dy_vec), _mm_mul_ps (vy, dx_vec));
+    const __m128 distance = _mm_add_ps (_mm_add_ps (_mm_mul_ps (cx, cx), _mm_mul_ps (cy, cy)), _mm_mul_ps (cz, cz));
+    const __m128 mask = _mm_cmplt_ps (distance, threshold_vec);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  // Obtain the line point and the normalized line direction
+  Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+  line_dir.normalize ();
+  const __m256 px_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 py_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 pz_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 dx_vec = _mm256_set1_ps (line_dir[0]);
+  const __m256 dy_vec = _mm256_set1_ps (line_dir[1]);
+  const __m256 dz_vec = _mm256_set1_ps (line_dir[2]);
+  // The squared distances are compared against the squared threshold
+  const __m256 threshold_vec = _mm256_set1_ps (static_cast<float> (threshold * threshold));
+  __m256i counts = _mm256_setzero_si256 ();
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    const __m256 vx = _mm256_sub_ps (px_vec, _mm256_set_ps (AT(7).x, AT(6).x, AT(5).x, AT(4).x, AT(3).x, AT(2).x, AT(1).x, AT(0).x));
+    const __m256 vy = _mm256_sub_ps (py_vec, _mm256_set_ps (AT(7).y, AT(6).y, AT(5).y, AT(4).y, AT(3).y, AT(2).y, AT(1).y, AT(0).y));
+    const __m256 vz = _mm256_sub_ps (pz_vec, _mm256_set_ps (AT(7).z, AT(6).z, AT(5).z, AT(4).z, AT(3).z, AT(2).z, AT(1).z, AT(0).z));
+    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1||, with ||P2-P1|| = 1
+    const __m256 cx = _mm256_sub_ps (_mm256_mul_ps (vy, dz_vec), _mm256_mul_ps (vz, dy_vec));
+    const __m256 cy = _mm256_sub_ps (_mm256_mul_ps (vz, dx_vec), _mm256_mul_ps (vx, dz_vec));
+    const __m256 cz = _mm256_sub_ps (_mm256_mul_ps (vx, dy_vec), _mm256_mul_ps (vy, dx_vec));
+    const __m256 distance = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (cx, cx), _mm256_mul_ps (cy, cy)), _mm256_mul_ps (cz, cz));
+    const __m256 mask = _mm256_cmp_ps (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX512F__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countWithinDistanceAVX512 (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  // Obtain the line point and the normalized line direction
+  Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+  line_dir.normalize ();
+  const __m512 px_vec = _mm512_set1_ps (model_coefficients[0]);
+  const __m512 py_vec = _mm512_set1_ps (model_coefficients[1]);
+  const __m512 pz_vec = _mm512_set1_ps (model_coefficients[2]);
+  const __m512 dx_vec = _mm512_set1_ps (line_dir[0]);
+  const __m512 dy_vec = _mm512_set1_ps (line_dir[1]);
+  const __m512 dz_vec = _mm512_set1_ps (line_dir[2]);
+  // The squared distances are compared against the squared threshold
+  const __m512 threshold_vec = _mm512_set1_ps (static_cast<float> (threshold * threshold));
+  __m512i counts = _mm512_setzero_si512 ();
+
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16)
+  {
+    const __m512 vx = _mm512_sub_ps (px_vec, pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).x); }));
+    const __m512 vy = _mm512_sub_ps (py_vec, pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).y); }));
+    const __m512 vz = _mm512_sub_ps (pz_vec, pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).z); }));
+    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1||, with ||P2-P1|| = 1
+    const __m512 cx = _mm512_sub_ps (_mm512_mul_ps (vy, dz_vec), _mm512_mul_ps (vz, dy_vec));
+    const __m512 cy = _mm512_sub_ps (_mm512_mul_ps (vz, dx_vec), _mm512_mul_ps (vx, dz_vec));
+    const __m512 cz = _mm512_sub_ps (_mm512_mul_ps (vx, dy_vec), _mm512_mul_ps (vy, dx_vec));
+    const __m512 distance = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (cx, cx), _mm512_mul_ps (cy, cy)), _mm512_mul_ps (cz, cz));
+    const __mmask16 mask = _mm512_cmp_ps_mask (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#undef AT
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelLine<PointT>::optimizeModelCoefficients (
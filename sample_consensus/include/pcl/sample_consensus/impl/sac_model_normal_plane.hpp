@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_NORMAL_PLANE_H_
 
 #include <pcl/sample_consensus/sac_model_normal_plane.h>
+#include <pcl/sample_consensus/impl/sac_model_simd.hpp>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> void
@@ -62,41 +63,19 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::selectWithinDistance (
     return;
   }
 
-  // Obtain the plane normal
-  Eigen::Vector4f coeff = model_coefficients;
-  coeff[3] = 0.0f;
-
-  inliers.clear ();
-  error_sqr_dists_.clear ();
-  inliers.reserve (indices_->size ());
-  error_sqr_dists_.reserve (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  // Same distances as countWithinDistance, so that both agree on the inliers
+  this->selectWithinRanges ([&] (std::size_t begin, std::size_t end, Indices &range_inliers, std::vector<double> &range_distances)
   {
-    const PointT  &pt = input_->points[(*indices_)[i]];
-    const PointNT &nt = normals_->points[(*indices_)[i]];
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f p (pt.x, pt.y, pt.z, 0.0f);
-    Eigen::Vector4f n (nt.normal_x, nt.normal_y, nt.normal_z, 0.0f);
-    double d_euclid = std::abs (coeff.dot (p) + model_coefficients[3]);
-
-    // Calculate the angular distance between the point normal and the plane normal
-    double d_normal = std::abs (getAngle3D (n, coeff));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    // Weight with the point curvature. On flat surfaces, curvature -> 0, which means the normal will have a higher influence
-    double weight = normal_distance_weight_ * (1.0 - nt.curvature);
-
-    double distance = std::abs (weight * d_normal + (1.0 - weight) * d_euclid); 
-    if (distance < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (distance);
-    }
-  }
+#if defined (__AVX512F__)
+    countWithinDistanceAVX512 (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__AVX__) && defined (__AVX2__)
+    countWithinDistanceAVX (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__SSE2__)
+    countWithinDistanceSSE (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#else
+    countWithinDistanceStandard (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#endif
+  }, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -114,6 +93,26 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
+  return (this->countWithinRanges ([&] (std::size_t begin, std::size_t end)
+  {
+#if defined (__AVX512F__)
+    return (countWithinDistanceAVX512 (model_coefficients, threshold, begin, end));
+#elif defined (__AVX__) && defined (__AVX2__)
+    return (countWithinDistanceAVX (model_coefficients, threshold, begin, end));
+#elif defined (__SSE2__)
+    return (countWithinDistanceSSE (model_coefficients, threshold, begin, end));
+#else
+    return (countWithinDistanceStandard (model_coefficients, threshold, begin, end));
+#endif
+  }));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
   // Obtain the plane normal
   Eigen::Vector4f coeff = model_coefficients;
   coeff[3] = 0.0f;
@@ -121,7 +120,7 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistance (
   std::size_t nr_p = 0;
 
   // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (std::size_t i = begin; i < end; ++i)
   {
     const PointT  &pt = input_->points[(*indices_)[i]];
     const PointNT &nt = normals_->points[(*indices_)[i]];
@@ -138,13 +137,176 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistance (
     // Weight with the point curvature. On flat surfaces, curvature -> 0, which means the normal will have a higher influence
     double weight = normal_distance_weight_ * (1.0 - nt.curvature);
 
-    if (std::abs (weight * d_normal + (1.0 - weight) * d_euclid) < threshold)
+    const double distance = std::abs (weight * d_normal + (1.0 - weight) * d_euclid);
+    if (distance < threshold)
+    {
       nr_p++;
+      if (inliers)
+      {
+        inliers->push_back ((*indices_)[i]);
+        distances->push_back (distance);
+      }
+    }
   }
   return (nr_p);
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#define AT(POS) (input_->points[(*indices_)[i + (POS)]])
+#define NORMAL_AT(POS) (normals_->points[(*indices_)[i + (POS)]])
+
+// The SIMD implementations use an approximation of acos (see pcl::detail::sacAcosUnit), so points
+// whose weighted distance lies within about 1e-4 of the threshold may be classified differently
+// than by the standard implementation.
+
+#if defined (__SSE2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 d_vec = _mm_set1_ps (model_coefficients[3]);
+  const __m128 sqr_norm_vec = _mm_set1_ps (model_coefficients.head<3> ().squaredNorm ());
+  const __m128 weight_vec = _mm_set1_ps (static_cast<float> (normal_distance_weight_));
+  const __m128 one_vec = _mm_set1_ps (1.0f);
+  const __m128 threshold_vec = _mm_set1_ps (static_cast<float> (threshold));
+  __m128i counts = _mm_setzero_si128 ();
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    const __m128 x = _mm_set_ps (AT(3).x, AT(2).x, AT(1).x, AT(0).x);
+    const __m128 y = _mm_set_ps (AT(3).y, AT(2).y, AT(1).y, AT(0).y);
+    const __m128 z = _mm_set_ps (AT(3).z, AT(2).z, AT(1).z, AT(0).z);
+    const __m128 nx = _mm_set_ps (NORMAL_AT(3).normal_x, NORMAL_AT(2).normal_x, NORMAL_AT(1).normal_x, NORMAL_AT(0).normal_x);
+    const __m128 ny = _mm_set_ps (NORMAL_AT(3).normal_y, NORMAL_AT(2).normal_y, NORMAL_AT(1).normal_y, NORMAL_AT(0).normal_y);
+    const __m128 nz = _mm_set_ps (NORMAL_AT(3).normal_z, NORMAL_AT(2).normal_z, NORMAL_AT(1).normal_z, NORMAL_AT(0).normal_z);
+    const __m128 curvature = _mm_set_ps (NORMAL_AT(3).curvature, NORMAL_AT(2).curvature, NORMAL_AT(1).curvature, NORMAL_AT(0).curvature);
+
+    const __m128 d_euclid = pcl::detail::sacAbs (_mm_add_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (a_vec, x), _mm_mul_ps (c_vec, z)),
+                                                                         _mm_mul_ps (b_vec, y)), d_vec));
+    const __m128 n_dot = _mm_add_ps (_mm_add_ps (_mm_mul_ps (a_vec, nx), _mm_mul_ps (b_vec, ny)), _mm_mul_ps (c_vec, nz));
+    const __m128 n_sqr_norm = _mm_add_ps (_mm_add_ps (_mm_mul_ps (nx, nx), _mm_mul_ps (ny, ny)), _mm_mul_ps (nz, nz));
+    const __m128 d_normal = pcl::detail::sacUnsignedAngle (n_dot, _mm_mul_ps (n_sqr_norm, sqr_norm_vec));
+
+    // Weight with the point curvature
+    const __m128 weight = _mm_mul_ps (weight_vec, _mm_sub_ps (one_vec, curvature));
+    const __m128 distance = pcl::detail::sacAbs (_mm_add_ps (_mm_mul_ps (weight, d_normal),
+                                                             _mm_mul_ps (_mm_sub_ps (one_vec, weight), d_euclid)));
+    const __m128 mask = _mm_cmplt_ps (distance, threshold_vec);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 d_vec = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 sqr_norm_vec = _mm256_set1_ps (model_coefficients.head<3> ().squaredNorm ());
+  const __m256 weight_vec = _mm256_set1_ps (static_cast<float> (normal_distance_weight_));
+  const __m256 one_vec = _mm256_set1_ps (1.0f);
+  const __m256 threshold_vec = _mm256_set1_ps (static_cast<float> (threshold));
+  __m256i counts = _mm256_setzero_si256 ();
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    const __m256 x = _mm256_set_ps (AT(7).x, AT(6).x, AT(5).x, AT(4).x, AT(3).x, AT(2).x, AT(1).x, AT(0).x);
+    const __m256 y = _mm256_set_ps (AT(7).y, AT(6).y, AT(5).y, AT(4).y, AT(3).y, AT(2).y, AT(1).y, AT(0).y);
+    const __m256 z = _mm256_set_ps (AT(7).z, AT(6).z, AT(5).z, AT(4).z, AT(3).z, AT(2).z, AT(1).z, AT(0).z);
+    const __m256 nx = _mm256_set_ps (NORMAL_AT(7).normal_x, NORMAL_AT(6).normal_x, NORMAL_AT(5).normal_x, NORMAL_AT(4).normal_x,
+                                     NORMAL_AT(3).normal_x, NORMAL_AT(2).normal_x, NORMAL_AT(1).normal_x, NORMAL_AT(0).normal_x);
+    const __m256 ny = _mm256_set_ps (NORMAL_AT(7).normal_y, NORMAL_AT(6).normal_y, NORMAL_AT(5).normal_y, NORMAL_AT(4).normal_y,
+                                     NORMAL_AT(3).normal_y, NORMAL_AT(2).normal_y, NORMAL_AT(1).normal_y, NORMAL_AT(0).normal_y);
+    const __m256 nz = _mm256_set_ps (NORMAL_AT(7).normal_z, NORMAL_AT(6).normal_z, NORMAL_AT(5).normal_z, NORMAL_AT(4).normal_z,
+                                     NORMAL_AT(3).normal_z, NORMAL_AT(2).normal_z, NORMAL_AT(1).normal_z, NORMAL_AT(0).normal_z);
+    const __m256 curvature = _mm256_set_ps (NORMAL_AT(7).curvature, NORMAL_AT(6).curvature, NORMAL_AT(5).curvature, NORMAL_AT(4).curvature,
+                                            NORMAL_AT(3).curvature, NORMAL_AT(2).curvature, NORMAL_AT(1).curvature, NORMAL_AT(0).curvature);
+
+    const __m256 d_euclid = pcl::detail::sacAbs (_mm256_add_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (a_vec, x), _mm256_mul_ps (c_vec, z)),
+                                                                               _mm256_mul_ps (b_vec, y)), d_vec));
+    const __m256 n_dot = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (a_vec, nx), _mm256_mul_ps (b_vec, ny)), _mm256_mul_ps (c_vec, nz));
+    const __m256 n_sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (nx, nx), _mm256_mul_ps (ny, ny)), _mm256_mul_ps (nz, nz));
+    const __m256 d_normal = pcl::detail::sacUnsignedAngle (n_dot, _mm256_mul_ps (n_sqr_norm, sqr_norm_vec));
+
+    // Weight with the point curvature
+    const __m256 weight = _mm256_mul_ps (weight_vec, _mm256_sub_ps (one_vec, curvature));
+    const __m256 distance = pcl::detail::sacAbs (_mm256_add_ps (_mm256_mul_ps (weight, d_normal),
+                                                                _mm256_mul_ps (_mm256_sub_ps (one_vec, weight), d_euclid)));
+    const __m256 mask = _mm256_cmp_ps (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX512F__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistanceAVX512 (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m512 a_vec = _mm512_set1_ps (model_coefficients[0]);
+  const __m512 b_vec = _mm512_set1_ps (model_coefficients[1]);
+  const __m512 c_vec = _mm512_set1_ps (model_coefficients[2]);
+  const __m512 d_vec = _mm512_set1_ps (model_coefficients[3]);
+  const __m512 sqr_norm_vec = _mm512_set1_ps (model_coefficients.head<3> ().squaredNorm ());
+  const __m512 weight_vec = _mm512_set1_ps (static_cast<float> (normal_distance_weight_));
+  const __m512 one_vec = _mm512_set1_ps (1.0f);
+  const __m512 threshold_vec = _mm512_set1_ps (static_cast<float> (threshold));
+  __m512i counts = _mm512_setzero_si512 ();
+
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16)
+  {
+    const __m512 x = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).x); });
+    const __m512 y = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).y); });
+    const __m512 z = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).z); });
+    const __m512 nx = pcl::detail::sacLoad ([&] (int lane) { return (NORMAL_AT(lane).normal_x); });
+    const __m512 ny = pcl::detail::sacLoad ([&] (int lane) { return (NORMAL_AT(lane).normal_y); });
+    const __m512 nz = pcl::detail::sacLoad ([&] (int lane) { return (NORMAL_AT(lane).normal_z); });
+    const __m512 curvature = pcl::detail::sacLoad ([&] (int lane) { return (NORMAL_AT(lane).curvature); });
+
+    const __m512 d_euclid = pcl::detail::sacAbs (_mm512_add_ps (_mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (a_vec, x), _mm512_mul_ps (c_vec, z)),
+                                                                               _mm512_mul_ps (b_vec, y)), d_vec));
+    const __m512 n_dot = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (a_vec, nx), _mm512_mul_ps (b_vec, ny)), _mm512_mul_ps (c_vec, nz));
+    const __m512 n_sqr_norm = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (nx, nx), _mm512_mul_ps (ny, ny)), _mm512_mul_ps (nz, nz));
+    const __m512 d_normal = pcl::detail::sacUnsignedAngle (n_dot, _mm512_mul_ps (n_sqr_norm, sqr_norm_vec));
+
+    // Weight with the point curvature
+    const __m512 weight = _mm512_mul_ps (weight_vec, _mm512_sub_ps (one_vec, curvature));
+    const __m512 distance = pcl::detail::sacAbs (_mm512_add_ps (_mm512_mul_ps (weight, d_normal),
+                                                                _mm512_mul_ps (_mm512_sub_ps (one_vec, weight), d_euclid)));
+    const __mmask16 mask = _mm512_cmp_ps_mask (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#undef AT
+#undef NORMAL_AT
+
+//////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> void
 pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::getDistancesToModel (
       const Eigen::VectorXf &model_coefficients, std::vector<double> &distances) const
@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_PLANE_H_
 
 #include <pcl/sample_consensus/sac_model_plane.h>
+#include <pcl/sample_consensus/impl/sac_model_simd.hpp>
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
 #include <pcl/common/concatenate.h>
@@ -154,30 +155,19 @@ pcl::SampleConsensusModelPlane<PointT>::selectWithinDistance (
     return;
   }
 
-  inliers.clear ();
-  error_sqr_dists_.clear ();
-  inliers.reserve (indices_->size ());
-  error_sqr_dists_.reserve (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  // Same distances as countWithinDistance, so that both agree on the inliers
+  this->selectWithinRanges ([&] (std::size_t begin, std::size_t end, Indices &range_inliers, std::vector<double> &range_distances)
   {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1.0f);
-    
-    float distance = std::abs (model_coefficients.dot (pt));
-    
-    if (distance < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (static_cast<double> (distance));
-    }
-  }
+#if defined (__AVX512F__)
+    countWithinDistanceAVX512 (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__AVX__) && defined (__AVX2__)
+    countWithinDistanceAVX (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__SSE2__)
+    countWithinDistanceSSE (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#else
+    countWithinDistanceStandard (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#endif
+  }, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -192,10 +182,30 @@ pcl::SampleConsensusModelPlane<PointT>::countWithinDistance (
     return (0);
   }
 
+  return (this->countWithinRanges ([&] (std::size_t begin, std::size_t end)
+  {
+#if defined (__AVX512F__)
+    return (countWithinDistanceAVX512 (model_coefficients, threshold, begin, end));
+#elif defined (__AVX__) && defined (__AVX2__)
+    return (countWithinDistanceAVX (model_coefficients, threshold, begin, end));
+#elif defined (__SSE2__)
+    return (countWithinDistanceSSE (model_coefficients, threshold, begin, end));
+#else
+    return (countWithinDistanceStandard (model_coefficients, threshold, begin, end));
+#endif
+  }));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelPlane<PointT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
   std::size_t nr_p = 0;
 
   // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (std::size_t i = begin; i < end; ++i)
   {
     // Calculate the distance from the point to the plane normal as the dot product
     // D = (P-A).N/|N|
@@ -203,14 +213,120 @@ pcl::SampleConsensusModelPlane<PointT>::countWithinDistance (
                         input_->points[(*indices_)[i]].y,
                         input_->points[(*indices_)[i]].z,
                         1.0f);
-    if (std::abs (model_coefficients.dot (pt)) < threshold)
+    const float distance = std::abs (model_coefficients.dot (pt));
+    if (distance < threshold)
     {
       nr_p++;
+      if (inliers)
+      {
+        inliers->push_back ((*indices_)[i]);
+        distances->push_back (static_cast<double> (distance));
+      }
     }
   }
   return (nr_p);
 }
 
+#define AT(POS) (input_->points[(*indices_)[i + (POS)]])
+
+#if defined (__SSE2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelPlane<PointT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 d_vec = _mm_set1_ps (model_coefficients[3]);
+  const __m128 threshold_vec = _mm_set1_ps (static_cast<float> (threshold));
+  __m128i counts = _mm_setzero_si128 ();
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    const __m128 x = _mm_set_ps (AT(3).x, AT(2).x, AT(1).x, AT(0).x);
+    const __m128 y = _mm_set_ps (AT(3).y, AT(2).y, AT(1).y, AT(0).y);
+    const __m128 z = _mm_set_ps (AT(3).z, AT(2).z, AT(1).z, AT(0).z);
+    // Same summation order as the (vectorized) Eigen dot product of the standard implementation
+    const __m128 distance = pcl::detail::sacAbs (_mm_add_ps (_mm_add_ps (_mm_mul_ps (a_vec, x), _mm_mul_ps (c_vec, z)),
+                                                             _mm_add_ps (_mm_mul_ps (b_vec, y), d_vec)));
+    const __m128 mask = _mm_cmplt_ps (distance, threshold_vec);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelPlane<PointT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 d_vec = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 threshold_vec = _mm256_set1_ps (static_cast<float> (threshold));
+  __m256i counts = _mm256_setzero_si256 ();
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    const __m256 x = _mm256_set_ps (AT(7).x, AT(6).x, AT(5).x, AT(4).x, AT(3).x, AT(2).x, AT(1).x, AT(0).x);
+    const __m256 y = _mm256_set_ps (AT(7).y, AT(6).y, AT(5).y, AT(4).y, AT(3).y, AT(2).y, AT(1).y, AT(0).y);
+    const __m256 z = _mm256_set_ps (AT(7).z, AT(6).z, AT(5).z, AT(4).z, AT(3).z, AT(2).z, AT(1).z, AT(0).z);
+    // Same summation order as the (vectorized) Eigen dot product of the standard implementation
+    const __m256 distance = pcl::detail::sacAbs (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (a_vec, x), _mm256_mul_ps (c_vec, z)),
+                                                                _mm256_add_ps (_mm256_mul_ps (b_vec, y), d_vec)));
+    const __m256 mask = _mm256_cmp_ps (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX512F__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelPlane<PointT>::countWithinDistanceAVX512 (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m512 a_vec = _mm512_set1_ps (model_coefficients[0]);
+  const __m512 b_vec = _mm512_set1_ps (model_coefficients[1]);
+  const __m512 c_vec = _mm512_set1_ps (model_coefficients[2]);
+  const __m512 d_vec = _mm512_set1_ps (model_coefficients[3]);
+  const __m512 threshold_vec = _mm512_set1_ps (static_cast<float> (threshold));
+  __m512i counts = _mm512_setzero_si512 ();
+
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16)
+  {
+    const __m512 x = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).x); });
+    const __m512 y = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).y); });
+    const __m512 z = pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).z); });
+    // Same summation order as the (vectorized) Eigen dot product of the standard implementation
+    const __m512 distance = pcl::detail::sacAbs (_mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (a_vec, x), _mm512_mul_ps (c_vec, z)),
+                                                                _mm512_add_ps (_mm512_mul_ps (b_vec, y), d_vec)));
+    const __mmask16 mask = _mm512_cmp_ps_mask (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#undef AT
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelPlane<PointT>::optimizeModelCoefficients (
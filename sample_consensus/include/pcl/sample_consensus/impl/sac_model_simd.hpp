@@ -0,0 +1,275 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if (defined(__AVX__) && defined(__AVX2__)) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include <pcl/types.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+
+namespace detail
+{
+
+// Small helpers shared by the SIMD implementations of SampleConsensusModel*::countWithinDistance
+// and selectWithinDistance. Inliers are counted per lane: a comparison mask has all bits set (i.e. -1
+// as an integer) in the lanes that passed, so subtracting the mask from the counter increments exactly
+// those lanes. The AVX-512 versions get the comparison as a mask register instead.
+
+#if defined(__SSE2__)
+
+/** Absolute value of four floats (clears the sign bit). */
+inline __m128
+sacAbs (const __m128 x)
+{
+  return (_mm_andnot_ps (_mm_set1_ps (-0.0f), x));
+}
+
+/** Arc cosine of four values in [0, 1], using the polynomial approximation 4.4.45 from
+  * Abramowitz & Stegun (maximum absolute error 6.8e-5 rad). NaN inputs yield NaN. */
+inline __m128
+sacAcosUnit (const __m128 x)
+{
+  __m128 p = _mm_set1_ps (-0.0187293f);
+  p = _mm_add_ps (_mm_mul_ps (p, x), _mm_set1_ps (0.0742610f));
+  p = _mm_add_ps (_mm_mul_ps (p, x), _mm_set1_ps (-0.2121144f));
+  p = _mm_add_ps (_mm_mul_ps (p, x), _mm_set1_ps (1.5707288f));
+  return (_mm_mul_ps (_mm_sqrt_ps (_mm_sub_ps (_mm_set1_ps (1.0f), x)), p));
+}
+
+/** Angle between two sets of vectors, folded into [0, pi/2], given their dot products and the
+  * products of their squared norms. As with pcl::getAngle3D, a zero-length vector gives pi/2. */
+inline __m128
+sacUnsignedAngle (const __m128 dot, const __m128 sqr_norms)
+{
+  const __m128 nonzero = _mm_cmpneq_ps (sqr_norms, _mm_setzero_ps ());
+  const __m128 cos_angle = _mm_and_ps (nonzero, sacAbs (_mm_div_ps (dot, _mm_sqrt_ps (sqr_norms))));
+  // _mm_min_ps returns its second operand if either is NaN, so NaNs are propagated here
+  return (sacAcosUnit (_mm_min_ps (_mm_set1_ps (1.0f), cos_angle)));
+}
+
+/** Increment the lanes of \a counts for which \a mask is set. */
+inline __m128i
+sacCount (const __m128i counts, const __m128 mask)
+{
+  return (_mm_sub_epi32 (counts, _mm_castps_si128 (mask)));
+}
+
+/** Sum of the four lane counters. */
+inline std::size_t
+sacSum (const __m128i counts)
+{
+  alignas (16) int c[4];
+  _mm_store_si128 (reinterpret_cast<__m128i*> (c), counts);
+  return (static_cast<std::size_t> (c[0]) + c[1] + c[2] + c[3]);
+}
+
+/** Append the entries of \a indices at positions i to i + 3 for which \a mask is set to \a inliers,
+  * and the matching lanes of \a distance to \a distances. */
+inline void
+sacSelect (const __m128 mask, const __m128 distance, const std::size_t i, const Indices &indices,
+           Indices &inliers, std::vector<double> &distances)
+{
+  const int lanes = _mm_movemask_ps (mask);
+  if (lanes == 0)
+    return;
+  alignas (16) float d[4];
+  _mm_store_ps (d, distance);
+  for (int lane = 0; lane < 4; ++lane)
+    if (lanes & (1 << lane))
+    {
+      inliers.push_back (indices[i + lane]);
+      distances.push_back (static_cast<double> (d[lane]));
+    }
+}
+
+#endif // defined(__SSE2__)
+
+#if defined(__AVX__) && defined(__AVX2__)
+
+/** Absolute value of eight floats (clears the sign bit). */
+inline __m256
+sacAbs (const __m256 x)
+{
+  return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), x));
+}
+
+/** Arc cosine of eight values in [0, 1], see the SSE version above. */
+inline __m256
+sacAcosUnit (const __m256 x)
+{
+  __m256 p = _mm256_set1_ps (-0.0187293f);
+  p = _mm256_add_ps (_mm256_mul_ps (p, x), _mm256_set1_ps (0.0742610f));
+  p = _mm256_add_ps (_mm256_mul_ps (p, x), _mm256_set1_ps (-0.2121144f));
+  p = _mm256_add_ps (_mm256_mul_ps (p, x), _mm256_set1_ps (1.5707288f));
+  return (_mm256_mul_ps (_mm256_sqrt_ps (_mm256_sub_ps (_mm256_set1_ps (1.0f), x)), p));
+}
+
+/** Angle between two sets of vectors, folded into [0, pi/2], see the SSE version above. */
+inline __m256
+sacUnsignedAngle (const __m256 dot, const __m256 sqr_norms)
+{
+  const __m256 nonzero = _mm256_cmp_ps (sqr_norms, _mm256_setzero_ps (), _CMP_NEQ_UQ);
+  const __m256 cos_angle = _mm256_and_ps (nonzero, sacAbs (_mm256_div_ps (dot, _mm256_sqrt_ps (sqr_norms))));
+  return (sacAcosUnit (_mm256_min_ps (_mm256_set1_ps (1.0f), cos_angle)));
+}
+
+/** Increment the lanes of \a counts for which \a mask is set. */
+inline __m256i
+sacCount (const __m256i counts, const __m256 mask)
+{
+  return (_mm256_sub_epi32 (counts, _mm256_castps_si256 (mask)));
+}
+
+/** Sum of the eight lane counters. */
+inline std::size_t
+sacSum (const __m256i counts)
+{
+  const __m128i c = _mm_add_epi32 (_mm256_castsi256_si128 (counts), _mm256_extracti128_si256 (counts, 1));
+  return (sacSum (c));
+}
+
+/** Append the entries of \a indices at positions i to i + 7 for which \a mask is set, see the SSE
+  * version above. */
+inline void
+sacSelect (const __m256 mask, const __m256 distance, const std::size_t i, const Indices &indices,
+           Indices &inliers, std::vector<double> &distances)
+{
+  const int lanes = _mm256_movemask_ps (mask);
+  if (lanes == 0)
+    return;
+  alignas (32) float d[8];
+  _mm256_store_ps (d, distance);
+  for (int lane = 0; lane < 8; ++lane)
+    if (lanes & (1 << lane))
+    {
+      inliers.push_back (indices[i + lane]);
+      distances.push_back (static_cast<double> (d[lane]));
+    }
+}
+
+#endif // defined(__AVX__) && defined(__AVX2__)
+
+#if defined(__AVX512F__)
+
+/** Sixteen floats, where \a get returns the value of each lane. The points are scattered in
+  * memory, so they are read one by one as with _mm256_set_ps in the AVX2 version. */
+template <typename GetLane> inline __m512
+sacLoad (const GetLane &get)
+{
+  alignas (64) float v[16];
+  for (int lane = 0; lane < 16; ++lane)
+    v[lane] = get (lane);
+  return (_mm512_load_ps (v));
+}
+
+/** Absolute value of sixteen floats (clears the sign bit). */
+inline __m512
+sacAbs (const __m512 x)
+{
+  return (_mm512_abs_ps (x));
+}
+
+/** Arc cosine of sixteen values in [0, 1], see the SSE version above. */
+inline __m512
+sacAcosUnit (const __m512 x)
+{
+  __m512 p = _mm512_set1_ps (-0.0187293f);
+  p = _mm512_add_ps (_mm512_mul_ps (p, x), _mm512_set1_ps (0.0742610f));
+  p = _mm512_add_ps (_mm512_mul_ps (p, x), _mm512_set1_ps (-0.2121144f));
+  p = _mm512_add_ps (_mm512_mul_ps (p, x), _mm512_set1_ps (1.5707288f));
+  return (_mm512_mul_ps (_mm512_sqrt_ps (_mm512_sub_ps (_mm512_set1_ps (1.0f), x)), p));
+}
+
+/** Angle between two sets of vectors, folded into [0, pi/2], see the SSE version above. */
+inline __m512
+sacUnsignedAngle (const __m512 dot, const __m512 sqr_norms)
+{
+  const __mmask16 nonzero = _mm512_cmp_ps_mask (sqr_norms, _mm512_setzero_ps (), _CMP_NEQ_UQ);
+  const __m512 cos_angle = _mm512_maskz_mov_ps (nonzero, sacAbs (_mm512_div_ps (dot, _mm512_sqrt_ps (sqr_norms))));
+  return (sacAcosUnit (_mm512_min_ps (_mm512_set1_ps (1.0f), cos_angle)));
+}
+
+/** Increment the lanes of \a counts for which \a mask is set. */
+inline __m512i
+sacCount (const __m512i counts, const __mmask16 mask)
+{
+  return (_mm512_mask_add_epi32 (counts, mask, counts, _mm512_set1_epi32 (1)));
+}
+
+/** Sum of the sixteen lane counters. */
+inline std::size_t
+sacSum (const __m512i counts)
+{
+  return (static_cast<std::size_t> (_mm512_reduce_add_epi32 (counts)));
+}
+
+/** Append the entries of \a indices at positions i to i + 15 for which \a mask is set, see the SSE
+  * version above. */
+inline void
+sacSelect (const __mmask16 mask, const __m512 distance, const std::size_t i, const Indices &indices,
+           Indices &inliers, std::vector<double> &distances)
+{
+  const unsigned int lanes = mask;
+  if (lanes == 0)
+    return;
+  alignas (64) float d[16];
+  _mm512_store_ps (d, distance);
+  for (int lane = 0; lane < 16; ++lane)
+    if (lanes & (1u << lane))
+    {
+      inliers.push_back (indices[i + lane]);
+      distances.push_back (static_cast<double> (d[lane]));
+    }
+}
+
+#endif // defined(__AVX512F__)
+
+} // namespace detail
+
+} // namespace pcl
@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/eigen.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
+#include <pcl/sample_consensus/impl/sac_model_simd.hpp>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -169,33 +170,19 @@ pcl::SampleConsensusModelSphere<PointT>::selectWithinDistance (
     return;
   }
 
-  inliers.clear ();
-  error_sqr_dists_.clear ();
-  inliers.reserve (indices_->size ());
-  error_sqr_dists_.reserve (indices_->size ());
-
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  // Same distances as countWithinDistance, so that both agree on the inliers
+  this->selectWithinRanges ([&] (std::size_t begin, std::size_t end, Indices &range_inliers, std::vector<double> &range_distances)
   {
-    double distance = std::abs (std::sqrt (
-                          ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                          ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                          ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                          ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) +
-
-                          ( input_->points[(*indices_)[i]].z - model_coefficients[2] ) *
-                          ( input_->points[(*indices_)[i]].z - model_coefficients[2] )
-                          ) - model_coefficients[3]);
-    // Calculate the distance from the point to the sphere as the difference between
-    // dist(point,sphere_origin) and sphere_radius
-    if (distance < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (static_cast<double> (distance));
-    }
-  }
+#if defined (__AVX512F__)
+    countWithinDistanceAVX512 (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__AVX__) && defined (__AVX2__)
+    countWithinDistanceAVX (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#elif defined (__SSE2__)
+    countWithinDistanceSSE (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#else
+    countWithinDistanceStandard (model_coefficients, threshold, begin, end, &range_inliers, &range_distances);
+#endif
+  }, inliers);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -207,14 +194,34 @@ pcl::SampleConsensusModelSphere<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
+  return (this->countWithinRanges ([&] (std::size_t begin, std::size_t end)
+  {
+#if defined (__AVX512F__)
+    return (countWithinDistanceAVX512 (model_coefficients, threshold, begin, end));
+#elif defined (__AVX__) && defined (__AVX2__)
+    return (countWithinDistanceAVX (model_coefficients, threshold, begin, end));
+#elif defined (__SSE2__)
+    return (countWithinDistanceSSE (model_coefficients, threshold, begin, end));
+#else
+    return (countWithinDistanceStandard (model_coefficients, threshold, begin, end));
+#endif
+  }));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
   std::size_t nr_p = 0;
 
   // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (std::size_t i = begin; i < end; ++i)
   {
     // Calculate the distance from the point to the sphere as the difference between
     // dist(point,sphere_origin) and sphere_radius
-    if (std::abs (std::sqrt (
+    const double distance = std::abs (std::sqrt (
                         ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
                         ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
 
@@ -223,12 +230,120 @@ pcl::SampleConsensusModelSphere<PointT>::countWithinDistance (
 
                         ( input_->points[(*indices_)[i]].z - model_coefficients[2] ) *
                         ( input_->points[(*indices_)[i]].z - model_coefficients[2] )
-                        ) - model_coefficients[3]) < threshold)
+                        ) - model_coefficients[3]);
+    if (distance < threshold)
+    {
       nr_p++;
+      if (inliers)
+      {
+        inliers->push_back ((*indices_)[i]);
+        distances->push_back (distance);
+      }
+    }
   }
   return (nr_p);
 }
 
+#define AT(POS) (input_->points[(*indices_)[i + (POS)]])
+
+#if defined (__SSE2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceSSE (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m128 cx_vec = _mm_set1_ps (model_coefficients[0]);
+  const __m128 cy_vec = _mm_set1_ps (model_coefficients[1]);
+  const __m128 cz_vec = _mm_set1_ps (model_coefficients[2]);
+  const __m128 radius_vec = _mm_set1_ps (model_coefficients[3]);
+  const __m128 threshold_vec = _mm_set1_ps (static_cast<float> (threshold));
+  __m128i counts = _mm_setzero_si128 ();
+
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    const __m128 dx = _mm_sub_ps (_mm_set_ps (AT(3).x, AT(2).x, AT(1).x, AT(0).x), cx_vec);
+    const __m128 dy = _mm_sub_ps (_mm_set_ps (AT(3).y, AT(2).y, AT(1).y, AT(0).y), cy_vec);
+    const __m128 dz = _mm_sub_ps (_mm_set_ps (AT(3).z, AT(2).z, AT(1).z, AT(0).z), cz_vec);
+    // The distance is the difference between dist(point,sphere_origin) and sphere_radius
+    const __m128 sqr_dist = _mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy)), _mm_mul_ps (dz, dz));
+    const __m128 distance = pcl::detail::sacAbs (_mm_sub_ps (_mm_sqrt_ps (sqr_dist), radius_vec));
+    const __m128 mask = _mm_cmplt_ps (distance, threshold_vec);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceAVX (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m256 cx_vec = _mm256_set1_ps (model_coefficients[0]);
+  const __m256 cy_vec = _mm256_set1_ps (model_coefficients[1]);
+  const __m256 cz_vec = _mm256_set1_ps (model_coefficients[2]);
+  const __m256 radius_vec = _mm256_set1_ps (model_coefficients[3]);
+  const __m256 threshold_vec = _mm256_set1_ps (static_cast<float> (threshold));
+  __m256i counts = _mm256_setzero_si256 ();
+
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    const __m256 dx = _mm256_sub_ps (_mm256_set_ps (AT(7).x, AT(6).x, AT(5).x, AT(4).x, AT(3).x, AT(2).x, AT(1).x, AT(0).x), cx_vec);
+    const __m256 dy = _mm256_sub_ps (_mm256_set_ps (AT(7).y, AT(6).y, AT(5).y, AT(4).y, AT(3).y, AT(2).y, AT(1).y, AT(0).y), cy_vec);
+    const __m256 dz = _mm256_sub_ps (_mm256_set_ps (AT(7).z, AT(6).z, AT(5).z, AT(4).z, AT(3).z, AT(2).z, AT(1).z, AT(0).z), cz_vec);
+    // The distance is the difference between dist(point,sphere_origin) and sphere_radius
+    const __m256 sqr_dist = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dy, dy)), _mm256_mul_ps (dz, dz));
+    const __m256 distance = pcl::detail::sacAbs (_mm256_sub_ps (_mm256_sqrt_ps (sqr_dist), radius_vec));
+    const __m256 mask = _mm256_cmp_ps (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#if defined (__AVX512F__)
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceAVX512 (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t begin, std::size_t end,
+      Indices *inliers, std::vector<double> *distances) const
+{
+  const __m512 cx_vec = _mm512_set1_ps (model_coefficients[0]);
+  const __m512 cy_vec = _mm512_set1_ps (model_coefficients[1]);
+  const __m512 cz_vec = _mm512_set1_ps (model_coefficients[2]);
+  const __m512 radius_vec = _mm512_set1_ps (model_coefficients[3]);
+  const __m512 threshold_vec = _mm512_set1_ps (static_cast<float> (threshold));
+  __m512i counts = _mm512_setzero_si512 ();
+
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16)
+  {
+    const __m512 dx = _mm512_sub_ps (pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).x); }), cx_vec);
+    const __m512 dy = _mm512_sub_ps (pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).y); }), cy_vec);
+    const __m512 dz = _mm512_sub_ps (pcl::detail::sacLoad ([&] (int lane) { return (AT(lane).z); }), cz_vec);
+    // The distance is the difference between dist(point,sphere_origin) and sphere_radius
+    const __m512 sqr_dist = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (dx, dx), _mm512_mul_ps (dy, dy)), _mm512_mul_ps (dz, dz));
+    const __m512 distance = pcl::detail::sacAbs (_mm512_sub_ps (_mm512_sqrt_ps (sqr_dist), radius_vec));
+    const __mmask16 mask = _mm512_cmp_ps_mask (distance, threshold_vec, _CMP_LT_OQ);
+    counts = pcl::detail::sacCount (counts, mask);
+    if (inliers)
+      pcl::detail::sacSelect (mask, distance, i, *indices_, *inliers, *distances);
+  }
+  return (pcl::detail::sacSum (counts) + countWithinDistanceStandard (model_coefficients, threshold, i, end, inliers, distances));
+}
+#endif
+
+#undef AT
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelSphere<PointT>::optimizeModelCoefficients (
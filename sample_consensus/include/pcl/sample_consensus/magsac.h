@@ -0,0 +1,162 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/sample_consensus/sac.h>
+#include <pcl/sample_consensus/sac_model.h>
+
+namespace pcl
+{
+  /** \brief @b MagsacSampleConsensus represents an implementation of the MAGSAC++ algorithm, as described in:
+    * "MAGSAC++, a fast, reliable and accurate robust estimator", D. Barath, J. Noskova, M. Ivashechkin and
+    * J. Matas, CVPR 2020.
+    *
+    * Instead of counting the points within a fixed distance, every hypothesis is scored by a loss that is
+    * marginalized over the unknown noise scale sigma, from 0 up to a maximum sigma_max. The threshold set on
+    * this class is therefore not a hand-tuned inlier threshold but an upper bound: sigma_max is chosen such
+    * that \a threshold is the 99% quantile of the residuals of a point with noise sigma_max. Overestimating
+    * it only has a mild effect on the result.
+    *
+    * The best hypothesis is polished by repeated least-squares fits to the points below the threshold, which
+    * are kept as long as they decrease the marginalized loss. The returned inliers are the points within
+    * \a threshold of the final model.
+    * \note The residuals of most models are scalar distances, i.e. they have one degree of freedom. Registration
+    * models have three, which is detected from the model type. Other cases, such as the image-space residuals of
+    * SampleConsensusModelRegistration2D (two), should be set explicitly with setDegreesOfFreedom.
+    * \ingroup sample_consensus
+    */
+  template <typename PointT>
+  class MagsacSampleConsensus : public SampleConsensus<PointT>
+  {
+    using SampleConsensusModelPtr = typename SampleConsensusModel<PointT>::Ptr;
+
+    public:
+      using Ptr = shared_ptr<MagsacSampleConsensus<PointT> >;
+      using ConstPtr = shared_ptr<const MagsacSampleConsensus<PointT> >;
+
+      using SampleConsensus<PointT>::max_iterations_;
+      using SampleConsensus<PointT>::threshold_;
+      using SampleConsensus<PointT>::iterations_;
+      using SampleConsensus<PointT>::sac_model_;
+      using SampleConsensus<PointT>::model_;
+      using SampleConsensus<PointT>::model_coefficients_;
+      using SampleConsensus<PointT>::inliers_;
+      using SampleConsensus<PointT>::probability_;
+
+      /** \brief MAGSAC++ main constructor
+        * \param[in] model a Sample Consensus model
+        */
+      MagsacSampleConsensus (const SampleConsensusModelPtr &model)
+        : SampleConsensus<PointT> (model)
+        , degrees_of_freedom_ (0)
+        , max_refinement_iterations_ (10)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief MAGSAC++ main constructor
+        * \param[in] model a Sample Consensus model
+        * \param[in] threshold upper bound of the distance to model threshold
+        */
+      MagsacSampleConsensus (const SampleConsensusModelPtr &model, double threshold)
+        : SampleConsensus<PointT> (model, threshold)
+        , degrees_of_freedom_ (0)
+        , max_refinement_iterations_ (10)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief Set the number of degrees of freedom of the point-to-model residuals.
+        * \param[in] dof the degrees of freedom, or 0 (default) to derive them from the model type
+        */
+      inline void
+      setDegreesOfFreedom (unsigned int dof) { degrees_of_freedom_ = dof; }
+
+      /** \brief Get the number of degrees of freedom of the residuals (0 means derived from the model type). */
+      inline unsigned int
+      getDegreesOfFreedom () const { return (degrees_of_freedom_); }
+
+      /** \brief Set the maximum number of least-squares refinements applied to the best model.
+        * \param[in] iterations the maximum number of refinements (0 disables the refinement)
+        */
+      inline void
+      setMaxRefinementIterations (unsigned int iterations) { max_refinement_iterations_ = iterations; }
+
+      /** \brief Get the maximum number of least-squares refinements applied to the best model. */
+      inline unsigned int
+      getMaxRefinementIterations () const { return (max_refinement_iterations_); }
+
+      /** \brief Compute the actual model and find the inliers
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        */
+      bool
+      computeModel (int debug_verbosity_level = 0) override;
+
+    protected:
+      /** \brief Tabulate the normalized MAGSAC++ loss for the current threshold and degrees of freedom. */
+      void
+      initLossTable ();
+
+      /** \brief Compute the marginalized loss of a model, given its point-to-model distances.
+        * \param[in] distances the distances of all the points to the model
+        * \param[out] n_inliers the number of points within the threshold
+        */
+      double
+      computeLoss (const std::vector<double> &distances, std::size_t &n_inliers) const;
+
+    private:
+      /** \brief The degrees of freedom of the residuals, 0 if derived from the model type. */
+      unsigned int degrees_of_freedom_;
+
+      /** \brief The maximum number of least-squares refinements of the best model. */
+      unsigned int max_refinement_iterations_;
+
+      /** \brief The loss of a point, normalized to 1 for outliers, sampled uniformly in the squared
+        * distance on [0, threshold^2]. */
+      std::vector<double> loss_table_;
+
+      /** \brief Number of loss table entries per unit of squared distance. */
+      double loss_table_scale_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/sample_consensus/impl/magsac.hpp>
+#endif
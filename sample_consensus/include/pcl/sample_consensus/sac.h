@@ -44,8 +44,10 @@
 #include <pcl/sample_consensus/sac_model.h>
 #include <pcl/pcl_base.h>
 
+#include <cmath>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <set>
 
 namespace pcl
@@ -67,6 +69,21 @@ namespace pcl
       using Ptr = shared_ptr<SampleConsensus<T> >;
       using ConstPtr = shared_ptr<const SampleConsensus<T> >;
 
+      /** \brief Pre-tests which reject a model hypothesis after verifying a few random points, before
+        * it is scored against all the indices. See setHypothesisPretest.
+        */
+      enum HypothesisPretest
+      {
+        /** every hypothesis is scored against all the indices */
+        PRETEST_NONE,
+        /** T(d,d) test: all of d random points must be inliers, as described in "Randomized RANSAC with
+          * Td,d test", O. Chum and J. Matas, BMVC 2002 */
+        PRETEST_TDD,
+        /** Wald's sequential probability ratio test on random points, as described in "Optimal Randomized
+          * RANSAC", O. Chum and J. Matas, IEEE PAMI 30(8), 2008 */
+        PRETEST_SPRT
+      };
+
 
       /** \brief Constructor for base SAC.
         * \param[in] model a Sample Consensus model
@@ -79,6 +96,13 @@ namespace pcl
         , threshold_ (std::numeric_limits<double>::max ())
         , max_iterations_ (1000)
         , threads_ (-1)
+        , pretest_ (PRETEST_NONE)
+        , tdd_pretest_size_ (1)
+        , sprt_epsilon_ (0.1)
+        , sprt_delta_ (0.01)
+        , sprt_model_cost_ (200.0)
+        , sprt_epsilon_current_ (0.1)
+        , sprt_decision_threshold_ (std::numeric_limits<double>::max ())
         , rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
          // Create a random number generator object
@@ -102,6 +126,13 @@ namespace pcl
         , threshold_ (threshold)
         , max_iterations_ (1000)
         , threads_ (-1)
+        , pretest_ (PRETEST_NONE)
+        , tdd_pretest_size_ (1)
+        , sprt_epsilon_ (0.1)
+        , sprt_delta_ (0.01)
+        , sprt_model_cost_ (200.0)
+        , sprt_epsilon_current_ (0.1)
+        , sprt_decision_threshold_ (std::numeric_limits<double>::max ())
         , rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
          // Create a random number generator object
@@ -162,7 +193,7 @@ namespace pcl
       getProbability () const { return (probability_); }
 
       /** \brief Set the number of threads to use or turn off parallelization.
-        * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically, a negative number turns parallelization off)
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel, a negative number turns parallelization off)
         * \note Not all SAC methods have a parallel implementation. Some will ignore this setting.
         */
       inline void
@@ -172,6 +203,60 @@ namespace pcl
       inline int
       getNumberOfThreads () const { return (threads_); }
 
+      /** \brief Set the pre-test used to reject bad model hypotheses before they are scored against all indices.
+        * \param[in] pretest the pre-test to use (PRETEST_NONE by default)
+        * \note Used by RandomSampleConsensus, MEstimatorSampleConsensus and MaximumLikelihoodSampleConsensus.
+        * A pre-test may also reject some good hypotheses, so more iterations can be needed. It pays off when
+        * the inlier ratio is low and most hypotheses are bad.
+        */
+      inline void
+      setHypothesisPretest (HypothesisPretest pretest) { pretest_ = pretest; }
+
+      /** \brief Get the pre-test used to reject bad model hypotheses, as set by the user. */
+      inline HypothesisPretest
+      getHypothesisPretest () const { return (pretest_); }
+
+      /** \brief Set the number of random points d verified by the T(d,d) pre-test.
+        * \param[in] d the number of points that all have to be inliers (default: 1)
+        */
+      inline void
+      setTddPretestSize (unsigned int d) { tdd_pretest_size_ = d; }
+
+      /** \brief Get the number of random points verified by the T(d,d) pre-test. */
+      inline unsigned int
+      getTddPretestSize () const { return (tdd_pretest_size_); }
+
+      /** \brief Set the parameters of the SPRT pre-test.
+        * \param[in] epsilon initial estimate of the inlier ratio (default: 0.1), raised as better models are found
+        * \param[in] delta probability that a point is consistent with a bad model (default: 0.01)
+        * \param[in] model_cost time needed to compute one model hypothesis, in units of the time needed to verify one point (default: 200)
+        */
+      inline void
+      setSprtParameters (double epsilon, double delta, double model_cost = 200.0)
+      {
+        if (!(delta > 0.0 && delta < epsilon && epsilon < 1.0 && model_cost > 0.0))
+        {
+          PCL_ERROR ("[pcl::SampleConsensus::setSprtParameters] Invalid parameters (need 0 < delta < epsilon < 1 and model_cost > 0)!\n");
+          return;
+        }
+        sprt_epsilon_ = epsilon;
+        sprt_delta_ = delta;
+        sprt_model_cost_ = model_cost;
+      }
+
+      /** \brief Get the parameters of the SPRT pre-test, as set by the user.
+        * \param[out] epsilon initial estimate of the inlier ratio
+        * \param[out] delta probability that a point is consistent with a bad model
+        * \param[out] model_cost time needed to compute one model hypothesis, in units of the time needed to verify one point
+        */
+      inline void
+      getSprtParameters (double &epsilon, double &delta, double &model_cost) const
+      {
+        epsilon = sprt_epsilon_;
+        delta = sprt_delta_;
+        model_cost = sprt_model_cost_;
+      }
+
       /** \brief Compute the actual model. Pure virtual. */
       virtual bool 
       computeModel (int debug_verbosity_level = 0) = 0;
@@ -314,6 +399,109 @@ namespace pcl
       getModelCoefficients (Eigen::VectorXf &model_coefficients) const { model_coefficients = model_coefficients_; }
 
     protected:
+      /** \brief Reset the adaptive state of the hypothesis pre-test. Must be called at the start of computeModel. */
+      inline void
+      initHypothesisPretest ()
+      {
+        sprt_epsilon_current_ = sprt_epsilon_;
+        computeSprtDecisionThreshold ();
+      }
+
+      /** \brief Run the pre-test selected with setHypothesisPretest on a model hypothesis.
+        * This function is thread-safe: random numbers are drawn under the same lock as the samples of
+        * RandomSampleConsensus.
+        * \param[in] model_coefficients the model hypothesis
+        * \param[in] threshold the inlier distance threshold of the calling method
+        * \return false if the hypothesis was rejected and does not need to be scored
+        */
+      bool
+      pretestHypothesis (const Eigen::VectorXf &model_coefficients, double threshold)
+      {
+        if (pretest_ == PRETEST_NONE || sac_model_->getIndices ()->empty ())
+          return (true);
+
+        const IndicesPtr indices = sac_model_->getIndices ();
+        if (pretest_ == PRETEST_TDD)
+        {
+          std::set<index_t> subset;
+          {
+            std::lock_guard<std::mutex> lock (*samples_mutex_);
+            getRandomSamples (indices, (std::min) (static_cast<std::size_t> (tdd_pretest_size_), indices->size ()), subset);
+          }
+          return (sac_model_->doSamplesVerifyModel (subset, model_coefficients, threshold));
+        }
+
+        double epsilon, decision_threshold;
+        {
+          std::lock_guard<std::mutex> lock (*sprt_mutex_);
+          epsilon = sprt_epsilon_current_;
+          decision_threshold = sprt_decision_threshold_;
+        }
+        // Factors applied to the likelihood ratio p(x|bad model) / p(x|good model) for a consistent and an inconsistent point
+        const double consistent_factor = sprt_delta_ / epsilon;
+        const double inconsistent_factor = (1.0 - sprt_delta_) / (1.0 - epsilon);
+
+        // Positions in the index vector are drawn in batches to limit the number of locks
+        const std::size_t batch_size = 32;
+        std::vector<std::size_t> batch;
+        double likelihood_ratio = 1.0;
+        for (std::size_t i = 0; i < indices->size (); ++i)
+        {
+          if (i % batch_size == 0)
+          {
+            batch.resize ((std::min) (batch_size, indices->size () - i));
+            std::lock_guard<std::mutex> lock (*samples_mutex_);
+            for (auto &position : batch)
+              position = static_cast<std::size_t> (static_cast<double> (indices->size ()) * rnd ());
+          }
+          likelihood_ratio *= sac_model_->isInlierAt (batch[i % batch_size], model_coefficients, threshold) ? consistent_factor : inconsistent_factor;
+          // The hypothesis is most probably bad
+          if (likelihood_ratio > decision_threshold)
+            return (false);
+          // The hypothesis is most probably good, it is not worth testing more points
+          if (likelihood_ratio < 1.0 / decision_threshold)
+            return (true);
+        }
+        return (true);
+      }
+
+      /** \brief Let the hypothesis pre-test adapt to the support of a new best model.
+        * \param[in] n_inliers the number of inliers of the new best model
+        */
+      inline void
+      updateHypothesisPretest (std::size_t n_inliers)
+      {
+        if (pretest_ != PRETEST_SPRT || sac_model_->getIndices ()->empty ())
+          return;
+        // The estimate of the inlier ratio is only raised, and kept away from 1 where the test degenerates
+        const double epsilon = (std::min) (0.99, static_cast<double> (n_inliers) / static_cast<double> (sac_model_->getIndices ()->size ()));
+        {
+          std::lock_guard<std::mutex> lock (*sprt_mutex_);
+          if (epsilon > sprt_epsilon_current_)
+          {
+            sprt_epsilon_current_ = epsilon;
+            computeSprtDecisionThreshold ();
+          }
+        }
+      }
+
+      /** \brief Compute the decision threshold of the SPRT pre-test, which minimizes the expected run time,
+        * from the current estimate of the inlier ratio (equation 17 in Chum and Matas, PAMI 2008).
+        */
+      inline void
+      computeSprtDecisionThreshold ()
+      {
+        const double epsilon = sprt_epsilon_current_;
+        const double delta = sprt_delta_;
+        const double c = (1.0 - delta) * std::log ((1.0 - delta) / (1.0 - epsilon)) + delta * std::log (delta / epsilon);
+        const double k = sprt_model_cost_ * c + 1.0;
+        // Fixed point iteration A_{n+1} = k + log (A_n), which converges within a few steps
+        double decision_threshold = k;
+        for (int i = 0; i < 10; ++i)
+          decision_threshold = k + std::log (decision_threshold);
+        sprt_decision_threshold_ = decision_threshold;
+      }
+
       /** \brief The underlying data model used (i.e. what is it that we attempt to search for). */
       SampleConsensusModelPtr sac_model_;
 
@@ -341,6 +529,35 @@ namespace pcl
       /** \brief The number of threads the scheduler should use, or a negative number if no parallelization is wanted. */
       int threads_;
 
+      /** \brief The pre-test used to reject bad model hypotheses early. */
+      HypothesisPretest pretest_;
+
+      /** \brief The number of random points verified by the T(d,d) pre-test. */
+      unsigned int tdd_pretest_size_;
+
+      /** \brief Initial estimate of the inlier ratio used by the SPRT pre-test. */
+      double sprt_epsilon_;
+
+      /** \brief Probability that a point is consistent with a bad model, used by the SPRT pre-test. */
+      double sprt_delta_;
+
+      /** \brief Time needed to compute one model hypothesis, in units of the time needed to verify one point. */
+      double sprt_model_cost_;
+
+      /** \brief Current estimate of the inlier ratio used by the SPRT pre-test. */
+      double sprt_epsilon_current_;
+
+      /** \brief Current decision threshold of the SPRT pre-test. */
+      double sprt_decision_threshold_;
+
+      /** \brief Protects the random number generators when several hypotheses are computed concurrently. It is
+        * shared by the copies of the object, like the generators, and keeps the object copyable and movable.
+        */
+      std::shared_ptr<std::mutex> samples_mutex_ = std::make_shared<std::mutex> ();
+
+      /** \brief Protects the adaptive state of the SPRT pre-test. */
+      std::shared_ptr<std::mutex> sprt_mutex_ = std::make_shared<std::mutex> ();
+
       /** \brief Boost-based random number generator algorithm. */
       boost::mt19937 rng_alg_;
 
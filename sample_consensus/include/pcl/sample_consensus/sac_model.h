@@ -56,6 +56,7 @@
 #include <pcl/sample_consensus/model_types.h>
 
 #include <pcl/search/search.h>
+#include <pcl/common/parallel.h>
 
 namespace pcl
 {
@@ -89,6 +90,7 @@ namespace pcl
         , samples_radius_ (0.)
         , samples_radius_search_ ()
         , rng_dist_ (new boost::uniform_int<> (0, std::numeric_limits<int>::max ()))
+        , threads_ (-1)
       {
         // Create a random number generator object
         if (random)
@@ -111,6 +113,7 @@ namespace pcl
         , samples_radius_ (0.)
         , samples_radius_search_ ()
         , rng_dist_ (new boost::uniform_int<> (0, std::numeric_limits<int>::max ()))
+        , threads_ (-1)
       {
         if (random)
           rng_alg_.seed (static_cast<unsigned> (std::time (nullptr)));
@@ -139,6 +142,7 @@ namespace pcl
         , samples_radius_ (0.)
         , samples_radius_search_ ()
         , rng_dist_ (new boost::uniform_int<> (0, std::numeric_limits<int>::max ()))
+        , threads_ (-1)
       {
         if (random)
           rng_alg_.seed (static_cast<unsigned> (std::time(nullptr)));
@@ -288,6 +292,24 @@ namespace pcl
                             const Eigen::VectorXf &model_coefficients,
                             const double threshold) const = 0;
 
+      /** \brief Verify whether the point at a given position of the index vector is an inlier of a given set of
+        * model coefficients. This is what the SPRT hypothesis pre-test of SampleConsensus does for each point it
+        * draws, so the models override it to avoid the std::set of doSamplesVerifyModel, which this default
+        * implementation calls.
+        * \param[in] position the position of the point in the index vector
+        * \param[in] model_coefficients the set of model coefficients
+        * \param[in] threshold a maximum admissible distance threshold for
+        * determining the inliers from the outliers
+        */
+      virtual bool
+      isInlierAt (std::size_t position,
+                  const Eigen::VectorXf &model_coefficients,
+                  const double threshold) const
+      {
+        const std::set<index_t> sample = {(*indices_)[position]};
+        return (doSamplesVerifyModel (sample, model_coefficients, threshold));
+      }
+
       /** \brief Provide a pointer to the input dataset
         * \param[in] cloud the const boost shared pointer to a PointCloud message
         */
@@ -407,6 +429,18 @@ namespace pcl
         radius = samples_radius_;
       }
 
+      /** \brief Set the number of threads used to count the inliers of a single model hypothesis.
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel, a negative number turns parallelization off)
+        * \note When countWithinDistance is called by a RandomSampleConsensus that evaluates several hypotheses
+        * concurrently, both share the thread budget of pcl::parallel.
+        */
+      inline void
+      setNumberOfThreads (const int nr_threads = -1) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads used to count inliers, as set by the user. */
+      inline int
+      getNumberOfThreads () const { return (threads_); }
+
       friend class ProgressiveSampleConsensus<PointT>;
 
       /** \brief Compute the variance of the errors to the model.
@@ -496,6 +530,69 @@ namespace pcl
         std::copy (shuffled_indices_.begin (), shuffled_indices_.begin () + sample_size, sample.begin ());
       }
 
+      /** \brief Count the inliers over all indices_ by summing the results of \a count_range over
+        * consecutive chunks of the index vector. The chunks are processed with pcl::parallel if requested
+        * through setNumberOfThreads and if the index vector is large enough.
+        * \param[in] count_range a callable returning the number of inliers in [begin, end) of indices_
+        */
+      template <typename CountRange> std::size_t
+      countWithinRanges (const CountRange &count_range) const
+      {
+        const std::size_t nr_indices = indices_->size ();
+        const std::size_t min_points_per_chunk = getMinPointsPerChunk ();
+        if (threads_ < 0 || nr_indices < 2 * min_points_per_chunk)
+          return (count_range (0, nr_indices));
+        return (pcl::parallel::parallel_reduce (std::size_t (0), nr_indices, std::size_t (0), count_range,
+                                                [] (std::size_t a, std::size_t b) { return (a + b); },
+                                                static_cast<unsigned int> (threads_), min_points_per_chunk));
+      }
+
+      /** \brief Select the inliers over all indices_ with \a select_range, over the same chunks of the index vector
+        * as countWithinRanges. Each chunk fills buffers of its own, which are then concatenated in the order of the
+        * chunks, so the inliers keep the order of the index vector.
+        * \param[in] select_range a callable appending the inliers in [begin, end) of indices_ and their distances to
+        * the model, called as select_range (begin, end, inliers, distances)
+        * \param[out] inliers the resultant inliers; their distances are stored in error_sqr_dists_
+        */
+      template <typename SelectRange> void
+      selectWithinRanges (const SelectRange &select_range, Indices &inliers)
+      {
+        inliers.clear ();
+        error_sqr_dists_.clear ();
+        const std::size_t nr_indices = indices_->size ();
+        const std::size_t min_points_per_chunk = getMinPointsPerChunk ();
+        if (threads_ < 0 || nr_indices < 2 * min_points_per_chunk)
+        {
+          select_range (std::size_t (0), nr_indices, inliers, error_sqr_dists_);
+          return;
+        }
+
+        const std::size_t nr_chunks = (nr_indices + min_points_per_chunk - 1) / min_points_per_chunk;
+        std::vector<Indices> chunk_inliers (nr_chunks);
+        std::vector<std::vector<double> > chunk_distances (nr_chunks);
+        pcl::parallel::parallel_for (std::size_t (0), nr_indices, [&] (std::size_t first, std::size_t last)
+        {
+          const std::size_t chunk = first / min_points_per_chunk;
+          select_range (first, last, chunk_inliers[chunk], chunk_distances[chunk]);
+        }, static_cast<unsigned int> (threads_), min_points_per_chunk);
+
+        std::size_t nr_inliers = 0;
+        for (const auto &chunk : chunk_inliers)
+          nr_inliers += chunk.size ();
+        inliers.reserve (nr_inliers);
+        error_sqr_dists_.reserve (nr_inliers);
+        for (std::size_t chunk = 0; chunk < nr_chunks; ++chunk)
+        {
+          inliers.insert (inliers.end (), chunk_inliers[chunk].begin (), chunk_inliers[chunk].end ());
+          error_sqr_dists_.insert (error_sqr_dists_.end (), chunk_distances[chunk].begin (), chunk_distances[chunk].end ());
+        }
+      }
+
+      /** \brief Get the size of the chunks of the index vector for parallel inlier counting and selection: below
+        * this number of points per chunk, the threading overhead outweighs the gain. */
+      static constexpr std::size_t
+      getMinPointsPerChunk () { return (16384); }
+
       /** \brief Check whether a model is valid given the user constraints.
         *
         * Default implementation verifies that the number of coefficients in the supplied model is as expected for this
@@ -565,6 +662,9 @@ namespace pcl
       /** \brief The number of coefficients in the model. Every subclass should initialize this appropriately. */
       unsigned int model_size_;
 
+      /** \brief The number of threads used to count inliers, or a negative number if no parallelization is wanted. */
+      int threads_;
+
       /** \brief Boost-based random number generator. */
       inline int
       rnd ()
@@ -160,6 +160,71 @@ namespace pcl
       countWithinDistance (const Eigen::VectorXf &model_coefficients,
                            const double threshold) const override;
 
+      /** \brief Count the inliers among the indices in [begin, end) without SIMD instructions, and optionally select them.
+        * This is not intended for normal use; countWithinDistance and selectWithinDistance automatically pick the
+        * fastest implementation.
+        * \param[in] model_coefficients the coefficients of a model that we need to compute distances to
+        * \param[in] threshold a maximum admissible distance threshold for determining the inliers from the outliers
+        * \param[in] begin the first position in the index vector to consider
+        * \param[in] end one past the last position in the index vector to consider
+        * \param[out] inliers if not null, the inliers are appended to it in the order of the index vector
+        * \param[out] distances the distances of the inliers to the model are appended to it (if \a inliers is not null)
+        */
+      std::size_t
+      countWithinDistanceStandard (const Eigen::VectorXf &model_coefficients,
+                                   const double threshold,
+                                   std::size_t begin,
+                                   std::size_t end,
+                                   Indices *inliers = nullptr,
+                                   std::vector<double> *distances = nullptr) const;
+
+      /** \brief Verify whether the point at a given position of the index vector is an inlier, with the
+        * criterion of countWithinDistance.
+        * \param[in] position the position of the point in the index vector
+        * \param[in] model_coefficients the coefficients of a model that we need to compute distances to
+        * \param[in] threshold a maximum admissible distance threshold for determining the inliers from the outliers
+        */
+      bool
+      isInlierAt (std::size_t position,
+                  const Eigen::VectorXf &model_coefficients,
+                  const double threshold) const override
+      {
+        return (countWithinDistanceStandard (model_coefficients, threshold, position, position + 1) == 1);
+      }
+
+#if defined (__SSE2__)
+      /** \brief SSE2 version of countWithinDistanceStandard, processing four points at a time. */
+      std::size_t
+      countWithinDistanceSSE (const Eigen::VectorXf &model_coefficients,
+                              const double threshold,
+                              std::size_t begin,
+                              std::size_t end,
+                              Indices *inliers = nullptr,
+                              std::vector<double> *distances = nullptr) const;
+#endif
+
+#if defined (__AVX__) && defined (__AVX2__)
+      /** \brief AVX2 version of countWithinDistanceStandard, processing eight points at a time. */
+      std::size_t
+      countWithinDistanceAVX (const Eigen::VectorXf &model_coefficients,
+                              const double threshold,
+                              std::size_t begin,
+                              std::size_t end,
+                              Indices *inliers = nullptr,
+                              std::vector<double> *distances = nullptr) const;
+#endif
+
+#if defined (__AVX512F__)
+      /** \brief AVX-512 version of countWithinDistanceStandard, processing sixteen points at a time. */
+      std::size_t
+      countWithinDistanceAVX512 (const Eigen::VectorXf &model_coefficients,
+                                 const double threshold,
+                                 std::size_t begin,
+                                 std::size_t end,
+                                 Indices *inliers = nullptr,
+                                 std::vector<double> *distances = nullptr) const;
+#endif
+
        /** \brief Recompute the 2d circle coefficients using the given inlier set and return them to the user.
         * @note: these are the coefficients of the 2d circle model after refinement (e.g. after SVD)
         * \param[in] inliers the data inliers found as supporting the model
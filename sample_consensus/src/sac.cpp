@@ -42,6 +42,8 @@
 #include <pcl/sample_consensus/impl/prosac.hpp>
 #include <pcl/sample_consensus/impl/mlesac.hpp>
 #include <pcl/sample_consensus/impl/lmeds.hpp>
+#include <pcl/sample_consensus/impl/magsac.hpp>
+#include <pcl/sample_consensus/impl/gc_ransac.hpp>
 
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/impl/instantiate.hpp>
@@ -55,6 +57,8 @@
   PCL_INSTANTIATE(ProgressiveSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
   PCL_INSTANTIATE(MaximumLikelihoodSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
   PCL_INSTANTIATE(LeastMedianSquares, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
+  PCL_INSTANTIATE(MagsacSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
+  PCL_INSTANTIATE(GraphCutRandomSampleConsensus, (pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
 #else
   PCL_INSTANTIATE(RandomSampleConsensus, PCL_XYZ_POINT_TYPES)
   PCL_INSTANTIATE(MEstimatorSampleConsensus, PCL_XYZ_POINT_TYPES)
@@ -63,6 +67,8 @@
   PCL_INSTANTIATE(ProgressiveSampleConsensus, PCL_XYZ_POINT_TYPES)
   PCL_INSTANTIATE(MaximumLikelihoodSampleConsensus, PCL_XYZ_POINT_TYPES)
   PCL_INSTANTIATE(LeastMedianSquares, PCL_XYZ_POINT_TYPES)
+  PCL_INSTANTIATE(MagsacSampleConsensus, PCL_XYZ_POINT_TYPES)
+  PCL_INSTANTIATE(GraphCutRandomSampleConsensus, PCL_XYZ_POINT_TYPES)
 #endif
 #endif    // PCL_NO_PRECOMPILE
 
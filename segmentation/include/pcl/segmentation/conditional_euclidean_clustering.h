@@ -103,7 +103,8 @@ namespace pcl
           max_cluster_size_ (std::numeric_limits<int>::max ()),
           extract_removed_clusters_ (extract_removed_clusters),
           small_clusters_ (new pcl::IndicesClusters),
-          large_clusters_ (new pcl::IndicesClusters)
+          large_clusters_ (new pcl::IndicesClusters),
+          organized_window_radius_ (0)
       {
       }
 
@@ -205,6 +206,26 @@ namespace pcl
         return (max_cluster_size_);
       }
 
+      /** \brief Set the half size of the pixel window in which cluster candidates are looked for in organized clouds.
+        * \details A non-zero value replaces the search method by a union-find over the image for organized input clouds:
+        * any two points within the cluster tolerance and at most this number of rows and columns apart are merged if the
+        * condition holds for them. The condition is evaluated once per pair, with the point which comes first in the
+        * image as its first argument, so it should be symmetric.
+        * \param[in] window_radius The half size of the window (default = 0, i.e. the search method is used)
+        */
+      inline void
+      setOrganizedWindowRadius (unsigned int window_radius)
+      {
+        organized_window_radius_ = window_radius;
+      }
+
+      /** \brief Get the half size of the pixel window used for organized clouds (0 if it is disabled).*/
+      inline unsigned int
+      getOrganizedWindowRadius () const
+      {
+        return (organized_window_radius_);
+      }
+
       /** \brief Segment the input into separate clusters.
         * \details The input can be set using setInputCloud() and setIndices().
         * <br>
@@ -259,6 +280,9 @@ namespace pcl
       /** \brief The resultant clusters that contain more than max_cluster_size points */
       pcl::IndicesClustersPtr large_clusters_;
 
+      /** \brief The half size of the pixel window used for organized clouds (default = 0, i.e. disabled) */
+      unsigned int organized_window_radius_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
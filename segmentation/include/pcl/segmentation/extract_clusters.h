@@ -80,6 +80,62 @@ namespace pcl
       const typename search::Search<PointT>::Ptr &tree, float tolerance, std::vector<PointIndices> &clusters,
       unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
 
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, without a
+    * search structure and using several threads.
+    *
+    * The points are sorted by the packed key of their cell in a voxel grid whose cell size is the tolerance, so the
+    * neighbors of a point within the tolerance are in its own or one of the 26 adjacent cells, which are found by
+    * binary search in the sorted keys. Pairs of neighboring points are merged in parallel with a pcl::UnionFind.
+    * The clusters are the same as the ones of the search-based extractEuclideanClusters, in the same order, with
+    * their indices sorted.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads to use (default: 0, i.e. the whole thread budget of pcl::parallel)
+    * \note Non-finite points are not connected to any other point.
+    * \note A point listed several times in \a indices is clustered once, and counts once for the cluster sizes.
+    * \ingroup segmentation
+    */
+  template <typename PointT> void
+  extractEuclideanClustersVoxelGrid (
+      const PointCloud<PointT> &cloud, const std::vector<int> &indices,
+      float tolerance, std::vector<PointIndices> &clusters,
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 0);
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose an organized point cloud into clusters based on the Euclidean distance between points which
+    * are close in the image.
+    *
+    * Two points are connected if they are within the tolerance of each other and their pixels are at most
+    * \a window_radius rows and columns apart. The connected components are found with a union-find over the image,
+    * which runs in linear time and without a search structure. Points which are close in space but not in the image
+    * (e.g. across a depth discontinuity) are not connected, so a window large enough to cover the tolerance at the
+    * shortest range of the data should be used to get the same clusters as extractEuclideanClusters.
+    * \param cloud the organized point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param window_radius the half size of the pixel window in which neighbors are looked for (default: 1, i.e.
+    * the 8-neighborhood)
+    * \param nr_threads the number of threads to use (default: 1, 0 uses the pcl::parallel thread budget)
+    * \note The clusters are in the order of their first point in \a indices, with their indices sorted.
+    * Non-finite points are not connected to any other point.
+    * \ingroup segmentation
+    */
+  template <typename PointT> void
+  extractEuclideanClustersOrganized (
+      const PointCloud<PointT> &cloud, const std::vector<int> &indices,
+      float tolerance, std::vector<PointIndices> &clusters,
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int window_radius = 1, unsigned int nr_threads = 1);
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the euclidean distance between points, and the normal
     * angular deviation
@@ -311,7 +367,9 @@ namespace pcl
       EuclideanClusterExtraction () : tree_ (), 
                                       cluster_tolerance_ (0),
                                       min_pts_per_cluster_ (1), 
-                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ())
+                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ()),
+                                      threads_ (-1),
+                                      organized_window_radius_ (-1)
       {};
 
       /** \brief Provide a pointer to the search object.
@@ -380,6 +438,50 @@ namespace pcl
         return (max_pts_per_cluster_); 
       }
 
+      /** \brief Set the number of threads to use, which selects the parallel voxel grid implementation (see
+        * extractEuclideanClustersVoxelGrid) instead of the search method.
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel, a
+        * negative number uses the search method, which is the default)
+        * \note The voxel grid implementation only uses the xyz coordinates of the points, so it gives the same
+        * clusters as the default search methods, but ignores custom point representations.
+        */
+      inline void
+      setNumberOfThreads (int nr_threads = -1)
+      {
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads (a negative number if the search method is used). */
+      inline int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
+      /** \brief Set the half size of the pixel window in which the neighbors of a point are looked for in organized
+        * clouds. Organized input clouds are clustered with the image-based implementation (see
+        * extractEuclideanClustersOrganized) instead of the search method, unless it is disabled here.
+        * \param[in] window_radius the half size of the window: 0 disables the image-based implementation, and a
+        * negative value (the default) picks the number of pixels the cluster tolerance spans at the median distance
+        * between adjacent pixels of the input, up to 4
+        * \note Points which are within the tolerance of each other but farther apart than the window in the image,
+        * e.g. across a hole of invalid pixels, are not connected. Use a larger window, or 0 to use the search method,
+        * if that matters.
+        */
+      inline void
+      setOrganizedWindowRadius (int window_radius)
+      {
+        organized_window_radius_ = window_radius;
+      }
+
+      /** \brief Get the half size of the pixel window used for organized clouds (0 if the image-based implementation
+        * is disabled, a negative value if the window is picked from the data). */
+      inline int
+      getOrganizedWindowRadius () const
+      {
+        return (organized_window_radius_);
+      }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] clusters the resultant point clusters
         */
@@ -405,6 +507,16 @@ namespace pcl
       /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
       int max_pts_per_cluster_;
 
+      /** \brief The number of threads of the voxel grid implementation, or a negative number to use the search method. */
+      int threads_;
+
+      /** \brief The half size of the pixel window used for organized clouds, 0 to use the search method, or a negative
+        * value to pick it from the data. */
+      int organized_window_radius_;
+
+      /** \brief The largest pixel window radius picked from the data. */
+      static constexpr unsigned int max_organized_window_radius_ = 4;
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("EuclideanClusterExtraction"); }
 
@@ -38,6 +38,7 @@
 #define PCL_SEGMENTATION_IMPL_CONDITIONAL_EUCLIDEAN_CLUSTERING_HPP_
 
 #include <pcl/segmentation/conditional_euclidean_clustering.h>
+#include <pcl/segmentation/impl/extract_clusters.hpp>
 
 template<typename PointT> void
 pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clusters)
@@ -54,6 +55,34 @@ pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clus
   if (!initCompute () || input_->points.empty () || indices_->empty () || !condition_function_)
     return;
 
+  // Organized clouds are clustered by connecting the points which are close in the image
+  if (organized_window_radius_ > 0 && input_->isOrganized ())
+  {
+    pcl::UnionFind sets;
+    pcl::detail::uniteOrganizedNeighbors (*input_, *indices_, cluster_tolerance_, organized_window_radius_, condition_function_, sets, 1);
+    IndicesClusters components;
+    pcl::detail::collectSets (*indices_, sets, components);
+    for (auto &component : components)
+    {
+      component.header = input_->header;
+      const int cluster_size = static_cast<int> (component.indices.size ());
+      if (cluster_size < min_cluster_size_)
+      {
+        if (extract_removed_clusters_)
+          small_clusters_->push_back (std::move (component));
+      }
+      else if (cluster_size > max_cluster_size_)
+      {
+        if (extract_removed_clusters_)
+          large_clusters_->push_back (std::move (component));
+      }
+      else
+        clusters.push_back (std::move (component));
+    }
+    deinitCompute ();
+    return;
+  }
+
   // Initialize the search class
   if (!searcher_)
   {
@@ -39,6 +39,13 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include <pcl/segmentation/extract_clusters.h>
+#include <pcl/segmentation/union_find.h>
+#include <pcl/common/parallel.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -202,6 +209,347 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClustersVoxelGrid (const PointCloud<PointT> &cloud,
+                                        const std::vector<int> &indices,
+                                        float tolerance, std::vector<PointIndices> &clusters,
+                                        unsigned int min_pts_per_cluster,
+                                        unsigned int max_pts_per_cluster,
+                                        unsigned int nr_threads)
+{
+  if (!(tolerance > 0.0f))
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersVoxelGrid] Invalid cluster tolerance %f!\n", tolerance);
+    return;
+  }
+  // Like in the search-based version, a point listed several times in indices is clustered, and counted, once
+  std::vector<bool> listed (cloud.points.size (), false);
+  std::vector<int> unique_indices;
+  unique_indices.reserve (indices.size ());
+  for (const int &index : indices)
+  {
+    if (listed[index])
+      continue;
+    listed[index] = true;
+    unique_indices.push_back (index);
+  }
+  const int n = static_cast<int> (unique_indices.size ());
+  if (n == 0)
+    return;
+  const float inv_tolerance = 1.0f / tolerance;
+  const float sqr_tolerance = tolerance * tolerance;
+
+  // Bounding box of the finite points, in cells
+  Eigen::Array3f min_p = Eigen::Array3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Array3f max_p = Eigen::Array3f::Constant (std::numeric_limits<float>::lowest ());
+  for (const int &index : unique_indices)
+  {
+    const PointT &point = cloud.points[index];
+    if (!isFinite (point))
+      continue;
+    min_p = min_p.min (point.getArray3fMap ());
+    max_p = max_p.max (point.getArray3fMap ());
+  }
+  const Eigen::Array3f min_cell = (min_p * inv_tolerance).floor ();
+  // Cells are numbered from 1, so that the neighbors of every cell have non-negative coordinates
+  const std::uint64_t max_cell = (1ull << 21) - 2;
+  if ((min_p <= max_p).all () && ((max_p * inv_tolerance).floor () - min_cell >= static_cast<float> (max_cell)).any ())
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersVoxelGrid] Cluster tolerance %f is too small for the input dataset!\n", tolerance);
+    return;
+  }
+
+  // Cell of every point, packed into 21 bits per axis. Sorting by these keys puts the cells in x, y, z
+  // order, so the 3 cells (x, y, z - 1), (x, y, z) and (x, y, z + 1) are always contiguous.
+  // Non-finite points get the largest key and are never connected.
+  const std::uint64_t invalid_key = std::numeric_limits<std::uint64_t>::max ();
+  const auto cell_key = [] (const std::uint64_t x, const std::uint64_t y, const std::uint64_t z)
+  {
+    return ((x << 42) | (y << 21) | z);
+  };
+  std::vector<std::pair<std::uint64_t, int> > keys (unique_indices.size ());
+  pcl::parallel::parallel_for (0, n, [&] (int first, int last)
+  {
+    for (int i = first; i < last; ++i)
+    {
+      const PointT &point = cloud.points[unique_indices[i]];
+      if (!isFinite (point))
+      {
+        keys[i] = std::make_pair (invalid_key, i);
+        continue;
+      }
+      const Eigen::Array3f cell = (point.getArray3fMap () * inv_tolerance).floor () - min_cell + 1.0f;
+      keys[i] = std::make_pair (cell_key (static_cast<std::uint64_t> (cell[0]), static_cast<std::uint64_t> (cell[1]),
+                                          static_cast<std::uint64_t> (cell[2])), i);
+    }
+  }, nr_threads);
+  std::sort (keys.begin (), keys.end ());
+
+  // The coordinates are copied in cell order, so that the candidate neighbors of a point are read from
+  // contiguous memory, and the occupied cells are listed with the range of their points.
+  std::vector<Eigen::Vector3f> sorted_points (unique_indices.size ());
+  std::vector<std::uint64_t> cell_keys;
+  std::vector<int> cell_start;
+  int nr_finite = 0;
+  for (; nr_finite < n && keys[nr_finite].first != invalid_key; ++nr_finite)
+  {
+    sorted_points[nr_finite] = cloud.points[unique_indices[keys[nr_finite].second]].getVector3fMap ();
+    if (cell_keys.empty () || cell_keys.back () != keys[nr_finite].first)
+    {
+      cell_keys.push_back (keys[nr_finite].first);
+      cell_start.push_back (nr_finite);
+    }
+  }
+  cell_start.push_back (nr_finite);
+  const int nr_cells = static_cast<int> (cell_keys.size ());
+
+  // The union-find works on the points in cell order, where neighbors are close in memory
+  UnionFind sets (unique_indices.size ());
+
+  // Connect every point to its neighbors within the tolerance. They are in the 3x3 columns of 3 cells
+  // around its own cell, which are looked up once per cell.
+  const std::uint64_t mask = (1ull << 21) - 1;
+  pcl::parallel::parallel_for (0, nr_cells, [&] (int first_cell, int last_cell)
+  {
+    for (int c = first_cell; c < last_cell; ++c)
+    {
+      const std::uint64_t x = cell_keys[c] >> 42, y = (cell_keys[c] >> 21) & mask, z = cell_keys[c] & mask;
+      int range_begin[9], range_end[9];
+      for (int d = 0; d < 9; ++d)
+      {
+        const std::uint64_t column = cell_key (x + d / 3 - 1, y + d % 3 - 1, 0);
+        const auto first = std::lower_bound (cell_keys.cbegin (), cell_keys.cend (), column | (z - 1));
+        auto last = first;
+        while (last != cell_keys.cend () && *last <= (column | (z + 1)))
+          ++last;
+        range_begin[d] = cell_start[first - cell_keys.cbegin ()];
+        range_end[d] = cell_start[last - cell_keys.cbegin ()];
+      }
+
+      for (int s = cell_start[c]; s < cell_start[c + 1]; ++s)
+      {
+        const Eigen::Vector3f &point = sorted_points[s];
+        // Every pair of points is tested once, from the point which comes first in cell order
+        for (int d = 0; d < 9; ++d)
+          for (int t = (std::max) (range_begin[d], s + 1); t < range_end[d]; ++t)
+            if ((sorted_points[t] - point).squaredNorm () <= sqr_tolerance)
+              sets.unite (s, t);
+      }
+    }
+  }, nr_threads, 64);
+
+  std::vector<int> roots (unique_indices.size ());
+  pcl::parallel::parallel_for (0, n, [&] (int first, int last)
+  {
+    for (int s = first; s < last; ++s)
+      roots[keys[s].second] = sets.find (s);
+  }, nr_threads);
+
+  // Number the sets in the order of their first point in indices, which is the order in which the
+  // search-based version finds the clusters
+  std::vector<int> set_ids (unique_indices.size (), -1);
+  std::vector<int> cluster_ids (unique_indices.size ());
+  std::vector<unsigned int> cluster_sizes;
+  for (int i = 0; i < n; ++i)
+  {
+    int &set_id = set_ids[roots[i]];
+    if (set_id < 0)
+    {
+      set_id = static_cast<int> (cluster_sizes.size ());
+      cluster_sizes.push_back (0);
+    }
+    cluster_ids[i] = set_id;
+    ++cluster_sizes[set_id];
+  }
+
+  std::vector<int> output_ids (cluster_sizes.size (), -1);
+  const std::size_t first_cluster = clusters.size ();
+  for (std::size_t c = 0; c < cluster_sizes.size (); ++c)
+  {
+    if (cluster_sizes[c] < min_pts_per_cluster || cluster_sizes[c] > max_pts_per_cluster)
+      continue;
+    output_ids[c] = static_cast<int> (clusters.size ());
+    clusters.emplace_back ();
+    clusters.back ().header = cloud.header;
+    clusters.back ().indices.reserve (cluster_sizes[c]);
+  }
+  for (int i = 0; i < n; ++i)
+  {
+    const int output_id = output_ids[cluster_ids[i]];
+    if (output_id >= 0)
+      clusters[output_id].indices.push_back (unique_indices[i]);
+  }
+  for (std::size_t c = first_cluster; c < clusters.size (); ++c)
+  {
+    std::vector<int> &cluster = clusters[c].indices;
+    std::sort (cluster.begin (), cluster.end ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Merge the sets of the points of an organized cloud which are within the tolerance of each other, at
+      * most \a window_radius rows and columns apart in the image, and for which \a condition holds.
+      * \param[in] cloud the organized point cloud
+      * \param[in] indices the points to use from \a cloud, the other ones are never merged
+      * \param[in] tolerance the spatial tolerance
+      * \param[in] window_radius the half size of the pixel window
+      * \param[in] condition a predicate on (point, neighbor, squared distance), called for the neighbors which come
+      * after the point in the image
+      * \param[out] sets the disjoint sets of the points of \a cloud
+      * \param[in] nr_threads the number of threads to use
+      */
+    template <typename PointT, typename Condition> void
+    uniteOrganizedNeighbors (const PointCloud<PointT> &cloud, const std::vector<int> &indices,
+                             float tolerance, unsigned int window_radius, const Condition &condition,
+                             UnionFind &sets, unsigned int nr_threads)
+    {
+      const int width = static_cast<int> (cloud.width);
+      const int height = static_cast<int> (cloud.height);
+      const int radius = static_cast<int> (window_radius);
+      const float sqr_tolerance = tolerance * tolerance;
+
+      std::vector<char> valid (cloud.points.size (), 0);
+      for (const int &index : indices)
+        if (index >= 0 && isFinite (cloud.points[index]))
+          valid[index] = 1;
+
+      sets.reset (cloud.points.size ());
+      pcl::parallel::parallel_for (0, height, [&] (int first_row, int last_row)
+      {
+        for (int v = first_row; v < last_row; ++v)
+        {
+          for (int u = 0; u < width; ++u)
+          {
+            const int a = v * width + u;
+            if (!valid[a])
+              continue;
+            const PointT &point = cloud.points[a];
+            // Only the pixels after the current one are visited, so that every pair is tested once
+            for (int dv = 0; dv <= radius && v + dv < height; ++dv)
+            {
+              for (int du = (dv == 0 ? 1 : -radius); du <= radius; ++du)
+              {
+                if (u + du < 0 || u + du >= width)
+                  continue;
+                const int b = a + dv * width + du;
+                if (!valid[b])
+                  continue;
+                const float sqr_distance = (cloud.points[b].getVector3fMap () - point.getVector3fMap ()).squaredNorm ();
+                if (sqr_distance <= sqr_tolerance && condition (point, cloud.points[b], sqr_distance))
+                  sets.unite (a, b);
+              }
+            }
+          }
+        }
+      }, nr_threads);
+    }
+
+    /** \brief Pick the pixel window of extractEuclideanClustersOrganized for a cloud: the number of pixels the
+      * tolerance spans at the median distance between adjacent (finite) pixels, within [1, \a max_window_radius].
+      * \param[in] cloud the organized point cloud
+      * \param[in] indices the points to use from \a cloud
+      * \param[in] tolerance the spatial tolerance
+      * \param[in] max_window_radius the largest window radius to return
+      */
+    template <typename PointT> unsigned int
+    getOrganizedWindowRadius (const PointCloud<PointT> &cloud, const std::vector<int> &indices,
+                              float tolerance, unsigned int max_window_radius)
+    {
+      const std::size_t width = cloud.width;
+      std::vector<char> valid (cloud.points.size (), 0);
+      for (const int &index : indices)
+        if (index >= 0 && isFinite (cloud.points[index]))
+          valid[index] = 1;
+
+      std::vector<float> spacings;
+      for (std::size_t a = 0; a < cloud.points.size (); ++a)
+      {
+        if (!valid[a])
+          continue;
+        if ((a + 1) % width != 0 && valid[a + 1])
+          spacings.push_back ((cloud.points[a + 1].getVector3fMap () - cloud.points[a].getVector3fMap ()).norm ());
+        if (a + width < cloud.points.size () && valid[a + width])
+          spacings.push_back ((cloud.points[a + width].getVector3fMap () - cloud.points[a].getVector3fMap ()).norm ());
+      }
+      if (spacings.empty ())
+        return (1);
+      auto median = spacings.begin () + spacings.size () / 2;
+      std::nth_element (spacings.begin (), median, spacings.end ());
+      if (!(*median > 0.0f))
+        return (max_window_radius);
+      const float window_radius = std::ceil (tolerance / *median);
+      return (window_radius >= static_cast<float> (max_window_radius) ? max_window_radius :
+              (std::max) (1u, static_cast<unsigned int> (window_radius)));
+    }
+
+    /** \brief Gather the points of \a indices by set, in the order of the first point of every set in \a indices.
+      * The indices of every cluster are sorted, and duplicates as well as negative indices are dropped.
+      */
+    inline void
+    collectSets (const std::vector<int> &indices, UnionFind &sets, std::vector<PointIndices> &clusters)
+    {
+      clusters.clear ();
+      std::vector<int> cluster_ids (sets.size (), -1);
+      std::vector<char> collected (sets.size (), 0);
+      for (const int &index : indices)
+      {
+        if (index < 0 || collected[index])
+          continue;
+        collected[index] = 1;
+        int &cluster_id = cluster_ids[sets.find (index)];
+        if (cluster_id < 0)
+        {
+          cluster_id = static_cast<int> (clusters.size ());
+          clusters.emplace_back ();
+        }
+        clusters[cluster_id].indices.push_back (index);
+      }
+      for (auto &cluster : clusters)
+        std::sort (cluster.indices.begin (), cluster.indices.end ());
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClustersOrganized (const PointCloud<PointT> &cloud,
+                                        const std::vector<int> &indices,
+                                        float tolerance, std::vector<PointIndices> &clusters,
+                                        unsigned int min_pts_per_cluster,
+                                        unsigned int max_pts_per_cluster,
+                                        unsigned int window_radius,
+                                        unsigned int nr_threads)
+{
+  if (!cloud.isOrganized ())
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersOrganized] The input cloud is not organized!\n");
+    return;
+  }
+  if (!(tolerance > 0.0f) || window_radius == 0)
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersOrganized] Invalid cluster tolerance %f or window radius %u!\n", tolerance, window_radius);
+    return;
+  }
+
+  UnionFind sets;
+  detail::uniteOrganizedNeighbors (cloud, indices, tolerance, window_radius,
+                                   [] (const PointT&, const PointT&, float) { return (true); }, sets, nr_threads);
+  std::vector<PointIndices> components;
+  detail::collectSets (indices, sets, components);
+  for (auto &component : components)
+  {
+    if (component.indices.size () < min_pts_per_cluster || component.indices.size () > max_pts_per_cluster)
+      continue;
+    component.header = cloud.header;
+    clusters.push_back (std::move (component));
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -217,6 +565,28 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
     return;
   }
 
+  if (organized_window_radius_ != 0 && input_->isOrganized ())
+  {
+    const float tolerance = static_cast<float> (cluster_tolerance_);
+    const unsigned int window_radius = organized_window_radius_ > 0 ? static_cast<unsigned int> (organized_window_radius_) :
+                                       detail::getOrganizedWindowRadius (*input_, *indices_, tolerance, max_organized_window_radius_);
+    extractEuclideanClustersOrganized (*input_, *indices_, tolerance, clusters, min_pts_per_cluster_, max_pts_per_cluster_,
+                                       window_radius, threads_ < 0 ? 1u : static_cast<unsigned int> (threads_));
+    // Sort the clusters based on their size (largest one first)
+    std::sort (clusters.rbegin (), clusters.rend (), comparePointClusters);
+    deinitCompute ();
+    return;
+  }
+
+  if (threads_ >= 0)
+  {
+    extractEuclideanClustersVoxelGrid (*input_, *indices_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
+    // Sort the clusters based on their size (largest one first)
+    std::sort (clusters.rbegin (), clusters.rend (), comparePointClusters);
+    deinitCompute ();
+    return;
+  }
+
   // Initialize the spatial locator
   if (!tree_)
   {
@@ -241,6 +611,8 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
 #define PCL_INSTANTIATE_EuclideanClusterExtraction(T) template class PCL_EXPORTS pcl::EuclideanClusterExtraction<T>;
 #define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClustersVoxelGrid(T) template void PCL_EXPORTS pcl::extractEuclideanClustersVoxelGrid<T>(const pcl::PointCloud<T> &, const std::vector<int> &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClustersOrganized(T) template void PCL_EXPORTS pcl::extractEuclideanClustersOrganized<T>(const pcl::PointCloud<T> &, const std::vector<int> &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int, unsigned int);
 #define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
 
 #endif        // PCL_EXTRACT_CLUSTERS_IMPL_H_
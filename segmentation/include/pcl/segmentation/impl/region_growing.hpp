@@ -43,10 +43,14 @@
 
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#include <pcl/common/parallel.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
+#include <pcl/segmentation/union_find.h>
 
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <list>
 #include <cmath>
@@ -71,7 +75,9 @@ pcl::RegionGrowing<PointT, NormalT>::RegionGrowing () :
   normal_flag_ (true),
   num_pts_in_segment_ (0),
   clusters_ (0),
-  number_of_segments_ (0)
+  number_of_segments_ (0),
+  union_find_flag_ (false),
+  threads_ (1)
 {
 }
 
@@ -245,6 +251,34 @@ pcl::RegionGrowing<PointT, NormalT>::setInputNormals (const NormalPtr& norm)
   normals_ = norm;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> bool
+pcl::RegionGrowing<PointT, NormalT>::getUnionFindFlag () const
+{
+  return (union_find_flag_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setUnionFindFlag (bool value)
+{
+  union_find_flag_ = value;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> unsigned int
+pcl::RegionGrowing<PointT, NormalT>::getNumberOfThreads () const
+{
+  return (threads_);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::extract (std::vector <pcl::PointIndices>& clusters)
@@ -343,32 +377,23 @@ template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::findPointNeighbours ()
 {
   int point_number = static_cast<int> (indices_->size ());
-  std::vector<int> neighbours;
-  std::vector<float> distances;
 
-  point_neighbours_.resize (input_->points.size (), neighbours);
-  if (input_->is_dense)
-  {
-    for (int i_point = 0; i_point < point_number; i_point++)
-    {
-      int point_index = (*indices_)[i_point];
-      neighbours.clear ();
-      search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
-    }
-  }
-  else
+  point_neighbours_.resize (input_->points.size ());
+  // The points are searched independently, each one writing its own list
+  pcl::parallel::parallel_for (0, point_number, [this] (int first, int last)
   {
-    for (int i_point = 0; i_point < point_number; i_point++)
+    std::vector<int> neighbours;
+    std::vector<float> distances;
+    for (int i_point = first; i_point < last; i_point++)
     {
-      neighbours.clear ();
       int point_index = (*indices_)[i_point];
-      if (!pcl::isFinite (input_->points[point_index]))
+      if (!input_->is_dense && !pcl::isFinite (input_->points[point_index]))
         continue;
+      neighbours.clear ();
       search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
       point_neighbours_[point_index].swap (neighbours);
     }
-  }
+  }, threads_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -401,6 +426,17 @@ pcl::RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm ()
       point_residual[i_point].second = point_index;
     }
   }
+
+  if (union_find_flag_)
+  {
+    if (!residual_flag_ && (smooth_mode_flag_ || !normal_flag_))
+    {
+      applyUnionFindAlgorithm (point_residual);
+      return;
+    }
+    PCL_WARN ("[pcl::RegionGrowing::applySmoothRegionGrowingAlgorithm] The union-find mode requires the smoothness constraint and no residual test, growing the segments sequentially.\n");
+  }
+
   int seed_counter = 0;
   int seed = point_residual[seed_counter].second;
 
@@ -428,6 +464,129 @@ pcl::RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm ()
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::applyUnionFindAlgorithm (const std::vector<std::pair<float, int> >& seeds)
+{
+  const int num_of_pts = static_cast<int> (seeds.size ());
+  const int no_segment = std::numeric_limits<int>::max ();
+
+  // Find out which points can serve as seeds. Since this does not depend on the point that reached them, any
+  // point will do
+  std::vector<char> is_a_seed (input_->points.size (), 0);
+  pcl::parallel::parallel_for (0, num_of_pts, [this, &is_a_seed] (int first, int last)
+  {
+    for (int i_point = first; i_point < last; i_point++)
+    {
+      const int point_index = (*indices_)[i_point];
+      bool seed = false;
+      validatePoint (point_index, point_index, point_index, seed);
+      is_a_seed[point_index] = seed;
+    }
+  }, threads_);
+
+  // Merge the seeds that grow into each other
+  pcl::UnionFind sets (input_->points.size ());
+  pcl::parallel::parallel_for (0, num_of_pts, [this, &is_a_seed, &sets] (int first, int last)
+  {
+    for (int i_point = first; i_point < last; i_point++)
+    {
+      const int point_index = (*indices_)[i_point];
+      if (!is_a_seed[point_index])
+        continue;
+      const std::vector<int>& neighbours = point_neighbours_[point_index];
+      for (std::size_t i_nghbr = 0; i_nghbr < neighbour_number_ && i_nghbr < neighbours.size (); i_nghbr++)
+      {
+        const int index = neighbours[i_nghbr];
+        bool seed = false;
+        if (index != point_index && is_a_seed[index] && validatePoint (point_index, point_index, index, seed))
+          sets.unite (point_index, index);
+      }
+    }
+  }, threads_);
+
+  // The segments are numbered in the order of their first seed, like the sequential algorithm does
+  std::vector<int> roots (input_->points.size (), -1);
+  pcl::parallel::parallel_for (0, num_of_pts, [this, &is_a_seed, &sets, &roots] (int first, int last)
+  {
+    for (int i_point = first; i_point < last; i_point++)
+    {
+      const int point_index = (*indices_)[i_point];
+      if (is_a_seed[point_index])
+        roots[point_index] = sets.find (point_index);
+    }
+  }, threads_);
+
+  std::vector<int> root_segment (input_->points.size (), -1);
+  int number_of_segments = 0;
+  for (const auto& seed : seeds)
+  {
+    const int root = roots[seed.second];
+    if (root == -1)
+      continue;
+    if (root_segment[root] == -1)
+    {
+      root_segment[root] = number_of_segments++;
+      num_pts_in_segment_.push_back (0);
+    }
+    point_labels_[seed.second] = root_segment[root];
+    num_pts_in_segment_[root_segment[root]]++;
+  }
+
+  // Each remaining point joins the first segment that reaches it
+  std::unique_ptr<std::atomic<int>[]> first_segment (new std::atomic<int>[input_->points.size ()]);
+  for (std::size_t i_point = 0; i_point < input_->points.size (); i_point++)
+    first_segment[i_point].store (no_segment, std::memory_order_relaxed);
+  pcl::parallel::parallel_for (0, num_of_pts, [this, &is_a_seed, &first_segment] (int first, int last)
+  {
+    for (int i_point = first; i_point < last; i_point++)
+    {
+      const int point_index = (*indices_)[i_point];
+      if (!is_a_seed[point_index])
+        continue;
+      const int segment = point_labels_[point_index];
+      const std::vector<int>& neighbours = point_neighbours_[point_index];
+      for (std::size_t i_nghbr = 0; i_nghbr < neighbour_number_ && i_nghbr < neighbours.size (); i_nghbr++)
+      {
+        const int index = neighbours[i_nghbr];
+        bool seed = false;
+        if (is_a_seed[index] || !validatePoint (point_index, point_index, index, seed))
+          continue;
+        int current = first_segment[index].load (std::memory_order_relaxed);
+        while (segment < current &&
+               !first_segment[index].compare_exchange_weak (current, segment, std::memory_order_relaxed));
+      }
+    }
+  }, threads_);
+
+  int segmented_pts_num = 0;
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    const int point_index = (*indices_)[i_point];
+    const int segment = first_segment[point_index].load (std::memory_order_relaxed);
+    if (segment != no_segment)
+    {
+      point_labels_[point_index] = segment;
+      num_pts_in_segment_[segment]++;
+    }
+    if (point_labels_[point_index] != -1)
+      segmented_pts_num++;
+  }
+
+  // The points that were not reached start segments of their own, which only grow over the points that were not
+  // reached either
+  for (int i_seed = 0; i_seed < num_of_pts && segmented_pts_num < num_of_pts; i_seed++)
+  {
+    const int index = seeds[i_seed].second;
+    if (point_labels_[index] != -1)
+      continue;
+    const int pts_in_segment = growRegion (index, number_of_segments);
+    segmented_pts_num += pts_in_segment;
+    num_pts_in_segment_.push_back (pts_in_segment);
+    number_of_segments++;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> int
 pcl::RegionGrowing<PointT, NormalT>::growRegion (int initial_seed, int segment_number)
@@ -41,9 +41,11 @@
 #define PCL_SEGMENTATION_REGION_GROWING_RGB_HPP_
 
 #include <pcl/segmentation/region_growing_rgb.h>
+#include <pcl/common/parallel.h>
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
 
+#include <algorithm>
 #include <queue>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -272,49 +274,53 @@ template <typename PointT, typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::findPointNeighbours ()
 {
   int point_number = static_cast<int> (indices_->size ());
-  std::vector<int> neighbours;
-  std::vector<float> distances;
 
-  point_neighbours_.resize (input_->points.size (), neighbours);
-  point_distances_.resize (input_->points.size (), distances);
+  point_neighbours_.resize (input_->points.size ());
+  point_distances_.resize (input_->points.size ());
 
-  for (int i_point = 0; i_point < point_number; i_point++)
+  // The same neighbours serve for growing the segments and for finding the neighbouring segments
+  pcl::parallel::parallel_for (0, point_number, [this] (int first, int last)
   {
-    int point_index = (*indices_)[i_point];
-    neighbours.clear ();
-    distances.clear ();
-    search_->nearestKSearch (i_point, region_neighbour_number_, neighbours, distances);
-    point_neighbours_[point_index].swap (neighbours);
-    point_distances_[point_index].swap (distances);
-  }
+    std::vector<int> neighbours;
+    std::vector<float> distances;
+    for (int i_point = first; i_point < last; i_point++)
+    {
+      int point_index = (*indices_)[i_point];
+      neighbours.clear ();
+      distances.clear ();
+      search_->nearestKSearch (i_point, region_neighbour_number_, neighbours, distances);
+      point_neighbours_[point_index].swap (neighbours);
+      point_distances_[point_index].swap (distances);
+    }
+  }, threads_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::findSegmentNeighbours ()
 {
-  std::vector<int> neighbours;
-  std::vector<float> distances;
-  segment_neighbours_.resize (number_of_segments_, neighbours);
-  segment_distances_.resize (number_of_segments_, distances);
+  segment_neighbours_.resize (number_of_segments_);
+  segment_distances_.resize (number_of_segments_);
 
-  for (int i_seg = 0; i_seg < number_of_segments_; i_seg++)
+  pcl::parallel::parallel_for (0, number_of_segments_, [this] (int first, int last)
   {
-    std::vector<int> nghbrs;
-    std::vector<float> dist;
-    findRegionsKNN (i_seg, region_neighbour_number_, nghbrs, dist);
-    segment_neighbours_[i_seg].swap (nghbrs);
-    segment_distances_[i_seg].swap (dist);
-  }
+    for (int i_seg = first; i_seg < last; i_seg++)
+    {
+      std::vector<int> nghbrs;
+      std::vector<float> dist;
+      findRegionsKNN (i_seg, region_neighbour_number_, nghbrs, dist);
+      segment_neighbours_[i_seg].swap (nghbrs);
+      segment_distances_[i_seg].swap (dist);
+    }
+  }, threads_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::findRegionsKNN (int index, int nghbr_number, std::vector<int>& nghbrs, std::vector<float>& dist)
 {
-  std::vector<float> distances;
-  float max_dist = std::numeric_limits<float>::max ();
-  distances.resize (clusters_.size (), max_dist);
+  // Distance of the point neighbours that belong to other segments, only the nearest one per segment is kept
+  std::vector<std::pair<int, float> > candidates;
 
   int number_of_points = num_pts_in_segment_[index];
   //loop through every point in this segment and check neighbours
@@ -323,31 +329,25 @@ pcl::RegionGrowingRGB<PointT, NormalT>::findRegionsKNN (int index, int nghbr_num
     int point_index = clusters_[index].indices[i_point];
     int number_of_neighbours = static_cast<int> (point_neighbours_[point_index].size ());
     //loop through every neighbour of the current point, find out to which segment it belongs
-    //and if it belongs to neighbouring segment and is close enough then remember segment and its distance
+    //and if it belongs to neighbouring segment then remember segment and its distance
     for (int i_nghbr = 0; i_nghbr < number_of_neighbours; i_nghbr++)
     {
-      // find segment
-      int segment_index = -1;
-      segment_index = point_labels_[ point_neighbours_[point_index][i_nghbr] ];
-
-      if ( segment_index != index )
-      {
-        // try to push it to the queue
-        if (distances[segment_index] > point_distances_[point_index][i_nghbr])
-          distances[segment_index] = point_distances_[point_index][i_nghbr];
-      }
+      int segment_index = point_labels_[ point_neighbours_[point_index][i_nghbr] ];
+      if ( segment_index != index && point_distances_[point_index][i_nghbr] < std::numeric_limits<float>::max () )
+        candidates.emplace_back (segment_index, point_distances_[point_index][i_nghbr]);
     }
   }// next point
+  std::sort (candidates.begin (), candidates.end ());
 
   std::priority_queue<std::pair<float, int> > segment_neighbours;
-  for (int i_seg = 0; i_seg < number_of_segments_; i_seg++)
+  for (std::size_t i_cand = 0; i_cand < candidates.size (); i_cand++)
   {
-    if (distances[i_seg] < max_dist)
-    {
-      segment_neighbours.push (std::make_pair (distances[i_seg], i_seg) );
-      if (int (segment_neighbours.size ()) > nghbr_number)
-        segment_neighbours.pop ();
-    }
+    // The candidates of a segment are sorted by distance
+    if (i_cand > 0 && candidates[i_cand].first == candidates[i_cand - 1].first)
+      continue;
+    segment_neighbours.push (std::make_pair (candidates[i_cand].second, candidates[i_cand].first) );
+    if (int (segment_neighbours.size ()) > nghbr_number)
+      segment_neighbours.pop ();
   }
 
   int size = std::min<int> (static_cast<int> (segment_neighbours.size ()), nghbr_number);
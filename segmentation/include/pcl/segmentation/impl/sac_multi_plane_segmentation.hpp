@@ -0,0 +1,213 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_IMPL_SAC_MULTI_PLANE_SEGMENTATION_H_
+#define PCL_SEGMENTATION_IMPL_SAC_MULTI_PLANE_SEGMENTATION_H_
+
+#include <pcl/segmentation/sac_multi_plane_segmentation.h>
+#include <pcl/sample_consensus/ransac.h>
+#include <pcl/sample_consensus/sac_model_plane.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/organized.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SACMultiPlaneSegmentation<PointT>::keepLargestCluster (Indices &inliers)
+{
+  for (const auto &index : inliers)
+    point_state_[index] = 1;
+
+  Indices cluster, largest_cluster;
+  Indices nn_indices;
+  std::vector<float> nn_distances;
+  for (const auto &seed : inliers)
+  {
+    if (point_state_[seed] != 1)
+      continue;
+
+    // Flood fill restricted to the inliers of the plane
+    cluster.clear ();
+    cluster.push_back (seed);
+    point_state_[seed] = 2;
+    for (std::size_t i = 0; i < cluster.size (); ++i)
+    {
+      tree_->radiusSearch ((*input_)[cluster[i]], cluster_tolerance_, nn_indices, nn_distances);
+      for (const auto &neighbor : nn_indices)
+      {
+        if (point_state_[neighbor] != 1)
+          continue;
+        point_state_[neighbor] = 2;
+        cluster.push_back (neighbor);
+      }
+    }
+
+    if (cluster.size () > largest_cluster.size ())
+      largest_cluster.swap (cluster);
+  }
+
+  for (const auto &index : inliers)
+    point_state_[index] = 0;
+
+  std::sort (largest_cluster.begin (), largest_cluster.end ());
+  inliers.swap (largest_cluster);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SACMultiPlaneSegmentation<PointT>::segment (std::vector<ModelCoefficients> &model_coefficients,
+                                                 std::vector<PointIndices> &inlier_indices)
+{
+  model_coefficients.clear ();
+  inlier_indices.clear ();
+
+  if (!initCompute ())
+    return;
+
+  if (threshold_ <= 0.0)
+  {
+    PCL_ERROR ("[pcl::%s::segment] Invalid distance threshold %f!\n", getClassName ().c_str (), threshold_);
+    deinitCompute ();
+    return;
+  }
+
+  // The search structure is built once, on all the points
+  if (cluster_tolerance_ > 0.0)
+  {
+    if (!tree_)
+    {
+      if (input_->isOrganized ())
+        tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+      else
+        tree_.reset (new pcl::search::KdTree<PointT> (false));
+    }
+    tree_->setInputCloud (input_, indices_);
+    point_state_.assign (input_->size (), 0);
+  }
+
+  // The plane model is shared by all the planes, only the indices of the points which are still
+  // available are updated after each plane. The inliers of the fragmented planes are not sampled anymore,
+  // but they remain available for the next planes.
+  IndicesPtr available (new Indices (*indices_));
+  IndicesPtr remaining (new Indices (*indices_));
+  typename SampleConsensusModelPlane<PointT>::Ptr model (new SampleConsensusModelPlane<PointT> (input_, *remaining));
+  model->setNumberOfThreads (threads_);
+  std::vector<bool> assigned (input_->size (), false);
+  std::vector<bool> excluded (input_->size (), false);
+  unsigned nr_fragmented_planes = 0;
+
+  Indices inliers, plane_inliers;
+  Eigen::VectorXf coefficients, refined_coefficients;
+  while (remaining->size () >= min_inliers_ && remaining->size () >= model->getSampleSize () &&
+         (max_planes_ == 0 || model_coefficients.size () < max_planes_))
+  {
+    RandomSampleConsensus<PointT> sac (model, threshold_);
+    sac.setMaxIterations (max_iterations_);
+    sac.setProbability (probability_);
+    sac.setNumberOfThreads (threads_);
+    if (!sac.computeModel ())
+      break;
+
+    sac.getInliers (inliers);
+    sac.getModelCoefficients (coefficients);
+
+    if (optimize_coefficients_)
+    {
+      model->optimizeModelCoefficients (inliers, coefficients, refined_coefficients);
+      coefficients = refined_coefficients;
+      model->selectWithinDistance (coefficients, threshold_, inliers);
+    }
+
+    if (cluster_tolerance_ > 0.0)
+    {
+      // The points of the fragmented planes which are close to this plane belong to it as well
+      if (nr_fragmented_planes > 0)
+      {
+        model->setIndices (available);
+        model->selectWithinDistance (coefficients, threshold_, inliers);
+        model->setIndices (remaining);
+      }
+      plane_inliers = inliers;
+      keepLargestCluster (inliers);
+
+      if (inliers.size () < min_inliers_)
+      {
+        // Look for the other planes instead, unless too many planes were fragmented already
+        if (++nr_fragmented_planes > max_fragmented_planes_)
+          break;
+        for (const auto &index : plane_inliers)
+          excluded[index] = true;
+        remaining->erase (std::remove_if (remaining->begin (), remaining->end (),
+                                          [&excluded] (const index_t index) { return (excluded[index]); }),
+                          remaining->end ());
+        model->setIndices (remaining);
+        PCL_DEBUG ("[pcl::%s::segment] Skipped a fragmented plane: largest cluster of %lu out of %lu inliers, %lu points left to sample.\n",
+                   getClassName ().c_str (), inliers.size (), plane_inliers.size (), remaining->size ());
+        continue;
+      }
+    }
+    else if (inliers.size () < min_inliers_)
+      break;
+
+    for (const auto &index : inliers)
+      assigned[index] = true;
+
+    model_coefficients.emplace_back ();
+    model_coefficients.back ().header = input_->header;
+    model_coefficients.back ().values.assign (coefficients.data (), coefficients.data () + coefficients.size ());
+    inlier_indices.emplace_back ();
+    inlier_indices.back ().header = input_->header;
+    inlier_indices.back ().indices.swap (inliers);
+
+    // Shrink the set of available points
+    available->erase (std::remove_if (available->begin (), available->end (),
+                                      [&assigned] (const index_t index) { return (assigned[index]); }),
+                      available->end ());
+    remaining->erase (std::remove_if (remaining->begin (), remaining->end (),
+                                      [&assigned] (const index_t index) { return (assigned[index]); }),
+                      remaining->end ());
+    model->setIndices (remaining);
+
+    PCL_DEBUG ("[pcl::%s::segment] Plane %lu: %lu inliers, %lu points left.\n", getClassName ().c_str (),
+               model_coefficients.size (), inlier_indices.back ().indices.size (), remaining->size ());
+  }
+
+  deinitCompute ();
+}
+
+#define PCL_INSTANTIATE_SACMultiPlaneSegmentation(T) template class PCL_EXPORTS pcl::SACMultiPlaneSegmentation<T>;
+
+#endif    // PCL_SEGMENTATION_IMPL_SAC_MULTI_PLANE_SEGMENTATION_H_
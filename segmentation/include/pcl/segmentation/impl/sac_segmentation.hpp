@@ -52,6 +52,8 @@
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/rransac.h>
 #include <pcl/sample_consensus/prosac.h>
+#include <pcl/sample_consensus/magsac.h>
+#include <pcl/sample_consensus/gc_ransac.h>
 
 // Sample Consensus models
 #include <pcl/sample_consensus/sac_model.h>
@@ -319,6 +321,18 @@ pcl::SACSegmentation<PointT>::initSAC (const int method_type)
       sac_.reset (new ProgressiveSampleConsensus<PointT> (model_, threshold_));
       break;
     }
+    case SAC_MAGSAC:
+    {
+      PCL_DEBUG ("[pcl::%s::initSAC] Using a method of type: SAC_MAGSAC with a maximum model threshold of %f\n", getClassName ().c_str (), threshold_);
+      sac_.reset (new MagsacSampleConsensus<PointT> (model_, threshold_));
+      break;
+    }
+    case SAC_GCRANSAC:
+    {
+      PCL_DEBUG ("[pcl::%s::initSAC] Using a method of type: SAC_GCRANSAC with a model threshold of %f\n", getClassName ().c_str (), threshold_);
+      sac_.reset (new GraphCutRandomSampleConsensus<PointT> (model_, threshold_));
+      break;
+    }
   }
   // Set the Sample Consensus parameters if they are given/changed
   if (sac_->getProbability () != probability_)
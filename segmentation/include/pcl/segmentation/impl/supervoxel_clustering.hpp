@@ -41,6 +41,29 @@
 #define PCL_SEGMENTATION_SUPERVOXEL_CLUSTERING_HPP_
 
 #include <pcl/segmentation/supervoxel_clustering.h>
+#include <pcl/common/parallel.h>
+
+#include <cstring>
+#include <memory>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Encode the claim of a supervoxel on a voxel so that the lowest value is the closest claim, and the
+      * lowest label among the closest ones.
+      */
+    inline std::uint64_t
+    encodeSupervoxelClaim (float distance, std::uint32_t label)
+    {
+      std::uint32_t bits;
+      std::memcpy (&bits, &distance, sizeof (bits));
+      // Map the floats to unsigned integers of the same order
+      bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+      return ((static_cast<std::uint64_t> (bits) << 32) | label);
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
@@ -52,7 +75,8 @@ pcl::SupervoxelClustering<PointT>::SupervoxelClustering (float voxel_resolution,
   color_importance_ (0.1f),
   spatial_importance_ (0.4f),
   normal_importance_ (1.0f),
-  use_default_transform_behaviour_ (true)
+  use_default_transform_behaviour_ (true),
+  threads_ (1)
 {
   adjacency_octree_.reset (new OctreeAdjacencyT (resolution_));
 }
@@ -156,10 +180,15 @@ pcl::SupervoxelClustering<PointT>::refineSupervoxels (int num_itr, std::map<std:
   int max_depth = static_cast<int> (1.8f*seed_resolution_/resolution_);
   for (int i = 0; i < num_itr; ++i)
   {
-    for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
+    // Each supervoxel only writes the normals of its own voxels
+    std::vector<SupervoxelHelper*> helpers;
+    for (auto &helper : supervoxel_helpers_)
+      helpers.push_back (&helper);
+    pcl::parallel::parallel_for (std::size_t (0), helpers.size (), [&helpers] (std::size_t first, std::size_t last)
     {
-      sv_itr->refineNormals ();
-    }
+      for (std::size_t i = first; i < last; ++i)
+        helpers[i]->refineNormals ();
+    }, threads_);
     
     reseedSupervoxels ();
     expandSupervoxels (max_depth);
@@ -191,6 +220,7 @@ pcl::SupervoxelClustering<PointT>::prepareForSegmentation ()
        || (!use_default_transform_behaviour_ && use_single_camera_transform_))
       adjacency_octree_->setTransformFunction ([this] (PointT &p) { transformFunction (p); });
 
+  adjacency_octree_->setNumberOfThreads (threads_);
   adjacency_octree_->addPointsFromInputCloud ();
   //double prep_end = timer_.getTime ();
   //std::cout<<"Time elapsed populating octree with next frame ="<<prep_end-prep_start<<" ms\n";
@@ -207,18 +237,19 @@ pcl::SupervoxelClustering<PointT>::prepareForSegmentation ()
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::computeVoxelData ()
 {
+  const std::size_t num_leaves = adjacency_octree_->size ();
   voxel_centroid_cloud_.reset (new PointCloudT);
-  voxel_centroid_cloud_->resize (adjacency_octree_->getLeafCount ());
-  typename LeafVectorT::iterator leaf_itr = adjacency_octree_->begin ();
-  typename PointCloudT::iterator cent_cloud_itr = voxel_centroid_cloud_->begin ();
-  for (int idx = 0 ; leaf_itr != adjacency_octree_->end (); ++leaf_itr, ++cent_cloud_itr, ++idx)
+  voxel_centroid_cloud_->resize (num_leaves);
+  pcl::parallel::parallel_for (std::size_t (0), num_leaves, [this] (std::size_t first, std::size_t last)
   {
-    VoxelData& new_voxel_data = (*leaf_itr)->getData ();
-    //Add the point to the centroid cloud
-    new_voxel_data.getPoint (*cent_cloud_itr);
-    //voxel_centroid_cloud_->push_back(new_voxel_data.getPoint ());
-    new_voxel_data.idx_ = idx;
-  }
+    for (std::size_t idx = first; idx < last; ++idx)
+    {
+      VoxelData& new_voxel_data = adjacency_octree_->at (idx)->getData ();
+      //Add the point to the centroid cloud
+      new_voxel_data.getPoint (voxel_centroid_cloud_->points[idx]);
+      new_voxel_data.idx_ = static_cast<int> (idx);
+    }
+  }, threads_);
   
   //If normals were provided
   if (input_normals_)
@@ -226,98 +257,155 @@ pcl::SupervoxelClustering<PointT>::computeVoxelData ()
     //Verify that input normal cloud size is same as input cloud size
     assert (input_normals_->size () == input_->size ());
     //For every point in the input cloud, find its corresponding leaf
-    typename NormalCloudT::const_iterator normal_itr = input_normals_->begin ();
-    for (typename PointCloudT::const_iterator input_itr = input_->begin (); input_itr != input_->end (); ++input_itr, ++normal_itr)
+    std::vector<LeafContainerT*> point_leaves (input_->size (), nullptr);
+    pcl::parallel::parallel_for (std::size_t (0), input_->size (), [this, &point_leaves] (std::size_t first, std::size_t last)
     {
-      //If the point is not finite we ignore it
-      if ( !pcl::isFinite<PointT> (*input_itr))
+      for (std::size_t i = first; i < last; ++i)
+      {
+        //If the point is not finite we ignore it
+        if (pcl::isFinite<PointT> (input_->points[i]))
+          point_leaves[i] = adjacency_octree_->getLeafContainerAtPoint (input_->points[i]);
+      }
+    }, threads_);
+    for (std::size_t i = 0; i < point_leaves.size (); ++i)
+    {
+      if (!point_leaves[i])
         continue;
-      //Otherwise look up its leaf container
-      LeafContainerT* leaf = adjacency_octree_->getLeafContainerAtPoint (*input_itr);
-
       //Get the voxel data object
-      VoxelData& voxel_data = leaf->getData ();
+      VoxelData& voxel_data = point_leaves[i]->getData ();
       //Add this normal in (we will normalize at the end)
-      voxel_data.normal_ += normal_itr->getNormalVector4fMap ();
-      voxel_data.curvature_ += normal_itr->curvature;
+      voxel_data.normal_ += input_normals_->points[i].getNormalVector4fMap ();
+      voxel_data.curvature_ += input_normals_->points[i].curvature;
     }
     //Now iterate through the leaves and normalize 
-    for (leaf_itr = adjacency_octree_->begin (); leaf_itr != adjacency_octree_->end (); ++leaf_itr)
+    pcl::parallel::parallel_for (std::size_t (0), num_leaves, [this] (std::size_t first, std::size_t last)
     {
-      VoxelData& voxel_data = (*leaf_itr)->getData ();
-      voxel_data.normal_.normalize ();
-      voxel_data.owner_ = nullptr;
-      voxel_data.distance_ = std::numeric_limits<float>::max ();
-      //Get the number of points in this leaf
-      int num_points = (*leaf_itr)->getPointCounter ();
-      voxel_data.curvature_ /= num_points;
-    }
+      for (std::size_t idx = first; idx < last; ++idx)
+      {
+        LeafContainerT* leaf = adjacency_octree_->at (idx);
+        VoxelData& voxel_data = leaf->getData ();
+        voxel_data.normal_.normalize ();
+        voxel_data.owner_ = nullptr;
+        voxel_data.distance_ = std::numeric_limits<float>::max ();
+        //Get the number of points in this leaf
+        int num_points = leaf->getPointCounter ();
+        voxel_data.curvature_ /= num_points;
+      }
+    }, threads_);
   }
   else //Otherwise just compute the normals
   {
-    for (leaf_itr = adjacency_octree_->begin (); leaf_itr != adjacency_octree_->end (); ++leaf_itr)
+    // Each leaf only writes its own data
+    pcl::parallel::parallel_for (std::size_t (0), num_leaves, [this] (std::size_t first, std::size_t last)
     {
-      VoxelData& new_voxel_data = (*leaf_itr)->getData ();
-      //For every point, get its neighbors, build an index vector, compute normal
       std::vector<int> indices;
       indices.reserve (81); 
-      //Push this point
-      indices.push_back (new_voxel_data.idx_);
-      for (typename LeafContainerT::const_iterator neighb_itr=(*leaf_itr)->cbegin (); neighb_itr!=(*leaf_itr)->cend (); ++neighb_itr)
+      for (std::size_t idx = first; idx < last; ++idx)
       {
-        VoxelData& neighb_voxel_data = (*neighb_itr)->getData ();
-        //Push neighbor index
-        indices.push_back (neighb_voxel_data.idx_);
-        //Get neighbors neighbors, push onto cloud
-        for (typename LeafContainerT::const_iterator neighb_neighb_itr=(*neighb_itr)->cbegin (); neighb_neighb_itr!=(*neighb_itr)->cend (); ++neighb_neighb_itr)
+        LeafContainerT* leaf = adjacency_octree_->at (idx);
+        VoxelData& new_voxel_data = leaf->getData ();
+        //For every point, get its neighbors, build an index vector, compute normal
+        indices.clear ();
+        //Push this point
+        indices.push_back (new_voxel_data.idx_);
+        for (typename LeafContainerT::const_iterator neighb_itr=leaf->cbegin (); neighb_itr!=leaf->cend (); ++neighb_itr)
         {
-          VoxelData& neighb2_voxel_data = (*neighb_neighb_itr)->getData ();
-          indices.push_back (neighb2_voxel_data.idx_);
+          VoxelData& neighb_voxel_data = (*neighb_itr)->getData ();
+          //Push neighbor index
+          indices.push_back (neighb_voxel_data.idx_);
+          //Get neighbors neighbors, push onto cloud
+          for (typename LeafContainerT::const_iterator neighb_neighb_itr=(*neighb_itr)->cbegin (); neighb_neighb_itr!=(*neighb_itr)->cend (); ++neighb_neighb_itr)
+          {
+            VoxelData& neighb2_voxel_data = (*neighb_neighb_itr)->getData ();
+            indices.push_back (neighb2_voxel_data.idx_);
+          }
         }
+        //Compute normal
+        pcl::computePointNormal (*voxel_centroid_cloud_, indices, new_voxel_data.normal_, new_voxel_data.curvature_);
+        pcl::flipNormalTowardsViewpoint (voxel_centroid_cloud_->points[new_voxel_data.idx_], 0.0f,0.0f,0.0f, new_voxel_data.normal_);
+        new_voxel_data.normal_[3] = 0.0f;
+        new_voxel_data.normal_.normalize ();
+        new_voxel_data.owner_ = nullptr;
+        new_voxel_data.distance_ = std::numeric_limits<float>::max ();
       }
-      //Compute normal
-      pcl::computePointNormal (*voxel_centroid_cloud_, indices, new_voxel_data.normal_, new_voxel_data.curvature_);
-      pcl::flipNormalTowardsViewpoint (voxel_centroid_cloud_->points[new_voxel_data.idx_], 0.0f,0.0f,0.0f, new_voxel_data.normal_);
-      new_voxel_data.normal_[3] = 0.0f;
-      new_voxel_data.normal_.normalize ();
-      new_voxel_data.owner_ = nullptr;
-      new_voxel_data.distance_ = std::numeric_limits<float>::max ();
-    }
+    }, threads_);
   }
-  
-  
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::expandSupervoxels ( int depth )
 {
-  
-  
   for (int i = 1; i < depth; ++i)
   {
-      //Expand the the supervoxels by one iteration
+    //Expand the the supervoxels by one iteration
+    if (threads_ == 1)
+    {
       for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
       {
         sv_itr->expand ();
       }
-      
-      //Update the centers to reflect new centers
-      for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); )
+    }
+    else
+      expandSupervoxelsConcurrently ();
+
+    //Remove the empty supervoxels
+    std::vector<SupervoxelHelper*> helpers;
+    for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); )
+    {
+      if (sv_itr->size () == 0)
       {
-        if (sv_itr->size () == 0)
-        {
-          sv_itr = supervoxel_helpers_.erase (sv_itr);
-        }
-        else
-        {
-          sv_itr->updateCentroid ();
-          ++sv_itr;
-        } 
+        sv_itr = supervoxel_helpers_.erase (sv_itr);
       }
+      else
+      {
+        helpers.push_back (&(*sv_itr));
+        ++sv_itr;
+      }
+    }
 
+    //Update the centers to reflect new centers
+    pcl::parallel::parallel_for (std::size_t (0), helpers.size (), [&helpers] (std::size_t first, std::size_t last)
+    {
+      for (std::size_t i = first; i < last; ++i)
+        helpers[i]->updateCentroid ();
+    }, threads_);
   }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::expandSupervoxelsConcurrently ()
+{
+  std::vector<SupervoxelHelper*> helpers;
+  for (auto &helper : supervoxel_helpers_)
+    helpers.push_back (&helper);
+
+  const std::size_t num_leaves = adjacency_octree_->size ();
+  std::unique_ptr<std::atomic<std::uint64_t>[]> claims (new std::atomic<std::uint64_t>[num_leaves]);
+  for (std::size_t i = 0; i < num_leaves; ++i)
+    claims[i].store (std::numeric_limits<std::uint64_t>::max (), std::memory_order_relaxed);
 
+  // Every supervoxel claims voxels given the ownership at the start of the iteration
+  std::vector<std::vector<std::pair<LeafContainerT*, float> > > claimed (helpers.size ());
+  pcl::parallel::parallel_for (std::size_t (0), helpers.size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+      helpers[i]->claimNeighbors (claims.get (), claimed[i]);
+  }, threads_);
+
+  // Each voxel is then taken by a single supervoxel
+  pcl::parallel::parallel_for (std::size_t (0), helpers.size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+      helpers[i]->takeClaimedLeaves (claims.get (), claimed[i]);
+  }, threads_);
+
+  pcl::parallel::parallel_for (std::size_t (0), helpers.size (), [&helpers] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+      helpers[i]->removeLostLeaves ();
+  }, threads_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -380,38 +468,37 @@ pcl::SupervoxelClustering<PointT>::selectInitialSupervoxelSeeds (std::vector<int
   std::vector<int> seed_indices_orig;
   seed_indices_orig.resize (num_seeds, 0);
   seed_indices.clear ();
-  std::vector<int> closest_index;
-  std::vector<float> distance;
-  closest_index.resize(1,0);
-  distance.resize(1,0);
   if (!voxel_kdtree_)
   {
     voxel_kdtree_.reset (new pcl::search::KdTree<PointT>);
     voxel_kdtree_ ->setInputCloud (voxel_centroid_cloud_);
   }
   
-  for (int i = 0; i < num_seeds; ++i)  
-  {
-    voxel_kdtree_->nearestKSearch (voxel_centers[i], 1, closest_index, distance);
-    seed_indices_orig[i] = closest_index[0];
-  }
-  
-  std::vector<int> neighbors;
-  std::vector<float> sqr_distances;
-  seed_indices.reserve (seed_indices_orig.size ());
   float search_radius = 0.5f*seed_resolution_;
   // This is 1/20th of the number of voxels which fit in a planar slice through search volume
   // Area of planar slice / area of voxel side. (Note: This is smaller than the value mentioned in the original paper)
   float min_points = 0.05f * (search_radius)*(search_radius) * 3.1415926536f  / (resolution_*resolution_);
-  for (const int &index_orig : seed_indices_orig)
+  std::vector<char> keep_seed (num_seeds, 0);
+  pcl::parallel::parallel_for (0, num_seeds, [&] (int first, int last)
   {
-    int num = voxel_kdtree_->radiusSearch (index_orig, search_radius , neighbors, sqr_distances);
-    int min_index = index_orig;
-    if ( num > min_points)
+    std::vector<int> closest_index (1, 0);
+    std::vector<float> distance (1, 0);
+    std::vector<int> neighbors;
+    std::vector<float> sqr_distances;
+    for (int i = first; i < last; ++i)
     {
-      seed_indices.push_back (min_index);
+      voxel_kdtree_->nearestKSearch (voxel_centers[i], 1, closest_index, distance);
+      seed_indices_orig[i] = closest_index[0];
+      int num = voxel_kdtree_->radiusSearch (seed_indices_orig[i], search_radius , neighbors, sqr_distances);
+      keep_seed[i] = num > min_points;
     }
-    
+  }, threads_);
+  
+  seed_indices.reserve (seed_indices_orig.size ());
+  for (int i = 0; i < num_seeds; ++i)
+  {
+    if (keep_seed[i])
+      seed_indices.push_back (seed_indices_orig[i]);
   }
  // std::cout << "Number of seed points after filtering="<<seed_points.size ()<<std::endl;
   
@@ -428,16 +515,28 @@ pcl::SupervoxelClustering<PointT>::reseedSupervoxels ()
     sv_itr->removeAllLeaves ();
   }
   
-  std::vector<int> closest_index;
-  std::vector<float> distance;
   //Now go through each supervoxel, find voxel closest to its center, add it in
-  for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
+  std::vector<SupervoxelHelper*> helpers;
+  for (auto &helper : supervoxel_helpers_)
+    helpers.push_back (&helper);
+  std::vector<int> closest_indices (helpers.size ());
+  pcl::parallel::parallel_for (std::size_t (0), helpers.size (), [&] (std::size_t first, std::size_t last)
   {
-    PointT point;
-    sv_itr->getXYZ (point.x, point.y, point.z);
-    voxel_kdtree_->nearestKSearch (point, 1, closest_index, distance);
-    
-    LeafContainerT* seed_leaf = adjacency_octree_->at (closest_index[0]);
+    std::vector<int> closest_index;
+    std::vector<float> distance;
+    for (std::size_t i = first; i < last; ++i)
+    {
+      PointT point;
+      helpers[i]->getXYZ (point.x, point.y, point.z);
+      voxel_kdtree_->nearestKSearch (point, 1, closest_index, distance);
+      closest_indices[i] = closest_index[0];
+    }
+  }, threads_);
+
+  for (std::size_t i = 0; i < helpers.size (); ++i)
+  {
+    SupervoxelHelper* sv_itr = helpers[i];
+    LeafContainerT* seed_leaf = adjacency_octree_->at (closest_indices[i]);
     if (seed_leaf)
     {
       sv_itr->addLeaf (seed_leaf);
@@ -678,6 +777,20 @@ pcl::SupervoxelClustering<PointT>::setUseSingleCameraTransform (bool val)
   use_single_camera_transform_ = val;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> unsigned int
+pcl::SupervoxelClustering<PointT>::getNumberOfThreads () const
+{
+  return (threads_);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::SupervoxelClustering<PointT>::getMaxLabel () const
@@ -828,6 +941,64 @@ pcl::SupervoxelClustering<PointT>::SupervoxelHelper::expand ()
   }  
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::SupervoxelHelper::claimNeighbors (std::atomic<std::uint64_t> *claims,
+                                                                      std::vector<std::pair<LeafContainerT*, float> > &claimed) const
+{
+  claimed.clear ();
+  claimed.reserve (leaves_.size () * 9);
+  //For each leaf belonging to this supervoxel
+  for (auto leaf_itr = leaves_.cbegin (); leaf_itr != leaves_.cend (); ++leaf_itr)
+  {
+    //for each neighbor of the leaf
+    for (typename LeafContainerT::const_iterator neighb_itr=(*leaf_itr)->cbegin (); neighb_itr!=(*leaf_itr)->cend (); ++neighb_itr)
+    {
+      const VoxelData& neighbor_voxel = ((*neighb_itr)->getData ());
+      if (neighbor_voxel.owner_ == this)
+        continue;
+      const float dist = parent_->voxelDataDistance (centroid_, neighbor_voxel);
+      if (dist < neighbor_voxel.distance_)
+      {
+        const std::uint64_t claim = pcl::detail::encodeSupervoxelClaim (dist, label_);
+        std::atomic<std::uint64_t> &best = claims[neighbor_voxel.idx_];
+        std::uint64_t current = best.load (std::memory_order_relaxed);
+        while (claim < current && !best.compare_exchange_weak (current, claim, std::memory_order_relaxed));
+        claimed.emplace_back (*neighb_itr, dist);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::SupervoxelHelper::takeClaimedLeaves (const std::atomic<std::uint64_t> *claims,
+                                                                         const std::vector<std::pair<LeafContainerT*, float> > &claimed)
+{
+  for (const auto &leaf_dist : claimed)
+  {
+    VoxelData& voxel = leaf_dist.first->getData ();
+    if (claims[voxel.idx_].load (std::memory_order_relaxed) != pcl::detail::encodeSupervoxelClaim (leaf_dist.second, label_))
+      continue;
+    voxel.owner_ = this;
+    voxel.distance_ = leaf_dist.second;
+    leaves_.insert (leaf_dist.first);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::SupervoxelHelper::removeLostLeaves ()
+{
+  for (auto leaf_itr = leaves_.begin (); leaf_itr != leaves_.end (); )
+  {
+    if ((*leaf_itr)->getData ().owner_ != this)
+      leaf_itr = leaves_.erase (leaf_itr);
+    else
+      ++leaf_itr;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::SupervoxelHelper::refineNormals ()
@@ -202,6 +202,35 @@ namespace pcl
       void
       setInputNormals (const NormalPtr& norm);
 
+      /** \brief Returns the flag that signalizes if the union-find mode is used. */
+      bool
+      getUnionFindFlag () const;
+
+      /** \brief Allows to turn on/off the union-find mode. In this mode the segments are not grown one after the
+        * other: the edges of the neighbour graph between points that can serve as seeds are tested concurrently and
+        * merged with a union-find, then each of the other points joins the first segment (in the order of the
+        * seeds) which has a seed it passes the test with. This yields the segments of the sequential algorithm,
+        * except that two segments are merged whenever one of them reaches a seed of the other one, regardless of
+        * which segment was grown first.
+        * The mode requires that the test of validatePoint () does not depend on the initial seed, and that a point
+        * can serve as a seed regardless of the point which reached it, i.e. the smoothness constraint is on (or the
+        * normal test off) and the residual test is off. The segments are grown sequentially otherwise.
+        * \param[in] value new mode value, if set to true then the union-find mode will be used
+        */
+      void
+      setUnionFindFlag (bool value);
+
+      /** \brief Set the number of threads used to find the neighbours of the points and, in the union-find mode,
+        * to label them. Defaults to 1. The threads are taken from the pool of pcl::parallel.
+        * \param[in] nr_threads the maximum number of threads to use (0 for the whole budget of pcl::parallel)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Returns the number of threads used to find the neighbours and to label the points. */
+      unsigned int
+      getNumberOfThreads () const;
+
       /** \brief This method launches the segmentation algorithm and returns the clusters that were
         * obtained during the segmentation.
         * \param[out] clusters clusters that were obtained. Each cluster is an array of point indices.
@@ -255,6 +284,13 @@ namespace pcl
       void
       applySmoothRegionGrowingAlgorithm ();
 
+      /** \brief This function labels the points like applySmoothRegionGrowingAlgorithm (), but with the
+        * union-find mode described in setUnionFindFlag ().
+        * \param[in] seeds the points that will be tried as seeds, in the order of the sequential algorithm
+        */
+      void
+      applyUnionFindAlgorithm (const std::vector<std::pair<float, int> >& seeds);
+
       /** \brief This method grows a segment for the given seed point. And returns the number of its points.
         * \param[in] initial_seed index of the point that will serve as the seed point
         * \param[in] segment_number indicates which number this segment will have
@@ -333,6 +369,12 @@ namespace pcl
       /** \brief Stores the number of segments. */
       int number_of_segments_;
 
+      /** \brief If set to true then the segments are labeled with the union-find mode. */
+      bool union_find_flag_;
+
+      /** \brief The number of threads used to find the neighbours and to label the points. */
+      unsigned int threads_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
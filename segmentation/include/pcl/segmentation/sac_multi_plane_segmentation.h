@@ -0,0 +1,258 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_base.h>
+#include <pcl/PointIndices.h>
+#include <pcl/ModelCoefficients.h>
+#include <pcl/search/search.h>
+
+namespace pcl
+{
+  /** \brief SACMultiPlaneSegmentation extracts all the planes of an unorganized point cloud in a single call.
+    *
+    * Planes are found one after the other with RANSAC, like repeated calls to SACSegmentation and
+    * ExtractIndices would do, but without copying the cloud: the same plane model is reused, and only the
+    * indices of the points which do not belong to any plane yet are handed to it. Hypotheses are generated
+    * and verified by several threads if requested (see setNumberOfThreads).
+    *
+    * Optionally, the inliers of each plane can be restricted to their largest Euclidean cluster (see
+    * setClusterTolerance), so that distinct coplanar surfaces, such as two tables of the same height, are
+    * reported as separate planes. The search structure needed for this is built only once for all planes.
+    * A plane whose largest cluster is smaller than \a min_inliers is not reported, and its inliers are no
+    * longer sampled (but may still belong to the next planes), so that the next hypotheses can find the other
+    * planes (see setMaxFragmentedPlanes).
+    *
+    * Planes are reported in the order they were found (which is roughly by decreasing size) until no plane
+    * with at least \a min_inliers points remains, or the maximum number of planes is reached. This is the
+    * counterpart of OrganizedMultiPlaneSegmentation for unorganized data.
+    * \ingroup segmentation
+    */
+  template <typename PointT>
+  class SACMultiPlaneSegmentation : public PCLBase<PointT>
+  {
+    using PCLBase<PointT>::input_;
+    using PCLBase<PointT>::indices_;
+    using PCLBase<PointT>::initCompute;
+    using PCLBase<PointT>::deinitCompute;
+
+    public:
+      using PointCloud = pcl::PointCloud<PointT>;
+      using PointCloudPtr = typename PointCloud::Ptr;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+      using SearchPtr = typename pcl::search::Search<PointT>::Ptr;
+
+      using Ptr = shared_ptr<SACMultiPlaneSegmentation<PointT> >;
+      using ConstPtr = shared_ptr<const SACMultiPlaneSegmentation<PointT> >;
+
+      /** \brief Empty constructor. */
+      SACMultiPlaneSegmentation ()
+        : threshold_ (0.02)
+        , max_iterations_ (1000)
+        , probability_ (0.99)
+        , threads_ (-1)
+        , optimize_coefficients_ (true)
+        , min_inliers_ (1000)
+        , max_planes_ (0)
+        , cluster_tolerance_ (0.0)
+        , max_fragmented_planes_ (10)
+      {
+      }
+
+      /** \brief Set the distance to the plane threshold.
+        * \param[in] threshold the distance threshold (default: 0.02)
+        */
+      inline void
+      setDistanceThreshold (double threshold) { threshold_ = threshold; }
+
+      /** \brief Get the distance to the plane threshold. */
+      inline double
+      getDistanceThreshold () const { return (threshold_); }
+
+      /** \brief Set the maximum number of RANSAC iterations per plane.
+        * \param[in] max_iterations the maximum number of iterations (default: 1000)
+        */
+      inline void
+      setMaxIterations (int max_iterations) { max_iterations_ = max_iterations; }
+
+      /** \brief Get the maximum number of RANSAC iterations per plane. */
+      inline int
+      getMaxIterations () const { return (max_iterations_); }
+
+      /** \brief Set the probability of choosing at least one sample free from outliers.
+        * \param[in] probability the desired probability (default: 0.99)
+        */
+      inline void
+      setProbability (double probability) { probability_ = probability; }
+
+      /** \brief Get the probability of choosing at least one sample free from outliers. */
+      inline double
+      getProbability () const { return (probability_); }
+
+      /** \brief Set the number of threads to use or turn off parallelization.
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel, a negative number turns parallelization off)
+        */
+      inline void
+      setNumberOfThreads (const int nr_threads = -1) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads (0 means automatic, a negative number no parallelization). */
+      inline int
+      getNumberOfThreads () const { return (threads_); }
+
+      /** \brief Set to true if a least-squares refinement of the plane coefficients (and of their inliers) is
+        * required (default: true).
+        * \param[in] optimize true for enabling the refinement, false otherwise
+        */
+      inline void
+      setOptimizeCoefficients (bool optimize) { optimize_coefficients_ = optimize; }
+
+      /** \brief Get the coefficient refinement flag. */
+      inline bool
+      getOptimizeCoefficients () const { return (optimize_coefficients_); }
+
+      /** \brief Set the minimum number of inliers required for a plane.
+        * \param[in] min_inliers the minimum number of inliers required per plane (default: 1000)
+        */
+      inline void
+      setMinInliers (unsigned min_inliers) { min_inliers_ = min_inliers; }
+
+      /** \brief Get the minimum number of inliers required per plane. */
+      inline unsigned
+      getMinInliers () const { return (min_inliers_); }
+
+      /** \brief Set the maximum number of planes to extract.
+        * \param[in] max_planes the maximum number of planes, or 0 for no limit (default)
+        */
+      inline void
+      setMaxNumberOfPlanes (unsigned max_planes) { max_planes_ = max_planes; }
+
+      /** \brief Get the maximum number of planes to extract (0 means no limit). */
+      inline unsigned
+      getMaxNumberOfPlanes () const { return (max_planes_); }
+
+      /** \brief Set the spatial tolerance used to split the inliers of a plane into Euclidean clusters. Only the
+        * largest cluster is kept per plane, the other inliers remain available for the next planes.
+        * \param[in] tolerance the cluster tolerance, or 0 to keep all the inliers (default)
+        */
+      inline void
+      setClusterTolerance (double tolerance) { cluster_tolerance_ = tolerance; }
+
+      /** \brief Get the spatial tolerance used to split the inliers of a plane into Euclidean clusters. */
+      inline double
+      getClusterTolerance () const { return (cluster_tolerance_); }
+
+      /** \brief Set the maximum number of planes whose largest cluster is too small, which are skipped before the
+        * segmentation gives up. Only used with a cluster tolerance (see setClusterTolerance).
+        * \param[in] max_fragmented_planes the maximum number of skipped planes (default: 10)
+        */
+      inline void
+      setMaxFragmentedPlanes (unsigned max_fragmented_planes) { max_fragmented_planes_ = max_fragmented_planes; }
+
+      /** \brief Get the maximum number of planes whose largest cluster is too small, which are skipped. */
+      inline unsigned
+      getMaxFragmentedPlanes () const { return (max_fragmented_planes_); }
+
+      /** \brief Provide a pointer to the search object used for the Euclidean clustering of the inliers.
+        * \param[in] tree a pointer to the spatial search object
+        */
+      inline void
+      setSearchMethod (const SearchPtr &tree) { tree_ = tree; }
+
+      /** \brief Get a pointer to the search object used for the Euclidean clustering of the inliers. */
+      inline SearchPtr
+      getSearchMethod () const { return (tree_); }
+
+      /** \brief Extract all the planes of the input cloud.
+        * \param[out] model_coefficients the coefficients (a, b, c, d) of the planes
+        * \param[out] inlier_indices the inliers of each plane
+        */
+      void
+      segment (std::vector<ModelCoefficients> &model_coefficients, std::vector<PointIndices> &inlier_indices);
+
+    protected:
+      /** \brief Restrict a set of inliers to its largest Euclidean cluster.
+        * \param[in,out] inliers the inliers of a plane
+        */
+      void
+      keepLargestCluster (Indices &inliers);
+
+      /** \brief Class getName method. */
+      virtual std::string
+      getClassName () const { return ("SACMultiPlaneSegmentation"); }
+
+      /** \brief Distance to the plane threshold. */
+      double threshold_;
+
+      /** \brief Maximum number of RANSAC iterations per plane. */
+      int max_iterations_;
+
+      /** \brief Desired probability of choosing at least one sample free from outliers. */
+      double probability_;
+
+      /** \brief The number of threads the scheduler should use, or a negative number if no parallelization is wanted. */
+      int threads_;
+
+      /** \brief Set to true if a coefficient refinement is required. */
+      bool optimize_coefficients_;
+
+      /** \brief The minimum number of inliers of a plane. */
+      unsigned min_inliers_;
+
+      /** \brief The maximum number of planes, 0 if unlimited. */
+      unsigned max_planes_;
+
+      /** \brief The spatial tolerance of the Euclidean clustering of the inliers, 0 if disabled. */
+      double cluster_tolerance_;
+
+      /** \brief The maximum number of planes whose largest cluster is too small, which are skipped. */
+      unsigned max_fragmented_planes_;
+
+      /** \brief The search object used for the Euclidean clustering of the inliers. */
+      SearchPtr tree_;
+
+    private:
+      /** \brief Per point of the input cloud: whether it is an inlier of the current plane (1), and whether it
+        * was already visited by the clustering (2). */
+      std::vector<unsigned char> point_state_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/segmentation/impl/sac_multi_plane_segmentation.hpp>
+#endif
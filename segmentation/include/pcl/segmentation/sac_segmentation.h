@@ -163,7 +163,7 @@ namespace pcl
       getProbability () const { return (probability_); }
 
       /** \brief Set the number of threads to use or turn off parallelization.
-        * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically, a negative number turns parallelization off)
+        * \param[in] nr_threads the number of threads to use (0 for the whole thread budget of pcl::parallel, a negative number turns parallelization off)
         * \note Not all SAC methods have a parallel implementation. Some will ignore this setting.
         */
       inline void
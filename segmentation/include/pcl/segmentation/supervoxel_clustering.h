@@ -53,6 +53,10 @@
 #include <pcl/search/search.h>
 #include <pcl/segmentation/boost.h>
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 
 
 //DEBUG TODO REMOVE
@@ -245,6 +249,21 @@ namespace pcl
       void
       setUseSingleCameraTransform (bool val);
 
+      /** \brief Set the number of threads used by extract () and refineSupervoxels (). Defaults to 1.
+       *  The adjacency octree, the voxel data and the seeds are computed in parallel with the same results.
+       *  With more than one thread the supervoxels are also expanded concurrently: in each iteration, every supervoxel
+       *  claims the neighboring voxels it is closer to than their owner at the start of the iteration, and each voxel
+       *  goes to its closest claimant (the lowest label on ties). This result does not depend on the number of threads,
+       *  but differs slightly from the one of a single thread, where the supervoxels take voxels from each other in turn.
+       *  \param[in] nr_threads the maximum number of threads to use (0 for the whole budget of pcl::parallel)
+       */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by extract () and refineSupervoxels (). */
+      unsigned int
+      getNumberOfThreads () const;
+
       /** \brief This method launches the segmentation algorithm and returns the supervoxels that were
        * obtained during the segmentation.
        * \param[out] supervoxel_clusters A map of labels to pointers to supervoxel structures
@@ -351,6 +370,12 @@ namespace pcl
       void
       expandSupervoxels (int depth);
 
+      /** \brief This performs one iteration of the superpixel evolution, with all the supervoxels expanding
+       *  concurrently (see setNumberOfThreads ())
+       */
+      void
+      expandSupervoxelsConcurrently ();
+
       /** \brief This sets the data of the voxels in the tree */
       void
       computeVoxelData ();
@@ -404,6 +429,9 @@ namespace pcl
       /** \brief Whether to use default transform behavior or not */
       bool use_default_transform_behaviour_;
 
+      /** \brief The number of threads used by extract () and refineSupervoxels () */
+      unsigned int threads_;
+
       /** \brief Internal storage class for supervoxels
        * \note Stores pointers to leaves of clustering internal octree,
        * \note so should not be used outside of clustering class
@@ -444,6 +472,24 @@ namespace pcl
           void
           expand ();
 
+          /** \brief Claims the neighboring voxels this supervoxel is closer to than their owner, without modifying them
+           *  \param[in,out] claims the best claim on each voxel so far, indexed by voxel index
+           *  \param[out] claimed the voxels claimed by this supervoxel, with their distance to it
+           */
+          void
+          claimNeighbors (std::atomic<std::uint64_t> *claims, std::vector<std::pair<LeafContainerT*, float> > &claimed) const;
+
+          /** \brief Takes the claimed voxels this supervoxel won
+           *  \param[in] claims the best claim on each voxel, indexed by voxel index
+           *  \param[in] claimed the voxels claimed by this supervoxel, as given by claimNeighbors ()
+           */
+          void
+          takeClaimedLeaves (const std::atomic<std::uint64_t> *claims, const std::vector<std::pair<LeafContainerT*, float> > &claimed);
+
+          /** \brief Removes the leaves that were taken by other supervoxels */
+          void
+          removeLostLeaves ();
+
           void
           refineNormals ();
 
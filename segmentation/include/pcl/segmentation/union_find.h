@@ -0,0 +1,127 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace pcl
+{
+  /** \brief Disjoint sets of the integers [0, size), which can be merged concurrently by several threads.
+    *
+    * Each set is represented by its smallest element: unite () links the larger root under the smaller one with
+    * an atomic compare-and-swap, and find () shortens the paths it walks (path halving). The final sets do not
+    * depend on the order in which the threads merged them.
+    *
+    * \ingroup segmentation
+    */
+  class UnionFind
+  {
+    public:
+      /** \brief Constructor, every element is in a set of its own.
+        * \param[in] size the number of elements
+        */
+      explicit UnionFind (std::size_t size = 0)
+      {
+        reset (size);
+      }
+
+      /** \brief Put every element in a set of its own.
+        * \param[in] size the number of elements
+        */
+      void
+      reset (std::size_t size)
+      {
+        parents_.reset (new std::atomic<int>[size]);
+        size_ = size;
+        for (std::size_t i = 0; i < size; ++i)
+          parents_[i].store (static_cast<int> (i), std::memory_order_relaxed);
+      }
+
+      /** \brief Get the number of elements. */
+      inline std::size_t
+      size () const
+      {
+        return (size_);
+      }
+
+      /** \brief Get the representative of the set of \a element, i.e. its smallest element once all the merges
+        * are done.
+        */
+      inline int
+      find (int element)
+      {
+        int parent = parents_[element].load (std::memory_order_relaxed);
+        while (parent != element)
+        {
+          const int grandparent = parents_[parent].load (std::memory_order_relaxed);
+          if (grandparent != parent)
+            // A failure means that another thread changed the parent, which is fine as well
+            parents_[element].compare_exchange_weak (parent, grandparent, std::memory_order_relaxed);
+          element = parent;
+          parent = parents_[element].load (std::memory_order_relaxed);
+        }
+        return (element);
+      }
+
+      /** \brief Merge the sets of \a a and \a b. */
+      inline void
+      unite (int a, int b)
+      {
+        for (;;)
+        {
+          a = find (a);
+          b = find (b);
+          if (a == b)
+            return;
+          if (a > b)
+            std::swap (a, b);
+          // b is linked only if it is still a root, otherwise look its new root up
+          int expected = b;
+          if (parents_[b].compare_exchange_strong (expected, a, std::memory_order_relaxed))
+            return;
+        }
+      }
+
+    private:
+      std::unique_ptr<std::atomic<int>[]> parents_;
+      std::size_t size_ = 0;
+  };
+}
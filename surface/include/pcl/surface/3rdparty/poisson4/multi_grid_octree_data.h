@@ -72,6 +72,7 @@ DAMAGE.
 // This should be enabled if GRADIENT_DOMAIN_SOLUTION is not, so that CG doesn't run into trouble.
 
 
+#include <algorithm>
 #include <unordered_map>
 
 #include "bspline_data.h"
@@ -332,7 +333,12 @@ namespace pcl
         Real getCornerValue( const TreeOctNode::ConstNeighborKey3& neighborKey3 , const TreeOctNode* node , int corner , const Real* metSolution , const double stencil1[3][3][3] , const double stencil2[3][3][3] );
         Real getCenterValue( const TreeOctNode::ConstNeighborKey3& neighborKey3 , const TreeOctNode* node );
       public:
+        // Upper bound on the number of full-size per-thread scratch buffers when boundedMemory is set
+        static const int MAX_BOUNDED_SCRATCH_THREADS = 4;
+        // Number of per-thread accumulation buffers used by the scatter passes (constraints, down-sampling, corner/edge counting)
+        int scratchThreads( void ) const { return boundedMemory ? std::min< int >( threads , MAX_BOUNDED_SCRATCH_THREADS ) : threads; }
         int threads;
+        bool boundedMemory;
         static double maxMemoryUsage;
         static double MemoryUsage( void );
         std::vector< pcl::poisson::Point3D<Real> >* normals;
@@ -528,6 +528,7 @@ namespace pcl
     Octree<Degree>::Octree(void)
     {
       threads = 1;
+      boundedMemory = false;
       radius = 0;
       width = 0;
       postNormalSmooth = 0;
@@ -1573,17 +1574,18 @@ namespace pcl
         for( int i=sNodes.nodeCount[depth] ; i<sNodes.nodeCount[depth+1] ; i++ ) sNodes.treeNodes[0]->nodeData.constraint += sNodes.treeNodes[i]->nodeData.constraint;
         return;
       }
-      std::vector< Vector< double > > constraints( threads );
-      for( int t=0 ; t<threads ; t++ ) constraints[t].Resize( sNodes.nodeCount[depth] - sNodes.nodeCount[depth-1] ) , constraints[t].SetZero();
+      int sThreads = scratchThreads();
+      std::vector< Vector< double > > constraints( sThreads );
+      for( int t=0 ; t<sThreads ; t++ ) constraints[t].Resize( sNodes.nodeCount[depth] - sNodes.nodeCount[depth-1] ) , constraints[t].SetZero();
       int start = sNodes.nodeCount[depth] , end = sNodes.nodeCount[depth+1] , range = end-start;
       int lStart = sNodes.nodeCount[depth-1] , lEnd = sNodes.nodeCount[depth];
       // For every node at the current depth
-#pragma omp parallel for num_threads( threads )
-      for( int t=0 ; t<threads ; t++ )
+#pragma omp parallel for num_threads( sThreads )
+      for( int t=0 ; t<sThreads ; t++ )
       {
         TreeOctNode::NeighborKey3 neighborKey;
         neighborKey.set( depth );
-        for( int i=start+(range*t)/threads ; i<start+(range*(t+1))/threads ; i++ )
+        for( int i=start+(range*t)/sThreads ; i<start+(range*(t+1))/sThreads ; i++ )
         {
           int d , off[3];
           UpSampleData usData[3];
@@ -1619,7 +1621,7 @@ namespace pcl
       for( int i=lStart ; i<lEnd ; i++ )
       {
         Real cSum = Real(0.);
-        for( int t=0 ; t<threads ; t++ ) cSum += constraints[t][i-lStart];
+        for( int t=0 ; t<sThreads ; t++ ) cSum += constraints[t][i-lStart];
         sNodes.treeNodes[i]->nodeData.constraint += cSum;
       }
     }
@@ -1633,16 +1635,17 @@ namespace pcl
         for( int i=sNodes.nodeCount[1] ; i<sNodes.nodeCount[2] ; i++ ) constraints[0] += constraints[i];
         return;
       }
-      std::vector< Vector< C > > _constraints( threads );
-      for( int t=0 ; t<threads ; t++ ) _constraints[t].Resize( sNodes.nodeCount[depth] - sNodes.nodeCount[depth-1] );
+      int sThreads = scratchThreads();
+      std::vector< Vector< C > > _constraints( sThreads );
+      for( int t=0 ; t<sThreads ; t++ ) _constraints[t].Resize( sNodes.nodeCount[depth] - sNodes.nodeCount[depth-1] );
       int start = sNodes.nodeCount[depth] , end = sNodes.nodeCount[depth+1] , range = end-start , lStart = sNodes.nodeCount[depth-1] , lEnd = sNodes.nodeCount[depth];
       // For every node at the current depth
-#pragma omp parallel for num_threads( threads )
-      for( int t=0 ; t<threads ; t++ )
+#pragma omp parallel for num_threads( sThreads )
+      for( int t=0 ; t<sThreads ; t++ )
       {
         TreeOctNode::NeighborKey3 neighborKey;
         neighborKey.set( depth );
-        for( int i=start+(range*t)/threads ; i<start+(range*(t+1))/threads ; i++ )
+        for( int i=start+(range*t)/sThreads ; i<start+(range*(t+1))/sThreads ; i++ )
         {
           int d , off[3];
           UpSampleData usData[3];
@@ -1678,7 +1681,7 @@ namespace pcl
       for( int i=lStart ; i<lEnd ; i++ )
       {
         C cSum = C(0);
-        for( int t=0 ; t<threads ; t++ ) cSum += _constraints[t][i-lStart];
+        for( int t=0 ; t<sThreads ; t++ ) cSum += _constraints[t][i-lStart];
         constraints[i] += cSum;
       }
     }
@@ -2154,8 +2157,9 @@ namespace pcl
       for( int i=0 ; i<_sNodes.nodeCount[maxDepth+1] ; i++ ) _sNodes.treeNodes[i]->nodeData.constraint = Real( 0. );
 
       // For the scattering part of the operation, we parallelize by duplicating the constraints and then summing at the end.
-      std::vector< std::vector< Real > > _constraints( threads );
-      for( int t=0 ; t<threads ; t++ ) _constraints[t].resize( _sNodes.nodeCount[maxDepth] , 0 );
+      int sThreads = scratchThreads();
+      std::vector< std::vector< Real > > _constraints( sThreads );
+      for( int t=0 ; t<sThreads ; t++ ) _constraints[t].resize( _sNodes.nodeCount[maxDepth] , 0 );
 
       for( int d=maxDepth ; d>=0 ; d-- )
       {
@@ -2163,13 +2167,13 @@ namespace pcl
         SetDivergenceStencil( d , &stencil[0][0][0] , false );
         Stencil< Point3D< double > , 5 > stencils[2][2][2];
         SetDivergenceStencils( d , stencils , true );
-#pragma omp parallel for num_threads( threads )
-        for( int t=0 ; t<threads ; t++ )
+#pragma omp parallel for num_threads( sThreads )
+        for( int t=0 ; t<sThreads ; t++ )
         {
           TreeOctNode::NeighborKey5 neighborKey5;
           neighborKey5.set( fData.depth );
           int start = _sNodes.nodeCount[d] , end = _sNodes.nodeCount[d+1] , range = end-start;
-          for( int i=start+(range*t)/threads ; i<start+(range*(t+1))/threads ; i++ )
+          for( int i=start+(range*t)/sThreads ; i<start+(range*(t+1))/sThreads ; i++ )
           {
             TreeOctNode* node = _sNodes.treeNodes[i];
             int startX=0 , endX=5 , startY=0 , endY=5 , startZ=0 , endZ=5;
@@ -2248,7 +2252,7 @@ namespace pcl
       for( int i=0 ; i<_sNodes.nodeCount[maxDepth] ; i++ )
       {
         Real cSum = Real(0.);
-        for( int t=0 ; t<threads ; t++ ) cSum += _constraints[t][i];
+        for( int t=0 ; t<sThreads ; t++ ) cSum += _constraints[t][i];
         constraints[i] = cSum;
       }
       // Fine-to-coarse down-sampling of constraints
@@ -2471,8 +2475,8 @@ namespace pcl
       rootData.boundaryValues = new std::unordered_map< long long , std::pair< Real , Point3D< Real > > >();
       int offSet = 0;
 
-      int maxCCount = _sNodes.getMaxCornerCount( &tree , sDepth , maxDepth , threads );
-      int maxECount = _sNodes.getMaxEdgeCount  ( &tree , sDepth , threads );
+      int maxCCount = _sNodes.getMaxCornerCount( &tree , sDepth , maxDepth , scratchThreads() );
+      int maxECount = _sNodes.getMaxEdgeCount  ( &tree , sDepth , scratchThreads() );
       rootData.cornerValues     = new          Real  [ maxCCount ];
       rootData.cornerNormals    = new Point3D< Real >[ maxCCount ];
       rootData.interiorRoots    = new int [ maxECount ];
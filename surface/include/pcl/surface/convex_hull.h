@@ -66,6 +66,11 @@ namespace pcl
 
   ////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief @b ConvexHull using libqhull library.
+    *
+    * Before calling qhull, the points which can not be hull vertices are discarded in parallel (Akl-Toussaint
+    * heuristic), so that qhull only gets the points close to the boundary of the cloud. 2D hulls do not use qhull,
+    * they are computed with Andrew's monotone chain algorithm.
+    *
     * \author Aitor Aldoma, Alex Trevor
     * \ingroup surface
     */
@@ -91,7 +96,7 @@ namespace pcl
       /** \brief Empty constructor. */
       ConvexHull () : compute_area_ (false), total_area_ (0), total_volume_ (0), dimension_ (0), 
                       projection_angle_thresh_ (std::cos (0.174532925) ), qhull_flags ("qhull "),
-                      x_axis_ (1.0, 0.0, 0.0), y_axis_ (0.0, 1.0, 0.0), z_axis_ (0.0, 0.0, 1.0)
+                      x_axis_ (1.0, 0.0, 0.0), y_axis_ (0.0, 1.0, 0.0), z_axis_ (0.0, 0.0, 1.0), threads_ (1)
       {
       };
       
@@ -167,6 +172,23 @@ namespace pcl
         return (dimension_);
       }
 
+      /** \brief Set the number of threads used to discard the interior points before computing the hull.
+        * \param[in] nr_threads the number of threads to use (0 sets the value to the thread budget, see
+        * pcl::parallel::setThreadBudget ())
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads used to discard the interior points. */
+      unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Retrieve the indices of the input point cloud that for the convex hull.
         *
         * \note Should only be called after reconstruction was performed.
@@ -267,6 +289,9 @@ namespace pcl
       /* \brief vector containing the point cloud indices of the convex hull points. */
       pcl::PointIndices hull_indices_;
 
+      /** \brief The number of threads used to discard the interior points (0 for the thread budget). */
+      unsigned int threads_;
+
       public:
         PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -47,7 +47,9 @@
 #include <pcl/kdtree/kdtree.h>
 #include <pcl/PolygonMesh.h>
 
+#include <array>
 #include <fstream>
+#include <functional>
 #include <iostream>
 
 
@@ -138,6 +140,7 @@ namespace pcl
       using MeshConstruction<PointInT>::tree_;
       using MeshConstruction<PointInT>::input_;
       using MeshConstruction<PointInT>::indices_;
+      using MeshConstruction<PointInT>::check_tree_;
 
       using KdTree = pcl::KdTree<PointInT>;
       using KdTreePtr = typename KdTree::Ptr;
@@ -146,6 +149,13 @@ namespace pcl
       using PointCloudInPtr = typename PointCloudIn::Ptr;
       using PointCloudInConstPtr = typename PointCloudIn::ConstPtr;
 
+      /** \brief Source of the points of a tile for reconstructOutOfCore (): fills \a points with (at least) all the
+        * points lying in the axis-aligned box [\a min_pt, \a max_pt] and \a ids with their vertex ids in the final mesh.
+        * Returns false if the points could not be provided.
+        */
+      using TileSource = std::function<bool (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt,
+                                             PointCloudIn &points, std::vector<int> &ids)>;
+
       enum GP3Type
       { 
         NONE = -1,    // not-defined
@@ -165,6 +175,8 @@ namespace pcl
         eps_angle_(M_PI/4), //45 degrees,
         consistent_(false), 
         consistent_ordering_ (false),
+        tile_size_ (0),
+        threads_ (1),
         angles_ (),
         R_ (),
         is_current_free_ (false),
@@ -266,6 +278,54 @@ namespace pcl
       inline bool 
       getConsistentVertexOrdering () const { return (consistent_ordering_); }
 
+      /** \brief Set the edge length of the cubic tiles of a partitioned reconstruction.
+        * \details With tiling enabled, the cloud is split into a regular grid of tiles which are triangulated
+        * independently (and concurrently, see setNumberOfThreads ()) instead of growing a single front over the whole
+        * cloud. Each tile also sees the points of its neighbors up to the search radius, and keeps the triangles that
+        * lie farther than the search radius from the other tiles. A seam pass then triangulates the points within twice
+        * the search radius of the borders of each tile again, and adds the triangles that touch a border of the tile
+        * unless one of their edges is shared by two triangles already or their projection overlaps a triangle around.
+        * The seam pass runs in eight rounds, over the tiles of the same coordinate parities in parallel. The result
+        * does not depend on the number of threads, and it differs from the untiled mesh along the tile borders only.
+        * Tiles much larger than the search radius keep the seam pass short.
+        * \param[in] tile_size the tile edge length (0 disables tiling, the default); it is raised to three times the
+        * search radius if it is smaller
+        */
+      inline void
+      setTileSize (double tile_size) { tile_size_ = tile_size; check_tree_ = (tile_size_ <= 0); }
+
+      /** \brief Get the edge length of the tiles of a partitioned reconstruction (0 if disabled). */
+      inline double
+      getTileSize () const { return (tile_size_); }
+
+      /** \brief Set the number of threads used to triangulate the tiles of a partitioned reconstruction.
+        * \param[in] nr_threads the number of threads (0 uses the whole pcl::parallel thread budget, default: 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads used to triangulate the tiles of a partitioned reconstruction. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+      /** \brief Out-of-core variant of the partitioned reconstruction, for clouds that do not fit in memory.
+        * \details The box [\a min_pt, \a max_pt] is split into tiles of getTileSize (), and the points of each tile
+        * (plus a margin of the search radius) are requested from \a source, e.g. read from disk, a few tiles at a
+        * time. \a source is always called from the calling thread, in increasing tile order.
+        * \note Besides the tiles that are being triangulated, every point within three times the search radius of a
+        * tile border is kept in memory until the seam pass at the end, so the memory use grows with the total area of
+        * the tile borders: use tiles much larger than the search radius.
+        * \param[in] source provides the points of a tile and their vertex ids
+        * \param[in] min_pt the minimum corner of the bounding box of all the points
+        * \param[in] max_pt the maximum corner of the bounding box of all the points
+        * \param[out] polygons the resultant triangles, referring to the vertex ids given by \a source
+        * \return false if the parameters are invalid or \a source failed
+        */
+      bool
+      reconstructOutOfCore (const TileSource &source,
+                            const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt,
+                            std::vector<pcl::Vertices> &polygons);
+
       /** \brief Get the state of each point after reconstruction.
         * \note Options are defined as constants: FREE, FRINGE, COMPLETED, BOUNDARY and NONE
         */
@@ -312,6 +372,12 @@ namespace pcl
       /** \brief Set this to true if the output triangle vertices should be consistently oriented. */
       bool consistent_ordering_;
 
+      /** \brief The edge length of the tiles of a partitioned reconstruction (0 if disabled). */
+      double tile_size_;
+
+      /** \brief The number of threads used for a partitioned reconstruction (0 for the thread budget). */
+      unsigned int threads_;
+
      private:
       /** \brief Struct for storing the angles to nearest neighbors **/
       struct nnAngle
@@ -415,6 +481,76 @@ namespace pcl
       bool
       reconstructPolygons (std::vector<pcl::Vertices> &polygons);
 
+      /** \brief Partitioned version of reconstructPolygons (), see setTileSize ().
+        * \param[out] polygons the resultant polygons, as a set of vertices. The Vertices structure contains an array of point indices.
+        */
+      bool
+      reconstructTiledPolygons (std::vector<pcl::Vertices> &polygons);
+
+      /** \brief Triangulate points with a single front, with the parameters of this object.
+        * \param[in] points the points to triangulate
+        * \param[out] polygons the triangles, referring to \a points
+        * \param[out] states the state of each of the points
+        */
+      void
+      triangulatePoints (const PointCloudInConstPtr &points, std::vector<pcl::Vertices> &polygons,
+                         std::vector<int> &states) const;
+
+      /** \brief Triangulate the points of a tile and its margin, keeping the triangles whose vertices all lie in the
+        * tile, farther than the search radius from the other tiles.
+        * \param[in] points the points of the tile and its margin
+        * \param[in] origin the minimum corner of the tile grid
+        * \param[in] tile_size the edge length of the tiles
+        * \param[in] dims the number of tiles of the grid along each axis
+        * \param[in] cell the grid coordinates of the tile
+        * \param[out] polygons the triangles kept, referring to \a points
+        * \param[out] states the state of each of the points
+        */
+      void
+      triangulateTile (const PointCloudInConstPtr &points, const Eigen::Vector3d &origin, double tile_size,
+                       const Eigen::Vector3i &dims, const Eigen::Vector3i &cell, std::vector<pcl::Vertices> &polygons,
+                       std::vector<int> &states) const;
+
+      /** \brief Seam pass of a partitioned reconstruction: triangulate the points along the borders of each tile
+        * again, and add the triangles that touch a border of the tile as long as none of their edges is shared by two
+        * triangles already and they do not overlap a triangle around.
+        * \param[in] points the points within three times the search radius of a tile border
+        * \param[in] ids the vertex ids of the points, in increasing order
+        * \param[in] origin the minimum corner of the tile grid
+        * \param[in] tile_size the edge length of the tiles
+        * \param[in] dims the number of tiles of the grid along each axis
+        * \param[in,out] polygons the triangles of the tiles, referring to vertex ids, to which the seam triangles are added
+        * \param[out] states the state of each of the points after the seam pass (of the points within the search
+        * radius of a tile border only)
+        */
+      void
+      stitchTiles (const PointCloudInConstPtr &points, const std::vector<int> &ids,
+                   const Eigen::Vector3d &origin, double tile_size, const Eigen::Vector3i &dims,
+                   std::vector<pcl::Vertices> &polygons, std::vector<int> &states) const;
+
+      /** \brief Check whether two triangles overlap once projected on the plane of the first one (sharing an edge or
+        * a vertex is no overlap). The second triangle is ignored if all its vertices lie farther than \a max_distance
+        * from that plane, and so is a degenerate first triangle.
+        * \param[in] a the vertices of the first triangle
+        * \param[in] b the vertices of the second triangle
+        * \param[in] max_distance the maximum distance of the second triangle to the plane of the first one
+        */
+      static bool
+      trianglesOverlap (const std::array<Eigen::Vector3d, 3> &a, const std::array<Eigen::Vector3d, 3> &b,
+                        double max_distance);
+
+      /** \brief Get the tile of a grid a point lies in, and the distance of the point to the nearest border between two
+        * tiles (the largest double if the grid has a single tile).
+        * \param[in] point the point
+        * \param[in] origin the minimum corner of the tile grid
+        * \param[in] tile_size the edge length of the tiles
+        * \param[in] dims the number of tiles of the grid along each axis
+        * \param[out] cell the grid coordinates of the tile
+        */
+      static double
+      getTileBorderDistance (const Eigen::Vector3d &point, const Eigen::Vector3d &origin, double tile_size,
+                             const Eigen::Vector3i &dims, Eigen::Vector3i &cell);
+
       /** \brief Class get name method. */
       std::string 
       getClassName () const override { return ("GreedyProjectionTriangulation"); }
@@ -48,10 +48,234 @@
 #include <pcl/common/eigen.h>
 #include <pcl/common/transforms.h>
 #include <pcl/common/io.h>
+#include <pcl/common/parallel.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <algorithm>
+#include <array>
 #include <cstdio>
 #include <cstdlib>
+#include <limits>
+#include <numeric>
 #include <pcl/surface/qhull.h>
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Normal of the line through two 2D points. */
+    inline Eigen::Vector2d
+    hullFacetNormal (const std::array<Eigen::Vector2d, 2> &p)
+    {
+      return (Eigen::Vector2d (p[0].y () - p[1].y (), p[1].x () - p[0].x ()));
+    }
+
+    /** \brief Normal of the plane through three 3D points. */
+    inline Eigen::Vector3d
+    hullFacetNormal (const std::array<Eigen::Vector3d, 3> &p)
+    {
+      return ((p[1] - p[0]).cross (p[2] - p[0]));
+    }
+
+    /** \brief Discard the points which can not be vertices of the convex hull (Akl-Toussaint heuristic).
+      *
+      * The extreme points along the 3^Dim - 1 directions of {-1, 0, 1}^Dim are vertices of the hull, so the points
+      * lying strictly inside the polytope they span are not. This polytope is bounded by the planes through Dim
+      * extreme points which leave all the other ones on the same side.
+      *
+      * \param[in] coords the coordinates of the points, Dim per point
+      * \param[in] nr_threads the number of threads to use (0 for the thread budget)
+      * \return the indices of the remaining points, in increasing order, whatever the number of threads
+      */
+    template <int Dim> std::vector<int>
+    convexHullCandidates (const std::vector<double> &coords, unsigned int nr_threads)
+    {
+      using Vector = Eigen::Matrix<double, Dim, 1>;
+      using VectorVector = std::vector<Vector, Eigen::aligned_allocator<Vector> >;
+      const int nr_points = static_cast<int> (coords.size () / Dim);
+      const auto point = [&coords] (int i) -> Vector { return (Eigen::Map<const Vector> (&coords[i * Dim])); };
+      std::vector<int> candidates (nr_points);
+      std::iota (candidates.begin (), candidates.end (), 0);
+
+      // Directions of {-1, 0, 1}^Dim, except 0
+      VectorVector directions;
+      const int nr_codes = Dim == 2 ? 9 : 27;
+      for (int code = 0; code < nr_codes; ++code)
+      {
+        Vector direction;
+        for (int d = 0, c = code; d < Dim; ++d, c /= 3)
+          direction[d] = c % 3 - 1;
+        if (!direction.isZero ())
+          directions.push_back (direction);
+      }
+
+      // Extreme points, the first one of the cloud in case of ties
+      const int grain_size = 4096;
+      using Extremes = std::vector<int>;
+      const Extremes extremes = pcl::parallel::parallel_reduce (0, nr_points, Extremes (directions.size (), -1),
+        [&] (int first, int last)
+        {
+          Extremes result (directions.size (), -1);
+          for (std::size_t d = 0; d < directions.size (); ++d)
+          {
+            double max_projection = -std::numeric_limits<double>::max ();
+            for (int i = first; i < last; ++i)
+            {
+              const double projection = directions[d].dot (point (i));
+              if (projection > max_projection)
+              {
+                max_projection = projection;
+                result[d] = i;
+              }
+            }
+          }
+          return (result);
+        },
+        [&] (const Extremes &a, const Extremes &b)
+        {
+          Extremes result (a);
+          for (std::size_t d = 0; d < directions.size (); ++d)
+            if (b[d] >= 0 && (result[d] < 0 || directions[d].dot (point (b[d])) > directions[d].dot (point (result[d]))))
+              result[d] = b[d];
+          return (result);
+        }, nr_threads, grain_size);
+
+      VectorVector extreme_points;
+      for (const int index : extremes)
+        if (index >= 0)
+          extreme_points.push_back (point (index));
+      if (extreme_points.size () < Dim + 1)
+        return (candidates);
+
+      // Tolerance on the distances, relative to the size of the cloud
+      double scale = 0;
+      for (const auto &p : extreme_points)
+        scale = (std::max) (scale, (p - extreme_points.front ()).norm ());
+      const double epsilon = 1e-9 * scale;
+      if (!(epsilon > 0))
+        return (candidates);
+
+      // Supporting hyperplanes through Dim extreme points, with the polytope on their negative side
+      VectorVector normals;
+      std::vector<double> offsets;
+      std::array<int, Dim> combination;
+      std::iota (combination.begin (), combination.end (), 0);
+      const int nr_extremes = static_cast<int> (extreme_points.size ());
+      while (combination[0] <= nr_extremes - Dim)
+      {
+        std::array<Vector, Dim> facet;
+        for (int d = 0; d < Dim; ++d)
+          facet[d] = extreme_points[combination[d]];
+        Vector normal = hullFacetNormal (facet);
+        const double norm = normal.norm ();
+        if (norm > 1e-12 * std::pow (scale, Dim - 1))
+        {
+          normal /= norm;
+          const double offset = normal.dot (facet[0]);
+          double min_distance = 0, max_distance = 0;
+          for (const auto &p : extreme_points)
+          {
+            const double distance = normal.dot (p) - offset;
+            min_distance = (std::min) (min_distance, distance);
+            max_distance = (std::max) (max_distance, distance);
+          }
+          if (max_distance <= epsilon)
+          {
+            normals.push_back (normal);
+            offsets.push_back (offset);
+          }
+          if (min_distance >= -epsilon)
+          {
+            normals.push_back (-normal);
+            offsets.push_back (-offset);
+          }
+        }
+
+        // Next combination in lexicographic order
+        int d = Dim - 1;
+        while (d > 0 && combination[d] == nr_extremes - Dim + d)
+          --d;
+        ++combination[d];
+        for (int e = d + 1; e < Dim; ++e)
+          combination[e] = combination[e - 1] + 1;
+      }
+      if (normals.empty ())
+        return (candidates);
+
+      // Keep the points which are not strictly inside the polytope (including invalid ones)
+      const std::size_t nr_blocks = (nr_points + grain_size - 1) / grain_size;
+      std::vector<std::vector<int> > kept (nr_blocks);
+      pcl::parallel::parallel_for (std::size_t (0), nr_blocks, [&] (std::size_t first_block, std::size_t last_block)
+      {
+        for (std::size_t block = first_block; block < last_block; ++block)
+        {
+          const int end = (std::min) (static_cast<int> (block + 1) * grain_size, nr_points);
+          for (int i = static_cast<int> (block) * grain_size; i < end; ++i)
+          {
+            const Vector p = point (i);
+            for (std::size_t h = 0; h < normals.size (); ++h)
+              if (!(normals[h].dot (p) - offsets[h] < -epsilon))
+              {
+                kept[block].push_back (i);
+                break;
+              }
+          }
+        }
+      }, nr_threads, std::size_t (1));
+
+      candidates.clear ();
+      for (const auto &block : kept)
+        candidates.insert (candidates.end (), block.begin (), block.end ());
+      return (candidates);
+    }
+
+    /** \brief Compute the convex hull of 2D points with Andrew's monotone chain algorithm.
+      * \param[in] coords the coordinates of the points, 2 per point
+      * \param[in] candidates the indices of the points to consider
+      * \return the indices of the hull vertices in counter-clockwise order, without collinear points
+      */
+    inline std::vector<int>
+    convexHull2D (const std::vector<double> &coords, std::vector<int> candidates)
+    {
+      const auto less = [&coords] (int a, int b)
+      {
+        if (coords[2 * a] != coords[2 * b])
+          return (coords[2 * a] < coords[2 * b]);
+        if (coords[2 * a + 1] != coords[2 * b + 1])
+          return (coords[2 * a + 1] < coords[2 * b + 1]);
+        return (a < b);
+      };
+      const auto cross = [&coords] (int o, int a, int b)
+      {
+        return ((coords[2 * a] - coords[2 * o]) * (coords[2 * b + 1] - coords[2 * o + 1]) -
+                (coords[2 * a + 1] - coords[2 * o + 1]) * (coords[2 * b] - coords[2 * o]));
+      };
+
+      std::sort (candidates.begin (), candidates.end (), less);
+      if (candidates.size () < 3)
+        return (candidates);
+
+      // Lower hull from left to right, then upper hull from right to left
+      std::vector<int> hull (2 * candidates.size ());
+      std::size_t k = 0;
+      for (std::size_t i = 0; i < candidates.size (); ++i)
+      {
+        while (k >= 2 && cross (hull[k - 2], hull[k - 1], candidates[i]) <= 0)
+          --k;
+        hull[k++] = candidates[i];
+      }
+      for (std::size_t i = candidates.size () - 1, lower_size = k + 1; i > 0; --i)
+      {
+        while (k >= lower_size && cross (hull[k - 2], hull[k - 1], candidates[i - 1]) <= 0)
+          --k;
+        hull[k++] = candidates[i - 1];
+      }
+      // The first point was added again at the end
+      hull.resize (k - 1);
+      return (hull);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::ConvexHull<PointInT>::calculateInputDimension ()
@@ -76,7 +300,6 @@ template <typename PointInT> void
 pcl::ConvexHull<PointInT>::performReconstruction2D (PointCloud &hull, std::vector<pcl::Vertices> &polygons,
                                                     bool)
 {
-  int dimension = 2;
   bool xy_proj_safe = true;
   bool yz_proj_safe = true;
   bool xz_proj_safe = true;
@@ -131,104 +354,89 @@ pcl::ConvexHull<PointInT>::performReconstruction2D (PointCloud &hull, std::vecto
     yz_proj_safe = false;
   }
 
-  // True if qhull should free points in qh_freeqhull() or reallocation
-  boolT ismalloc = True;
-  // output from qh_produce_output(), use NULL to skip qh_produce_output()
-  FILE *outfile = nullptr;
-
-#ifndef HAVE_QHULL_2011
-  if (compute_area_)
-    outfile = stderr;
-#endif
-
-  // option flags for qhull, see qh_opt.htm
-  const char* flags = qhull_flags.c_str ();
-  // error messages from qhull code
-  FILE *errfile = stderr;
-
-  // Array of coordinates for each point
-  coordT *points = reinterpret_cast<coordT*> (calloc (indices_->size () * dimension, sizeof (coordT)));
-
-  // Build input data, using appropriate projection
-  int j = 0;
+  // Coordinates of the points in the chosen projection
+  int u_axis = 0, v_axis = 1;
   if (xy_proj_safe)
   {
-    for (std::size_t i = 0; i < indices_->size (); ++i, j+=dimension)
-    {
-      points[j + 0] = static_cast<coordT> (input_->points[(*indices_)[i]].x);
-      points[j + 1] = static_cast<coordT> (input_->points[(*indices_)[i]].y);
-    }
-  } 
+    u_axis = 0;
+    v_axis = 1;
+  }
   else if (yz_proj_safe)
   {
-    for (std::size_t i = 0; i < indices_->size (); ++i, j+=dimension)
-    {
-      points[j + 0] = static_cast<coordT> (input_->points[(*indices_)[i]].y);
-      points[j + 1] = static_cast<coordT> (input_->points[(*indices_)[i]].z);
-    }
+    u_axis = 1;
+    v_axis = 2;
   }
   else if (xz_proj_safe)
   {
-    for (std::size_t i = 0; i < indices_->size (); ++i, j+=dimension)
-    {
-      points[j + 0] = static_cast<coordT> (input_->points[(*indices_)[i]].x);
-      points[j + 1] = static_cast<coordT> (input_->points[(*indices_)[i]].z);
-    }
+    u_axis = 0;
+    v_axis = 2;
   }
   else
   {
     // This should only happen if we had invalid input
     PCL_ERROR ("[pcl::%s::performReconstruction2D] Invalid input!\n", getClassName ().c_str ());
+    hull.points.resize (0);
+    hull.width = hull.height = 0;
+    polygons.resize (0);
+    return;
   }
-   
-  // Compute convex hull
-  int exitcode = qh_new_qhull (dimension, static_cast<int> (indices_->size ()), points, ismalloc, const_cast<char*> (flags), outfile, errfile);
-#ifdef HAVE_QHULL_2011
-  if (compute_area_)
+
+  // Positions in indices_ of the finite points, which are the only ones the hull is computed on
+  std::vector<int> finite_positions;
+  finite_positions.reserve (indices_->size ());
+  for (std::size_t i = 0; i < indices_->size (); ++i)
+    if (input_->is_dense || pcl::isFinite (input_->points[(*indices_)[i]]))
+      finite_positions.push_back (static_cast<int> (i));
+
+  std::vector<double> coords (2 * finite_positions.size ());
+  pcl::parallel::parallel_for (std::size_t (0), finite_positions.size (), [&] (std::size_t first, std::size_t last)
   {
-    qh_prepare_output();
-  }
-#endif
-    
-  // 0 if no error from qhull or it doesn't find any vertices
-  if (exitcode != 0 || qh num_vertices == 0)
+    for (std::size_t i = first; i < last; ++i)
+    {
+      const PointInT &p = input_->points[(*indices_)[finite_positions[i]]];
+      coords[2 * i + 0] = static_cast<double> (p.data[u_axis]);
+      coords[2 * i + 1] = static_cast<double> (p.data[v_axis]);
+    }
+  }, threads_);
+
+  // Compute convex hull
+  std::vector<int> candidates = pcl::detail::convexHullCandidates<2> (coords, threads_);
+  std::vector<int> hull_vertices = pcl::detail::convexHull2D (coords, std::move (candidates));
+
+  // Degenerate input, e.g. collinear points
+  if (hull_vertices.size () < 3)
   {
-    PCL_ERROR ("[pcl::%s::performReconstrution2D] ERROR: qhull was unable to compute a convex hull for the given point cloud (%lu)!\n", getClassName ().c_str (), indices_->size ());
+    PCL_ERROR ("[pcl::%s::performReconstrution2D] ERROR: unable to compute a convex hull for the given point cloud (%lu)!\n", getClassName ().c_str (), indices_->size ());
 
     hull.points.resize (0);
     hull.width = hull.height = 0;
     polygons.resize (0);
-
-    qh_freeqhull (!qh_ALL);
-    int curlong, totlong;
-    qh_memfreeshort (&curlong, &totlong);
-
     return;
   }
 
-  // Qhull returns the area in volume for 2D
+  // Area of the polygon in the projection, as reported by qhull before
   if (compute_area_)
   {
-    total_area_ = qh totvol;
+    double area = 0;
+    for (std::size_t i = 0, j = hull_vertices.size () - 1; i < hull_vertices.size (); j = i++)
+      area += coords[2 * hull_vertices[j]] * coords[2 * hull_vertices[i] + 1] -
+              coords[2 * hull_vertices[i]] * coords[2 * hull_vertices[j] + 1];
+    total_area_ = 0.5 * std::abs (area);
     total_volume_ = 0.0;
   }
 
-  int num_vertices = qh num_vertices;
-  hull.points.resize (num_vertices);
-  memset (&hull.points[0], static_cast<int> (hull.points.size ()), sizeof (PointInT));
+  // Back to positions in indices_
+  for (int &vertex : hull_vertices)
+    vertex = finite_positions[vertex];
 
-  vertexT * vertex;
-  int i = 0;
+  const int num_vertices = static_cast<int> (hull_vertices.size ());
+  hull.points.resize (num_vertices);
 
   std::vector<std::pair<int, Eigen::Vector4f>, Eigen::aligned_allocator<std::pair<int, Eigen::Vector4f> > > idx_points (num_vertices);
-  idx_points.resize (hull.points.size ());
-  memset (&idx_points[0], static_cast<int> (hull.points.size ()), sizeof (std::pair<int, Eigen::Vector4f>));
-
-  FORALLvertices
+  for (int i = 0; i < num_vertices; ++i)
   {
-    hull.points[i] = input_->points[(*indices_)[qh_pointid (vertex->point)]];
-    idx_points[i].first = qh_pointid (vertex->point);
-    ++i;
+    hull.points[i] = input_->points[(*indices_)[hull_vertices[i]]];
+    idx_points[i].first = hull_vertices[i];
   }
 
   // Sort
@@ -273,10 +481,6 @@ pcl::ConvexHull<PointInT>::performReconstruction2D (PointCloud &hull, std::vecto
     hull.points[j] = input_->points[(*indices_)[idx_points[j].first]];
     polygons[0].vertices[j] = static_cast<unsigned int> (j);
   }
-    
-  qh_freeqhull (!qh_ALL);
-  int curlong, totlong;
-  qh_memfreeshort (&curlong, &totlong);
 
   hull.width = static_cast<std::uint32_t> (hull.points.size ());
   hull.height = 1;
@@ -309,19 +513,32 @@ pcl::ConvexHull<PointInT>::performReconstruction3D (
   // error messages from qhull code
   FILE *errfile = stderr;
 
+  // Discard the points which can not be on the hull
+  std::vector<double> coords (indices_->size () * dimension);
+  pcl::parallel::parallel_for (std::size_t (0), indices_->size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+    {
+      coords[i * dimension + 0] = static_cast<double> (input_->points[(*indices_)[i]].x);
+      coords[i * dimension + 1] = static_cast<double> (input_->points[(*indices_)[i]].y);
+      coords[i * dimension + 2] = static_cast<double> (input_->points[(*indices_)[i]].z);
+    }
+  }, threads_);
+  const std::vector<int> candidates = pcl::detail::convexHullCandidates<3> (coords, threads_);
+
   // Array of coordinates for each point
-  coordT *points = reinterpret_cast<coordT*> (calloc (indices_->size () * dimension, sizeof (coordT)));
+  coordT *points = reinterpret_cast<coordT*> (calloc (candidates.size () * dimension, sizeof (coordT)));
 
   int j = 0;
-  for (std::size_t i = 0; i < indices_->size (); ++i, j+=dimension)
+  for (std::size_t i = 0; i < candidates.size (); ++i, j+=dimension)
   {
-    points[j + 0] = static_cast<coordT> (input_->points[(*indices_)[i]].x);
-    points[j + 1] = static_cast<coordT> (input_->points[(*indices_)[i]].y);
-    points[j + 2] = static_cast<coordT> (input_->points[(*indices_)[i]].z);
+    points[j + 0] = static_cast<coordT> (coords[candidates[i] * dimension + 0]);
+    points[j + 1] = static_cast<coordT> (coords[candidates[i] * dimension + 1]);
+    points[j + 2] = static_cast<coordT> (coords[candidates[i] * dimension + 2]);
   }
 
   // Compute convex hull
-  int exitcode = qh_new_qhull (dimension, static_cast<int> (indices_->size ()), points, ismalloc, const_cast<char*> (flags), outfile, errfile);
+  int exitcode = qh_new_qhull (dimension, static_cast<int> (candidates.size ()), points, ismalloc, const_cast<char*> (flags), outfile, errfile);
 #ifdef HAVE_QHULL_2011
   if (compute_area_)
   {
@@ -372,7 +589,7 @@ pcl::ConvexHull<PointInT>::performReconstruction3D (
   FORALLvertices
   {
     // Add vertices to hull point_cloud and store index
-    hull_indices_.indices.push_back ((*indices_)[qh_pointid (vertex->point)]);
+    hull_indices_.indices.push_back ((*indices_)[candidates[qh_pointid (vertex->point)]]);
     hull.points[i] = input_->points[hull_indices_.indices.back ()];
 
     qhid_to_pcidx[vertex->id] = i; // map the vertex id of qhull to the point cloud index
@@ -39,6 +39,13 @@
 #define PCL_SURFACE_IMPL_GP3_H_
 
 #include <pcl/surface/gp3.h>
+#include <pcl/common/parallel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
@@ -77,6 +84,9 @@ pcl::GreedyProjectionTriangulation<PointInT>::reconstructPolygons (std::vector<p
     polygons.clear ();
     return (false);
   }
+  if (tile_size_ > 0)
+    return (reconstructTiledPolygons (polygons));
+
   const double sqr_mu = mu_*mu_;
   const double sqr_max_edge = search_radius_*search_radius_;
   if (nnn_ > static_cast<int> (indices_->size ()))
@@ -1656,6 +1666,622 @@ pcl::GreedyProjectionTriangulation<PointInT>::connectPoint (
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::GreedyProjectionTriangulation<PointInT>::reconstructTiledPolygons (std::vector<pcl::Vertices> &polygons)
+{
+  const double tile_size = (std::max) (tile_size_, 3 * search_radius_);
+  const double margin = search_radius_;
+
+  polygons.clear ();
+  part_.assign (indices_->size (), -1);
+  state_.assign (indices_->size (), NONE);
+  source_.clear ();
+  ffn_.clear ();
+  sfn_.clear ();
+  fringe_queue_.clear ();
+
+  // Bounding box of the valid points
+  std::vector<int> valid;
+  valid.reserve (indices_->size ());
+  Eigen::Vector3d min_pt = Eigen::Vector3d::Constant (std::numeric_limits<double>::max ());
+  Eigen::Vector3d max_pt = Eigen::Vector3d::Constant (-std::numeric_limits<double>::max ());
+  for (std::size_t i = 0; i < indices_->size (); ++i)
+  {
+    const PointInT &point = input_->points[(*indices_)[i]];
+    if (!std::isfinite (point.x) || !std::isfinite (point.y) || !std::isfinite (point.z))
+      continue;
+    valid.push_back (static_cast<int> (i));
+    min_pt = min_pt.cwiseMin (point.getVector3fMap ().template cast<double> ());
+    max_pt = max_pt.cwiseMax (point.getVector3fMap ().template cast<double> ());
+  }
+  if (valid.empty ())
+    return (true);
+
+  const Eigen::Vector3i dims = ((max_pt - min_pt) / tile_size).array ().floor ().template cast<int> () + 1;
+  const auto tileKey = [&dims] (const Eigen::Vector3i &cell)
+  {
+    return ((static_cast<std::uint64_t> (cell[0]) * dims[1] + cell[1]) * dims[2] + cell[2]);
+  };
+
+  // Every point goes to its own tile, and to the margin of the neighboring tiles it is close to
+  std::unordered_map<std::uint64_t, std::vector<int> > tile_points;
+  std::vector<std::uint64_t> own_tile (indices_->size ());
+  std::vector<double> border_distance (indices_->size (), std::numeric_limits<double>::max ());
+  for (const int i : valid)
+  {
+    const Eigen::Vector3d p = input_->points[(*indices_)[i]].getVector3fMap ().template cast<double> ();
+    Eigen::Vector3i cell, lo, hi;
+    border_distance[i] = getTileBorderDistance (p, min_pt, tile_size, dims, cell);
+    for (int d = 0; d < 3; ++d)
+    {
+      const double offset = p[d] - (min_pt[d] + cell[d] * tile_size);
+      lo[d] = (cell[d] > 0 && offset <= margin) ? cell[d] - 1 : cell[d];
+      hi[d] = (cell[d] + 1 < dims[d] && tile_size - offset <= margin) ? cell[d] + 1 : cell[d];
+    }
+    own_tile[i] = tileKey (cell);
+    for (int x = lo[0]; x <= hi[0]; ++x)
+      for (int y = lo[1]; y <= hi[1]; ++y)
+        for (int z = lo[2]; z <= hi[2]; ++z)
+          tile_points[tileKey (Eigen::Vector3i (x, y, z))].push_back (i);
+  }
+
+  // Tiles are processed and their triangles concatenated in a fixed order
+  std::vector<std::uint64_t> keys;
+  keys.reserve (tile_points.size ());
+  for (const auto &tile : tile_points)
+    keys.push_back (tile.first);
+  std::sort (keys.begin (), keys.end ());
+
+  std::vector<std::vector<pcl::Vertices> > tile_polygons (keys.size ());
+  pcl::parallel::parallel_for (std::size_t (0), keys.size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t t = first; t < last; ++t)
+    {
+      const std::vector<int> &members = tile_points.at (keys[t]);
+      PointCloudInPtr cloud (new PointCloudIn);
+      cloud->points.reserve (members.size ());
+      for (const int i : members)
+        cloud->points.push_back (input_->points[(*indices_)[i]]);
+      cloud->width = static_cast<std::uint32_t> (cloud->points.size ());
+      cloud->height = 1;
+      cloud->is_dense = true;
+
+      const Eigen::Vector3i cell (static_cast<int> (keys[t] / (static_cast<std::uint64_t> (dims[1]) * dims[2])),
+                                  static_cast<int> ((keys[t] / dims[2]) % dims[1]),
+                                  static_cast<int> (keys[t] % dims[2]));
+      std::vector<int> states;
+      triangulateTile (cloud, min_pt, tile_size, dims, cell, tile_polygons[t], states);
+      for (auto &triangle : tile_polygons[t])
+        for (auto &vertex : triangle.vertices)
+          vertex = members[vertex];
+
+      // Only the tile a point lies in reports its state, so that no two tiles write the same entry
+      for (std::size_t j = 0; j < members.size (); ++j)
+        if (own_tile[members[j]] == keys[t])
+          state_[members[j]] = states[j];
+    }
+  }, threads_, std::size_t (1));
+
+  std::size_t nr_polygons = 0;
+  for (const auto &triangles : tile_polygons)
+    nr_polygons += triangles.size ();
+  polygons.reserve (nr_polygons);
+  for (const auto &triangles : tile_polygons)
+    polygons.insert (polygons.end (), triangles.begin (), triangles.end ());
+  const std::size_t nr_tile_polygons = polygons.size ();
+
+  // Stitch the tiles along their borders
+  PointCloudInPtr seam (new PointCloudIn);
+  std::vector<int> seam_ids;
+  for (const int i : valid)
+  {
+    if (border_distance[i] > 3 * search_radius_)
+      continue;
+    seam->points.push_back (input_->points[(*indices_)[i]]);
+    seam_ids.push_back (i);
+  }
+  seam->width = static_cast<std::uint32_t> (seam->points.size ());
+  seam->height = 1;
+  seam->is_dense = true;
+  std::vector<int> seam_states;
+  stitchTiles (seam, seam_ids, min_pt, tile_size, dims, polygons, seam_states);
+  for (std::size_t j = 0; j < seam_ids.size (); ++j)
+    if (border_distance[seam_ids[j]] <= search_radius_)
+      state_[seam_ids[j]] = seam_states[j];
+
+  // The parts are the connected components of the mesh, numbered in the order of their first point
+  std::vector<int> root (indices_->size ());
+  std::iota (root.begin (), root.end (), 0);
+  const auto findRoot = [&root] (int i)
+  {
+    while (root[i] != i)
+      i = root[i] = root[root[i]];
+    return (i);
+  };
+  for (const auto &triangle : polygons)
+    for (std::size_t k = 1; k < triangle.vertices.size (); ++k)
+    {
+      const int a = findRoot (static_cast<int> (triangle.vertices[0]));
+      const int b = findRoot (static_cast<int> (triangle.vertices[k]));
+      root[b] = a;
+    }
+  std::vector<bool> used (indices_->size (), false);
+  for (const auto &triangle : polygons)
+    for (const auto &vertex : triangle.vertices)
+      used[vertex] = true;
+  std::vector<int> root_part (indices_->size (), -1);
+  int nr_parts = 0;
+  for (std::size_t i = 0; i < indices_->size (); ++i)
+  {
+    if (!used[i])
+      continue;
+    const int r = findRoot (static_cast<int> (i));
+    if (root_part[r] < 0)
+      root_part[r] = nr_parts++;
+    part_[i] = root_part[r];
+  }
+
+  PCL_DEBUG ("[pcl::%s::reconstructTiledPolygons] %lu triangles from %lu tiles and %lu along their borders.\n",
+             getClassName ().c_str (), polygons.size (), keys.size (), polygons.size () - nr_tile_polygons);
+  return (true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::GreedyProjectionTriangulation<PointInT>::reconstructOutOfCore (const TileSource &source,
+                                                                    const Eigen::Vector3f &min_pt,
+                                                                    const Eigen::Vector3f &max_pt,
+                                                                    std::vector<pcl::Vertices> &polygons)
+{
+  polygons.clear ();
+  part_.clear ();
+  state_.clear ();
+  if (search_radius_ <= 0 || mu_ <= 0 || tile_size_ <= 0 || !source || (min_pt.array () > max_pt.array ()).any ())
+  {
+    PCL_ERROR ("[pcl::%s::reconstructOutOfCore] Invalid parameters: search radius (%f), mu (%f), tile size (%f) or bounding box.\n",
+               getClassName ().c_str (), search_radius_, mu_, tile_size_);
+    return (false);
+  }
+
+  const double tile_size = (std::max) (tile_size_, 3 * search_radius_);
+  const Eigen::Vector3d origin = min_pt.cast<double> ();
+  const Eigen::Vector3i dims = ((max_pt.cast<double> () - origin) / tile_size).array ().floor ().template cast<int> () + 1;
+  const std::size_t nr_tiles = static_cast<std::size_t> (dims[0]) * dims[1] * dims[2];
+  // Keep only as many tiles in memory as can be triangulated at the same time
+  const unsigned int budget = pcl::parallel::getThreadBudget ();
+  const std::size_t batch_size = (std::max) (1u, threads_ == 0 ? budget : (std::min) (threads_, budget));
+
+  // The points along the tile borders are kept for the seam pass
+  PointCloudIn seam_points;
+  std::vector<int> seam_ids;
+  for (std::size_t batch_begin = 0; batch_begin < nr_tiles; batch_begin += batch_size)
+  {
+    const std::size_t batch_end = (std::min) (batch_begin + batch_size, nr_tiles);
+    std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> > cells (batch_end - batch_begin);
+    std::vector<PointCloudInPtr> clouds (batch_end - batch_begin);
+    std::vector<std::vector<int> > ids (batch_end - batch_begin);
+    for (std::size_t t = batch_begin; t < batch_end; ++t)
+    {
+      const std::size_t k = t - batch_begin;
+      cells[k] = Eigen::Vector3i (static_cast<int> (t / (static_cast<std::size_t> (dims[1]) * dims[2])),
+                                  static_cast<int> ((t / dims[2]) % dims[1]),
+                                  static_cast<int> (t % dims[2]));
+      const Eigen::Vector3d tile_min = origin + cells[k].cast<double> () * tile_size;
+      const Eigen::Vector3f box_min = (tile_min.array () - search_radius_).cast<float> ();
+      const Eigen::Vector3f box_max = (tile_min.array () + tile_size + search_radius_).cast<float> ();
+      clouds[k].reset (new PointCloudIn);
+      if (!source (box_min, box_max, *clouds[k], ids[k]) || ids[k].size () != clouds[k]->points.size ())
+      {
+        PCL_ERROR ("[pcl::%s::reconstructOutOfCore] Could not get the points of tile (%d, %d, %d).\n",
+                   getClassName ().c_str (), cells[k][0], cells[k][1], cells[k][2]);
+        polygons.clear ();
+        return (false);
+      }
+    }
+
+    std::vector<std::vector<pcl::Vertices> > tile_polygons (batch_end - batch_begin);
+    std::vector<std::vector<int> > tile_seam (batch_end - batch_begin);
+    pcl::parallel::parallel_for (std::size_t (0), clouds.size (), [&] (std::size_t first, std::size_t last)
+    {
+      for (std::size_t k = first; k < last; ++k)
+      {
+        std::vector<int> states;
+        triangulateTile (clouds[k], origin, tile_size, dims, cells[k], tile_polygons[k], states);
+        for (auto &triangle : tile_polygons[k])
+          for (auto &vertex : triangle.vertices)
+            vertex = ids[k][vertex];
+        for (std::size_t j = 0; j < clouds[k]->points.size (); ++j)
+        {
+          Eigen::Vector3i cell;
+          const double distance = getTileBorderDistance (clouds[k]->points[j].getVector3fMap ().template cast<double> (),
+                                                         origin, tile_size, dims, cell);
+          if (cell == cells[k] && distance <= 3 * search_radius_)
+            tile_seam[k].push_back (static_cast<int> (j));
+        }
+      }
+    }, threads_, std::size_t (1));
+
+    for (std::size_t k = 0; k < clouds.size (); ++k)
+    {
+      polygons.insert (polygons.end (), tile_polygons[k].begin (), tile_polygons[k].end ());
+      for (const int j : tile_seam[k])
+      {
+        seam_points.push_back (clouds[k]->points[j]);
+        seam_ids.push_back (ids[k][j]);
+      }
+    }
+  }
+
+  // Stitch the tiles along their borders, with the points in the order of their ids as for reconstruct ()
+  std::vector<int> order (seam_ids.size ());
+  std::iota (order.begin (), order.end (), 0);
+  std::sort (order.begin (), order.end (), [&seam_ids] (int a, int b) { return (seam_ids[a] < seam_ids[b]); });
+  PointCloudInPtr seam (new PointCloudIn);
+  std::vector<int> sorted_ids (order.size ());
+  seam->points.reserve (order.size ());
+  for (std::size_t j = 0; j < order.size (); ++j)
+  {
+    seam->points.push_back (seam_points.points[order[j]]);
+    sorted_ids[j] = seam_ids[order[j]];
+  }
+  seam_points.clear ();
+  seam->width = static_cast<std::uint32_t> (seam->points.size ());
+  seam->height = 1;
+  seam->is_dense = true;
+  std::vector<int> seam_states;
+  stitchTiles (seam, sorted_ids, origin, tile_size, dims, polygons, seam_states);
+  return (true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> double
+pcl::GreedyProjectionTriangulation<PointInT>::getTileBorderDistance (const Eigen::Vector3d &point,
+                                                                     const Eigen::Vector3d &origin, double tile_size,
+                                                                     const Eigen::Vector3i &dims, Eigen::Vector3i &cell)
+{
+  double distance = std::numeric_limits<double>::max ();
+  for (int d = 0; d < 3; ++d)
+  {
+    cell[d] = (std::max) (0, (std::min) (static_cast<int> (std::floor ((point[d] - origin[d]) / tile_size)), dims[d] - 1));
+    const double offset = point[d] - (origin[d] + cell[d] * tile_size);
+    if (cell[d] > 0)
+      distance = (std::min) (distance, offset);
+    if (cell[d] + 1 < dims[d])
+      distance = (std::min) (distance, tile_size - offset);
+  }
+  return (distance);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::GreedyProjectionTriangulation<PointInT>::triangulatePoints (const PointCloudInConstPtr &points,
+                                                                 std::vector<pcl::Vertices> &polygons,
+                                                                 std::vector<int> &states) const
+{
+  polygons.clear ();
+  states.clear ();
+  if (points->points.size () >= 3)
+  {
+    GreedyProjectionTriangulation<PointInT> gp3;
+    gp3.setMu (mu_);
+    gp3.setSearchRadius (search_radius_);
+    gp3.setMaximumNearestNeighbors (nnn_);
+    gp3.setMinimumAngle (minimum_angle_);
+    gp3.setMaximumAngle (maximum_angle_);
+    gp3.setMaximumSurfaceAngle (eps_angle_);
+    gp3.setNormalConsistency (consistent_);
+    gp3.setConsistentVertexOrdering (consistent_ordering_);
+    gp3.setInputCloud (points);
+    gp3.reconstruct (polygons);
+    states = gp3.getPointStates ();
+  }
+  if (states.size () != points->points.size ())
+    states.assign (points->points.size (), NONE);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::GreedyProjectionTriangulation<PointInT>::triangulateTile (const PointCloudInConstPtr &points,
+                                                               const Eigen::Vector3d &origin, double tile_size,
+                                                               const Eigen::Vector3i &dims, const Eigen::Vector3i &cell,
+                                                               std::vector<pcl::Vertices> &polygons,
+                                                               std::vector<int> &states) const
+{
+  std::vector<pcl::Vertices> tile_polygons;
+  triangulatePoints (points, tile_polygons, states);
+
+  // Keep the triangles whose vertices all lie in this tile, farther than the search radius from the other tiles.
+  // Their neighborhoods are complete within the margin, and since no edge is longer than the search radius, no
+  // other tile builds them.
+  std::vector<bool> interior (points->points.size ());
+  for (std::size_t j = 0; j < points->points.size (); ++j)
+  {
+    Eigen::Vector3i point_cell;
+    const double distance = getTileBorderDistance (points->points[j].getVector3fMap ().template cast<double> (),
+                                                   origin, tile_size, dims, point_cell);
+    interior[j] = (point_cell == cell && distance > search_radius_);
+  }
+  polygons.clear ();
+  polygons.reserve (tile_polygons.size ());
+  for (const auto &triangle : tile_polygons)
+  {
+    if (std::all_of (triangle.vertices.begin (), triangle.vertices.end (),
+                     [&interior] (const std::uint32_t vertex) { return (interior[vertex]); }))
+      polygons.push_back (triangle);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::GreedyProjectionTriangulation<PointInT>::stitchTiles (const PointCloudInConstPtr &points,
+                                                           const std::vector<int> &ids,
+                                                           const Eigen::Vector3d &origin, double tile_size,
+                                                           const Eigen::Vector3i &dims,
+                                                           std::vector<pcl::Vertices> &polygons,
+                                                           std::vector<int> &states) const
+{
+  const std::size_t nr_points = ids.size ();
+  const double radius = search_radius_;
+  states.assign (nr_points, NONE);
+
+  const auto tileKey = [&dims] (const Eigen::Vector3i &cell)
+  {
+    return ((static_cast<std::uint64_t> (cell[0]) * dims[1] + cell[1]) * dims[2] + cell[2]);
+  };
+  const auto tileCell = [&dims] (std::uint64_t key)
+  {
+    return (Eigen::Vector3i (static_cast<int> (key / (static_cast<std::uint64_t> (dims[1]) * dims[2])),
+                             static_cast<int> ((key / dims[2]) % dims[1]),
+                             static_cast<int> (key % dims[2])));
+  };
+  const auto seamIndex = [&ids] (int id)
+  {
+    const auto it = std::lower_bound (ids.begin (), ids.end (), id);
+    return ((it != ids.end () && *it == id) ? static_cast<int> (it - ids.begin ()) : -1);
+  };
+  const auto position = [&points] (int j)
+  {
+    return (Eigen::Vector3d (points->points[j].getVector3fMap ().template cast<double> ()));
+  };
+  const auto edgeKey = [] (int a, int b)
+  {
+    return ((static_cast<std::uint64_t> ((std::min) (a, b)) << 32) | static_cast<std::uint32_t> ((std::max) (a, b)));
+  };
+
+  std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> > cells (nr_points);
+  std::vector<double> border_distance (nr_points);
+  for (std::size_t j = 0; j < nr_points; ++j)
+    border_distance[j] = getTileBorderDistance (position (static_cast<int> (j)), origin, tile_size, dims, cells[j]);
+
+  // One seam unit per tile with points within the search radius of its borders. A unit triangulates the points
+  // within twice the search radius of a border around its tile, and adds the triangles with one of these points
+  // as a vertex.
+  std::vector<std::uint64_t> unit_keys;
+  for (std::size_t j = 0; j < nr_points; ++j)
+    if (border_distance[j] <= radius)
+      unit_keys.push_back (tileKey (cells[j]));
+  std::sort (unit_keys.begin (), unit_keys.end ());
+  unit_keys.erase (std::unique (unit_keys.begin (), unit_keys.end ()), unit_keys.end ());
+  const auto forUnitsAround = [&] (const Eigen::Vector3d &p, double margin, auto &&visit)
+  {
+    Eigen::Vector3i cell, lo, hi;
+    getTileBorderDistance (p, origin, tile_size, dims, cell);
+    for (int d = 0; d < 3; ++d)
+    {
+      const double offset = p[d] - (origin[d] + cell[d] * tile_size);
+      lo[d] = (cell[d] > 0 && offset <= margin) ? cell[d] - 1 : cell[d];
+      hi[d] = (cell[d] + 1 < dims[d] && tile_size - offset <= margin) ? cell[d] + 1 : cell[d];
+    }
+    for (int x = lo[0]; x <= hi[0]; ++x)
+      for (int y = lo[1]; y <= hi[1]; ++y)
+        for (int z = lo[2]; z <= hi[2]; ++z)
+        {
+          const auto it = std::lower_bound (unit_keys.begin (), unit_keys.end (), tileKey (Eigen::Vector3i (x, y, z)));
+          if (it != unit_keys.end () && *it == tileKey (Eigen::Vector3i (x, y, z)))
+            visit (static_cast<int> (it - unit_keys.begin ()));
+        }
+  };
+  std::vector<std::vector<int> > unit_points (unit_keys.size ());
+  for (std::size_t j = 0; j < nr_points; ++j)
+    if (border_distance[j] <= 2 * radius)
+      forUnitsAround (position (static_cast<int> (j)), 2 * radius,
+                      [&] (int u) { unit_points[u].push_back (static_cast<int> (j)); });
+
+  // The triangles whose vertices are all seam points, with the units they are close enough to for overlapping a
+  // triangle of the unit, and the number of triangles on each of their edges
+  std::vector<std::array<int, 3> > triangles;
+  std::vector<std::vector<int> > unit_triangles (unit_keys.size ());
+  std::unordered_map<std::uint64_t, int> nr_triangles;
+  const auto addTriangle = [&] (const std::array<int, 3> &triangle)
+  {
+    for (int k = 0; k < 3; ++k)
+      ++nr_triangles[edgeKey (triangle[k], triangle[(k + 1) % 3])];
+    const int t = static_cast<int> (triangles.size ());
+    triangles.push_back (triangle);
+    const Eigen::Vector3d centroid = (position (triangle[0]) + position (triangle[1]) + position (triangle[2])) / 3.0;
+    forUnitsAround (centroid, 2 * radius, [&] (int u) { unit_triangles[u].push_back (t); });
+  };
+  for (const auto &polygon : polygons)
+  {
+    if (polygon.vertices.size () != 3)
+      continue;
+    std::array<int, 3> triangle;
+    bool on_seam = true;
+    for (int k = 0; k < 3 && on_seam; ++k)
+      on_seam = ((triangle[k] = seamIndex (static_cast<int> (polygon.vertices[k]))) >= 0);
+    if (on_seam)
+      addTriangle (triangle);
+  }
+
+  // The triangles of a unit lie within the search radius of its tile, so the units of tiles which do not touch,
+  // not even by a corner, are independent. They are processed in eight rounds by the parity of their tile
+  // coordinates, the units of a round in parallel, and their triangles are added in the order of the units.
+  std::vector<std::vector<std::array<int, 3> > > unit_polygons (unit_keys.size ());
+  for (int parity = 0; parity < 8; ++parity)
+  {
+    std::vector<int> round;
+    for (std::size_t u = 0; u < unit_keys.size (); ++u)
+    {
+      const Eigen::Vector3i cell = tileCell (unit_keys[u]);
+      if (((cell[0] & 1) | ((cell[1] & 1) << 1) | ((cell[2] & 1) << 2)) == parity)
+        round.push_back (static_cast<int> (u));
+    }
+
+    pcl::parallel::parallel_for (std::size_t (0), round.size (), [&] (std::size_t first, std::size_t last)
+    {
+      for (std::size_t r = first; r < last; ++r)
+      {
+        const int u = round[r];
+        const Eigen::Vector3i unit_cell = tileCell (unit_keys[u]);
+        const std::vector<int> &members = unit_points[u];
+        PointCloudInPtr cloud (new PointCloudIn);
+        cloud->points.reserve (members.size ());
+        for (const int j : members)
+          cloud->points.push_back (points->points[j]);
+        cloud->width = static_cast<std::uint32_t> (cloud->points.size ());
+        cloud->height = 1;
+        cloud->is_dense = true;
+
+        std::vector<pcl::Vertices> candidates;
+        std::vector<int> unit_states;
+        triangulatePoints (cloud, candidates, unit_states);
+        const auto owned = [&] (int j) { return (cells[j] == unit_cell && border_distance[j] <= radius); };
+        for (std::size_t m = 0; m < members.size (); ++m)
+          if (owned (members[m]))
+            states[members[m]] = unit_states[m];
+
+        // The triangles around, in a grid of cells of twice the search radius (by their centroid)
+        const Eigen::Vector3d grid_origin = (origin + unit_cell.cast<double> () * tile_size).array () - 3 * radius;
+        const auto gridKey = [&] (const std::array<int, 3> &triangle, const Eigen::Vector3i &shift)
+        {
+          const Eigen::Vector3d centroid = (position (triangle[0]) + position (triangle[1]) + position (triangle[2])) / 3.0;
+          const Eigen::Vector3i cell = ((centroid - grid_origin) / (2 * radius)).array ().floor ().template cast<int> () + shift.array ();
+          return ((static_cast<std::uint64_t> (cell[0] & 0x1fffff) << 42) |
+                  (static_cast<std::uint64_t> (cell[1] & 0x1fffff) << 21) |
+                   static_cast<std::uint64_t> (cell[2] & 0x1fffff));
+        };
+        std::vector<std::array<int, 3> > nearby;
+        std::unordered_map<std::uint64_t, std::vector<int> > grid;
+        const auto addNearby = [&] (const std::array<int, 3> &triangle)
+        {
+          grid[gridKey (triangle, Eigen::Vector3i::Zero ())].push_back (static_cast<int> (nearby.size ()));
+          nearby.push_back (triangle);
+        };
+        for (const int t : unit_triangles[u])
+          addNearby (triangles[t]);
+
+        std::unordered_map<std::uint64_t, int> unit_nr_triangles;
+        const auto nrTriangles = [&] (int a, int b)
+        {
+          const auto global = nr_triangles.find (edgeKey (a, b));
+          const auto local = unit_nr_triangles.find (edgeKey (a, b));
+          return ((global == nr_triangles.end () ? 0 : global->second) + (local == unit_nr_triangles.end () ? 0 : local->second));
+        };
+
+        // Add the triangles that touch a border of the tile, unless an edge is shared by two triangles already or the
+        // triangle overlaps one around
+        for (const auto &candidate : candidates)
+        {
+          if (candidate.vertices.size () != 3)
+            continue;
+          std::array<int, 3> triangle;
+          bool touches_border = false;
+          for (int k = 0; k < 3; ++k)
+          {
+            triangle[k] = members[candidate.vertices[k]];
+            touches_border = touches_border || owned (triangle[k]);
+          }
+          bool fits = touches_border;
+          for (int k = 0; k < 3 && fits; ++k)
+            fits = (nrTriangles (triangle[k], triangle[(k + 1) % 3]) < 2);
+          const std::array<Eigen::Vector3d, 3> corners = {{position (triangle[0]), position (triangle[1]), position (triangle[2])}};
+          for (int dx = -1; dx <= 1 && fits; ++dx)
+            for (int dy = -1; dy <= 1 && fits; ++dy)
+              for (int dz = -1; dz <= 1 && fits; ++dz)
+              {
+                const auto cell = grid.find (gridKey (triangle, Eigen::Vector3i (dx, dy, dz)));
+                if (cell == grid.end ())
+                  continue;
+                for (std::size_t i = 0; i < cell->second.size () && fits; ++i)
+                {
+                  const std::array<int, 3> &other = nearby[cell->second[i]];
+                  fits = !trianglesOverlap (corners, {{position (other[0]), position (other[1]), position (other[2])}}, radius);
+                }
+              }
+          if (!fits)
+            continue;
+          for (int k = 0; k < 3; ++k)
+            ++unit_nr_triangles[edgeKey (triangle[k], triangle[(k + 1) % 3])];
+          addNearby (triangle);
+          unit_polygons[u].push_back (triangle);
+        }
+      }
+    }, threads_, std::size_t (1));
+
+    for (const int u : round)
+    {
+      for (const auto &triangle : unit_polygons[u])
+      {
+        addTriangle (triangle);
+        pcl::Vertices stitched;
+        stitched.vertices.resize (3);
+        for (int k = 0; k < 3; ++k)
+          stitched.vertices[k] = ids[triangle[k]];
+        polygons.push_back (stitched);
+      }
+      unit_polygons[u].clear ();
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::GreedyProjectionTriangulation<PointInT>::trianglesOverlap (const std::array<Eigen::Vector3d, 3> &a,
+                                                                const std::array<Eigen::Vector3d, 3> &b,
+                                                                double max_distance)
+{
+  // Project both triangles on the plane of the first one, unless the second one lies away from it
+  const Eigen::Vector3d normal = (a[1] - a[0]).cross (a[2] - a[0]);
+  const double norm = normal.norm ();
+  if (norm == 0)
+    return (false);
+  const Eigen::Vector3d n = normal / norm;
+  double distance = std::numeric_limits<double>::max ();
+  for (const auto &corner : b)
+    distance = (std::min) (distance, std::abs (n.dot (corner - a[0])));
+  if (distance > max_distance)
+    return (false);
+  const Eigen::Vector3d u = (a[1] - a[0]).normalized (), v = n.cross (u);
+  std::array<Eigen::Vector2d, 3> pa, pb;
+  for (int k = 0; k < 3; ++k)
+  {
+    pa[k] = Eigen::Vector2d (u.dot (a[k] - a[0]), v.dot (a[k] - a[0]));
+    pb[k] = Eigen::Vector2d (u.dot (b[k] - a[0]), v.dot (b[k] - a[0]));
+  }
+
+  // Separating axes: the triangles do not overlap if their projections on the normal of an edge at most touch,
+  // e.g. when they share that edge
+  const double tolerance = 1e-9 * max_distance * max_distance;
+  for (const auto *triangle : {&pa, &pb})
+    for (int k = 0; k < 3; ++k)
+    {
+      const Eigen::Vector2d edge = (*triangle)[(k + 1) % 3] - (*triangle)[k];
+      const Eigen::Vector2d axis (-edge[1], edge[0]);
+      double min_a = std::numeric_limits<double>::max (), max_a = -min_a, min_b = min_a, max_b = -min_a;
+      for (int i = 0; i < 3; ++i)
+      {
+        min_a = (std::min) (min_a, axis.dot (pa[i]));
+        max_a = (std::max) (max_a, axis.dot (pa[i]));
+        min_b = (std::min) (min_b, axis.dot (pb[i]));
+        max_b = (std::max) (max_b, axis.dot (pb[i]));
+      }
+      if (max_a <= min_b + tolerance || max_b <= min_a + tolerance)
+        return (false);
+    }
+  return (true);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> std::vector<std::vector<std::size_t> >
 pcl::GreedyProjectionTriangulation<PointInT>::getTriangleList (const pcl::PolygonMesh &input)
@@ -38,9 +38,14 @@
 
 #include <pcl/surface/marching_cubes.h>
 #include <pcl/common/common.h>
+#include <pcl/common/parallel.h>
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::MarchingCubes<PointNT>::~MarchingCubes ()
@@ -82,7 +87,8 @@ pcl::MarchingCubes<PointNT>::interpolateEdge (Eigen::Vector3f &p1,
 template <typename PointNT> void
 pcl::MarchingCubes<PointNT>::createSurface (const std::vector<float> &leaf_node,
                                             const Eigen::Vector3i &index_3d,
-                                            pcl::PointCloud<PointNT> &cloud)
+                                            pcl::PointCloud<PointNT> &cloud,
+                                            std::vector<std::uint64_t> *edge_ids)
 {
   int cubeindex = 0;
   if (leaf_node[0] < iso_level_) cubeindex |= 1;
@@ -157,6 +163,21 @@ pcl::MarchingCubes<PointNT>::createSurface (const std::vector<float> &leaf_node,
     p3.getVector3fMap () = vertex_list[triTable[cubeindex][i+2]];
     cloud.push_back (p3);
   }
+
+  if (edge_ids)
+  {
+    // The node at which every edge of the cube starts, relative to index_3d, and the axis along which it goes
+    static const int edge_origin[12][3] = {{0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {0, 0, 0}, {0, 1, 0}, {1, 1, 0},
+                                           {0, 1, 1}, {0, 1, 0}, {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}};
+    static const int edge_axis[12] = {0, 2, 0, 2, 0, 2, 0, 2, 1, 1, 1, 1};
+    for (int i = 0; triTable[cubeindex][i] != -1; ++i)
+    {
+      const int edge = triTable[cubeindex][i];
+      const std::uint64_t node = (static_cast<std::uint64_t> (index_3d[0] + edge_origin[edge][0]) * res_y_
+                                  + index_3d[1] + edge_origin[edge][1]) * res_z_ + index_3d[2] + edge_origin[edge][2];
+      edge_ids->push_back (3 * node + edge_axis[edge]);
+    }
+  }
 }
 
 
@@ -199,7 +220,15 @@ pcl::MarchingCubes<PointNT>::getGridValue (Eigen::Vector3i pos)
   if (pos[2] < 0 || pos[2] >= res_z_)
     return -1.0f;
 
-  return grid_[pos[0]*res_y_*res_z_ + pos[1]*res_z_ + pos[2]];
+  const std::uint64_t index = (static_cast<std::uint64_t> (pos[0]) * res_y_ + pos[1]) * res_z_ + pos[2];
+  if (narrow_band_)
+  {
+    const auto node = std::lower_bound (band_nodes_.cbegin (), band_nodes_.cend (), index);
+    if (node == band_nodes_.cend () || *node != index)
+      return std::numeric_limits<float>::quiet_NaN ();
+    return band_values_[node - band_nodes_.cbegin ()];
+  }
+  return grid_[index];
 }
 
 
@@ -230,11 +259,14 @@ pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &po
     return;
   }
 
-  // the point cloud really generated from Marching Cubes, prev intermediate_cloud_
-  pcl::PointCloud<PointNT> intermediate_cloud;
-
   // Create grid
-  grid_ = std::vector<float> (res_x_*res_y_*res_z_, NAN);
+  narrow_band_ = usesNarrowBand ();
+  band_nodes_.clear ();
+  band_values_.clear ();
+  if (narrow_band_)
+    grid_.clear ();
+  else
+    grid_ = std::vector<float> (res_x_*res_y_*res_z_, NAN);
 
   // Compute bounding box and voxel size
   getBoundingBox ();
@@ -245,25 +277,99 @@ pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &po
   // This needs to be implemented in a child class
   voxelizeData ();
 
-  // preallocate memory assuming a hull. suppose 6 point per voxel
-  double size_reserve = std::min((double) intermediate_cloud.points.max_size (),
-      2.0 * 6.0 * (double) (res_y_*res_z_ + res_x_*res_z_ + res_x_*res_y_));
-  intermediate_cloud.reserve ((std::size_t) size_reserve);
+  // The cubes are triangulated by blocks, in parallel, and the blocks are then concatenated in order, so the result
+  // is the same as a sequential walk through the grid. A block is a slice of constant x of the dense grid, or a range
+  // of nodes of the narrow band, each of them being the first corner of a cube.
+  const std::size_t band_block_size = 4096;
+  const std::size_t nr_blocks = narrow_band_ ? (band_nodes_.size () + band_block_size - 1) / band_block_size
+                                             : static_cast<std::size_t> (std::max (res_x_, 0));
+  std::vector<pcl::PointCloud<PointNT> > block_points (nr_blocks);
+  std::vector<std::vector<std::uint64_t> > block_edges (nr_blocks);
+  const auto is_inner_cube = [this] (const Eigen::Vector3i &index_3d)
+  {
+    return (index_3d[0] >= 1 && index_3d[0] < res_x_ - 1 &&
+            index_3d[1] >= 1 && index_3d[1] < res_y_ - 1 &&
+            index_3d[2] >= 1 && index_3d[2] < res_z_ - 1);
+  };
+  pcl::parallel::parallel_for (std::size_t (0), nr_blocks, [&] (std::size_t first, std::size_t last)
+  {
+    std::vector<float> leaf_node;
+    for (std::size_t block = first; block < last; ++block)
+    {
+      std::vector<std::uint64_t> *edges = merge_vertices_ ? &block_edges[block] : nullptr;
+      if (narrow_band_)
+      {
+        const std::size_t end = std::min (band_nodes_.size (), (block + 1) * band_block_size);
+        for (std::size_t i = block * band_block_size; i < end; ++i)
+        {
+          const std::uint64_t node = band_nodes_[i];
+          Eigen::Vector3i index_3d (static_cast<int> (node / res_z_ / res_y_),
+                                    static_cast<int> (node / res_z_ % res_y_),
+                                    static_cast<int> (node % res_z_));
+          if (!is_inner_cube (index_3d))
+            continue;
+          getNeighborList1D (leaf_node, index_3d);
+          if (!leaf_node.empty ())
+            createSurface (leaf_node, index_3d, block_points[block], edges);
+        }
+      }
+      else
+      {
+        for (int y = 1; y < res_y_-1; ++y)
+          for (int z = 1; z < res_z_-1; ++z)
+          {
+            Eigen::Vector3i index_3d (static_cast<int> (block), y, z);
+            if (!is_inner_cube (index_3d))
+              continue;
+            getNeighborList1D (leaf_node, index_3d);
+            if (!leaf_node.empty ())
+              createSurface (leaf_node, index_3d, block_points[block], edges);
+          }
+      }
+    }
+  }, threads_, std::size_t (1));
+
+  // the point cloud really generated from Marching Cubes, prev intermediate_cloud_
+  pcl::PointCloud<PointNT> intermediate_cloud;
+  std::vector<std::uint64_t> edge_ids;
+  std::size_t nr_points = 0;
+  for (const auto &block : block_points)
+    nr_points += block.size ();
+  intermediate_cloud.reserve (nr_points);
+  if (merge_vertices_)
+    edge_ids.reserve (nr_points);
+  for (std::size_t block = 0; block < nr_blocks; ++block)
+  {
+    intermediate_cloud.insert (intermediate_cloud.end (), block_points[block].begin (), block_points[block].end ());
+    edge_ids.insert (edge_ids.end (), block_edges[block].begin (), block_edges[block].end ());
+  }
+  block_points.clear ();
+  block_edges.clear ();
 
-  for (int x = 1; x < res_x_-1; ++x)
-    for (int y = 1; y < res_y_-1; ++y)
-      for (int z = 1; z < res_z_-1; ++z)
+  polygons.resize (intermediate_cloud.size () / 3);
+  if (merge_vertices_)
+  {
+    // Every intersection of the surface with a grid edge becomes a single vertex, at its first position
+    std::unordered_map<std::uint64_t, int> vertex_ids;
+    vertex_ids.reserve (edge_ids.size () / 4);
+    points.clear ();
+    for (std::size_t i = 0; i < polygons.size (); ++i)
+    {
+      pcl::Vertices v;
+      v.vertices.resize (3);
+      for (int j = 0; j < 3; ++j)
       {
-        Eigen::Vector3i index_3d (x, y, z);
-        std::vector<float> leaf_node;
-        getNeighborList1D (leaf_node, index_3d);
-        if (!leaf_node.empty ())
-          createSurface (leaf_node, index_3d, intermediate_cloud);
+        const auto vertex = vertex_ids.emplace (edge_ids[3 * i + j], static_cast<int> (points.size ()));
+        if (vertex.second)
+          points.push_back (intermediate_cloud[3 * i + j]);
+        v.vertices[j] = vertex.first->second;
       }
+      polygons[i] = v;
+    }
+    return;
+  }
 
   points.swap (intermediate_cloud);
-
-  polygons.resize (points.size () / 3);
   for (std::size_t i = 0; i < polygons.size (); ++i)
   {
     pcl::Vertices v;
@@ -38,9 +38,14 @@
 
 #include <pcl/surface/marching_cubes_hoppe.h>
 #include <pcl/common/common.h>
+#include <pcl/common/parallel.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
+#include <atomic>
+#include <memory>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::MarchingCubesHoppe<PointNT>::~MarchingCubesHoppe ()
@@ -49,44 +54,124 @@ pcl::MarchingCubesHoppe<PointNT>::~MarchingCubesHoppe ()
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointNT> void
-pcl::MarchingCubesHoppe<PointNT>::voxelizeData ()
+template <typename PointNT> float
+pcl::MarchingCubesHoppe<PointNT>::computeNodeValue (int x, int y, int z,
+                                                    std::vector<int> &nn_indices,
+                                                    std::vector<float> &nn_sqr_dists) const
 {
-  const bool is_far_ignored = dist_ignore_ > 0.0f;
+  const Eigen::Vector3f point = (lower_boundary_ + size_voxel_ * Eigen::Array3f (x, y, z)).matrix ();
+  PointNT p;
 
-  for (int x = 0; x < res_x_; ++x)
-  {
-    const int y_start = x * res_y_ * res_z_;
+  p.getVector3fMap () = point;
 
-    for (int y = 0; y < res_y_; ++y)
-    {
-      const int z_start = y_start + y * res_z_;
+  tree_->nearestKSearch (p, 1, nn_indices, nn_sqr_dists);
 
-      for (int z = 0; z < res_z_; ++z)
-      {
-        std::vector<int> nn_indices (1, 0);
-        std::vector<float> nn_sqr_dists (1, 0.0f);
-        const Eigen::Vector3f point = (lower_boundary_ + size_voxel_ * Eigen::Array3f (x, y, z)).matrix ();
-        PointNT p;
+  if (dist_ignore_ <= 0.0f || nn_sqr_dists[0] < dist_ignore_)
+  {
+    const Eigen::Vector3f normal = input_->points[nn_indices[0]].getNormalVector3fMap ();
 
-        p.getVector3fMap () = point;
+    if (!std::isnan (normal (0)) && normal.norm () > 0.5f)
+      return normal.dot (point - input_->points[nn_indices[0]].getVector3fMap ());
+  }
+  return std::numeric_limits<float>::quiet_NaN ();
+}
 
-        tree_->nearestKSearch (p, 1, nn_indices, nn_sqr_dists);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubesHoppe<PointNT>::voxelizeData ()
+{
+  if (!usesNarrowBand ())
+  {
+    pcl::parallel::parallel_for (0, res_x_, [this] (int first, int last)
+    {
+      std::vector<int> nn_indices (1, 0);
+      std::vector<float> nn_sqr_dists (1, 0.0f);
+      for (int x = first; x < last; ++x)
+      {
+        const int y_start = x * res_y_ * res_z_;
 
-        if (!is_far_ignored || nn_sqr_dists[0] < dist_ignore_)
+        for (int y = 0; y < res_y_; ++y)
         {
-          const Eigen::Vector3f normal = input_->points[nn_indices[0]].getNormalVector3fMap ();
+          const int z_start = y_start + y * res_z_;
 
-          if (!std::isnan (normal (0)) && normal.norm () > 0.5f)
-            grid_[z_start + z] = normal.dot (
-                point - input_->points[nn_indices[0]].getVector3fMap ());
+          for (int z = 0; z < res_z_; ++z)
+            grid_[z_start + z] = computeNodeValue (x, y, z, nn_indices, nn_sqr_dists);
         }
       }
+    }, threads_, 1);
+    return;
+  }
+
+  // Mark the nodes within the ignore distance of an input point, one bit per node. The radius is slightly enlarged so
+  // that rounding never drops a node, the exact test being done by computeNodeValue ().
+  const std::uint64_t nr_nodes = static_cast<std::uint64_t> (res_x_) * res_y_ * res_z_;
+  const std::size_t nr_words = static_cast<std::size_t> ((nr_nodes + 63) / 64);
+  std::unique_ptr<std::atomic<std::uint64_t>[]> marks (new std::atomic<std::uint64_t>[nr_words]);
+  for (std::size_t i = 0; i < nr_words; ++i)
+    marks[i].store (0, std::memory_order_relaxed);
+
+  const float sqr_radius = 1.01f * dist_ignore_;
+  const float radius = std::sqrt (sqr_radius);
+  const Eigen::Array3i max_node (res_x_ - 1, res_y_ - 1, res_z_ - 1);
+  pcl::parallel::parallel_for (std::size_t (0), input_->size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+    {
+      if (!pcl::isFinite (input_->points[i]))
+        continue;
+      const Eigen::Array3f point = input_->points[i].getArray3fMap ();
+      const Eigen::Array3i min_index = ((point - radius - lower_boundary_) / size_voxel_).floor ().template cast<int> ().max (0);
+      const Eigen::Array3i max_index = ((point + radius - lower_boundary_) / size_voxel_).ceil ().template cast<int> ().min (max_node);
+      for (int x = min_index[0]; x <= max_index[0]; ++x)
+        for (int y = min_index[1]; y <= max_index[1]; ++y)
+          for (int z = min_index[2]; z <= max_index[2]; ++z)
+          {
+            const Eigen::Array3f node = lower_boundary_ + size_voxel_ * Eigen::Array3f (x, y, z);
+            if ((node - point).matrix ().squaredNorm () > sqr_radius)
+              continue;
+            const std::uint64_t index = (static_cast<std::uint64_t> (x) * res_y_ + y) * res_z_ + z;
+            marks[index / 64].fetch_or (std::uint64_t (1) << (index % 64), std::memory_order_relaxed);
+          }
     }
+  }, threads_);
+
+  // The marked nodes are listed in increasing order
+  for (std::size_t i = 0; i < nr_words; ++i)
+  {
+    std::uint64_t word = marks[i].load (std::memory_order_relaxed);
+    for (std::uint64_t index = 64 * static_cast<std::uint64_t> (i); word; word >>= 1, ++index)
+      if (word & 1)
+        band_nodes_.push_back (index);
   }
-}
+  marks.reset ();
 
+  band_values_.resize (band_nodes_.size ());
+  pcl::parallel::parallel_for (std::size_t (0), band_nodes_.size (), [this] (std::size_t first, std::size_t last)
+  {
+    std::vector<int> nn_indices (1, 0);
+    std::vector<float> nn_sqr_dists (1, 0.0f);
+    for (std::size_t i = first; i < last; ++i)
+    {
+      const std::uint64_t node = band_nodes_[i];
+      band_values_[i] = computeNodeValue (static_cast<int> (node / res_z_ / res_y_),
+                                          static_cast<int> (node / res_z_ % res_y_),
+                                          static_cast<int> (node % res_z_), nn_indices, nn_sqr_dists);
+    }
+  }, threads_);
 
+  // Only keep the nodes where the distance is defined
+  std::size_t nr_defined = 0;
+  for (std::size_t i = 0; i < band_nodes_.size (); ++i)
+  {
+    if (std::isnan (band_values_[i]))
+      continue;
+    band_nodes_[nr_defined] = band_nodes_[i];
+    band_values_[nr_defined] = band_values_[i];
+    ++nr_defined;
+  }
+  band_nodes_.resize (nr_defined);
+  band_values_.resize (nr_defined);
+}
 
 #define PCL_INSTANTIATE_MarchingCubesHoppe(T) template class PCL_EXPORTS pcl::MarchingCubesHoppe<T>;
 
@@ -41,6 +41,7 @@
 
 #include <pcl/surface/marching_cubes_rbf.h>
 #include <pcl/common/common.h>
+#include <pcl/common/parallel.h>
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
@@ -59,20 +60,23 @@ pcl::MarchingCubesRBF<PointNT>::voxelizeData ()
   Eigen::MatrixXd M (2*N, 2*N),
                   d (2*N, 1);
 
-  for (unsigned int row_i = 0; row_i < 2*N; ++row_i)
+  pcl::parallel::parallel_for (0u, 2*N, [&] (unsigned int first, unsigned int last)
   {
-    // boolean variable to determine whether we are in the off_surface domain for the rows
-    bool row_off = (row_i >= N);
-    for (unsigned int col_i = 0; col_i < 2*N; ++col_i)
+    for (unsigned int row_i = first; row_i < last; ++row_i)
     {
-      // boolean variable to determine whether we are in the off_surface domain for the columns
-      bool col_off = (col_i >= N);
-      M (row_i, col_i) = kernel (Eigen::Vector3f (input_->points[col_i%N].getVector3fMap ()).cast<double> () + Eigen::Vector3f (input_->points[col_i%N].getNormalVector3fMap ()).cast<double> () * col_off * off_surface_epsilon_,
-                                 Eigen::Vector3f (input_->points[row_i%N].getVector3fMap ()).cast<double> () + Eigen::Vector3f (input_->points[row_i%N].getNormalVector3fMap ()).cast<double> () * row_off * off_surface_epsilon_);
-    }
+      // boolean variable to determine whether we are in the off_surface domain for the rows
+      bool row_off = (row_i >= N);
+      for (unsigned int col_i = 0; col_i < 2*N; ++col_i)
+      {
+        // boolean variable to determine whether we are in the off_surface domain for the columns
+        bool col_off = (col_i >= N);
+        M (row_i, col_i) = kernel (Eigen::Vector3f (input_->points[col_i%N].getVector3fMap ()).cast<double> () + Eigen::Vector3f (input_->points[col_i%N].getNormalVector3fMap ()).cast<double> () * col_off * off_surface_epsilon_,
+                                   Eigen::Vector3f (input_->points[row_i%N].getVector3fMap ()).cast<double> () + Eigen::Vector3f (input_->points[row_i%N].getNormalVector3fMap ()).cast<double> () * row_off * off_surface_epsilon_);
+      }
 
-    d (row_i, 0) = row_off * off_surface_epsilon_;
-  }
+      d (row_i, 0) = row_off * off_surface_epsilon_;
+    }
+  }, threads_);
 
   // Solve for the weights
   Eigen::MatrixXd w (2*N, 1);
@@ -90,22 +94,25 @@ pcl::MarchingCubesRBF<PointNT>::voxelizeData ()
     weights[i + N] = w (i + N, 0);
   }
 
-  for (int x = 0; x < res_x_; ++x)
-    for (int y = 0; y < res_y_; ++y)
-      for (int z = 0; z < res_z_; ++z)
-      {
-        const Eigen::Vector3f point_f = (size_voxel_ * Eigen::Array3f (x, y, z) 
-            + lower_boundary_).matrix ();
-        const Eigen::Vector3d point = point_f.cast<double> ();
-
-        double f = 0.0;
-        std::vector<double>::const_iterator w_it (weights.begin());
-        for (std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> >::const_iterator c_it = centers.begin ();
-             c_it != centers.end (); ++c_it, ++w_it)
-          f += *w_it * kernel (*c_it, point);
-
-        grid_[x * res_y_*res_z_ + y * res_z_ + z] = float (f);
-      }
+  pcl::parallel::parallel_for (0, res_x_, [&] (int first, int last)
+  {
+    for (int x = first; x < last; ++x)
+      for (int y = 0; y < res_y_; ++y)
+        for (int z = 0; z < res_z_; ++z)
+        {
+          const Eigen::Vector3f point_f = (size_voxel_ * Eigen::Array3f (x, y, z) 
+              + lower_boundary_).matrix ();
+          const Eigen::Vector3d point = point_f.cast<double> ();
+
+          double f = 0.0;
+          std::vector<double>::const_iterator w_it (weights.begin());
+          for (std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> >::const_iterator c_it = centers.begin ();
+               c_it != centers.end (); ++c_it, ++w_it)
+            f += *w_it * kernel (*c_it, point);
+
+          grid_[x * res_y_*res_z_ + y * res_z_ + z] = float (f);
+        }
+  }, threads_, 1);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
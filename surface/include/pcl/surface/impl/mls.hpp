@@ -47,10 +47,11 @@
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
 #include <pcl/common/geometry.h>
+#include <pcl/common/parallel.h>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
+#include <algorithm>
+#include <limits>
+#include <memory>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
@@ -105,39 +106,16 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::process (PointCloudOut &output)
   // Send the surface dataset to the spatial locator
   tree_->setInputCloud (input_);
 
-  switch (upsample_method_)
+  // Initialize the seed of the random number generators if necessary
+  if (upsample_method_ == RANDOM_UNIFORM_DENSITY)
   {
-    // Initialize random number generator if necessary
-    case (RANDOM_UNIFORM_DENSITY):
-    {
-      std::random_device rd;
-      rng_.seed (rd());
-      const double tmp = search_radius_ / 2.0;
-      rng_uniform_distribution_.reset (new std::uniform_real_distribution<> (-tmp, tmp));
-
-      break;
-    }
-    case (VOXEL_GRID_DILATION):
-    case (DISTINCT_CLOUD):
-    {
-      if (!cache_mls_results_)
-        PCL_WARN ("The cache mls results is forced when using upsampling method VOXEL_GRID_DILATION or DISTINCT_CLOUD.\n");
-
-      cache_mls_results_ = true;
-      break;
-    }
-    default:
-      break;
+    std::random_device rd;
+    rng_seed_ = rd ();
   }
 
+  mls_results_.clear ();
   if (cache_mls_results_)
-  {
     mls_results_.resize (input_->size ());
-  }
-  else
-  {
-    mls_results_.resize (1); // Need to have a reference to a single dummy result.
-  }
 
   // Perform the actual surface reconstruction
   performProcessing (output);
@@ -216,10 +194,12 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::computeMLSPointNormal (int index,
       else
       {
         // Sample the local plane
+        SplitMix64 rng (rng_seed_, static_cast<std::uint32_t> (index));
+        std::uniform_real_distribution<> rng_uniform_distribution (-search_radius_ / 2.0, search_radius_ / 2.0);
         for (int num_added = 0; num_added < num_points_to_add;)
         {
-          const double u = (*rng_uniform_distribution_) (rng_);
-          const double v = (*rng_uniform_distribution_) (rng_);
+          const double u = rng_uniform_distribution (rng);
+          const double v = rng_uniform_distribution (rng);
 
           // Check if inside circle; if not, try another coin flip
           if (u * u + v * v > search_radius_ * search_radius_ / 4)
@@ -282,153 +262,216 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
   // Compute the number of coefficients
   nr_coeff_ = (order_ + 1) * (order_ + 2) / 2;
 
-#ifdef _OPENMP
-  // (Maximum) number of threads
-  const unsigned int threads = threads_ == 0 ? 1 : threads_;
-  // Create temporaries for each thread in order to avoid synchronization
-  typename PointCloudOut::CloudVectorType projected_points (threads);
-  typename NormalCloud::CloudVectorType projected_points_normals (threads);
-  std::vector<PointIndices> corresponding_input_indices (threads);
-#endif
-
-  // For all points
-#pragma omp parallel for \
-  default(none) \
-  shared(corresponding_input_indices, projected_points, projected_points_normals) \
-  schedule(dynamic,1000) \
-  num_threads(threads)
-  for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
+  // Without cache, the fits needed by these methods are computed when upsampling
+  if (cache_mls_results_ || (upsample_method_ != VOXEL_GRID_DILATION && upsample_method_ != DISTINCT_CLOUD))
   {
-    // Allocate enough space to hold the results of nearest neighbor searches
-    // \note resize is irrelevant for a radiusSearch ().
-    std::vector<int> nn_indices;
-    std::vector<float> nn_sqr_dists;
-
-    // Get the initial estimates of point positions and their neighborhoods
-    if (searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists))
+    // Every block of points gets its own output, so that no synchronization is needed and that the
+    // output does not depend on the number of threads
+    const std::size_t block_size = 1000;
+    const std::size_t nr_blocks = (indices_->size () + block_size - 1) / block_size;
+    typename PointCloudOut::CloudVectorType projected_points (nr_blocks);
+    typename NormalCloud::CloudVectorType projected_points_normals (nr_blocks);
+    std::vector<PointIndices> corresponding_input_indices (nr_blocks);
+
+    pcl::parallel::parallel_for (std::size_t (0), nr_blocks, [&] (std::size_t first_block, std::size_t last_block)
     {
-      // Check the number of nearest neighbors for normal estimation (and later for polynomial fit as well)
-      if (nn_indices.size () >= 3)
+      // Allocate enough space to hold the results of nearest neighbor searches
+      // \note resize is irrelevant for a radiusSearch ().
+      std::vector<int> nn_indices;
+      std::vector<float> nn_sqr_dists;
+      MLSResult mls_result;
+
+      for (std::size_t block = first_block; block < last_block; ++block)
       {
-        // This thread's ID (range 0 to threads-1)
-#ifdef _OPENMP
-        const int tn = omp_get_thread_num ();
-        // Size of projected points before computeMLSPointNormal () adds points
-        std::size_t pp_size = projected_points[tn].size ();
-#else
-        PointCloudOut projected_points;
-        NormalCloud projected_points_normals;
-#endif
-
-        // Get a plane approximating the local surface's tangent and project point onto it
-        const int index = (*indices_)[cp];
-
-        std::size_t mls_result_index = 0;
-        if (cache_mls_results_)
-          mls_result_index = index; // otherwise we give it a dummy location.
-
-#ifdef _OPENMP
-        computeMLSPointNormal (index, nn_indices, projected_points[tn], projected_points_normals[tn], corresponding_input_indices[tn], mls_results_[mls_result_index]);
-
-        // Copy all information from the input cloud to the output points (not doing any interpolation)
-        for (std::size_t pp = pp_size; pp < projected_points[tn].size (); ++pp)
-          copyMissingFields (input_->points[(*indices_)[cp]], projected_points[tn][pp]);
-#else
-        computeMLSPointNormal (index, nn_indices, projected_points, projected_points_normals, *corresponding_input_indices_, mls_results_[mls_result_index]);
-
-        // Append projected points to output
-        output.insert (output.end (), projected_points.begin (), projected_points.end ());
-        if (compute_normals_)
-          normals_->insert (normals_->end (), projected_points_normals.begin (), projected_points_normals.end ());
-#endif
+        const std::size_t end = (std::min) ((block + 1) * block_size, indices_->size ());
+        for (std::size_t cp = block * block_size; cp < end; ++cp)
+        {
+          // Get the initial estimates of point positions and their neighborhoods
+          if (!searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists))
+            continue;
+          // Check the number of nearest neighbors for normal estimation (and later for polynomial fit as well)
+          if (nn_indices.size () < 3)
+            continue;
+
+          // Size of projected points before computeMLSPointNormal () adds points
+          const std::size_t pp_size = projected_points[block].size ();
+
+          // Get a plane approximating the local surface's tangent and project point onto it
+          const int index = (*indices_)[cp];
+          computeMLSPointNormal (index, nn_indices, projected_points[block], projected_points_normals[block],
+                                 corresponding_input_indices[block], cache_mls_results_ ? mls_results_[index] : mls_result);
+
+          // Copy all information from the input cloud to the output points (not doing any interpolation)
+          for (std::size_t pp = pp_size; pp < projected_points[block].size (); ++pp)
+            copyMissingFields (input_->points[index], projected_points[block][pp]);
+        }
       }
-    }
+    }, threads_ == 0 ? 1 : threads_, std::size_t (1));
+
+    appendProjectedPoints (projected_points, projected_points_normals, corresponding_input_indices, output);
   }
 
-#ifdef _OPENMP
-  // Combine all threads' results into the output vectors
-  for (unsigned int tn = 0; tn < threads; ++tn)
+  // Perform the distinct-cloud or voxel-grid upsampling
+  performUpsampling (output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::appendProjectedPoints (
+    const typename PointCloudOut::CloudVectorType &projected_points,
+    const typename NormalCloud::CloudVectorType &projected_points_normals,
+    const std::vector<PointIndices> &corresponding_input_indices,
+    PointCloudOut &output)
+{
+  std::size_t nr_points = output.size ();
+  for (const auto &points : projected_points)
+    nr_points += points.size ();
+  output.points.reserve (nr_points);
+  corresponding_input_indices_->indices.reserve (corresponding_input_indices_->indices.size () + nr_points - output.size ());
+  if (compute_normals_)
+    normals_->points.reserve (nr_points);
+
+  for (std::size_t block = 0; block < projected_points.size (); ++block)
   {
-    output.insert (output.end (), projected_points[tn].begin (), projected_points[tn].end ());
+    output.insert (output.end (), projected_points[block].begin (), projected_points[block].end ());
     corresponding_input_indices_->indices.insert (corresponding_input_indices_->indices.end (),
-                                                  corresponding_input_indices[tn].indices.begin (), corresponding_input_indices[tn].indices.end ());
+                                                  corresponding_input_indices[block].indices.begin (),
+                                                  corresponding_input_indices[block].indices.end ());
     if (compute_normals_)
-      normals_->insert (normals_->end (), projected_points_normals[tn].begin (), projected_points_normals[tn].end ());
+      normals_->insert (normals_->end (), projected_points_normals[block].begin (), projected_points_normals[block].end ());
   }
-#endif
+}
 
-  // Perform the distinct-cloud or voxel-grid upsampling
-  performUpsampling (output);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> const pcl::MLSResult&
+pcl::MovingLeastSquares<PointInT, PointOutT>::getUpsamplingFit (int index,
+                                                                const std::vector<bool> &in_indices,
+                                                                MLSResult &fit,
+                                                                int &fit_index) const
+{
+  if (cache_mls_results_)
+    return (mls_results_[index]);
+
+  // Consecutive samples are usually closest to the same input point
+  if (fit_index != index)
+  {
+    // Same conditions as in performProcessing ()
+    fit = MLSResult ();
+    fit_index = index;
+    std::vector<int> nn_indices;
+    std::vector<float> nn_sqr_dists;
+    if (in_indices[index] && searchForNeighbors (index, nn_indices, nn_sqr_dists) && nn_indices.size () >= 3)
+      fit.computeMLSSurface<PointInT> (*input_, index, nn_indices, search_radius_, order_);
+  }
+  return (fit);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::projectUpsamplingPoint (const PointInT &sample,
+                                                                      const std::vector<bool> &in_indices,
+                                                                      MLSResult &fit,
+                                                                      int &fit_index,
+                                                                      PointCloudOut &projected_points,
+                                                                      NormalCloud &projected_points_normals,
+                                                                      PointIndices &corresponding_input_indices) const
+{
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  tree_->nearestKSearch (sample, 1, nn_indices, nn_dists);
+  const int input_index = nn_indices.front ();
+
+  // If the closest point did not have a valid MLS fitting result
+  // OR if it is too far away from the sampled point
+  const MLSResult &mls_result = getUpsamplingFit (input_index, in_indices, fit, fit_index);
+  if (mls_result.valid == false)
+    return;
+
+  Eigen::Vector3d add_point = sample.getVector3fMap ().template cast<double> ();
+  MLSResult::MLSProjectionResults proj = mls_result.projectPoint (add_point, projection_method_, 5 * nr_coeff_);
+  addProjectedPointNormal (input_index, proj.point, proj.normal, mls_result.curvature,
+                           projected_points, projected_points_normals, corresponding_input_indices);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &output)
 {
+  if (upsample_method_ != DISTINCT_CLOUD && upsample_method_ != VOXEL_GRID_DILATION)
+    return;
 
-  if (upsample_method_ == DISTINCT_CLOUD)
-  {
-    corresponding_input_indices_.reset (new PointIndices);
-    for (std::size_t dp_i = 0; dp_i < distinct_cloud_->size (); ++dp_i) // dp_i = distinct_point_i
-    {
-      // Distinct cloud may have nan points, skip them
-      if (!std::isfinite (distinct_cloud_->points[dp_i].x))
-        continue;
+  const unsigned int threads = threads_ == 0 ? 1 : threads_;
+  corresponding_input_indices_.reset (new PointIndices);
 
-      // Get 3D position of point
-      //Eigen::Vector3f pos = distinct_cloud_->points[dp_i].getVector3fMap ();
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch (distinct_cloud_->points[dp_i], 1, nn_indices, nn_dists);
-      int input_index = nn_indices.front ();
-
-      // If the closest point did not have a valid MLS fitting result
-      // OR if it is too far away from the sampled point
-      if (mls_results_[input_index].valid == false)
-        continue;
-
-      Eigen::Vector3d add_point = distinct_cloud_->points[dp_i].getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj =  mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
-    }
+  // Without cache, only the points in the indices may be fitted (as in performProcessing ())
+  std::vector<bool> in_indices;
+  if (!cache_mls_results_)
+  {
+    in_indices.resize (input_->size (), false);
+    for (const int index : *indices_)
+      in_indices[index] = true;
   }
 
-  // For the voxel grid upsampling method, generate the voxel grid and dilate it
-  // Then, project the newly obtained points to the MLS surface
-  if (upsample_method_ == VOXEL_GRID_DILATION)
+  // The samples are the points of the distinct cloud or the centers of the dilated voxels
+  std::vector<std::uint64_t> voxels;
+  std::size_t nr_samples = 0;
+  std::unique_ptr<MLSVoxelGrid> voxel_grid;
+  if (upsample_method_ == DISTINCT_CLOUD)
+    nr_samples = distinct_cloud_->size ();
+  else
   {
-    corresponding_input_indices_.reset (new PointIndices);
-
-    MLSVoxelGrid voxel_grid (input_, indices_, voxel_size_);
+    // For the voxel grid upsampling method, generate the voxel grid and dilate it
+    // Then, project the newly obtained points to the MLS surface
+    voxel_grid.reset (new MLSVoxelGrid (input_, indices_, voxel_size_, threads));
     for (int iteration = 0; iteration < dilation_iteration_num_; ++iteration)
-      voxel_grid.dilate ();
+      voxel_grid->dilate (threads);
 
-    for (typename MLSVoxelGrid::HashMap::iterator m_it = voxel_grid.voxel_grid_.begin (); m_it != voxel_grid.voxel_grid_.end (); ++m_it)
-    {
-      // Get 3D position of point
-      Eigen::Vector3f pos;
-      voxel_grid.getPosition (m_it->first, pos);
+    voxels.reserve (voxel_grid->voxel_grid_.size ());
+    for (const auto &voxel : voxel_grid->voxel_grid_)
+      voxels.push_back (voxel.first);
+    std::sort (voxels.begin (), voxels.end ());
+    nr_samples = voxels.size ();
+  }
 
-      PointInT p;
-      p.x = pos[0];
-      p.y = pos[1];
-      p.z = pos[2];
+  const std::size_t block_size = 1000;
+  const std::size_t nr_blocks = (nr_samples + block_size - 1) / block_size;
+  typename PointCloudOut::CloudVectorType projected_points (nr_blocks);
+  typename NormalCloud::CloudVectorType projected_points_normals (nr_blocks);
+  std::vector<PointIndices> corresponding_input_indices (nr_blocks);
 
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch (p, 1, nn_indices, nn_dists);
-      int input_index = nn_indices.front ();
-
-      // If the closest point did not have a valid MLS fitting result
-      // OR if it is too far away from the sampled point
-      if (mls_results_[input_index].valid == false)
-        continue;
-
-      Eigen::Vector3d add_point = p.getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj = mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
+  pcl::parallel::parallel_for (std::size_t (0), nr_blocks, [&] (std::size_t first_block, std::size_t last_block)
+  {
+    MLSResult fit;
+    int fit_index = -1;
+    for (std::size_t block = first_block; block < last_block; ++block)
+    {
+      const std::size_t end = (std::min) ((block + 1) * block_size, nr_samples);
+      for (std::size_t i = block * block_size; i < end; ++i)
+      {
+        PointInT sample;
+        if (upsample_method_ == DISTINCT_CLOUD)
+        {
+          // Distinct cloud may have nan points, skip them
+          sample = distinct_cloud_->points[i];
+          if (!std::isfinite (sample.x))
+            continue;
+        }
+        else
+        {
+          // Get 3D position of point
+          Eigen::Vector3f pos;
+          voxel_grid->getPosition (voxels[i], pos);
+          sample.x = pos[0];
+          sample.y = pos[1];
+          sample.z = pos[2];
+        }
+        projectUpsamplingPoint (sample, in_indices, fit, fit_index, projected_points[block],
+                                projected_points_normals[block], corresponding_input_indices[block]);
+      }
     }
-  }
+  }, threads, std::size_t (1));
+
+  appendProjectedPoints (projected_points, projected_points_normals, corresponding_input_indices, output);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -833,7 +876,8 @@ pcl::MLSResult::computeMLSSurface (const pcl::PointCloud<PointT> &cloud,
 template <typename PointInT, typename PointOutT>
 pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::MLSVoxelGrid (PointCloudInConstPtr& cloud,
                                                                           IndicesPtr &indices,
-                                                                          float voxel_size) :
+                                                                          float voxel_size,
+                                                                          unsigned int nr_threads) :
   voxel_grid_ (), data_size_ (), voxel_size_ (voxel_size)
 {
   pcl::getMinMax3D (*cloud, *indices, bounding_min_, bounding_max_);
@@ -842,45 +886,68 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::MLSVoxelGrid (PointC
   const double max_size = (std::max) ((std::max)(bounding_box_size.x (), bounding_box_size.y ()), bounding_box_size.z ());
   // Put initial cloud in voxel grid
   data_size_ = static_cast<std::uint64_t> (1.5 * max_size / voxel_size_);
-  for (std::size_t i = 0; i < indices->size (); ++i)
-    if (std::isfinite (cloud->points[(*indices)[i]].x))
-    {
-      Eigen::Vector3i pos;
-      getCellIndex (cloud->points[(*indices)[i]].getVector3fMap (), pos);
 
-      std::uint64_t index_1d;
-      getIndexIn1D (pos, index_1d);
-      Leaf leaf;
-      voxel_grid_[index_1d] = leaf;
-    }
+  // The voxels of the points are computed in parallel, and inserted afterwards
+  const std::uint64_t invalid = std::numeric_limits<std::uint64_t>::max ();
+  std::vector<std::uint64_t> voxels (indices->size (), invalid);
+  pcl::parallel::parallel_for (std::size_t (0), indices->size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t i = first; i < last; ++i)
+      if (std::isfinite (cloud->points[(*indices)[i]].x))
+      {
+        Eigen::Vector3i pos;
+        getCellIndex (cloud->points[(*indices)[i]].getVector3fMap (), pos);
+        getIndexIn1D (pos, voxels[i]);
+      }
+  }, nr_threads);
+
+  voxel_grid_.reserve (voxels.size ());
+  for (const std::uint64_t index_1d : voxels)
+    if (index_1d != invalid)
+      voxel_grid_.emplace (index_1d, Leaf ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::dilate ()
+pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::dilate (unsigned int nr_threads)
 {
-  HashMap new_voxel_grid = voxel_grid_;
-  for (typename MLSVoxelGrid::HashMap::iterator m_it = voxel_grid_.begin (); m_it != voxel_grid_.end (); ++m_it)
+  std::vector<std::uint64_t> voxels;
+  voxels.reserve (voxel_grid_.size ());
+  for (const auto &voxel : voxel_grid_)
+    voxels.push_back (voxel.first);
+
+  // Collect the neighbors that are not in the grid yet in parallel (the grid is only read), then insert them
+  const std::size_t block_size = 4096;
+  const std::size_t nr_blocks = (voxels.size () + block_size - 1) / block_size;
+  std::vector<std::vector<std::uint64_t> > new_voxels (nr_blocks);
+  pcl::parallel::parallel_for (std::size_t (0), nr_blocks, [&] (std::size_t first_block, std::size_t last_block)
   {
-    Eigen::Vector3i index;
-    getIndexIn3D (m_it->first, index);
-
-    // Now dilate all of its voxels
-    for (int x = -1; x <= 1; ++x)
-      for (int y = -1; y <= 1; ++y)
-        for (int z = -1; z <= 1; ++z)
-          if (x != 0 || y != 0 || z != 0)
-          {
-            Eigen::Vector3i new_index;
-            new_index = index + Eigen::Vector3i (x, y, z);
+    for (std::size_t block = first_block; block < last_block; ++block)
+    {
+      const std::size_t end = (std::min) ((block + 1) * block_size, voxels.size ());
+      for (std::size_t i = block * block_size; i < end; ++i)
+      {
+        Eigen::Vector3i index;
+        getIndexIn3D (voxels[i], index);
+
+        // Now dilate all of its voxels
+        for (int x = -1; x <= 1; ++x)
+          for (int y = -1; y <= 1; ++y)
+            for (int z = -1; z <= 1; ++z)
+              if (x != 0 || y != 0 || z != 0)
+              {
+                std::uint64_t index_1d;
+                getIndexIn1D (index + Eigen::Vector3i (x, y, z), index_1d);
+                if (voxel_grid_.find (index_1d) == voxel_grid_.end ())
+                  new_voxels[block].push_back (index_1d);
+              }
+      }
+    }
+  }, nr_threads, std::size_t (1));
 
-            std::uint64_t index_1d;
-            getIndexIn1D (new_index, index_1d);
-            Leaf leaf;
-            new_voxel_grid[index_1d] = leaf;
-          }
-  }
-  voxel_grid_ = new_voxel_grid;
+  for (const auto &block : new_voxels)
+    for (const std::uint64_t index_1d : block)
+      voxel_grid_.emplace (index_1d, Leaf ());
 }
 
 
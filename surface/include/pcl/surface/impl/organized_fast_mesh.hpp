@@ -43,6 +43,55 @@
 
 #include <pcl/surface/organized_fast_mesh.h>
 
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Find the pixels whose depth changed by more than \a threshold, or which became valid or invalid
+      * (NaN depth).
+      * \param[in] depth the new depths
+      * \param[in] previous_depth the previous depths
+      * \param[in] size the number of pixels
+      * \param[in] threshold the depth change threshold
+      * \param[out] changed the indices of the changed pixels, in increasing order
+      */
+    inline void
+    findDepthChanges (const float *depth, const float *previous_depth, int size, float threshold,
+                      std::vector<int> &changed)
+    {
+      changed.clear ();
+      int i = 0;
+#if defined(__SSE2__)
+      const __m128 sign_mask = _mm_set1_ps (-0.0f);
+      const __m128 threshold4 = _mm_set1_ps (threshold);
+      for (; i + 4 <= size; i += 4)
+      {
+        const __m128 d = _mm_loadu_ps (depth + i);
+        const __m128 p = _mm_loadu_ps (previous_depth + i);
+        const __m128 diff = _mm_andnot_ps (sign_mask, _mm_sub_ps (d, p));
+        // Changed by more than the threshold, or exactly one of the depths is NaN
+        const __m128 moved = _mm_cmpgt_ps (diff, threshold4);
+        const __m128 validity = _mm_xor_ps (_mm_cmpunord_ps (d, d), _mm_cmpunord_ps (p, p));
+        const int mask = _mm_movemask_ps (_mm_or_ps (moved, validity));
+        if (mask)
+          for (int lane = 0; lane < 4; ++lane)
+            if (mask & (1 << lane))
+              changed.push_back (i + lane);
+      }
+#endif
+      for (; i < size; ++i)
+        if (std::abs (depth[i] - previous_depth[i]) > threshold || std::isnan (depth[i]) != std::isnan (previous_depth[i]))
+          changed.push_back (i);
+    }
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::performReconstruction (pcl::PolygonMesh &output)
@@ -277,6 +326,213 @@ pcl::OrganizedFastMesh<PointInT>::makeAdaptiveCutMesh (std::vector<pcl::Vertices
   polygons.resize (idx);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::reconstructIncremental (TriangleMesh &mesh)
+{
+  if (triangulation_type_ == QUAD_MESH)
+  {
+    PCL_ERROR ("[pcl::OrganizedFastMesh::reconstructIncremental] A QuadMesh is needed for QUAD_MESH!\n");
+    return;
+  }
+  updateMesh (mesh);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::reconstructIncremental (QuadMesh &mesh)
+{
+  if (triangulation_type_ != QUAD_MESH)
+  {
+    PCL_ERROR ("[pcl::OrganizedFastMesh::reconstructIncremental] A TriangleMesh is needed for triangle meshes!\n");
+    return;
+  }
+  updateMesh (mesh);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> template <typename MeshT> void
+pcl::OrganizedFastMesh<PointInT>::updateMesh (MeshT &mesh)
+{
+  if (!input_ || !input_->isOrganized ())
+  {
+    PCL_ERROR ("[pcl::OrganizedFastMesh::reconstructIncremental] The input cloud must be organized!\n");
+    return;
+  }
+
+  const int width = static_cast<int> (input_->width);
+  const int nr_points = static_cast<int> (input_->points.size ());
+  const int last_column = width - triangle_pixel_size_columns_;
+  const int last_row = static_cast<int> (input_->height) - triangle_pixel_size_rows_;
+  const int nr_cells_x = last_column > 0 ? (last_column + triangle_pixel_size_columns_ - 1) / triangle_pixel_size_columns_ : 0;
+  const int nr_cells_y = last_row > 0 ? (last_row + triangle_pixel_size_rows_ - 1) / triangle_pixel_size_rows_ : 0;
+  const int polygon_size = triangulation_type_ == QUAD_MESH ? 4 : 3;
+
+  std::vector<float> depth (nr_points);
+  for (int i = 0; i < nr_points; ++i)
+    depth[i] = input_->points[i].z;
+
+  // Delete the faces of a cell
+  const auto clear_cell = [&] (int cell)
+  {
+    for (int k = 0; k < 2; ++k)
+    {
+      pcl::geometry::FaceIndex &face = cell_faces_[2 * cell + k];
+      if (face.isValid ())
+      {
+        mesh.deleteFace (face);
+        face.invalidate ();
+        --nr_cell_faces_;
+      }
+    }
+  };
+
+  // Add the faces of a cell, computed from the points of the mesh
+  std::array<std::array<int, 4>, 2> polygons;
+  typename MeshT::VertexIndices vertices (polygon_size);
+  const auto fill_cell = [&] (int cell)
+  {
+    const int i = (cell / nr_cells_x) * triangle_pixel_size_rows_ * width + (cell % nr_cells_x) * triangle_pixel_size_columns_;
+    const int index_right = i + triangle_pixel_size_columns_;
+    const int index_down = i + triangle_pixel_size_rows_ * width;
+    const int index_down_right = index_down + triangle_pixel_size_columns_;
+    const int nr_polygons = makeCellPolygons (mesh.getVertexDataCloud (), i, index_right, index_down, index_down_right, polygons);
+    for (int k = 0; k < nr_polygons; ++k)
+    {
+      for (int v = 0; v < polygon_size; ++v)
+        vertices[v] = pcl::geometry::VertexIndex (polygons[k][v]);
+      cell_faces_[2 * cell + k] = mesh.addFace (vertices);
+      if (cell_faces_[2 * cell + k].isValid ())
+        ++nr_cell_faces_;
+    }
+  };
+
+  const bool rebuild = previous_depth_.size () != static_cast<std::size_t> (nr_points) ||
+                       mesh.sizeVertices () != static_cast<std::size_t> (nr_points) ||
+                       cell_faces_.size () != static_cast<std::size_t> (2 * nr_cells_x * nr_cells_y) ||
+                       incremental_type_ != triangulation_type_ ||
+                       incremental_pixel_size_rows_ != triangle_pixel_size_rows_ ||
+                       incremental_pixel_size_columns_ != triangle_pixel_size_columns_ ||
+                       // Too many faces were deleted by the updates
+                       mesh.sizeFaces () > 2 * nr_cell_faces_ + 4096;
+  if (rebuild)
+  {
+    mesh.clear ();
+    mesh.reserveVertices (nr_points);
+    mesh.reserveEdges (3 * nr_cells_x * nr_cells_y + nr_cells_x + nr_cells_y);
+    mesh.reserveFaces (2 * nr_cells_x * nr_cells_y);
+    for (const auto &point : input_->points)
+      mesh.addVertex (point);
+
+    previous_depth_ = depth;
+    cell_faces_.assign (2 * nr_cells_x * nr_cells_y, pcl::geometry::FaceIndex ());
+    nr_cell_faces_ = 0;
+    incremental_type_ = triangulation_type_;
+    incremental_pixel_size_rows_ = triangle_pixel_size_rows_;
+    incremental_pixel_size_columns_ = triangle_pixel_size_columns_;
+    for (int cell = 0; cell < nr_cells_x * nr_cells_y; ++cell)
+      fill_cell (cell);
+    return;
+  }
+
+  // Update the changed points, and find the cells they are a corner of
+  std::vector<int> changed;
+  pcl::detail::findDepthChanges (depth.data (), previous_depth_.data (), nr_points, depth_change_threshold_, changed);
+  std::vector<int> dirty_cells;
+  for (const int index : changed)
+  {
+    mesh.getVertexDataCloud ()[index] = input_->points[index];
+    previous_depth_[index] = depth[index];
+
+    const int x = index % width, y = index / width;
+    if (x % triangle_pixel_size_columns_ != 0 || y % triangle_pixel_size_rows_ != 0)
+      continue;
+    const int cell_x = x / triangle_pixel_size_columns_, cell_y = y / triangle_pixel_size_rows_;
+    for (int cy = cell_y - 1; cy <= cell_y; ++cy)
+      for (int cx = cell_x - 1; cx <= cell_x; ++cx)
+        if (cx >= 0 && cx < nr_cells_x && cy >= 0 && cy < nr_cells_y)
+          dirty_cells.push_back (cy * nr_cells_x + cx);
+  }
+  std::sort (dirty_cells.begin (), dirty_cells.end ());
+  dirty_cells.erase (std::unique (dirty_cells.begin (), dirty_cells.end ()), dirty_cells.end ());
+
+  // Delete all the faces first, so that the new ones do not conflict with the old ones
+  for (const int cell : dirty_cells)
+    clear_cell (cell);
+  for (const int cell : dirty_cells)
+    fill_cell (cell);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> int
+pcl::OrganizedFastMesh<PointInT>::makeCellPolygons (const pcl::PointCloud<PointInT> &cloud, int i, int index_right,
+                                                    int index_down, int index_down_right,
+                                                    std::array<std::array<int, 4>, 2> &polygons)
+{
+  const PointInT &p = cloud.points[i];
+  const PointInT &p_right = cloud.points[index_right];
+  const PointInT &p_down = cloud.points[index_down];
+  const PointInT &p_down_right = cloud.points[index_down_right];
+  const bool valid = pcl::isFinite (p), valid_right = pcl::isFinite (p_right),
+             valid_down = pcl::isFinite (p_down), valid_down_right = pcl::isFinite (p_down_right);
+
+  int nr_polygons = 0;
+  const auto add_triangle = [&] (int a, const PointInT &point_a, int b, const PointInT &point_b, int c, const PointInT &point_c)
+  {
+    if (store_shadowed_faces_ || !(isShadowed (point_a, point_b) || isShadowed (point_b, point_c) || isShadowed (point_c, point_a)))
+      polygons[nr_polygons++] = {{a, b, c, -1}};
+  };
+
+  if (triangulation_type_ == QUAD_MESH)
+  {
+    if (valid && valid_right && valid_down_right && valid_down)
+      if (store_shadowed_faces_ || !(isShadowed (p, p_right) || isShadowed (p_right, p_down_right) ||
+                                     isShadowed (p_down_right, p_down) || isShadowed (p_down, p)))
+        polygons[nr_polygons++] = {{i, index_right, index_down_right, index_down}};
+    return (nr_polygons);
+  }
+
+  const bool right_cut_upper = valid && valid_down_right && valid_right;
+  const bool right_cut_lower = valid && valid_down && valid_down_right;
+  const bool left_cut_upper = valid && valid_down && valid_right;
+  const bool left_cut_lower = valid_right && valid_down && valid_down_right;
+
+  bool right_cut = triangulation_type_ == TRIANGLE_RIGHT_CUT;
+  if (triangulation_type_ == TRIANGLE_ADAPTIVE_CUT)
+  {
+    if (!(right_cut_upper && right_cut_lower && left_cut_upper && left_cut_lower))
+    {
+      // At most one of the triangles is valid
+      if (right_cut_upper)
+        add_triangle (i, p, index_down_right, p_down_right, index_right, p_right);
+      if (right_cut_lower)
+        add_triangle (i, p, index_down, p_down, index_down_right, p_down_right);
+      if (left_cut_upper)
+        add_triangle (i, p, index_down, p_down, index_right, p_right);
+      if (left_cut_lower)
+        add_triangle (index_right, p_right, index_down, p_down, index_down_right, p_down_right);
+      return (nr_polygons);
+    }
+    right_cut = std::abs (p_down.z - p_right.z) >= std::abs (p.z - p_down_right.z);
+  }
+
+  if (right_cut)
+  {
+    if (right_cut_upper)
+      add_triangle (i, p, index_down_right, p_down_right, index_right, p_right);
+    if (right_cut_lower)
+      add_triangle (i, p, index_down, p_down, index_down_right, p_down_right);
+  }
+  else
+  {
+    if (left_cut_upper)
+      add_triangle (i, p, index_down, p_down, index_right, p_right);
+    if (left_cut_lower)
+      add_triangle (index_right, p_right, index_down, p_down, index_down_right, p_down_right);
+  }
+  return (nr_polygons);
+}
+
 #define PCL_INSTANTIATE_OrganizedFastMesh(T)                \
   template class PCL_EXPORTS pcl::OrganizedFastMesh<T>;
 
@@ -42,6 +42,7 @@
 
 #include <pcl/surface/poisson.h>
 #include <pcl/common/common.h>
+#include <pcl/common/parallel.h>
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
@@ -54,6 +55,7 @@
 
 #define MEMORY_ALLOCATOR_BLOCK_SIZE 1<<12
 
+#include <algorithm>
 #include <cstdarg>
 #include <string>
 
@@ -81,6 +83,8 @@ pcl::Poisson<PointNT>::Poisson ()
   , show_residual_ (false)
   , min_iterations_ (8)
   , solver_accuracy_ (1e-3f)
+  , threads_ (1)
+  , bounded_memory_ (false)
 {
 }
 
@@ -100,11 +104,9 @@ pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
   poisson::TreeNodeData::UseIndex = 1;
   poisson::Octree<Degree> tree;
 
-  /// TODO OPENMP stuff
-  //    tree.threads = Threads.value;
+  tree.threads = threads_ > 0 ? threads_ : static_cast<int> (pcl::parallel::getThreadBudget ());
   center.coords[0] = center.coords[1] = center.coords[2] = 0;
 
-
   if (solver_divide_ < min_depth_)
   {
     PCL_WARN ("[pcl::Poisson] solver_divide_ must be at least as large as min_depth_: %d >= %d\n", solver_divide_, min_depth_);
@@ -116,6 +118,18 @@ pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
     iso_divide_ = min_depth_;
   }
 
+  // Deep trees: cap the per-thread scatter buffers and solve / extract in blocks, for this run only
+  int solver_divide = solver_divide_, iso_divide = iso_divide_;
+  tree.boundedMemory = bounded_memory_ && depth_ >= 11;
+  if (tree.boundedMemory)
+  {
+    const int max_divide = std::max (8, min_depth_);
+    if (solver_divide > max_divide || iso_divide > max_divide)
+      PCL_DEBUG ("[pcl::Poisson] Bounded memory mode: limiting the solver/iso divide to %d\n", max_divide);
+    solver_divide = std::min (solver_divide, max_divide);
+    iso_divide = std::min (iso_divide, max_divide);
+  }
+
   pcl::poisson::TreeOctNode::SetAllocator (MEMORY_ALLOCATOR_BLOCK_SIZE);
 
   kernel_depth_ = depth_ - 2;
@@ -130,7 +144,7 @@ pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
 
   tree.ClipTree ();
   tree.finalize ();
-  tree.RefineBoundary (iso_divide_);
+  tree.RefineBoundary (iso_divide);
 
   PCL_DEBUG ("Input Points: %d\n" , point_count );
   PCL_DEBUG ("Leaves/Nodes: %d/%d\n" , tree.tree.leaves() , tree.tree.nodes() );
@@ -139,11 +153,11 @@ pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
   tree.SetLaplacianConstraints ();
 
   tree.maxMemoryUsage = 0;
-  tree.LaplacianMatrixIteration (solver_divide_, show_residual_, min_iterations_, solver_accuracy_);
+  tree.LaplacianMatrixIteration (solver_divide, show_residual_, min_iterations_, solver_accuracy_);
 
   iso_value = tree.GetIsoValue ();
 
-  tree.GetMCIsoTriangles (iso_value, iso_divide_, &mesh, 0, 1, manifold_, output_polygons_);
+  tree.GetMCIsoTriangles (iso_value, iso_divide, &mesh, 0, 1, manifold_, output_polygons_);
 }
 
 
@@ -0,0 +1,597 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SURFACE_IMPL_TSDF_VOLUME_H_
+#define PCL_SURFACE_IMPL_TSDF_VOLUME_H_
+
+#include <pcl/surface/tsdf_volume.h>
+#include <pcl/surface/marching_cubes.h> // for edgeTable and triTable
+#include <pcl/common/parallel.h>
+#include <pcl/console/print.h>
+#include <pcl/conversions.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Half the number of voxels along each axis of a TSDFVolume. */
+    constexpr int tsdf_volume_half_extent = 1 << 19;
+
+    /** \brief Trilinear interpolation of the values at the corners of a unit cube, given in the order
+      * (0,0,0), (1,0,0), (0,1,0), (1,1,0), (0,0,1), (1,0,1), (0,1,1), (1,1,1), at the point (fx, fy, fz).
+      */
+    inline float
+    tsdfTrilinear (const float values[8], float fx, float fy, float fz)
+    {
+#if defined(__SSE2__)
+      // Interpolate along z the four pairs of corners at once, then weight the four results by their xy weights
+      const __m128 bottom = _mm_loadu_ps (values);
+      const __m128 top = _mm_loadu_ps (values + 4);
+      const __m128 wx = _mm_set_ps (fx, 1.0f - fx, fx, 1.0f - fx);
+      const __m128 wy = _mm_set_ps (fy, fy, 1.0f - fy, 1.0f - fy);
+      const __m128 z = _mm_add_ps (_mm_mul_ps (bottom, _mm_set1_ps (1.0f - fz)), _mm_mul_ps (top, _mm_set1_ps (fz)));
+      __m128 sum = _mm_mul_ps (_mm_mul_ps (wx, wy), z);
+      sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+      sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 1));
+      return (_mm_cvtss_f32 (sum));
+#else
+      float z[4];
+      for (int i = 0; i < 4; ++i)
+        z[i] = values[i] * (1.0f - fz) + values[i + 4] * fz;
+      const float y0 = z[0] * (1.0f - fx) + z[1] * fx;
+      const float y1 = z[2] * (1.0f - fx) + z[3] * fx;
+      return (y0 * (1.0f - fy) + y1 * fy);
+#endif
+    }
+  }
+}
+
+template <typename PointT> constexpr int pcl::TSDFVolume<PointT>::BLOCK_SIZE;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::TSDFVolume<PointT>::TSDFVolume (float voxel_size, float trunc_dist)
+  : voxel_size_ (voxel_size)
+  , trunc_dist_ (trunc_dist)
+  , max_weight_ (128.0f)
+  , fx_ (525.0f), fy_ (525.0f), cx_ (-1.0f), cy_ (-1.0f)
+  , min_depth_ (0.3f), max_depth_ (5.0f)
+  , threads_ (1)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::TSDFVolume<PointT>::setVoxelSize (float voxel_size)
+{
+  voxel_size_ = voxel_size;
+  reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::TSDFVolume<PointT>::reset ()
+{
+  blocks_.clear ();
+  block_keys_.clear ();
+  block_indices_.clear ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::uint64_t
+pcl::TSDFVolume<PointT>::getBlockKey (const Eigen::Vector3i &block)
+{
+  // 21 bits per axis, which is enough for the blocks of the whole volume
+  const std::uint64_t mask = (std::uint64_t (1) << 21) - 1;
+  const int offset = 1 << 20;
+  return (((static_cast<std::uint64_t> (block[0] + offset) & mask) << 42) |
+          ((static_cast<std::uint64_t> (block[1] + offset) & mask) << 21) |
+           (static_cast<std::uint64_t> (block[2] + offset) & mask));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> Eigen::Vector3i
+pcl::TSDFVolume<PointT>::getBlockCoordinates (std::uint64_t key)
+{
+  const std::uint64_t mask = (std::uint64_t (1) << 21) - 1;
+  const int offset = 1 << 20;
+  return (Eigen::Vector3i (static_cast<int> ((key >> 42) & mask) - offset,
+                           static_cast<int> ((key >> 21) & mask) - offset,
+                           static_cast<int> (key & mask) - offset));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> Eigen::Vector3i
+pcl::TSDFVolume<PointT>::getBlockOfVoxel (const Eigen::Vector3i &voxel)
+{
+  // Integer division rounding towards minus infinity
+  Eigen::Vector3i block;
+  for (int d = 0; d < 3; ++d)
+    block[d] = (voxel[d] >= 0 ? voxel[d] : voxel[d] - (BLOCK_SIZE - 1)) / BLOCK_SIZE;
+  return (block);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::TSDFVolume<PointT>::getIndexInBlock (const Eigen::Vector3i &voxel, const Eigen::Vector3i &block)
+{
+  const Eigen::Vector3i local = voxel - block * BLOCK_SIZE;
+  return ((local[2] * BLOCK_SIZE + local[1]) * BLOCK_SIZE + local[0]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> const typename pcl::TSDFVolume<PointT>::Voxel*
+pcl::TSDFVolume<PointT>::findVoxel (const Eigen::Vector3i &voxel, BlockCache &cache) const
+{
+  const Eigen::Vector3i block = getBlockOfVoxel (voxel);
+  const std::uint64_t key = getBlockKey (block);
+  if (key != cache.key)
+  {
+    const auto it = block_indices_.find (key);
+    cache.key = key;
+    cache.block = (it == block_indices_.end ()) ? nullptr : &blocks_[it->second];
+  }
+  if (!cache.block)
+    return (nullptr);
+  return (&(*cache.block)[getIndexInBlock (voxel, block)]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::TSDFVolume<PointT>::interpolate (const Eigen::Vector3f &point, float &tsdf, BlockCache &cache) const
+{
+  // The values are stored at the centers of the voxels
+  const Eigen::Vector3f grid = point / voxel_size_ - Eigen::Vector3f::Constant (0.5f);
+  const Eigen::Vector3f base = grid.array ().floor ();
+  const Eigen::Vector3f f = grid - base;
+  const Eigen::Vector3i voxel = base.cast<int> ();
+
+  alignas (16) float values[8];
+  const Eigen::Vector3i block = getBlockOfVoxel (voxel);
+  const Eigen::Vector3i local = voxel - block * BLOCK_SIZE;
+  if ((local.array () < BLOCK_SIZE - 1).all ())
+  {
+    // All the corners are in the same block, which is looked up once
+    const Voxel *first = findVoxel (voxel, cache);
+    if (!first)
+      return (false);
+    for (int i = 0; i < 8; ++i)
+    {
+      const Voxel &corner = first[(i & 1) + ((i >> 1) & 1) * BLOCK_SIZE + (i >> 2) * BLOCK_SIZE * BLOCK_SIZE];
+      if (corner.weight == 0.0f)
+        return (false);
+      values[i] = corner.tsdf;
+    }
+  }
+  else
+  {
+    for (int i = 0; i < 8; ++i)
+    {
+      const Voxel *corner = findVoxel (voxel + Eigen::Vector3i (i & 1, (i >> 1) & 1, i >> 2), cache);
+      if (!corner || corner->weight == 0.0f)
+        return (false);
+      values[i] = corner->tsdf;
+    }
+  }
+
+  tsdf = detail::tsdfTrilinear (values, f[0], f[1], f[2]);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::TSDFVolume<PointT>::integrate (const PointCloud &cloud, const Eigen::Affine3f &camera_pose)
+{
+  if (!cloud.isOrganized ())
+  {
+    PCL_ERROR ("[pcl::TSDFVolume::integrate] The input cloud is not organized!\n");
+    return (false);
+  }
+
+  const unsigned int width = cloud.width;
+  const unsigned int height = cloud.height;
+  float cx, cy;
+  getPrincipalPoint (width, height, cx, cy);
+  const float block_extent = voxel_size_ * BLOCK_SIZE;
+  const Eigen::Vector3f camera_origin = camera_pose.translation ();
+  const int nr_steps = std::max (1, static_cast<int> (std::ceil (2.0f * trunc_dist_ / voxel_size_)));
+
+  // Find the blocks within the truncation distance of the frame, by sampling the ray of every pixel around its depth.
+  // Each chunk of rows sorts its own keys, and the lists of the chunks are merged in order afterwards
+  using Keys = std::vector<std::uint64_t>;
+  Keys keys = pcl::parallel::parallel_reduce (0u, height, Keys (), [&] (unsigned int first, unsigned int last)
+  {
+    Keys chunk_keys;
+    for (unsigned int v = first; v < last; ++v)
+    {
+      for (unsigned int u = 0; u < width; ++u)
+      {
+        const PointT &p = cloud (u, v);
+        if (!std::isfinite (p.z) || p.z < min_depth_ || p.z > max_depth_)
+          continue;
+        const Eigen::Vector3f point (p.x, p.y, p.z);
+        const float distance = point.norm ();
+        const Eigen::Vector3f direction = camera_pose.linear () * (point / distance);
+        std::uint64_t last_key = ~std::uint64_t (0);
+        for (int s = 0; s <= nr_steps; ++s)
+        {
+          const float t = distance - trunc_dist_ + 2.0f * trunc_dist_ * static_cast<float> (s) / nr_steps;
+          const Eigen::Vector3i block = ((camera_origin + t * direction) / block_extent).array ().floor ().template cast<int> ();
+          if ((block.array () < -detail::tsdf_volume_half_extent / BLOCK_SIZE).any () ||
+              (block.array () >= detail::tsdf_volume_half_extent / BLOCK_SIZE).any ())
+            continue;
+          const std::uint64_t key = getBlockKey (block);
+          if (key != last_key)
+            chunk_keys.push_back (key);
+          last_key = key;
+        }
+      }
+    }
+    std::sort (chunk_keys.begin (), chunk_keys.end ());
+    chunk_keys.erase (std::unique (chunk_keys.begin (), chunk_keys.end ()), chunk_keys.end ());
+    return (chunk_keys);
+  },
+  [] (Keys a, const Keys &b)
+  {
+    a.insert (a.end (), b.begin (), b.end ());
+    return (a);
+  }, threads_, 16u);
+  std::sort (keys.begin (), keys.end ());
+  keys.erase (std::unique (keys.begin (), keys.end ()), keys.end ());
+
+  // Allocate the new blocks, with the voxels not observed yet
+  std::vector<std::size_t> frame_blocks;
+  frame_blocks.reserve (keys.size ());
+  for (const std::uint64_t key : keys)
+  {
+    const auto result = block_indices_.emplace (key, blocks_.size ());
+    if (result.second)
+    {
+      blocks_.emplace_back ();
+      blocks_.back ().fill (Voxel {1.0f, 0.0f});
+      block_keys_.push_back (key);
+    }
+    frame_blocks.push_back (result.first->second);
+  }
+
+  // Update the voxels of the blocks seen in the frame. The voxels are projected into the frame, and their signed
+  // distance is measured along the optical axis
+  const Eigen::Affine3f world_to_camera = camera_pose.inverse ();
+  const Eigen::Vector3f step_x = world_to_camera.linear ().col (0) * voxel_size_;
+  const Eigen::Vector3f step_y = world_to_camera.linear ().col (1) * voxel_size_;
+  const Eigen::Vector3f step_z = world_to_camera.linear ().col (2) * voxel_size_;
+  pcl::parallel::parallel_for (std::size_t (0), frame_blocks.size (), [&] (std::size_t first, std::size_t last)
+  {
+    for (std::size_t b = first; b < last; ++b)
+    {
+      Block &block = blocks_[frame_blocks[b]];
+      const Eigen::Vector3f origin = world_to_camera *
+        (((getBlockCoordinates (block_keys_[frame_blocks[b]]) * BLOCK_SIZE).template cast<float> () +
+          Eigen::Vector3f::Constant (0.5f)) * voxel_size_);
+      int index = 0;
+      for (int z = 0; z < BLOCK_SIZE; ++z)
+      {
+        for (int y = 0; y < BLOCK_SIZE; ++y)
+        {
+          for (int x = 0; x < BLOCK_SIZE; ++x, ++index)
+          {
+            const Eigen::Vector3f p = origin + static_cast<float> (x) * step_x + static_cast<float> (y) * step_y +
+                                      static_cast<float> (z) * step_z;
+            if (p[2] <= 0.0f)
+              continue;
+            const float u = std::floor (fx_ * p[0] / p[2] + cx + 0.5f);
+            const float v = std::floor (fy_ * p[1] / p[2] + cy + 0.5f);
+            if (u < 0.0f || v < 0.0f || u >= static_cast<float> (width) || v >= static_cast<float> (height))
+              continue;
+            const float depth = cloud (static_cast<int> (u), static_cast<int> (v)).z;
+            if (!std::isfinite (depth) || depth < min_depth_ || depth > max_depth_)
+              continue;
+            const float sdf = depth - p[2];
+            if (sdf < -trunc_dist_)
+              continue;
+
+            Voxel &voxel = block[index];
+            const float tsdf = std::min (1.0f, sdf / trunc_dist_);
+            voxel.tsdf = (voxel.tsdf * voxel.weight + tsdf) / (voxel.weight + 1.0f);
+            voxel.weight = std::min (voxel.weight + 1.0f, max_weight_);
+          }
+        }
+      }
+    }
+  }, threads_, std::size_t (1));
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::TSDFVolume<PointT>::raycast (const Eigen::Affine3f &camera_pose, unsigned int width, unsigned int height,
+                                  PointCloud &cloud) const
+{
+  castRays (camera_pose, width, height, cloud, nullptr);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::TSDFVolume<PointT>::raycast (const Eigen::Affine3f &camera_pose, unsigned int width, unsigned int height,
+                                  PointCloud &cloud, pcl::PointCloud<pcl::Normal> &normals) const
+{
+  castRays (camera_pose, width, height, cloud, &normals);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::TSDFVolume<PointT>::castRays (const Eigen::Affine3f &camera_pose, unsigned int width, unsigned int height,
+                                   PointCloud &cloud, pcl::PointCloud<pcl::Normal> *normals) const
+{
+  cloud.points.assign (std::size_t (width) * height, PointT ());
+  cloud.width = width;
+  cloud.height = height;
+  cloud.is_dense = false;
+  if (normals)
+  {
+    normals->points.assign (std::size_t (width) * height, pcl::Normal ());
+    normals->width = width;
+    normals->height = height;
+    normals->is_dense = false;
+  }
+
+  float cx, cy;
+  getPrincipalPoint (width, height, cx, cy);
+  const float nan = std::numeric_limits<float>::quiet_NaN ();
+  const float block_extent = voxel_size_ * BLOCK_SIZE;
+  const Eigen::Vector3f camera_origin = camera_pose.translation ();
+
+  pcl::parallel::parallel_for (0u, height, [&] (unsigned int first, unsigned int last)
+  {
+    BlockCache cache;
+    for (unsigned int v = first; v < last; ++v)
+    {
+      for (unsigned int u = 0; u < width; ++u)
+      {
+        PointT &point = cloud (u, v);
+        point.x = point.y = point.z = nan;
+        if (normals)
+        {
+          pcl::Normal &normal = (*normals) (u, v);
+          normal.normal_x = normal.normal_y = normal.normal_z = normal.curvature = nan;
+        }
+
+        // The point of the ray at depth z is ray * z in the camera frame, and origin + direction * z in the volume
+        const Eigen::Vector3f ray ((static_cast<float> (u) - cx) / fx_, (static_cast<float> (v) - cy) / fy_, 1.0f);
+        const float ray_length = ray.norm ();
+        const Eigen::Vector3f direction = camera_pose.linear () * ray;
+
+        float z = min_depth_;
+        float previous_z = 0.0f, previous_tsdf = 0.0f;
+        bool previous_valid = false;
+        while (z < max_depth_)
+        {
+          const Eigen::Vector3f q = camera_origin + z * direction;
+          const Eigen::Vector3f grid = q / voxel_size_;
+          if (!findVoxel (grid.array ().floor ().template cast<int> (), cache))
+          {
+            // Skip the whole block, up to the plane through which the ray leaves it
+            const Eigen::Vector3f lower = (grid / static_cast<float> (BLOCK_SIZE)).array ().floor () * block_extent;
+            float exit = std::numeric_limits<float>::max ();
+            for (int d = 0; d < 3; ++d)
+            {
+              if (direction[d] > 0.0f)
+                exit = std::min (exit, (lower[d] + block_extent - camera_origin[d]) / direction[d]);
+              else if (direction[d] < 0.0f)
+                exit = std::min (exit, (lower[d] - camera_origin[d]) / direction[d]);
+            }
+            z = std::max (exit, z) + 0.01f * voxel_size_ / ray_length;
+            previous_valid = false;
+            continue;
+          }
+
+          float tsdf;
+          if (!interpolate (q, tsdf, cache))
+          {
+            z += voxel_size_ / ray_length;
+            previous_valid = false;
+            continue;
+          }
+
+          if (previous_valid && previous_tsdf > 0.0f && tsdf <= 0.0f)
+          {
+            // Zero crossing from the front: interpolate the surface between the two samples
+            const float hit = previous_z + (z - previous_z) * previous_tsdf / (previous_tsdf - tsdf);
+            point.getVector3fMap () = ray * hit;
+            if (normals)
+            {
+              const Eigen::Vector3f surface = camera_origin + hit * direction;
+              Eigen::Vector3f gradient;
+              bool valid = true;
+              for (int d = 0; d < 3 && valid; ++d)
+              {
+                Eigen::Vector3f offset = Eigen::Vector3f::Zero ();
+                offset[d] = voxel_size_;
+                float forward, backward;
+                valid = interpolate (surface + offset, forward, cache) && interpolate (surface - offset, backward, cache);
+                if (valid)
+                  gradient[d] = forward - backward;
+              }
+              if (valid && gradient.squaredNorm () > 0.0f)
+              {
+                pcl::Normal &normal = (*normals) (u, v);
+                normal.getNormalVector3fMap () = (camera_pose.linear ().transpose () * gradient).normalized ();
+                normal.curvature = 0.0f;
+              }
+            }
+            break;
+          }
+          // Zero crossing from the back, the surface is not visible
+          if (previous_valid && previous_tsdf < 0.0f && tsdf > 0.0f)
+            break;
+
+          previous_valid = true;
+          previous_tsdf = tsdf;
+          previous_z = z;
+          // The surface is at least at the signed distance, up to the error of the projective distances
+          z += std::max (voxel_size_, 0.8f * tsdf * trunc_dist_) / ray_length;
+        }
+      }
+    }
+  }, threads_, 1u);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::TSDFVolume<PointT>::extractMesh (pcl::PolygonMesh &mesh) const
+{
+  // The corners of a cell in the order of pcl::MarchingCubes, and the two corners of every edge
+  static const int corners[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1},
+                                    {0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1}};
+  static const int edge_corners[12][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6},
+                                          {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+  // The corner at which every edge starts, and the axis along which it goes
+  static const int edge_origin[12] = {0, 1, 3, 0, 4, 5, 7, 4, 0, 1, 2, 3};
+  static const int edge_axis[12] = {0, 2, 0, 2, 0, 2, 0, 2, 1, 1, 1, 1};
+
+  // Every cell is owned by the block of its lowest corner, so that each is polygonized once. The triangles of the
+  // blocks are collected separately, with the ids of the edges their vertices lie on
+  struct BlockTriangles
+  {
+    std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > vertices;
+    std::vector<std::uint64_t> edges;
+  };
+  std::vector<BlockTriangles> block_triangles (blocks_.size ());
+
+  pcl::parallel::parallel_for (std::size_t (0), blocks_.size (), [&] (std::size_t first, std::size_t last)
+  {
+    BlockCache cache;
+    for (std::size_t b = first; b < last; ++b)
+    {
+      const Block &block = blocks_[b];
+      const Eigen::Vector3i origin = getBlockCoordinates (block_keys_[b]) * BLOCK_SIZE;
+      BlockTriangles &triangles = block_triangles[b];
+      for (int z = 0; z < BLOCK_SIZE; ++z)
+      {
+        for (int y = 0; y < BLOCK_SIZE; ++y)
+        {
+          for (int x = 0; x < BLOCK_SIZE; ++x)
+          {
+            const bool inner = x < BLOCK_SIZE - 1 && y < BLOCK_SIZE - 1 && z < BLOCK_SIZE - 1;
+            float values[8];
+            int cubeindex = 0;
+            bool valid = true;
+            for (int i = 0; i < 8 && valid; ++i)
+            {
+              const Voxel *corner;
+              if (inner)
+                corner = &block[((z + corners[i][2]) * BLOCK_SIZE + y + corners[i][1]) * BLOCK_SIZE + x + corners[i][0]];
+              else
+                corner = findVoxel (origin + Eigen::Vector3i (x + corners[i][0], y + corners[i][1], z + corners[i][2]),
+                                    cache);
+              valid = corner && corner->weight > 0.0f;
+              if (valid)
+              {
+                values[i] = corner->tsdf;
+                if (values[i] < 0.0f)
+                  cubeindex |= 1 << i;
+              }
+            }
+            if (!valid || edgeTable[cubeindex] == 0)
+              continue;
+
+            const Eigen::Vector3i cell = origin + Eigen::Vector3i (x, y, z);
+            for (int i = 0; triTable[cubeindex][i] != -1; ++i)
+            {
+              const int edge = triTable[cubeindex][i];
+              const int c1 = edge_corners[edge][0], c2 = edge_corners[edge][1];
+              const Eigen::Vector3f p1 = (cell + Eigen::Vector3i (corners[c1][0], corners[c1][1], corners[c1][2]))
+                                         .template cast<float> ();
+              const Eigen::Vector3f p2 = (cell + Eigen::Vector3i (corners[c2][0], corners[c2][1], corners[c2][2]))
+                                         .template cast<float> ();
+              const float mu = values[c1] / (values[c1] - values[c2]);
+              triangles.vertices.push_back ((p1 + mu * (p2 - p1) + Eigen::Vector3f::Constant (0.5f)) * voxel_size_);
+
+              // 20 bits per axis for the voxel at which the edge starts, and 2 bits for its axis
+              const int *start = corners[edge_origin[edge]];
+              const std::uint64_t mask = (std::uint64_t (1) << 20) - 1;
+              triangles.edges.push_back (
+                ((static_cast<std::uint64_t> (cell[0] + start[0] + detail::tsdf_volume_half_extent) & mask) << 42) |
+                ((static_cast<std::uint64_t> (cell[1] + start[1] + detail::tsdf_volume_half_extent) & mask) << 22) |
+                ((static_cast<std::uint64_t> (cell[2] + start[2] + detail::tsdf_volume_half_extent) & mask) << 2) |
+                static_cast<std::uint64_t> (edge_axis[edge]));
+            }
+          }
+        }
+      }
+    }
+  }, threads_, std::size_t (1));
+
+  // Merge the vertices on the same edge, in the order of the blocks
+  pcl::PointCloud<PointT> vertices;
+  mesh.polygons.clear ();
+  std::unordered_map<std::uint64_t, std::uint32_t> edge_vertices;
+  for (const BlockTriangles &triangles : block_triangles)
+  {
+    for (std::size_t i = 0; i < triangles.vertices.size (); i += 3)
+    {
+      pcl::Vertices polygon;
+      polygon.vertices.resize (3);
+      for (int j = 0; j < 3; ++j)
+      {
+        const auto result = edge_vertices.emplace (triangles.edges[i + j], static_cast<std::uint32_t> (vertices.size ()));
+        if (result.second)
+        {
+          PointT vertex;
+          vertex.getVector3fMap () = triangles.vertices[i + j];
+          vertices.push_back (vertex);
+        }
+        polygon.vertices[j] = result.first->second;
+      }
+      mesh.polygons.push_back (polygon);
+    }
+  }
+  pcl::toPCLPointCloud2 (vertices, mesh.cloud);
+}
+
+#define PCL_INSTANTIATE_TSDFVolume(T) template class PCL_EXPORTS pcl::TSDFVolume<T>;
+
+#endif    // PCL_SURFACE_IMPL_TSDF_VOLUME_H_
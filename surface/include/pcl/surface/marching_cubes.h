@@ -40,6 +40,9 @@
 #include <pcl/surface/boost.h>
 #include <pcl/surface/reconstruction.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace pcl
 {
   /*
@@ -434,10 +437,54 @@ namespace pcl
       getPercentageExtendGrid ()
       { return percentage_extend_grid_; }
 
+      /** \brief Set the number of threads used to compute the scalar field and to triangulate the grid. The result
+        * does not depend on it.
+        * \param[in] nr_threads the number of threads (0 uses the whole pcl::parallel thread budget, default: 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads used to compute the scalar field and to triangulate the grid. */
+      inline unsigned int
+      getNumberOfThreads () const
+      { return threads_; }
+
+      /** \brief Set whether the triangles share their vertices. By default every triangle has 3 vertices of its own
+        * (a triangle soup). Otherwise the intersections of the surface with a grid edge are merged into a single
+        * vertex, which gives a connected mesh with about 6 times fewer vertices.
+        * \param[in] merge_vertices whether the vertices on shared grid edges are merged (default: false)
+        */
+      inline void
+      setMergeVertices (bool merge_vertices)
+      { merge_vertices_ = merge_vertices; }
+
+      /** \brief Get whether the vertices on shared grid edges are merged. */
+      inline bool
+      getMergeVertices () const
+      { return merge_vertices_; }
+
     protected:
       /** \brief The data structure storing the 3D grid */
       std::vector<float> grid_;
 
+      /** \brief Whether the scalar field is only stored in a narrow band around the input (see usesNarrowBand ()),
+        * in band_nodes_ and band_values_ instead of grid_. */
+      bool narrow_band_ = false;
+
+      /** \brief The sorted linear indices (x * res_y_ * res_z_ + y * res_z_ + z) of the grid nodes of the narrow band
+        * where the scalar field is defined. */
+      std::vector<std::uint64_t> band_nodes_;
+
+      /** \brief The scalar field at the nodes of band_nodes_. */
+      std::vector<float> band_values_;
+
+      /** \brief The number of threads used to compute the scalar field and to triangulate the grid. */
+      unsigned int threads_ = 1;
+
+      /** \brief Whether the vertices on shared grid edges are merged. */
+      bool merge_vertices_ = false;
+
       /** \brief The grid resolution */
       int res_x_ = 32, res_y_ = 32, res_z_ = 32;
 
@@ -460,6 +507,13 @@ namespace pcl
       virtual void
       voxelizeData () = 0;
 
+      /** \brief Whether voxelizeData () only fills a narrow band of the grid, i.e. band_nodes_ and band_values_.
+        * The grid nodes outside of the band are undefined, and grid_ is then not allocated.
+        */
+      virtual bool
+      usesNarrowBand () const
+      { return false; }
+
       /** \brief Interpolate along the voxel edge.
         * \param[in] p1 The first point on the edge
         * \param[in] p2 The second point on the edge
@@ -475,11 +529,14 @@ namespace pcl
         * \param leaf_node the leaf node to be checked
         * \param index_3d the 3d index of the leaf node to be checked
         * \param cloud point cloud to store the vertices of the polygon
+        * \param edge_ids if given, the grid edge of every vertex is appended to it, as 3 times the linear index of the
+        * first node of the edge plus its axis
         */
       void
       createSurface (const std::vector<float> &leaf_node,
                      const Eigen::Vector3i &index_3d,
-                     pcl::PointCloud<PointNT> &cloud);
+                     pcl::PointCloud<PointNT> &cloud,
+                     std::vector<std::uint64_t> *edge_ids = nullptr);
 
       /** \brief Get the bounding box for the input data points. 
         */
@@ -39,9 +39,11 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
-#include <map>
+#include <limits>
 #include <random>
+#include <unordered_map>
 
 // PCL includes
 #include <pcl/memory.h>
@@ -312,7 +314,7 @@ namespace pcl
                               voxel_size_ (1.0),
                               dilation_iteration_num_ (0),
                               nr_coeff_ (),
-                              rng_uniform_distribution_ ()
+                              rng_seed_ (0)
                               {};
 
       /** \brief Empty destructor */
@@ -487,8 +489,9 @@ namespace pcl
 
       /** \brief Set whether the mls results should be stored for each point in the input cloud
         * \param[in] cache_mls_results True if the mls results should be stored, otherwise false.
-        * \note The cache_mls_results_ is forced to true when using upsampling method VOXEL_GRID_DILATION or DISTINCT_CLOUD.
-        * \note If memory consumption is a concern set to false when not using upsampling method VOXEL_GRID_DILATION or DISTINCT_CLOUD.
+        * \note If memory consumption is a concern set to false. With the upsampling methods VOXEL_GRID_DILATION and
+        * DISTINCT_CLOUD, the fit of the input point closest to each sample is then computed when needed instead of being
+        * looked up, which gives the same output at a higher computational cost.
         */
       inline void
       setCacheMLSResults (bool cache_mls_results) { cache_mls_results_ = cache_mls_results; }
@@ -510,13 +513,14 @@ namespace pcl
       getProjectionMethod () const { return (projection_method_); }
 
       /** \brief Get the MLSResults for input cloud
-        * \note The results are only stored if setCacheMLSResults(true) was called or when using the upsampling method DISTINCT_CLOUD or VOXEL_GRID_DILATION.
+        * \note The results are only stored if setCacheMLSResults(true) was called (the default).
         * \note This vector is align with the input cloud indices, so use getCorrespondingIndices to get the correct results when using output cloud indices.
         */
       inline const std::vector<MLSResult>&
       getMLSResults () const { return (mls_results_); }
 
-      /** \brief Set the maximum number of threads to use
+      /** \brief Set the maximum number of threads to use, for the fitting as well as for all the upsampling methods.
+      * \note The output does not depend on the number of threads.
       * \param threads the maximum number of hardware threads to use (0 sets the value to 1)
       */
       inline void
@@ -580,13 +584,11 @@ namespace pcl
         */
       int desired_num_points_in_radius_;
 
-      /** \brief True if the mls results for the input cloud should be stored
-        * \note This is forced to true when using upsampling methods VOXEL_GRID_DILATION or DISTINCT_CLOUD.
-        */
+      /** \brief True if the mls results for the input cloud should be stored */
       bool cache_mls_results_;
 
       /** \brief Stores the MLS result for each point in the input cloud
-        * \note Used only in the case of VOXEL_GRID_DILATION or DISTINCT_CLOUD upsampling
+        * \note Only filled if cache_mls_results_ is set
         */
       std::vector<MLSResult> mls_results_;
 
@@ -607,10 +609,12 @@ namespace pcl
 
           MLSVoxelGrid (PointCloudInConstPtr& cloud,
                         IndicesPtr &indices,
-                        float voxel_size);
+                        float voxel_size,
+                        unsigned int nr_threads = 1);
 
+          /** \brief Add the 26 neighbors of every occupied voxel to the grid. */
           void
-          dilate ();
+          dilate (unsigned int nr_threads = 1);
 
           inline void
           getIndexIn1D (const Eigen::Vector3i &index, std::uint64_t &index_1d) const
@@ -645,7 +649,7 @@ namespace pcl
               point[i] = static_cast<Eigen::Vector3f::Scalar> (index_3d[i]) * voxel_size_ + bounding_min_[i];
           }
 
-          typedef std::map<std::uint64_t, Leaf> HashMap;
+          typedef std::unordered_map<std::uint64_t, Leaf> HashMap;
           HashMap voxel_grid_;
           Eigen::Vector4f bounding_min_, bounding_max_;
           std::uint64_t data_size_;
@@ -720,6 +724,40 @@ namespace pcl
       copyMissingFields (const PointInT &point_in,
                          PointOutT &point_out) const;
 
+      /** \brief Get the MLS fit of an input point for the DISTINCT_CLOUD and VOXEL_GRID_DILATION upsampling, either
+        * from mls_results_ or, if the results are not cached, by fitting it again.
+        * \param[in] index the index of the point in the input cloud
+        * \param[in] in_indices flags the input points that are part of the indices (only used without cache)
+        * \param[in,out] fit the last fit computed by the calling thread, reused if it was computed for \a index
+        * \param[in,out] fit_index the index of the point \a fit was computed for (-1 if none)
+        */
+      const MLSResult&
+      getUpsamplingFit (int index, const std::vector<bool> &in_indices, MLSResult &fit, int &fit_index) const;
+
+      /** \brief Project a sample of the DISTINCT_CLOUD and VOXEL_GRID_DILATION upsampling to the MLS surface of the
+        * closest input point, see getUpsamplingFit () for the remaining parameters.
+        * \param[in] sample the point to be projected
+        * \param[out] projected_points the projected point, if the closest input point has a valid fit
+        * \param[out] projected_points_normals the normal of the projected point
+        * \param[out] corresponding_input_indices the index of the closest input point
+        */
+      void
+      projectUpsamplingPoint (const PointInT &sample, const std::vector<bool> &in_indices, MLSResult &fit, int &fit_index,
+                              PointCloudOut &projected_points, NormalCloud &projected_points_normals,
+                              PointIndices &corresponding_input_indices) const;
+
+      /** \brief Append the points produced by the blocks of a parallel loop to the output, in block order.
+        * \param[in] projected_points the points of each block
+        * \param[in] projected_points_normals the normals of each block
+        * \param[in] corresponding_input_indices the input point indices of each block
+        * \param[in,out] output the output cloud
+        */
+      void
+      appendProjectedPoints (const typename PointCloudOut::CloudVectorType &projected_points,
+                             const typename NormalCloud::CloudVectorType &projected_points_normals,
+                             const std::vector<PointIndices> &corresponding_input_indices,
+                             PointCloudOut &output);
+
       /** \brief Abstract surface reconstruction method.
         * \param[out] output the result of the reconstruction
         */
@@ -733,13 +771,42 @@ namespace pcl
       performUpsampling (PointCloudOut &output);
 
     private:
-      /** \brief Random number generator algorithm. */
-      mutable std::mt19937 rng_;
+      /** \brief Counter-based random number generator (splitmix64), whose state is a single integer, so that it is
+        * cheap to create one for each point.
+        */
+      struct SplitMix64
+      {
+        using result_type = std::uint64_t;
+
+        /** \brief Start the stream of the given seed and point index. */
+        SplitMix64 (std::uint32_t seed, std::uint32_t index)
+          : state (mix ((static_cast<std::uint64_t> (seed) << 32) | index)) {}
+
+        static constexpr result_type
+        min () { return (0); }
+
+        static constexpr result_type
+        max () { return (std::numeric_limits<result_type>::max ()); }
+
+        result_type
+        operator() () { return (mix (state += 0x9E3779B97F4A7C15ull)); }
+
+        static std::uint64_t
+        mix (std::uint64_t z)
+        {
+          z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+          z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+          return (z ^ (z >> 31));
+        }
+
+        std::uint64_t state;
+      };
 
-      /** \brief Random number generator using an uniform distribution of floats
+      /** \brief Seed of the random number generators, each point gets its own generator seeded from it and its
+        * index so that the samples do not depend on the thread that processes the point
         * \note Used only in the case of RANDOM_UNIFORM_DENSITY upsampling
         */
-      std::unique_ptr<std::uniform_real_distribution<>> rng_uniform_distribution_;
+      std::uint32_t rng_seed_;
 
       /** \brief Abstract class get name method. */
       std::string
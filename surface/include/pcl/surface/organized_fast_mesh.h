@@ -42,8 +42,12 @@
 
 #include <pcl/common/angles.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/geometry/quad_mesh.h>
+#include <pcl/geometry/triangle_mesh.h>
 #include <pcl/surface/reconstruction.h>
 
+#include <array>
+
 
 namespace pcl
 {
@@ -76,6 +80,13 @@ namespace pcl
 
       using Polygons = std::vector<pcl::Vertices>;
 
+      /** \brief Mesh updated by reconstructIncremental () for the triangle meshes. Its vertices are the points of
+        * the cloud (the mesh is not manifold, as the polygons of reconstruct () do not always form a manifold). */
+      using TriangleMesh = pcl::geometry::TriangleMesh<pcl::geometry::DefaultMeshTraits<PointInT> >;
+
+      /** \brief Mesh updated by reconstructIncremental () for QUAD_MESH. */
+      using QuadMesh = pcl::geometry::QuadMesh<pcl::geometry::DefaultMeshTraits<PointInT> >;
+
       enum TriangulationType
       {
         TRIANGLE_RIGHT_CUT,     // _always_ "cuts" a quad from top left to bottom right
@@ -100,6 +111,11 @@ namespace pcl
       , distance_tolerance_ (-1.0f)
       , distance_dependent_ (false)
       , use_depth_as_distance_(false)
+      , depth_change_threshold_ (0.0f)
+      , nr_cell_faces_ (0)
+      , incremental_type_ (QUAD_MESH)
+      , incremental_pixel_size_rows_ (0)
+      , incremental_pixel_size_columns_ (0)
       {
         check_tree_ = false;
       };
@@ -124,12 +140,14 @@ namespace pcl
           max_edge_length_set_ = true;
         else
           max_edge_length_set_ = false;
+        resetIncremental ();
       };
 
       inline void
       unsetMaxEdgeLength ()
       {
         max_edge_length_set_  = false;
+        resetIncremental ();
       }
 
       /** \brief Set the edge length (in pixels) used for constructing the fixed mesh.
@@ -151,6 +169,7 @@ namespace pcl
       setTrianglePixelSizeRows (int triangle_size)
       {
         triangle_pixel_size_rows_ = std::max (1, (triangle_size - 1));
+        resetIncremental ();
       }
 
       /** \brief Set the edge length (in pixels) used for iterating over columns when constructing the fixed mesh.
@@ -161,6 +180,7 @@ namespace pcl
       setTrianglePixelSizeColumns (int triangle_size)
       {
         triangle_pixel_size_columns_ = std::max (1, (triangle_size - 1));
+        resetIncremental ();
       }
 
       /** \brief Set the triangulation type (see \a TriangulationType)
@@ -171,6 +191,7 @@ namespace pcl
       setTriangulationType (TriangulationType type)
       {
         triangulation_type_ = type;
+        resetIncremental ();
       }
 
       /** \brief Set the viewpoint from where the input point cloud has been acquired.
@@ -179,6 +200,7 @@ namespace pcl
       inline void setViewpoint (const Eigen::Vector3f& viewpoint)
       {
         viewpoint_ = viewpoint;
+        resetIncremental ();
       }
 
       /** \brief Get the viewpoint from where the input point cloud has been acquired. */
@@ -194,6 +216,7 @@ namespace pcl
       storeShadowedFaces (bool enable)
       {
         store_shadowed_faces_ = enable;
+        resetIncremental ();
       }
 
       /** \brief Set the angle tolerance used for checking whether or not an edge is occluded.
@@ -208,12 +231,14 @@ namespace pcl
           cos_angle_tolerance_ = std::abs (std::cos (angle_tolerance));
         else
           cos_angle_tolerance_ = -1.0f;
+        resetIncremental ();
       }
 
 
       inline void setDistanceTolerance(float distance_tolerance, bool depth_dependent = false)
       {
         distance_tolerance_ = distance_tolerance;
+        resetIncremental ();
         if (distance_tolerance_ < 0)
           return;
 
@@ -227,6 +252,53 @@ namespace pcl
       inline void useDepthAsDistance(bool enable)
       {
         use_depth_as_distance_ = enable;
+        resetIncremental ();
+      }
+
+      /** \brief Set the change of depth (z-coordinate) above which reconstructIncremental () updates a point.
+        * \param[in] threshold the depth change threshold (Default: 0 = every change is applied)
+        */
+      inline void
+      setDepthChangeThreshold (float threshold)
+      {
+        depth_change_threshold_ = threshold;
+      }
+
+      /** \brief Get the change of depth above which reconstructIncremental () updates a point. */
+      inline float
+      getDepthChangeThreshold () const
+      {
+        return (depth_change_threshold_);
+      }
+
+      /** \brief Update a mesh of a stream of organized clouds incrementally.
+        *
+        * The first call builds the whole mesh, with one vertex per point of the cloud (the vertex indices are the
+        * point indices). The following calls, for the next clouds of the stream, only update the points whose depth
+        * changed by more than the depth change threshold (or which became valid or invalid), and re-triangulate the
+        * cells with such a corner. The other points keep their previous position in the mesh, and the faces are
+        * always the polygons reconstruct () computes for the points of the mesh.
+        *
+        * The whole mesh is built again when the size of the cloud changes, after any of the setters of the
+        * triangulation parameters (edge lengths, triangulation type, viewpoint and shadow test), after
+        * resetIncremental (), and from time to time to remove the faces deleted by the updates. The mesh must not be
+        * modified between the calls.
+        * \param[in,out] mesh the mesh to update, for all the triangulation types but QUAD_MESH
+        */
+      void
+      reconstructIncremental (TriangleMesh &mesh);
+
+      /** \brief Update a quad mesh of a stream of organized clouds incrementally, see above.
+        * \param[in,out] mesh the mesh to update, for QUAD_MESH
+        */
+      void
+      reconstructIncremental (QuadMesh &mesh);
+
+      /** \brief Make the next call to reconstructIncremental () build the whole mesh again. */
+      inline void
+      resetIncremental ()
+      {
+        previous_depth_.clear ();
       }
 
     protected:
@@ -270,6 +342,24 @@ namespace pcl
           This flag may be set using useDepthAsDistance(true) for (RGB-)Depth cameras to skip computations and gain additional speed up. */
       bool use_depth_as_distance_;
 
+      /** \brief depth change above which reconstructIncremental () updates a point. */
+      float depth_change_threshold_;
+
+      /** \brief depths of the points of the incremental mesh (empty if there is none). */
+      std::vector<float> previous_depth_;
+
+      /** \brief faces of each cell of the incremental mesh (two per cell, invalid if there is none). */
+      std::vector<pcl::geometry::FaceIndex> cell_faces_;
+
+      /** \brief number of valid faces in \a cell_faces_. */
+      std::size_t nr_cell_faces_;
+
+      /** \brief triangulation type of the incremental mesh. */
+      TriangulationType incremental_type_;
+
+      /** \brief pixel sizes of the incremental mesh. */
+      int incremental_pixel_size_rows_, incremental_pixel_size_columns_;
+
 
       /** \brief Perform the actual polygonal reconstruction.
         * \param[out] polygons the resultant polygons
@@ -293,6 +383,25 @@ namespace pcl
       void
       performReconstruction (pcl::PolygonMesh &output) override;
 
+      /** \brief Build or update an incremental mesh, see reconstructIncremental ().
+        * \param[in,out] mesh the mesh to update
+        */
+      template <typename MeshT> void
+      updateMesh (MeshT &mesh);
+
+      /** \brief Compute the polygons of one cell, as the make*Mesh () methods do.
+        * \param[in] cloud the points
+        * \param[in] i index of the top left corner of the cell
+        * \param[in] index_right index of the top right corner of the cell
+        * \param[in] index_down index of the bottom left corner of the cell
+        * \param[in] index_down_right index of the bottom right corner of the cell
+        * \param[out] polygons the vertices of the polygons (the first 3 for triangles)
+        * \return the number of polygons (at most 2)
+        */
+      int
+      makeCellPolygons (const pcl::PointCloud<PointInT> &cloud, int i, int index_right, int index_down,
+                        int index_down_right, std::array<std::array<int, 4>, 2> &polygons);
+
       /** \brief Add a new triangle to the current polygon mesh
         * \param[in] a index of the first vertex
         * \param[in] b index of the second vertex
@@ -216,6 +216,32 @@ namespace pcl
       inline bool
       getManifold () { return manifold_; }
 
+      /** \brief Set the number of threads used by the Laplacian setup, the solver and the iso-surface extraction.
+        * \note The octree construction and the point splatting remain single-threaded.
+        * \param[in] threads the number of threads (0 uses pcl::parallel::getThreadBudget ())
+        */
+      inline void
+      setThreads (int threads) { threads_ = threads; }
+
+      /** \brief Get the number of threads (0 means pcl::parallel::getThreadBudget ()) */
+      inline int
+      getThreads () { return threads_; }
+
+      /** \brief Bound the memory footprint of deep reconstructions (depth >= 11).
+        * \note When enabled, at most 4 full-size per-thread accumulation buffers are allocated for the
+        * Laplacian constraints, the down-sampling and the corner/edge counting passes, whatever the number of
+        * threads. The solver and iso-surface extraction are also forced to work in blocks, with a solver and iso
+        * divide of at most 8 (or the minimum depth if larger); this has no effect at the default divide of 8. This
+        * trades some speed for a much lower peak memory usage when many threads are used.
+        * \param[in] bounded_memory the given flag
+        */
+      inline void
+      setBoundedMemory (bool bounded_memory) { bounded_memory_ = bounded_memory; }
+
+      /** \brief Get the bounded memory flag */
+      inline bool
+      getBoundedMemory () { return bounded_memory_; }
+
     protected:
       /** \brief Class get name method. */
       std::string
@@ -243,6 +269,8 @@ namespace pcl
       bool show_residual_;
       int min_iterations_;
       float solver_accuracy_;
+      int threads_;
+      bool bounded_memory_;
 
       template<int Degree> void
       execute (poisson::CoredVectorMeshData &mesh,
@@ -0,0 +1,342 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/PolygonMesh.h>
+
+#include <Eigen/Geometry>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Fusion of organized depth frames into a truncated signed distance function (TSDF) volume on the CPU.
+    *
+    * This is the CPU counterpart of pcl::gpu::TsdfVolume. Instead of a dense grid of fixed extent, the volume is
+    * sparse: voxels are allocated in blocks of BLOCK_SIZE^3 around the observed surfaces only, and the blocks are
+    * looked up by their integer coordinates in a hash map. The extent of the scene thus needs not be known in advance,
+    * and the memory grows with the observed surface rather than with the scene extent.
+    *
+    * Frames are organized clouds in the camera frame (e.g. from an OpenNI grabber), fused with integrate () given the
+    * pose of the camera. raycast () renders the fused surface as an organized cloud seen from a given pose, which
+    * can be meshed with pcl::OrganizedFastMesh or registered against the next frame, and extractMesh () extracts a
+    * mesh of the whole volume with marching cubes.
+    *
+    * The voxels hold the signed distance to the surface along the viewing rays, divided by the truncation distance
+    * and clamped to [-1, 1]: it is positive in front of the surface and negative behind it. All three operations
+    * run in parallel on pcl::parallel, and give the same result for any number of threads.
+    *
+    * The volume extends over 2^20 voxels along each axis, centered on the origin of the volume frame (10 km with the
+    * default voxel size); the parts of the frames outside of it are ignored.
+    *
+    * \ingroup surface
+    */
+  template <typename PointT>
+  class TSDFVolume
+  {
+    public:
+      using Ptr = shared_ptr<TSDFVolume<PointT> >;
+      using ConstPtr = shared_ptr<const TSDFVolume<PointT> >;
+
+      using PointCloud = pcl::PointCloud<PointT>;
+
+      /** \brief The number of voxels along each side of a block. */
+      static constexpr int BLOCK_SIZE = 8;
+
+      /** \brief Constructor.
+        * \param[in] voxel_size the side length of a voxel, in meters
+        * \param[in] trunc_dist the truncation distance of the signed distances, in meters
+        */
+      TSDFVolume (float voxel_size = 0.01f, float trunc_dist = 0.03f);
+
+      /** \brief Set the side length of a voxel. This clears the volume.
+        * \param[in] voxel_size the side length of a voxel, in meters
+        */
+      void
+      setVoxelSize (float voxel_size);
+
+      /** \brief Get the side length of a voxel. */
+      inline float
+      getVoxelSize () const
+      {
+        return (voxel_size_);
+      }
+
+      /** \brief Set the truncation distance of the signed distances. It should be a few voxels at least.
+        * \param[in] distance the truncation distance, in meters
+        */
+      inline void
+      setTsdfTruncDist (float distance)
+      {
+        trunc_dist_ = distance;
+      }
+
+      /** \brief Get the truncation distance of the signed distances. */
+      inline float
+      getTsdfTruncDist () const
+      {
+        return (trunc_dist_);
+      }
+
+      /** \brief Set the maximum weight of a voxel. Once it is reached, the voxel turns into a running average
+        * of the last frames, so that the volume can follow small changes of the scene.
+        * \param[in] max_weight the maximum weight, i.e. the number of frames averaged (default: 128)
+        */
+      inline void
+      setMaxWeight (float max_weight)
+      {
+        max_weight_ = max_weight;
+      }
+
+      /** \brief Get the maximum weight of a voxel. */
+      inline float
+      getMaxWeight () const
+      {
+        return (max_weight_);
+      }
+
+      /** \brief Set the intrinsic parameters of the depth camera.
+        * \param[in] fx the focal length along x, in pixels
+        * \param[in] fy the focal length along y, in pixels
+        * \param[in] cx the principal point along x, in pixels (negative for the center of the image)
+        * \param[in] cy the principal point along y, in pixels (negative for the center of the image)
+        */
+      inline void
+      setCameraIntrinsics (float fx, float fy, float cx = -1.0f, float cy = -1.0f)
+      {
+        fx_ = fx;
+        fy_ = fy;
+        cx_ = cx;
+        cy_ = cy;
+      }
+
+      /** \brief Get the intrinsic parameters of the depth camera, see setCameraIntrinsics (). */
+      inline void
+      getCameraIntrinsics (float &fx, float &fy, float &cx, float &cy) const
+      {
+        fx = fx_;
+        fy = fy_;
+        cx = cx_;
+        cy = cy_;
+      }
+
+      /** \brief Set the range of depths used by integrate () and searched by raycast ().
+        * \param[in] min_depth the minimum depth, in meters (default: 0.3)
+        * \param[in] max_depth the maximum depth, in meters (default: 5)
+        */
+      inline void
+      setDepthRange (float min_depth, float max_depth)
+      {
+        min_depth_ = min_depth;
+        max_depth_ = max_depth;
+      }
+
+      /** \brief Get the range of depths used by integrate () and searched by raycast (). */
+      inline void
+      getDepthRange (float &min_depth, float &max_depth) const
+      {
+        min_depth = min_depth_;
+        max_depth = max_depth_;
+      }
+
+      /** \brief Set the number of threads to use.
+        * \param[in] nr_threads the number of threads to use (0 sets the value to the thread budget, see
+        * pcl::parallel::setThreadBudget ())
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
+      /** \brief Get the number of threads to use. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
+      /** \brief Remove all the voxels of the volume. */
+      void
+      reset ();
+
+      /** \brief Get the number of allocated blocks of BLOCK_SIZE^3 voxels. */
+      inline std::size_t
+      getNumberOfBlocks () const
+      {
+        return (blocks_.size ());
+      }
+
+      /** \brief Fuse a depth frame into the volume.
+        * \param[in] cloud the organized cloud of the frame, in the camera frame (z along the optical axis).
+        * The depth of each pixel is taken from its z coordinate, and invalid pixels are NaN
+        * \param[in] camera_pose the pose of the camera in the volume frame
+        * \return false if the cloud is not organized
+        */
+      bool
+      integrate (const PointCloud &cloud, const Eigen::Affine3f &camera_pose = Eigen::Affine3f::Identity ());
+
+      /** \brief Render the surface of the volume from a given pose, by casting a ray through each pixel.
+        * \param[in] camera_pose the pose of the camera in the volume frame
+        * \param[in] width the width of the image, in pixels
+        * \param[in] height the height of the image, in pixels
+        * \param[out] cloud the organized cloud of the surface in the camera frame, with NaN for the pixels whose
+        * ray hit no surface
+        */
+      void
+      raycast (const Eigen::Affine3f &camera_pose, unsigned int width, unsigned int height, PointCloud &cloud) const;
+
+      /** \brief Render the surface of the volume and its normals from a given pose, see raycast ().
+        * \param[in] camera_pose the pose of the camera in the volume frame
+        * \param[in] width the width of the image, in pixels
+        * \param[in] height the height of the image, in pixels
+        * \param[out] cloud the organized cloud of the surface in the camera frame
+        * \param[out] normals the organized cloud of the normals of the surface in the camera frame, computed from
+        * the gradient of the signed distances and oriented towards the camera
+        */
+      void
+      raycast (const Eigen::Affine3f &camera_pose, unsigned int width, unsigned int height, PointCloud &cloud,
+               pcl::PointCloud<pcl::Normal> &normals) const;
+
+      /** \brief Extract the surface of the whole volume as a triangle mesh with marching cubes. The triangles share
+        * their vertices, and the vertices are in the volume frame.
+        * \param[out] mesh the resultant mesh
+        */
+      void
+      extractMesh (pcl::PolygonMesh &mesh) const;
+
+    protected:
+      /** \brief A voxel: the truncated signed distance, divided by the truncation distance, and its weight. */
+      struct Voxel
+      {
+        float tsdf;
+        float weight;
+      };
+
+      using Block = std::array<Voxel, BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE>;
+
+      /** \brief The last block found by findVoxel (), as rays and cells mostly look up the same block in a row. */
+      struct BlockCache
+      {
+        std::uint64_t key = ~std::uint64_t (0);
+        const Block *block = nullptr;
+      };
+
+      /** \brief Get the hash key of the block with the given integer coordinates. */
+      static std::uint64_t
+      getBlockKey (const Eigen::Vector3i &block);
+
+      /** \brief Get the integer coordinates of a block from its hash key. */
+      static Eigen::Vector3i
+      getBlockCoordinates (std::uint64_t key);
+
+      /** \brief Get the integer coordinates of the block holding a voxel. */
+      static Eigen::Vector3i
+      getBlockOfVoxel (const Eigen::Vector3i &voxel);
+
+      /** \brief Get the index of a voxel in its block. */
+      static int
+      getIndexInBlock (const Eigen::Vector3i &voxel, const Eigen::Vector3i &block);
+
+      /** \brief Find a voxel, given its integer coordinates.
+        * \return a pointer to the voxel, or a null pointer if its block is not allocated
+        */
+      const Voxel*
+      findVoxel (const Eigen::Vector3i &voxel, BlockCache &cache) const;
+
+      /** \brief Interpolate the signed distance at a point of the volume, from the 8 nearest voxels.
+        * \param[in] point the point, in the volume frame
+        * \param[out] tsdf the interpolated value
+        * \param[in,out] cache the last block looked up
+        * \return false if one of the voxels is not allocated or has not been observed yet
+        */
+      bool
+      interpolate (const Eigen::Vector3f &point, float &tsdf, BlockCache &cache) const;
+
+      /** \brief Cast the rays of all the pixels, see raycast (). */
+      void
+      castRays (const Eigen::Affine3f &camera_pose, unsigned int width, unsigned int height, PointCloud &cloud,
+                pcl::PointCloud<pcl::Normal> *normals) const;
+
+      /** \brief Get the principal point to use for images of the given size. */
+      inline void
+      getPrincipalPoint (unsigned int width, unsigned int height, float &cx, float &cy) const
+      {
+        cx = cx_ < 0.0f ? static_cast<float> (width - 1) / 2.0f : cx_;
+        cy = cy_ < 0.0f ? static_cast<float> (height - 1) / 2.0f : cy_;
+      }
+
+      /** \brief The side length of a voxel. */
+      float voxel_size_;
+
+      /** \brief The truncation distance of the signed distances. */
+      float trunc_dist_;
+
+      /** \brief The maximum weight of a voxel. */
+      float max_weight_;
+
+      /** \brief The intrinsic parameters of the depth camera. */
+      float fx_, fy_, cx_, cy_;
+
+      /** \brief The range of depths used by integrate () and raycast (). */
+      float min_depth_, max_depth_;
+
+      /** \brief The number of threads to use. */
+      unsigned int threads_;
+
+      /** \brief The allocated blocks, in the order they were allocated. */
+      std::vector<Block> blocks_;
+
+      /** \brief The hash keys of the allocated blocks, in the same order. */
+      std::vector<std::uint64_t> block_keys_;
+
+      /** \brief The index in blocks_ of each allocated block, by hash key. */
+      std::unordered_map<std::uint64_t, std::size_t> block_indices_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/surface/impl/tsdf_volume.hpp>
+#endif
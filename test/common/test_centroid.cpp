@@ -48,9 +48,11 @@
 #include <pcl/pcl_tests.h>
 
 #include <pcl/common/centroid.h>
+#include <pcl/common/local_surface_statistics.h>
 
 using namespace pcl;
 using pcl::test::EXPECT_EQ_VECTORS;
+using pcl::test::EXPECT_NEAR_VECTORS;
 
 pcl::PCLPointCloud2 cloud_blob;
 
@@ -1098,6 +1100,84 @@ TEST (PCL, demeanPointCloud)
   EXPECT_NEAR (mat_demean (2, cloud_demean.size () - 1), -0.071702, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, computeLocalSurfaceStatistics)
+{
+  PointCloud<PointXYZ> cloud;
+  fromPCLPointCloud2 (cloud_blob, cloud);
+  Indices indices (cloud.size ());
+  for (std::size_t i = 0; i < indices.size (); ++i)
+    indices[i] = static_cast<int> (i);
+
+  // Same centroid and covariance matrix as computeMeanAndCovarianceMatrix
+  Eigen::Matrix3d covariance_matrix;
+  Eigen::Vector4d centroid;
+  computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix, centroid);
+  LocalSurfaceStatistics statistics;
+  EXPECT_EQ (computeLocalSurfaceStatistics (cloud, indices, statistics), cloud.size ());
+  EXPECT_EQ (statistics.num_points, cloud.size ());
+  EXPECT_NEAR_VECTORS (statistics.centroid, centroid.head<3> (), 1e-10);
+  for (int i = 0; i < 9; ++i)
+    EXPECT_NEAR (statistics.covariance (i), covariance_matrix (i), 1e-10);
+
+  // Eigenvalues in increasing order, and orthonormal eigenvectors which diagonalize the covariance matrix
+  EXPECT_LE (statistics.eigenvalues[0], statistics.eigenvalues[1]);
+  EXPECT_LE (statistics.eigenvalues[1], statistics.eigenvalues[2]);
+  const Eigen::Matrix3d reconstructed = statistics.eigenvectors * statistics.eigenvalues.asDiagonal () *
+                                        statistics.eigenvectors.transpose ();
+  for (int i = 0; i < 9; ++i)
+    EXPECT_NEAR (reconstructed (i), statistics.covariance (i), 1e-8);
+  EXPECT_TRUE ((statistics.eigenvectors.transpose () * statistics.eigenvectors).isIdentity (1e-8));
+
+  // Scatter matrix around a given point
+  Eigen::Vector3d sum;
+  Eigen::Matrix3d scatter_matrix;
+  const Eigen::Vector3d origin = cloud[0].getVector3fMap ().cast<double> ();
+  EXPECT_EQ (computeScatterMatrix (cloud, indices, origin, sum, scatter_matrix), cloud.size ());
+  const Eigen::Vector3d mean_offset = statistics.centroid - origin;
+  EXPECT_NEAR_VECTORS (sum, cloud.size () * mean_offset, 1e-8);
+  const Eigen::Matrix3d expected_scatter = cloud.size () * (statistics.covariance + mean_offset * mean_offset.transpose ());
+  for (int i = 0; i < 9; ++i)
+    EXPECT_NEAR (scatter_matrix (i), expected_scatter (i), 1e-8);
+
+  // Far from the origin, where the raw moments lose the covariance in single precision
+  PointCloud<PointXYZ> shifted_cloud = cloud;
+  for (auto &point : shifted_cloud)
+    point.x += 1000.0f;
+  LocalSurfaceStatistics shifted_statistics;
+  computeLocalSurfaceStatistics (shifted_cloud, indices, shifted_statistics);
+  for (int i = 0; i < 9; ++i)
+    EXPECT_NEAR (shifted_statistics.covariance (i), statistics.covariance (i), 1e-6);
+
+  // Non-finite points are skipped, and a neighborhood without finite point gives NaN
+  cloud.is_dense = false;
+  cloud[0].x = std::numeric_limits<float>::quiet_NaN ();
+  EXPECT_EQ (computeLocalSurfaceStatistics (cloud, indices, statistics), cloud.size () - 1);
+  EXPECT_EQ (computeLocalSurfaceStatistics (cloud, Indices (1, 0), statistics), 0);
+  EXPECT_TRUE (std::isnan (statistics.centroid[0]));
+
+  // Batch of neighborhoods, in compressed sparse row format
+  std::vector<std::size_t> offsets;
+  Indices neighbor_indices;
+  offsets.push_back (0);
+  for (std::size_t i = 0; i + 10 <= cloud.size (); i += 7)
+  {
+    neighbor_indices.insert (neighbor_indices.end (), indices.begin () + i, indices.begin () + i + 10);
+    offsets.push_back (neighbor_indices.size ());
+  }
+  LocalSurfaceStatisticsVector batch_statistics;
+  computeLocalSurfaceStatistics (cloud, offsets, neighbor_indices, batch_statistics, true, 2);
+  ASSERT_EQ (batch_statistics.size (), offsets.size () - 1);
+  for (std::size_t i = 0; i < batch_statistics.size (); ++i)
+  {
+    computeLocalSurfaceStatistics (cloud, Indices (neighbor_indices.begin () + offsets[i],
+                                                   neighbor_indices.begin () + offsets[i + 1]), statistics);
+    EXPECT_EQ (batch_statistics[i].num_points, statistics.num_points);
+    EXPECT_EQ_VECTORS (batch_statistics[i].centroid, statistics.centroid);
+    EXPECT_EQ_VECTORS (batch_statistics[i].eigenvalues, statistics.eigenvalues);
+  }
+}
+
 int
 main (int argc, char** argv)
 {
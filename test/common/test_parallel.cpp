@@ -0,0 +1,223 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/common/parallel.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ParallelFor, VisitsEachIndexOnce)
+{
+  for (const unsigned int nr_threads : {1u, 2u, 4u})
+  {
+    std::vector<int> visits (1000, 0);
+    pcl::parallel::parallel_for (0, static_cast<int> (visits.size ()), [&visits] (int first, int last)
+    {
+      for (int i = first; i < last; ++i)
+        ++visits[i];
+    }, nr_threads, 7);
+    for (const int v : visits)
+      ASSERT_EQ (v, 1);
+  }
+
+  // Empty range
+  bool called = false;
+  pcl::parallel::parallel_for (5, 5, [&called] (int, int) { called = true; });
+  EXPECT_FALSE (called);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ParallelReduce, Sum)
+{
+  std::vector<double> values (10000);
+  for (std::size_t i = 0; i < values.size (); ++i)
+    values[i] = 1.0 / static_cast<double> (i + 1);
+
+  const auto sum = [&values] (std::size_t nr_threads)
+  {
+    return (pcl::parallel::parallel_reduce (std::size_t (0), values.size (), 0.0, [&values] (std::size_t first, std::size_t last)
+    {
+      return (std::accumulate (values.begin () + first, values.begin () + last, 0.0));
+    }, std::plus<double> (), static_cast<unsigned int> (nr_threads), std::size_t (64)));
+  };
+
+  const double reference = sum (1);
+  EXPECT_NEAR (reference, std::accumulate (values.begin (), values.end (), 0.0), 1e-9);
+  // The partial results are combined in a fixed order
+  EXPECT_EQ (sum (2), reference);
+  EXPECT_EQ (sum (4), reference);
+
+  EXPECT_EQ (pcl::parallel::parallel_reduce (0, 0, 42, [] (int, int) { return (0); }, std::plus<int> ()), 42);
+
+  // bool results
+  const bool all_even = pcl::parallel::parallel_reduce (0, 100, true, [] (int first, int last)
+  {
+    bool even = true;
+    for (int i = first; i < last; ++i)
+      even = even && (i % 2 == 0);
+    return (even);
+  }, [] (bool a, bool b) { return (a && b); }, 4, 10);
+  EXPECT_FALSE (all_even);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ParallelFor, Exceptions)
+{
+  std::atomic<int> chunks (0);
+  EXPECT_THROW (pcl::parallel::parallel_for (0, 1000, [&chunks] (int first, int)
+  {
+    ++chunks;
+    if (first == 500)
+      throw std::runtime_error ("chunk failed");
+  }, 4, 10), std::runtime_error);
+  // The pool is still usable afterwards
+  std::atomic<int> count (0);
+  pcl::parallel::parallel_for (0, 100, [&count] (int first, int last) { count += last - first; }, 4, 1);
+  EXPECT_EQ (count, 100);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ParallelFor, Nested)
+{
+  std::vector<std::atomic<int> > visits (64 * 64);
+  for (auto &v : visits)
+    v = 0;
+  pcl::parallel::parallel_for (0, 64, [&visits] (int first, int last)
+  {
+    for (int i = first; i < last; ++i)
+      pcl::parallel::parallel_for (0, 64, [&visits, i] (int inner_first, int inner_last)
+      {
+        for (int j = inner_first; j < inner_last; ++j)
+          ++visits[i * 64 + j];
+      }, 0, 4);
+  }, 0, 1);
+  for (const auto &v : visits)
+    ASSERT_EQ (v, 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ParallelFor, ThreadBudget)
+{
+  pcl::parallel::setThreadBudget (3);
+  EXPECT_EQ (pcl::parallel::getThreadBudget (), 3);
+  EXPECT_EQ (pcl::parallel::detail::getNumberOfThreads (0), 3);
+  EXPECT_EQ (pcl::parallel::detail::getNumberOfThreads (2), 2);
+  EXPECT_EQ (pcl::parallel::detail::getNumberOfThreads (8), 3);
+
+  std::atomic<int> count (0);
+  pcl::parallel::parallel_for (0, 1000, [&count] (int first, int last) { count += last - first; });
+  EXPECT_EQ (count, 1000);
+
+  pcl::parallel::setThreadBudget (1);
+  count = 0;
+  pcl::parallel::parallel_for (0, 1000, [&count] (int first, int last) { count += last - first; });
+  EXPECT_EQ (count, 1000);
+
+  pcl::parallel::setThreadBudget ();
+  EXPECT_GE (pcl::parallel::getThreadBudget (), 1);
+  pcl::parallel::setThreadBudget (4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ParallelFor, ThreadBudgetChangedWhileRunning)
+{
+  // Changing the budget from within a loop neither waits for the running loops nor stops their workers
+  std::atomic<int> count (0);
+  pcl::parallel::parallel_for (0, 256, [&count] (int first, int last)
+  {
+    for (int i = first; i < last; ++i)
+    {
+      pcl::parallel::setThreadBudget (2 + i % 5);
+      pcl::parallel::parallel_for (0, 16, [&count] (int inner_first, int inner_last)
+      {
+        count += inner_last - inner_first;
+      }, 0, 1);
+    }
+  }, 0, 1);
+  EXPECT_EQ (count, 256 * 16);
+  pcl::parallel::setThreadBudget (4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ParallelFor, ThreadBudgetSharedByConcurrentLoops)
+{
+  // The pool already has 3 workers from the budget of 4, but after lowering the budget the loops running
+  // concurrently share a single helper
+  pcl::parallel::setThreadBudget (4);
+  pcl::parallel::parallel_for (0, 64, [] (int, int) {}, 0, 1);
+  pcl::parallel::setThreadBudget (2);
+
+  const unsigned int nr_callers = 3;
+  std::atomic<int> active (0), max_active (0), count (0);
+  std::vector<std::thread> callers;
+  for (unsigned int i = 0; i < nr_callers; ++i)
+    callers.emplace_back ([&]
+    {
+      pcl::parallel::parallel_for (0, 64, [&] (int first, int last)
+      {
+        const int now = ++active;
+        int previous = max_active;
+        while (previous < now && !max_active.compare_exchange_weak (previous, now)) {}
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        count += last - first;
+        --active;
+      }, 0, 1);
+    });
+  for (auto &caller : callers)
+    caller.join ();
+  EXPECT_EQ (count, 64 * static_cast<int> (nr_callers));
+  EXPECT_LE (max_active, static_cast<int> (nr_callers) + 1);
+  pcl::parallel::setThreadBudget (4);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  // Use the pool even on machines with fewer cores
+  pcl::parallel::setThreadBudget (4);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -40,8 +40,17 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/boundary.h>
+#include <pcl/features/fpfh.h>
+#include <pcl/features/neighborhood_cache.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/features/principal_curvatures.h>
+#include <pcl/features/rsd.h>
+#include <pcl/features/spin_image.h>
+#include <pcl/exceptions.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/common/centroid.h>
+#include <pcl/common/parallel.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -152,6 +161,195 @@ TEST (PCL, BaseFeature)
   EXPECT_NEAR (curvature, 0.0693136, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NeighborhoodCache)
+{
+  PointCloud<PointXYZ>::ConstPtr cloud_ptr = cloud.makeShared ();
+
+  NeighborhoodCache<PointXYZ>::Ptr neighborhoods (new NeighborhoodCache<PointXYZ>);
+  neighborhoods->setInputCloud (cloud_ptr);
+  neighborhoods->setRadiusSearch (0.03);
+  // Neither or both search parameters set
+  neighborhoods->setKSearch (10);
+  EXPECT_FALSE (neighborhoods->compute ());
+  neighborhoods->setKSearch (0);
+  ASSERT_TRUE (neighborhoods->compute ());
+  ASSERT_EQ (neighborhoods->getOffsets ().size (), cloud.points.size () + 1);
+  EXPECT_EQ (neighborhoods->getOffsets ().back (), neighborhoods->getNeighborIndices ().size ());
+
+  EXPECT_TRUE (neighborhoods->isCompatible (cloud_ptr, cloud_ptr, 0.03, 0));
+  EXPECT_TRUE (neighborhoods->isCompatible (cloud_ptr, cloud_ptr, 0.02, 0));
+  EXPECT_FALSE (neighborhoods->isCompatible (cloud_ptr, cloud_ptr, 0.04, 0));
+  EXPECT_FALSE (neighborhoods->isCompatible (cloud_ptr, cloud_ptr, 0, 10));
+  EXPECT_FALSE (neighborhoods->isCompatible (cloud.makeShared (), cloud_ptr, 0.03, 0));
+
+  // The features estimated with the cached neighborhoods, at the same and at a smaller radius, are the same
+  for (const double radius : {0.03, 0.02})
+  {
+    NormalEstimation<PointXYZ, Normal> ne;
+    ne.setInputCloud (cloud_ptr);
+    ne.setRadiusSearch (radius);
+    PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+    ne.compute (*normals);
+    ne.setPrecomputedNeighborhoods (neighborhoods);
+    PointCloud<Normal> cached_normals;
+    ne.compute (cached_normals);
+    ASSERT_EQ (cached_normals.points.size (), normals->points.size ());
+    for (std::size_t i = 0; i < normals->points.size (); ++i)
+    {
+      EXPECT_NEAR (cached_normals.points[i].normal_x, normals->points[i].normal_x, 1e-4);
+      EXPECT_NEAR (cached_normals.points[i].normal_y, normals->points[i].normal_y, 1e-4);
+      EXPECT_NEAR (cached_normals.points[i].normal_z, normals->points[i].normal_z, 1e-4);
+      EXPECT_NEAR (cached_normals.points[i].curvature, normals->points[i].curvature, 1e-4);
+    }
+
+    FPFHEstimation<PointXYZ, Normal, FPFHSignature33> fpfh;
+    fpfh.setInputCloud (cloud_ptr);
+    fpfh.setInputNormals (normals);
+    fpfh.setRadiusSearch (radius);
+    PointCloud<FPFHSignature33> signatures, cached_signatures;
+    fpfh.compute (signatures);
+    fpfh.setPrecomputedNeighborhoods (neighborhoods);
+    fpfh.compute (cached_signatures);
+    ASSERT_EQ (cached_signatures.points.size (), signatures.points.size ());
+    for (std::size_t i = 0; i < signatures.points.size (); ++i)
+      for (int j = 0; j < 33; ++j)
+        EXPECT_NEAR (cached_signatures.points[i].histogram[j], signatures.points[i].histogram[j], 1e-3);
+  }
+
+  // The neighborhoods of fewer nearest neighbors are a prefix of the cached ones
+  neighborhoods->setRadiusSearch (0);
+  neighborhoods->setKSearch (10);
+  neighborhoods->setIndices (IndicesPtr (new std::vector<int> (indices.begin (), indices.begin () + indices.size () / 2)));
+  ASSERT_TRUE (neighborhoods->compute ());
+  std::vector<int> k_indices, cached_indices;
+  std::vector<float> k_sqr_distances, cached_sqr_distances;
+  for (std::size_t i = 0; i < indices.size (); ++i)
+  {
+    const int nr_neighbors = neighborhoods->getNeighbors (indices[i], 8, cached_indices, cached_sqr_distances);
+    if (i >= indices.size () / 2)
+    {
+      // Not cached
+      EXPECT_EQ (nr_neighbors, -1);
+      continue;
+    }
+    tree->nearestKSearch (cloud, indices[i], 8, k_indices, k_sqr_distances);
+    ASSERT_EQ (nr_neighbors, 8);
+    EXPECT_EQ (cached_indices, k_indices);
+  }
+  EXPECT_EQ (neighborhoods->getNeighbors (indices[0], 11, cached_indices, cached_sqr_distances), -1);
+
+  // The points which are not cached are searched
+  NormalEstimation<PointXYZ, Normal> ne;
+  ne.setInputCloud (cloud_ptr);
+  ne.setKSearch (10);
+  PointCloud<Normal> normals, cached_normals;
+  ne.compute (normals);
+  ne.setPrecomputedNeighborhoods (neighborhoods);
+  ne.compute (cached_normals);
+  ASSERT_EQ (cached_normals.points.size (), normals.points.size ());
+  for (std::size_t i = 0; i < normals.points.size (); ++i)
+  {
+    EXPECT_NEAR (cached_normals.points[i].normal_x, normals.points[i].normal_x, 1e-4);
+    EXPECT_NEAR (cached_normals.points[i].normal_y, normals.points[i].normal_y, 1e-4);
+    EXPECT_NEAR (cached_normals.points[i].normal_z, normals.points[i].normal_z, 1e-4);
+  }
+
+  // The search method of the neighborhoods is only borrowed for one compute ()
+  NormalEstimation<PointXYZ, Normal> borrowing_ne;
+  borrowing_ne.setInputCloud (cloud_ptr);
+  borrowing_ne.setKSearch (10);
+  borrowing_ne.setPrecomputedNeighborhoods (neighborhoods);
+  borrowing_ne.compute (cached_normals);
+  EXPECT_FALSE (borrowing_ne.getSearchMethod ());
+  // A search surface which the neighborhoods do not match gets a search method of its own
+  borrowing_ne.setSearchSurface (cloud.makeShared ());
+  borrowing_ne.compute (normals);
+  EXPECT_NE (borrowing_ne.getSearchMethod (), neighborhoods->getSearchMethod ());
+  EXPECT_EQ (neighborhoods->getSearchMethod ()->getInputCloud (), cloud_ptr);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ParallelFeature)
+{
+  PointCloud<PointXYZ>::ConstPtr cloud_ptr = cloud.makeShared ();
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  NormalEstimation<PointXYZ, Normal> ne;
+  ne.setInputCloud (cloud_ptr);
+  ne.setSearchMethod (tree);
+  ne.setKSearch (10);
+  ne.compute (*normals);
+
+  // Use the pool even on machines with fewer cores
+  const pcl::parallel::ScopedThreadBudget budget (4);
+
+  // The features computed with several threads are the same as the ones computed with one
+  PrincipalCurvaturesEstimation<PointXYZ, Normal, PrincipalCurvatures> pc;
+  EXPECT_EQ (pc.getNumberOfThreads (), 1u);
+  pc.setInputCloud (cloud_ptr);
+  pc.setInputNormals (normals);
+  pc.setSearchMethod (tree);
+  pc.setKSearch (10);
+  PointCloud<PrincipalCurvatures> curvatures, parallel_curvatures;
+  pc.compute (curvatures);
+  pc.setNumberOfThreads (4);
+  EXPECT_EQ (pc.getNumberOfThreads (), 4u);
+  pc.compute (parallel_curvatures);
+  ASSERT_EQ (parallel_curvatures.points.size (), curvatures.points.size ());
+  EXPECT_EQ (parallel_curvatures.is_dense, curvatures.is_dense);
+  for (std::size_t i = 0; i < curvatures.points.size (); ++i)
+  {
+    EXPECT_EQ (parallel_curvatures.points[i].principal_curvature_x, curvatures.points[i].principal_curvature_x);
+    EXPECT_EQ (parallel_curvatures.points[i].principal_curvature_y, curvatures.points[i].principal_curvature_y);
+    EXPECT_EQ (parallel_curvatures.points[i].principal_curvature_z, curvatures.points[i].principal_curvature_z);
+    EXPECT_EQ (parallel_curvatures.points[i].pc1, curvatures.points[i].pc1);
+    EXPECT_EQ (parallel_curvatures.points[i].pc2, curvatures.points[i].pc2);
+  }
+
+  BoundaryEstimation<PointXYZ, Normal, Boundary> be;
+  be.setInputCloud (cloud_ptr);
+  be.setInputNormals (normals);
+  be.setSearchMethod (tree);
+  be.setKSearch (10);
+  PointCloud<Boundary> boundaries, parallel_boundaries;
+  be.compute (boundaries);
+  be.setNumberOfThreads (4);
+  be.compute (parallel_boundaries);
+  ASSERT_EQ (parallel_boundaries.points.size (), boundaries.points.size ());
+  for (std::size_t i = 0; i < boundaries.points.size (); ++i)
+    EXPECT_EQ (parallel_boundaries.points[i].boundary_point, boundaries.points[i].boundary_point);
+
+  RSDEstimation<PointXYZ, Normal, PrincipalRadiiRSD> rsd;
+  rsd.setInputCloud (cloud_ptr);
+  rsd.setInputNormals (normals);
+  rsd.setSearchMethod (tree);
+  rsd.setRadiusSearch (0.02);
+  rsd.setSaveHistograms (true);
+  PointCloud<PrincipalRadiiRSD> radii, parallel_radii;
+  rsd.compute (radii);
+  const auto histograms = rsd.getHistograms ();
+  rsd.setNumberOfThreads (4);
+  rsd.compute (parallel_radii);
+  ASSERT_EQ (parallel_radii.points.size (), radii.points.size ());
+  ASSERT_EQ (rsd.getHistograms ()->size (), histograms->size ());
+  for (std::size_t i = 0; i < radii.points.size (); ++i)
+  {
+    EXPECT_EQ (parallel_radii.points[i].r_min, radii.points[i].r_min);
+    EXPECT_EQ (parallel_radii.points[i].r_max, radii.points[i].r_max);
+    EXPECT_EQ ((*rsd.getHistograms ())[i], (*histograms)[i]);
+  }
+
+  // An exception thrown for a point leaves the parallel computation
+  SpinImageEstimation<PointXYZ, Normal, Histogram<153> > spin_est (8, 0.5, 16);
+  spin_est.setInputCloud (cloud_ptr);
+  spin_est.setInputNormals (normals);
+  spin_est.setSearchMethod (tree);
+  spin_est.setRadiusSearch (0.001);
+  spin_est.setNumberOfThreads (4);
+  PointCloud<Histogram<153> > spin_images;
+  EXPECT_THROW (spin_est.compute (spin_images), PCLException);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -41,7 +41,9 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
 
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 using namespace pcl;
 using namespace std;
@@ -490,6 +492,66 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationThreads)
+{
+  // A curved, noisy surface with holes, whose size is not a multiple of the tile size used internally
+  PointCloud<PointXYZ>::Ptr surface (new PointCloud<PointXYZ> (203, 157));
+  for (std::size_t v = 0; v < surface->height; ++v)
+  {
+    for (std::size_t u = 0; u < surface->width; ++u)
+    {
+      PointXYZ &point = (*surface) (u, v);
+      point.x = static_cast<float> (u) * 0.01f;
+      point.y = static_cast<float> (v) * 0.01f;
+      point.z = 2.0f + 0.3f * std::sin (point.x * 3.0f) * std::cos (point.y * 2.0f) + 0.001f * static_cast<float> ((u * 7 + v * 13) % 5);
+      if ((u * 31 + v * 17) % 41 == 0)
+        point.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+  surface->is_dense = false;
+
+  using Estimator = IntegralImageNormalEstimation<PointXYZ, Normal>;
+  const Estimator::NormalEstimationMethod methods[] = {Estimator::COVARIANCE_MATRIX, Estimator::AVERAGE_3D_GRADIENT,
+                                                       Estimator::AVERAGE_DEPTH_CHANGE, Estimator::SIMPLE_3D_GRADIENT};
+  for (const auto method : methods)
+  {
+    for (const auto border_policy : {Estimator::BORDER_POLICY_IGNORE, Estimator::BORDER_POLICY_MIRROR})
+    {
+      if (method == Estimator::SIMPLE_3D_GRADIENT && border_policy == Estimator::BORDER_POLICY_MIRROR)
+        continue;
+
+      PointCloud<Normal> output[2];
+      for (int run = 0; run < 2; ++run)
+      {
+        Estimator estimator;
+        estimator.setNormalEstimationMethod (method);
+        estimator.setBorderPolicy (border_policy);
+        estimator.setDepthDependentSmoothing (true);
+        estimator.setNormalSmoothingSize (5.0f);
+        estimator.setNumberOfThreads (run == 0 ? 1 : 4);
+        estimator.setInputCloud (surface);
+        estimator.compute (output[run]);
+      }
+
+      // The normals computed with several threads are identical to the serial ones
+      ASSERT_EQ (output[0].size (), output[1].size ());
+      for (std::size_t i = 0; i < output[0].size (); ++i)
+      {
+        for (int d = 0; d < 4; ++d)
+        {
+          const float a = d < 3 ? output[0][i].normal[d] : output[0][i].curvature;
+          const float b = d < 3 ? output[1][i].normal[d] : output[1][i].curvature;
+          if (std::isnan (a))
+            EXPECT_TRUE (std::isnan (b));
+          else
+            EXPECT_EQ (a, b);
+        }
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
@@ -247,6 +247,11 @@ TEST (PCL, NormalEstimationOpenMPInitVectors)
 TEST (PCL, NormalEstimationOpenMP)
 {
   NormalEstimationOMP<PointXYZ, Normal> n (4); // instantiate 4 threads
+  // The number of threads is the one of Feature, whichever class it is set through
+  EXPECT_EQ (4u, n.getNumberOfThreads ());
+  Feature<PointXYZ, Normal> &feature = n;
+  feature.setNumberOfThreads (2);
+  EXPECT_EQ (2u, n.getNumberOfThreads ());
 
   // Object
   PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
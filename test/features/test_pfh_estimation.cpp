@@ -45,6 +45,7 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/pfh.h>
+#include <pcl/features/pfh_tools.h>
 #include <pcl/features/fpfh.h>
 #include <pcl/features/fpfh_omp.h>
 #include <pcl/features/vfh.h>
@@ -449,6 +450,159 @@ TYPED_TEST (FPFHTest, Estimation)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TYPED_TEST (FPFHTest, MultiRadius)
+{
+  TypeParam& fpfh = this->fpfh;
+  fpfh.setInputCloud (cloud);
+  fpfh.setInputNormals (cloud);
+  fpfh.setSearchMethod (tree);
+  fpfh.setKSearch (10);
+
+  const std::vector<double> radii = {0.005, 0.01, 0.02};
+  std::vector<PointCloud<FPFHSignature33> > outputs;
+  fpfh.computeMultiRadius (radii, outputs);
+  ASSERT_EQ (outputs.size (), radii.size ());
+  // The search parameters of the estimator are left untouched
+  EXPECT_EQ (fpfh.getKSearch (), 10);
+  EXPECT_EQ (fpfh.getRadiusSearch (), 0.0);
+
+  FPFHEstimation<PointT, PointT, FPFHSignature33> reference;
+  reference.setInputCloud (cloud);
+  reference.setInputNormals (cloud);
+  reference.setSearchMethod (tree);
+  for (std::size_t r = 0; r < radii.size (); ++r)
+  {
+    PointCloud<FPFHSignature33> expected;
+    reference.setRadiusSearch (radii[r]);
+    reference.compute (expected);
+
+    ASSERT_EQ (outputs[r].size (), expected.size ());
+    EXPECT_EQ (outputs[r].is_dense, expected.is_dense);
+    for (std::size_t i = 0; i < expected.size (); ++i)
+      for (int d = 0; d < 33; ++d)
+      {
+        if (std::isnan (expected[i].histogram[d]))
+          EXPECT_TRUE (std::isnan (outputs[r][i].histogram[d]));
+        else
+          EXPECT_NEAR (outputs[r][i].histogram[d], expected[i].histogram[d], 1e-4);
+      }
+  }
+
+  // Invalid radii
+  fpfh.computeMultiRadius (std::vector<double> (), outputs);
+  EXPECT_TRUE (outputs.empty ());
+  fpfh.computeMultiRadius (std::vector<double> {0.01, 0.0}, outputs);
+  EXPECT_TRUE (outputs.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PairFeaturesBatch)
+{
+  // Pair the first point with all the points, itself included
+  const std::size_t nr_points = cloud->size ();
+  std::vector<float> data (10 * nr_points);
+  float *x = &data[0], *y = x + nr_points, *z = y + nr_points;
+  float *nx = z + nr_points, *ny = nx + nr_points, *nz = ny + nr_points;
+  float *f1 = nz + nr_points, *f2 = f1 + nr_points, *f3 = f2 + nr_points, *f4 = f3 + nr_points;
+  for (std::size_t i = 0; i < nr_points; ++i)
+  {
+    x[i] = (*cloud)[i].x;
+    y[i] = (*cloud)[i].y;
+    z[i] = (*cloud)[i].z;
+    nx[i] = (*cloud)[i].normal_x;
+    ny[i] = (*cloud)[i].normal_y;
+    nz[i] = (*cloud)[i].normal_z;
+  }
+
+  const Eigen::Vector4f p1 = (*cloud)[0].getVector4fMap (), n1 = (*cloud)[0].getNormalVector4fMap ();
+  for (const bool fast_atan2 : {false, true})
+  {
+    const std::size_t nr_valid = pcl::computePairFeatures (p1, n1, nr_points, x, y, z, nx, ny, nz,
+                                                           f1, f2, f3, f4, fast_atan2);
+    std::size_t expected_nr_valid = 0;
+    for (std::size_t i = 0; i < nr_points; ++i)
+    {
+      float e1, e2, e3, e4;
+      if (pcl::computePairFeatures (p1, n1, (*cloud)[i].getVector4fMap (), (*cloud)[i].getNormalVector4fMap (),
+                                    e1, e2, e3, e4))
+        ++expected_nr_valid;
+      EXPECT_NEAR (f1[i], e1, 1e-4);
+      EXPECT_NEAR (f2[i], e2, 1e-5);
+      EXPECT_NEAR (f3[i], e3, 1e-5);
+      EXPECT_NEAR (f4[i], e4, 1e-5);
+    }
+    EXPECT_EQ (nr_valid, expected_nr_valid);
+    // The pair of the first point with itself is undefined
+    EXPECT_EQ (f1[0], 0.0f);
+    EXPECT_EQ (f4[0], 0.0f);
+  }
+
+  for (int i = -180; i <= 180; ++i)
+  {
+    const float angle = static_cast<float> (i * M_PI / 180.0) * 0.999f;
+    EXPECT_NEAR (pcl::fastAtan2 (2.0f * std::sin (angle), 2.0f * std::cos (angle)), angle, 2e-5);
+  }
+  EXPECT_EQ (pcl::fastAtan2 (0.0f, 0.0f), 0.0f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PairFeaturesDuplicatedNeighbor)
+{
+  // A neighborhood in which the first point appears twice: the pairs of the two copies are undefined, and binned
+  // with zero features as by the single pair version
+  PointCloud<PointT> duplicated;
+  for (std::size_t i = 0; i < 20; ++i)
+    duplicated.push_back ((*cloud)[i]);
+  duplicated.push_back ((*cloud)[0]);
+  std::vector<int> neighbors (duplicated.size ());
+  for (std::size_t i = 0; i < neighbors.size (); ++i)
+    neighbors[i] = static_cast<int> (i);
+
+  // FPFH: against the single pair version
+  const int nr_bins = 11;
+  FPFHEstimation<PointT, PointT, FPFHSignature33> fpfh;
+  Eigen::MatrixXf hist_f1 = Eigen::MatrixXf::Zero (1, nr_bins), hist_f2 = hist_f1, hist_f3 = hist_f1;
+  fpfh.computePointSPFHSignature (duplicated, duplicated, 0, 0, neighbors, hist_f1, hist_f2, hist_f3);
+  Eigen::MatrixXf expected_f1 = Eigen::MatrixXf::Zero (1, nr_bins), expected_f2 = expected_f1, expected_f3 = expected_f1;
+  const float hist_incr = 100.0f / static_cast<float> (neighbors.size () - 1);
+  const auto bin = [nr_bins] (double value) { return ((std::min) ((std::max) (static_cast<int> (std::floor (nr_bins * value)), 0), nr_bins - 1)); };
+  for (const int j : neighbors)
+  {
+    float f1, f2, f3, f4;
+    if (j == 0)
+      continue;
+    pcl::computePairFeatures (duplicated[0].getVector4fMap (), duplicated[0].getNormalVector4fMap (),
+                              duplicated[j].getVector4fMap (), duplicated[j].getNormalVector4fMap (),
+                              f1, f2, f3, f4);
+    expected_f1 (0, bin ((f1 + M_PI) / (2.0 * M_PI))) += hist_incr;
+    expected_f2 (0, bin ((f2 + 1.0) * 0.5)) += hist_incr;
+    expected_f3 (0, bin ((f3 + 1.0) * 0.5)) += hist_incr;
+  }
+  for (int b = 0; b < nr_bins; ++b)
+  {
+    EXPECT_NEAR (hist_f1 (0, b), expected_f1 (0, b), 1e-4);
+    EXPECT_NEAR (hist_f2 (0, b), expected_f2 (0, b), 1e-4);
+    EXPECT_NEAR (hist_f3 (0, b), expected_f3 (0, b), 1e-4);
+  }
+  // Every pair is binned, so the histograms still sum to 100
+  EXPECT_NEAR (hist_f1.sum (), 100.0f, 1e-3);
+  EXPECT_NEAR (hist_f2.sum (), 100.0f, 1e-3);
+  EXPECT_NEAR (hist_f3.sum (), 100.0f, 1e-3);
+
+  // PFH: the batch path against the cached one, which pairs the points one by one
+  const int nr_subdiv = 5;
+  pcl::PFHEstimation<PointT, PointT, pcl::PFHSignature125> pfh;
+  Eigen::VectorXf batch (nr_subdiv * nr_subdiv * nr_subdiv), cached (nr_subdiv * nr_subdiv * nr_subdiv);
+  pfh.setUseInternalCache (false);
+  pfh.computePointPFHSignature (duplicated, duplicated, neighbors, nr_subdiv, batch);
+  pfh.setUseInternalCache (true);
+  pfh.computePointPFHSignature (duplicated, duplicated, neighbors, nr_subdiv, cached);
+  for (int b = 0; b < batch.size (); ++b)
+    EXPECT_NEAR (batch[b], cached[b], 1e-4);
+  EXPECT_NEAR (batch.sum (), 100.0f, 1e-3);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, VFHEstimation)
 {
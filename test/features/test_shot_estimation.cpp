@@ -473,6 +473,65 @@ TYPED_TEST (SHOTShapeTest, Estimation)
   testSHOTLocalReferenceFrame<TypeParam, PointXYZ, Normal, SHOT352> (cloud.makeShared (), normals, test_indices);
 }
 
+TYPED_TEST (SHOTShapeTest, CloudReferenceFrames)
+{
+  double radius = 0.04;
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (radius);
+  n.compute (*normals);
+
+  // Frames for the whole cloud, computed once
+  PointCloud<ReferenceFrame>::Ptr frames (new PointCloud<ReferenceFrame> ());
+  SHOTLocalReferenceFrameEstimation<PointXYZ, ReferenceFrame> lrf_estimator;
+  lrf_estimator.setRadiusSearch (radius);
+  lrf_estimator.setInputCloud (cloud.makeShared ());
+  lrf_estimator.compute (*frames);
+
+  PointCloud<SHOT352> full_output;
+  TypeParam& shot = this->shot;
+  shot.setInputNormals (normals);
+  shot.setRadiusSearch (radius);
+  shot.setSearchMethod (tree);
+  shot.setInputCloud (cloud.makeShared ());
+  shot.setInputReferenceFrames (frames);
+  shot.compute (full_output);
+  ASSERT_EQ (full_output.size (), cloud.size ());
+
+  // Describe the cloud in two batches of indices, reusing the cloud-wide frames
+  shot.setInputCloudReferenceFrames (frames);
+  EXPECT_EQ (shot.getInputCloudReferenceFrames (), frames);
+  for (std::size_t batch = 0; batch < 2; ++batch)
+  {
+    pcl::IndicesPtr batch_indices (new pcl::Indices);
+    for (std::size_t i = batch; i < cloud.size (); i += 2)
+      batch_indices->push_back (static_cast<int> (i));
+
+    PointCloud<SHOT352> output, expected;
+    shot.setIndices (batch_indices);
+    shot.compute (output);
+    shotCopyPointCloud<SHOT352> (full_output, *batch_indices, expected);
+    checkDesc<SHOT352> (output, expected);
+
+    PointCloud<ReferenceFrame>::ConstPtr used_frames = shot.getInputReferenceFrames ();
+    ASSERT_EQ (used_frames->size (), batch_indices->size ());
+    for (std::size_t i = 0; i < batch_indices->size (); ++i)
+      for (int j = 0; j < 9; ++j)
+        ASSERT_EQ (used_frames->points[i].rf[j], frames->points[(*batch_indices)[i]].rf[j]);
+  }
+
+  // A frame cloud that does not match the input is rejected
+  PointCloud<ReferenceFrame>::Ptr wrong_frames (new PointCloud<ReferenceFrame> (*frames));
+  wrong_frames->points.pop_back ();
+  wrong_frames->width = static_cast<std::uint32_t> (wrong_frames->points.size ());
+  shot.setInputCloudReferenceFrames (wrong_frames);
+  PointCloud<SHOT352> output;
+  shot.compute (output);
+  EXPECT_TRUE (output.empty ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /*
 TEST (PCL, GenericSHOTShapeEstimation)
@@ -675,6 +734,42 @@ TYPED_TEST (SHOTShapeAndColorTest, Estimation)
   EXPECT_NEAR (shots1344->points[103].descriptor[511], 0.0057367259, 1e-5);
   EXPECT_NEAR (shots1344->points[103].descriptor[512], 0.048375979, 1e-5);
 
+  // A second compute () gives the same descriptors
+  PointCloud<SHOT1344> shots1344_again;
+  shot1344.compute (shots1344_again);
+  ASSERT_EQ (shots1344_again.points.size (), shots1344->points.size ());
+  for (std::size_t i = 0; i < shots1344->points.size (); i += 50)
+    for (int d = 0; d < 1344; ++d)
+      EXPECT_EQ (shots1344_again.points[i].descriptor[d], shots1344->points[i].descriptor[d]);
+
+  // ... and converted again for another cloud of the same size
+  PointCloud<PointXYZRGBA>::Ptr recolored (new PointCloud<PointXYZRGBA> (cloudWithColors));
+  for (auto &point : recolored->points)
+    std::swap (point.r, point.b);
+  shot1344.setInputCloud (recolored);
+  shot1344.compute (shots1344_again);
+  TypeParam recolored_shot;
+  recolored_shot.setInputNormals (normals);
+  recolored_shot.setRadiusSearch (20 * mr);
+  recolored_shot.setInputCloud (recolored);
+  recolored_shot.setIndices (indicesptr);
+  PointCloud<SHOT1344> recolored_shots;
+  recolored_shot.compute (recolored_shots);
+  ASSERT_EQ (shots1344_again.points.size (), recolored_shots.points.size ());
+  for (std::size_t i = 0; i < recolored_shots.points.size (); i += 50)
+    for (int d = 0; d < 1344; ++d)
+      EXPECT_NEAR (shots1344_again.points[i].descriptor[d], recolored_shots.points[i].descriptor[d], 1e-6);
+
+  // ... and for the same cloud after its colors are edited in place
+  for (auto &point : recolored->points)
+    std::swap (point.r, point.b);
+  shot1344.compute (shots1344_again);
+  ASSERT_EQ (shots1344_again.points.size (), shots1344->points.size ());
+  for (std::size_t i = 0; i < shots1344->points.size (); i += 50)
+    for (int d = 0; d < 1344; ++d)
+      EXPECT_NEAR (shots1344_again.points[i].descriptor[d], shots1344->points[i].descriptor[d], 1e-6);
+  shot1344.setInputCloud (cloudWithColors.makeShared ());
+
   // Test results when setIndices and/or setSearchSurface are used
   pcl::IndicesPtr test_indices (new pcl::Indices (0));
   for (std::size_t i = 0; i < cloud.size (); i+=3)
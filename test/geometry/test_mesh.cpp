@@ -643,6 +643,158 @@ TEST (TestMesh, IsBoundaryIsManifold)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+TEST (TestMesh, AddFaces)
+{
+  // Triangulated grid of n x n vertices
+  const int n = 20;
+  std::vector <VertexIndices> faces;
+  VertexIndices buffer;
+  for (int y = 0; y + 1 < n; ++y)
+  {
+    for (int x = 0; x + 1 < n; ++x)
+    {
+      const VertexIndex v0 (y * n + x), v1 (y * n + x + 1), v2 ((y + 1) * n + x + 1), v3 ((y + 1) * n + x);
+      faces.push_back (VertexIndices {v0, v1, v3});
+      faces.push_back (VertexIndices {v1, v2, v3});
+      buffer.insert (buffer.end (), faces [faces.size () - 2].begin (), faces [faces.size () - 2].end ());
+      buffer.insert (buffer.end (), faces.back ().begin (), faces.back ().end ());
+    }
+  }
+
+  ManifoldTriangleMesh mesh, mesh_incremental, mesh_parallel;
+  for (int i = 0; i < n * n; ++i)
+  {
+    mesh.addVertex (i);
+    mesh_incremental.addVertex (i);
+    mesh_parallel.addVertex (i);
+  }
+  for (const auto &face : faces)
+  {
+    ASSERT_TRUE (mesh_incremental.addFace (face).isValid ());
+  }
+  ASSERT_EQ (faces.size (), mesh.addFaces (buffer, 3));
+  EXPECT_EQ (mesh_incremental.sizeEdges (), mesh.sizeEdges ());
+  EXPECT_TRUE (hasFaces (mesh, faces));
+  EXPECT_TRUE (mesh.isManifold ());
+  EXPECT_EQ (getBoundaryVertices (mesh_incremental, VertexIndex (0)), getBoundaryVertices (mesh, VertexIndex (0)));
+
+  // Same neighbors in the same order around the vertices
+  for (int i = 0; i < n * n; ++i)
+  {
+    VertexIndices expected, actual;
+    ManifoldTriangleMesh::VertexAroundVertexCirculator       circ     = mesh_incremental.getVertexAroundVertexCirculator (VertexIndex (i));
+    const ManifoldTriangleMesh::VertexAroundVertexCirculator circ_end = circ;
+    do expected.push_back (circ.getTargetIndex ()); while (++circ != circ_end);
+    circ = mesh.getVertexAroundVertexCirculator (VertexIndex (i));
+    const ManifoldTriangleMesh::VertexAroundVertexCirculator circ_end_2 = circ;
+    do actual.push_back (circ.getTargetIndex ()); while (++circ != circ_end_2);
+    EXPECT_TRUE (isCircularPermutation (expected, actual));
+  }
+
+  // Compact layout: the edges are numbered in the order of the first face they belong to, whose half-edge is the
+  // first one of the edge
+  for (std::size_t e = 0; e < mesh.sizeEdges (); ++e)
+  {
+    const FaceIndex face_0 = mesh.getFaceIndex (HalfEdgeIndex (static_cast <int> (2 * e)));
+    const FaceIndex face_1 = mesh.getFaceIndex (HalfEdgeIndex (static_cast <int> (2 * e + 1)));
+    ASSERT_TRUE (face_0.isValid ());
+    if (face_1.isValid ())
+    {
+      EXPECT_LT (face_0.get (), face_1.get ());
+    }
+    if (e > 0)
+    {
+      EXPECT_LE (mesh.getFaceIndex (HalfEdgeIndex (static_cast <int> (2 * e - 2))).get (), face_0.get ());
+    }
+  }
+
+  // The result does not depend on the number of threads
+  {
+    const pcl::parallel::ScopedThreadBudget budget (4);
+    ASSERT_EQ (faces.size (), mesh_parallel.addFaces (buffer, 3, ManifoldTriangleMesh::FaceDataCloud (), 4));
+  }
+  EXPECT_TRUE (mesh.isEqualTopology (mesh_parallel));
+
+  // The faces are added one by one to a mesh which has faces already
+  buffer.assign (faces [0].begin (), faces [0].end ());
+  ASSERT_EQ (0u, mesh_parallel.addFaces (buffer, 3));
+  EXPECT_EQ (faces.size (), mesh_parallel.sizeFaces ());
+
+  // Wrong face size
+  ManifoldTriangleMesh mesh_quads;
+  for (int i = 0; i < 4; ++i) mesh_quads.addVertex (i);
+  buffer = {VertexIndex (0), VertexIndex (1), VertexIndex (2), VertexIndex (3)};
+  EXPECT_EQ (0u, mesh_quads.addFaces (buffer, 4));
+  EXPECT_EQ (0u, mesh_quads.sizeEdges ());
+
+  // Offsets which decrease or exceed the vertices
+  ManifoldTriangleMesh mesh_offsets;
+  for (int i = 0; i < 3; ++i) mesh_offsets.addVertex (i);
+  buffer = {VertexIndex (0), VertexIndex (1), VertexIndex (2)};
+  EXPECT_EQ (0u, mesh_offsets.addFaces (buffer, std::vector <std::size_t> {0, 10, 3}));
+  EXPECT_EQ (0u, mesh_offsets.addFaces (buffer, std::vector <std::size_t> {0, 4}));
+  EXPECT_EQ (0u, mesh_offsets.sizeFaces ());
+  EXPECT_EQ (1u, mesh_offsets.addFaces (buffer, std::vector <std::size_t> {0, 3}));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST (TestMesh, AddFacesNonManifold)
+{
+  // Same faces as in IsBoundaryIsManifold: the vertices 0, 1 and 2 have two fans until the last face is added
+  using VI = VertexIndex;
+  const std::vector <VertexIndices> faces = {{VI (0), VI (3), VI (1)}, {VI (2), VI (1), VI (4)}, {VI (0), VI (2), VI (5)}, {VI (0), VI (1), VI (2)}};
+  VertexIndices buffer;
+  for (const auto &face : faces) buffer.insert (buffer.end (), face.begin (), face.end ());
+
+  // All faces form a manifold mesh, which is built at once
+  ManifoldTriangleMesh manifold_mesh;
+  for (unsigned int i = 0; i < 6; ++i) manifold_mesh.addVertex (i);
+  ASSERT_EQ (4u, manifold_mesh.addFaces (buffer, 3));
+  EXPECT_TRUE (hasFaces (manifold_mesh, faces));
+  EXPECT_TRUE (manifold_mesh.isManifold ());
+
+  // Without the last face, the faces are added one by one, which gives the same mesh as addFace
+  buffer.resize (9);
+  ManifoldTriangleMesh manifold_mesh_2, manifold_mesh_incremental;
+  NonManifoldTriangleMesh non_manifold_mesh, non_manifold_mesh_incremental;
+  for (unsigned int i = 0; i < 6; ++i)
+  {
+    manifold_mesh_2.addVertex (i);
+    manifold_mesh_incremental.addVertex (i);
+    non_manifold_mesh.addVertex (i);
+    non_manifold_mesh_incremental.addVertex (i);
+  }
+  std::size_t nr_added = 0;
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    if (manifold_mesh_incremental.addFace (faces [i]).isValid ()) ++nr_added;
+    ASSERT_TRUE (non_manifold_mesh_incremental.addFace (faces [i]).isValid ());
+  }
+  EXPECT_EQ (1u, nr_added);
+  EXPECT_EQ (nr_added, manifold_mesh_2.addFaces (buffer, 3));
+  EXPECT_TRUE (manifold_mesh_2.isEqualTopology (manifold_mesh_incremental));
+  EXPECT_EQ (3u, non_manifold_mesh.addFaces (buffer, 3));
+  EXPECT_TRUE (non_manifold_mesh.isEqualTopology (non_manifold_mesh_incremental));
+
+  // An edge shared by three faces
+  buffer = {VI (0), VI (1), VI (2), VI (1), VI (0), VI (3), VI (0), VI (1), VI (4)};
+  NonManifoldTriangleMesh mesh_3, mesh_3_parallel;
+  for (unsigned int i = 0; i < 5; ++i)
+  {
+    mesh_3.addVertex (i);
+    mesh_3_parallel.addVertex (i);
+  }
+  EXPECT_EQ (2u, mesh_3.addFaces (buffer, 3));
+
+  // The faces are rejected in the same way on several threads
+  const pcl::parallel::ScopedThreadBudget budget (4);
+  EXPECT_EQ (2u, mesh_3_parallel.addFaces (buffer, 3, NonManifoldTriangleMesh::FaceDataCloud (), 4));
+  EXPECT_TRUE (mesh_3_parallel.isEqualTopology (mesh_3));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 int
 main (int argc, char** argv)
 {
@@ -0,0 +1,212 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Point Cloud Library (PCL) - www.pointclouds.org
+ * Copyright (c) 2020-, Open Perception, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials provided
+ *    with the distribution.
+ *  * Neither the name of the copyright holder(s) nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <cmath>
+#include <functional>
+#include <set>
+#include <vector>
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/geometry/quadric_decimation.h>
+#include <pcl/geometry/triangle_mesh.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct MeshTraits
+{
+  using VertexData = pcl::PointXYZ;
+  using HalfEdgeData = pcl::geometry::NoData;
+  using EdgeData = pcl::geometry::NoData;
+  using FaceData = int;
+  using IsManifold = std::true_type;
+};
+
+using Mesh = pcl::geometry::TriangleMesh<MeshTraits>;
+using VertexIndex = Mesh::VertexIndex;
+using FaceIndex = Mesh::FaceIndex;
+
+/** \brief Triangulated grid of n x n vertices over [0, n-1]^2, with the height given by a function. The faces hold their index as data. */
+Mesh
+makeGrid (const int n, const std::function <float (float, float)>& height)
+{
+  Mesh mesh;
+  for (int y = 0; y < n; ++y)
+  {
+    for (int x = 0; x < n; ++x)
+    {
+      mesh.addVertex (pcl::PointXYZ (float (x), float (y), height (float (x), float (y))));
+    }
+  }
+  int face = 0;
+  for (int y = 0; y + 1 < n; ++y)
+  {
+    for (int x = 0; x + 1 < n; ++x)
+    {
+      const VertexIndex v0 (y * n + x), v1 (y * n + x + 1), v2 ((y + 1) * n + x + 1), v3 ((y + 1) * n + x);
+      EXPECT_TRUE (mesh.addFace (v0, v1, v3, face++).isValid ());
+      EXPECT_TRUE (mesh.addFace (v1, v2, v3, face++).isValid ());
+    }
+  }
+  return (mesh);
+}
+
+/** \brief Check that the faces of a height field still face up, and that their data are distinct original faces. */
+void
+checkFaces (const Mesh& mesh, const int nr_original_faces)
+{
+  std::set <int> data;
+  for (std::size_t f = 0; f < mesh.sizeFaces (); ++f)
+  {
+    Mesh::VertexAroundFaceCirculator circ = mesh.getVertexAroundFaceCirculator (FaceIndex (static_cast <int> (f)));
+    Eigen::Vector3f p [3];
+    for (int i = 0; i < 3; ++i, ++circ)
+    {
+      p [i] = mesh.getVertexDataCloud () [circ.getTargetIndex ().get ()].getVector3fMap ();
+    }
+    EXPECT_GT ((p [1] - p [0]).cross (p [2] - p [0]) [2], 0.0f);
+
+    const int face = mesh.getFaceDataCloud () [f];
+    EXPECT_GE (face, 0);
+    EXPECT_LT (face, nr_original_faces);
+    EXPECT_TRUE (data.insert (face).second);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST (TestQuadricDecimation, Plane)
+{
+  const int n = 30;
+  Mesh mesh = makeGrid (n, [] (float, float) { return (0.0f); });
+  const int nr_faces = static_cast <int> (mesh.sizeFaces ());
+
+  pcl::geometry::QuadricDecimation <Mesh> decimation;
+  decimation.setTargetNumberOfFaces (200);
+  EXPECT_LE (decimation.decimate (mesh), 200u);
+  EXPECT_EQ (0u, decimation.getNumberOfDroppedFaces ());
+  EXPECT_GE (mesh.sizeFaces (), 190u);
+  EXPECT_TRUE (mesh.isManifold ());
+  checkFaces (mesh, nr_faces);
+
+  // The plane stays in place, and so do its boundary and corners
+  Eigen::Vector3f min_pt = Eigen::Vector3f::Constant (1e9f), max_pt = -min_pt;
+  for (const auto& vertex : mesh.getVertexDataCloud ())
+  {
+    EXPECT_NEAR (0.0f, vertex.z, 1e-5f);
+    min_pt = min_pt.cwiseMin (vertex.getVector3fMap ());
+    max_pt = max_pt.cwiseMax (vertex.getVector3fMap ());
+  }
+  EXPECT_NEAR (0.0f, min_pt [0], 1e-4f);
+  EXPECT_NEAR (0.0f, min_pt [1], 1e-4f);
+  EXPECT_NEAR (n - 1.0f, max_pt [0], 1e-4f);
+  EXPECT_NEAR (n - 1.0f, max_pt [1], 1e-4f);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST (TestQuadricDecimation, MaxError)
+{
+  const int n = 40;
+  const auto height = [] (float x, float y) { return (0.5f * std::sin (0.3f * x) * std::cos (0.2f * y)); };
+  Mesh mesh = makeGrid (n, height);
+  const std::size_t nr_faces = mesh.sizeFaces ();
+
+  // Without a target, the decimation only stops at the maximum error
+  pcl::geometry::QuadricDecimation <Mesh> decimation;
+  decimation.setMaxError (1e-4);
+  EXPECT_EQ (0u, decimation.getTargetNumberOfFaces ());
+  decimation.decimate (mesh);
+  EXPECT_EQ (0u, decimation.getNumberOfDroppedFaces ());
+  EXPECT_LT (mesh.sizeFaces (), nr_faces / 2);
+  EXPECT_GT (mesh.sizeFaces (), 100u);
+  EXPECT_TRUE (mesh.isManifold ());
+  checkFaces (mesh, static_cast <int> (nr_faces));
+  for (const auto& vertex : mesh.getVertexDataCloud ())
+  {
+    EXPECT_NEAR (height (vertex.x, vertex.y), vertex.z, 0.05f);
+  }
+
+  // A lower bound keeps more faces
+  Mesh finer = makeGrid (n, height);
+  decimation.setMaxError (1e-6);
+  decimation.decimate (finer);
+  EXPECT_EQ (0u, decimation.getNumberOfDroppedFaces ());
+  EXPECT_GT (finer.sizeFaces (), mesh.sizeFaces ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TEST (TestQuadricDecimation, Parallel)
+{
+  // Large enough to be decimated in parts first
+  const int n = 160;
+  const auto height = [] (float x, float y) { return (5.0f * std::sin (0.05f * x) * std::cos (0.07f * y)); };
+  Mesh mesh = makeGrid (n, height);
+  const int nr_faces = static_cast <int> (mesh.sizeFaces ());
+
+  pcl::geometry::QuadricDecimation <Mesh> decimation;
+  decimation.setTargetNumberOfFaces (nr_faces / 20);
+  EXPECT_LE (decimation.decimate (mesh), static_cast <std::size_t> (nr_faces / 20));
+  EXPECT_EQ (0u, decimation.getNumberOfDroppedFaces ());
+  EXPECT_GE (mesh.sizeFaces (), static_cast <std::size_t> (nr_faces / 20 - 10));
+  EXPECT_TRUE (mesh.isManifold ());
+  checkFaces (mesh, nr_faces);
+
+  // The result does not depend on the number of threads
+  Mesh parallel_mesh = makeGrid (n, height);
+  decimation.setNumberOfThreads (4);
+  decimation.decimate (parallel_mesh);
+  EXPECT_EQ (0u, decimation.getNumberOfDroppedFaces ());
+  ASSERT_EQ (mesh.sizeVertices (), parallel_mesh.sizeVertices ());
+  ASSERT_EQ (mesh.sizeFaces (), parallel_mesh.sizeFaces ());
+  EXPECT_TRUE (mesh.isEqualTopology (parallel_mesh));
+  for (std::size_t v = 0; v < mesh.sizeVertices (); ++v)
+  {
+    EXPECT_EQ (mesh.getVertexDataCloud () [v].getVector3fMap (), parallel_mesh.getVertexDataCloud () [v].getVector3fMap ());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
@@ -41,6 +41,12 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <pcl/test/gtest.h>
+#include <pcl/console/print.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <locale>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PLYReaderWriter)
@@ -531,6 +537,251 @@ TEST_F (PLYTest, CommentAtTheEnd)
   ASSERT_EQ (cloud.empty(), false);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, BinaryByteOrders)
+{
+  for (const bool big_endian : {false, true})
+  {
+    std::ostringstream data;
+    const auto write = [&] (auto value)
+    {
+      char bytes[sizeof (value)];
+      memcpy (bytes, &value, sizeof (value));
+      const bool host_big_endian = (pcl::io::ply::host_byte_order == pcl::io::ply::big_endian_byte_order);
+      if (big_endian != host_big_endian)
+        std::reverse (bytes, bytes + sizeof (value));
+      data.write (bytes, sizeof (value));
+    };
+    for (int i = 0; i < 3; ++i)
+    {
+      write (1.5f * i);
+      write (-2.0f * i);
+      write (0.25 * i);
+      write (std::uint8_t (10 * i));
+      write (std::uint8_t (20 * i));
+      write (std::uint8_t (30 * i));
+      write (std::uint8_t (255));
+      write (std::uint16_t (1000 + i));
+    }
+    // a face with a scalar and a list that are not read, around the vertex indices
+    write (std::uint8_t (7));
+    write (std::uint8_t (3));
+    write (std::int32_t (0));
+    write (std::int32_t (1));
+    write (std::int32_t (2));
+    write (std::uint8_t (2));
+    write (0.5f);
+    write (0.75f);
+
+    std::ofstream fs;
+    fs.open (mesh_file_ply_.c_str (), std::ios::binary);
+    fs << "ply\n"
+          "format " << (big_endian ? "binary_big_endian" : "binary_little_endian") << " 1.0\n"
+          "element vertex 3\n"
+          "property float x\n"
+          "property float y\n"
+          "property double z\n"
+          "property uchar red\n"
+          "property uchar green\n"
+          "property uchar blue\n"
+          "property uchar alpha\n"
+          "property ushort label\n"
+          "element face 1\n"
+          "property uchar flags\n"
+          "property list uchar int vertex_indices\n"
+          "property list uchar float texcoord\n"
+          "end_header\n"
+       << data.str ();
+    fs.close ();
+
+    pcl::PolygonMesh mesh;
+    ASSERT_EQ (pcl::io::loadPLYFile (mesh_file_ply_, mesh), 0);
+    ASSERT_EQ (mesh.cloud.width * mesh.cloud.height, 3);
+    ASSERT_EQ (mesh.cloud.fields.size (), 5);
+    EXPECT_EQ (mesh.cloud.fields[3].name, "rgba");
+    EXPECT_EQ (mesh.cloud.point_step, 22);
+    EXPECT_TRUE (mesh.cloud.is_dense);
+    for (int i = 0; i < 3; ++i)
+    {
+      const std::uint8_t* point = &mesh.cloud.data[i * mesh.cloud.point_step];
+      float x, y;
+      double z;
+      std::uint32_t rgba;
+      std::uint16_t label;
+      memcpy (&x, point, sizeof (x));
+      memcpy (&y, point + 4, sizeof (y));
+      memcpy (&z, point + 8, sizeof (z));
+      memcpy (&rgba, point + 16, sizeof (rgba));
+      memcpy (&label, point + 20, sizeof (label));
+      EXPECT_EQ (x, 1.5f * i);
+      EXPECT_EQ (y, -2.0f * i);
+      EXPECT_EQ (z, 0.25 * i);
+      EXPECT_EQ (rgba, 0xff000000u | (10u * i) << 16 | (20u * i) << 8 | 30u * i);
+      EXPECT_EQ (label, 1000 + i);
+    }
+    ASSERT_EQ (mesh.polygons.size (), 1);
+    EXPECT_EQ (mesh.polygons[0].vertices, std::vector<std::uint32_t> ({0, 1, 2}));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, ParallelASCII)
+{
+  // more vertices and faces than a chunk parsed by a thread
+  const int nr_vertices = 10000;
+  std::ofstream fs;
+  fs.open (mesh_file_ply_.c_str ());
+  fs << "ply\n"
+        "format ascii 1.0\n"
+        "element vertex " << nr_vertices << "\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property uchar intensity\n"
+        "element face " << nr_vertices - 2 << "\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n";
+  for (int i = 0; i < nr_vertices; ++i)
+    fs << i << " " << 0.5 * i << " " << (i == 5000 ? "nan" : "-1.25") << " " << i % 256 << "\n";
+  for (int i = 0; i + 2 < nr_vertices; ++i)
+    fs << "3 " << i << " " << i + 1 << "  " << i + 2 << "\n";
+  fs.close ();
+
+  pcl::PLYReader reader;
+  pcl::PolygonMesh serial, parallel;
+  ASSERT_EQ (reader.read (mesh_file_ply_, serial), 0);
+  reader.setNumberOfThreads (4);
+  ASSERT_EQ (reader.read (mesh_file_ply_, parallel), 0);
+
+  EXPECT_EQ (serial.cloud.data, parallel.cloud.data);
+  EXPECT_FALSE (serial.cloud.is_dense);
+  EXPECT_FALSE (parallel.cloud.is_dense);
+  ASSERT_EQ (parallel.polygons.size (), nr_vertices - 2);
+  for (int i = 0; i + 2 < nr_vertices; ++i)
+  {
+    EXPECT_EQ (serial.polygons[i].vertices, parallel.polygons[i].vertices);
+    EXPECT_EQ (parallel.polygons[i].vertices, std::vector<std::uint32_t> ({std::uint32_t (i), std::uint32_t (i + 1), std::uint32_t (i + 2)}));
+  }
+
+  pcl::PointCloud<pcl::PointXYZI> cloud;
+  pcl::fromPCLPointCloud2 (parallel.cloud, cloud);
+  ASSERT_EQ (cloud.size (), nr_vertices);
+  for (int i = 0; i < nr_vertices; ++i)
+  {
+    EXPECT_EQ (cloud[i].x, float (i));
+    EXPECT_EQ (cloud[i].y, float (0.5 * i));
+    EXPECT_EQ (cloud[i].intensity, float (i % 256));
+  }
+  EXPECT_TRUE (std::isnan (cloud[5000].z));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, ASCIIWithDecimalComma)
+{
+  std::ofstream fs;
+  fs.open (mesh_file_ply_.c_str ());
+  fs << "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "property double z\n"
+        "end_header\n"
+        "0.5 -1.25 2.75\n"
+        "1e-3 3.5e2 -inf\n"
+        "0.125 0.0625 1,5\n";
+  fs.close ();
+
+  // The numbers have to be parsed the same way in a locale whose decimal point is a comma
+  try
+  {
+#ifdef _WIN32
+    std::locale::global (std::locale ("German_germany"));
+#else
+    std::locale::global (std::locale ("de_DE.UTF-8"));
+#endif
+  }
+  catch (const std::runtime_error&)
+  {
+    PCL_WARN ("Failed to set locale, skipping test.\n");
+    return;
+  }
+  pcl::PCLPointCloud2 cloud;
+  const int res = pcl::io::loadPLYFile (mesh_file_ply_, cloud);
+  std::locale::global (std::locale::classic ());
+  ASSERT_EQ (res, 0);
+  ASSERT_EQ (cloud.width * cloud.height, 3);
+  ASSERT_EQ (cloud.fields.size (), 3);
+
+  const auto value = [&cloud] (std::size_t point, std::size_t field)
+  {
+    const std::uint8_t* data = &cloud.data[point * cloud.point_step + cloud.fields[field].offset];
+    if (cloud.fields[field].datatype == pcl::PCLPointField::FLOAT64)
+    {
+      double v;
+      memcpy (&v, data, sizeof (v));
+      return (v);
+    }
+    float v;
+    memcpy (&v, data, sizeof (v));
+    return (double (v));
+  };
+  EXPECT_EQ (value (0, 0), 0.5);
+  EXPECT_EQ (value (0, 1), -1.25);
+  EXPECT_EQ (value (0, 2), 2.75);
+  EXPECT_EQ (value (1, 0), double (1e-3f));
+  EXPECT_EQ (value (1, 1), 350.0);
+  EXPECT_EQ (value (1, 2), -std::numeric_limits<double>::infinity ());
+  EXPECT_EQ (value (2, 0), 0.125);
+  EXPECT_EQ (value (2, 1), 0.0625);
+  // A decimal comma is not a number
+  EXPECT_TRUE (std::isnan (value (2, 2)));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, MissingData)
+{
+  pcl::PCLPointCloud2 cloud;
+
+  std::ofstream fs;
+  fs.open (mesh_file_ply_.c_str ());
+  fs << "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "end_header\n"
+        "1 2\n"
+        "3 4\n";
+  fs.close ();
+  EXPECT_LT (pcl::io::loadPLYFile (mesh_file_ply_, cloud), 0);
+
+  fs.open (mesh_file_ply_.c_str ());
+  fs << "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "end_header\n"
+        "1 2\n"
+        "3\n"
+        "5 6\n";
+  fs.close ();
+  EXPECT_LT (pcl::io::loadPLYFile (mesh_file_ply_, cloud), 0);
+
+  const float values[5] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+  fs.open (mesh_file_ply_.c_str (), std::ios::binary);
+  fs << "ply\n"
+        "format binary_little_endian 1.0\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "end_header\n";
+  fs.write (reinterpret_cast<const char*> (values), sizeof (values));
+  fs.close ();
+  EXPECT_LT (pcl::io::loadPLYFile (mesh_file_ply_, cloud), 0);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
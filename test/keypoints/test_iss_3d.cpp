@@ -153,6 +153,43 @@ TEST (PCL, ISSKeypoint3D_BE)
   tree.reset (new search::KdTree<PointXYZ> ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ISSKeypoint3D_Threads)
+{
+  //
+  // The keypoints, and their order, do not depend on the number of threads
+  //
+  PointCloud<PointXYZ> keypoints_serial, keypoints_parallel;
+
+  ISSKeypoint3D<PointXYZ, PointXYZ> iss_detector;
+  iss_detector.setSearchMethod (tree);
+  iss_detector.setSalientRadius (6 * cloud_resolution);
+  iss_detector.setNonMaxRadius (4 * cloud_resolution);
+  iss_detector.setNormalRadius (4 * cloud_resolution);
+  iss_detector.setBorderRadius (4 * cloud_resolution);
+
+  iss_detector.setThreshold21 (0.975);
+  iss_detector.setThreshold32 (0.975);
+  iss_detector.setMinNeighbors (5);
+  iss_detector.setAngleThreshold (static_cast<float> (M_PI) / 3.0);
+  iss_detector.setInputCloud (cloud);
+
+  iss_detector.setNumberOfThreads (1);
+  iss_detector.compute (keypoints_serial);
+  iss_detector.setNumberOfThreads (4);
+  iss_detector.compute (keypoints_parallel);
+
+  ASSERT_EQ (keypoints_serial.points.size (), keypoints_parallel.points.size ());
+  for (std::size_t i = 0; i < keypoints_serial.points.size (); ++i)
+  {
+    EXPECT_EQ (keypoints_serial.points[i].x, keypoints_parallel.points[i].x);
+    EXPECT_EQ (keypoints_serial.points[i].y, keypoints_parallel.points[i].y);
+    EXPECT_EQ (keypoints_serial.points[i].z, keypoints_parallel.points[i].z);
+  }
+
+  tree.reset (new search::KdTree<PointXYZ> ());
+}
+
 //* ---[ */
 int
 main (int argc, char** argv)
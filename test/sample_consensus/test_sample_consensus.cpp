@@ -38,19 +38,32 @@
 
 #include <pcl/test/gtest.h>
 
+#include <pcl/common/parallel.h>
 #include <pcl/sample_consensus/msac.h>
 #include <pcl/sample_consensus/lmeds.h>
+#include <pcl/sample_consensus/magsac.h>
+#include <pcl/sample_consensus/gc_ransac.h>
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/mlesac.h>
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/rransac.h>
+#include <pcl/sample_consensus/sac_model_circle.h>
+#include <pcl/sample_consensus/sac_model_cylinder.h>
+#include <pcl/sample_consensus/sac_model_line.h>
+#include <pcl/sample_consensus/sac_model_normal_plane.h>
+#include <pcl/sample_consensus/sac_model_plane.h>
+#include <pcl/sample_consensus/sac_model_registration.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <thread>
+#include <type_traits>
+#include <utility>
 
 using namespace pcl;
 
@@ -77,6 +90,287 @@ TEST (SampleConsensus, Base)
 
   sac.setMaxIterations (10000);
   ASSERT_EQ (10000, sac.getMaxIterations ());
+
+  // The estimators can be copied and moved
+  static_assert (std::is_copy_constructible<RandomSampleConsensus<PointXYZ> >::value, "not copyable");
+  static_assert (std::is_move_constructible<RandomSampleConsensus<PointXYZ> >::value, "not movable");
+  RandomSampleConsensus<PointXYZ> copy (sac);
+  EXPECT_EQ (10000, copy.getMaxIterations ());
+  RandomSampleConsensus<PointXYZ> moved (std::move (copy));
+  EXPECT_EQ (0.03, moved.getDistanceThreshold ());
+  copy = moved;
+  EXPECT_EQ (0.99, copy.getProbability ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Random points and normals in [-1, 1]^3; the number of points is not a multiple of 4, 8 or 16 so that the
+// SIMD implementations also have to handle a remainder.
+void
+createRandomCloud (PointCloud<PointXYZ> &cloud, PointCloud<Normal> &normals, std::size_t nr_points = 100003)
+{
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> dist (-1.0f, 1.0f);
+  std::uniform_real_distribution<float> curvature_dist (0.0f, 0.1f);
+  cloud.resize (nr_points);
+  normals.resize (nr_points);
+  for (std::size_t i = 0; i < nr_points; ++i)
+  {
+    cloud[i].x = dist (rng);
+    cloud[i].y = dist (rng);
+    cloud[i].z = dist (rng);
+    normals[i].getNormalVector3fMap () = Eigen::Vector3f (dist (rng), dist (rng), dist (rng)).normalized ();
+    normals[i].curvature = curvature_dist (rng);
+  }
+}
+
+// Compare the standard, SIMD and multi-threaded inlier counts of a model. The SIMD implementations of
+// models using normals approximate acos, so a tiny fraction of the counts may differ there.
+template <typename ModelT> void
+verifyCountWithinDistance (ModelT &model, const Eigen::VectorXf &coefficients, double threshold, std::size_t tolerance = 0)
+{
+  const std::size_t nr_indices = model.getIndices ()->size ();
+  const std::size_t expected = model.countWithinDistanceStandard (coefficients, threshold, 0, nr_indices);
+  EXPECT_LT (0, expected);
+  EXPECT_GT (nr_indices, expected);
+#if defined (__SSE2__)
+  EXPECT_NEAR (expected, model.countWithinDistanceSSE (coefficients, threshold, 0, nr_indices), tolerance);
+#endif
+#if defined (__AVX__) && defined (__AVX2__)
+  EXPECT_NEAR (expected, model.countWithinDistanceAVX (coefficients, threshold, 0, nr_indices), tolerance);
+#endif
+#if defined (__AVX512F__)
+  EXPECT_NEAR (expected, model.countWithinDistanceAVX512 (coefficients, threshold, 0, nr_indices), tolerance);
+#endif
+  const std::size_t serial = model.countWithinDistance (coefficients, threshold);
+  EXPECT_NEAR (expected, serial, tolerance);
+  // The inliers are selected with the same distances, in the order of the indices
+  Indices inliers;
+  model.selectWithinDistance (coefficients, threshold, inliers);
+  EXPECT_EQ (serial, inliers.size ());
+  EXPECT_TRUE (std::is_sorted (inliers.begin (), inliers.end ()));
+  // Splitting the index range over several threads must not change the result
+  const pcl::parallel::ScopedThreadBudget budget (4);
+  model.setNumberOfThreads (4);
+  EXPECT_EQ (serial, model.countWithinDistance (coefficients, threshold));
+  Indices parallel_inliers;
+  model.selectWithinDistance (coefficients, threshold, parallel_inliers);
+  EXPECT_EQ (inliers, parallel_inliers);
+  model.setNumberOfThreads (-1);
+}
+
+TEST (SampleConsensusModel, CountWithinDistanceSIMD)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  createRandomCloud (*cloud, *normals);
+
+  SampleConsensusModelPlane<PointXYZ> plane (cloud);
+  verifyCountWithinDistance (plane, Eigen::Vector4f (0.36f, 0.48f, 0.8f, -0.1f), 0.05);
+
+  SampleConsensusModelNormalPlane<PointXYZ, Normal> normal_plane (cloud);
+  normal_plane.setInputNormals (normals);
+  normal_plane.setNormalDistanceWeight (0.1);
+  verifyCountWithinDistance (normal_plane, Eigen::Vector4f (0.36f, 0.48f, 0.8f, -0.1f), 0.1, 10);
+
+  SampleConsensusModelSphere<PointXYZ> sphere (cloud);
+  verifyCountWithinDistance (sphere, Eigen::Vector4f (0.1f, -0.2f, 0.3f, 0.6f), 0.05);
+
+  SampleConsensusModelCircle2D<PointXYZ> circle (cloud);
+  verifyCountWithinDistance (circle, Eigen::Vector3f (0.1f, -0.2f, 0.6f), 0.05);
+
+  Eigen::VectorXf line_coefficients (6);
+  line_coefficients << 0.1f, -0.2f, 0.3f, 1.0f, 2.0f, -0.5f;
+  SampleConsensusModelLine<PointXYZ> line (cloud);
+  verifyCountWithinDistance (line, line_coefficients, 0.1);
+
+  Eigen::VectorXf cylinder_coefficients (7);
+  cylinder_coefficients << 0.1f, -0.2f, 0.3f, 1.0f, 2.0f, -0.5f, 0.5f;
+  SampleConsensusModelCylinder<PointXYZ, Normal> cylinder (cloud);
+  cylinder.setInputNormals (normals);
+  cylinder.setNormalDistanceWeight (0.1);
+  verifyCountWithinDistance (cylinder, cylinder_coefficients, 0.1, 10);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Plane z = 0.5 hidden among uniformly distributed outliers (20 % inliers)
+template <typename SacT>
+class SacPretestTest : public ::testing::Test {};
+
+using sacPretestTypes = ::testing::Types<
+  RandomSampleConsensus<PointXYZ>,
+  MEstimatorSampleConsensus<PointXYZ>
+>;
+TYPED_TEST_SUITE(SacPretestTest, sacPretestTypes);
+
+TYPED_TEST(SacPretestTest, RejectBadHypotheses)
+{
+  const std::size_t nr_inliers = 2000;
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal> normals;
+  createRandomCloud (*cloud, normals, 5 * nr_inliers);
+  for (std::size_t i = 0; i < nr_inliers; ++i)
+    (*cloud)[i].z = 0.5f;
+
+  using Pretest = typename SampleConsensus<PointXYZ>::HypothesisPretest;
+  for (const Pretest pretest : {SampleConsensus<PointXYZ>::PRETEST_TDD, SampleConsensus<PointXYZ>::PRETEST_SPRT})
+  {
+    typename SampleConsensusModelPlane<PointXYZ>::Ptr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+    TypeParam sac (model, 0.01);
+    sac.setHypothesisPretest (pretest);
+    EXPECT_EQ (pretest, sac.getHypothesisPretest ());
+    ASSERT_TRUE (sac.computeModel ());
+
+    Indices inliers;
+    sac.getInliers (inliers);
+    // All the plane points, plus the few outliers which happen to be close to the plane
+    EXPECT_LE (nr_inliers, inliers.size ());
+    EXPECT_GT (nr_inliers + 200, inliers.size ());
+
+    Eigen::VectorXf coefficients;
+    sac.getModelCoefficients (coefficients);
+    EXPECT_NEAR (1.0f, std::abs (coefficients[2]), 1e-3f);
+    EXPECT_NEAR (0.5f, std::abs (coefficients[3]), 1e-2f);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MLESAC scores the hypotheses by likelihood rather than by inlier count, the pre-tests must not change its model
+TEST (MaximumLikelihoodSampleConsensus, Pretest)
+{
+  const std::size_t nr_inliers = 8000;
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal> normals;
+  createRandomCloud (*cloud, normals, nr_inliers + 2000);
+  for (std::size_t i = 0; i < nr_inliers; ++i)
+    (*cloud)[i].z = 0.5f;
+
+  const auto compute_model = [&cloud] (SampleConsensus<PointXYZ>::HypothesisPretest pretest)
+  {
+    SampleConsensusModelPlane<PointXYZ>::Ptr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+    MaximumLikelihoodSampleConsensus<PointXYZ> sac (model, 0.01);
+    sac.setHypothesisPretest (pretest);
+    EXPECT_TRUE (sac.computeModel ());
+    Eigen::VectorXf coefficients;
+    sac.getModelCoefficients (coefficients);
+    // Orient the plane, so that the coefficients of different runs compare
+    if (coefficients.size () == 4 && coefficients[2] < 0)
+      coefficients = -coefficients;
+    return (coefficients);
+  };
+
+  const Eigen::VectorXf expected = compute_model (SampleConsensus<PointXYZ>::PRETEST_NONE);
+  ASSERT_EQ (4, expected.size ());
+  EXPECT_NEAR (1.0f, expected[2], 1e-3f);
+  EXPECT_NEAR (-0.5f, expected[3], 1e-3f);
+
+  for (const auto pretest : {SampleConsensus<PointXYZ>::PRETEST_TDD, SampleConsensus<PointXYZ>::PRETEST_SPRT})
+  {
+    const Eigen::VectorXf coefficients = compute_model (pretest);
+    ASSERT_EQ (4, coefficients.size ());
+    for (int i = 0; i < 4; ++i)
+      EXPECT_NEAR (expected[i], coefficients[i], 1e-3f);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Several hypotheses computed concurrently, each of them counting its inliers with several threads as well
+TEST (RandomSampleConsensus, MultipleThreads)
+{
+  const pcl::parallel::ScopedThreadBudget budget (4);
+  const std::size_t nr_inliers = 10000;
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal> normals;
+  createRandomCloud (*cloud, normals, 5 * nr_inliers);
+  for (std::size_t i = 0; i < nr_inliers; ++i)
+    (*cloud)[i].z = 0.5f;
+
+  SampleConsensusModelPlane<PointXYZ>::Ptr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+  model->setNumberOfThreads (0);
+  RandomSampleConsensus<PointXYZ> sac (model, 0.01);
+  sac.setNumberOfThreads (0);
+  sac.setHypothesisPretest (SampleConsensus<PointXYZ>::PRETEST_SPRT);
+  ASSERT_TRUE (sac.computeModel ());
+
+  Indices inliers;
+  sac.getInliers (inliers);
+  EXPECT_LE (nr_inliers, inliers.size ());
+  EXPECT_GT (nr_inliers + 1000, inliers.size ());
+
+  Eigen::VectorXf coefficients;
+  sac.getModelCoefficients (coefficients);
+  EXPECT_NEAR (1.0f, std::abs (coefficients[2]), 1e-3f);
+  EXPECT_NEAR (0.5f, std::abs (coefficients[3]), 1e-2f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Estimators which are meant to work with a loose threshold and few hypotheses
+template <typename SacT>
+class SacRobustTest : public ::testing::Test {};
+
+using sacRobustTypes = ::testing::Types<
+  MagsacSampleConsensus<PointXYZ>,
+  GraphCutRandomSampleConsensus<PointXYZ>
+>;
+TYPED_TEST_SUITE(SacRobustTest, sacRobustTypes);
+
+TYPED_TEST(SacRobustTest, NoisyPlane)
+{
+  // Plane z = 0.5 with Gaussian noise (sigma = 0.002) among uniformly distributed outliers (20 % inliers)
+  const std::size_t nr_inliers = 2000;
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal> normals;
+  createRandomCloud (*cloud, normals, 5 * nr_inliers);
+  std::mt19937 rng (7);
+  std::normal_distribution<float> noise (0.0f, 0.002f);
+  for (std::size_t i = 0; i < nr_inliers; ++i)
+    (*cloud)[i].z = 0.5f + noise (rng);
+
+  typename SampleConsensusModelPlane<PointXYZ>::Ptr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+  TypeParam sac (model, 0.02);
+  ASSERT_TRUE (sac.computeModel ());
+
+  Eigen::VectorXf coefficients;
+  sac.getModelCoefficients (coefficients);
+  EXPECT_NEAR (1.0f, std::abs (coefficients[2]), 1e-4f);
+  EXPECT_NEAR (0.5f, std::abs (coefficients[3]), 1e-3f);
+
+  Indices inliers;
+  sac.getInliers (inliers);
+  EXPECT_LE (nr_inliers - 10, inliers.size ());
+  EXPECT_GT (nr_inliers + 250, inliers.size ());
+}
+
+TYPED_TEST(SacRobustTest, Registration)
+{
+  // 70 % of the target points are the source points moved by a rigid transformation
+  const std::size_t nr_points = 1000;
+  PointCloud<PointXYZ>::Ptr source (new PointCloud<PointXYZ>);
+  PointCloud<PointXYZ>::Ptr target (new PointCloud<PointXYZ>);
+  PointCloud<Normal> normals;
+  createRandomCloud (*source, normals, nr_points);
+  createRandomCloud (*target, normals, nr_points + 1);
+  target->resize (nr_points);
+
+  Eigen::Affine3f transform = Eigen::Translation3f (0.1f, -0.2f, 0.3f) *
+                              Eigen::AngleAxisf (0.5f, Eigen::Vector3f (1.0f, 2.0f, 3.0f).normalized ());
+  for (std::size_t i = 0; i < 7 * nr_points / 10; ++i)
+    (*target)[i].getVector3fMap () = transform * (*source)[i].getVector3fMap ();
+
+  typename SampleConsensusModelRegistration<PointXYZ>::Ptr model (new SampleConsensusModelRegistration<PointXYZ> (source));
+  model->setInputTarget (target);
+  TypeParam sac (model, 0.01);
+  ASSERT_TRUE (sac.computeModel ());
+
+  Eigen::VectorXf coefficients;
+  sac.getModelCoefficients (coefficients);
+  const Eigen::Matrix4f estimated = Eigen::Map<const Eigen::Matrix4f> (coefficients.data ()).transpose ();
+  EXPECT_TRUE (estimated.isApprox (transform.matrix (), 1e-4f));
+
+  Indices inliers;
+  sac.getInliers (inliers);
+  // The correspondences are not spatially coherent, so GC-RANSAC may drop a few inliers surrounded by outliers
+  EXPECT_GE (7 * nr_points / 10, inliers.size ());
+  EXPECT_LT (7 * nr_points / 10 - 10, inliers.size ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -90,7 +384,9 @@ using sacTypes = ::testing::Types<
   MEstimatorSampleConsensus<PointXYZ>,
   RandomizedRandomSampleConsensus<PointXYZ>,
   RandomizedMEstimatorSampleConsensus<PointXYZ>,
-  MaximumLikelihoodSampleConsensus<PointXYZ>
+  MaximumLikelihoodSampleConsensus<PointXYZ>,
+  MagsacSampleConsensus<PointXYZ>,
+  GraphCutRandomSampleConsensus<PointXYZ>
 >;
 TYPED_TEST_SUITE(SacTest, sacTypes);
 
@@ -40,15 +40,22 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
+#include <pcl/common/parallel.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/search/search.h>
 #include <pcl/features/normal_3d.h>
 
+#include <pcl/segmentation/conditional_euclidean_clustering.h>
+#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 #include <pcl/segmentation/region_growing.h>
 #include <pcl/segmentation/region_growing_rgb.h>
 #include <pcl/segmentation/min_cut_segmentation.h>
+#include <pcl/segmentation/sac_multi_plane_segmentation.h>
+#include <pcl/segmentation/supervoxel_clustering.h>
+
+#include <random>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -201,6 +208,60 @@ TEST (RegionGrowingTest, SegmentFromPoint)
   EXPECT_NE (0, cluster.indices.size());
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingTest, UnionFind)
+{
+  // Use the pool even on machines with fewer cores
+  const pcl::parallel::ScopedThreadBudget budget (4);
+
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+  rg.setInputCloud (cloud_);
+  rg.setInputNormals (normals_);
+  std::vector <pcl::PointIndices> clusters;
+  rg.extract (clusters);
+
+  // No seed of a segment reaches another segment on this cloud, the segments are hence the same
+  rg.setUnionFindFlag (true);
+  EXPECT_TRUE (rg.getUnionFindFlag ());
+  rg.setNumberOfThreads (4);
+  EXPECT_EQ (4, rg.getNumberOfThreads ());
+  std::vector <pcl::PointIndices> union_find_clusters;
+  rg.extract (union_find_clusters);
+  ASSERT_EQ (clusters.size (), union_find_clusters.size ());
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+    EXPECT_EQ (clusters[i].indices, union_find_clusters[i].indices);
+
+  // Otherwise some segments are merged, the result does not depend on the number of threads
+  rg.setInputCloud (another_cloud_);
+  rg.setInputNormals (another_normals_);
+  rg.setUnionFindFlag (false);
+  rg.setNumberOfThreads (1);
+  rg.extract (clusters);
+  rg.setUnionFindFlag (true);
+  rg.extract (union_find_clusters);
+  EXPECT_LE (union_find_clusters.size (), clusters.size ());
+  EXPECT_NE (0, union_find_clusters.size ());
+  rg.setNumberOfThreads (4);
+  rg.extract (clusters);
+  ASSERT_EQ (clusters.size (), union_find_clusters.size ());
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+    EXPECT_EQ (clusters[i].indices, union_find_clusters[i].indices);
+
+  RegionGrowingRGB<pcl::PointXYZRGB> rg_rgb;
+  rg_rgb.setInputCloud (colored_cloud);
+  rg_rgb.setDistanceThreshold (10);
+  rg_rgb.setRegionColorThreshold (5);
+  rg_rgb.setPointColorThreshold (6);
+  rg_rgb.setMinClusterSize (20);
+  rg_rgb.extract (clusters);
+  rg_rgb.setUnionFindFlag (true);
+  rg_rgb.setNumberOfThreads (4);
+  rg_rgb.extract (union_find_clusters);
+  ASSERT_EQ (clusters.size (), union_find_clusters.size ());
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+    EXPECT_EQ (clusters[i].indices, union_find_clusters[i].indices);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (MinCutSegmentationTest, Segment)
 {
@@ -385,6 +446,403 @@ TEST (ExtractPolygonalPrism, Segmentation)
   EXPECT_EQ (static_cast<int> (output.indices.size ()), 0);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Floor and two walls meeting in a corner, on a 2 cm grid, plus uniformly distributed clutter
+TEST (SACMultiPlaneSegmentation, Segment)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 100; ++i)
+    for (int j = 0; j < 100; ++j)
+      cloud->push_back (PointXYZ (0.02f * static_cast<float> (i), 0.02f * static_cast<float> (j), 0.0f));
+  for (int i = 0; i < 100; ++i)
+    for (int j = 1; j <= 50; ++j)
+    {
+      cloud->push_back (PointXYZ (0.0f, 0.02f * static_cast<float> (i) + 0.01f, 0.02f * static_cast<float> (j)));
+      cloud->push_back (PointXYZ (0.02f * static_cast<float> (i) + 0.01f, 0.0f, 0.02f * static_cast<float> (j)));
+    }
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> dist (0.1f, 1.0f);
+  for (int i = 0; i < 1000; ++i)
+    cloud->push_back (PointXYZ (2.0f * dist (rng), 2.0f * dist (rng), dist (rng)));
+
+  SACMultiPlaneSegmentation<PointXYZ> mps;
+  mps.setInputCloud (cloud);
+  mps.setDistanceThreshold (0.005);
+  mps.setMinInliers (500);
+  mps.setNumberOfThreads (2);
+  std::vector<ModelCoefficients> coefficients;
+  std::vector<PointIndices> inliers;
+  mps.segment (coefficients, inliers);
+
+  ASSERT_EQ (3, coefficients.size ());
+  ASSERT_EQ (3, inliers.size ());
+  // The floor is the largest plane
+  EXPECT_NEAR (1.0f, std::abs (coefficients[0].values[2]), 1e-3f);
+  EXPECT_EQ (10000, inliers[0].indices.size ());
+  for (std::size_t i = 1; i < 3; ++i)
+  {
+    EXPECT_NEAR (0.0f, coefficients[i].values[2], 1e-3f);
+    EXPECT_NEAR (0.0f, coefficients[i].values[3], 1e-3f);
+    EXPECT_LE (5000, inliers[i].indices.size ());
+    EXPECT_GT (5100, inliers[i].indices.size ());
+  }
+
+  // Limit the number of planes
+  mps.setMaxNumberOfPlanes (2);
+  mps.segment (coefficients, inliers);
+  EXPECT_EQ (2, coefficients.size ());
+  EXPECT_EQ (2, inliers.size ());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Two coplanar patches 1 m apart
+TEST (SACMultiPlaneSegmentation, ClusterTolerance)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 50; ++i)
+    for (int j = 0; j < 50; ++j)
+    {
+      cloud->push_back (PointXYZ (0.02f * static_cast<float> (i), 0.02f * static_cast<float> (j), 0.5f));
+      cloud->push_back (PointXYZ (2.0f + 0.02f * static_cast<float> (i), 0.02f * static_cast<float> (j), 0.5f));
+    }
+
+  SACMultiPlaneSegmentation<PointXYZ> mps;
+  mps.setInputCloud (cloud);
+  mps.setDistanceThreshold (0.005);
+  mps.setMinInliers (100);
+  std::vector<ModelCoefficients> coefficients;
+  std::vector<PointIndices> inliers;
+  mps.segment (coefficients, inliers);
+  ASSERT_EQ (1, inliers.size ());
+  EXPECT_EQ (5000, inliers[0].indices.size ());
+
+  mps.setClusterTolerance (0.05);
+  mps.segment (coefficients, inliers);
+  ASSERT_EQ (2, inliers.size ());
+  EXPECT_EQ (2500, inliers[0].indices.size ());
+  EXPECT_EQ (2500, inliers[1].indices.size ());
+  EXPECT_NEAR (0.5f, std::abs (coefficients[1].values[3]), 1e-4f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Many small patches on the plane z = 0, which together have more points than the compact wall x = 3
+TEST (SACMultiPlaneSegmentation, FragmentedPlane)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (int p = 0; p < 25; ++p)
+    for (int i = 0; i < 10; ++i)
+      for (int j = 0; j < 10; ++j)
+        cloud->push_back (PointXYZ (0.5f * static_cast<float> (p % 5) + 0.02f * static_cast<float> (i),
+                                    0.5f * static_cast<float> (p / 5) + 0.02f * static_cast<float> (j), 0.0f));
+  for (int i = 0; i < 40; ++i)
+    for (int j = 0; j < 30; ++j)
+      cloud->push_back (PointXYZ (3.0f, 0.02f * static_cast<float> (i), 0.1f + 0.02f * static_cast<float> (j)));
+
+  SACMultiPlaneSegmentation<PointXYZ> mps;
+  mps.setInputCloud (cloud);
+  mps.setDistanceThreshold (0.005);
+  mps.setMinInliers (500);
+  mps.setClusterTolerance (0.05);
+  std::vector<ModelCoefficients> coefficients;
+  std::vector<PointIndices> inliers;
+  mps.segment (coefficients, inliers);
+  // The floor is found first, but none of its patches is large enough: the wall is found next
+  ASSERT_EQ (1, inliers.size ());
+  EXPECT_EQ (1200, inliers[0].indices.size ());
+  EXPECT_NEAR (1.0f, std::abs (coefficients[0].values[0]), 1e-4f);
+
+  // Give up after the floor
+  mps.setMaxFragmentedPlanes (0);
+  mps.segment (coefficients, inliers);
+  EXPECT_TRUE (inliers.empty ());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, VoxelGridMatchesSearch)
+{
+  const pcl::parallel::ScopedThreadBudget budget (4);
+  // Gaussian blobs of different sizes, some of them touching, plus sparse noise and a few NaNs (not indexed,
+  // as radiusSearch does not accept them)
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> center_dist (-2.0f, 2.0f);
+  for (int c = 0; c < 20; ++c)
+  {
+    const Eigen::Vector3f center (center_dist (rng), center_dist (rng), center_dist (rng));
+    std::normal_distribution<float> dist (0.0f, 0.02f * static_cast<float> (c % 5 + 1));
+    for (int i = 0; i < 100 * (c % 4 + 1); ++i)
+      cloud->push_back (PointXYZ (center[0] + dist (rng), center[1] + dist (rng), center[2] + dist (rng)));
+  }
+  for (int i = 0; i < 200; ++i)
+    cloud->push_back (PointXYZ (center_dist (rng), center_dist (rng), center_dist (rng)));
+  for (int i = 0; i < 5; ++i)
+    (*cloud)[194 * i + 1].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud->is_dense = false;
+
+  // Every other point
+  IndicesPtr indices (new Indices);
+  for (int i = 0; i < static_cast<int> (cloud->size ()); i += 2)
+    indices->push_back (i);
+
+  for (const float tolerance : {0.02f, 0.05f, 0.2f})
+  {
+    std::vector<PointIndices> expected;
+    search::KdTree<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ>);
+    tree->setInputCloud (cloud, indices);
+    extractEuclideanClusters (*cloud, *indices, tree, tolerance, expected, 3, 500);
+    ASSERT_LT (1, expected.size ());
+
+    for (const unsigned int nr_threads : {1, 4})
+    {
+      std::vector<PointIndices> clusters;
+      extractEuclideanClustersVoxelGrid (*cloud, *indices, tolerance, clusters, 3, 500, nr_threads);
+      ASSERT_EQ (expected.size (), clusters.size ());
+      for (std::size_t i = 0; i < expected.size (); ++i)
+        EXPECT_EQ (expected[i].indices, clusters[i].indices);
+    }
+  }
+
+  EuclideanClusterExtraction<PointXYZ> ec;
+  ec.setInputCloud (cloud);
+  ec.setIndices (indices);
+  ec.setClusterTolerance (0.05);
+  ec.setMinClusterSize (10);
+  std::vector<PointIndices> expected, clusters;
+  ec.extract (expected);
+  ec.setNumberOfThreads (0);
+  ec.extract (clusters);
+  ASSERT_EQ (expected.size (), clusters.size ());
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    EXPECT_EQ (expected[i].indices.size (), clusters[i].indices.size ());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, VoxelGridDuplicateIndices)
+{
+  // Two clusters of 3 and 5 points. Listing every point of the first one twice must not make it reach the
+  // minimum size of 4, nor duplicate its points in the output.
+  PointCloud<PointXYZ> cloud;
+  for (int i = 0; i < 3; ++i)
+    cloud.push_back (PointXYZ (0.01f * i, 0.0f, 0.0f));
+  for (int i = 0; i < 5; ++i)
+    cloud.push_back (PointXYZ (1.0f + 0.01f * i, 0.0f, 0.0f));
+  const std::vector<int> indices {0, 1, 2, 3, 4, 5, 6, 7, 2, 1, 0, 7};
+
+  std::vector<PointIndices> clusters;
+  extractEuclideanClustersVoxelGrid (cloud, indices, 0.02f, clusters, 4);
+  ASSERT_EQ (1, clusters.size ());
+  EXPECT_EQ (std::vector<int> ({3, 4, 5, 6, 7}), clusters[0].indices);
+
+  clusters.clear ();
+  extractEuclideanClustersVoxelGrid (cloud, indices, 0.02f, clusters, 1, 4);
+  ASSERT_EQ (1, clusters.size ());
+  EXPECT_EQ (std::vector<int> ({0, 1, 2}), clusters[0].indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// An organized cloud of a background at depth 2 split by a column of NaNs, and two boxes in front of it
+PointCloud<PointXYZ>::Ptr
+makeOrganizedScene ()
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (80, 60));
+  for (std::uint32_t v = 0; v < cloud->height; ++v)
+    for (std::uint32_t u = 0; u < cloud->width; ++u)
+    {
+      PointXYZ &point = cloud->at (u, v);
+      point.x = 0.01f * u;
+      point.y = 0.01f * v;
+      point.z = 2.0f;
+      if (u >= 10 && u < 30 && v >= 10 && v < 25)
+        point.z = 1.0f;
+      else if (u >= 45 && u < 70 && v >= 30 && v < 50)
+        point.z = 1.5f;
+      else if (u == 40)
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  return (cloud);
+}
+
+// The search methods expect finite points
+IndicesPtr
+finiteIndices (const PointCloud<PointXYZ> &cloud)
+{
+  IndicesPtr indices (new std::vector<int>);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    if (isFinite (cloud.points[i]))
+      indices->push_back (static_cast<int> (i));
+  return (indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, Organized)
+{
+  const pcl::parallel::ScopedThreadBudget budget (4);
+  const PointCloud<PointXYZ>::Ptr cloud = makeOrganizedScene ();
+
+  // The window covers the tolerance, so the clusters are the same as with a search method
+  const std::vector<std::pair<float, unsigned int> > settings = {{0.015f, 1}, {0.025f, 2}};
+  for (const auto &tolerance_radius : settings)
+  {
+    EuclideanClusterExtraction<PointXYZ> ec;
+    ec.setInputCloud (cloud);
+    ec.setIndices (finiteIndices (*cloud));
+    ec.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+    ec.setClusterTolerance (tolerance_radius.first);
+    ec.setMinClusterSize (400);
+    // The image-based implementation is used by default for organized clouds
+    EXPECT_GT (0, ec.getOrganizedWindowRadius ());
+    ec.setOrganizedWindowRadius (0);
+    std::vector<PointIndices> expected;
+    ec.extract (expected);
+
+    // An explicit window, and the default one picked from the data
+    for (const int window_radius : {static_cast<int> (tolerance_radius.second), -1})
+      for (const int nr_threads : {-1, 0})
+      {
+        std::vector<PointIndices> clusters;
+        ec.setOrganizedWindowRadius (window_radius);
+        ec.setNumberOfThreads (nr_threads);
+        ec.extract (clusters);
+        ASSERT_EQ (expected.size (), clusters.size ());
+        for (std::size_t i = 0; i < expected.size (); ++i)
+          EXPECT_EQ (expected[i].indices, clusters[i].indices);
+      }
+  }
+
+  // The window picked from the data covers the tolerance at the spacing of the pixels, and is bounded
+  const std::vector<int> all = *finiteIndices (*cloud);
+  EXPECT_EQ (2, detail::getOrganizedWindowRadius (*cloud, all, 0.015f, 4));
+  EXPECT_EQ (1, detail::getOrganizedWindowRadius (*cloud, all, 0.005f, 4));
+  EXPECT_EQ (4, detail::getOrganizedWindowRadius (*cloud, all, 1.0f, 4));
+
+  // The image-based clusters of a subset of the points, in the order of their first point
+  std::vector<int> indices;
+  for (int i = static_cast<int> (cloud->size ()) - 1; i >= 40 * 80; --i)
+    indices.push_back (i);
+  std::vector<PointIndices> clusters;
+  extractEuclideanClustersOrganized (*cloud, indices, 0.015f, clusters, 2);
+  ASSERT_EQ (3, clusters.size ());
+  EXPECT_EQ (39 * 20 - 25 * 10, clusters[0].indices.size ());
+  EXPECT_EQ (40 * 20, clusters[1].indices.size ());
+  EXPECT_EQ (25 * 10, clusters[2].indices.size ());
+  EXPECT_TRUE (std::is_sorted (clusters[0].indices.begin (), clusters[0].indices.end ()));
+
+  // An unorganized cloud is rejected
+  clusters.clear ();
+  PointCloud<PointXYZ> unorganized (*cloud);
+  unorganized.width = static_cast<std::uint32_t> (unorganized.size ());
+  unorganized.height = 1;
+  extractEuclideanClustersOrganized (unorganized, indices, 0.015f, clusters, 2);
+  EXPECT_TRUE (clusters.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+inSameHalf (const PointXYZ &a, const PointXYZ &b, float)
+{
+  return ((a.y < 0.3f) == (b.y < 0.3f));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ConditionalEuclideanClustering, Organized)
+{
+  const PointCloud<PointXYZ>::Ptr cloud = makeOrganizedScene ();
+  const auto sorted_clusters = [] (IndicesClusters clusters)
+  {
+    for (auto &cluster : clusters)
+      std::sort (cluster.indices.begin (), cluster.indices.end ());
+    std::sort (clusters.begin (), clusters.end (), [] (const PointIndices &a, const PointIndices &b)
+    {
+      return (a.indices < b.indices);
+    });
+    return (clusters);
+  };
+
+  ConditionalEuclideanClustering<PointXYZ> cec (true);
+  cec.setInputCloud (cloud);
+  cec.setIndices (finiteIndices (*cloud));
+  cec.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+  cec.setConditionFunction (&inSameHalf);
+  cec.setClusterTolerance (0.015f);
+  cec.setMinClusterSize (300);
+  cec.setMaxClusterSize (1000);
+  IndicesClusters expected, clusters;
+  IndicesClustersPtr expected_small, expected_large, small, large;
+  cec.segment (expected);
+  cec.getRemovedClusters (expected_small, expected_large);
+  expected = sorted_clusters (expected);
+  const IndicesClusters expected_small_sorted = sorted_clusters (*expected_small);
+  const IndicesClusters expected_large_sorted = sorted_clusters (*expected_large);
+
+  cec.setOrganizedWindowRadius (1);
+  EXPECT_EQ (1, cec.getOrganizedWindowRadius ());
+  cec.segment (clusters);
+  cec.getRemovedClusters (small, large);
+  ASSERT_FALSE (expected.empty ());
+  EXPECT_EQ (expected.size () + expected_small_sorted.size () + expected_large_sorted.size (),
+             clusters.size () + small->size () + large->size ());
+  const IndicesClusters sorted = sorted_clusters (clusters);
+  ASSERT_EQ (expected.size (), sorted.size ());
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    EXPECT_EQ (expected[i].indices, sorted[i].indices);
+  const IndicesClusters small_sorted = sorted_clusters (*small);
+  ASSERT_EQ (expected_small_sorted.size (), small_sorted.size ());
+  for (std::size_t i = 0; i < small_sorted.size (); ++i)
+    EXPECT_EQ (expected_small_sorted[i].indices, small_sorted[i].indices);
+  const IndicesClusters large_sorted = sorted_clusters (*large);
+  ASSERT_EQ (expected_large_sorted.size (), large_sorted.size ());
+  for (std::size_t i = 0; i < large_sorted.size (); ++i)
+    EXPECT_EQ (expected_large_sorted[i].indices, large_sorted[i].indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SupervoxelClustering, MultipleThreads)
+{
+  const pcl::parallel::ScopedThreadBudget budget (4);
+
+  const auto segment = [] (unsigned int nr_threads, std::map<std::uint32_t, Supervoxel<PointXYZRGB>::Ptr> &clusters)
+  {
+    SupervoxelClustering<PointXYZRGB> super (0.008f, 0.1f);
+    super.setInputCloud (colored_cloud);
+    super.setColorImportance (0.2f);
+    super.setSpatialImportance (0.4f);
+    super.setNormalImportance (1.0f);
+    super.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (nr_threads, super.getNumberOfThreads ());
+    super.extract (clusters);
+    return (super.getVoxelCentroidCloud ());
+  };
+
+  std::map<std::uint32_t, Supervoxel<PointXYZRGB>::Ptr> sequential, two, four;
+  const auto voxels = segment (1, sequential);
+  const auto voxels_two = segment (2, two);
+  const auto voxels_four = segment (4, four);
+
+  // The voxelization does not depend on the number of threads
+  ASSERT_EQ (voxels->size (), voxels_two->size ());
+  for (std::size_t i = 0; i < voxels->size (); ++i)
+  {
+    EXPECT_EQ (voxels->points[i].x, voxels_two->points[i].x);
+    EXPECT_EQ (voxels->points[i].y, voxels_two->points[i].y);
+    EXPECT_EQ (voxels->points[i].z, voxels_two->points[i].z);
+    EXPECT_EQ (voxels->points[i].rgba, voxels_two->points[i].rgba);
+  }
+
+  // The concurrent expansion differs slightly from the sequential one, but not from itself
+  ASSERT_FALSE (two.empty ());
+  EXPECT_NEAR (static_cast<double> (sequential.size ()), static_cast<double> (two.size ()), 0.1 * sequential.size ());
+  ASSERT_EQ (two.size (), four.size ());
+  std::size_t voxel_count = 0;
+  for (const auto &label_supervoxel : two)
+  {
+    const auto it = four.find (label_supervoxel.first);
+    ASSERT_TRUE (it != four.end ());
+    EXPECT_EQ (label_supervoxel.second->voxels_->size (), it->second->voxels_->size ());
+    voxel_count += label_supervoxel.second->voxels_->size ();
+  }
+  EXPECT_LE (voxel_count, voxels->size ());
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
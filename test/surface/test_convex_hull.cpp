@@ -39,6 +39,7 @@
 
 #include <pcl/test/gtest.h>
 
+#include <limits>
 #include <random>
 
 #include <pcl/point_types.h>
@@ -484,6 +485,116 @@ TEST (PCL, ConvexHull_4points)
   EXPECT_NEAR (convex_hull.getTotalArea (), 1.0f, 1e-6);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ConvexHull_2dPrefilter)
+{
+  // Points in a square, and the corners of a larger one
+  pcl::PointCloud<pcl::PointXYZ>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZ> ());
+  std::mt19937 rng (12345u);
+  std::uniform_real_distribution<float> rd (-1.0f, 1.0f);
+  for (int i = 0; i < 100000; ++i)
+    input_cloud->push_back (pcl::PointXYZ (rd (rng), rd (rng), 0.5f));
+  const std::vector<int> corners = {12345, 23456, 34567, 45678};
+  input_cloud->points[corners[0]] = pcl::PointXYZ (-1.5f, -1.5f, 0.5f);
+  input_cloud->points[corners[1]] = pcl::PointXYZ (1.5f, -1.5f, 0.5f);
+  input_cloud->points[corners[2]] = pcl::PointXYZ (1.5f, 1.5f, 0.5f);
+  input_cloud->points[corners[3]] = pcl::PointXYZ (-1.5f, 1.5f, 0.5f);
+
+  for (const unsigned int threads : {1u, 4u})
+  {
+    pcl::PointCloud<pcl::PointXYZ> hull;
+    std::vector<pcl::Vertices> polygons;
+    pcl::ConvexHull<pcl::PointXYZ> chull;
+    chull.setInputCloud (input_cloud);
+    chull.setComputeAreaVolume (true);
+    chull.setNumberOfThreads (threads);
+    chull.reconstruct (hull, polygons);
+
+    ASSERT_EQ (2, chull.getDimension ());
+    ASSERT_EQ (1, polygons.size ());
+    EXPECT_EQ (4, polygons[0].vertices.size ());
+    EXPECT_NEAR (chull.getTotalArea (), 9.0, 1e-4);
+
+    pcl::PointIndices hull_indices;
+    chull.getHullPointIndices (hull_indices);
+    std::sort (hull_indices.indices.begin (), hull_indices.indices.end ());
+    EXPECT_EQ (corners, hull_indices.indices);
+  }
+
+  // Invalid points are ignored
+  const float nan = std::numeric_limits<float>::quiet_NaN ();
+  for (const int i : {1000, 2000, 3000})
+    input_cloud->points[i] = pcl::PointXYZ (nan, nan, nan);
+  input_cloud->is_dense = false;
+  pcl::PointCloud<pcl::PointXYZ> hull;
+  std::vector<pcl::Vertices> polygons;
+  pcl::ConvexHull<pcl::PointXYZ> chull;
+  chull.setInputCloud (input_cloud);
+  chull.setDimension (2);
+  chull.setComputeAreaVolume (true);
+  chull.reconstruct (hull, polygons);
+
+  ASSERT_EQ (1, polygons.size ());
+  EXPECT_EQ (4, polygons[0].vertices.size ());
+  EXPECT_NEAR (chull.getTotalArea (), 9.0, 1e-4);
+  pcl::PointIndices hull_indices;
+  chull.getHullPointIndices (hull_indices);
+  std::sort (hull_indices.indices.begin (), hull_indices.indices.end ());
+  EXPECT_EQ (corners, hull_indices.indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ConvexHull_3dPrefilter)
+{
+  // Points in a ball
+  pcl::PointCloud<pcl::PointXYZ>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZ> ());
+  std::mt19937 rng (12345u);
+  std::uniform_real_distribution<float> rd (-1.0f, 1.0f);
+  while (input_cloud->size () < 20000)
+  {
+    const pcl::PointXYZ p (rd (rng), rd (rng), rd (rng));
+    if (p.getVector3fMap ().squaredNorm () <= 1.0f)
+      input_cloud->push_back (p);
+  }
+
+  std::vector<int> reference;
+  for (const unsigned int threads : {1u, 4u})
+  {
+    pcl::PointCloud<pcl::PointXYZ> hull;
+    std::vector<pcl::Vertices> polygons;
+    pcl::ConvexHull<pcl::PointXYZ> chull;
+    chull.setInputCloud (input_cloud);
+    chull.setNumberOfThreads (threads);
+    chull.reconstruct (hull, polygons);
+    ASSERT_EQ (3, chull.getDimension ());
+    ASSERT_FALSE (polygons.empty ());
+
+    // No input point may lie outside of the hull, which would be the case if a hull vertex had been discarded
+    Eigen::Vector3f centroid = Eigen::Vector3f::Zero ();
+    for (const auto &point : hull.points)
+      centroid += point.getVector3fMap ();
+    centroid /= static_cast<float> (hull.size ());
+    for (const auto &polygon : polygons)
+    {
+      const Eigen::Vector3f p0 = hull[polygon.vertices[0]].getVector3fMap ();
+      Eigen::Vector3f normal = (hull[polygon.vertices[1]].getVector3fMap () - p0).cross (hull[polygon.vertices[2]].getVector3fMap () - p0);
+      if (normal.dot (centroid - p0) > 0)
+        normal = -normal;
+      normal.normalize ();
+      for (const auto &point : input_cloud->points)
+        ASSERT_LE (normal.dot (point.getVector3fMap () - p0), 1e-5f);
+    }
+
+    pcl::PointIndices hull_indices;
+    chull.getHullPointIndices (hull_indices);
+    std::sort (hull_indices.indices.begin (), hull_indices.indices.end ());
+    if (reference.empty ())
+      reference = hull_indices.indices;
+    else
+      EXPECT_EQ (reference, hull_indices.indices);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -49,6 +49,8 @@
 #include <pcl/io/obj_io.h>
 #include <pcl/TextureMesh.h>
 #include <pcl/surface/texture_mapping.h>
+
+#include <map>
 using namespace pcl;
 using namespace pcl::io;
 using namespace std;
@@ -239,6 +241,82 @@ TEST (PCL, UpdateMesh_With_TextureMapping)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GreedyProjectionTriangulation_Tiled)
+{
+  GreedyProjectionTriangulation<PointNormal> gp3;
+  gp3.setInputCloud (cloud_with_normals);
+  gp3.setSearchRadius (0.025);
+  gp3.setMu (2.5);
+  gp3.setMaximumNearestNeighbors (100);
+  PolygonMesh reference;
+  gp3.reconstruct (reference);
+
+  gp3.setTileSize (0.06);
+  EXPECT_EQ (gp3.getTileSize (), 0.06);
+  PolygonMesh serial;
+  gp3.reconstruct (serial);
+  const std::vector<int> parts = gp3.getPartIDs ();
+  const std::vector<int> states = gp3.getPointStates ();
+
+  gp3.setNumberOfThreads (4);
+  PolygonMesh parallel;
+  gp3.reconstruct (parallel);
+
+  // The tiles are independent of the number of threads
+  ASSERT_EQ (parallel.polygons.size (), serial.polygons.size ());
+  for (std::size_t i = 0; i < serial.polygons.size (); ++i)
+    EXPECT_EQ (parallel.polygons[i].vertices, serial.polygons[i].vertices);
+  EXPECT_EQ (gp3.getPartIDs (), parts);
+  EXPECT_EQ (gp3.getPointStates (), states);
+  EXPECT_EQ (parts.size (), cloud_with_normals->size ());
+
+  // The seams are stitched without any edge shared by more than two triangles
+  EXPECT_GT (serial.polygons.size (), reference.polygons.size () / 2);
+  std::map<std::pair<std::uint32_t, std::uint32_t>, int> nr_triangles;
+  for (const auto &polygon : serial.polygons)
+  {
+    ASSERT_EQ (polygon.vertices.size (), 3);
+    for (std::size_t k = 0; k < 3; ++k)
+    {
+      const std::uint32_t a = polygon.vertices[k], b = polygon.vertices[(k + 1) % 3];
+      EXPECT_LT (a, cloud_with_normals->size ());
+      ++nr_triangles[std::make_pair ((std::min) (a, b), (std::max) (a, b))];
+    }
+  }
+  for (const auto &edge : nr_triangles)
+    EXPECT_LE (edge.second, 2) << "edge " << edge.first.first << "-" << edge.first.second;
+
+  // Streaming the tiles gives the same mesh
+  PointNormal min_pt, max_pt;
+  getMinMax3D (*cloud_with_normals, min_pt, max_pt);
+  std::size_t nr_requests = 0;
+  const auto source = [&nr_requests] (const Eigen::Vector3f &box_min, const Eigen::Vector3f &box_max,
+                                      PointCloud<PointNormal> &points, std::vector<int> &ids)
+  {
+    ++nr_requests;
+    for (std::size_t i = 0; i < cloud_with_normals->size (); ++i)
+    {
+      const Eigen::Vector3f p = (*cloud_with_normals)[i].getVector3fMap ();
+      if ((p.array () >= box_min.array ()).all () && (p.array () <= box_max.array ()).all ())
+      {
+        points.push_back ((*cloud_with_normals)[i]);
+        ids.push_back (static_cast<int> (i));
+      }
+    }
+    return (true);
+  };
+  std::vector<Vertices> streamed;
+  ASSERT_TRUE (gp3.reconstructOutOfCore (source, min_pt.getVector3fMap (), max_pt.getVector3fMap (), streamed));
+  EXPECT_GT (nr_requests, 1);
+  ASSERT_EQ (streamed.size (), serial.polygons.size ());
+  for (std::size_t i = 0; i < serial.polygons.size (); ++i)
+    EXPECT_EQ (streamed[i].vertices, serial.polygons[i].vertices);
+
+  gp3.setTileSize (0);
+  EXPECT_FALSE (gp3.reconstructOutOfCore (source, min_pt.getVector3fMap (), max_pt.getVector3fMap (), streamed));
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
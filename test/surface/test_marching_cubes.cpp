@@ -48,6 +48,7 @@
 #include <pcl/surface/marching_cubes_hoppe.h>
 #include <pcl/surface/marching_cubes_rbf.h>
 #include <pcl/common/common.h>
+#include <pcl/common/parallel.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -100,6 +101,95 @@ TEST (PCL, MarchingCubesTest)
   EXPECT_EQ (vertices[vertices.size ()/2].vertices[2], 4277);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Hoppe's method on the full grid, even when far voxels are ignored
+template <typename PointNT>
+class DenseMarchingCubesHoppe : public MarchingCubesHoppe<PointNT>
+{
+  protected:
+    bool
+    usesNarrowBand () const override
+    { return false; }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesNarrowBand)
+{
+  const pcl::parallel::ScopedThreadBudget budget (4);
+
+  DenseMarchingCubesHoppe<PointNormal> dense;
+  dense.setIsoLevel (0);
+  dense.setGridResolution (50, 50, 50);
+  dense.setPercentageExtendGrid (0.3f);
+  dense.setDistanceIgnore (1e-4f);
+  dense.setInputCloud (cloud_with_normals);
+  PointCloud<PointNormal> expected_points;
+  std::vector<Vertices> expected_vertices;
+  dense.reconstruct (expected_points, expected_vertices);
+  ASSERT_FALSE (expected_vertices.empty ());
+
+  // The narrow band gives the same triangles, in the same order, for any number of threads
+  for (const unsigned int nr_threads : {1u, 4u})
+  {
+    MarchingCubesHoppe<PointNormal> hoppe (1e-4f, 0.3f, 0.0f);
+    hoppe.setGridResolution (50, 50, 50);
+    hoppe.setNumberOfThreads (nr_threads);
+    hoppe.setInputCloud (cloud_with_normals);
+    PointCloud<PointNormal> points;
+    std::vector<Vertices> vertices;
+    hoppe.reconstruct (points, vertices);
+
+    ASSERT_EQ (expected_points.size (), points.size ());
+    ASSERT_EQ (expected_vertices.size (), vertices.size ());
+    for (std::size_t i = 0; i < points.size (); ++i)
+    {
+      EXPECT_EQ (expected_points.points[i].x, points.points[i].x);
+      EXPECT_EQ (expected_points.points[i].y, points.points[i].y);
+      EXPECT_EQ (expected_points.points[i].z, points.points[i].z);
+    }
+    for (std::size_t i = 0; i < vertices.size (); ++i)
+      EXPECT_EQ (expected_vertices[i].vertices, vertices[i].vertices);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesMergeVertices)
+{
+  MarchingCubesHoppe<PointNormal> hoppe;
+  hoppe.setIsoLevel (0);
+  hoppe.setGridResolution (30, 30, 30);
+  hoppe.setPercentageExtendGrid (0.3f);
+  hoppe.setInputCloud (cloud_with_normals);
+  PointCloud<PointNormal> soup_points, points;
+  std::vector<Vertices> soup_vertices, vertices;
+  hoppe.reconstruct (soup_points, soup_vertices);
+
+  hoppe.setMergeVertices (true);
+  EXPECT_TRUE (hoppe.getMergeVertices ());
+  hoppe.setNumberOfThreads (0);
+  hoppe.reconstruct (points, vertices);
+
+  // Same triangles, which now share their vertices
+  ASSERT_EQ (soup_vertices.size (), vertices.size ());
+  EXPECT_LT (points.size (), soup_points.size () / 4);
+  std::vector<bool> used (points.size (), false);
+  for (std::size_t i = 0; i < vertices.size (); ++i)
+  {
+    ASSERT_EQ (3, vertices[i].vertices.size ());
+    EXPECT_NE (vertices[i].vertices[0], vertices[i].vertices[1]);
+    EXPECT_NE (vertices[i].vertices[1], vertices[i].vertices[2]);
+    EXPECT_NE (vertices[i].vertices[2], vertices[i].vertices[0]);
+    for (int j = 0; j < 3; ++j)
+    {
+      const PointNormal &point = points.points[vertices[i].vertices[j]];
+      const PointNormal &soup_point = soup_points.points[soup_vertices[i].vertices[j]];
+      EXPECT_NEAR ((point.getVector3fMap () - soup_point.getVector3fMap ()).norm (), 0.0f, 1e-5);
+      used[vertices[i].vertices[j]] = true;
+    }
+  }
+  EXPECT_EQ (points.size (), std::count (used.begin (), used.end (), true));
+}
+
 
 /* ---[ */
 int
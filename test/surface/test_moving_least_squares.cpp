@@ -142,7 +142,6 @@ TEST (PCL, MovingLeastSquares)
   EXPECT_NEAR (double (mls_normals->size ()), 29394, 2);
 }
 
-#ifdef _OPENMP
 TEST (PCL, MovingLeastSquaresOMP)
 {
   // Init objects
@@ -169,7 +168,52 @@ TEST (PCL, MovingLeastSquaresOMP)
   EXPECT_NEAR (std::abs (mls_normals->points[0].normal[2]), 0.795969, 1e-3);
   EXPECT_NEAR (mls_normals->points[0].curvature, 0.012019, 1e-3);
 }
-#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MovingLeastSquaresLeanUpsampling)
+{
+  // Voxel grid upsampling with the cached MLS results, computed by a single thread
+  PointCloud<PointNormal> reference;
+  MovingLeastSquares<PointXYZ, PointNormal> mls;
+  mls.setInputCloud (cloud);
+  mls.setComputeNormals (true);
+  mls.setPolynomialOrder (2);
+  mls.setSearchMethod (tree);
+  mls.setSearchRadius (0.03);
+  mls.setUpsamplingMethod (MovingLeastSquares<PointXYZ, PointNormal>::VOXEL_GRID_DILATION);
+  mls.setDilationIterations (2);
+  mls.setDilationVoxelSize (0.005f);
+  mls.process (reference);
+  EXPECT_EQ (mls.getMLSResults ().size (), cloud->size ());
+  ASSERT_GT (reference.size (), cloud->size ());
+
+  // Without cache, the fits are computed on demand and the output is the same, for any number of threads
+  for (const unsigned int threads : {1u, 4u})
+  {
+    PointCloud<PointNormal> lean;
+    mls.setCacheMLSResults (false);
+    mls.setNumberOfThreads (threads);
+    mls.process (lean);
+    EXPECT_TRUE (mls.getMLSResults ().empty ());
+    ASSERT_EQ (lean.size (), reference.size ());
+    ASSERT_EQ (mls.getCorrespondingIndices ()->indices.size (), reference.size ());
+    for (std::size_t i = 0; i < lean.size (); ++i)
+    {
+      EXPECT_EQ (lean[i].x, reference[i].x);
+      EXPECT_EQ (lean[i].y, reference[i].y);
+      EXPECT_EQ (lean[i].z, reference[i].z);
+      EXPECT_EQ (lean[i].curvature, reference[i].curvature);
+    }
+  }
+
+  // The cached results computed by several threads give the same output as well
+  PointCloud<PointNormal> cached;
+  mls.setCacheMLSResults (true);
+  mls.process (cached);
+  ASSERT_EQ (cached.size (), reference.size ());
+  for (std::size_t i = 0; i < cached.size (); ++i)
+    EXPECT_EQ (cached[i].getVector3fMap (), reference[i].getVector3fMap ());
+}
 
 /* ---[ */
 int
@@ -110,6 +110,115 @@ TEST (PCL, Organized)
   EXPECT_EQ (int (triangles.polygons.at (0).vertices.at (2)), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename MeshT> std::vector<std::vector<int> >
+getSortedFaces (const MeshT &mesh)
+{
+  std::vector<std::vector<int> > faces;
+  for (std::size_t f = 0; f < mesh.sizeFaces (); ++f)
+  {
+    const pcl::geometry::FaceIndex face (static_cast<int> (f));
+    if (mesh.isDeleted (face))
+      continue;
+    std::vector<int> vertices;
+    auto circ = mesh.getVertexAroundFaceCirculator (face);
+    const auto circ_end = circ;
+    do
+      vertices.push_back ((circ++).getTargetIndex ().get ());
+    while (circ != circ_end);
+    std::sort (vertices.begin (), vertices.end ());
+    faces.push_back (vertices);
+  }
+  std::sort (faces.begin (), faces.end ());
+  return (faces);
+}
+
+std::vector<std::vector<int> >
+getSortedFaces (const std::vector<pcl::Vertices> &polygons)
+{
+  std::vector<std::vector<int> > faces;
+  for (const auto &polygon : polygons)
+  {
+    std::vector<int> vertices (polygon.vertices.begin (), polygon.vertices.end ());
+    std::sort (vertices.begin (), vertices.end ());
+    faces.push_back (vertices);
+  }
+  std::sort (faces.begin (), faces.end ());
+  return (faces);
+}
+
+template <typename MeshT> void
+testIncremental (OrganizedFastMesh<PointXYZ>::TriangulationType type)
+{
+  // A wavy surface with a few holes
+  pcl::PointCloud<pcl::PointXYZ>::Ptr frame (new pcl::PointCloud<pcl::PointXYZ> (40, 30));
+  for (int y = 0; y < 30; ++y)
+    for (int x = 0; x < 40; ++x)
+    {
+      const float z = 2.0f + 0.1f * std::sin (0.3f * x) * std::cos (0.2f * y);
+      (*frame) (x, y) = pcl::PointXYZ (0.01f * x * z, 0.01f * y * z, z);
+    }
+  const float nan = std::numeric_limits<float>::quiet_NaN ();
+  for (const int index : {45, 46, 300, 301, 341, 1000})
+    frame->points[index] = pcl::PointXYZ (nan, nan, nan);
+
+  OrganizedFastMesh<PointXYZ> ofm;
+  ofm.setTriangulationType (type);
+  ofm.setTrianglePixelSize (1);
+  ofm.setMaxEdgeLength (0.1f);
+  ofm.setDepthChangeThreshold (0.01f);
+  ofm.setInputCloud (frame);
+
+  MeshT mesh;
+  std::vector<pcl::Vertices> polygons;
+  ofm.reconstructIncremental (mesh);
+  ofm.reconstruct (polygons);
+  ASSERT_EQ (frame->size (), mesh.sizeVertices ());
+  ASSERT_FALSE (polygons.empty ());
+  EXPECT_EQ (getSortedFaces (polygons), getSortedFaces (mesh));
+
+  // Move a patch away (breaking its edges to the rest), fill two holes and make new ones
+  for (int y = 10; y < 15; ++y)
+    for (int x = 20; x < 26; ++x)
+      (*frame) (x, y).getVector3fMap () *= 1.5f;
+  (*frame) (5, 1) = pcl::PointXYZ (0.1f, 0.02f, 2.0f);
+  (*frame) (6, 1) = pcl::PointXYZ (0.12f, 0.02f, 2.0f);
+  frame->points[500] = frame->points[800] = pcl::PointXYZ (nan, nan, nan);
+  ofm.reconstructIncremental (mesh);
+  ofm.reconstruct (polygons);
+  EXPECT_EQ (getSortedFaces (polygons), getSortedFaces (mesh));
+
+  // Changes below the threshold are ignored
+  const pcl::PointCloud<pcl::PointXYZ> meshed = *frame;
+  for (auto &point : frame->points)
+    point.z += 0.005f;
+  ofm.reconstructIncremental (mesh);
+  for (std::size_t i = 0; i < meshed.size (); ++i)
+    if (pcl::isFinite (meshed[i]))
+      EXPECT_EQ (meshed[i].z, mesh.getVertexDataCloud ()[i].z);
+  *frame = meshed;
+  ofm.reconstruct (polygons);
+  EXPECT_EQ (getSortedFaces (polygons), getSortedFaces (mesh));
+
+  // A new triangulation parameter applies to all the cells, not only to the ones of the changed points
+  const std::vector<std::vector<int> > faces = getSortedFaces (polygons);
+  ofm.setMaxEdgeLength (2.0f);
+  ofm.setAngleTolerance (-1.0f);
+  (*frame) (30, 20).z += 0.02f;
+  ofm.reconstructIncremental (mesh);
+  ofm.reconstruct (polygons);
+  EXPECT_NE (faces, getSortedFaces (polygons));
+  EXPECT_EQ (getSortedFaces (polygons), getSortedFaces (mesh));
+}
+
+TEST (PCL, OrganizedFastMeshIncremental)
+{
+  testIncremental<OrganizedFastMesh<PointXYZ>::TriangleMesh> (OrganizedFastMesh<PointXYZ>::TRIANGLE_RIGHT_CUT);
+  testIncremental<OrganizedFastMesh<PointXYZ>::TriangleMesh> (OrganizedFastMesh<PointXYZ>::TRIANGLE_LEFT_CUT);
+  testIncremental<OrganizedFastMesh<PointXYZ>::TriangleMesh> (OrganizedFastMesh<PointXYZ>::TRIANGLE_ADAPTIVE_CUT);
+  testIncremental<OrganizedFastMesh<PointXYZ>::QuadMesh> (OrganizedFastMesh<PointXYZ>::QUAD_MESH);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
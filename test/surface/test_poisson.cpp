@@ -44,6 +44,7 @@
 #include <pcl/io/vtk_io.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/surface/poisson.h>
+#include <pcl/surface/3rdparty/poisson4/multi_grid_octree_data.h>
 #include <pcl/common/common.h>
 
 using namespace pcl;
@@ -92,6 +93,86 @@ TEST (PCL, Poisson)
   EXPECT_EQ (mesh.polygons[1000].vertices[2], 715);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PoissonMultipleThreads)
+{
+  Poisson<PointNormal> poisson;
+  poisson.setInputCloud (cloud_with_normals);
+  PolygonMesh mesh_serial;
+  poisson.reconstruct (mesh_serial);
+
+  poisson.setThreads (4);
+  EXPECT_EQ (poisson.getThreads (), 4);
+  PolygonMesh mesh_parallel;
+  poisson.reconstruct (mesh_parallel);
+
+  // The vertex order depends on the scheduling, the surface itself does not
+  EXPECT_EQ (mesh_parallel.polygons.size (), mesh_serial.polygons.size ());
+  EXPECT_EQ (mesh_parallel.cloud.width * mesh_parallel.cloud.height, mesh_serial.cloud.width * mesh_serial.cloud.height);
+  for (const auto &polygon : mesh_parallel.polygons)
+  {
+    ASSERT_EQ (polygon.vertices.size (), 3);
+    for (const auto &vertex : polygon.vertices)
+      EXPECT_LT (vertex, mesh_parallel.cloud.width * mesh_parallel.cloud.height);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PoissonBoundedMemory)
+{
+  Poisson<PointNormal> poisson;
+  poisson.setInputCloud (cloud_with_normals);
+  poisson.setDepth (11);
+  poisson.setSolverDivide (10);
+  poisson.setIsoDivide (10);
+  poisson.setThreads (4);
+  PolygonMesh mesh;
+  poisson.reconstruct (mesh);
+
+  poisson.setBoundedMemory (true);
+  EXPECT_TRUE (poisson.getBoundedMemory ());
+  PolygonMesh mesh_bounded;
+  poisson.reconstruct (mesh_bounded);
+  // The divide depths are only capped for the bounded run, the configured ones are kept
+  EXPECT_EQ (poisson.getSolverDivide (), 10);
+  EXPECT_EQ (poisson.getIsoDivide (), 10);
+
+  ASSERT_FALSE (mesh_bounded.polygons.empty ());
+  // Block-wise solving only perturbs the solution slightly
+  EXPECT_NEAR (static_cast<double> (mesh_bounded.polygons.size ()), static_cast<double> (mesh.polygons.size ()),
+               0.05 * static_cast<double> (mesh.polygons.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PoissonBoundedMemoryThreads)
+{
+  // The per-thread scatter buffers are capped in bounded memory mode, whatever the number of threads
+  poisson::Octree<2> tree;
+  tree.threads = 16;
+  EXPECT_EQ (tree.scratchThreads (), 16);
+  tree.boundedMemory = true;
+  EXPECT_EQ (tree.scratchThreads (), poisson::Octree<2>::MAX_BOUNDED_SCRATCH_THREADS);
+  tree.threads = 2;
+  EXPECT_EQ (tree.scratchThreads (), 2);
+
+  // More threads than scratch buffers: the solver threads share the buffers, and the surface is the same
+  Poisson<PointNormal> poisson;
+  poisson.setInputCloud (cloud_with_normals);
+  poisson.setDepth (11);
+  poisson.setBoundedMemory (true);
+  poisson.setThreads (poisson::Octree<2>::MAX_BOUNDED_SCRATCH_THREADS);
+  PolygonMesh mesh;
+  poisson.reconstruct (mesh);
+
+  poisson.setThreads (4 * poisson::Octree<2>::MAX_BOUNDED_SCRATCH_THREADS);
+  PolygonMesh mesh_capped;
+  poisson.reconstruct (mesh_capped);
+
+  ASSERT_FALSE (mesh_capped.polygons.empty ());
+  EXPECT_EQ (mesh_capped.polygons.size (), mesh.polygons.size ());
+  EXPECT_EQ (mesh_capped.cloud.width * mesh_capped.cloud.height, mesh.cloud.width * mesh.cloud.height);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
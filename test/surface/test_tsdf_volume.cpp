@@ -0,0 +1,174 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/conversions.h>
+#include <pcl/surface/organized_fast_mesh.h>
+#include <pcl/surface/tsdf_volume.h>
+
+#include <cmath>
+
+using namespace pcl;
+
+const float focal_length = 100.0f;
+const unsigned int frame_width = 80;
+const unsigned int frame_height = 60;
+
+// A frame of a wall facing the camera at the given depth
+PointCloud<PointXYZ>
+makeWallFrame (float depth)
+{
+  PointCloud<PointXYZ> frame (frame_width, frame_height);
+  const float cx = (frame_width - 1) / 2.0f, cy = (frame_height - 1) / 2.0f;
+  for (unsigned int v = 0; v < frame_height; ++v)
+    for (unsigned int u = 0; u < frame_width; ++u)
+      frame (u, v) = PointXYZ ((u - cx) / focal_length * depth, (v - cy) / focal_length * depth, depth);
+  return (frame);
+}
+
+// Fuse the wall seen from two positions
+void
+fuseWall (TSDFVolume<PointXYZ> &volume)
+{
+  volume.setCameraIntrinsics (focal_length, focal_length);
+  volume.setDepthRange (0.3f, 3.0f);
+  ASSERT_TRUE (volume.integrate (makeWallFrame (1.0f)));
+  ASSERT_TRUE (volume.integrate (makeWallFrame (0.9f), Eigen::Affine3f (Eigen::Translation3f (0.05f, 0.0f, 0.1f))));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TSDFVolumeRaycast)
+{
+  TSDFVolume<PointXYZ> volume (0.01f, 0.04f);
+  fuseWall (volume);
+  EXPECT_GT (volume.getNumberOfBlocks (), 0u);
+
+  PointCloud<PointXYZ> unorganized;
+  unorganized.push_back (PointXYZ (0.0f, 0.0f, 1.0f));
+  EXPECT_FALSE (volume.integrate (unorganized));
+
+  PointCloud<PointXYZ> surface;
+  PointCloud<Normal> normals;
+  volume.raycast (Eigen::Affine3f::Identity (), frame_width, frame_height, surface, normals);
+  ASSERT_EQ (frame_width, surface.width);
+  ASSERT_EQ (frame_height, surface.height);
+  ASSERT_EQ (surface.size (), normals.size ());
+  std::size_t nr_hits = 0;
+  for (std::size_t i = 0; i < surface.size (); ++i)
+  {
+    if (!std::isfinite (surface[i].z))
+      continue;
+    ++nr_hits;
+    EXPECT_NEAR (1.0f, surface[i].z, 0.005f);
+    if (std::isfinite (normals[i].normal_z))
+    {
+      EXPECT_LT (normals[i].normal_z, -0.99f);
+    }
+  }
+  EXPECT_GT (nr_hits, surface.size () * 9 / 10);
+
+  // The same surface seen from farther away
+  PointCloud<PointXYZ> far_surface;
+  volume.raycast (Eigen::Affine3f (Eigen::Translation3f (0.0f, 0.0f, -0.5f)), frame_width, frame_height, far_surface);
+  for (const auto &point : far_surface)
+  {
+    if (std::isfinite (point.z))
+    {
+      EXPECT_NEAR (1.5f, point.z, 0.005f);
+    }
+  }
+
+  // The rendered surface is an organized cloud, which can be meshed as such
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ> (surface));
+  OrganizedFastMesh<PointXYZ> ofm;
+  ofm.setInputCloud (input);
+  ofm.setTriangulationType (OrganizedFastMesh<PointXYZ>::TRIANGLE_ADAPTIVE_CUT);
+  std::vector<Vertices> polygons;
+  ofm.reconstruct (polygons);
+  EXPECT_GT (polygons.size (), nr_hits);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TSDFVolumeExtractMesh)
+{
+  TSDFVolume<PointXYZ> volume (0.01f, 0.04f);
+  fuseWall (volume);
+
+  PolygonMesh mesh;
+  volume.extractMesh (mesh);
+  PointCloud<PointXYZ> vertices;
+  fromPCLPointCloud2 (mesh.cloud, vertices);
+  ASSERT_GT (mesh.polygons.size (), 0u);
+  for (const auto &vertex : vertices)
+    EXPECT_NEAR (1.0f, vertex.z, 0.005f);
+  // The vertices are shared by the triangles
+  EXPECT_LT (vertices.size (), 3 * mesh.polygons.size ());
+  for (const auto &polygon : mesh.polygons)
+  {
+    ASSERT_EQ (3u, polygon.vertices.size ());
+    for (const auto &vertex : polygon.vertices)
+      EXPECT_LT (vertex, vertices.size ());
+  }
+
+  // The volume and its mesh do not depend on the number of threads
+  TSDFVolume<PointXYZ> parallel_volume (0.01f, 0.04f);
+  parallel_volume.setNumberOfThreads (4);
+  fuseWall (parallel_volume);
+  EXPECT_EQ (volume.getNumberOfBlocks (), parallel_volume.getNumberOfBlocks ());
+  PolygonMesh parallel_mesh;
+  parallel_volume.extractMesh (parallel_mesh);
+  EXPECT_EQ (mesh.cloud.data, parallel_mesh.cloud.data);
+  ASSERT_EQ (mesh.polygons.size (), parallel_mesh.polygons.size ());
+  for (std::size_t i = 0; i < mesh.polygons.size (); ++i)
+    EXPECT_EQ (mesh.polygons[i].vertices, parallel_mesh.polygons[i].vertices);
+
+  volume.reset ();
+  EXPECT_EQ (0u, volume.getNumberOfBlocks ());
+  volume.extractMesh (mesh);
+  EXPECT_TRUE (mesh.polygons.empty ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
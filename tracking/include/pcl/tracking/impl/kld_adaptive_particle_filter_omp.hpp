@@ -1,6 +1,7 @@
 #ifndef PCL_TRACKING_IMPL_KLD_ADAPTIVE_PARTICLE_OMP_FILTER_H_
 #define PCL_TRACKING_IMPL_KLD_ADAPTIVE_PARTICLE_OMP_FILTER_H_
 
+#include <pcl/common/parallel.h>
 #include <pcl/tracking/kld_adaptive_particle_filter_omp.h>
 
 namespace pcl {
@@ -11,14 +12,7 @@ void
 KLDAdaptiveParticleFilterOMPTracker<PointInT, StateT>::setNumberOfThreads(
     unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -27,14 +21,16 @@ void
 KLDAdaptiveParticleFilterOMPTracker<PointInT, StateT>::weight()
 {
   if (!use_normal_) {
-    // clang-format off
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-    // clang-format on
-    for (int i = 0; i < particle_num_; i++)
-      this->computeTransformedPointCloudWithoutNormal(particles_->points[i],
-                                                      *transed_reference_vector_[i]);
+    pcl::parallel::parallel_for(
+        0,
+        particle_num_,
+        [&](int first, int last) {
+          for (int i = first; i < last; i++) {
+            this->computeTransformedPointCloudWithoutNormal(
+                particles_->points[i], *transed_reference_vector_[i]);
+          }
+        },
+        threads_);
 
     PointCloudInPtr coherence_input(new PointCloudIn);
     this->cropInputPointCloud(input_, *coherence_input);
@@ -45,16 +41,18 @@ KLDAdaptiveParticleFilterOMPTracker<PointInT, StateT>::weight()
         change_counter_ = change_detector_interval_;
         coherence_->setTargetCloud(coherence_input);
         coherence_->initCompute();
-        // clang-format off
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-        // clang-format on
-        for (int i = 0; i < particle_num_; i++) {
-          IndicesPtr indices;
-          coherence_->compute(
-              transed_reference_vector_[i], indices, particles_->points[i].weight);
-        }
+        pcl::parallel::parallel_for(
+            0,
+            particle_num_,
+            [&](int first, int last) {
+              for (int i = first; i < last; i++) {
+                IndicesPtr indices;
+                coherence_->compute(transed_reference_vector_[i],
+                                    indices,
+                                    particles_->points[i].weight);
+              }
+            },
+            threads_);
       }
       else
         changed_ = false;
@@ -63,16 +61,18 @@ KLDAdaptiveParticleFilterOMPTracker<PointInT, StateT>::weight()
       --change_counter_;
       coherence_->setTargetCloud(coherence_input);
       coherence_->initCompute();
-      // clang-format off
-#pragma omp parallel for \
-  default(none) \
-  num_threads(threads_)
-      // clang-format on
-      for (int i = 0; i < particle_num_; i++) {
-        IndicesPtr indices;
-        coherence_->compute(
-            transed_reference_vector_[i], indices, particles_->points[i].weight);
-      }
+      pcl::parallel::parallel_for(
+          0,
+          particle_num_,
+          [&](int first, int last) {
+            for (int i = first; i < last; i++) {
+              IndicesPtr indices;
+              coherence_->compute(transed_reference_vector_[i],
+                                  indices,
+                                  particles_->points[i].weight);
+            }
+          },
+          threads_);
     }
   }
   else {
@@ -80,32 +80,33 @@ KLDAdaptiveParticleFilterOMPTracker<PointInT, StateT>::weight()
     for (int i = 0; i < particle_num_; i++) {
       indices_list[i] = IndicesPtr(new std::vector<int>);
     }
-    // clang-format off
-#pragma omp parallel for \
-  default(none) \
-  shared(indices_list) \
-  num_threads(threads_)
-    // clang-format on
-    for (int i = 0; i < particle_num_; i++) {
-      this->computeTransformedPointCloudWithNormal(
-          particles_->points[i], *indices_list[i], *transed_reference_vector_[i]);
-    }
+    pcl::parallel::parallel_for(
+        0,
+        particle_num_,
+        [&](int first, int last) {
+          for (int i = first; i < last; i++) {
+            this->computeTransformedPointCloudWithNormal(
+                particles_->points[i], *indices_list[i], *transed_reference_vector_[i]);
+          }
+        },
+        threads_);
 
     PointCloudInPtr coherence_input(new PointCloudIn);
     this->cropInputPointCloud(input_, *coherence_input);
 
     coherence_->setTargetCloud(coherence_input);
     coherence_->initCompute();
-    // clang-format off
-#pragma omp parallel for \
-  default(none) \
-  shared(indices_list) \
-  num_threads(threads_)
-    // clang-format on
-    for (int i = 0; i < particle_num_; i++) {
-      coherence_->compute(
-          transed_reference_vector_[i], indices_list[i], particles_->points[i].weight);
-    }
+    pcl::parallel::parallel_for(
+        0,
+        particle_num_,
+        [&](int first, int last) {
+          for (int i = first; i < last; i++) {
+            coherence_->compute(transed_reference_vector_[i],
+                                indices_list[i],
+                                particles_->points[i].weight);
+          }
+        },
+        threads_);
   }
 
   normalizeWeight();
@@ -10,7 +10,7 @@ namespace tracking {
  * by setReferenceCloud within the measured PointCloud using particle filter method. The
  * number of the particles changes adaptively based on KLD sampling [D. Fox, NIPS-01],
  * [D.Fox, IJRR03]. and the computation of the weights of the particles is parallelized
- * using OpenMP.
+ * with the threads of pcl::parallel.
  * \author Ryohei Ueda
  * \ingroup tracking
  */
@@ -66,8 +66,8 @@ public:
   using CloudCoherenceConstPtr = typename CloudCoherence::ConstPtr;
 
   /** \brief Initialize the scheduler and set the number of threads to use.
-   * \param nr_threads the number of hardware threads to use (0 sets the value
-   * back to automatic)
+   * \param nr_threads the number of threads to use (0 for the whole thread budget
+   * of pcl::parallel)
    */
   KLDAdaptiveParticleFilterOMPTracker(unsigned int nr_threads = 0)
   : KLDAdaptiveParticleFilterTracker<PointInT, StateT>()
@@ -77,9 +77,9 @@ public:
     setNumberOfThreads(nr_threads);
   }
 
-  /** \brief Initialize the scheduler and set the number of threads to use.
-   * \param nr_threads the number of hardware threads to use (0 sets the value back to
-   * automatic)
+  /** \brief Set the number of threads to use.
+   * \param nr_threads the number of threads to use (0 for the whole thread budget
+   * of pcl::parallel)
    */
   void
   setNumberOfThreads(unsigned int nr_threads = 0);
@@ -8,7 +8,7 @@ namespace pcl {
 namespace tracking {
 /** \brief @b ParticleFilterOMPTracker tracks the PointCloud which is given by
  * setReferenceCloud within the measured PointCloud using particle filter method in
- * parallel, using the OpenMP standard. \author Ryohei Ueda \ingroup tracking
+ * parallel, with the threads of pcl::parallel. \author Ryohei Ueda \ingroup tracking
  */
 template <typename PointInT, typename StateT>
 class ParticleFilterOMPTracker : public ParticleFilterTracker<PointInT, StateT> {
@@ -54,8 +54,8 @@ public:
   using CloudCoherenceConstPtr = typename CloudCoherence::ConstPtr;
 
   /** \brief Initialize the scheduler and set the number of threads to use.
-   * \param nr_threads the number of hardware threads to use (0 sets the value
-   * back to automatic)
+   * \param nr_threads the number of threads to use (0 for the whole thread budget
+   * of pcl::parallel)
    */
   ParticleFilterOMPTracker(unsigned int nr_threads = 0)
   : ParticleFilterTracker<PointInT, StateT>()
@@ -65,9 +65,9 @@ public:
     setNumberOfThreads(nr_threads);
   }
 
-  /** \brief Initialize the scheduler and set the number of threads to use.
-   * \param nr_threads the number of hardware threads to use (0 sets the value
-   * back to automatic)
+  /** \brief Set the number of threads to use.
+   * \param nr_threads the number of threads to use (0 for the whole thread budget
+   * of pcl::parallel)
    */
   void
   setNumberOfThreads(unsigned int nr_threads = 0);